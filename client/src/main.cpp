@@ -3,7 +3,9 @@
 
 #include <chrono>
 #include <iostream>
+#include <sstream>
 #include <string>
+#include <vector>
 
 using namespace Diginext::Core::Storage;
 using namespace std::chrono_literals;
@@ -28,6 +30,36 @@ int main(int argc, char** argv) {
 
     Diginext::Core::TCP::tcp_all_log_disable();
 
+    // --servers host:port,host:port spreads keys over several servers
+    // --framing base64|binary|compressed is asked for in a hello, the servers may grant less
+    std::vector<std::string> servers;
+    Diginext::Core::TCP::tcp_framing framing = Diginext::Core::TCP::tcp_framing::Base64Line;
+    for (int i = 1; i + 1 < argc; i++) {
+        if (std::string(argv[i]) == "--framing") {
+            if (!Diginext::Core::TCP::tcp_framing_from_string(argv[++i], framing)) {
+                std::cerr << "framing must be base64, binary or compressed" << std::endl;
+                return 1;
+            }
+        } else if (std::string(argv[i]) == "--servers") {
+            std::stringstream list(argv[++i]);
+            std::string server;
+            while (std::getline(list, server, ',')) {
+                if (!server.empty()) {
+                    servers.push_back(server);
+                }
+            }
+        }
+    }
+
+    StorageClient::pointer client;
+    try {
+        client = servers.empty() ? StorageClient::create() : StorageClient::create(servers);
+        client->setFraming(framing);
+    } catch (const std::exception &error) {
+        std::cerr << error.what() << std::endl;
+        return 1;
+    }
+
     while (true) {
         std::cout << INFO_MESSAGE << std::endl;
 
@@ -39,8 +71,6 @@ int main(int argc, char** argv) {
         if (request == QUIT_REQUEST) {
             break;
         } else {
-            StorageClient::pointer client = StorageClient::create();
-            client->Connect();
             client->send(request);
             waitAnswer(client);
         }
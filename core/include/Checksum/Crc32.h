@@ -0,0 +1,29 @@
+#ifndef DIGINEXT_CORE___CHECKSUM_CRC32_H
+#define DIGINEXT_CORE___CHECKSUM_CRC32_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace Diginext::Core {
+
+    /**
+     * \brief crc32 (IEEE 802.3, reflected, poly 0xEDB88320)
+     */
+    class Crc32 {
+    public:
+        /**
+         * @brief crc32 of buffer
+         * @param[in] data
+         * @param[in] dataLength
+         * @param[in] crc previous crc to continue from, 0 to start
+         * @return crc32
+         */
+        static uint32_t Compute(const char *data, size_t dataLength, uint32_t crc = 0);
+
+        static uint32_t Compute(const std::string &data, uint32_t crc = 0);
+    };
+
+}// namespace Diginext::Core
+
+#endif
@@ -0,0 +1,96 @@
+#ifndef DIGINEXT_CORE___STORAGE_BTREE_INDEX_H
+#define DIGINEXT_CORE___STORAGE_BTREE_INDEX_H
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace Diginext::Core::Storage {
+
+    using namespace std;
+
+    /**
+     * \brief BTreeIndex
+     * \details B+tree of keys: internal nodes route by separator keys, leaves hold the
+     * keys in order and are linked left to right, so a range scan is one descent plus
+     * a walk along the leaves. Nodes split when full and borrow or merge when less than
+     * half full. Nodes are allocated at full capacity, so memory usage is tracked exactly.
+     * Not thread-safe, the owner serializes access.
+     */
+    class BTreeIndex {
+    private:
+        struct Node {
+            bool leaf;
+            std::vector<string> keys;
+            std::vector<std::unique_ptr<Node>> children;///< internal: keys.size() + 1 children
+            Node *next = nullptr;///< leaf: right neighbour
+
+            explicit Node(bool leaf);
+        };
+
+        std::unique_ptr<Node> root;
+        size_t count;
+        size_t leafCount;
+        size_t internalCount;
+        size_t keyBytes;///< heap buffers of the keys and separators
+
+        std::unique_ptr<Node> makeNode(bool leaf);
+        void dropNode(const Node *node);
+
+        bool insertInto(Node *node, const string &key, string &separator, std::unique_ptr<Node> &split);
+        bool eraseFrom(Node *node, string_view key);
+        void rebalance(Node *parent, size_t index);
+        const Node *findLeaf(string_view key) const;
+
+    public:
+        static const size_t MAX_KEYS = 64;
+        static const size_t MIN_KEYS = MAX_KEYS / 2;
+
+        typedef std::function<bool(const string &key)> key_callback;
+
+        BTreeIndex();
+
+        BTreeIndex(const BTreeIndex &) = delete;
+        BTreeIndex &operator=(const BTreeIndex &) = delete;
+
+        /**
+         * @brief add key
+         * @return false if key is already present
+         */
+        bool insert(const string &key);
+
+        /**
+         * @brief remove key
+         * @return false if key is absent
+         */
+        bool erase(string_view key);
+
+        bool contains(string_view key) const;
+
+        /**
+         * @brief visit keys >= start in ascending order
+         * @param[in] start
+         * @param[in] callback return false to stop
+         */
+        void scan(string_view start, const key_callback &callback) const;
+
+        void clear();
+
+        size_t size() const;
+
+        /**
+         * @brief tree height, 1 for a single leaf
+         */
+        size_t height() const;
+
+        /**
+         * @brief bytes held by nodes and key buffers, the object itself excluded
+         */
+        size_t memoryUsage() const;
+    };
+}// namespace Diginext::Core::Storage
+
+#endif
@@ -0,0 +1,54 @@
+#ifndef DIGINEXT_CORE___STORAGE_BLOOM_FILTER_H
+#define DIGINEXT_CORE___STORAGE_BLOOM_FILTER_H
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace Diginext::Core::Storage {
+
+    using namespace std;
+
+    /**
+     * \brief BloomFilter
+     * \details serialized as [bit array][probe count u8]; probes are derived from one
+     * 64-bit key hash by double hashing, so a lookup hashes the key once
+     */
+    class BloomFilter {
+    private:
+        string data;
+
+    public:
+        static const size_t DEFAULT_BITS_PER_KEY = 10;
+
+        BloomFilter() = default;
+
+        /**
+         * @brief wrap serialized filter
+         * @param[in] data
+         */
+        explicit BloomFilter(string data);
+
+        /**
+         * @brief build filter for key hashes (hash_key)
+         * @param[in] hashes
+         * @param[in] bitsPerKey 10 bits per key give about 1% false positives
+         * @return filter
+         */
+        static BloomFilter build(const std::vector<uint64_t> &hashes, size_t bitsPerKey = DEFAULT_BITS_PER_KEY);
+
+        /**
+         * @brief false - key is definitely absent, true - key may be present;
+         * an empty filter may contain anything
+         * @param[in] hash hash_key of the key
+         */
+        bool mayContain(uint64_t hash) const;
+
+        bool mayContain(string_view key) const;
+
+        const string &getData() const;
+    };
+}// namespace Diginext::Core::Storage
+
+#endif
@@ -0,0 +1,120 @@
+#ifndef DIGINEXT_CORE___STORAGE_EPOCH_RECLAMATION_H
+#define DIGINEXT_CORE___STORAGE_EPOCH_RECLAMATION_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace Diginext::Core::Storage {
+
+    /**
+     * \brief EpochManager
+     * \details epoch based reclamation: a reader pins the current global epoch for
+     * the time it dereferences shared pointers, a writer that unlinks a node retires
+     * it and the node is freed only once every pinned epoch is newer than the retire epoch
+     */
+    class EpochManager {
+    private:
+        static const size_t MAX_THREADS = 1024;
+
+        struct alignas(64) ThreadSlot {
+            std::atomic<uint64_t> epoch{0};
+            std::atomic<bool> used{false};
+        };
+
+        ThreadSlot slots[MAX_THREADS];
+        std::atomic<size_t> slotsHighWater{0};
+        std::atomic<uint64_t> globalEpoch{1};
+
+        EpochManager() = default;
+
+        ThreadSlot *acquireSlot();
+        void releaseSlot(ThreadSlot *slot);
+
+        friend struct EpochThreadState;
+
+    public:
+        static EpochManager &instance();
+
+        EpochManager(const EpochManager &) = delete;
+        EpochManager &operator=(const EpochManager &) = delete;
+
+        /**
+         * \brief pins the epoch of the calling thread until destroyed, may be nested
+         */
+        class Guard {
+        public:
+            Guard();
+            ~Guard();
+
+            Guard(const Guard &) = delete;
+            Guard &operator=(const Guard &) = delete;
+        };
+
+        /**
+         * @brief move global epoch forward
+         * @return new epoch
+         */
+        uint64_t advance();
+
+        /**
+         * @brief current global epoch
+         */
+        uint64_t current() const;
+
+        /**
+         * @brief oldest epoch pinned by any reader, current epoch if none
+         */
+        uint64_t minActive() const;
+    };
+
+    /**
+     * \brief RetireList
+     * \details nodes unlinked by a writer, waiting for readers to leave their epoch;
+     * not thread safe, owned by one writer (e.g. guarded by the shard mutex)
+     */
+    class RetireList {
+    private:
+        struct Retired {
+            uint64_t epoch;
+            void *ptr;
+            void (*deleter)(void *);
+        };
+
+        std::vector<Retired> retired;
+        size_t nextReclaim = RECLAIM_THRESHOLD;
+
+    public:
+        static const size_t RECLAIM_THRESHOLD = 64;
+
+        RetireList() = default;
+        ~RetireList();
+
+        RetireList(const RetireList &) = delete;
+        RetireList &operator=(const RetireList &) = delete;
+
+        template<class T>
+        void retire(T *ptr) {
+            this->retire(ptr, [](void *p) { delete static_cast<T *>(p); });
+        }
+
+        void retire(void *ptr, void (*deleter)(void *));
+
+        /**
+         * @brief free every node no reader can still see
+         * @return freed nodes count
+         */
+        size_t reclaim();
+
+        /**
+         * @brief reclaim once enough nodes were retired since the last pass,
+         * so a long pinned reader does not turn every write into a slot scan
+         */
+        void collect();
+
+        size_t size() const;
+    };
+}// namespace Diginext::Core::Storage
+
+#endif
@@ -0,0 +1,66 @@
+#ifndef DIGINEXT_CORE___STORAGE_HASH_RING_H
+#define DIGINEXT_CORE___STORAGE_HASH_RING_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace Diginext::Core::Storage {
+
+    using namespace std;
+
+    /**
+     * \brief HashRing
+     * \details consistent hashing: every node owns vnodes points on a 64-bit ring, placed by
+     * hashing "node#i", and a key belongs to the node of the first point at or after the key's
+     * hash. Adding a node only takes keys over from the points it lands in front of, removing
+     * one only hands its own keys to the following points, every other key stays where it was.
+     * Points are a sorted array, a lookup is one binary search.
+     * Not thread-safe.
+     */
+    class HashRing {
+    private:
+        struct Point {
+            uint64_t hash;
+            uint32_t node;///< index into nodes
+        };
+
+        size_t vnodes;
+        std::vector<string> nodes;
+        std::vector<Point> points;///< ascending by hash, ties by node name
+
+        void sortPoints();
+
+    public:
+        static const size_t DEFAULT_VNODES = 160;
+
+        explicit HashRing(size_t vnodes = DEFAULT_VNODES);
+
+        /**
+         * @brief add a node, no-op if it is on the ring already
+         * @return true if added
+         */
+        bool add(const string &node);
+
+        /**
+         * @brief remove a node and its points
+         * @return true if it was on the ring
+         */
+        bool remove(const string &node);
+
+        bool contains(const string &node) const;
+
+        /**
+         * @brief node owning the key, the ring must not be empty
+         */
+        const string &locate(const string &key) const;
+
+        const std::vector<string> &getNodes() const;
+        size_t size() const;
+        bool empty() const;
+    };
+}// namespace Diginext::Core::Storage
+
+#endif
@@ -0,0 +1,92 @@
+#ifndef DIGINEXT_CORE___STORAGE_HOT_KEY_TRACKER_H
+#define DIGINEXT_CORE___STORAGE_HOT_KEY_TRACKER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace Diginext::Core::Storage {
+
+    using namespace std;
+
+    /**
+     * \brief HotKeyTracker
+     * \details heavy hitters over the server's reads and writes. About one access in sampleRate
+     * is sampled, at random intervals; the rest cost one decrement. A sample goes into a
+     * Count-Min Sketch (conservative update) and a key whose estimate beats the coldest of the
+     * top capacity keys takes its place. Every DECAY_SAMPLES samples all counts are halved, so
+     * the list follows what is hot now rather than since start.
+     * Counts are scaled back by sampleRate, estimates not exact numbers.
+     * Not thread-safe, used from the server io thread.
+     */
+    class HotKeyTracker {
+    public:
+        struct HotKey {
+            string key;
+            uint64_t accesses;///< sketch estimate
+            uint64_t reads;   ///< counted since the key entered the list
+            uint64_t writes;
+        };
+
+    private:
+        struct Counts {
+            uint32_t estimate = 0;
+            uint32_t reads = 0;
+            uint32_t writes = 0;
+        };
+
+        size_t capacity;
+        size_t sampleRate;
+        uint64_t random;
+        size_t countdown;///< accesses left until the next sample
+
+        std::vector<uint32_t> sketch;///< SKETCH_DEPTH rows of SKETCH_WIDTH counters
+        std::unordered_map<string, Counts> top;
+        uint32_t floor;///< no top key is below it, the coldest may be above after updates
+
+        uint64_t sampled;
+        uint64_t sinceDecay;
+
+        void sample(const string &key, bool write);
+        uint32_t addToSketch(const string &key);
+        bool admit(const string &key, uint32_t estimate);
+        void decay();
+
+    public:
+        static const size_t DEFAULT_CAPACITY = 32;
+        static const size_t DEFAULT_SAMPLE_RATE = 16;
+        static const size_t SKETCH_DEPTH = 4;
+        static const size_t SKETCH_WIDTH = 4096;
+        static const uint64_t DECAY_SAMPLES = 1 << 16;
+
+        /**
+         * @param[in] capacity keys kept in the top list, 0 - tracking off
+         * @param[in] sampleRate one access in sampleRate on average is sampled, 1 - all
+         */
+        explicit HotKeyTracker(size_t capacity = DEFAULT_CAPACITY, size_t sampleRate = DEFAULT_SAMPLE_RATE);
+
+        /**
+         * @brief count an access, inline so the unsampled ones stay a decrement
+         */
+        void record(const string &key, bool write) {
+            if (this->capacity != 0 && --this->countdown == 0) {
+                this->sample(key, write);
+            }
+        }
+
+        /**
+         * @brief hottest keys first
+         * @param[in] limit at most that many
+         */
+        std::vector<HotKey> hottest(size_t limit) const;
+
+        bool enabled() const;
+        size_t getCapacity() const;
+        size_t getSampleRate() const;
+        uint64_t getSampled() const;
+    };
+}// namespace Diginext::Core::Storage
+
+#endif
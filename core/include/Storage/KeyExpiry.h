@@ -0,0 +1,124 @@
+#ifndef DIGINEXT_CORE___STORAGE_KEY_EXPIRY_H
+#define DIGINEXT_CORE___STORAGE_KEY_EXPIRY_H
+
+#include "Storage/TimingWheel.h"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+namespace Diginext::Core::Storage {
+
+    using namespace std;
+
+    /**
+     * \brief KeyExpiry
+     * \details key deadlines for StorageServer: the map holds the current deadline of every
+     * key with a TTL, the timing wheel tells when to look at it. Overwriting or persisting a
+     * key only updates the map, its old wheel timer is dropped when it fires.
+     * Not thread-safe, used from the server io thread.
+     */
+    class KeyExpiry {
+    private:
+        typedef std::chrono::steady_clock clock;
+
+        clock::time_point origin;
+        std::chrono::milliseconds tick;
+        std::unordered_map<string, uint64_t> deadlines;///< key -> deadline, ms since origin
+        TimingWheel wheel;
+
+        uint64_t now() const;
+
+    public:
+        typedef std::function<void(const string &key)> expire_callback;
+        typedef std::function<void(const string &key, uint64_t at)> deadline_callback;
+
+        static constexpr std::chrono::milliseconds DEFAULT_TICK{10};
+
+        explicit KeyExpiry(std::chrono::milliseconds tick = DEFAULT_TICK);
+
+        KeyExpiry(const KeyExpiry &) = delete;
+        KeyExpiry &operator=(const KeyExpiry &) = delete;
+
+        /**
+         * @brief set or replace key deadline
+         * @param[in] key
+         * @param[in] ttl time to live from now
+         */
+        void expire(const string &key, std::chrono::milliseconds ttl);
+
+        /**
+         * @brief set or replace key deadline given as wall-clock time, e.g. read back from a log;
+         * a deadline already passed expires the key at once
+         * @param[in] key
+         * @param[in] at milliseconds since unix epoch
+         */
+        void expireAt(const string &key, uint64_t at);
+
+        /**
+         * @brief key deadline as wall-clock time, the form that outlives the process
+         * @param[in] key
+         * @return milliseconds since unix epoch, 0 if key has no deadline
+         */
+        uint64_t deadline(const string &key) const;
+
+        /**
+         * @brief visit every deadline as wall-clock time
+         */
+        void forEach(const deadline_callback &callback) const;
+
+        /**
+         * @brief keep key expired without a timer, until it is persisted or given a new deadline;
+         * e.g. on a follower, where the leader's stream removes the key
+         * @param[in] key
+         */
+        void hold(const string &key);
+
+        /**
+         * @brief drop key deadline
+         * @param[in] key
+         * @return true if key had one
+         */
+        bool persist(const string &key);
+
+        /**
+         * @brief key deadline passed but the key is not reclaimed yet;
+         * without any TTL set this is a single emptiness check
+         * @param[in] key
+         */
+        bool expired(const string &key) const;
+
+        /**
+         * @brief time left before key expires
+         * @param[in] key
+         * @return -1 ms if key has no deadline
+         */
+        std::chrono::milliseconds remaining(const string &key) const;
+
+        /**
+         * @brief reclaim at most budget expired keys, the deadline is dropped before callback
+         * @param[in] budget
+         * @param[in] callback removes the key from storage
+         * @return true if more expired keys are waiting
+         */
+        bool collect(size_t budget, const expire_callback &callback);
+
+        /**
+         * @brief keys with a deadline
+         */
+        size_t size() const;
+
+        std::chrono::milliseconds getTick() const;
+
+        /**
+         * @brief wall-clock now, milliseconds since unix epoch
+         */
+        static uint64_t wallClock();
+    };
+}// namespace Diginext::Core::Storage
+
+#endif
@@ -0,0 +1,218 @@
+#ifndef DIGINEXT_CORE___STORAGE_LSM_STORAGE_H
+#define DIGINEXT_CORE___STORAGE_LSM_STORAGE_H
+
+#include "Log/Log.h"
+#include "Storage/SSTable.h"
+#include "Storage/StorageEngine.h"
+#include "Storage/WriteAheadLog.h"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace Diginext::Core::Storage {
+
+    using namespace std;
+    using namespace Diginext::Core::Log;
+
+    struct LsmOptions {
+        /**
+         * \brief memtable is frozen and flushed to level 0 once it holds this many bytes
+         */
+        size_t memtableSize = 4 * 1024 * 1024;
+
+        size_t blockSize = 4096;
+
+        size_t bloomBitsPerKey = BloomFilter::DEFAULT_BITS_PER_KEY;
+
+        /**
+         * \brief level 0 tables overlap each other, merge them into level 1 at this count
+         */
+        size_t level0CompactionTrigger = 4;
+
+        uint64_t level1MaxBytes = 10 * 1024 * 1024;
+
+        /**
+         * \brief every next level may hold this many times more bytes
+         */
+        uint64_t levelMultiplier = 10;
+
+        /**
+         * \brief compaction output is split into tables of about this size
+         */
+        uint64_t tableFileSize = 2 * 1024 * 1024;
+
+        FsyncPolicy fsyncPolicy = FsyncPolicy::GroupCommit;
+
+        std::chrono::microseconds groupCommitWindow = std::chrono::microseconds(2000);
+    };
+
+    struct LsmStats {
+        uint64_t memtableBytes = 0;
+        uint64_t tableCount = 0;
+        uint64_t diskBytes = 0;///< tables and logs
+        uint64_t blockReads = 0;///< data block reads issued by live tables
+        uint64_t flushes = 0;
+        uint64_t compactions = 0;
+        std::vector<uint64_t> levelBytes;
+    };
+
+    /**
+     * \brief LsmStorage
+     * \details log-structured merge tree: writes go to the memtable log and a sorted
+     * memtable; a full memtable is frozen and written by the background thread as a
+     * level 0 SSTable, which also runs leveled compaction (level 0 -> 1 once enough
+     * tables pile up, level N -> N+1 when a level outgrows its byte budget).
+     *
+     * Directory layout: MANIFEST (live tables per level, file numbers),
+     * NNNNNN.log (memtable logs), NNNNNN.sst (tables).
+     *
+     * Reads check memtable, frozen memtable, level 0 newest first, then one table per
+     * deeper level; every table lookup is gated by its key range and bloom filter.
+     */
+    class LsmStorage : public StorageEngine {
+    public:
+        static const size_t LEVEL_COUNT = 7;
+
+    private:
+        struct Memtable {
+            mutable std::shared_mutex sync;
+            std::map<string, value_pointer> entries;///< nullptr value - tombstone
+            size_t bytes = 0;
+            int64_t liveDelta = 0;///< keys added minus keys removed, for size()
+            uint64_t logNumber = 0;
+            WriteAheadLog::pointer log;
+
+            /**
+             * @brief insert, overwrite or tombstone a key, caller holds sync
+             * @param[in] stored nullptr - tombstone
+             */
+            void apply(const string &key, const value_pointer &stored);
+        };
+
+        struct Version {
+            std::vector<SSTable::pointer> levels[LEVEL_COUNT];///< level 0 newest first, others sorted by key
+        };
+
+        struct Compaction {
+            size_t level;
+            std::vector<SSTable::pointer> inputs;///< level and level + 1 tables, newest first
+            bool trivialMove;
+        };
+
+        Logger::pointer logger;
+        string directory;
+        LsmOptions options;
+
+        // mem / imm / version pointers, readers copy them and release the lock
+        mutable std::mutex stateSync;
+        std::condition_variable stateCondition;
+        shared_ptr<Memtable> mem;
+        shared_ptr<Memtable> imm;
+        shared_ptr<const Version> version;
+
+        std::mutex writeSync;
+        std::mutex manifestSync;
+        uint64_t nextFileNumber;
+        string compactPointer[LEVEL_COUNT];
+
+        std::thread background;
+        std::condition_variable backgroundCondition;
+        bool stopping;
+        bool opened;
+
+        std::atomic<uint64_t> flushCount{0};
+        std::atomic<uint64_t> compactionCount{0};
+
+        string fileName(uint64_t number, const char *extension) const;
+        shared_ptr<Memtable> newMemtable(uint64_t number);
+        uint64_t allocateFileNumber();
+
+        void open();
+        void recover(uint64_t logNumber, uint64_t lastFileNumber);
+        void writeManifest(const Version &current, uint64_t logNumber);
+
+        void makeRoom(bool force);
+        void write(WalRecordType type, const string &key, const string &value, const durable_callback &onDurable);
+        void writeBatch(const record_batch &records, const durable_callback &onDurable);
+
+        SSTable::pointer writeTable(const Memtable &memtable);
+        void flushImmutable();
+        bool pickCompaction(const Version &current, Compaction &compaction) const;
+        void compact(const Compaction &compaction);
+        void backgroundLoop();
+
+        uint64_t levelMaxBytes(size_t level) const;
+        static uint64_t levelBytes(const std::vector<SSTable::pointer> &tables);
+        static bool overlaps(const SSTable::pointer &table, const string &smallest, const string &largest);
+        static bool keyInDeeperLevels(const Version &current, size_t level, string_view key);
+
+        LookupResult lookup(const string &key, value_pointer &value) const;
+
+    public:
+        typedef shared_ptr<LsmStorage> pointer;
+
+        /**
+         * @brief open (or create) storage in directory, recover memtable logs
+         * and start the background thread; throws on I/O or format errors
+         * @param[in] directory
+         * @param[in] options
+         */
+        static pointer create(const string &directory, const LsmOptions &options = LsmOptions());
+
+        LsmStorage(const string &directory, const LsmOptions &options = LsmOptions());
+        ~LsmStorage() override;
+
+        LsmStorage(const LsmStorage &) = delete;
+        LsmStorage &operator=(const LsmStorage &) = delete;
+
+        bool get(const string &key, string &value) const override;
+        value_pointer getShared(const string &key) const override;
+        void put(const string &key, const string &value) override;
+        void putDurable(const string &key, const string &value, const durable_callback &onDurable) override;
+        void multiPut(const record_batch &records) override;
+        void multiPutDurable(const record_batch &records, const durable_callback &onDurable) override;
+        bool update(const string &key, const update_callback &update, const durable_callback &onDurable = nullptr,
+                    uint64_t *version = nullptr) override;
+        bool remove(const string &key) override;
+        void forEach(const record_callback &callback) const override;
+        void scan(const string &start, const string &end, const scan_callback &callback) const override;
+
+        /**
+         * @brief estimated keys count: a key overwritten in several tables is counted
+         * more than once until compaction merges them
+         */
+        size_t size() const override;
+
+        bool persistent() const override;
+
+        /**
+         * @brief flush memtable to level 0 and wait until it is written
+         */
+        void flush();
+
+        /**
+         * @brief block until no flush or compaction is pending
+         */
+        void waitIdle();
+
+        /**
+         * @brief flush pending log writes, stop background thread; frozen memtable is
+         * written first, the active one stays in its log
+         */
+        void close();
+
+        LsmStats getStats() const;
+        string getDirectory() const;
+    };
+}// namespace Diginext::Core::Storage
+
+#endif
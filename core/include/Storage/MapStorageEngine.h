@@ -0,0 +1,53 @@
+#ifndef DIGINEXT_CORE___STORAGE_MAP_STORAGE_ENGINE_H
+#define DIGINEXT_CORE___STORAGE_MAP_STORAGE_ENGINE_H
+
+#include "Storage/StorageEngine.h"
+#include "Storage/VersionClock.h"
+
+#include <map>
+#include <memory>
+#include <shared_mutex>
+#include <string>
+#include <vector>
+
+namespace Diginext::Core::Storage {
+
+    using namespace std;
+
+    /**
+     * \brief MapStorageEngine
+     * \details reference backend: one std::map behind a reader-writer lock,
+     * simple enough to be obviously correct; other engines are checked against it
+     */
+    class MapStorageEngine : public StorageEngine {
+    private:
+        struct Record {
+            value_pointer value;
+            uint64_t version;
+        };
+
+        mutable std::shared_mutex sync;
+        std::map<string, Record> data;
+        VersionClock clock;
+
+    public:
+        typedef shared_ptr<MapStorageEngine> pointer;
+        static pointer create();
+
+        bool get(const string &key, string &value) const override;
+        value_pointer getShared(const string &key) const override;
+        value_pointer getVersioned(const string &key, uint64_t &version) const override;
+        std::vector<value_pointer> multiGet(const std::vector<string> &keys) const override;
+        void put(const string &key, const string &value) override;
+        void multiPut(const record_batch &records) override;
+        bool update(const string &key, const update_callback &update, const durable_callback &onDurable = nullptr,
+                    uint64_t *version = nullptr) override;
+        bool remove(const string &key) override;
+        void forEach(const record_callback &callback) const override;
+        void scan(const string &start, const string &end, const scan_callback &callback) const override;
+        size_t size() const override;
+        bool versioned() const override;
+    };
+}// namespace Diginext::Core::Storage
+
+#endif
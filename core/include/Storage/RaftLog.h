@@ -0,0 +1,104 @@
+#ifndef DIGINEXT_CORE___STORAGE_RAFT_LOG_H
+#define DIGINEXT_CORE___STORAGE_RAFT_LOG_H
+
+#include "Log/Log.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace Diginext::Core::Storage {
+
+    using namespace std;
+    using namespace Diginext::Core::Log;
+
+    /**
+     * \brief RaftLog
+     * \details durable part of a raft node: current term, vote of that term and the log entries.
+     * Every change is appended to one file of checksummed records
+     * [crc32 u32][payload length u32][type u8][fields], crc32 covers the payload, and is forced to
+     * disk before the call returns, so a node never forgets a vote or an entry it acknowledged.
+     * Conflicting entries are dropped by a truncate record, the file itself only grows.
+     * Without a path everything is kept in memory only.
+     * Not thread-safe, the server thread is the only user.
+     */
+    class RaftLog {
+    public:
+        struct Entry {
+            uint64_t term;
+            string command;///< empty - no-op of a new leader
+        };
+
+        static const uint32_t MAX_RECORD_SIZE = 1024 * 1024 * 1024;
+
+    private:
+        Logger::pointer logger;
+        string path;
+        bool syncWrites;
+        FILE *file;
+
+        uint64_t term;
+        string votedFor;
+        std::deque<Entry> entries;///< entry of index i is entries[i - 1]
+
+        void write(const string &records);
+
+    public:
+        /**
+         * @param[in] path log file, empty - in memory only
+         * @param[in] syncWrites fsync every change; false leaves flushing to the OS, a crash of
+         * the machine may then lose acknowledged entries
+         */
+        RaftLog(const string &path, bool syncWrites);
+        virtual ~RaftLog();
+
+        RaftLog(const RaftLog &) = delete;
+        RaftLog &operator=(const RaftLog &) = delete;
+
+        /**
+         * @brief read the file back and open it for append; a torn or corrupted tail is cut off
+         * @return entries read
+         */
+        size_t open();
+
+        void close();
+
+        uint64_t getTerm() const;
+        const string &getVotedFor() const;
+
+        /**
+         * @brief durably set term and vote, empty votedFor - no vote in this term yet
+         */
+        void setState(uint64_t term, const string &votedFor);
+
+        /**
+         * @brief index of the last entry, 0 - empty log
+         */
+        uint64_t lastIndex() const;
+
+        /**
+         * @brief term of the entry, 0 for index 0 and for indexes past the end
+         */
+        uint64_t termAt(uint64_t index) const;
+
+        /**
+         * @brief entry at 1 <= index <= lastIndex()
+         */
+        const Entry &at(uint64_t index) const;
+
+        /**
+         * @brief durably append entries after lastIndex(), one write and one fsync for all of them
+         */
+        void append(const std::vector<Entry> &batch);
+
+        /**
+         * @brief durably drop the entry at index and every entry after it
+         */
+        void truncate(uint64_t index);
+    };
+}// namespace Diginext::Core::Storage
+
+#endif
@@ -0,0 +1,212 @@
+#ifndef DIGINEXT_CORE___STORAGE_RAFT_NODE_H
+#define DIGINEXT_CORE___STORAGE_RAFT_NODE_H
+
+#include "Storage/RaftLog.h"
+#include "Storage/StorageCommon.h"
+#include "Storage/StorageOptions.h"
+#include "Log/Log.h"
+#include "TCP/TCP.h"
+#include "TCP/TCPConnection.h"
+
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <boost/asio.hpp>
+#include <boost/asio/steady_timer.hpp>
+
+#include <nlohmann/json.hpp>
+
+namespace Diginext::Core::Storage {
+
+    using namespace std;
+    using namespace Diginext::Core::TCP;
+    using namespace Diginext::Core::Log;
+
+    /**
+     * \brief RaftNode
+     * \details one member of a raft cluster. Commands proposed on the leader are appended to the
+     * durable RaftLog and handed to the apply callback, on every member in log order, once a
+     * majority has them on disk.
+     *
+     * The leader streams AppendEntries to each follower without waiting for answers (up to a
+     * window of messages in flight per follower), and proposals that arrive while the server
+     * thread is busy share one log write, one fsync and one message. Followers refuse to vote
+     * while they have heard from a leader within the election timeout, which gives the leader a
+     * lease: while a majority answered a message sent less than the lease ago, no other leader can
+     * exist and reads are served locally. Without a lease a read waits for one more round of
+     * answers from a majority (read index).
+     *
+     * Everything runs on the server thread: peers are reached through outgoing connections on the
+     * server's io service, their requests arrive through the server like any other request.
+     */
+    class RaftNode {
+    public:
+        enum class Role {
+            Follower,
+            Candidate,
+            Leader
+        };
+
+        typedef std::chrono::steady_clock clock;
+        typedef std::function<void(uint64_t index, const string &command)> apply_callback;
+        typedef std::function<void()> leadership_callback;
+        typedef std::function<void(bool leader)> read_callback;
+
+        struct PeerStatus {
+            string id;
+            bool connected;
+            uint64_t matchIndex;
+        };
+
+    private:
+        struct Peer {
+            string id;
+            tcp::endpoint endpoint;
+            tcp_connection::pointer connection;
+            tcp_connection::pointer closed;///< kept until its queued close has run
+            bool connected = false;
+            std::unique_ptr<boost::asio::steady_timer> reconnectTimer;
+
+            uint64_t nextIndex = 1;
+            uint64_t matchIndex = 0;
+            size_t inflight = 0;
+            uint64_t resetSeq = 0;///< answers to messages sent up to this one are stale
+            std::deque<std::pair<uint64_t, clock::time_point>> sent;///< unanswered messages
+            clock::time_point lastSent;
+            uint64_t ackedSeq = 0;
+            clock::time_point ackedAt;///< send time of the newest answered message
+            bool voteGranted = false;
+        };
+
+        struct PendingRead {
+            uint64_t seq;///< a majority must answer this message or a later one
+            read_callback callback;
+        };
+
+        Logger::pointer logger;
+        boost::asio::io_service &ios;
+        string id;
+        std::chrono::milliseconds electionTimeout;
+        size_t maxBatch;
+        tcp_framing framing;
+        apply_callback apply;
+        leadership_callback leadershipLost;
+
+        RaftLog log;
+        std::vector<Peer> peers;
+        Role role;
+        string leader;
+        uint64_t commitIndex;
+        uint64_t lastApplied;
+        uint64_t termStart;///< first index of the leader's term, reads wait until it commits
+        uint64_t seq;
+        uint64_t elections;
+
+        clock::time_point electionDeadline;
+        clock::time_point leaderContact;
+        std::unique_ptr<boost::asio::steady_timer> tickTimer;
+        std::mt19937_64 random;
+
+        std::vector<RaftLog::Entry> batch;///< proposals waiting for the next log write
+        bool flushPending;
+        std::deque<PendingRead> reads;
+
+        size_t quorum() const;
+        void resetElectionDeadline();
+        void scheduleTick();
+        void tick();
+
+        void connectPeer(size_t index);
+        void peerDown(size_t index, tcp_connection *connection);
+        void sendToPeer(Peer &peer, const nlohmann::json &message);
+
+        void becomeFollower(uint64_t term);
+        void becomeLeader();
+        void startElection();
+        void sendVoteRequest(Peer &peer);
+
+        void flush();
+        void replicate(Peer &peer);
+        void sendAppend(Peer &peer);
+        void advanceCommit();
+        void applyCommitted();
+        uint64_t quorumAckedSeq() const;
+        clock::time_point quorumAckedAt() const;
+        void serveReads();
+
+        void handleAppend(tcp_connection::pointer connection, const nlohmann::json &json);
+        void handleVote(tcp_connection::pointer connection, const nlohmann::json &json);
+        void handleAppendResult(Peer &peer, const nlohmann::json &json);
+        void handleVoteResult(Peer &peer, const nlohmann::json &json);
+
+    public:
+        typedef shared_ptr<RaftNode> pointer;
+
+        /**
+         * @param[in] ios server io service, every callback runs on its thread
+         * @param[in] options raft and fsync options
+         * @param[in] apply called for every committed command in log order
+         * @param[in] leadershipLost called when this node stops being leader, proposals not applied yet may or may not commit
+         */
+        static pointer create(boost::asio::io_service &ios, const StorageOptions &options, apply_callback apply,
+                              leadership_callback leadershipLost);
+
+        RaftNode(boost::asio::io_service &ios, const StorageOptions &options, apply_callback apply, leadership_callback leadershipLost);
+        virtual ~RaftNode();
+
+        /**
+         * \brief read the log back and start timers and peer connections
+         */
+        void start();
+
+        /**
+         * @brief append a command on the leader
+         * @return log index the command gets, 0 - this node is not the leader
+         */
+        uint64_t propose(const string &command);
+
+        /**
+         * @brief run callback(true) once a read of local state is linearizable, right away under a
+         * leader lease; callback(false) if this node is not or stops being the leader
+         */
+        void read(const read_callback &callback);
+
+        /**
+         * @brief answer raft_append / raft_vote of another member
+         */
+        void handleRequest(tcp_connection::pointer connection, const string &request, const nlohmann::json &json);
+
+        bool isLeader() const;
+
+        /**
+         * @brief the leader this node knows of, empty - none
+         */
+        const string &getLeader() const;
+
+        const string &getId() const;
+        Role getRole() const;
+        uint64_t getTerm() const;
+        uint64_t getCommitIndex() const;
+        uint64_t getLastIndex() const;
+        uint64_t getElections() const;
+        bool hasLease() const;
+        std::vector<PeerStatus> getPeers() const;
+
+        //handlers
+        void handle_peer_connected(size_t index, tcp_connection *connection);
+        void handle_peer_disconnected(size_t index, tcp_connection *connection);
+        void handle_peer_message(size_t index, tcp_connection *connection, std::string msg);
+        void handle_tick(const boost::system::error_code &error);
+    };
+
+    string raft_role_to_string(RaftNode::Role role);
+}// namespace Diginext::Core::Storage
+
+#endif
@@ -0,0 +1,79 @@
+#ifndef DIGINEXT_CORE___STORAGE_REPLICATION_LOG_H
+#define DIGINEXT_CORE___STORAGE_REPLICATION_LOG_H
+
+#include "Storage/WriteAheadLog.h"
+
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <string>
+
+namespace Diginext::Core::Storage {
+
+    using namespace std;
+
+    /**
+     * \brief ReplicationLog
+     * \details in-memory backlog of the leader's mutations in apply order. Every record gets the
+     * next position; the oldest records are dropped once the backlog outgrows its byte budget.
+     * A replica that reconnects with the log id and the last position it applied resumes from
+     * the backlog while it still covers that position, otherwise it needs a full sync.
+     * Not thread-safe, the server thread is the only user.
+     */
+    class ReplicationLog {
+    public:
+        struct Record {
+            uint64_t position;
+            WalRecordType type;
+            string key;
+            string value;
+        };
+
+        typedef std::function<void(const Record &record)> record_callback;
+
+    private:
+        string id;
+        size_t maxBytes;
+        size_t bytes;
+        uint64_t position;
+        std::deque<Record> records;
+
+        static size_t recordBytes(const Record &record);
+
+    public:
+        /**
+         * @param[in] maxBytes backlog budget, keys and values counted
+         */
+        explicit ReplicationLog(size_t maxBytes);
+
+        /**
+         * @brief random id of this log, positions of another log mean nothing here
+         */
+        const string &getId() const;
+
+        /**
+         * @brief position of the last record, 0 - none yet
+         */
+        uint64_t getPosition() const;
+
+        size_t getBytes() const;
+
+        void append(WalRecordType type, const string &key, const string &value);
+
+        /**
+         * @brief every record after the position is still in the backlog
+         */
+        bool covers(uint64_t after) const;
+
+        /**
+         * @brief records after the position, in order
+         * @param[in] after last position the reader has
+         * @param[in] maxRecords
+         * @param[in] maxBytes at least one record is read even if it is larger
+         * @return records read
+         */
+        size_t read(uint64_t after, size_t maxRecords, size_t maxBytes, const record_callback &callback) const;
+    };
+}// namespace Diginext::Core::Storage
+
+#endif
@@ -0,0 +1,80 @@
+#ifndef DIGINEXT_CORE___STORAGE_REQUEST_CODEC_H
+#define DIGINEXT_CORE___STORAGE_REQUEST_CODEC_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace Diginext::Core::Storage {
+
+    using namespace std;
+
+    /**
+     * \brief ParsedRequest
+     * \details the fields of a plain read / write request. The views point into the message, or
+     * into the buffers below when the string had escapes; valid until the next parse_request
+     * with the same object. The buffers keep their capacity, so a parse allocates nothing once
+     * they have grown to the request sizes seen.
+     */
+    struct ParsedRequest {
+        string_view request;
+        string_view key;
+        string_view value;
+        bool hasKey = false;
+        bool hasValue = false;
+        bool hasTtl = false;
+        bool hasIfVersion = false;
+        int64_t ttl = 0;
+        uint64_t ifVersion = 0;
+
+        string requestBuffer;
+        string keyBuffer;
+        string valueBuffer;
+    };
+
+    /**
+     * @brief scan a flat request object without building a DOM
+     * \details only "request", "key", "value" (strings), "ttl" and "if_version" (integers) are
+     * understood. Any other field, type or number form, invalid UTF-8 or malformed JSON makes it
+     * give up, the generic parser then takes the message and answers it as before.
+     * @return true if request holds every field of the message
+     */
+    bool parse_request(string_view message, ParsedRequest &request);
+
+    /**
+     * @brief true if text is UTF-8 nlohmann::json accepts, so a JSON string can carry it
+     */
+    bool valid_utf8(string_view text);
+
+    /**
+     * @brief append text as a JSON string, escaped the way nlohmann::json::dump does
+     */
+    void write_json_string(string &out, string_view text);
+
+    /**
+     * \brief ResponseWriter
+     * \details builds a flat answer object straight into one buffer reused for every answer.
+     * Fields go out in the order written; written in name order the text equals what
+     * nlohmann::json::dump makes of the same object.
+     */
+    class ResponseWriter {
+    private:
+        string out;
+        bool first = true;
+
+        void name(const string &field);
+
+    public:
+        ResponseWriter &begin();
+        ResponseWriter &field(const string &name, string_view value);
+        ResponseWriter &field(const string &name, uint64_t value);
+
+        /**
+         * @return the answer, valid until the next begin()
+         */
+        const string &end();
+    };
+}// namespace Diginext::Core::Storage
+
+#endif
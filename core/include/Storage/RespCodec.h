@@ -0,0 +1,176 @@
+#ifndef DIGINEXT_CORE___STORAGE_RESP_CODEC_H
+#define DIGINEXT_CORE___STORAGE_RESP_CODEC_H
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace Diginext::Core::Storage {
+
+    using namespace std;
+
+    // largest bulk string a command may carry, as in Redis
+    const size_t RESP_MAX_BULK = 512 * 1024 * 1024;
+
+    // most arguments of one command
+    const size_t RESP_MAX_ARGUMENTS = 1024 * 1024;
+
+    // longest inline command or length line
+    const size_t RESP_MAX_INLINE = 64 * 1024;
+
+    enum class resp_parse {
+        Command,   ///< getArgs() holds the next command
+        Incomplete,///< the rest of the input is part of a command not fully received yet
+        Error      ///< malformed input, getError() says why; the connection cannot be resynchronized
+    };
+
+    /**
+     * \brief RespParser
+     * \details splits a RESP2 request stream into commands: multibulk arrays of bulk strings,
+     * as clients send them, and inline commands split on spaces, as typed into telnet (no quoting).
+     * A chunk read from the socket is fed whole and every command in it is taken out in one go,
+     * the arguments are views into the chunk. Only the tail of a command cut by the read is
+     * copied, into a buffer that keeps its capacity; the next chunk completes it from that buffer
+     * and the commands behind it are parsed in the chunk again, so a batch allocates nothing once
+     * the buffers have grown to the sizes seen.
+     */
+    class RespParser {
+    private:
+        string pending;    ///< unparsed tail of earlier chunks
+        string_view input; ///< the chunk, or pending while the command cut by the last read is completed
+        string_view rest;  ///< the part of the chunk not moved into pending yet
+        bool fromPending = false;
+        size_t offset = 0; ///< start of the next command in input
+        size_t needed = 0; ///< bytes from offset input must hold before parsing again, 0 - unknown
+        size_t resumeCount = 0; ///< arguments of the multibulk cut while completing pending, 0 - none
+        size_t resumePos = 0;   ///< where its first argument not taken yet starts in input
+        std::vector<string_view> args;
+        string error;
+
+        resp_parse line(size_t pos, size_t &end);
+        resp_parse number(size_t &pos, int64_t &value, const char *what);
+        resp_parse multibulk();
+        resp_parse inlineCommand();
+        resp_parse suspend(int64_t count, size_t pos);
+        resp_parse fail(const string &description);
+        resp_parse parse();
+        resp_parse completePending();
+
+    public:
+        /**
+         * @brief start a batch, chunk must stay valid until finish()
+         */
+        void feed(string_view chunk);
+
+        /**
+         * @brief the next command of the batch
+         * @return Command with getArgs() set, Incomplete once the batch is used up
+         */
+        resp_parse next();
+
+        /**
+         * @brief end the batch, the unparsed tail is kept for the next feed; views handed out become invalid
+         */
+        void finish();
+
+        const std::vector<string_view> &getArgs() const;
+        const string &getError() const;
+
+        /**
+         * @brief bytes of a command cut by the reads, waiting for the rest
+         */
+        size_t buffered() const;
+    };
+
+    /**
+     * \brief RespReplies
+     * \details answers of one connection in command order. Each command takes a sequence number
+     * and is answered exactly once; an answer that is not the oldest one outstanding, e.g. a read
+     * served while an earlier write waits for the log, is held until the ones before it are in.
+     */
+    class RespReplies {
+    private:
+        uint64_t next = 1;
+        uint64_t head = 1;
+        string out;                    ///< in order and ready to send
+        std::map<uint64_t, string> early;
+
+    public:
+        /**
+         * @return sequence number of a new command
+         */
+        uint64_t begin();
+
+        void answer(uint64_t sequence, string_view reply);
+
+        /**
+         * @return answers ready to go out in one send, cleared by sent()
+         */
+        const string &ready() const;
+        void sent();
+
+        /**
+         * @return commands not answered yet
+         */
+        size_t waiting() const;
+    };
+
+    void resp_simple(string &out, string_view text);
+    void resp_error(string &out, string_view text);
+    void resp_integer(string &out, int64_t value);
+    void resp_bulk(string &out, string_view value);
+    void resp_null(string &out);
+    void resp_array(string &out, size_t count);
+
+    enum class resp_command {
+        Ping,
+        Echo,
+        Quit,
+        Select,
+        Command,
+        Config,
+        Client,
+        Info,
+        DbSize,
+        Get,
+        MGet,
+        Exists,
+        StrLen,
+        Set,
+        SetNx,
+        SetEx,
+        PSetEx,
+        MSet,
+        Del,
+        Incr,
+        Decr,
+        IncrBy,
+        DecrBy,
+        Append,
+        Expire,
+        PExpire,
+        Persist,
+        Ttl,
+        PTtl
+    };
+
+    struct RespCommandInfo {
+        resp_command command;
+        const char *name;///< lower case, as error messages quote it
+        int arity;       ///< arguments with the name, negative - at least that many
+        bool write;      ///< refused by a read-only replica
+    };
+
+    /**
+     * @brief the command named, in any letter case, without allocating
+     * @return nullptr if unknown
+     */
+    const RespCommandInfo *resp_command_lookup(string_view name);
+
+    bool resp_arity_ok(const RespCommandInfo &info, size_t arguments);
+}// namespace Diginext::Core::Storage
+
+#endif
@@ -0,0 +1,190 @@
+#ifndef DIGINEXT_CORE___STORAGE_SSTABLE_H
+#define DIGINEXT_CORE___STORAGE_SSTABLE_H
+
+#include "Storage/BloomFilter.h"
+#include "Storage/StorageFile.h"
+
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace Diginext::Core::Storage {
+
+    using namespace std;
+
+    enum class LookupResult {
+        NotFound,
+        Found,
+        Deleted///< key has a tombstone, older data must not be consulted
+    };
+
+    /**
+     * \brief SSTableBuilder
+     * \details writes a sorted table: [data block]*[bloom filter][index][footer];
+     * a data block is a run of (type u8, key length u32, value length u32, key, value)
+     * closed by crc32 of the block, the index holds the smallest table key and
+     * (last key, offset, size) for every block
+     */
+    class SSTableBuilder {
+    private:
+        string path;
+        FILE *file;
+        size_t blockSize;
+        size_t bitsPerKey;
+
+        string block;
+        string lastKey;
+        string smallestKey;
+        string index;
+        std::vector<uint64_t> hashes;
+        uint64_t offset;
+        uint64_t entryCount;
+        uint64_t deletedCount;
+        bool failed;
+
+        void flushBlock();
+        void writeRaw(const string &data);
+
+    public:
+        SSTableBuilder(const string &path, size_t blockSize = 4096, size_t bitsPerKey = BloomFilter::DEFAULT_BITS_PER_KEY);
+        virtual ~SSTableBuilder();
+
+        SSTableBuilder(const SSTableBuilder &) = delete;
+        SSTableBuilder &operator=(const SSTableBuilder &) = delete;
+
+        /**
+         * @brief append entry, keys must be strictly increasing
+         * @param[in] key
+         * @param[in] value
+         * @param[in] deleted tombstone
+         */
+        void add(string_view key, string_view value, bool deleted = false);
+
+        /**
+         * @brief write filter, index and footer, fsync and close; throws on I/O failure
+         * @return file size
+         */
+        uint64_t finish();
+
+        /**
+         * @brief close and remove unfinished file
+         */
+        void abandon();
+
+        uint64_t getEntryCount() const;
+
+        /**
+         * @brief bytes written so far
+         */
+        uint64_t getFileSize() const;
+    };
+
+    /**
+     * \brief SSTable
+     * \details immutable sorted table; bloom filter and block index stay in memory,
+     * so a lookup costs at most one block read and a filtered miss costs none
+     */
+    class SSTable : public std::enable_shared_from_this<SSTable> {
+    public:
+        typedef shared_ptr<SSTable> pointer;
+
+    private:
+        struct BlockHandle {
+            string lastKey;
+            uint64_t offset;
+            uint32_t size;
+        };
+
+        uint64_t number;
+        RandomAccessFile::pointer file;
+        BloomFilter filter;
+        std::vector<BlockHandle> blocks;
+        string smallestKey;
+        uint64_t entryCount;
+        uint64_t deletedCount;
+        std::atomic<bool> obsolete{false};
+
+        bool load();
+        bool readBlock(size_t index, string &block) const;
+
+    public:
+        /**
+         * @brief open table
+         * @param[in] path
+         * @param[in] number file number
+         * @return table or nullptr if file is missing or invalid
+         */
+        static pointer open(const string &path, uint64_t number);
+
+        SSTable(const string &path, uint64_t number);
+        virtual ~SSTable();
+
+        SSTable(const SSTable &) = delete;
+        SSTable &operator=(const SSTable &) = delete;
+
+        /**
+         * @brief point lookup
+         * @param[in] key
+         * @param[in] hash hash_key of key
+         * @param[out] value
+         */
+        LookupResult get(string_view key, uint64_t hash, string &value) const;
+
+        /**
+         * \brief sequential reader, keeps the table alive
+         */
+        class Iterator {
+        private:
+            SSTable::pointer table;
+            size_t blockIndex;
+            string block;
+            size_t position;
+            size_t blockEnd;
+            string_view currentKey;
+            string_view currentValue;
+            bool currentDeleted;
+            bool isValid;
+
+            bool loadBlock(size_t index);
+            void parse();
+
+        public:
+            explicit Iterator(SSTable::pointer table);
+
+            void seekToFirst();
+
+            /**
+             * @brief position at the first key >= key
+             */
+            void seek(string_view key);
+
+            bool valid() const;
+            void next();
+
+            string_view key() const;
+            string_view value() const;
+            bool deleted() const;
+        };
+
+        Iterator iterator();
+
+        /**
+         * @brief remove the file once the last reference is gone
+         */
+        void markObsolete();
+
+        uint64_t getNumber() const;
+        uint64_t getFileSize() const;
+        uint64_t getEntryCount() const;
+        uint64_t getDeletedCount() const;
+        uint64_t getReads() const;
+        const string &getSmallestKey() const;
+        const string &getLargestKey() const;
+    };
+}// namespace Diginext::Core::Storage
+
+#endif
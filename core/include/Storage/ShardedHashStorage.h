@@ -0,0 +1,349 @@
+#ifndef DIGINEXT_CORE___STORAGE_SHARDED_HASH_STORAGE_H
+#define DIGINEXT_CORE___STORAGE_SHARDED_HASH_STORAGE_H
+
+#include "Storage/BTreeIndex.h"
+#include "Storage/EpochReclamation.h"
+#include "Storage/SlabAllocator.h"
+#include "Storage/SnapshotFile.h"
+#include "Storage/VersionClock.h"
+#include "Storage/StorageEngine.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+namespace Diginext::Core::Storage {
+
+    using namespace std;
+
+    /**
+     * \brief ShardedHashStorage
+     * \details key space split into shards, every shard is an open-addressing
+     * (linear probing) hash table; shard is chosen by the high bits of the key hash,
+     * slot by the low bits.
+     *
+     * Reads never lock: slots hold atomic pointers to immutable entries, a writer
+     * (serialized per shard by a mutex) publishes a new entry or a new table and
+     * retires the old one, which is freed by epoch based reclamation.
+     *
+     * An entry is one contiguous record (hash, sizes, flags, key bytes, and the value bytes
+     * when the value is small) carved from a per-shard slab allocator, so a lookup touches
+     * one cache line or two and a small key-value pair costs one slot instead of several
+     * heap blocks. Larger values stay in a shared buffer the record points to.
+     *
+     * An attached snapshot is a read-only base layer: keys missing in memory are looked
+     * up in the mapped snapshot, removing a snapshot key leaves a deleted marker in memory.
+     *
+     * With a memory limit every shard gets an equal share of it and evicts on its own,
+     * under its own write lock: CLOCK over the slots of the hash table with a small
+     * saturating frequency per entry (bumped by reads, aged by the hand), so keys read
+     * once by a scan leave before keys read again and again. Memory is counted exactly
+     * for entries, value buffers, tables and the ordered index; the mapped base is not.
+     *
+     * Every shard also keeps its live keys in a B+tree, updated under the shard write lock,
+     * so range scans merge the shard trees instead of sorting the whole table. Base keys
+     * are added to the trees on the first scan, point reads never wait for it.
+     *
+     * Snapshots (MVCC): while any snapshot is open, a write links the entry it replaces
+     * behind the new one instead of retiring it, so every key becomes a chain of versions,
+     * newest first. A snapshot read walks the chain lock-free to the newest version not
+     * newer than its timestamp. Transactions read at a snapshot and commit all-or-nothing
+     * under the locks of the shards they touch, after checking that no key they read or
+     * write changed since. Writes cut the chain they extend below the oldest snapshot; a
+     * background collector drops every version no open snapshot reads and turns deleted
+     * markers into tombstones once no snapshot needs them.
+     */
+    class ShardedHashStorage : public StorageEngine {
+    private:
+        struct Entry {
+            static const uint8_t IN_BASE = 1;
+            static const uint8_t DELETED = 2;///< marker shadowing a base key or an older version
+            static const uint8_t SHARED_VALUE = 4;///< value_pointer follows the header
+            static const uint8_t SLAB = 8;
+            static const uint8_t CHAINED = 16;///< older version pointer follows the header
+
+            uint64_t hash;
+            uint64_t version;
+            uint32_t keySize;
+            uint32_t valueSize;
+            mutable std::atomic<uint8_t> frequency{1};///< eviction clock, new keys get one round
+            uint8_t flags;
+
+            Entry(uint64_t hash, uint64_t version, uint32_t keySize, uint32_t valueSize, uint8_t flags);
+
+            /**
+             * @brief allocate and fill a record
+             * @param[in] value nullptr - deleted marker
+             * @param[in] older previous version kept for snapshots, nullptr - none
+             */
+            static Entry *create(SlabAllocator &slab, uint64_t hash, uint64_t version, string_view key, const string *value, bool inBase,
+                                 Entry *older = nullptr);
+            static void destroy(void *entry);
+
+            bool live() const;
+            bool inBase() const;
+            Entry *older() const;
+            void setOlder(Entry *older);
+            const char *payload() const;
+            string_view key() const;
+            string_view value() const;
+            value_pointer sharedValue() const;
+            size_t bytes() const;
+        };
+
+        struct Table {
+            size_t mask;
+            std::unique_ptr<std::atomic<Entry *>[]> slots;
+
+            explicit Table(size_t capacity);
+        };
+
+        struct Shard {
+            std::mutex writeSync;
+            std::atomic<Table *> table{nullptr};
+            std::atomic<size_t> count{0};///< used slots, deleted markers included
+            std::atomic<size_t> live{0};
+            std::atomic<size_t> shadowed{0};///< memory entries (live or deleted) hiding a base key
+            size_t tombstones = 0;
+            SlabAllocator slab;///< outlives retired, which frees entries into it
+            RetireList retired;
+            BTreeIndex index;///< live keys, guarded by writeSync
+            std::atomic<size_t> bytes{0};///< entries, values, table and index
+            std::atomic<uint64_t> evictions{0};
+            size_t clockHand = 0;
+            std::atomic<size_t> history{0};///< older versions in chains and deleted markers waiting for the collector
+
+            ~Shard();
+        };
+
+        std::vector<std::unique_ptr<Shard>> shards;
+        unsigned shardBits;
+        SnapshotFile::pointer base;
+        mutable std::once_flag baseIndexed;
+        size_t memoryLimit;
+        size_t shardBudget;
+        VersionClock clock;
+        uint64_t baseVersion;///< every base key has this version until it is overwritten
+
+        mutable std::mutex snapshotSync;
+        std::multiset<uint64_t> snapshots;///< open snapshot timestamps, guarded by snapshotSync
+        std::atomic<size_t> snapshotCount{0};///< raised before a snapshot draws its timestamp
+        std::atomic<uint64_t> oldestSnapshot{NO_SNAPSHOT};
+
+        std::once_flag collectorStarted;
+        std::thread collector;
+        std::mutex collectorSync;
+        std::condition_variable collectorWake;
+        bool collectorStopping = false;
+
+        size_t shardIndex(uint64_t hash) const;
+        Shard &shardFor(uint64_t hash) const;
+        void indexBase() const;
+        value_pointer readShared(const Shard &shard, uint64_t hash, const string &key, uint64_t *version) const;
+        void store(Shard &shard, uint64_t hash, const string &key, const string &value, bool inBase, uint64_t version);
+        /**
+         * @param[in] keepHistory false - drop the entry from open snapshots too (eviction)
+         */
+        void unlink(Shard &shard, Table *table, size_t slot, Entry *current, bool keepHistory);
+        void evict(Shard &shard, const Entry *keep);
+
+        /**
+         * @brief versions at or below the horizon are unreachable, except the newest of them
+         * @details read under a shard lock, UINT64_MAX with no snapshots, 0 while one is being opened
+         */
+        uint64_t pruneHorizon() const;
+        void prune(Shard &shard, Entry *head, uint64_t horizon);
+
+        /**
+         * @brief unlink every older version no open snapshot reads, snapshots sorted
+         */
+        void compact(Shard &shard, Entry *head, const std::vector<uint64_t> &snapshots);
+        void collectShard(Shard &shard);
+        void collectorLoop();
+        void touch(const Entry *entry) const;
+
+        static Entry *tombstone();
+        static const Entry *find(const Table *table, uint64_t hash, string_view key);
+        static void insert(Shard &shard, Entry *entry);
+        static void dropHistory(Shard &shard, Entry *entry);
+        static void updateIndex(Shard &shard, const string &key, bool live);
+        static size_t entryBytes(const Entry *entry);
+        static size_t tableBytes(size_t capacity);
+
+    public:
+        static const size_t DEFAULT_SHARD_COUNT = 64;
+        static const size_t INITIAL_SHARD_CAPACITY = 16;
+        static const size_t SCAN_BATCH = 64;
+        static const uint8_t MAX_FREQUENCY = 3;
+        static const size_t INLINE_VALUE_MAX = 256;
+        static const uint64_t NO_SNAPSHOT = UINT64_MAX;
+        static const size_t COLLECT_SLICE = 1024;///< slots swept per shard lock hold
+
+        typedef shared_ptr<ShardedHashStorage> pointer;
+        static pointer create(size_t shardCount = DEFAULT_SHARD_COUNT);
+
+        explicit ShardedHashStorage(size_t shardCount = DEFAULT_SHARD_COUNT);
+        ~ShardedHashStorage() override;
+
+        ShardedHashStorage(const ShardedHashStorage &) = delete;
+        ShardedHashStorage &operator=(const ShardedHashStorage &) = delete;
+
+        /**
+         * @brief read value with single lock-free lookup
+         * @param[in] key
+         * @param[out] value
+         * @return true if key exists
+         */
+        bool get(const string &key, string &value) const override;
+
+        /**
+         * @brief read value buffer with single lock-free lookup; a small value kept
+         * inline is copied into a new buffer
+         * @param[in] key
+         * @return value buffer or nullptr if key not found
+         */
+        value_pointer getShared(const string &key) const override;
+
+        /**
+         * @brief getShared with the version of the value
+         */
+        value_pointer getVersioned(const string &key, uint64_t &version) const override;
+
+        /**
+         * @brief read several values under one epoch guard
+         * @param[in] keys
+         * @return value buffer per key, nullptr for missing keys
+         */
+        std::vector<value_pointer> multiGet(const std::vector<string> &keys) const override;
+
+        /**
+         * @brief insert or overwrite value
+         * @param[in] key
+         * @param[in] value
+         */
+        void put(const string &key, const string &value) override;
+
+        /**
+         * @brief insert or overwrite several values, records are grouped by shard
+         * and each shard lock is taken once per batch
+         * @param[in] records
+         */
+        void multiPut(const record_batch &records) override;
+
+        /**
+         * @brief read-modify-write under the shard lock, readers still see either value lock-free
+         */
+        bool update(const string &key, const update_callback &update, const durable_callback &onDurable = nullptr,
+                    uint64_t *version = nullptr) override;
+
+        /**
+         * @brief remove key
+         * @param[in] key
+         * @return true if key existed
+         */
+        bool remove(const string &key) override;
+
+        /**
+         * @brief attach snapshot as read-only base layer, call before serving requests
+         * @param[in] snapshot
+         */
+        void attachBase(SnapshotFile::pointer snapshot);
+
+        SnapshotFile::pointer getBase() const;
+
+        /**
+         * @brief bound memory usage, evicting keys once a shard is over its share;
+         * call before serving requests
+         * @param[in] bytes 0 - no limit
+         */
+        void setMemoryLimit(size_t bytes);
+
+        size_t getMemoryLimit() const;
+
+        /**
+         * @brief bytes held by entries, values, hash tables and indexes; retired
+         * entries still waiting for reclamation and the mapped base are not counted
+         */
+        size_t memoryUsage() const;
+
+        /**
+         * @brief keys evicted by the memory limit
+         */
+        uint64_t getEvictions() const;
+
+        /**
+         * @brief visit every live key (memory and unshadowed base) without blocking writers;
+         * shards are visited one by one, so concurrent writes may or may not be seen
+         * @param[in] callback
+         */
+        void forEach(const record_callback &callback) const override;
+
+        /**
+         * @brief ordered range scan, k-way merge of the shard indexes; each shard lock is
+         * taken only to copy its next batch of keys (up to SCAN_BATCH), values are read lock-free
+         */
+        void scan(const string &start, const string &end, const scan_callback &callback) const override;
+
+        /**
+         * @brief keys count
+         * @return keys count
+         */
+        size_t size() const override;
+
+        bool versioned() const override;
+
+        /**
+         * @brief open a snapshot: reads at the returned timestamp see every write made before
+         * it and none after, until releaseSnapshot
+         * @return snapshot timestamp
+         */
+        uint64_t acquireSnapshot();
+
+        void releaseSnapshot(uint64_t snapshot);
+
+        /**
+         * @brief lock-free read of the key as of the snapshot
+         * @param[in] key
+         * @param[in] snapshot open snapshot timestamp
+         * @param[out] version version of the value read, may be nullptr
+         * @return value buffer or nullptr if key did not exist at the snapshot
+         */
+        value_pointer getAt(const string &key, uint64_t snapshot, uint64_t *version = nullptr) const;
+
+        /**
+         * @brief optimistic all-or-nothing commit
+         * @param[in] snapshot timestamp the transaction read at
+         * @param[in] checked keys that must not have changed after the snapshot, the read and written keys
+         * @param[in] writes
+         * @return commit version of all writes, 0 on conflict (nothing is written)
+         */
+        uint64_t commit(uint64_t snapshot, const std::vector<string> &checked, const record_batch &writes);
+
+        size_t getSnapshotCount() const;
+
+        /**
+         * @brief older versions and deleted markers kept for open snapshots
+         */
+        size_t historySize() const;
+
+        /**
+         * @brief prune every shard now, the background collector does the same periodically
+         */
+        void collectHistory();
+
+        /**
+         * @brief shard count (always power of two)
+         * @return shard count
+         */
+        size_t getShardCount() const;
+    };
+}// namespace Diginext::Core::Storage
+
+#endif
@@ -0,0 +1,93 @@
+#ifndef DIGINEXT_CORE___STORAGE_SLAB_ALLOCATOR_H
+#define DIGINEXT_CORE___STORAGE_SLAB_ALLOCATOR_H
+
+#include <cstddef>
+#include <cstdint>
+
+namespace Diginext::Core::Storage {
+
+    /**
+     * \brief SlabAllocator
+     * \details size-class allocator for small records: every class carves fixed-size slots
+     * out of PAGE_SIZE pages aligned to PAGE_SIZE, so a slot finds its page (and owner) by
+     * masking its address and needs no per-slot header. Every class keeps a list of pages
+     * with free slots and a list of full ones; a page that becomes empty is returned unless
+     * it is the last one of its class. Not thread-safe, the owner serializes allocate and release.
+     */
+    class SlabAllocator {
+    private:
+        struct Page {
+            SlabAllocator *owner;
+            Page *prev;
+            Page *next;
+            void *freeList;///< released slots, linked through their first bytes
+            char *bump;///< slots past it were never handed out
+            char *end;
+            uint32_t used;
+            uint32_t sizeClass;
+            bool full;///< in the full list of its class, otherwise in the partial one
+        };
+
+        struct SizeClass {
+            Page *partial = nullptr;
+            Page *full = nullptr;
+            size_t pages = 0;
+        };
+
+        static const size_t CLASS_COUNT = 18;
+        static const size_t CLASS_SIZES[CLASS_COUNT];
+
+        SizeClass classes[CLASS_COUNT];
+        size_t pageCount;
+        size_t usedBytes;
+
+        static size_t classIndex(size_t size);
+
+        Page *newPage(size_t sizeClass);
+        void link(Page *page, bool full);
+        void unlink(Page *page);
+        void free(Page *page, void *slot);
+
+    public:
+        static const size_t PAGE_SIZE = 16 * 1024;
+        static const size_t MAX_SLOT_SIZE = 512;
+
+        SlabAllocator();
+        ~SlabAllocator();
+
+        SlabAllocator(const SlabAllocator &) = delete;
+        SlabAllocator &operator=(const SlabAllocator &) = delete;
+
+        /**
+         * @brief slot size that holds size bytes
+         * @param[in] size
+         * @return slot size, 0 if size is over MAX_SLOT_SIZE
+         */
+        static size_t slotSize(size_t size);
+
+        /**
+         * @brief allocate a slot, 16-byte aligned
+         * @param[in] size at most MAX_SLOT_SIZE
+         * @return slot
+         */
+        void *allocate(size_t size);
+
+        /**
+         * @brief give slot back to the allocator that handed it out
+         * @param[in] slot
+         */
+        static void release(void *slot);
+
+        /**
+         * @brief bytes in slots handed out
+         */
+        size_t getUsedBytes() const;
+
+        /**
+         * @brief pages held, times PAGE_SIZE is what the allocator takes from the system
+         */
+        size_t getPageCount() const;
+    };
+}// namespace Diginext::Core::Storage
+
+#endif
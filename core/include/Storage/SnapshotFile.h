@@ -0,0 +1,90 @@
+#ifndef DIGINEXT_CORE___STORAGE_SNAPSHOT_FILE_H
+#define DIGINEXT_CORE___STORAGE_SNAPSHOT_FILE_H
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <string_view>
+
+namespace Diginext::Core::Storage {
+
+    using namespace std;
+
+    /**
+     * \brief SnapshotFile
+     * \details read-only memory-mapped snapshot of the key space:
+     * [header][value heap: (key length u32, value length u32, key, value)...][hash index],
+     * the index is an open-addressing table of (key hash u64, record offset u64) buckets,
+     * offset 0 marks an empty bucket. Nothing is parsed on open, pages are loaded by the
+     * OS on first access.
+     */
+    class SnapshotFile {
+    public:
+        typedef shared_ptr<SnapshotFile> pointer;
+        typedef std::function<void(string_view key, string_view value)> record_callback;
+        typedef std::function<void(const record_callback &emit)> source_callback;
+
+    private:
+        string path;
+        const char *data;
+        uint64_t size;
+        uint64_t count;
+        uint64_t bucketMask;
+        uint64_t indexOffset;
+        uint64_t walOffset;
+
+#ifdef _WIN32
+        void *fileHandle;
+        void *mappingHandle;
+#endif
+
+        bool map();
+        void unmap();
+        bool record(uint64_t offset, string_view &key, string_view &value) const;
+
+    public:
+        /**
+         * @brief map snapshot file
+         * @param[in] path
+         * @return snapshot or nullptr if file is missing or invalid
+         */
+        static pointer open(const string &path);
+
+        /**
+         * @brief write snapshot from records emitted by source, atomically replaces path
+         * @param[in] path
+         * @param[in] source calls emit for every live record
+         * @param[in] walOffset write-ahead log offset the snapshot is consistent from
+         * @return written records count
+         */
+        static uint64_t write(const string &path, const source_callback &source, uint64_t walOffset = 0);
+
+        explicit SnapshotFile(const string &path);
+        virtual ~SnapshotFile();
+
+        SnapshotFile(const SnapshotFile &) = delete;
+        SnapshotFile &operator=(const SnapshotFile &) = delete;
+
+        /**
+         * @brief lookup key through the mapped index
+         * @param[in] key
+         * @param[out] value view into the mapping, valid while snapshot is alive
+         * @return true if key exists
+         */
+        bool find(string_view key, string_view &value) const;
+
+        bool contains(string_view key) const;
+
+        /**
+         * @brief visit every record in heap order
+         */
+        void forEach(const record_callback &callback) const;
+
+        uint64_t getCount() const;
+        uint64_t getWalOffset() const;
+        string getPath() const;
+    };
+}// namespace Diginext::Core::Storage
+
+#endif
@@ -1,21 +1,26 @@
 #ifndef DIGINEXT_CORE___STORAGE_STORAGE_CLIENT_H
 #define DIGINEXT_CORE___STORAGE_STORAGE_CLIENT_H
 
+#include "Storage/HashRing.h"
 #include "Storage/StorageCommon.h"
 #include "Log/Log.h"
 #include "TCP/TCP.h"
 #include "TCP/TCPClient.h"
 
-#include <memory>
-#include <string>
-
+#include <atomic>
+#include <condition_variable>
+#include <functional>
 #include <map>
+#include <memory>
 #include <mutex>
 #include <string>
+#include <vector>
 
 #include <boost/asio.hpp>
 #include <boost/asio/ip/tcp.hpp>
 
+#include <nlohmann/json.hpp>
+
 namespace Diginext::Core::Storage {
 
     using namespace std;
@@ -24,31 +29,148 @@ namespace Diginext::Core::Storage {
 
     /**
     * \brief StorageClient
+     * \details client of one or many StorageServer instances. Keys are spread over the servers
+     * with a consistent-hash ring (HashRing), so adding or removing a server moves only the keys
+     * the ring hands over. Every server has one persistent connection, opened on first use and
+     * reopened after a failure. mget / mput are split per server and the parts are sent to all
+     * of them before waiting for any answer. Requests without a key (stats, scan, ...) go to
+     * every server.
+     * Change events of watch subscriptions are not answers, they go to the event handler.
+     * Thread-safe. In binary framing every request carries an id the server echoes on its answers,
+     * so any number of callers share a connection with their requests in flight at once and the
+     * server answers them in whatever order they finish. In base64 framing answers carry no id and
+     * a connection takes one request at a time.
      */
     class StorageClient
     {
+    public:
+        /**
+         * \brief change event of a watch, runs on the connection's io thread
+         */
+        typedef std::function<void(const string &endpoint, const nlohmann::json &event)> event_callback;
+
     private:
+        /**
+         * \brief request in flight
+         */
+        struct Call {
+            std::vector<nlohmann::json> messages;///< its answer, several for a scan
+            bool complete = false;               ///< answered, or failed with no messages
+            std::condition_variable done;
+        };
+
+        struct Shard {
+            string id;///< host:port, also its name on the ring
+            tcp::endpoint endpoint;
+            tcp_client::pointer client;
+
+            std::mutex connectSync;///< held while the connection is checked, opened or dropped
+            std::mutex orderSync;  ///< base64 framing only: held from send until the answer is in
+
+            std::mutex sync;
+            std::condition_variable wake;
+            bool connected = false;
+            bool linkDown = false;
+            bool tagged = false;          ///< binary framing, answers carry the request id
+            uint64_t link = 0;            ///< bumped per connection, a call sent on an old one is not awaited
+            std::map<uint64_t, Call> calls;///< in flight, by request id
+        };
+
+        typedef shared_ptr<Shard> shard_pointer;
+
+        /**
+         * \brief a sent request, what receiveFrom waits for
+         */
+        struct Ticket {
+            shard_pointer shard;
+            uint64_t id = 0;                   ///< 0 - not sent
+            uint64_t link = 0;
+            std::unique_lock<std::mutex> order;///< orderSync of a base64 connection
+        };
+
         Logger::pointer logger;
-        tcp_client::pointer tcpClient;
-        string host;
-        unsigned short port;
+        mutable std::mutex ringSync;
+        HashRing ring;
+        std::map<string, shard_pointer> shards;
+        mutable std::mutex answerSync;
         string answer;
+        std::mutex eventSync;
+        event_callback onEvent;
+        std::atomic<tcp_framing> framing;
+        std::atomic<uint64_t> nextRequestId;
+
+        void deliverEvent(Shard &shard, const nlohmann::json &event);
+
+        shard_pointer shardOf(const string &key);
+        std::vector<shard_pointer> allShards() const;
+
+        void beginConnect(Shard &shard);
+        bool waitConnected(Shard &shard);
+        void dropConnection(Shard &shard);
+        void failCalls(Shard &shard);
+
+        /**
+         * @brief connect if needed and send, the answer is left for receiveFrom
+         * @return ticket with id 0 if not connected, request not sent
+         */
+        Ticket sendTo(const shard_pointer &shard, const nlohmann::json &request);
+
+        /**
+         * @brief wait for the answer to a ticket, error json on timeout or disconnect
+         */
+        nlohmann::json receiveFrom(Ticket &ticket);
+
+        nlohmann::json requestOne(const shard_pointer &shard, const nlohmann::json &request);
+        nlohmann::json requestSplit(const nlohmann::json &request, const string &field);
+        nlohmann::json requestAll(const nlohmann::json &request);
 
     public:
         typedef shared_ptr<StorageClient> pointer;
+
         static pointer create(const string &host = LOCAL_ADDRESS_TCP_V6, const unsigned short port = DEFAULT_PORT);
 
+        /**
+         * @param[in] endpoints servers as "host:port", host an IP address ("[::1]:port" or "::1:port" for IPv6)
+         * @param[in] vnodes ring points per server, more points spread keys more evenly
+         */
+        static pointer create(const std::vector<string> &endpoints, size_t vnodes = HashRing::DEFAULT_VNODES);
+
         StorageClient(const string &host = LOCAL_ADDRESS_TCP_V6, const unsigned short port = DEFAULT_PORT);
-        virtual ~StorageClient() = default;
+        StorageClient(const std::vector<string> &endpoints, size_t vnodes = HashRing::DEFAULT_VNODES);
+        virtual ~StorageClient();
+
+        /**
+         * @brief add a server to the ring, it takes over its share of the keys
+         * @return false - already there
+         */
+        bool addEndpoint(const string &endpoint);
+
+        /**
+         * @brief remove a server from the ring, its keys move to the remaining servers
+         * @return false - not there
+         */
+        bool removeEndpoint(const string &endpoint);
+
+        std::vector<string> getEndpoints() const;
+
+        /**
+         * @brief server a key is routed to
+         */
+        string locate(const string &key) const;
 
         /**
         * @brief client status
-        * \return true | false
+        * \return true if connected to every server
         */
         bool Started() const;
 
         /**
-         * @brief connect
+         * @brief framing asked for by connections made from now on, each server grants it or less
+         */
+        void setFraming(tcp_framing framing);
+
+        /**
+         * @brief connect to every server
          */
         void Connect();
 
@@ -58,8 +180,44 @@ namespace Diginext::Core::Storage {
         void Disconnect();
 
         /**
-         * @brief send message to server
-         * @param[in] msg
+         * @brief send a request and wait for its answer
+         * @details a request with key goes to the key's server; mget / mput are split per server
+         * and answered as one message (values in request order, mput ok once every part is);
+         * anything else is sent to every server and answered as
+         * {"status":"ok","shards":{"host:port":answer}} (the plain answer with one server).
+         * The answer to a streamed scan is one message with all items.
+         * @param[in] request
+         * @return answer, {"status":"error",...} if a server does not answer
+         */
+        nlohmann::json request(const nlohmann::json &request);
+
+        /**
+         * @brief send every request before waiting for any answer
+         * @details requests with key are all on the wire at once, in binary framing the servers work
+         * on them together and may finish them in any order; the others, and the next request to a
+         * base64 connection, wait for the answers before them. Writes to one key are applied in
+         * request order.
+         * @return answers in request order, as request() gives them
+         */
+        std::vector<nlohmann::json> pipeline(const std::vector<nlohmann::json> &requests);
+
+        /**
+         * @brief hottest keys over every server, from their stats, for caching and placement decisions
+         * @param[in] limit at most that many
+         * @return [{"key":..,"shard":"host:port","accesses":..,"reads":..,"writes":..}] hottest first,
+         * empty where servers run without hot key tracking
+         */
+        nlohmann::json hotKeys(size_t limit = 32);
+
+        /**
+         * @brief handler of watch events; a lost connection is reported as {"event":"disconnected"},
+         * its watches are gone and have to be sent again
+         */
+        void setEventHandler(const event_callback &handler);
+
+        /**
+         * @brief send message to server, the answer is kept for getAnswer
+         * @param[in] msg json request
          */
         void send(const std::string& msg);
 
@@ -70,13 +228,13 @@ namespace Diginext::Core::Storage {
         string getAnswer() const;
 
         //handlers
-        void handle_connection_timed_oud(tcp::endpoint &endpoint);
-        void handle_connection_error(tcp::endpoint &endpoint, const boost::system::error_code &ec);
-        void handle_connection_success(tcp::endpoint &endpoint);
-        void handle_disconnected();
-        void handle_read_message(std::string msg);
-        void handle_read_error(const boost::system::error_code error, size_t bytes_transferred);
-        void handle_send_error(const boost::system::error_code error, size_t bytes_transferred);
+        void handle_connection_timed_oud(Shard *shard, tcp::endpoint &endpoint);
+        void handle_connection_error(Shard *shard, tcp::endpoint &endpoint, const boost::system::error_code &ec);
+        void handle_connection_success(Shard *shard, tcp::endpoint &endpoint);
+        void handle_disconnected(Shard *shard);
+        void handle_read_message(Shard *shard, uint64_t requestId, std::string msg);
+        void handle_read_error(Shard *shard, const boost::system::error_code error, size_t bytes_transferred);
+        void handle_send_error(Shard *shard, const boost::system::error_code error, size_t bytes_transferred);
     };
 }
 
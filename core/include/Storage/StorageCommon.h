@@ -11,13 +11,90 @@ namespace Diginext::Core::Storage {
             const std::string VALUE = "value";
             const std::string STATUS = "status";
             const std::string DESCRIPTION = "description";
+            const std::string PREFIX = "prefix";
+            const std::string START = "start";
+            const std::string END = "end";
+            const std::string LIMIT = "limit";
+            const std::string CURSOR = "cursor";
+            const std::string ITEMS = "items";
+            const std::string FINAL = "final";
+            const std::string TTL = "ttl";
+            const std::string EXPIRE_AT = "expire_at";
+            const std::string STATS = "stats";
+            const std::string KEYS = "keys";
+            const std::string VALUES = "values";
+            const std::string BY = "by";
+            const std::string EXPECTED = "expected";
+            const std::string SWAPPED = "swapped";
+            const std::string LENGTH = "length";
+            const std::string VERSION = "version";
+            const std::string IF_VERSION = "if_version";
+            const std::string TXN = "txn";
+            const std::string SNAPSHOT = "snapshot";
+            const std::string REPLICATION = "replication";
+            const std::string REPLICATION_ID = "replication_id";
+            const std::string POSITION = "position";
+            const std::string HEAD = "head";
+            const std::string RECORDS = "records";
+            const std::string RAFT = "raft";
+            const std::string TERM = "term";
+            const std::string LEADER = "leader";
+            const std::string CANDIDATE = "candidate";
+            const std::string FROM = "from";
+            const std::string SEQ = "seq";
+            const std::string PREV_INDEX = "prev_index";
+            const std::string PREV_TERM = "prev_term";
+            const std::string LAST_INDEX = "last_index";
+            const std::string LAST_TERM = "last_term";
+            const std::string COMMIT_INDEX = "commit_index";
+            const std::string ENTRIES = "entries";
+            const std::string COMMAND = "command";
+            const std::string SUCCESS = "success";
+            const std::string MATCH = "match";
+            const std::string GRANTED = "granted";
+            const std::string SHARD = "shard";
+            const std::string SHARDS = "shards";
+            const std::string EVENT = "event";
+            const std::string DROPPED = "dropped";
+            const std::string WATCH = "watch";
         }
 
         namespace VALUE {
             const std::string STATUS_OK = "ok";
             const std::string STATUS_ERROR = "error";
+            const std::string STATUS_NOT_MODIFIED = "not_modified";
             const std::string REQUEST_READ = "read";
             const std::string REQUEST_WRITE = "write";
+            const std::string REQUEST_SNAPSHOT = "snapshot";
+            const std::string REQUEST_SCAN = "scan";
+            const std::string REQUEST_EXPIRE = "expire";
+            const std::string REQUEST_PERSIST = "persist";
+            const std::string REQUEST_STATS = "stats";
+            const std::string REQUEST_MGET = "mget";
+            const std::string REQUEST_MPUT = "mput";
+            const std::string REQUEST_INCR = "incr";
+            const std::string REQUEST_DECR = "decr";
+            const std::string REQUEST_CAS = "cas";
+            const std::string REQUEST_APPEND = "append";
+            const std::string REQUEST_BEGIN = "begin";
+            const std::string REQUEST_COMMIT = "commit";
+            const std::string REQUEST_ABORT = "abort";
+            const std::string REQUEST_REPLICATE = "replicate";
+            const std::string REQUEST_REPLICATE_ACK = "replicate_ack";
+            const std::string REPLICATION_FULL = "full";
+            const std::string REPLICATION_PARTIAL = "partial";
+            const std::string REPLICATION_ITEMS = "items";
+            const std::string REPLICATION_SYNCED = "synced";
+            const std::string REPLICATION_RECORDS = "records";
+            const std::string REQUEST_RAFT_APPEND = "raft_append";
+            const std::string REQUEST_RAFT_VOTE = "raft_vote";
+            const std::string RAFT_APPEND = "append";
+            const std::string RAFT_VOTE = "vote";
+            const std::string REQUEST_WATCH = "watch";
+            const std::string REQUEST_UNWATCH = "unwatch";
+            const std::string EVENT_PUT = "put";
+            const std::string EVENT_DELETE = "delete";
+            const std::string EVENT_OVERFLOW = "overflow";
         }
     }
 }
@@ -0,0 +1,48 @@
+#ifndef DIGINEXT_CORE___STORAGE_STORAGE_ENCODING_H
+#define DIGINEXT_CORE___STORAGE_STORAGE_ENCODING_H
+
+#include <cstdint>
+#include <string>
+
+namespace Diginext::Core::Storage {
+
+    // fixed width little-endian integers for on-disk formats
+
+    inline void put_fixed32(std::string &out, uint32_t value) {
+        char buffer[4];
+        for (int i = 0; i < 4; i++) {
+            buffer[i] = static_cast<char>((value >> (8 * i)) & 0xFF);
+        }
+        out.append(buffer, 4);
+    }
+
+    inline void put_fixed64(std::string &out, uint64_t value) {
+        char buffer[8];
+        for (int i = 0; i < 8; i++) {
+            buffer[i] = static_cast<char>((value >> (8 * i)) & 0xFF);
+        }
+        out.append(buffer, 8);
+    }
+
+    inline uint32_t get_fixed32(const char *data) {
+        const auto *p = reinterpret_cast<const unsigned char *>(data);
+        return uint32_t(p[0]) | (uint32_t(p[1]) << 8) | (uint32_t(p[2]) << 16) | (uint32_t(p[3]) << 24);
+    }
+
+    inline uint64_t get_fixed64(const char *data) {
+        return uint64_t(get_fixed32(data)) | (uint64_t(get_fixed32(data + 4)) << 32);
+    }
+
+    inline void set_fixed32(char *data, uint32_t value) {
+        for (int i = 0; i < 4; i++) {
+            data[i] = static_cast<char>((value >> (8 * i)) & 0xFF);
+        }
+    }
+
+    inline void set_fixed64(char *data, uint64_t value) {
+        set_fixed32(data, static_cast<uint32_t>(value));
+        set_fixed32(data + 4, static_cast<uint32_t>(value >> 32));
+    }
+}// namespace Diginext::Core::Storage
+
+#endif
@@ -0,0 +1,177 @@
+#ifndef DIGINEXT_CORE___STORAGE_STORAGE_ENGINE_H
+#define DIGINEXT_CORE___STORAGE_STORAGE_ENGINE_H
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace Diginext::Core::Storage {
+
+    using namespace std;
+
+    /**
+     * \brief immutable, refcounted value buffer
+     * \details a reader may keep sending it while a writer already replaced the key
+     */
+    typedef shared_ptr<const string> value_pointer;
+
+    /**
+     * \brief StorageEngine
+     * \details key-value engine behind StorageServer requests
+     */
+    class StorageEngine {
+    public:
+        typedef shared_ptr<StorageEngine> pointer;
+        typedef std::function<void(string_view key, string_view value)> record_callback;
+        typedef std::function<bool(string_view key, string_view value)> scan_callback;
+        typedef std::function<void(bool durable)> durable_callback;
+        typedef std::vector<std::pair<string, string>> record_batch;
+        typedef std::function<bool(bool exists, string_view current, uint64_t version, string &updated)> update_callback;
+
+        virtual ~StorageEngine() = default;
+
+        /**
+         * @brief read value
+         * @param[in] key
+         * @param[out] value
+         * @return true if key exists
+         */
+        virtual bool get(const string &key, string &value) const = 0;
+
+        /**
+         * @brief read value buffer
+         * @param[in] key
+         * @return value buffer or nullptr if key not found
+         */
+        virtual value_pointer getShared(const string &key) const = 0;
+
+        /**
+         * @brief read value buffer and its version
+         * @param[in] key
+         * @param[out] version 0 if engine is not versioned or key not found
+         * @return value buffer or nullptr if key not found
+         */
+        virtual value_pointer getVersioned(const string &key, uint64_t &version) const {
+            version = 0;
+            return this->getShared(key);
+        }
+
+        /**
+         * @brief read several values
+         * @param[in] keys
+         * @return value buffer per key, nullptr for missing keys
+         */
+        virtual std::vector<value_pointer> multiGet(const std::vector<string> &keys) const {
+            std::vector<value_pointer> values;
+            values.reserve(keys.size());
+            for (const auto &key : keys) {
+                values.push_back(this->getShared(key));
+            }
+
+            return values;
+        }
+
+        /**
+         * @brief insert or overwrite value
+         * @param[in] key
+         * @param[in] value
+         */
+        virtual void put(const string &key, const string &value) = 0;
+
+        /**
+         * @brief insert or overwrite value, onDurable is called once the write survives a restart;
+         * engines without own persistence call it right away
+         * @param[in] key
+         * @param[in] value
+         * @param[in] onDurable
+         */
+        virtual void putDurable(const string &key, const string &value, const durable_callback &onDurable) {
+            this->put(key, value);
+            if (onDurable) {
+                onDurable(true);
+            }
+        }
+
+        /**
+         * @brief insert or overwrite several values, engines take each of their locks once per batch
+         * @param[in] records key-value pairs, a key repeated in the batch keeps its last value
+         */
+        virtual void multiPut(const record_batch &records) {
+            for (const auto &record : records) {
+                this->put(record.first, record.second);
+            }
+        }
+
+        /**
+         * @brief multiPut with one onDurable call for the whole batch, see putDurable
+         * @param[in] records
+         * @param[in] onDurable
+         */
+        virtual void multiPutDurable(const record_batch &records, const durable_callback &onDurable) {
+            this->multiPut(records);
+            if (onDurable) {
+                onDurable(true);
+            }
+        }
+
+        /**
+         * @brief atomic read-modify-write of one key, no other write of the key runs in between
+         * @param[in] key
+         * @param[in] update gets the current value (exists false - missing key) with its version and
+         * fills the new one; returns false to leave the key unchanged
+         * @param[in] onDurable called only if the key was written, see putDurable
+         * @param[out] version version of the written value, 0 if engine is not versioned
+         * @return true if the key was written
+         */
+        virtual bool update(const string &key, const update_callback &update, const durable_callback &onDurable = nullptr,
+                            uint64_t *version = nullptr) = 0;
+
+        /**
+         * @brief remove key
+         * @param[in] key
+         * @return true if key existed
+         */
+        virtual bool remove(const string &key) = 0;
+
+        /**
+         * @brief visit every live key, concurrent writes may or may not be seen
+         * @param[in] callback
+         */
+        virtual void forEach(const record_callback &callback) const = 0;
+
+        /**
+         * @brief visit keys in [start, end) in ascending order
+         * @param[in] start
+         * @param[in] end empty - no upper bound
+         * @param[in] callback return false to stop
+         */
+        virtual void scan(const string &start, const string &end, const scan_callback &callback) const = 0;
+
+        /**
+         * @brief keys count
+         * @return keys count
+         */
+        virtual size_t size() const = 0;
+
+        /**
+         * @brief engine keeps its data across restarts by itself,
+         * server write-ahead log and snapshots are not used for it
+         */
+        virtual bool persistent() const {
+            return false;
+        }
+
+        /**
+         * @brief engine keeps a version per key, see VersionClock; every write gets a new one
+         */
+        virtual bool versioned() const {
+            return false;
+        }
+    };
+}// namespace Diginext::Core::Storage
+
+#endif
@@ -0,0 +1,28 @@
+#ifndef DIGINEXT_CORE___STORAGE_STORAGE_ENGINE_FACTORY_H
+#define DIGINEXT_CORE___STORAGE_STORAGE_ENGINE_FACTORY_H
+
+#include "Storage/StorageEngine.h"
+#include "Storage/StorageOptions.h"
+
+#include <string>
+#include <vector>
+
+namespace Diginext::Core::Storage {
+
+    /**
+     * @brief names accepted by create_storage_engine
+     */
+    std::vector<std::string> storage_engine_names();
+
+    bool storage_engine_exists(const std::string &name);
+
+    /**
+     * @brief create engine named by options.engine:
+     * "map" - MapStorageEngine, "hash" - ShardedHashStorage, "lsm" - LsmStorage in options.dataDir
+     * @param[in] options
+     * @return engine, throws std::invalid_argument for unknown names
+     */
+    StorageEngine::pointer create_storage_engine(const StorageOptions &options);
+}// namespace Diginext::Core::Storage
+
+#endif
@@ -0,0 +1,112 @@
+#ifndef DIGINEXT_CORE___STORAGE_STORAGE_FILE_H
+#define DIGINEXT_CORE___STORAGE_STORAGE_FILE_H
+
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <string>
+
+namespace Diginext::Core::Storage {
+
+    /**
+     * @brief file exists
+     * @param[in] path
+     */
+    bool file_exists(const std::string &path);
+
+    /**
+     * @brief file size in bytes, 0 if file does not exist
+     * @param[in] path
+     */
+    uint64_t file_size(const std::string &path);
+
+    /**
+     * @brief cut file to size bytes
+     * @param[in] path
+     * @param[in] size
+     * @return true on success
+     */
+    bool file_truncate(const std::string &path, uint64_t size);
+
+    /**
+     * @brief flush stdio buffers and force file data to stable storage
+     * @param[in] file
+     * @return true on success
+     */
+    bool file_sync(FILE *file);
+
+    /**
+     * @brief atomically replace target with source (rename)
+     * @param[in] source
+     * @param[in] target
+     * @return true on success
+     */
+    bool file_replace(const std::string &source, const std::string &target);
+
+    /**
+     * @brief remove file if exists
+     * @param[in] path
+     */
+    void file_remove(const std::string &path);
+
+    /**
+     * @brief create directory if it does not exist (parent must exist)
+     * @param[in] path
+     * @return true if directory exists after the call
+     */
+    bool directory_create(const std::string &path);
+
+    /**
+     * \brief RandomAccessFile
+     * \details read-only file for positional reads from many threads at once
+     * (pread / overlapped ReadFile), no shared file position
+     */
+    class RandomAccessFile {
+    private:
+        std::string path;
+        uint64_t size;
+        mutable std::atomic<uint64_t> reads{0};
+
+#ifdef _WIN32
+        void *handle;
+#else
+        int fd;
+#endif
+
+    public:
+        typedef std::shared_ptr<RandomAccessFile> pointer;
+
+        /**
+         * @brief open file for reading
+         * @param[in] path
+         * @return file or nullptr if it cannot be opened
+         */
+        static pointer open(const std::string &path);
+
+        explicit RandomAccessFile(const std::string &path);
+        virtual ~RandomAccessFile();
+
+        RandomAccessFile(const RandomAccessFile &) = delete;
+        RandomAccessFile &operator=(const RandomAccessFile &) = delete;
+
+        /**
+         * @brief read size bytes at offset
+         * @param[in] offset
+         * @param[in] size
+         * @param[out] out
+         * @return false on error or short read
+         */
+        bool read(uint64_t offset, size_t size, std::string &out) const;
+
+        /**
+         * @brief reads issued so far
+         */
+        uint64_t getReads() const;
+
+        uint64_t getSize() const;
+        std::string getPath() const;
+    };
+}// namespace Diginext::Core::Storage
+
+#endif
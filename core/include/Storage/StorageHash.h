@@ -0,0 +1,39 @@
+#ifndef DIGINEXT_CORE___STORAGE_STORAGE_HASH_H
+#define DIGINEXT_CORE___STORAGE_STORAGE_HASH_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace Diginext::Core::Storage {
+
+    /**
+     * @brief 64-bit key hash
+     * @details FNV-1a with a murmur3 finalizer, so both the high bits (shard choice)
+     * and the low bits (slot choice) are well mixed
+     * @param[in] data
+     * @param[in] size
+     * @param[in] seed
+     * @return hash
+     */
+    inline uint64_t hash_key(const char *data, size_t size, uint64_t seed = 0) {
+        uint64_t hash = 14695981039346656037ULL ^ seed;
+        for (size_t i = 0; i < size; i++) {
+            hash ^= static_cast<unsigned char>(data[i]);
+            hash *= 1099511628211ULL;
+        }
+
+        hash ^= hash >> 33;
+        hash *= 0xff51afd7ed558ccdULL;
+        hash ^= hash >> 33;
+        hash *= 0xc4ceb9fe1a85ec53ULL;
+        hash ^= hash >> 33;
+        return hash;
+    }
+
+    inline uint64_t hash_key(const std::string &key, uint64_t seed = 0) {
+        return hash_key(key.data(), key.size(), seed);
+    }
+}// namespace Diginext::Core::Storage
+
+#endif
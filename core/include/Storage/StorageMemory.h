@@ -0,0 +1,46 @@
+#ifndef DIGINEXT_CORE___STORAGE_STORAGE_MEMORY_H
+#define DIGINEXT_CORE___STORAGE_STORAGE_MEMORY_H
+
+#include <cstddef>
+#include <memory>
+#include <string>
+
+namespace Diginext::Core::Storage {
+
+    using namespace std;
+
+    /**
+     * @brief heap buffer of string, 0 for short strings kept inline
+     * @param[in] value
+     * @return bytes
+     */
+    inline size_t string_heap_bytes(const string &value) {
+        const char *data = value.data();
+        const char *object = reinterpret_cast<const char *>(&value);
+        if (data >= object && data < object + sizeof(string)) {
+            return 0;
+        }
+
+        return value.capacity() + 1;
+    }
+
+    /**
+     * @brief one make_shared<const string> allocation: control block, string object, heap buffer
+     * @param[in] value
+     * @return bytes
+     */
+    inline size_t shared_string_bytes(const string &value) {
+        // the control block of make_shared: vtable pointer, use and weak counts
+        return sizeof(void *) + 2 * sizeof(int) + sizeof(string) + string_heap_bytes(value);
+    }
+
+    /**
+     * @brief parse size with optional k/m/g suffix (powers of 1024), e.g. "512mb", "2g"
+     * @param[in] text
+     * @param[out] bytes
+     * @return false if text is not a size
+     */
+    bool memory_size_from_string(const string &text, size_t &bytes);
+}// namespace Diginext::Core::Storage
+
+#endif
@@ -0,0 +1,121 @@
+#ifndef DIGINEXT_CORE___STORAGE_STORAGE_OPTIONS_H
+#define DIGINEXT_CORE___STORAGE_STORAGE_OPTIONS_H
+
+#include "Storage/WatchRegistry.h"
+#include "Storage/WriteAheadLog.h"
+#include "TCP/TCP.h"
+
+#include <chrono>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace Diginext::Core::Storage {
+
+    /**
+     * \brief StorageServer options
+     */
+    struct StorageOptions {
+        /**
+         * \brief storage engine, see create_storage_engine
+         */
+        std::string engine = "hash";
+
+        /**
+         * \brief data directory of on-disk engines
+         */
+        std::string dataDir = "diginext-data";
+
+        /**
+         * \brief write-ahead log file, empty - in-memory only
+         */
+        std::string walPath;
+
+        FsyncPolicy fsyncPolicy = FsyncPolicy::GroupCommit;
+
+        std::chrono::microseconds groupCommitWindow = std::chrono::microseconds(2000);
+
+        /**
+         * \brief memory-mapped snapshot file, empty - no snapshots
+         */
+        std::string snapshotPath;
+
+        /**
+         * \brief memory limit in bytes for the hash engine, keys are evicted past it; 0 - no limit
+         */
+        size_t maxMemory = 0;
+
+        /**
+         * \brief leader to follow, empty - this server takes writes itself
+         */
+        std::string replicaOfHost;
+
+        unsigned short replicaOfPort = 0;
+
+        /**
+         * \brief replication backlog in bytes, replicas disconnected for longer need a full sync
+         */
+        size_t replicationBacklog = size_t(64) << 20;
+
+        /**
+         * \brief this node in a raft cluster, the host:port peers and clients reach it at; empty - no cluster
+         */
+        std::string raftId;
+
+        /**
+         * \brief the other members of the raft cluster, host:port each
+         */
+        std::vector<std::string> raftPeers;
+
+        /**
+         * \brief raft log file, empty - in memory only, a restarted node rejoins with an empty log
+         */
+        std::string raftLogPath;
+
+        /**
+         * \brief a follower that hears nothing from the leader for this long, plus a random part of
+         * up to as much again, starts an election; the leader lease is a bit shorter
+         */
+        std::chrono::milliseconds raftElectionTimeout = std::chrono::milliseconds(300);
+
+        /**
+         * \brief most log entries per raft log write and per AppendEntries message
+         */
+        size_t raftBatch = 256;
+
+        /**
+         * \brief bytes a watching connection may have queued before its change events overflow
+         */
+        size_t watchQueueLimit = size_t(1) << 20;
+
+        WatchOverflowPolicy watchOverflow = WatchOverflowPolicy::Drop;
+
+        /**
+         * \brief keys in the hot key list of stats; 0 - no tracking
+         */
+        size_t hotKeys = 32;
+
+        /**
+         * \brief one read or write in hotKeySample on average feeds the hot key tracker
+         */
+        size_t hotKeySample = 16;
+
+        /**
+         * \brief framing asked for on connections this server opens, to its leader and raft peers;
+         * anything above Base64Line needs those to understand the hello, upgrade them first
+         */
+        TCP::tcp_framing framing = TCP::tcp_framing::Base64Line;
+
+        /**
+         * \brief best framing an accepted connection may negotiate, one without a hello stays Base64Line
+         */
+        TCP::tcp_framing acceptFraming = TCP::tcp_best_framing();
+
+        /**
+         * \brief second listen port speaking RESP2, on the same address and io thread as the native one; 0 - none
+         */
+        unsigned short respPort = 0;
+    };
+}// namespace Diginext::Core::Storage
+
+#endif
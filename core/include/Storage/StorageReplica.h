@@ -0,0 +1,127 @@
+#ifndef DIGINEXT_CORE___STORAGE_STORAGE_REPLICA_H
+#define DIGINEXT_CORE___STORAGE_STORAGE_REPLICA_H
+
+#include "Storage/StorageCommon.h"
+#include "Storage/StorageEngine.h"
+#include "Log/Log.h"
+#include "TCP/TCP.h"
+#include "TCP/TCPClient.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include <nlohmann/json.hpp>
+
+namespace Diginext::Core::Storage {
+
+    using namespace std;
+    using namespace Diginext::Core::TCP;
+    using namespace Diginext::Core::Log;
+
+    /**
+     * \brief StorageReplica
+     * \details follower side of replication: keeps a connection to the leader, applies its
+     * ordered mutation stream to the local engine and acknowledges every applied batch, which
+     * lets the leader send more. After a disconnect it reconnects with the leader's log id and
+     * the last applied position and resumes from the leader's backlog; only a new leader or a
+     * position the backlog no longer covers costs a full copy of the data set.
+     * Key deadlines are not the engine's, they go to the deadline handler.
+     */
+    class StorageReplica {
+    public:
+        typedef std::vector<std::pair<string, uint64_t>> deadline_batch;///< key and wall-clock deadline, 0 - none
+        typedef std::function<void(deadline_batch deadlines)> deadline_callback;
+
+        enum class State {
+            Connecting,
+            Syncing,///< full copy in progress, reads may see a mix of old and new data
+            Online
+        };
+
+    private:
+        Logger::pointer logger;
+        StorageEngine::pointer storage;
+        string host;
+        unsigned short port;
+        tcp_framing framing;
+        deadline_callback deadlineHandler;
+
+        std::thread worker;
+        std::mutex sync;
+        std::condition_variable wake;
+        bool stopping;
+        bool linkDown;///< set by connection handlers, the worker reconnects
+
+        // stream state, touched by the thread of the current connection only
+        tcp_client::pointer client;
+        string replicationId;
+        std::unordered_set<string> stale;///< local keys a running full sync has not sent yet
+
+        std::atomic<uint64_t> position;
+        std::atomic<uint64_t> leaderPosition;
+        std::atomic<uint64_t> fullSyncs;
+        std::atomic<uint64_t> partialSyncs;
+        std::atomic<State> state;
+
+        void run();
+        void setLinkDown();
+        void applyRecords(const nlohmann::json &json);
+
+    public:
+        typedef shared_ptr<StorageReplica> pointer;
+        static pointer create(StorageEngine::pointer storage, const string &host, unsigned short port,
+                              tcp_framing framing = tcp_framing::Base64Line);
+
+        StorageReplica(StorageEngine::pointer storage, const string &host, unsigned short port, tcp_framing framing = tcp_framing::Base64Line);
+        virtual ~StorageReplica();
+
+        /**
+         * @brief called from the connection thread with the deadlines of every applied message,
+         * in stream order, right after its data; set before start
+         */
+        void setDeadlineHandler(const deadline_callback &handler);
+
+        /**
+         * \brief connect in background, reconnect until stopped
+         */
+        void start();
+
+        void stop();
+
+        /**
+         * @brief leader log position applied locally
+         */
+        uint64_t getPosition() const;
+
+        /**
+         * @brief leader log position as of the last message from it
+         */
+        uint64_t getLeaderPosition() const;
+
+        uint64_t getFullSyncs() const;
+        uint64_t getPartialSyncs() const;
+        State getState() const;
+        string getLeader() const;
+
+        //handlers
+        void handle_connection_timed_out(tcp::endpoint &endpoint);
+        void handle_connection_error(tcp::endpoint &endpoint, const boost::system::error_code &ec);
+        void handle_connection_success(tcp::endpoint &endpoint);
+        void handle_disconnected();
+        void handle_read_message(std::string msg);
+        void handle_read_error(const boost::system::error_code error, size_t bytes_transferred);
+    };
+
+    string replica_state_to_string(StorageReplica::State state);
+}// namespace Diginext::Core::Storage
+
+#endif
@@ -0,0 +1,52 @@
+#ifndef DIGINEXT_CORE___STORAGE_STORAGE_SCAN_H
+#define DIGINEXT_CORE___STORAGE_STORAGE_SCAN_H
+
+#include "Storage/StorageEngine.h"
+
+#include <cstddef>
+#include <functional>
+#include <string>
+
+namespace Diginext::Core::Storage {
+
+    using namespace std;
+
+    const size_t SCAN_DEFAULT_LIMIT = 1000;
+    const size_t SCAN_MAX_LIMIT = 10000;
+    const size_t SCAN_CHUNK_ITEMS = 256;
+    const size_t SCAN_CHUNK_BYTES = 64 * 1024;
+
+    /**
+     * \brief ScanRequest
+     * \details keys in [start, end), at most limit of them
+     */
+    struct ScanRequest {
+        string start;
+        string end;///< empty - no upper bound
+        size_t limit = SCAN_DEFAULT_LIMIT;
+        std::function<bool(string_view key)> skip;///< optional, e.g. expired keys
+    };
+
+    typedef std::function<void(const string &chunk)> scan_chunk_callback;
+
+    /**
+     * @brief first key after every key starting with prefix
+     * @param[in] prefix
+     * @return range end, empty if there is none (empty prefix or all 0xff)
+     */
+    string scan_prefix_end(const string &prefix);
+
+    /**
+     * @brief run scan and emit the result as JSON chunks
+     * {"status":"ok","items":[{"key":..,"value":..},..],"final":false|true}, each at most
+     * SCAN_CHUNK_ITEMS items or about SCAN_CHUNK_BYTES; the final chunk carries "cursor"
+     * (base64 of the last key) when more keys are left in the range
+     * @param[in] engine
+     * @param[in] request
+     * @param[in] emit
+     * @return items count
+     */
+    size_t scan_chunks(const StorageEngine &engine, const ScanRequest &request, const scan_chunk_callback &emit);
+}// namespace Diginext::Core::Storage
+
+#endif
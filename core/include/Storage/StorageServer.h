@@ -1,7 +1,20 @@
 #ifndef DIGINEXT_CORE___STORAGE_STORAGE_SERVER_H
 #define DIGINEXT_CORE___STORAGE_STORAGE_SERVER_H
 
+#include "Storage/HotKeyTracker.h"
+#include "Storage/KeyExpiry.h"
+#include "Storage/RaftNode.h"
+#include "Storage/ReplicationLog.h"
+#include "Storage/RequestCodec.h"
+#include "Storage/RespCodec.h"
 #include "Storage/StorageCommon.h"
+#include "Storage/StorageReplica.h"
+#include "Storage/ShardedHashStorage.h"
+#include "Storage/SnapshotFile.h"
+#include "Storage/StorageEngine.h"
+#include "Storage/StorageOptions.h"
+#include "Storage/WatchRegistry.h"
+#include "Storage/WriteAheadLog.h"
 #include "Log/Log.h"
 #include "TCP/TCP.h"
 #include "TCP/TCPServer.h"
@@ -9,12 +22,19 @@
 #include <memory>
 #include <string>
 
+#include <atomic>
+#include <chrono>
 #include <map>
 #include <mutex>
+#include <set>
 #include <string>
+#include <thread>
 
 #include <boost/asio.hpp>
 #include <boost/asio/ip/tcp.hpp>
+#include <boost/asio/steady_timer.hpp>
+
+#include <nlohmann/json.hpp>
 
 namespace Diginext::Core::Storage {
 
@@ -27,24 +47,182 @@ namespace Diginext::Core::Storage {
      */
     class StorageServer {
     private:
+        /**
+         * \brief open transaction: reads at its snapshot, writes buffered until commit
+         */
+        struct Transaction {
+            uint64_t snapshot;
+            string connection;///< uuid of the owner, the transaction is aborted when it disconnects
+            std::set<string> reads;
+            std::map<string, string> writes;
+        };
+
+        /**
+         * \brief follower connected to this server
+         */
+        struct Replica {
+            tcp_connection::pointer connection;
+            uint64_t sent;///< last position sent
+            uint64_t acked;///< last position the follower applied
+        };
+
+        /**
+         * \brief client of the RESP listener
+         */
+        struct RespSession {
+            RespParser parser;
+            RespReplies replies;
+            bool closing = false;///< QUIT or a protocol error, the rest of the input is ignored
+        };
+
         Logger::pointer logger;
         tcp_server::pointer tcpServer;
-        std::map<string, string> dataStorage;
-        std::mutex dataSync;
+        StorageOptions options;
+        StorageEngine::pointer dataStorage;
+        WriteAheadLog::pointer wal;
+        WriteAheadLog::pointer deadlineLog;///< key deadlines of an engine with its own log, which knows nothing of them
+        std::thread snapshotThread;
+        std::atomic<bool> snapshotRunning;
+        KeyExpiry expiry;
+        std::unique_ptr<boost::asio::steady_timer> expiryTimer;
+        uint64_t readHits;///< counters below are touched by the server thread only
+        uint64_t readMisses;
+        uint64_t expiredKeys;
+        std::map<uint64_t, Transaction> transactions;
+        uint64_t nextTransaction;
+        std::unique_ptr<ReplicationLog> replicationLog;///< created when the first follower connects
+        std::map<string, Replica> replicas;///< by connection uuid
+        bool replicationFlushPending;
+        StorageReplica::pointer replica;///< set when this server follows a leader
+        RaftNode::pointer raft;///< set in raft cluster mode
+        std::map<uint64_t, std::pair<tcp_connection::pointer, uint64_t>> raftPending;///< clients waiting for their log index to apply, with the request id
+        std::unique_ptr<WatchRegistry> watches;
+        std::unique_ptr<boost::asio::steady_timer> watchTimer;
+        bool watchFlushPending;
+        std::unique_ptr<HotKeyTracker> hotKeys;
+
+        ParsedRequest parsed;  ///< last request taken by the fast path, its buffers reused
+        string parsedKey;      ///< parsed.key as the engines take it, capacity reused
+        ResponseWriter response;///< every flat answer is written here, io thread only
+        uint64_t requestId;     ///< binary frame id of the request being answered, io thread only
+
+        tcp_server::pointer respServer;           ///< RESP2 listener on the io thread of tcpServer, goes before it
+        std::map<string, RespSession> respSessions;///< by connection uuid
+        RespSession *respSession;                 ///< session whose read is being served, answers wait for its end
+        tcp_connection *respConnection;
+        string respAnswer;                        ///< every RESP answer is written here, io thread only
+
+        void openSnapshot();
+        void openWriteAheadLog();
+        void openDeadlineLog();
+        void scheduleExpiry(std::chrono::milliseconds delay);
+
+        /**
+         * @brief apply the deadlines of a deadline file or log
+         * @return records read
+         */
+        size_t loadDeadlines(const string &path);
+        void restoreDeadline(const string &key, const string &logged);
+
+        /**
+         * @brief set key deadline, ttl 0 makes the key persistent; a change is logged as wall-clock
+         * time to the write-ahead log and the replication stream, so a restart or a follower keeps it
+         * @param[in] durable called once the change is durable, right away if nothing changed
+         * @return true if key had a deadline before
+         */
+        bool setDeadline(const string &key, std::chrono::milliseconds ttl, const StorageEngine::durable_callback &durable = nullptr);
+
+        value_pointer readValue(const string &key, uint64_t *version = nullptr);
+        /**
+         * @param[in] ttl deadline the write sets, logged before the value; 0 - persistent, nullptr - kept as it is
+         */
+        bool writeValue(tcp_connection::pointer connection, const string &key, string &value, const uint64_t *ifVersion,
+                        const std::chrono::milliseconds *ttl);
+        void removeValue(const string &key, const StorageEngine::durable_callback &durable = nullptr);
+        void scanValues(tcp_connection::pointer connection, const nlohmann::json &json);
+        void readValues(tcp_connection::pointer connection, const nlohmann::json &json, Transaction *transaction);
+        void writeValues(tcp_connection::pointer connection, const nlohmann::json &json);
+        void writeRecords(tcp_connection::pointer connection, const StorageEngine::record_batch &records);
+        bool readIfVersion(tcp_connection::pointer connection, const nlohmann::json &json, uint64_t &version);
+        /**
+         * @param[in] reply answers the client, with written false right away if update refused, with
+         * true and the new version (0 if unknown) once the write is durable; never called without a connection
+         * @param[in] ttl deadline a successful update sets, as for writeValue
+         */
+        bool updateValue(tcp_connection::pointer connection, const string &key, const StorageEngine::update_callback &update,
+                         const std::function<void(bool written, uint64_t version)> &reply, const std::chrono::milliseconds *ttl = nullptr);
+        std::function<void(bool, uint64_t)> replyJson(tcp_connection::pointer connection, const shared_ptr<nlohmann::json> &answer);
+        void incrementValue(tcp_connection::pointer connection, const string &key, const nlohmann::json &json, bool decrement);
+        void compareAndSwapValue(tcp_connection::pointer connection, const string &key, const nlohmann::json &json);
+        void appendValue(tcp_connection::pointer connection, const string &key, const nlohmann::json &json);
+        bool readTtl(tcp_connection::pointer connection, const nlohmann::json &json, std::chrono::milliseconds &ttl);
 
-        bool keyExists(string key);
-        string readValue(string key);
-        void writeValue(string key, string value);
+        void beginTransaction(tcp_connection::pointer connection);
+        Transaction *findTransaction(tcp_connection::pointer connection, const nlohmann::json &json);
+        value_pointer readInTransaction(Transaction &transaction, const string &key, uint64_t *version);
+        void commitTransaction(tcp_connection::pointer connection, const nlohmann::json &json);
+        void endTransaction(uint64_t id);
+
+        void logMutation(WalRecordType type, const string &key, const string &value);
+        void notifyWatchers(WalRecordType type, const string &key, const string &value);
+        void watchKeys(tcp_connection::pointer connection, const string &request, const nlohmann::json &json);
+        void scheduleWatchFlush();
+        void startReplication(tcp_connection::pointer connection, const nlohmann::json &json);
+        void sendFullSync(Replica &replica);
+        bool sendReplicationRecords(Replica &replica);
+        void flushReplicas();
+
+        bool routeRaftRequest(tcp_connection::pointer connection, const string &request, const nlohmann::json &json);
+        void applyRaftCommand(uint64_t index, const string &command);
+        void failRaftPending();
+        void sendNotLeader(tcp_connection::pointer connection);
+
+        void dispatchRequest(tcp_connection::pointer connection, const string &request, const nlohmann::json &json);
+        bool dispatchParsed(tcp_connection::pointer connection);
+        void serveRead(tcp_connection::pointer connection, const string &key, const uint64_t *ifVersion, Transaction *transaction);
+        void serveWrite(tcp_connection::pointer connection, const string &key, string &value, std::chrono::milliseconds ttl,
+                        const uint64_t *ifVersion);
+
+        /**
+         * @brief answer the request being served, its id goes back in the binary header
+         */
+        void reply(tcp_connection::pointer connection, const string &answer);
+
+        /**
+         * @brief completion of work finished off the io thread, e.g. by a log flusher: it runs on the
+         * io thread with the id of the request it answers, so answers go out in completion order
+         */
+        StorageEngine::durable_callback resume(const StorageEngine::durable_callback &done);
 
         void sendErrorStatus(tcp_connection::pointer connection, const string& description);
-        void sendOkRead(tcp_connection::pointer connection, const string& value);
-        void sendOkWrite(tcp_connection::pointer connection);
+        void sendOkRead(tcp_connection::pointer connection, const string& value, uint64_t version);
+        void sendNotModified(tcp_connection::pointer connection, uint64_t version);
+        void sendOkWrite(tcp_connection::pointer connection, uint64_t version = 0);
+        void sendStats(tcp_connection::pointer connection);
+
+        /**
+         * @brief one RESP command, answered through reply() with this->requestId as its sequence number
+         */
+        void serveResp(tcp_connection::pointer connection, RespSession &session, const std::vector<string_view> &args);
+        void respSet(tcp_connection::pointer connection, resp_command command, const std::vector<string_view> &args);
+        void respIncrement(tcp_connection::pointer connection, const string &key, int64_t by);
+        void respAppend(tcp_connection::pointer connection, const string &key, string_view tail);
+        void respDelete(tcp_connection::pointer connection, const std::vector<string_view> &args);
+        void respMultiGet(tcp_connection::pointer connection, const std::vector<string_view> &args);
+        void respInfo();
+
+        /**
+         * @brief send the answers that are in order, close a quitting session once all are out
+         */
+        void flushResp(tcp_connection::pointer connection, RespSession &session);
 
     public:
         typedef shared_ptr<StorageServer> pointer;
-        static pointer create(const string &host = LOCAL_ADDRESS_TCP_V6, const unsigned short port = DEFAULT_PORT);
+        static pointer create(const string &host = LOCAL_ADDRESS_TCP_V6, const unsigned short port = DEFAULT_PORT,
+                              const StorageOptions &options = StorageOptions());
 
-        StorageServer(const string &host = LOCAL_ADDRESS_TCP_V6, const unsigned short port = DEFAULT_PORT);
+        StorageServer(const string &host = LOCAL_ADDRESS_TCP_V6, const unsigned short port = DEFAULT_PORT,
+                      const StorageOptions &options = StorageOptions());
         virtual ~StorageServer();
 
         /**
@@ -65,6 +243,12 @@ namespace Diginext::Core::Storage {
          */
         unsigned short getPort() const;
 
+        /**
+         * @brief RESP listen port
+         * @return 0 if the RESP listener is off
+         */
+        unsigned short getRespPort() const;
+
         /**
          * \brief start server
          */
@@ -75,6 +259,18 @@ namespace Diginext::Core::Storage {
          */
         void Stop();
 
+        /**
+         * @brief write snapshot in background thread, writers are not stopped; called on the server thread,
+         * which owns the key deadlines saved next to it
+         * @return false if snapshot is not configured or already running
+         */
+        bool SaveSnapshot();
+
+        /**
+         * @brief background snapshot status
+         */
+        bool SnapshotRunning() const;
+
         //handlers
         void handle_accept(tcp_connection::pointer connection);
         void handle_accept_error(tcp_connection::pointer connection, const boost::system::error_code error);
@@ -82,6 +278,11 @@ namespace Diginext::Core::Storage {
         void handle_read_message(tcp_connection::pointer connection, std::string msg);
         void handle_read_error(tcp_connection::pointer connection, const boost::system::error_code error, size_t bytes_transferred);
         void handle_send_error(tcp_connection::pointer connection, const boost::system::error_code error, size_t bytes_transferred);
+        void handle_expiry_timer(const boost::system::error_code &error);
+        void handle_watch_timer(const boost::system::error_code &error);
+        void handle_resp_accept(tcp_connection::pointer connection);
+        void handle_resp_disconnect(tcp_connection::pointer connection);
+        void handle_resp_message(tcp_connection::pointer connection, std::string msg);
     };
 }// namespace Diginext::Core::Storage
 
@@ -0,0 +1,85 @@
+#ifndef DIGINEXT_CORE___STORAGE_TIMING_WHEEL_H
+#define DIGINEXT_CORE___STORAGE_TIMING_WHEEL_H
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace Diginext::Core::Storage {
+
+    using namespace std;
+
+    /**
+     * \brief TimingWheel
+     * \details hierarchical timing wheel of keys: LEVEL_COUNT levels of SLOT_COUNT slots,
+     * level L slot covers SLOT_COUNT^L ticks. Scheduling is O(1); when the wheel turns past
+     * a level boundary the matching slot of the next level is cascaded down, so every
+     * entry is moved at most LEVEL_COUNT times. Deadlines past the top level wait in an
+     * overflow list. Runs of ticks with nothing in the lower levels are skipped in one
+     * step. Entries are never cancelled, the owner drops stale ones when they fire.
+     * Not thread-safe.
+     */
+    class TimingWheel {
+    public:
+        static const unsigned SLOT_BITS = 6;
+        static const size_t SLOT_COUNT = size_t(1) << SLOT_BITS;
+        static const size_t LEVEL_COUNT = 4;
+
+        struct Timer {
+            string key;
+            uint64_t deadline;///< tick
+        };
+
+        typedef std::function<void(const Timer &timer)> expire_callback;
+
+        explicit TimingWheel(uint64_t currentTick = 0);
+
+        TimingWheel(const TimingWheel &) = delete;
+        TimingWheel &operator=(const TimingWheel &) = delete;
+
+        /**
+         * @brief add timer, a deadline not after the current tick is due right away
+         * @param[in] key
+         * @param[in] deadline tick
+         */
+        void schedule(const string &key, uint64_t deadline);
+
+        /**
+         * @brief turn the wheel up to tick and fire at most budget due timers, the rest
+         * stay due for the next call
+         * @param[in] tick
+         * @param[in] budget
+         * @param[in] callback
+         * @return fired timers count
+         */
+        size_t advance(uint64_t tick, size_t budget, const expire_callback &callback);
+
+        /**
+         * @brief timers already due, waiting for budget
+         */
+        size_t getDueCount() const;
+
+        /**
+         * @brief scheduled timers, due ones included
+         */
+        size_t size() const;
+
+        uint64_t getCurrentTick() const;
+
+    private:
+        std::vector<Timer> slots[LEVEL_COUNT][SLOT_COUNT];
+        size_t levelCounts[LEVEL_COUNT];
+        std::vector<Timer> overflow;
+        std::deque<Timer> due;
+        uint64_t current;
+        size_t count;
+
+        void place(Timer &&timer);
+        void cascade(size_t level);
+    };
+}// namespace Diginext::Core::Storage
+
+#endif
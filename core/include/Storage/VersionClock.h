@@ -0,0 +1,43 @@
+#ifndef DIGINEXT_CORE___STORAGE_VERSION_CLOCK_H
+#define DIGINEXT_CORE___STORAGE_VERSION_CLOCK_H
+
+#include <atomic>
+#include <cstdint>
+
+namespace Diginext::Core::Storage {
+
+    /**
+     * \brief VersionClock
+     * \details hybrid logical clock for key versions: next() returns max(last + 1, wall clock
+     * in microseconds). Versions strictly increase within a process and, as long as writes did
+     * not outrun the wall clock by more than the restart takes, stay above every version
+     * handed out before a restart, so a version cached by a client never names a different value.
+     */
+    class VersionClock {
+    private:
+        std::atomic<uint64_t> last;
+
+    public:
+        VersionClock();
+
+        VersionClock(const VersionClock &) = delete;
+        VersionClock &operator=(const VersionClock &) = delete;
+
+        /**
+         * @brief new version, larger than every version returned before
+         */
+        uint64_t next();
+
+        /**
+         * @brief last version returned by next
+         */
+        uint64_t current() const;
+
+        /**
+         * @brief wall clock in microseconds since the unix epoch
+         */
+        static uint64_t now();
+    };
+}// namespace Diginext::Core::Storage
+
+#endif
@@ -0,0 +1,128 @@
+#ifndef DIGINEXT_CORE___STORAGE_WATCH_REGISTRY_H
+#define DIGINEXT_CORE___STORAGE_WATCH_REGISTRY_H
+
+#include "TCP/TCPConnection.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace Diginext::Core::Storage {
+
+    using namespace std;
+    using namespace Diginext::Core::TCP;
+
+    /**
+     * \brief what happens to events for a subscriber whose connection has too much queued
+     */
+    enum class WatchOverflowPolicy {
+        Drop,      ///< drop its events, then send one overflow event with the count once it drained
+        Disconnect ///< close its connection
+    };
+
+    bool watch_overflow_policy_from_string(const string &name, WatchOverflowPolicy &policy);
+    string watch_overflow_policy_to_string(WatchOverflowPolicy policy);
+
+    /**
+     * \brief WatchRegistry
+     * \details key and prefix subscriptions of the server's connections. A change is encoded into
+     * one wire frame per framing, shared by every subscriber's send queue, however many there are; a
+     * subscriber watching a key through several subscriptions gets it once. Prefixes are found
+     * with one hash lookup per distinct watched prefix length.
+     * Not thread-safe, used from the server io thread.
+     */
+    class WatchRegistry {
+    private:
+        struct Watcher {
+            tcp_connection::pointer connection;
+            size_t subscriptions = 0;
+            uint64_t dropped = 0;  ///< events dropped since the last overflow event
+            uint64_t lastEvent = 0;///< event already delivered, for subscribers matching twice
+        };
+
+        typedef std::unordered_map<string, std::vector<Watcher *>> subscription_map;
+
+        size_t queueLimit;
+        WatchOverflowPolicy policy;
+
+        std::unordered_map<string, std::unique_ptr<Watcher>> watchers;///< by connection uuid
+        subscription_map keys;
+        subscription_map prefixes;
+        std::map<size_t, size_t> prefixLengths;///< length -> watched prefixes of that length
+        std::vector<string> overflowed;        ///< uuids of watchers owed an overflow event
+
+        size_t subscriptionCount;
+        uint64_t eventSeq;
+        uint64_t eventsSent;
+        uint64_t eventsDropped;
+        uint64_t disconnects;
+
+        std::vector<Watcher *> matched;///< reused by notify
+
+        static void unlink(subscription_map &map, const string &pattern, Watcher *watcher);
+        void collect(const std::vector<Watcher *> &subscribers);
+        bool sendOverflow(Watcher &watcher);
+        void drop(const string &uuid);
+
+    public:
+        static const size_t MAX_WATCHES_PER_CONNECTION = 10000;
+
+        /**
+         * @param[in] queueLimit bytes a subscriber's connection may have queued before its events overflow
+         * @param[in] policy what an overflow does
+         */
+        WatchRegistry(size_t queueLimit, WatchOverflowPolicy policy);
+
+        WatchRegistry(const WatchRegistry &) = delete;
+        WatchRegistry &operator=(const WatchRegistry &) = delete;
+
+        /**
+         * @brief subscribe a connection to a key or to every key starting with a prefix
+         * @return false - already subscribed
+         */
+        bool watch(const tcp_connection::pointer &connection, const string &pattern, bool prefix);
+
+        /**
+         * @return false - was not subscribed
+         */
+        bool unwatch(const string &uuid, const string &pattern, bool prefix);
+
+        /**
+         * @brief drop every subscription of a disconnected connection
+         */
+        void remove(const string &uuid);
+
+        size_t watches(const string &uuid) const;
+
+        /**
+         * @brief no subscriptions at all, a change costs nothing
+         */
+        bool empty() const;
+
+        /**
+         * @brief push a change to its subscribers
+         * @param[in] key
+         * @param[in] value new value, nullptr - the key was removed
+         * @return connections to close under WatchOverflowPolicy::Disconnect, already unsubscribed
+         */
+        std::vector<tcp_connection::pointer> notify(const string &key, const string *value);
+
+        /**
+         * @brief send the overflow events of watchers whose queue drained
+         * @return true if some are still waiting for theirs
+         */
+        bool flushOverflows();
+
+        size_t getSubscriptions() const;
+        size_t getWatchers() const;
+        uint64_t getEventsSent() const;
+        uint64_t getEventsDropped() const;
+        uint64_t getDisconnects() const;
+    };
+}// namespace Diginext::Core::Storage
+
+#endif
@@ -0,0 +1,169 @@
+#ifndef DIGINEXT_CORE___STORAGE_WRITE_AHEAD_LOG_H
+#define DIGINEXT_CORE___STORAGE_WRITE_AHEAD_LOG_H
+
+#include "Log/Log.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace Diginext::Core::Storage {
+
+    using namespace std;
+    using namespace Diginext::Core::Log;
+
+    /**
+     * \brief when appended records are forced to disk
+     */
+    enum class FsyncPolicy {
+        Always,     ///< fsync as soon as possible, writers arriving during an fsync share the next one
+        GroupCommit,///< gather writes for a commit window, then one fsync for the group
+        Async       ///< acknowledge immediately, fsync in background at most once per interval
+    };
+
+    bool fsync_policy_from_string(const string &name, FsyncPolicy &policy);
+    string fsync_policy_to_string(FsyncPolicy policy);
+
+    enum class WalRecordType : uint8_t {
+        Put = 1,
+        Remove = 2,
+        Expire = 3///< key deadline: value is milliseconds since unix epoch in decimal, empty - the key is persistent again
+    };
+
+    struct WalRecord {
+        WalRecordType type;
+        string key;
+        string value;
+    };
+
+    /**
+     * \brief WriteAheadLog
+     * \details append-only log of checksummed records:
+     * [crc32 u32][payload length u32][type u8][key length u32][key][value],
+     * crc32 covers the payload. All file writes are done by one flusher thread,
+     * so concurrent writers share fsyncs.
+     */
+    class WriteAheadLog {
+    public:
+        typedef shared_ptr<WriteAheadLog> pointer;
+        typedef std::function<void(bool durable)> durable_callback;
+        typedef std::function<void(const WalRecord &record)> replay_callback;
+
+        static const uint32_t MAX_RECORD_SIZE = 1024 * 1024 * 1024;
+        static const size_t MAX_GROUP_BYTES = 4 * 1024 * 1024;
+
+    private:
+        Logger::pointer logger;
+
+        string path;
+        FsyncPolicy policy;
+        std::chrono::microseconds groupCommitWindow;
+        std::chrono::milliseconds asyncSyncInterval;
+
+        FILE *file;
+        std::thread flusher;
+
+        mutable std::mutex sync;
+        std::condition_variable pendingCondition;
+        std::condition_variable durableCondition;
+
+        string pending;
+        std::vector<durable_callback> callbacks;
+        uint64_t appendedOffset;
+        uint64_t writtenOffset;
+        uint64_t durableOffset;
+        bool stopping;
+        bool syncRequested;
+
+        void flushLoop();
+
+    public:
+        static pointer create(const string &path,
+                              FsyncPolicy policy = FsyncPolicy::GroupCommit,
+                              std::chrono::microseconds groupCommitWindow = std::chrono::microseconds(2000));
+
+        WriteAheadLog(const string &path,
+                      FsyncPolicy policy = FsyncPolicy::GroupCommit,
+                      std::chrono::microseconds groupCommitWindow = std::chrono::microseconds(2000));
+        virtual ~WriteAheadLog();
+
+        WriteAheadLog(const WriteAheadLog &) = delete;
+        WriteAheadLog &operator=(const WriteAheadLog &) = delete;
+
+        /**
+         * @brief encode record into log format
+         * @param[out] out
+         * @param[in] type
+         * @param[in] key
+         * @param[in] value
+         */
+        static void encode(string &out, WalRecordType type, const string &key, const string &value);
+
+        /**
+         * @brief read log sequentially and apply every valid record, must be called before open;
+         * a torn or corrupted tail is cut off
+         * @param[in] apply
+         * @param[in] fromOffset skip records before this offset
+         * @return applied records count
+         */
+        size_t replay(const replay_callback &apply, uint64_t fromOffset = 0);
+
+        /**
+         * @brief open log for append and start flusher thread
+         */
+        void open();
+
+        /**
+         * @brief flush everything pending, fsync and stop flusher thread
+         */
+        void close();
+
+        bool opened() const;
+
+        /**
+         * @brief append record
+         * @param[in] type
+         * @param[in] key
+         * @param[in] value
+         * @param[in] onDurable called (from flusher thread, or inline for Async) when record is durable under policy
+         * @param[in] applyInOrder called under log lock right after the record got its position,
+         * so the in-memory order of mutations equals the log order
+         * @return log offset after the record
+         */
+        uint64_t append(WalRecordType type, const string &key, const string &value,
+                        durable_callback onDurable = nullptr,
+                        const std::function<void()> &applyInOrder = nullptr);
+
+        /**
+         * @brief append put records as one unit: one log lock, one durable callback for the batch
+         * @param[in] records key-value pairs
+         * @param[in] onDurable called once every record of the batch is durable under policy
+         * @param[in] applyInOrder called under log lock after the last record got its position
+         * @return log offset after the last record
+         */
+        uint64_t appendBatch(const std::vector<std::pair<string, string>> &records,
+                             durable_callback onDurable = nullptr,
+                             const std::function<void()> &applyInOrder = nullptr);
+
+        /**
+         * @brief block until log is durable up to offset
+         * @param[in] offset
+         */
+        void waitDurable(uint64_t offset);
+
+        uint64_t getAppendedOffset() const;
+        uint64_t getDurableOffset() const;
+        FsyncPolicy getPolicy() const;
+        string getPath() const;
+    };
+}// namespace Diginext::Core::Storage
+
+#endif
@@ -1,6 +1,8 @@
 #ifndef DIGINEXT_CORE___TCP_TCP_H
 #define DIGINEXT_CORE___TCP_TCP_H
 
+#include <cstddef>
+#include <cstdint>
 #include <string>
 
 namespace Diginext::Core::TCP {
@@ -10,6 +12,66 @@ namespace Diginext::Core::TCP {
     const std::string LOCAL_ADDRESS_TCP_V4 = "127.0.0.1";
     const std::string LOCAL_ADDRESS_TCP_V6 = "::1";
 
+    /**
+     * \brief how messages are delimited on a connection, chosen per connection by the hello
+     * \details ordered from legacy to fastest, the value is the codec byte of the hello
+     */
+    enum class tcp_framing : unsigned char {
+        Base64Line = 0,///< base64 text, one message per '\n' terminated line, what a peer without a hello speaks
+        Binary = 1,    ///< binary header (length, flags, request id) followed by the raw bytes
+        Compressed = 2,///< binary framing, larger payloads deflated, FRAME_FLAG_COMPRESSED set on those
+        Raw = 3        ///< no framing: each read goes up as it came, messages go out as they are; for a protocol
+                       ///< framed above this layer (RESP), set by the listener, never negotiated
+    };
+
+    const size_t TCP_FRAMING_COUNT = 4;
+
+    /**
+     * \brief the codecs a hello may ask for, Raw is not one of them
+     */
+    bool tcp_framing_from_string(const std::string &name, tcp_framing &framing);
+    std::string tcp_framing_to_string(tcp_framing framing);
+
+    /**
+     * \brief built with zlib, without it Compressed is never offered nor chosen
+     */
+    bool tcp_compression_available();
+
+    /**
+     * \brief Compressed when available, Binary otherwise
+     */
+    tcp_framing tcp_best_framing();
+
+    /**
+     * \brief hello: HELLO_MAGIC, HELLO_VERSION, codec byte, two zero bytes
+     * \details the client sends it first thing, asking for a codec; the server answers with the
+     * same eight bytes carrying the codec it picked and both switch to it. A legacy client starts
+     * with a base64 character instead, never 0, so the first byte tells the two apart.
+     */
+    const size_t HELLO_SIZE = 8;
+    const unsigned char HELLO_MAGIC[4] = { 0x00, 'D', 'G', 'X' };
+    const unsigned char HELLO_VERSION = 1;
+
+    /**
+     * \brief binary frame header: payload length, flags, request id; little-endian
+     */
+    const size_t BINARY_HEADER_SIZE = 16;
+
+    /**
+     * \brief a larger length in a binary header is taken as a broken stream
+     */
+    const uint32_t BINARY_MAX_PAYLOAD = uint32_t(256) << 20;
+
+    /**
+     * \brief binary header flag: payload is the original length (uint32) and a zlib stream
+     */
+    const uint32_t FRAME_FLAG_COMPRESSED = 1;
+
+    /**
+     * \brief smaller payloads go out as they are in Compressed framing, deflate does not pay off there
+     */
+    const size_t COMPRESS_MIN_PAYLOAD = 512;
+
     bool tcp_connection_log_enabled();
     bool tcp_client_log_enabled();
     bool tcp_server_log_enabled();
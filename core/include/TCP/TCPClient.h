@@ -31,6 +31,7 @@ namespace Diginext::Core::TCP {
         boost::asio::io_service ios;
         boost::asio::io_service *io_service;
         tcp_connection::pointer tcp_conn;
+        tcp_framing framing;
 
         bool started_status;
         std::mutex status_sync;
@@ -52,10 +53,17 @@ namespace Diginext::Core::TCP {
         static pointer create();
 
         tcp_connection::pointer getConnection();
+
+        // framing the next connect() asks for in its hello, the server may grant less; Base64Line - no hello
+        void setFraming(tcp_framing framing);
+
         void connect(tcp::endpoint &endpoint);
         void disconnect();
         void send(std::string msg);
 
+        // request id in the binary header, the server echoes it on every answer; base64 framing drops it
+        void send(const std::string &msg, uint64_t requestId);
+
         tcp_client();
         virtual ~tcp_client();
 
@@ -69,6 +77,7 @@ namespace Diginext::Core::TCP {
         signal<void(tcp::endpoint &endpoint)> onConnectionSuccess;
         signal<void()> onDisconnected;
         signal<void(std::string msg)> onReadMessage;
+        signal<void(uint64_t requestId, std::string msg)> onReadReply;///< before onReadMessage, request id 0 in base64 framing
         signal<void(const boost::system::error_code error, size_t bytes_transferred)> onReadError;
         signal<void(const boost::system::error_code error, size_t bytes_transferred)> onSendError;
     };
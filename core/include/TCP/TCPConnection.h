@@ -4,11 +4,15 @@
 #include "Log/Log.h"
 #include "TCP/TCP.h"
 
+#include <atomic>
+#include <cstdint>
 #include <list>
+#include <memory>
 #include <mutex>
 #include <stdexcept>
 #include <string>
 #include <thread>
+#include <vector>
 
 #include <boost/asio.hpp>
 #include <boost/asio/io_service.hpp>
@@ -29,6 +33,53 @@ namespace Diginext::Core::TCP {
             const std::string &message,
             std::string &message_unreceived_part);
 
+    /**
+     * \brief message in wire framing (base64 + delimiter), immutable, so one frame can be queued
+     * on any number of connections without a copy
+     */
+    typedef std::shared_ptr<const std::string> frame_pointer;
+
+    frame_pointer encode_frame(const std::string &message);
+
+    /**
+     * \brief message in the given framing, requestId and flags only go on the wire in binary framing
+     */
+    frame_pointer encode_frame(const std::string &message, tcp_framing framing, uint64_t requestId = 0, uint32_t flags = 0);
+
+    struct binary_header {
+        uint32_t length;
+        uint32_t flags;
+        uint64_t requestId;
+    };
+
+    void write_binary_header(unsigned char *out, const binary_header &header);
+    binary_header read_binary_header(const unsigned char *in);
+
+    /**
+     * \brief the message a binary frame carries, inflated when the flags say so
+     * @return false if the payload does not inflate to the length it claims
+     */
+    bool decode_payload(const char *payload, size_t length, uint32_t flags, std::string &message);
+
+    /**
+     * \brief hello or its answer, asking for / telling the codec
+     */
+    frame_pointer encode_hello(tcp_framing framing);
+
+    /**
+     * @return false if in is not a hello of this version
+     */
+    bool read_hello(const unsigned char *in, tcp_framing &framing);
+
+    /**
+     * \brief who says hello on a connection
+     */
+    enum class tcp_negotiation {
+        None,   ///< framing fixed by setFraming
+        Request,///< client: hello on connect, onConnectionSuccess once the server answered
+        Accept  ///< server: the first byte tells a hello from a legacy base64 line
+    };
+
     class tcp_connection : public boost::enable_shared_from_this<tcp_connection> {
     private:
         Logger::pointer logger;
@@ -40,13 +91,45 @@ namespace Diginext::Core::TCP {
         boost::asio::streambuf message_;
         std::string partMessage;
 
-        std::list<string> sendBuffer;
+        std::atomic<tcp_framing> framing;
+        tcp_framing offered;///< asked for by Request, the best one granted by Accept
+        tcp_negotiation negotiation;
+        bool negotiated;///< guarded by sendSync, messages sent before are held in pendingMessages
+        std::vector<std::pair<std::string, uint64_t>> pendingMessages;
+        unsigned char helloReply[HELLO_SIZE];
+
+        std::vector<unsigned char> readBuffer;///< binary framing, frames not delivered yet are in [readStart, readEnd)
+        size_t readStart;
+        size_t readEnd;
+        std::string readBody;///< payload too large for readBuffer, read into directly
+        uint64_t readRequestId;
+        uint32_t readFlags;
+
+        std::list<frame_pointer> sendBuffer;
+        std::vector<boost::asio::const_buffer> sendBuffers;///< the front of sendBuffer in the write in flight
+        size_t sendingFrames;
         std::mutex sendSync;
         bool sendStart;
+        size_t queuedBytes;
+        bool closeWhenSent;///< guarded by sendSync, disconnect once the queue drains
 
         void handle_connect(const boost::system::error_code &ec, tcp::endpoint &endpoint);
         void handle_read(const boost::system::error_code &error, size_t bytes_transferred);
 
+        void handle_hello_reply(const boost::system::error_code &error, tcp::endpoint endpoint);
+        void handle_sniff(const boost::system::error_code &error, size_t bytes_transferred);
+        void handle_hello(const boost::system::error_code &error, size_t bytes_transferred);
+        void finish_negotiation(tcp_framing framing);
+
+        void start_read();
+        void read_binary();
+        void read_raw();
+        void handle_read_raw(const boost::system::error_code &error, size_t bytes_transferred);
+        void handle_read_binary(const boost::system::error_code &error, size_t bytes_transferred);
+        void handle_read_body(const boost::system::error_code &error, size_t bytes_transferred);
+        void read_failed(const boost::system::error_code &error, size_t bytes_transferred);
+        bool deliver(const char *payload, size_t length, uint32_t flags);
+
         void handle_write(const boost::system::error_code &error, size_t bytes_transferred);
         void async_write(bool init = false);
 
@@ -64,7 +147,32 @@ namespace Diginext::Core::TCP {
         std::string getUUID();
 
         tcp::socket &socket();
-        void send(std::string msg);
+        void send(const std::string &msg);
+
+        // send in binary framing with the request id in the header, base64 framing has no room for it
+        void send(const std::string &msg, uint64_t requestId);
+
+        // queue an encoded frame, shared with every other connection it is sent to
+        void sendFrame(frame_pointer frame);
+
+        // bytes queued and not written to the socket yet
+        size_t getQueuedBytes();
+
+        // framing of both directions, set before start(), no hello
+        void setFraming(tcp_framing framing);
+        tcp_framing getFraming() const;
+
+        // client side, set before connect(): ask the server for framing in a hello, Base64Line - no hello
+        void requestFraming(tcp_framing framing);
+
+        // server side, set before start(): a hello gets at most best, a peer without one stays Base64Line; Raw - no hello, no framing
+        void acceptFraming(tcp_framing best);
+
+        // hello not answered / not read yet, getFraming() is not final
+        bool negotiating();
+
+        // request id of the binary frame onReadMessage is delivering, 0 in base64 framing
+        uint64_t getReadRequestId() const;
 
         // start async read
         void start();
@@ -73,6 +181,9 @@ namespace Diginext::Core::TCP {
         void stop();
         void disconnect();
 
+        // disconnect once everything queued so far is written, e.g. after a last answer
+        void disconnectAfterSend();
+
         //events
         signal<void(tcp_connection *conn, tcp::endpoint &endpoint)> onConnectionTimedOut;
         signal<void(tcp_connection *conn, tcp::endpoint &endpoint, const boost::system::error_code &ec)> onConnectionError;
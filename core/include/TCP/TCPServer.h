@@ -32,12 +32,14 @@ namespace Diginext::Core::TCP {
 
         boost::asio::io_service ios;
         boost::asio::io_service *io_service;
+        bool shared;///< runs on an io_service someone else owns and runs, no thread of its own
         tcp::acceptor acceptor_;
 
         bool started_status;
         std::mutex status_sync;
 
         std::list<tcp_connection::pointer> connections;
+        tcp_framing framing;
 
         void start_accept();
         void handle_accept(tcp_connection::pointer new_connection, const boost::system::error_code &error);
@@ -57,16 +59,28 @@ namespace Diginext::Core::TCP {
     public:
         typedef boost::shared_ptr<tcp_server> pointer;
         static pointer create(tcp::endpoint &endpoint);
+        static pointer create(tcp::endpoint &endpoint, boost::asio::io_service &io_service);
 
         explicit tcp_server(tcp::endpoint &endpoint);
+
+        /**
+         * \brief a listener on an io_service already run by its owner, e.g. a second port of the same server;
+         * start() and stop() then only open and close it, the caller keeps the thread
+         */
+        tcp_server(tcp::endpoint &endpoint, boost::asio::io_service &io_service);
         virtual ~tcp_server();
 
         tcp::acceptor *getAcceptor();
+        boost::asio::io_service &getIoService();
 
         void start();
         void stop();
         bool started();
 
+        // best framing a hello is granted on connections accepted from now on, Base64Line - hellos are answered with it, Raw - no hellos
+        void setFraming(tcp_framing framing);
+        tcp_framing getFraming() const;
+
         tcp::endpoint getLocalEndpoint() const;
         std::string getLocalAddress() const;
         unsigned short getPort() const;
@@ -81,6 +95,10 @@ namespace Diginext::Core::TCP {
 
         void send(tcp_connection::pointer connection, std::string message);
         void send(std::string uuid, std::string message);
+
+        /**
+         * \brief broadcast, the message is encoded once per framing and every connection queues that same frame
+         */
         void sendAll(std::string message);
 
         //events
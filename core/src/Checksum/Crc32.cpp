@@ -0,0 +1,61 @@
+#include "Checksum/Crc32.h"
+
+#include <array>
+
+namespace Diginext::Core
+{
+    // slicing-by-8 tables, table[0] is the classic byte table
+    static std::array<std::array<uint32_t, 256>, 8> makeCrc32Tables()
+    {
+        std::array<std::array<uint32_t, 256>, 8> tables{};
+
+        for (uint32_t i = 0; i < 256; i++)
+        {
+            uint32_t crc = i;
+            for (int bit = 0; bit < 8; bit++)
+            {
+                crc = (crc & 1) ? (crc >> 1) ^ 0xEDB88320U : crc >> 1;
+            }
+            tables[0][i] = crc;
+        }
+
+        for (uint32_t i = 0; i < 256; i++)
+        {
+            for (size_t t = 1; t < 8; t++)
+            {
+                tables[t][i] = (tables[t - 1][i] >> 8) ^ tables[0][tables[t - 1][i] & 0xFF];
+            }
+        }
+
+        return tables;
+    }
+
+    uint32_t Crc32::Compute(const char* data, size_t dataLength, uint32_t crc)
+    {
+        static const auto tables = makeCrc32Tables();
+
+        const auto* p = reinterpret_cast<const unsigned char*>(data);
+        crc = ~crc;
+
+        while (dataLength >= 8)
+        {
+            const uint32_t low = crc ^ (uint32_t(p[0]) | (uint32_t(p[1]) << 8) | (uint32_t(p[2]) << 16) | (uint32_t(p[3]) << 24));
+            crc = tables[7][low & 0xFF] ^ tables[6][(low >> 8) & 0xFF] ^ tables[5][(low >> 16) & 0xFF] ^ tables[4][low >> 24] ^
+                  tables[3][p[4]] ^ tables[2][p[5]] ^ tables[1][p[6]] ^ tables[0][p[7]];
+            p += 8;
+            dataLength -= 8;
+        }
+
+        while (dataLength-- > 0)
+        {
+            crc = (crc >> 8) ^ tables[0][(crc ^ *p++) & 0xFF];
+        }
+
+        return ~crc;
+    }
+
+    uint32_t Crc32::Compute(const std::string& data, uint32_t crc)
+    {
+        return Compute(data.data(), data.size(), crc);
+    }
+}
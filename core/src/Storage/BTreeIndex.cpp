@@ -0,0 +1,276 @@
+#include "Storage/BTreeIndex.h"
+
+#include "Storage/StorageMemory.h"
+
+#include <algorithm>
+#include <iterator>
+
+namespace Diginext::Core::Storage {
+
+    BTreeIndex::Node::Node(bool leaf) : leaf(leaf) {
+        // one spare slot: a node overflows by one key before it splits
+        this->keys.reserve(MAX_KEYS + 1);
+        if (!leaf) {
+            this->children.reserve(MAX_KEYS + 2);
+        }
+    }
+
+    BTreeIndex::BTreeIndex() {
+        this->clear();
+    }
+
+    void BTreeIndex::clear() {
+        this->root = nullptr;
+        this->count = 0;
+        this->leafCount = 0;
+        this->internalCount = 0;
+        this->keyBytes = 0;
+        this->root = this->makeNode(true);
+    }
+
+    std::unique_ptr<BTreeIndex::Node> BTreeIndex::makeNode(bool leaf) {
+        if (leaf) {
+            this->leafCount++;
+        } else {
+            this->internalCount++;
+        }
+
+        return std::make_unique<Node>(leaf);
+    }
+
+    void BTreeIndex::dropNode(const Node *node) {
+        if (node->leaf) {
+            this->leafCount--;
+        } else {
+            this->internalCount--;
+        }
+    }
+
+    size_t BTreeIndex::memoryUsage() const {
+        const size_t leafBytes = sizeof(Node) + (MAX_KEYS + 1) * sizeof(string);
+        const size_t internalBytes = leafBytes + (MAX_KEYS + 2) * sizeof(std::unique_ptr<Node>);
+        return this->leafCount * leafBytes + this->internalCount * internalBytes + this->keyBytes;
+    }
+
+    size_t BTreeIndex::size() const {
+        return this->count;
+    }
+
+    size_t BTreeIndex::height() const {
+        size_t levels = 1;
+        for (const Node *node = this->root.get(); !node->leaf; node = node->children.front().get()) {
+            levels++;
+        }
+
+        return levels;
+    }
+
+    const BTreeIndex::Node *BTreeIndex::findLeaf(string_view key) const {
+        const Node *node = this->root.get();
+        while (!node->leaf) {
+            // child i holds keys in [keys[i - 1], keys[i])
+            const size_t index = std::upper_bound(node->keys.begin(), node->keys.end(), key) - node->keys.begin();
+            node = node->children[index].get();
+        }
+
+        return node;
+    }
+
+    bool BTreeIndex::contains(string_view key) const {
+        const Node *leaf = this->findLeaf(key);
+        return std::binary_search(leaf->keys.begin(), leaf->keys.end(), key);
+    }
+
+    bool BTreeIndex::insert(const string &key) {
+        string separator;
+        std::unique_ptr<Node> split;
+        if (!this->insertInto(this->root.get(), key, separator, split)) {
+            return false;
+        }
+
+        if (split != nullptr) {
+            auto grown = this->makeNode(false);
+            grown->keys.push_back(std::move(separator));
+            grown->children.push_back(std::move(this->root));
+            grown->children.push_back(std::move(split));
+            this->root = std::move(grown);
+        }
+
+        this->count++;
+        return true;
+    }
+
+    bool BTreeIndex::insertInto(Node *node, const string &key, string &separator, std::unique_ptr<Node> &split) {
+        if (node->leaf) {
+            const auto it = std::lower_bound(node->keys.begin(), node->keys.end(), key);
+            if (it != node->keys.end() && *it == key) {
+                return false;
+            }
+
+            this->keyBytes += string_heap_bytes(*(node->keys.insert(it, key)));
+            if (node->keys.size() <= MAX_KEYS) {
+                return true;
+            }
+
+            const size_t middle = node->keys.size() / 2;
+            split = this->makeNode(true);
+            split->keys.assign(std::make_move_iterator(node->keys.begin() + middle), std::make_move_iterator(node->keys.end()));
+            node->keys.resize(middle);
+            split->next = node->next;
+            node->next = split.get();
+            separator = split->keys.front();
+            this->keyBytes += string_heap_bytes(separator);
+            return true;
+        }
+
+        const size_t index = std::upper_bound(node->keys.begin(), node->keys.end(), key) - node->keys.begin();
+        string childSeparator;
+        std::unique_ptr<Node> childSplit;
+        if (!this->insertInto(node->children[index].get(), key, childSeparator, childSplit)) {
+            return false;
+        }
+
+        if (childSplit == nullptr) {
+            return true;
+        }
+
+        node->keys.insert(node->keys.begin() + index, std::move(childSeparator));
+        node->children.insert(node->children.begin() + index + 1, std::move(childSplit));
+        if (node->keys.size() <= MAX_KEYS) {
+            return true;
+        }
+
+        // the middle separator moves up, it is not kept in either half
+        const size_t middle = node->keys.size() / 2;
+        split = this->makeNode(false);
+        separator = std::move(node->keys[middle]);
+        split->keys.assign(std::make_move_iterator(node->keys.begin() + middle + 1), std::make_move_iterator(node->keys.end()));
+        split->children.assign(std::make_move_iterator(node->children.begin() + middle + 1), std::make_move_iterator(node->children.end()));
+        node->keys.resize(middle);
+        node->children.resize(middle + 1);
+        return true;
+    }
+
+    bool BTreeIndex::erase(string_view key) {
+        if (!this->eraseFrom(this->root.get(), key)) {
+            return false;
+        }
+
+        if (!this->root->leaf && this->root->children.size() == 1) {
+            this->dropNode(this->root.get());
+            auto child = std::move(this->root->children.front());
+            this->root = std::move(child);
+        }
+
+        this->count--;
+        return true;
+    }
+
+    bool BTreeIndex::eraseFrom(Node *node, string_view key) {
+        if (node->leaf) {
+            const auto it = std::lower_bound(node->keys.begin(), node->keys.end(), key);
+            if (it == node->keys.end() || *it != key) {
+                return false;
+            }
+
+            this->keyBytes -= string_heap_bytes(*it);
+            node->keys.erase(it);
+            return true;
+        }
+
+        const size_t index = std::upper_bound(node->keys.begin(), node->keys.end(), key) - node->keys.begin();
+        if (!this->eraseFrom(node->children[index].get(), key)) {
+            return false;
+        }
+
+        // separators may keep naming erased keys, they only route
+        const Node *child = node->children[index].get();
+        const size_t size = child->leaf ? child->keys.size() : child->children.size();
+        if (size < MIN_KEYS) {
+            this->rebalance(node, index);
+        }
+
+        return true;
+    }
+
+    void BTreeIndex::rebalance(Node *parent, size_t index) {
+        Node *child = parent->children[index].get();
+        Node *left = index > 0 ? parent->children[index - 1].get() : nullptr;
+        Node *right = index + 1 < parent->children.size() ? parent->children[index + 1].get() : nullptr;
+
+        const auto spare = [](const Node *node) {
+            return node != nullptr && (node->leaf ? node->keys.size() : node->children.size()) > MIN_KEYS;
+        };
+
+        if (spare(left)) {
+            if (child->leaf) {
+                child->keys.insert(child->keys.begin(), std::move(left->keys.back()));
+                left->keys.pop_back();
+                this->keyBytes -= string_heap_bytes(parent->keys[index - 1]);
+                parent->keys[index - 1] = child->keys.front();
+                this->keyBytes += string_heap_bytes(parent->keys[index - 1]);
+            } else {
+                child->keys.insert(child->keys.begin(), std::move(parent->keys[index - 1]));
+                child->children.insert(child->children.begin(), std::move(left->children.back()));
+                parent->keys[index - 1] = std::move(left->keys.back());
+                left->keys.pop_back();
+                left->children.pop_back();
+            }
+            return;
+        }
+
+        if (spare(right)) {
+            if (child->leaf) {
+                child->keys.push_back(std::move(right->keys.front()));
+                right->keys.erase(right->keys.begin());
+                this->keyBytes -= string_heap_bytes(parent->keys[index]);
+                parent->keys[index] = right->keys.front();
+                this->keyBytes += string_heap_bytes(parent->keys[index]);
+            } else {
+                child->keys.push_back(std::move(parent->keys[index]));
+                child->children.push_back(std::move(right->children.front()));
+                parent->keys[index] = std::move(right->keys.front());
+                right->keys.erase(right->keys.begin());
+                right->children.erase(right->children.begin());
+            }
+            return;
+        }
+
+        // merge with a sibling: always fold the right node of the pair into the left one
+        const size_t leftIndex = right != nullptr ? index : index - 1;
+        Node *target = parent->children[leftIndex].get();
+        Node *source = parent->children[leftIndex + 1].get();
+
+        if (target->leaf) {
+            target->next = source->next;
+        } else {
+            target->keys.push_back(std::move(parent->keys[leftIndex]));
+            std::move(source->children.begin(), source->children.end(), std::back_inserter(target->children));
+        }
+        std::move(source->keys.begin(), source->keys.end(), std::back_inserter(target->keys));
+
+        // leaf merge drops the separator, internal merge moved it down and left it empty
+        this->keyBytes -= string_heap_bytes(parent->keys[leftIndex]);
+        this->dropNode(source);
+        parent->keys.erase(parent->keys.begin() + leftIndex);
+        parent->children.erase(parent->children.begin() + leftIndex + 1);
+    }
+
+    void BTreeIndex::scan(string_view start, const key_callback &callback) const {
+        const Node *leaf = this->findLeaf(start);
+        auto it = std::lower_bound(leaf->keys.begin(), leaf->keys.end(), start);
+
+        while (leaf != nullptr) {
+            for (; it != leaf->keys.end(); ++it) {
+                if (!callback(*it)) {
+                    return;
+                }
+            }
+
+            leaf = leaf->next;
+            if (leaf != nullptr) {
+                it = leaf->keys.begin();
+            }
+        }
+    }
+}// namespace Diginext::Core::Storage
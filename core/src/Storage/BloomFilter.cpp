@@ -0,0 +1,64 @@
+#include "Storage/BloomFilter.h"
+
+#include "Storage/StorageHash.h"
+
+#include <algorithm>
+#include <utility>
+
+namespace Diginext::Core::Storage {
+
+    BloomFilter::BloomFilter(string data) : data(std::move(data)) {
+    }
+
+    BloomFilter BloomFilter::build(const std::vector<uint64_t> &hashes, size_t bitsPerKey) {
+        // k = bitsPerKey * ln 2 minimizes the false positive rate
+        const size_t probes = std::clamp<size_t>(bitsPerKey * 69 / 100, 1, 30);
+        const size_t bits = std::max<size_t>(hashes.size() * bitsPerKey, 64);
+        const size_t bytes = (bits + 7) / 8;
+
+        string data(bytes + 1, '\0');
+        const uint64_t bitCount = uint64_t(bytes) * 8;
+        for (const uint64_t hash : hashes) {
+            uint64_t h = hash;
+            const uint64_t delta = (hash >> 33) | (hash << 31);
+            for (size_t i = 0; i < probes; i++) {
+                const uint64_t bit = h % bitCount;
+                data[bit / 8] = static_cast<char>(data[bit / 8] | (1 << (bit % 8)));
+                h += delta;
+            }
+        }
+
+        data[bytes] = static_cast<char>(probes);
+        return BloomFilter(std::move(data));
+    }
+
+    bool BloomFilter::mayContain(uint64_t hash) const {
+        if (this->data.size() < 2) {
+            return true;
+        }
+
+        const size_t bytes = this->data.size() - 1;
+        const size_t probes = static_cast<unsigned char>(this->data[bytes]);
+        const uint64_t bitCount = uint64_t(bytes) * 8;
+
+        uint64_t h = hash;
+        const uint64_t delta = (hash >> 33) | (hash << 31);
+        for (size_t i = 0; i < probes; i++) {
+            const uint64_t bit = h % bitCount;
+            if ((this->data[bit / 8] & (1 << (bit % 8))) == 0) {
+                return false;
+            }
+            h += delta;
+        }
+
+        return true;
+    }
+
+    bool BloomFilter::mayContain(string_view key) const {
+        return this->mayContain(hash_key(key.data(), key.size()));
+    }
+
+    const string &BloomFilter::getData() const {
+        return this->data;
+    }
+}// namespace Diginext::Core::Storage
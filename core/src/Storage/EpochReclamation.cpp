@@ -0,0 +1,143 @@
+#include "Storage/EpochReclamation.h"
+
+#include <algorithm>
+#include <thread>
+
+namespace Diginext::Core::Storage {
+
+    struct EpochThreadState {
+        EpochManager::ThreadSlot *slot = nullptr;
+        size_t depth = 0;
+
+        ~EpochThreadState() {
+            if (this->slot != nullptr) {
+                EpochManager::instance().releaseSlot(this->slot);
+            }
+        }
+    };
+
+    thread_local EpochThreadState epochThreadState;
+
+    EpochManager &EpochManager::instance() {
+        static EpochManager manager;
+        return manager;
+    }
+
+    EpochManager::ThreadSlot *EpochManager::acquireSlot() {
+        while (true) {
+            for (size_t i = 0; i < MAX_THREADS; i++) {
+                auto &slot = this->slots[i];
+                bool expected = false;
+                if (!slot.used.load(std::memory_order_relaxed) &&
+                    slot.used.compare_exchange_strong(expected, true, std::memory_order_acquire)) {
+                    size_t highWater = this->slotsHighWater.load(std::memory_order_relaxed);
+                    while (highWater < i + 1 &&
+                           !this->slotsHighWater.compare_exchange_weak(highWater, i + 1, std::memory_order_acq_rel)) {
+                    }
+
+                    return &slot;
+                }
+            }
+
+            // more live threads than slots: wait for one to exit
+            std::this_thread::yield();
+        }
+    }
+
+    void EpochManager::releaseSlot(ThreadSlot *slot) {
+        slot->epoch.store(0, std::memory_order_release);
+        slot->used.store(false, std::memory_order_release);
+    }
+
+    EpochManager::Guard::Guard() {
+        auto &state = epochThreadState;
+        if (state.depth++ > 0) {
+            return;
+        }
+
+        auto &manager = EpochManager::instance();
+        if (state.slot == nullptr) {
+            state.slot = manager.acquireSlot();
+        }
+
+        state.slot->epoch.store(manager.globalEpoch.load(std::memory_order_relaxed), std::memory_order_seq_cst);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+    }
+
+    EpochManager::Guard::~Guard() {
+        auto &state = epochThreadState;
+        if (--state.depth > 0) {
+            return;
+        }
+
+        state.slot->epoch.store(0, std::memory_order_release);
+    }
+
+    uint64_t EpochManager::advance() {
+        return this->globalEpoch.fetch_add(1, std::memory_order_acq_rel) + 1;
+    }
+
+    uint64_t EpochManager::current() const {
+        return this->globalEpoch.load(std::memory_order_acquire);
+    }
+
+    uint64_t EpochManager::minActive() const {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+
+        uint64_t result = this->current();
+        const size_t highWater = this->slotsHighWater.load(std::memory_order_acquire);
+        for (size_t i = 0; i < highWater; i++) {
+            const uint64_t epoch = this->slots[i].epoch.load(std::memory_order_seq_cst);
+            if (epoch != 0) {
+                result = std::min(result, epoch);
+            }
+        }
+
+        return result;
+    }
+
+    RetireList::~RetireList() {
+        // owner is being destroyed, nobody can reach the nodes any more
+        for (auto &item : this->retired) {
+            item.deleter(item.ptr);
+        }
+    }
+
+    void RetireList::retire(void *ptr, void (*deleter)(void *)) {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        this->retired.push_back({ EpochManager::instance().current(), ptr, deleter });
+    }
+
+    size_t RetireList::reclaim() {
+        auto &manager = EpochManager::instance();
+        manager.advance();
+        const uint64_t minEpoch = manager.minActive();
+
+        size_t freed = 0;
+        auto keep = this->retired.begin();
+        for (auto it = this->retired.begin(); it != this->retired.end(); ++it) {
+            if (it->epoch < minEpoch) {
+                it->deleter(it->ptr);
+                freed++;
+            } else {
+                *keep++ = *it;
+            }
+        }
+
+        this->retired.erase(keep, this->retired.end());
+        return freed;
+    }
+
+    void RetireList::collect() {
+        if (this->retired.size() < this->nextReclaim) {
+            return;
+        }
+
+        this->reclaim();
+        this->nextReclaim = this->retired.size() + RECLAIM_THRESHOLD;
+    }
+
+    size_t RetireList::size() const {
+        return this->retired.size();
+    }
+}// namespace Diginext::Core::Storage
@@ -0,0 +1,96 @@
+#include "Storage/HashRing.h"
+
+#include "Storage/StorageHash.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace Diginext::Core::Storage {
+    // ring points must not correlate with the key hashes of the storage shards
+    const uint64_t RING_SEED = 0x5bd1e9955bd1e995ULL;
+
+    HashRing::HashRing(size_t vnodes) {
+        this->vnodes = std::max<size_t>(vnodes, 1);
+    }
+
+    void HashRing::sortPoints() {
+        // ties are broken by name, not by insertion order, so every client builds the same ring
+        std::sort(this->points.begin(), this->points.end(), [this](const Point &a, const Point &b) {
+            if (a.hash != b.hash) {
+                return a.hash < b.hash;
+            }
+            return this->nodes[a.node] < this->nodes[b.node];
+        });
+    }
+
+    bool HashRing::add(const string &node) {
+        if (this->contains(node)) {
+            return false;
+        }
+
+        const auto index = static_cast<uint32_t>(this->nodes.size());
+        this->nodes.push_back(node);
+
+        this->points.reserve(this->points.size() + this->vnodes);
+        for (size_t i = 0; i < this->vnodes; i++) {
+            const string name = node + "#" + std::to_string(i);
+            this->points.push_back({ hash_key(name, RING_SEED), index });
+        }
+
+        this->sortPoints();
+        return true;
+    }
+
+    bool HashRing::remove(const string &node) {
+        const auto found = std::find(this->nodes.begin(), this->nodes.end(), node);
+        if (found == this->nodes.end()) {
+            return false;
+        }
+
+        const auto index = static_cast<uint32_t>(found - this->nodes.begin());
+        this->nodes.erase(found);
+
+        // the order of the remaining points does not change, only their node indexes shift
+        this->points.erase(std::remove_if(this->points.begin(), this->points.end(),
+                                          [index](const Point &point) { return point.node == index; }),
+                           this->points.end());
+        for (auto &point : this->points) {
+            if (point.node > index) {
+                point.node--;
+            }
+        }
+
+        return true;
+    }
+
+    bool HashRing::contains(const string &node) const {
+        return std::find(this->nodes.begin(), this->nodes.end(), node) != this->nodes.end();
+    }
+
+    const string &HashRing::locate(const string &key) const {
+        if (this->points.empty()) {
+            throw std::logic_error("HashRing: no nodes");
+        }
+
+        const uint64_t hash = hash_key(key, RING_SEED);
+        auto point = std::lower_bound(this->points.begin(), this->points.end(), hash,
+                                      [](const Point &point, uint64_t hash) { return point.hash < hash; });
+        if (point == this->points.end()) {
+            point = this->points.begin();
+        }
+
+        return this->nodes[point->node];
+    }
+
+    const std::vector<string> &HashRing::getNodes() const {
+        return this->nodes;
+    }
+
+    size_t HashRing::size() const {
+        return this->nodes.size();
+    }
+
+    bool HashRing::empty() const {
+        return this->nodes.empty();
+    }
+}// namespace Diginext::Core::Storage
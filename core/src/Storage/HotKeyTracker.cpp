@@ -0,0 +1,168 @@
+#include "Storage/HotKeyTracker.h"
+
+#include "Storage/StorageHash.h"
+
+#include <algorithm>
+#include <limits>
+
+namespace Diginext::Core::Storage {
+    const uint64_t SAMPLE_SEED = 0x9e3779b97f4a7c15ULL;
+
+    HotKeyTracker::HotKeyTracker(size_t capacity, size_t sampleRate) {
+        this->capacity = capacity;
+        this->sampleRate = std::max<size_t>(sampleRate, 1);
+        this->random = SAMPLE_SEED;
+        this->countdown = 1;
+        this->floor = 0;
+        this->sampled = 0;
+        this->sinceDecay = 0;
+
+        if (capacity != 0) {
+            this->sketch.assign(SKETCH_DEPTH * SKETCH_WIDTH, 0);
+            this->top.reserve(capacity + 1);
+        }
+    }
+
+    void HotKeyTracker::sample(const string &key, bool write) {
+        // next gap uniform in [1, 2 * rate - 1], a fixed stride would alias with periodic access patterns
+        this->random ^= this->random << 13;
+        this->random ^= this->random >> 7;
+        this->random ^= this->random << 17;
+        this->countdown = 1 + static_cast<size_t>(this->random % (2 * this->sampleRate - 1));
+
+        this->sampled++;
+        const uint32_t estimate = this->addToSketch(key);
+
+        auto found = this->top.find(key);
+        if (found == this->top.end() && this->admit(key, estimate)) {
+            found = this->top.find(key);
+        }
+
+        if (found != this->top.end()) {
+            found->second.estimate = estimate;
+            (write ? found->second.writes : found->second.reads)++;
+        }
+
+        if (++this->sinceDecay >= DECAY_SAMPLES) {
+            this->decay();
+        }
+    }
+
+    uint32_t HotKeyTracker::addToSketch(const string &key) {
+        // one hash, a 16-bit slice of it per row
+        const uint64_t hash = hash_key(key);
+        uint32_t *counters[SKETCH_DEPTH];
+        uint32_t minimum = std::numeric_limits<uint32_t>::max();
+        for (size_t row = 0; row < SKETCH_DEPTH; row++) {
+            counters[row] = &this->sketch[row * SKETCH_WIDTH + ((hash >> (row * 16)) & (SKETCH_WIDTH - 1))];
+            minimum = std::min(minimum, *counters[row]);
+        }
+
+        // conservative update: only the counters at the minimum grow, the others already overcount
+        if (minimum == std::numeric_limits<uint32_t>::max()) {
+            return minimum;
+        }
+        for (auto *counter : counters) {
+            if (*counter == minimum) {
+                (*counter)++;
+            }
+        }
+        return minimum + 1;
+    }
+
+    bool HotKeyTracker::admit(const string &key, uint32_t estimate) {
+        if (this->top.size() < this->capacity) {
+            this->top.emplace(key, Counts{});
+            this->floor = std::min(this->floor, estimate);
+            return true;
+        }
+
+        if (estimate <= this->floor) {
+            return false;
+        }
+
+        // the floor went stale as top keys grew, find the real coldest
+        auto coldest = this->top.begin();
+        for (auto entry = this->top.begin(); entry != this->top.end(); ++entry) {
+            if (entry->second.estimate < coldest->second.estimate) {
+                coldest = entry;
+            }
+        }
+
+        if (estimate <= coldest->second.estimate) {
+            this->floor = coldest->second.estimate;
+            return false;
+        }
+
+        this->top.erase(coldest);
+        this->top.emplace(key, Counts{});
+
+        this->floor = estimate;
+        for (const auto &entry : this->top) {
+            if (entry.first != key) {
+                this->floor = std::min(this->floor, entry.second.estimate);
+            }
+        }
+        return true;
+    }
+
+    void HotKeyTracker::decay() {
+        this->sinceDecay = 0;
+        for (auto &counter : this->sketch) {
+            counter >>= 1;
+        }
+
+        this->floor = std::numeric_limits<uint32_t>::max();
+        for (auto entry = this->top.begin(); entry != this->top.end();) {
+            auto &counts = entry->second;
+            counts.estimate >>= 1;
+            counts.reads >>= 1;
+            counts.writes >>= 1;
+            if (counts.estimate == 0) {
+                entry = this->top.erase(entry);
+                continue;
+            }
+
+            this->floor = std::min(this->floor, counts.estimate);
+            ++entry;
+        }
+
+        if (this->top.empty()) {
+            this->floor = 0;
+        }
+    }
+
+    std::vector<HotKeyTracker::HotKey> HotKeyTracker::hottest(size_t limit) const {
+        std::vector<HotKey> keys;
+        keys.reserve(this->top.size());
+        for (const auto &entry : this->top) {
+            keys.push_back({ entry.first, uint64_t(entry.second.estimate) * this->sampleRate, uint64_t(entry.second.reads) * this->sampleRate,
+                             uint64_t(entry.second.writes) * this->sampleRate });
+        }
+
+        std::sort(keys.begin(), keys.end(), [](const HotKey &left, const HotKey &right) {
+            return left.accesses != right.accesses ? left.accesses > right.accesses : left.key < right.key;
+        });
+
+        if (keys.size() > limit) {
+            keys.resize(limit);
+        }
+        return keys;
+    }
+
+    bool HotKeyTracker::enabled() const {
+        return this->capacity != 0;
+    }
+
+    size_t HotKeyTracker::getCapacity() const {
+        return this->capacity;
+    }
+
+    size_t HotKeyTracker::getSampleRate() const {
+        return this->sampleRate;
+    }
+
+    uint64_t HotKeyTracker::getSampled() const {
+        return this->sampled;
+    }
+}// namespace Diginext::Core::Storage
@@ -0,0 +1,107 @@
+#include "Storage/KeyExpiry.h"
+
+namespace Diginext::Core::Storage {
+
+    constexpr std::chrono::milliseconds KeyExpiry::DEFAULT_TICK;
+
+    KeyExpiry::KeyExpiry(std::chrono::milliseconds tick) {
+        this->origin = clock::now();
+        this->tick = tick.count() > 0 ? tick : DEFAULT_TICK;
+    }
+
+    uint64_t KeyExpiry::now() const {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(clock::now() - this->origin).count());
+    }
+
+    void KeyExpiry::expire(const string &key, std::chrono::milliseconds ttl) {
+        const uint64_t deadline = this->now() + static_cast<uint64_t>(ttl.count() > 0 ? ttl.count() : 0);
+        this->deadlines[key] = deadline;
+
+        // rounded up, a timer never fires before the deadline
+        const auto tickMs = static_cast<uint64_t>(this->tick.count());
+        this->wheel.schedule(key, (deadline + tickMs - 1) / tickMs);
+    }
+
+    void KeyExpiry::expireAt(const string &key, uint64_t at) {
+        const uint64_t wall = wallClock();
+        this->expire(key, std::chrono::milliseconds(at > wall ? at - wall : 0));
+    }
+
+    uint64_t KeyExpiry::deadline(const string &key) const {
+        const auto it = this->deadlines.find(key);
+        if (it == this->deadlines.end()) {
+            return 0;
+        }
+
+        const uint64_t current = this->now();
+        return wallClock() + (it->second > current ? it->second - current : 0);
+    }
+
+    void KeyExpiry::forEach(const deadline_callback &callback) const {
+        // one clock reading for the whole walk, every deadline is shifted by the same offset
+        const uint64_t current = this->now();
+        const uint64_t wall = wallClock();
+        for (const auto &entry : this->deadlines) {
+            callback(entry.first, wall + (entry.second > current ? entry.second - current : 0));
+        }
+    }
+
+    void KeyExpiry::hold(const string &key) {
+        this->deadlines[key] = 0;
+    }
+
+    bool KeyExpiry::persist(const string &key) {
+        return this->deadlines.erase(key) > 0;
+    }
+
+    bool KeyExpiry::expired(const string &key) const {
+        if (this->deadlines.empty()) {
+            return false;
+        }
+
+        const auto it = this->deadlines.find(key);
+        return it != this->deadlines.end() && it->second <= this->now();
+    }
+
+    std::chrono::milliseconds KeyExpiry::remaining(const string &key) const {
+        const auto it = this->deadlines.find(key);
+        if (it == this->deadlines.end()) {
+            return std::chrono::milliseconds(-1);
+        }
+
+        const uint64_t current = this->now();
+        return std::chrono::milliseconds(it->second > current ? it->second - current : 0);
+    }
+
+    bool KeyExpiry::collect(size_t budget, const expire_callback &callback) {
+        const uint64_t current = this->now();
+        const uint64_t tickMs = static_cast<uint64_t>(this->tick.count());
+
+        // stale timers (key persisted or given a new deadline) are dropped without callback
+        // but still count against the budget, so one call stays bounded either way
+        this->wheel.advance(current / tickMs, budget, [this, current, &callback](const TimingWheel::Timer &timer) {
+            const auto it = this->deadlines.find(timer.key);
+            if (it == this->deadlines.end() || it->second > current) {
+                return;
+            }
+
+            this->deadlines.erase(it);
+            callback(timer.key);
+        });
+
+        return this->wheel.getDueCount() > 0;
+    }
+
+    size_t KeyExpiry::size() const {
+        return this->deadlines.size();
+    }
+
+    std::chrono::milliseconds KeyExpiry::getTick() const {
+        return this->tick;
+    }
+
+    uint64_t KeyExpiry::wallClock() {
+        return static_cast<uint64_t>(
+                std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count());
+    }
+}// namespace Diginext::Core::Storage
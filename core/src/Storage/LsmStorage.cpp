@@ -0,0 +1,1068 @@
+#include "Storage/LsmStorage.h"
+
+#include "Log/LogConsole.h"
+#include "Storage/StorageFile.h"
+#include "Storage/StorageHash.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <queue>
+#include <set>
+#include <sstream>
+#include <stdexcept>
+
+namespace Diginext::Core::Storage {
+    const char *MANIFEST_HEADER = "DGXLSM1";
+
+    // map node, key and value buffers
+    const size_t MEMTABLE_ENTRY_OVERHEAD = 64;
+
+    namespace {
+        /**
+         * \brief sorted input of a merge, lower index in the source list = newer data
+         */
+        class MergeSource {
+        public:
+            virtual ~MergeSource() = default;
+            virtual bool valid() const = 0;
+            virtual void next() = 0;
+            virtual string_view key() const = 0;
+            virtual string_view value() const = 0;
+            virtual bool deleted() const = 0;
+        };
+
+        /**
+         * \brief reads the memtable in small sorted chunks, so writers are blocked only
+         * for one chunk copy at a time
+         */
+        class MemtableSource : public MergeSource {
+        private:
+            static const size_t CHUNK_SIZE = 128;
+
+            shared_ptr<const void> owner;
+            const std::map<string, value_pointer> &entries;
+            std::shared_mutex &sync;
+            std::vector<std::pair<string, value_pointer>> chunk;
+            size_t position = 0;
+            bool exhausted = false;
+
+            void fill(const string &from, bool inclusive) {
+                this->chunk.clear();
+                this->position = 0;
+
+                std::shared_lock<std::shared_mutex> lock(this->sync);
+                auto it = inclusive ? this->entries.lower_bound(from) : this->entries.upper_bound(from);
+                for (; it != this->entries.end() && this->chunk.size() < CHUNK_SIZE; ++it) {
+                    this->chunk.emplace_back(it->first, it->second);
+                }
+
+                this->exhausted = it == this->entries.end();
+            }
+
+        public:
+            MemtableSource(shared_ptr<const void> owner, const std::map<string, value_pointer> &entries, std::shared_mutex &sync, const string &start)
+                : owner(std::move(owner)), entries(entries), sync(sync) {
+                this->fill(start, true);
+            }
+
+            bool valid() const override {
+                return this->position < this->chunk.size();
+            }
+
+            void next() override {
+                this->position++;
+                if (this->position == this->chunk.size() && !this->exhausted) {
+                    const string last = this->chunk.back().first;
+                    this->fill(last, false);
+                }
+            }
+
+            string_view key() const override {
+                return this->chunk[this->position].first;
+            }
+
+            string_view value() const override {
+                const auto &value = this->chunk[this->position].second;
+                return value == nullptr ? string_view() : string_view(*value);
+            }
+
+            bool deleted() const override {
+                return this->chunk[this->position].second == nullptr;
+            }
+        };
+
+        class TableSource : public MergeSource {
+        private:
+            SSTable::Iterator iterator;
+
+        public:
+            TableSource(const SSTable::pointer &table, const string &start) : iterator(table->iterator()) {
+                if (start.empty()) {
+                    this->iterator.seekToFirst();
+                } else {
+                    this->iterator.seek(start);
+                }
+            }
+
+            bool valid() const override {
+                return this->iterator.valid();
+            }
+
+            void next() override {
+                this->iterator.next();
+            }
+
+            string_view key() const override {
+                return this->iterator.key();
+            }
+
+            string_view value() const override {
+                return this->iterator.value();
+            }
+
+            bool deleted() const override {
+                return this->iterator.deleted();
+            }
+        };
+
+        /**
+         * \brief k-way merge, emits every key once with its newest entry until emit returns false
+         */
+        void merge(std::vector<std::unique_ptr<MergeSource>> &sources,
+                   const std::function<bool(string_view key, string_view value, bool deleted)> &emit) {
+            const auto greater = [&sources](size_t a, size_t b) {
+                const int order = sources[a]->key().compare(sources[b]->key());
+                return order != 0 ? order > 0 : a > b;
+            };
+
+            std::priority_queue<size_t, std::vector<size_t>, decltype(greater)> heap(greater);
+            for (size_t i = 0; i < sources.size(); i++) {
+                if (sources[i]->valid()) {
+                    heap.push(i);
+                }
+            }
+
+            string key;
+            while (!heap.empty()) {
+                const size_t newest = heap.top();
+                heap.pop();
+
+                key.assign(sources[newest]->key());
+                if (!emit(key, sources[newest]->value(), sources[newest]->deleted())) {
+                    return;
+                }
+
+                sources[newest]->next();
+                if (sources[newest]->valid()) {
+                    heap.push(newest);
+                }
+
+                // older entries of the same key
+                while (!heap.empty() && sources[heap.top()]->key() == key) {
+                    const size_t older = heap.top();
+                    heap.pop();
+                    sources[older]->next();
+                    if (sources[older]->valid()) {
+                        heap.push(older);
+                    }
+                }
+            }
+        }
+
+        bool smallest_less(const SSTable::pointer &a, const SSTable::pointer &b) {
+            return a->getSmallestKey() < b->getSmallestKey();
+        }
+    }// namespace
+
+    LsmStorage::pointer LsmStorage::create(const string &directory, const LsmOptions &options) {
+        return std::make_shared<LsmStorage>(directory, options);
+    }
+
+    LsmStorage::LsmStorage(const string &directory, const LsmOptions &options) {
+        this->logger = ConsoleLogger::create("LsmStorage");
+        this->directory = directory;
+        this->options = options;
+        this->version = std::make_shared<Version>();
+        this->nextFileNumber = 1;
+        this->stopping = false;
+        this->opened = false;
+
+        this->open();
+    }
+
+    LsmStorage::~LsmStorage() {
+        try {
+            this->close();
+        } catch (...) {
+        }
+    }
+
+    string LsmStorage::fileName(uint64_t number, const char *extension) const {
+        char name[32];
+        std::snprintf(name, sizeof(name), "%06llu.%s", static_cast<unsigned long long>(number), extension);
+        return this->directory + "/" + name;
+    }
+
+    uint64_t LsmStorage::allocateFileNumber() {
+        std::lock_guard<std::mutex> guard(this->manifestSync);
+        return this->nextFileNumber++;
+    }
+
+    shared_ptr<LsmStorage::Memtable> LsmStorage::newMemtable(uint64_t number) {
+        auto memtable = std::make_shared<Memtable>();
+        memtable->logNumber = number;
+        memtable->log = WriteAheadLog::create(this->fileName(number, "log"), this->options.fsyncPolicy, this->options.groupCommitWindow);
+        memtable->log->open();
+        return memtable;
+    }
+
+    void LsmStorage::open() {
+        if (!directory_create(this->directory)) {
+            throw std::runtime_error("LsmStorage: cannot create directory " + this->directory);
+        }
+
+        auto current = std::make_shared<Version>();
+        uint64_t logNumber = 0;
+        std::set<uint64_t> liveTables;
+
+        const string manifestPath = this->directory + "/MANIFEST";
+        FILE *file = std::fopen(manifestPath.c_str(), "rb");
+        if (file != nullptr) {
+            string content;
+            char buffer[4096];
+            size_t read;
+            while ((read = std::fread(buffer, 1, sizeof(buffer), file)) > 0) {
+                content.append(buffer, read);
+            }
+            std::fclose(file);
+
+            std::istringstream input(content);
+            string token;
+            input >> token;
+            if (token != MANIFEST_HEADER) {
+                throw std::runtime_error("LsmStorage: invalid manifest " + manifestPath);
+            }
+
+            while (input >> token) {
+                if (token == "next") {
+                    input >> this->nextFileNumber;
+                } else if (token == "log") {
+                    input >> logNumber;
+                } else if (token == "table") {
+                    size_t level = LEVEL_COUNT;
+                    uint64_t number = 0;
+                    input >> level >> number;
+                    if (!input || level >= LEVEL_COUNT) {
+                        throw std::runtime_error("LsmStorage: invalid manifest " + manifestPath);
+                    }
+
+                    auto table = SSTable::open(this->fileName(number, "sst"), number);
+                    if (table == nullptr) {
+                        throw std::runtime_error("LsmStorage: missing or corrupted table " + this->fileName(number, "sst"));
+                    }
+
+                    current->levels[level].push_back(table);
+                    liveTables.insert(number);
+                } else {
+                    throw std::runtime_error("LsmStorage: invalid manifest " + manifestPath);
+                }
+            }
+        }
+
+        std::sort(current->levels[0].begin(), current->levels[0].end(),
+                  [](const SSTable::pointer &a, const SSTable::pointer &b) { return a->getNumber() > b->getNumber(); });
+        for (size_t level = 1; level < LEVEL_COUNT; level++) {
+            std::sort(current->levels[level].begin(), current->levels[level].end(), smallest_less);
+        }
+
+        this->version = current;
+
+        // leftovers of an interrupted flush or compaction and logs already in tables;
+        // numbers handed out after the last manifest write are simply reused
+        for (uint64_t number = 1; number < this->nextFileNumber; number++) {
+            if (liveTables.count(number) == 0) {
+                file_remove(this->fileName(number, "sst"));
+            }
+
+            if (number < logNumber) {
+                file_remove(this->fileName(number, "log"));
+            }
+        }
+
+        this->recover(logNumber, this->nextFileNumber);
+
+        this->background = std::thread(&LsmStorage::backgroundLoop, this);
+        this->opened = true;
+    }
+
+    void LsmStorage::recover(uint64_t logNumber, uint64_t lastFileNumber) {
+        Memtable recovered;
+        std::vector<string> replayedLogs;
+        size_t records = 0;
+
+        const auto flushRecovered = [this, &recovered]() {
+            auto table = this->writeTable(recovered);
+            if (table != nullptr) {
+                auto next = std::make_shared<Version>(*(this->version));
+                next->levels[0].insert(next->levels[0].begin(), table);
+                this->version = next;
+            }
+
+            recovered.entries.clear();
+            recovered.bytes = 0;
+        };
+
+        for (uint64_t number = logNumber; number < lastFileNumber; number++) {
+            const string path = this->fileName(number, "log");
+            if (!file_exists(path)) {
+                continue;
+            }
+
+            WriteAheadLog log(path);
+            records += log.replay([this, &recovered, &flushRecovered](const WalRecord &record) {
+                recovered.bytes += record.key.size() + record.value.size() + MEMTABLE_ENTRY_OVERHEAD;
+                recovered.entries[record.key] = record.type == WalRecordType::Put ? std::make_shared<const string>(record.value) : nullptr;
+
+                if (recovered.bytes >= this->options.memtableSize) {
+                    flushRecovered();
+                }
+            });
+            replayedLogs.push_back(path);
+        }
+
+        if (!recovered.entries.empty()) {
+            flushRecovered();
+        }
+
+        const uint64_t number = this->nextFileNumber++;
+        this->writeManifest(*(this->version), number);
+        this->mem = this->newMemtable(number);
+
+        for (const auto &path : replayedLogs) {
+            file_remove(path);
+        }
+
+        if (records > 0) {
+            this->logger->LogInfo("recover | " + this->directory + " | replayed " + std::to_string(records) + " log records");
+        }
+    }
+
+    void LsmStorage::writeManifest(const Version &current, uint64_t logNumber) {
+        std::ostringstream output;
+        output << MANIFEST_HEADER << "\n";
+        output << "next " << this->nextFileNumber << "\n";
+        output << "log " << logNumber << "\n";
+        for (size_t level = 0; level < LEVEL_COUNT; level++) {
+            for (const auto &table : current.levels[level]) {
+                output << "table " << level << " " << table->getNumber() << "\n";
+            }
+        }
+
+        const string content = output.str();
+        const string path = this->directory + "/MANIFEST";
+        const string tempPath = path + ".tmp";
+
+        FILE *file = std::fopen(tempPath.c_str(), "wb");
+        if (file == nullptr) {
+            throw std::runtime_error("LsmStorage: cannot create " + tempPath);
+        }
+
+        bool success = std::fwrite(content.data(), 1, content.size(), file) == content.size();
+        success = file_sync(file) && success;
+        success = std::fclose(file) == 0 && success;
+        if (!success || !file_replace(tempPath, path)) {
+            file_remove(tempPath);
+            throw std::runtime_error("LsmStorage: cannot write " + path);
+        }
+    }
+
+    void LsmStorage::makeRoom(bool force) {
+        if (!force && this->mem->bytes < this->options.memtableSize) {
+            return;
+        }
+
+        if (this->mem->entries.empty()) {
+            return;
+        }
+
+        {
+            // one frozen memtable at a time: writers wait for the flush instead of piling up tables
+            std::unique_lock<std::mutex> lock(this->stateSync);
+            this->stateCondition.wait(lock, [this]() { return this->imm == nullptr || this->stopping; });
+            if (this->stopping) {
+                throw std::runtime_error("LsmStorage: write to closed storage " + this->directory);
+            }
+        }
+
+        shared_ptr<Memtable> fresh;
+        {
+            std::lock_guard<std::mutex> guard(this->manifestSync);
+            const uint64_t number = this->nextFileNumber++;
+
+            shared_ptr<const Version> current;
+            {
+                std::lock_guard<std::mutex> state(this->stateSync);
+                current = this->version;
+            }
+
+            // the new log must be known before it gets records, the frozen one is still needed
+            this->writeManifest(*current, this->mem->logNumber);
+            fresh = this->newMemtable(number);
+        }
+
+        this->mem->log->close();
+
+        {
+            std::lock_guard<std::mutex> guard(this->stateSync);
+            this->imm = this->mem;
+            this->mem = fresh;
+        }
+
+        this->backgroundCondition.notify_one();
+    }
+
+    void LsmStorage::Memtable::apply(const string &key, const value_pointer &stored) {
+        const size_t valueSize = stored == nullptr ? 0 : stored->size();
+
+        auto it = this->entries.find(key);
+        if (it == this->entries.end()) {
+            this->entries.emplace(key, stored);
+            this->bytes += key.size() + valueSize + MEMTABLE_ENTRY_OVERHEAD;
+            this->liveDelta += stored != nullptr ? 1 : -1;
+            return;
+        }
+
+        const size_t previousSize = it->second == nullptr ? 0 : it->second->size();
+        this->bytes = this->bytes - previousSize + valueSize;
+        if (it->second == nullptr && stored != nullptr) {
+            this->liveDelta++;
+        } else if (it->second != nullptr && stored == nullptr) {
+            this->liveDelta--;
+        }
+
+        it->second = stored;
+    }
+
+    void LsmStorage::write(WalRecordType type, const string &key, const string &value, const durable_callback &onDurable) {
+        this->makeRoom(false);
+
+        const value_pointer stored = type == WalRecordType::Put ? std::make_shared<const string>(value) : nullptr;
+        Memtable &memtable = *(this->mem);
+
+        memtable.log->append(type, key, value, onDurable, [&memtable, &key, &stored]() {
+            std::unique_lock<std::shared_mutex> lock(memtable.sync);
+            memtable.apply(key, stored);
+        });
+    }
+
+    void LsmStorage::writeBatch(const record_batch &records, const durable_callback &onDurable) {
+        // the whole batch lands in one memtable, which may overshoot its size by one batch
+        this->makeRoom(false);
+
+        std::vector<value_pointer> stored;
+        stored.reserve(records.size());
+        for (const auto &record : records) {
+            stored.push_back(std::make_shared<const string>(record.second));
+        }
+
+        Memtable &memtable = *(this->mem);
+        memtable.log->appendBatch(records, onDurable, [&memtable, &records, &stored]() {
+            std::unique_lock<std::shared_mutex> lock(memtable.sync);
+            for (size_t i = 0; i < records.size(); i++) {
+                memtable.apply(records[i].first, stored[i]);
+            }
+        });
+    }
+
+    SSTable::pointer LsmStorage::writeTable(const Memtable &memtable) {
+        const uint64_t number = this->allocateFileNumber();
+        const string path = this->fileName(number, "sst");
+
+        {
+            SSTableBuilder builder(path, this->options.blockSize, this->options.bloomBitsPerKey);
+
+            std::shared_lock<std::shared_mutex> lock(memtable.sync);
+            for (const auto &entry : memtable.entries) {
+                if (entry.second == nullptr) {
+                    builder.add(entry.first, string_view(), true);
+                } else {
+                    builder.add(entry.first, *(entry.second));
+                }
+            }
+
+            if (builder.getEntryCount() == 0) {
+                builder.abandon();
+                return nullptr;
+            }
+
+            builder.finish();
+        }
+
+        auto table = SSTable::open(path, number);
+        if (table == nullptr) {
+            throw std::runtime_error("LsmStorage: cannot open written table " + path);
+        }
+
+        return table;
+    }
+
+    void LsmStorage::flushImmutable() {
+        shared_ptr<Memtable> frozen;
+        {
+            std::lock_guard<std::mutex> guard(this->stateSync);
+            frozen = this->imm;
+        }
+
+        if (frozen == nullptr) {
+            return;
+        }
+
+        auto table = this->writeTable(*frozen);
+
+        {
+            std::lock_guard<std::mutex> guard(this->manifestSync);
+
+            shared_ptr<const Version> current;
+            uint64_t logNumber;
+            {
+                std::lock_guard<std::mutex> state(this->stateSync);
+                current = this->version;
+                logNumber = this->mem->logNumber;
+            }
+
+            auto next = std::make_shared<Version>(*current);
+            if (table != nullptr) {
+                next->levels[0].insert(next->levels[0].begin(), table);
+            }
+
+            this->writeManifest(*next, logNumber);
+
+            std::lock_guard<std::mutex> state(this->stateSync);
+            this->version = next;
+            this->imm = nullptr;
+        }
+
+        this->stateCondition.notify_all();
+        file_remove(this->fileName(frozen->logNumber, "log"));
+        this->flushCount++;
+    }
+
+    uint64_t LsmStorage::levelMaxBytes(size_t level) const {
+        uint64_t bytes = this->options.level1MaxBytes;
+        for (size_t i = 1; i < level; i++) {
+            bytes *= this->options.levelMultiplier;
+        }
+
+        return bytes;
+    }
+
+    uint64_t LsmStorage::levelBytes(const std::vector<SSTable::pointer> &tables) {
+        uint64_t bytes = 0;
+        for (const auto &table : tables) {
+            bytes += table->getFileSize();
+        }
+
+        return bytes;
+    }
+
+    bool LsmStorage::overlaps(const SSTable::pointer &table, const string &smallest, const string &largest) {
+        return !(table->getLargestKey() < smallest || largest < table->getSmallestKey());
+    }
+
+    bool LsmStorage::keyInDeeperLevels(const Version &current, size_t level, string_view key) {
+        for (size_t deeper = level + 1; deeper < LEVEL_COUNT; deeper++) {
+            const auto &tables = current.levels[deeper];
+            const auto it = std::lower_bound(tables.begin(), tables.end(), key,
+                                             [](const SSTable::pointer &table, string_view target) { return table->getLargestKey() < target; });
+            if (it != tables.end() && (*it)->getSmallestKey() <= key) {
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    bool LsmStorage::pickCompaction(const Version &current, Compaction &compaction) const {
+        compaction.inputs.clear();
+        compaction.trivialMove = false;
+
+        if (current.levels[0].size() >= this->options.level0CompactionTrigger) {
+            // level 0 tables overlap, all of them go down together
+            compaction.level = 0;
+            compaction.inputs = current.levels[0];
+
+            string smallest = current.levels[0].front()->getSmallestKey();
+            string largest = current.levels[0].front()->getLargestKey();
+            for (const auto &table : current.levels[0]) {
+                smallest = std::min(smallest, table->getSmallestKey());
+                largest = std::max(largest, table->getLargestKey());
+            }
+
+            for (const auto &table : current.levels[1]) {
+                if (overlaps(table, smallest, largest)) {
+                    compaction.inputs.push_back(table);
+                }
+            }
+
+            return true;
+        }
+
+        for (size_t level = 1; level + 1 < LEVEL_COUNT; level++) {
+            const auto &tables = current.levels[level];
+            if (levelBytes(tables) <= this->levelMaxBytes(level)) {
+                continue;
+            }
+
+            // round-robin over the key space, so every range gets compacted in turn
+            SSTable::pointer picked = tables.front();
+            for (const auto &table : tables) {
+                if (table->getSmallestKey() > this->compactPointer[level]) {
+                    picked = table;
+                    break;
+                }
+            }
+
+            compaction.level = level;
+            compaction.inputs.push_back(picked);
+            for (const auto &table : current.levels[level + 1]) {
+                if (overlaps(table, picked->getSmallestKey(), picked->getLargestKey())) {
+                    compaction.inputs.push_back(table);
+                }
+            }
+
+            compaction.trivialMove = compaction.inputs.size() == 1;
+            return true;
+        }
+
+        return false;
+    }
+
+    void LsmStorage::compact(const Compaction &compaction) {
+        const size_t outputLevel = compaction.level + 1;
+
+        shared_ptr<const Version> current;
+        {
+            std::lock_guard<std::mutex> guard(this->stateSync);
+            current = this->version;
+        }
+
+        std::vector<SSTable::pointer> outputs;
+        if (compaction.trivialMove) {
+            // nothing to merge with below, the file just changes level
+            outputs = compaction.inputs;
+        } else {
+            std::vector<std::unique_ptr<MergeSource>> sources;
+            for (const auto &table : compaction.inputs) {
+                sources.push_back(std::make_unique<TableSource>(table, string()));
+            }
+
+            std::unique_ptr<SSTableBuilder> builder;
+            uint64_t number = 0;
+
+            const auto finishTable = [this, &builder, &number, &outputs]() {
+                builder->finish();
+                builder.reset();
+
+                auto table = SSTable::open(this->fileName(number, "sst"), number);
+                if (table == nullptr) {
+                    throw std::runtime_error("LsmStorage: cannot open written table " + this->fileName(number, "sst"));
+                }
+
+                outputs.push_back(table);
+            };
+
+            try {
+                merge(sources, [&](string_view key, string_view value, bool deleted) {
+                    // a tombstone is only needed while older data may exist below
+                    if (deleted && !keyInDeeperLevels(*current, outputLevel, key)) {
+                        return true;
+                    }
+
+                    if (builder == nullptr) {
+                        number = this->allocateFileNumber();
+                        builder = std::make_unique<SSTableBuilder>(this->fileName(number, "sst"), this->options.blockSize,
+                                                                   this->options.bloomBitsPerKey);
+                    }
+
+                    builder->add(key, value, deleted);
+                    if (builder->getFileSize() >= this->options.tableFileSize) {
+                        finishTable();
+                    }
+                    return true;
+                });
+
+                if (builder != nullptr) {
+                    finishTable();
+                }
+            } catch (...) {
+                for (const auto &table : outputs) {
+                    table->markObsolete();
+                }
+                throw;
+            }
+        }
+
+        {
+            std::lock_guard<std::mutex> guard(this->manifestSync);
+
+            uint64_t logNumber;
+            {
+                std::lock_guard<std::mutex> state(this->stateSync);
+                current = this->version;
+                logNumber = this->imm != nullptr ? this->imm->logNumber : this->mem->logNumber;
+            }
+
+            auto next = std::make_shared<Version>(*current);
+            for (size_t level : { compaction.level, outputLevel }) {
+                auto &tables = next->levels[level];
+                tables.erase(std::remove_if(tables.begin(), tables.end(), [&compaction](const SSTable::pointer &table) {
+                                 return std::find(compaction.inputs.begin(), compaction.inputs.end(), table) != compaction.inputs.end();
+                             }),
+                             tables.end());
+            }
+
+            auto &target = next->levels[outputLevel];
+            target.insert(target.end(), outputs.begin(), outputs.end());
+            std::sort(target.begin(), target.end(), smallest_less);
+
+            this->writeManifest(*next, logNumber);
+
+            std::lock_guard<std::mutex> state(this->stateSync);
+            this->version = next;
+            if (compaction.level > 0) {
+                this->compactPointer[compaction.level] = compaction.inputs.front()->getLargestKey();
+            }
+        }
+
+        if (!compaction.trivialMove) {
+            // files go away once readers holding the old version are done
+            for (const auto &table : compaction.inputs) {
+                table->markObsolete();
+            }
+        }
+
+        this->compactionCount++;
+    }
+
+    void LsmStorage::backgroundLoop() {
+        std::unique_lock<std::mutex> lock(this->stateSync);
+
+        while (true) {
+            Compaction compaction;
+            this->backgroundCondition.wait(lock, [this, &compaction]() {
+                return this->stopping || this->imm != nullptr || this->pickCompaction(*(this->version), compaction);
+            });
+
+            const bool flushPending = this->imm != nullptr;
+            if (!flushPending && this->stopping) {
+                break;
+            }
+
+            if (!flushPending && compaction.inputs.empty()) {
+                this->pickCompaction(*(this->version), compaction);
+            }
+
+            lock.unlock();
+            try {
+                if (flushPending) {
+                    this->flushImmutable();
+                } else {
+                    this->compact(compaction);
+                }
+            } catch (const std::exception &e) {
+                this->logger->LogError(string("background | ") + e.what());
+                std::this_thread::sleep_for(std::chrono::seconds(1));
+            }
+            lock.lock();
+
+            if (flushPending && this->stopping && this->imm != nullptr) {
+                break;// flush keeps failing, the frozen log stays for recovery
+            }
+
+            this->stateCondition.notify_all();
+        }
+
+        this->stateCondition.notify_all();
+    }
+
+    LookupResult LsmStorage::lookup(const string &key, value_pointer &value) const {
+        shared_ptr<Memtable> active;
+        shared_ptr<Memtable> frozen;
+        shared_ptr<const Version> current;
+        {
+            std::lock_guard<std::mutex> guard(this->stateSync);
+            active = this->mem;
+            frozen = this->imm;
+            current = this->version;
+        }
+
+        for (const auto &memtable : { active, frozen }) {
+            if (memtable == nullptr) {
+                continue;
+            }
+
+            std::shared_lock<std::shared_mutex> lock(memtable->sync);
+            const auto it = memtable->entries.find(key);
+            if (it != memtable->entries.end()) {
+                value = it->second;
+                return it->second == nullptr ? LookupResult::Deleted : LookupResult::Found;
+            }
+        }
+
+        const uint64_t hash = hash_key(key);
+        string found;
+
+        // level 0 tables overlap, newest first
+        for (const auto &table : current->levels[0]) {
+            const LookupResult result = table->get(key, hash, found);
+            if (result != LookupResult::NotFound) {
+                value = result == LookupResult::Found ? std::make_shared<const string>(std::move(found)) : nullptr;
+                return result;
+            }
+        }
+
+        // deeper levels are sorted and disjoint, at most one candidate each
+        for (size_t level = 1; level < LEVEL_COUNT; level++) {
+            const auto &tables = current->levels[level];
+            const auto it = std::lower_bound(tables.begin(), tables.end(), key,
+                                             [](const SSTable::pointer &table, const string &target) { return table->getLargestKey() < target; });
+            if (it == tables.end()) {
+                continue;
+            }
+
+            const LookupResult result = (*it)->get(key, hash, found);
+            if (result != LookupResult::NotFound) {
+                value = result == LookupResult::Found ? std::make_shared<const string>(std::move(found)) : nullptr;
+                return result;
+            }
+        }
+
+        return LookupResult::NotFound;
+    }
+
+    bool LsmStorage::get(const string &key, string &value) const {
+        value_pointer found;
+        if (this->lookup(key, found) != LookupResult::Found) {
+            return false;
+        }
+
+        value = *found;
+        return true;
+    }
+
+    value_pointer LsmStorage::getShared(const string &key) const {
+        value_pointer found;
+        if (this->lookup(key, found) != LookupResult::Found) {
+            return nullptr;
+        }
+
+        return found;
+    }
+
+    void LsmStorage::put(const string &key, const string &value) {
+        std::lock_guard<std::mutex> guard(this->writeSync);
+        this->write(WalRecordType::Put, key, value, nullptr);
+    }
+
+    void LsmStorage::putDurable(const string &key, const string &value, const durable_callback &onDurable) {
+        std::lock_guard<std::mutex> guard(this->writeSync);
+        this->write(WalRecordType::Put, key, value, onDurable);
+    }
+
+    void LsmStorage::multiPut(const record_batch &records) {
+        std::lock_guard<std::mutex> guard(this->writeSync);
+        this->writeBatch(records, nullptr);
+    }
+
+    void LsmStorage::multiPutDurable(const record_batch &records, const durable_callback &onDurable) {
+        std::lock_guard<std::mutex> guard(this->writeSync);
+        this->writeBatch(records, onDurable);
+    }
+
+    bool LsmStorage::update(const string &key, const update_callback &update, const durable_callback &onDurable, uint64_t *version) {
+        std::lock_guard<std::mutex> guard(this->writeSync);
+
+        value_pointer found;
+        const bool exists = this->lookup(key, found) == LookupResult::Found;
+
+        string updated;
+        if (!update(exists, exists ? string_view(*found) : string_view(), 0, updated)) {
+            return false;
+        }
+
+        this->write(WalRecordType::Put, key, updated, onDurable);
+        if (version != nullptr) {
+            *version = 0;
+        }
+        return true;
+    }
+
+    bool LsmStorage::remove(const string &key) {
+        std::lock_guard<std::mutex> guard(this->writeSync);
+
+        value_pointer found;
+        if (this->lookup(key, found) != LookupResult::Found) {
+            return false;
+        }
+
+        this->write(WalRecordType::Remove, key, string(), nullptr);
+        return true;
+    }
+
+    void LsmStorage::forEach(const record_callback &callback) const {
+        this->scan(string(), string(), [&callback](string_view key, string_view value) {
+            callback(key, value);
+            return true;
+        });
+    }
+
+    void LsmStorage::scan(const string &start, const string &end, const scan_callback &callback) const {
+        shared_ptr<Memtable> active;
+        shared_ptr<Memtable> frozen;
+        shared_ptr<const Version> current;
+        {
+            std::lock_guard<std::mutex> guard(this->stateSync);
+            active = this->mem;
+            frozen = this->imm;
+            current = this->version;
+        }
+
+        std::vector<std::unique_ptr<MergeSource>> sources;
+        for (const auto &memtable : { active, frozen }) {
+            if (memtable != nullptr) {
+                sources.push_back(std::make_unique<MemtableSource>(memtable, memtable->entries, memtable->sync, start));
+            }
+        }
+
+        for (size_t level = 0; level < LEVEL_COUNT; level++) {
+            for (const auto &table : current->levels[level]) {
+                if (table->getLargestKey() >= start && (end.empty() || table->getSmallestKey() < end)) {
+                    sources.push_back(std::make_unique<TableSource>(table, start));
+                }
+            }
+        }
+
+        merge(sources, [&end, &callback](string_view key, string_view value, bool deleted) {
+            if (!end.empty() && key >= end) {
+                return false;
+            }
+
+            return deleted || callback(key, value);
+        });
+    }
+
+    size_t LsmStorage::size() const {
+        shared_ptr<Memtable> active;
+        shared_ptr<Memtable> frozen;
+        shared_ptr<const Version> current;
+        {
+            std::lock_guard<std::mutex> guard(this->stateSync);
+            active = this->mem;
+            frozen = this->imm;
+            current = this->version;
+        }
+
+        // a table tombstone usually cancels one older entry
+        int64_t count = 0;
+        for (size_t level = 0; level < LEVEL_COUNT; level++) {
+            for (const auto &table : current->levels[level]) {
+                count += int64_t(table->getEntryCount()) - 2 * int64_t(table->getDeletedCount());
+            }
+        }
+
+        for (const auto &memtable : { active, frozen }) {
+            if (memtable != nullptr) {
+                std::shared_lock<std::shared_mutex> lock(memtable->sync);
+                count += memtable->liveDelta;
+            }
+        }
+
+        return count > 0 ? static_cast<size_t>(count) : 0;
+    }
+
+    bool LsmStorage::persistent() const {
+        return true;
+    }
+
+    void LsmStorage::flush() {
+        {
+            std::lock_guard<std::mutex> guard(this->writeSync);
+            this->makeRoom(true);
+        }
+
+        std::unique_lock<std::mutex> lock(this->stateSync);
+        this->stateCondition.wait(lock, [this]() { return this->imm == nullptr || this->stopping; });
+    }
+
+    void LsmStorage::waitIdle() {
+        std::unique_lock<std::mutex> lock(this->stateSync);
+        this->stateCondition.wait(lock, [this]() {
+            Compaction compaction;
+            return this->stopping || (this->imm == nullptr && !this->pickCompaction(*(this->version), compaction));
+        });
+    }
+
+    void LsmStorage::close() {
+        {
+            std::lock_guard<std::mutex> guard(this->writeSync);
+            std::lock_guard<std::mutex> state(this->stateSync);
+            if (!this->opened) {
+                return;
+            }
+
+            this->opened = false;
+            this->stopping = true;
+        }
+
+        this->backgroundCondition.notify_all();
+        this->stateCondition.notify_all();
+        if (this->background.joinable()) {
+            this->background.join();
+        }
+
+        std::lock_guard<std::mutex> guard(this->writeSync);
+        if (this->mem != nullptr) {
+            this->mem->log->close();
+        }
+    }
+
+    LsmStats LsmStorage::getStats() const {
+        shared_ptr<Memtable> active;
+        shared_ptr<Memtable> frozen;
+        shared_ptr<const Version> current;
+        {
+            std::lock_guard<std::mutex> guard(this->stateSync);
+            active = this->mem;
+            frozen = this->imm;
+            current = this->version;
+        }
+
+        LsmStats stats;
+        for (const auto &memtable : { active, frozen }) {
+            if (memtable != nullptr) {
+                std::shared_lock<std::shared_mutex> lock(memtable->sync);
+                stats.memtableBytes += memtable->bytes;
+                stats.diskBytes += file_size(memtable->log->getPath());
+            }
+        }
+
+        for (size_t level = 0; level < LEVEL_COUNT; level++) {
+            const uint64_t bytes = levelBytes(current->levels[level]);
+            stats.levelBytes.push_back(bytes);
+            stats.diskBytes += bytes;
+            stats.tableCount += current->levels[level].size();
+
+            for (const auto &table : current->levels[level]) {
+                stats.blockReads += table->getReads();
+            }
+        }
+
+        stats.flushes = this->flushCount.load();
+        stats.compactions = this->compactionCount.load();
+        return stats;
+    }
+
+    string LsmStorage::getDirectory() const {
+        return this->directory;
+    }
+}// namespace Diginext::Core::Storage
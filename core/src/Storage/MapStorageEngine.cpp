@@ -0,0 +1,135 @@
+#include "Storage/MapStorageEngine.h"
+
+#include <mutex>
+
+namespace Diginext::Core::Storage {
+
+    MapStorageEngine::pointer MapStorageEngine::create() {
+        return std::make_shared<MapStorageEngine>();
+    }
+
+    bool MapStorageEngine::get(const string &key, string &value) const {
+        std::shared_lock<std::shared_mutex> lock(this->sync);
+        const auto it = this->data.find(key);
+        if (it == this->data.end()) {
+            return false;
+        }
+
+        value = *(it->second.value);
+        return true;
+    }
+
+    value_pointer MapStorageEngine::getShared(const string &key) const {
+        std::shared_lock<std::shared_mutex> lock(this->sync);
+        const auto it = this->data.find(key);
+        return it == this->data.end() ? nullptr : it->second.value;
+    }
+
+    value_pointer MapStorageEngine::getVersioned(const string &key, uint64_t &version) const {
+        std::shared_lock<std::shared_mutex> lock(this->sync);
+        const auto it = this->data.find(key);
+        if (it == this->data.end()) {
+            version = 0;
+            return nullptr;
+        }
+
+        version = it->second.version;
+        return it->second.value;
+    }
+
+    std::vector<value_pointer> MapStorageEngine::multiGet(const std::vector<string> &keys) const {
+        std::vector<value_pointer> values;
+        values.reserve(keys.size());
+
+        std::shared_lock<std::shared_mutex> lock(this->sync);
+        for (const auto &key : keys) {
+            const auto it = this->data.find(key);
+            values.push_back(it == this->data.end() ? nullptr : it->second.value);
+        }
+
+        return values;
+    }
+
+    void MapStorageEngine::put(const string &key, const string &value) {
+        auto stored = std::make_shared<const string>(value);
+
+        std::unique_lock<std::shared_mutex> lock(this->sync);
+        this->data[key] = Record{ std::move(stored), this->clock.next() };
+    }
+
+    void MapStorageEngine::multiPut(const record_batch &records) {
+        std::vector<value_pointer> stored;
+        stored.reserve(records.size());
+        for (const auto &record : records) {
+            stored.push_back(std::make_shared<const string>(record.second));
+        }
+
+        std::unique_lock<std::shared_mutex> lock(this->sync);
+        for (size_t i = 0; i < records.size(); i++) {
+            this->data[records[i].first] = Record{ std::move(stored[i]), this->clock.next() };
+        }
+    }
+
+    bool MapStorageEngine::update(const string &key, const update_callback &update, const durable_callback &onDurable, uint64_t *version) {
+        {
+            std::unique_lock<std::shared_mutex> lock(this->sync);
+            const auto it = this->data.find(key);
+            const bool exists = it != this->data.end();
+
+            string updated;
+            if (!update(exists, exists ? string_view(*(it->second.value)) : string_view(), exists ? it->second.version : 0, updated)) {
+                return false;
+            }
+
+            Record record{ std::make_shared<const string>(std::move(updated)), this->clock.next() };
+            if (version != nullptr) {
+                *version = record.version;
+            }
+
+            if (exists) {
+                it->second = std::move(record);
+            } else {
+                this->data.emplace(key, std::move(record));
+            }
+        }
+
+        if (onDurable) {
+            onDurable(true);
+        }
+        return true;
+    }
+
+    bool MapStorageEngine::remove(const string &key) {
+        std::unique_lock<std::shared_mutex> lock(this->sync);
+        return this->data.erase(key) > 0;
+    }
+
+    void MapStorageEngine::forEach(const record_callback &callback) const {
+        std::shared_lock<std::shared_mutex> lock(this->sync);
+        for (const auto &record : this->data) {
+            callback(record.first, *(record.second.value));
+        }
+    }
+
+    void MapStorageEngine::scan(const string &start, const string &end, const scan_callback &callback) const {
+        std::shared_lock<std::shared_mutex> lock(this->sync);
+        for (auto it = this->data.lower_bound(start); it != this->data.end(); ++it) {
+            if (!end.empty() && it->first >= end) {
+                return;
+            }
+
+            if (!callback(it->first, *(it->second.value))) {
+                return;
+            }
+        }
+    }
+
+    size_t MapStorageEngine::size() const {
+        std::shared_lock<std::shared_mutex> lock(this->sync);
+        return this->data.size();
+    }
+
+    bool MapStorageEngine::versioned() const {
+        return true;
+    }
+}// namespace Diginext::Core::Storage
@@ -0,0 +1,204 @@
+#include "Storage/RaftLog.h"
+
+#include "Checksum/Crc32.h"
+#include "Log/LogConsole.h"
+#include "Storage/StorageEncoding.h"
+#include "Storage/StorageFile.h"
+
+#include <stdexcept>
+
+namespace Diginext::Core::Storage {
+    const size_t RECORD_HEADER_SIZE = 8;
+
+    // payload: [type u8] then
+    //   State    [term u64][voted for]
+    //   Entry    [index u64][term u64][command]
+    //   Truncate [index u64]
+    enum class RaftRecordType : uint8_t {
+        State = 1,
+        Entry = 2,
+        Truncate = 3
+    };
+
+    static void encode_record(string &out, const string &payload) {
+        put_fixed32(out, Crc32::Compute(payload));
+        put_fixed32(out, static_cast<uint32_t>(payload.size()));
+        out.append(payload);
+    }
+
+    RaftLog::RaftLog(const string &path, bool syncWrites) {
+        this->logger = ConsoleLogger::create("RaftLog");
+        this->path = path;
+        this->syncWrites = syncWrites;
+        this->file = nullptr;
+        this->term = 0;
+    }
+
+    RaftLog::~RaftLog() {
+        try {
+            this->close();
+        } catch (...) {
+        }
+    }
+
+    size_t RaftLog::open() {
+        if (this->path.empty() || this->file != nullptr) {
+            return this->entries.size();
+        }
+
+        uint64_t goodOffset = 0;
+        FILE *input = std::fopen(this->path.c_str(), "rb");
+        if (input != nullptr) {
+            char header[RECORD_HEADER_SIZE];
+            string payload;
+            while (std::fread(header, 1, RECORD_HEADER_SIZE, input) == RECORD_HEADER_SIZE) {
+                const uint32_t crc = get_fixed32(header);
+                const uint32_t payloadSize = get_fixed32(header + 4);
+                if (payloadSize == 0 || payloadSize > MAX_RECORD_SIZE) {
+                    break;
+                }
+
+                payload.resize(payloadSize);
+                if (std::fread(&payload[0], 1, payloadSize, input) != payloadSize || Crc32::Compute(payload) != crc) {
+                    break;
+                }
+
+                const auto type = static_cast<RaftRecordType>(payload[0]);
+                const char *fields = payload.data() + 1;
+                const size_t fieldsSize = payloadSize - 1;
+                if (type == RaftRecordType::State && fieldsSize >= 8) {
+                    this->term = get_fixed64(fields);
+                    this->votedFor.assign(fields + 8, fieldsSize - 8);
+                } else if (type == RaftRecordType::Entry && fieldsSize >= 16 && get_fixed64(fields) == this->lastIndex() + 1) {
+                    this->entries.push_back({ get_fixed64(fields + 8), string(fields + 16, fieldsSize - 16) });
+                } else if (type == RaftRecordType::Truncate && fieldsSize == 8 && get_fixed64(fields) >= 1) {
+                    const uint64_t index = get_fixed64(fields);
+                    if (index <= this->lastIndex()) {
+                        this->entries.resize(static_cast<size_t>(index - 1));
+                    }
+                } else {
+                    break;
+                }
+
+                goodOffset += RECORD_HEADER_SIZE + payloadSize;
+            }
+
+            std::fclose(input);
+        }
+
+        const uint64_t size = file_size(this->path);
+        if (goodOffset < size) {
+            this->logger->LogWarning("open | dropping " + std::to_string(size - goodOffset) +
+                                     " bytes of torn or corrupted tail at offset " + std::to_string(goodOffset));
+            if (!file_truncate(this->path, goodOffset)) {
+                throw std::runtime_error("RaftLog: cannot truncate " + this->path);
+            }
+        }
+
+        this->file = std::fopen(this->path.c_str(), "ab");
+        if (this->file == nullptr) {
+            throw std::runtime_error("RaftLog: cannot open " + this->path);
+        }
+
+        return this->entries.size();
+    }
+
+    void RaftLog::close() {
+        if (this->file == nullptr) {
+            return;
+        }
+
+        file_sync(this->file);
+        std::fclose(this->file);
+        this->file = nullptr;
+    }
+
+    void RaftLog::write(const string &records) {
+        if (this->file == nullptr) {
+            return;
+        }
+
+        // a node that cannot persist must not acknowledge anything
+        const bool written = std::fwrite(records.data(), 1, records.size(), this->file) == records.size();
+        if (!written || (this->syncWrites ? !file_sync(this->file) : std::fflush(this->file) != 0)) {
+            throw std::runtime_error("RaftLog: write or fsync failed for " + this->path);
+        }
+    }
+
+    uint64_t RaftLog::getTerm() const {
+        return this->term;
+    }
+
+    const string &RaftLog::getVotedFor() const {
+        return this->votedFor;
+    }
+
+    void RaftLog::setState(uint64_t term, const string &votedFor) {
+        string payload;
+        payload.push_back(static_cast<char>(RaftRecordType::State));
+        put_fixed64(payload, term);
+        payload.append(votedFor);
+
+        string record;
+        encode_record(record, payload);
+        this->write(record);
+
+        this->term = term;
+        this->votedFor = votedFor;
+    }
+
+    uint64_t RaftLog::lastIndex() const {
+        return this->entries.size();
+    }
+
+    uint64_t RaftLog::termAt(uint64_t index) const {
+        if (index == 0 || index > this->lastIndex()) {
+            return 0;
+        }
+
+        return this->entries[static_cast<size_t>(index - 1)].term;
+    }
+
+    const RaftLog::Entry &RaftLog::at(uint64_t index) const {
+        return this->entries.at(static_cast<size_t>(index - 1));
+    }
+
+    void RaftLog::append(const std::vector<Entry> &batch) {
+        if (batch.empty()) {
+            return;
+        }
+
+        if (this->file != nullptr) {
+            string records;
+            string payload;
+            uint64_t index = this->lastIndex();
+            for (const auto &entry : batch) {
+                payload.clear();
+                payload.push_back(static_cast<char>(RaftRecordType::Entry));
+                put_fixed64(payload, ++index);
+                put_fixed64(payload, entry.term);
+                payload.append(entry.command);
+                encode_record(records, payload);
+            }
+            this->write(records);
+        }
+
+        this->entries.insert(this->entries.end(), batch.begin(), batch.end());
+    }
+
+    void RaftLog::truncate(uint64_t index) {
+        if (index == 0 || index > this->lastIndex()) {
+            return;
+        }
+
+        string payload;
+        payload.push_back(static_cast<char>(RaftRecordType::Truncate));
+        put_fixed64(payload, index);
+
+        string record;
+        encode_record(record, payload);
+        this->write(record);
+
+        this->entries.resize(static_cast<size_t>(index - 1));
+    }
+}// namespace Diginext::Core::Storage
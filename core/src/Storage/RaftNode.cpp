@@ -0,0 +1,725 @@
+#include "Storage/RaftNode.h"
+
+#include "Log/LogConsole.h"
+
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+
+namespace Diginext::Core::Storage {
+    using namespace std::chrono_literals;
+
+    // AppendEntries messages sent to one follower and not answered yet
+    const size_t PIPELINE_WINDOW = 32;
+
+    // entries per AppendEntries message stop growing past this, a single larger entry still goes
+    const size_t APPEND_MAX_BYTES = 1024 * 1024;
+
+    // pause before a lost peer connection is opened again
+    const auto RECONNECT_DELAY = 100ms;
+
+    string raft_role_to_string(RaftNode::Role role) {
+        switch (role) {
+            case RaftNode::Role::Follower:
+                return "follower";
+            case RaftNode::Role::Candidate:
+                return "candidate";
+            case RaftNode::Role::Leader:
+                return "leader";
+        }
+
+        return "unknown";
+    }
+
+    RaftNode::pointer RaftNode::create(boost::asio::io_service &ios, const StorageOptions &options, apply_callback apply,
+                                       leadership_callback leadershipLost) {
+        return std::make_shared<RaftNode>(ios, options, std::move(apply), std::move(leadershipLost));
+    }
+
+    RaftNode::RaftNode(boost::asio::io_service &ios, const StorageOptions &options, apply_callback apply, leadership_callback leadershipLost)
+        : ios(ios), log(options.raftLogPath, options.fsyncPolicy != FsyncPolicy::Async) {
+        this->logger = ConsoleLogger::create("RaftNode");
+        this->id = options.raftId;
+        this->electionTimeout = options.raftElectionTimeout;
+        this->maxBatch = std::max<size_t>(options.raftBatch, 1);
+        this->framing = options.framing;
+        this->apply = std::move(apply);
+        this->leadershipLost = std::move(leadershipLost);
+        this->role = Role::Follower;
+        this->commitIndex = 0;
+        this->lastApplied = 0;
+        this->termStart = 0;
+        this->seq = 0;
+        this->elections = 0;
+        this->flushPending = false;
+        this->random.seed(std::random_device()());
+
+        // constructed in place, handlers refer to peers by index
+        this->peers.resize(options.raftPeers.size());
+        for (size_t i = 0; i < options.raftPeers.size(); i++) {
+            const string &address = options.raftPeers[i];
+            const size_t colon = address.rfind(':');
+            if (colon == string::npos || colon == 0) {
+                throw std::invalid_argument("raft peer must be host:port: " + address);
+            }
+
+            this->peers[i].id = address;
+            this->peers[i].endpoint = tcp::endpoint(boost::asio::ip::address::from_string(address.substr(0, colon)),
+                                                    static_cast<unsigned short>(std::stoi(address.substr(colon + 1))));
+        }
+    }
+
+    RaftNode::~RaftNode() {
+        try {
+            if (this->tickTimer != nullptr) {
+                this->tickTimer->cancel();
+            }
+
+            for (auto &peer : this->peers) {
+                if (peer.reconnectTimer != nullptr) {
+                    peer.reconnectTimer->cancel();
+                }
+
+                if (peer.connection != nullptr) {
+                    boost::system::error_code ignored;
+                    peer.connection->socket().close(ignored);
+                }
+            }
+        } catch (...) {
+        }
+    }
+
+    void RaftNode::start() {
+        if (this->tickTimer != nullptr) {
+            return;
+        }
+
+        const size_t count = this->log.open();
+        this->logger->LogInfo("raft | node " + this->id + " | " + std::to_string(this->peers.size()) + " peers | term " +
+                              std::to_string(this->log.getTerm()) + " | " + std::to_string(count) + " log entries");
+
+        this->resetElectionDeadline();
+        for (size_t i = 0; i < this->peers.size(); i++) {
+            this->peers[i].reconnectTimer = std::make_unique<boost::asio::steady_timer>(this->ios);
+            this->connectPeer(i);
+        }
+
+        this->tickTimer = std::make_unique<boost::asio::steady_timer>(this->ios);
+        this->scheduleTick();
+    }
+
+    size_t RaftNode::quorum() const {
+        return (this->peers.size() + 1) / 2 + 1;
+    }
+
+    void RaftNode::resetElectionDeadline() {
+        // a random part keeps followers from running for the same term together
+        std::uniform_int_distribution<int64_t> spread(0, this->electionTimeout.count());
+        this->electionDeadline = clock::now() + this->electionTimeout + std::chrono::milliseconds(spread(this->random));
+    }
+
+    void RaftNode::scheduleTick() {
+        this->tickTimer->expires_after(this->electionTimeout / 10);
+        this->tickTimer->async_wait(boost::bind(&RaftNode::handle_tick, this, boost::asio::placeholders::error));
+    }
+
+    void RaftNode::handle_tick(const boost::system::error_code &error) {
+        if (error == boost::asio::error::operation_aborted) {
+            return;
+        }
+
+        this->tick();
+        this->scheduleTick();
+    }
+
+    void RaftNode::tick() {
+        const auto now = clock::now();
+        if (this->role != Role::Leader) {
+            if (now >= this->electionDeadline) {
+                this->startElection();
+            }
+            return;
+        }
+
+        for (auto &peer : this->peers) {
+            if (peer.connected && now - peer.lastSent >= this->electionTimeout / 5) {
+                this->sendAppend(peer);
+            }
+        }
+
+        // the others may have elected someone else by now, stop taking writes that cannot commit
+        if (!this->peers.empty() && now - std::max(this->quorumAckedAt(), this->leaderContact) > this->electionTimeout) {
+            this->logger->LogWarning("raft | no answer from a majority, stepping down in term " + std::to_string(this->log.getTerm()));
+            this->becomeFollower(this->log.getTerm());
+        }
+    }
+
+    void RaftNode::connectPeer(size_t index) {
+        Peer &peer = this->peers[index];
+        peer.closed.reset();
+        peer.connection = tcp_connection::create(this->ios);
+        peer.connection->requestFraming(this->framing);
+
+        peer.connection->onConnectionSuccess.connect(boost::bind(&RaftNode::handle_peer_connected, this, index, _1));
+        peer.connection->onConnectionError.connect(boost::bind(&RaftNode::handle_peer_disconnected, this, index, _1));
+        peer.connection->onConnectionTimedOut.connect(boost::bind(&RaftNode::handle_peer_disconnected, this, index, _1));
+        peer.connection->onDisconnected.connect(boost::bind(&RaftNode::handle_peer_disconnected, this, index, _1));
+        peer.connection->onReadError.connect(boost::bind(&RaftNode::handle_peer_disconnected, this, index, _1));
+        peer.connection->onSendError.connect(boost::bind(&RaftNode::handle_peer_disconnected, this, index, _1));
+        peer.connection->onReadMessage.connect(boost::bind(&RaftNode::handle_peer_message, this, index, _1, _2));
+
+        peer.connection->connect(peer.endpoint);
+    }
+
+    void RaftNode::handle_peer_connected(size_t index, tcp_connection *connection) {
+        Peer &peer = this->peers[index];
+        if (peer.connection.get() != connection) {
+            return;
+        }
+
+        // small messages in both directions, do not hold them back
+        boost::system::error_code ignored;
+        connection->socket().set_option(tcp::no_delay(true), ignored);
+
+        peer.connected = true;
+        this->logger->LogInfo("raft | connected to " + peer.id);
+
+        if (this->role == Role::Leader) {
+            // whatever was in flight on the old connection is gone
+            peer.nextIndex = peer.matchIndex + 1;
+            peer.inflight = 0;
+            peer.resetSeq = this->seq;
+            this->sendAppend(peer);
+            this->replicate(peer);
+        } else if (this->role == Role::Candidate && !peer.voteGranted) {
+            this->sendVoteRequest(peer);
+        }
+    }
+
+    void RaftNode::handle_peer_disconnected(size_t index, tcp_connection *connection) {
+        this->peerDown(index, connection);
+    }
+
+    void RaftNode::peerDown(size_t index, tcp_connection *connection) {
+        Peer &peer = this->peers[index];
+        if (peer.connection.get() != connection) {
+            return;
+        }
+
+        if (peer.connected) {
+            this->logger->LogInfo("raft | lost connection to " + peer.id);
+        }
+
+        // cleared first: disconnect reports the disconnect once more
+        peer.closed = peer.connection;
+        peer.connection.reset();
+        peer.connected = false;
+        peer.inflight = 0;
+        peer.sent.clear();
+        peer.closed->disconnect();
+
+        peer.reconnectTimer->expires_after(RECONNECT_DELAY);
+        peer.reconnectTimer->async_wait([this, index](const boost::system::error_code &error) {
+            if (error != boost::asio::error::operation_aborted) {
+                this->connectPeer(index);
+            }
+        });
+    }
+
+    void RaftNode::sendToPeer(Peer &peer, const nlohmann::json &message) {
+        if (peer.connected) {
+            peer.connection->send(message.dump());
+        }
+    }
+
+    void RaftNode::handle_peer_message(size_t index, tcp_connection *connection, std::string msg) {
+        Peer &peer = this->peers[index];
+        if (peer.connection.get() != connection) {
+            return;
+        }
+
+        try {
+            const nlohmann::json json = nlohmann::json::parse(msg);
+            if (!json.contains(JSON::KEY::RAFT)) {
+                this->logger->LogWarning("raft | " + peer.id + " answered " + json.value(JSON::KEY::DESCRIPTION, msg));
+                return;
+            }
+
+            const string type = json[JSON::KEY::RAFT].get<string>();
+            if (type == JSON::VALUE::RAFT_APPEND) {
+                this->handleAppendResult(peer, json);
+            } else if (type == JSON::VALUE::RAFT_VOTE) {
+                this->handleVoteResult(peer, json);
+            }
+        } catch (const nlohmann::json::exception &) {
+            this->logger->LogError("raft | malformed message from " + peer.id);
+        }
+    }
+
+    void RaftNode::becomeFollower(uint64_t term) {
+        const bool wasLeader = this->role == Role::Leader;
+        if (term > this->log.getTerm()) {
+            this->log.setState(term, string());
+            this->leader.clear();
+        }
+
+        this->role = Role::Follower;
+        this->resetElectionDeadline();
+
+        if (wasLeader) {
+            this->leader.clear();
+            this->batch.clear();
+
+            std::deque<PendingRead> failed;
+            failed.swap(this->reads);
+            for (auto &read : failed) {
+                read.callback(false);
+            }
+
+            this->leadershipLost();
+        }
+    }
+
+    void RaftNode::startElection() {
+        this->elections++;
+        this->leader.clear();
+        this->log.setState(this->log.getTerm() + 1, this->id);
+
+        if (this->peers.empty()) {
+            this->becomeLeader();
+            return;
+        }
+
+        this->role = Role::Candidate;
+        this->resetElectionDeadline();
+        this->logger->LogInfo("raft | election for term " + std::to_string(this->log.getTerm()));
+
+        for (auto &peer : this->peers) {
+            peer.voteGranted = false;
+            this->sendVoteRequest(peer);
+        }
+    }
+
+    void RaftNode::sendVoteRequest(Peer &peer) {
+        nlohmann::json message;
+        message[JSON::KEY::REQUEST] = JSON::VALUE::REQUEST_RAFT_VOTE;
+        message[JSON::KEY::TERM] = this->log.getTerm();
+        message[JSON::KEY::CANDIDATE] = this->id;
+        message[JSON::KEY::LAST_INDEX] = this->log.lastIndex();
+        message[JSON::KEY::LAST_TERM] = this->log.termAt(this->log.lastIndex());
+        this->sendToPeer(peer, message);
+    }
+
+    void RaftNode::becomeLeader() {
+        this->role = Role::Leader;
+        this->leader = this->id;
+        this->leaderContact = clock::now();
+        this->termStart = this->log.lastIndex() + 1;
+        this->logger->LogInfo("raft | leader of term " + std::to_string(this->log.getTerm()));
+
+        for (auto &peer : this->peers) {
+            peer.nextIndex = this->log.lastIndex() + 1;
+            peer.matchIndex = 0;
+            peer.inflight = 0;
+            peer.resetSeq = this->seq;
+            peer.sent.clear();
+            peer.ackedSeq = 0;
+            peer.ackedAt = clock::time_point();
+        }
+
+        // an entry of the new term commits everything before it and opens reads
+        this->batch.clear();
+        this->batch.push_back({ this->log.getTerm(), string() });
+        this->flush();
+    }
+
+    uint64_t RaftNode::propose(const string &command) {
+        if (this->role != Role::Leader) {
+            return 0;
+        }
+
+        this->batch.push_back({ this->log.getTerm(), command });
+        const uint64_t index = this->log.lastIndex() + this->batch.size();
+
+        // proposals queued on the server thread meanwhile share the log write and the messages
+        if (this->batch.size() >= this->maxBatch) {
+            this->flush();
+        } else if (!this->flushPending) {
+            this->flushPending = true;
+            this->ios.post([this]() {
+                this->flushPending = false;
+                this->flush();
+            });
+        }
+
+        return index;
+    }
+
+    void RaftNode::flush() {
+        if (this->batch.empty() || this->role != Role::Leader) {
+            this->batch.clear();
+            return;
+        }
+
+        this->log.append(this->batch);
+        this->batch.clear();
+
+        for (auto &peer : this->peers) {
+            this->replicate(peer);
+        }
+        this->advanceCommit();
+    }
+
+    void RaftNode::replicate(Peer &peer) {
+        if (!peer.connected) {
+            return;
+        }
+
+        // no waiting for answers, the connection keeps the messages in order
+        while (peer.inflight < PIPELINE_WINDOW && peer.nextIndex <= this->log.lastIndex()) {
+            this->sendAppend(peer);
+        }
+    }
+
+    void RaftNode::sendAppend(Peer &peer) {
+        const uint64_t prevIndex = peer.nextIndex - 1;
+
+        nlohmann::json entries = nlohmann::json::array();
+        size_t bytes = 0;
+        uint64_t index = peer.nextIndex;
+        while (index <= this->log.lastIndex() && entries.size() < this->maxBatch && (entries.empty() || bytes < APPEND_MAX_BYTES)) {
+            const RaftLog::Entry &entry = this->log.at(index++);
+            nlohmann::json item;
+            item[JSON::KEY::TERM] = entry.term;
+            item[JSON::KEY::COMMAND] = entry.command;
+            entries.push_back(std::move(item));
+            bytes += entry.command.size();
+        }
+
+        nlohmann::json message;
+        message[JSON::KEY::REQUEST] = JSON::VALUE::REQUEST_RAFT_APPEND;
+        message[JSON::KEY::TERM] = this->log.getTerm();
+        message[JSON::KEY::LEADER] = this->id;
+        message[JSON::KEY::SEQ] = ++this->seq;
+        message[JSON::KEY::PREV_INDEX] = prevIndex;
+        message[JSON::KEY::PREV_TERM] = this->log.termAt(prevIndex);
+        message[JSON::KEY::COMMIT_INDEX] = this->commitIndex;
+        message[JSON::KEY::ENTRIES] = std::move(entries);
+
+        const auto now = clock::now();
+        peer.sent.emplace_back(this->seq, now);
+        peer.lastSent = now;
+        peer.inflight++;
+        peer.nextIndex = index;
+        this->sendToPeer(peer, message);
+    }
+
+    void RaftNode::advanceCommit() {
+        if (this->role != Role::Leader) {
+            return;
+        }
+
+        // the highest index a majority has on disk, the leader's own log included
+        std::vector<uint64_t> matches{ this->log.lastIndex() };
+        for (const auto &peer : this->peers) {
+            matches.push_back(peer.matchIndex);
+        }
+        std::sort(matches.begin(), matches.end(), std::greater<uint64_t>());
+
+        // entries of earlier terms commit only together with one of this term
+        const uint64_t index = matches[this->quorum() - 1];
+        if (index > this->commitIndex && this->log.termAt(index) == this->log.getTerm()) {
+            this->commitIndex = index;
+            this->applyCommitted();
+            this->serveReads();
+        }
+    }
+
+    void RaftNode::applyCommitted() {
+        while (this->lastApplied < this->commitIndex) {
+            const RaftLog::Entry &entry = this->log.at(++this->lastApplied);
+            if (!entry.command.empty()) {
+                this->apply(this->lastApplied, entry.command);
+            }
+        }
+    }
+
+    uint64_t RaftNode::quorumAckedSeq() const {
+        std::vector<uint64_t> acked{ std::numeric_limits<uint64_t>::max() };
+        for (const auto &peer : this->peers) {
+            acked.push_back(peer.ackedSeq);
+        }
+        std::sort(acked.begin(), acked.end(), std::greater<uint64_t>());
+
+        return acked[this->quorum() - 1];
+    }
+
+    RaftNode::clock::time_point RaftNode::quorumAckedAt() const {
+        std::vector<clock::time_point> acked{ clock::now() };
+        for (const auto &peer : this->peers) {
+            acked.push_back(peer.ackedAt);
+        }
+        std::sort(acked.begin(), acked.end(), std::greater<clock::time_point>());
+
+        return acked[this->quorum() - 1];
+    }
+
+    bool RaftNode::hasLease() const {
+        if (this->role != Role::Leader || this->commitIndex < this->termStart) {
+            return false;
+        }
+
+        // a majority accepted this leader at that time and refuses other candidates for an election
+        // timeout after it; a margin is left for clock drift between the nodes
+        return clock::now() < this->quorumAckedAt() + this->electionTimeout * 9 / 10;
+    }
+
+    void RaftNode::read(const read_callback &callback) {
+        if (this->role != Role::Leader) {
+            callback(false);
+            return;
+        }
+
+        if (this->hasLease()) {
+            callback(true);
+            return;
+        }
+
+        // read index: a majority must still follow this leader after the read arrived
+        this->reads.push_back({ this->seq + 1, callback });
+        for (auto &peer : this->peers) {
+            if (peer.connected) {
+                this->sendAppend(peer);
+            }
+        }
+        this->serveReads();
+    }
+
+    void RaftNode::serveReads() {
+        if (this->role != Role::Leader || this->commitIndex < this->termStart) {
+            return;
+        }
+
+        const uint64_t acked = this->quorumAckedSeq();
+        while (!this->reads.empty() && this->reads.front().seq <= acked) {
+            const read_callback callback = std::move(this->reads.front().callback);
+            this->reads.pop_front();
+            callback(true);
+        }
+    }
+
+    void RaftNode::handleRequest(tcp_connection::pointer connection, const string &request, const nlohmann::json &json) {
+        if (request == JSON::VALUE::REQUEST_RAFT_APPEND) {
+            this->handleAppend(connection, json);
+        } else if (request == JSON::VALUE::REQUEST_RAFT_VOTE) {
+            this->handleVote(connection, json);
+        }
+    }
+
+    void RaftNode::handleAppend(tcp_connection::pointer connection, const nlohmann::json &json) {
+        const uint64_t term = json[JSON::KEY::TERM].get<uint64_t>();
+
+        nlohmann::json answer;
+        answer[JSON::KEY::RAFT] = JSON::VALUE::RAFT_APPEND;
+        answer[JSON::KEY::FROM] = this->id;
+        answer[JSON::KEY::SEQ] = json[JSON::KEY::SEQ];
+        answer[JSON::KEY::SUCCESS] = false;
+        answer[JSON::KEY::MATCH] = 0;
+
+        if (term < this->log.getTerm()) {
+            answer[JSON::KEY::TERM] = this->log.getTerm();
+            connection->send(answer.dump());
+            return;
+        }
+
+        if (term > this->log.getTerm() || this->role != Role::Follower) {
+            this->becomeFollower(term);
+        }
+        this->leader = json[JSON::KEY::LEADER].get<string>();
+        this->leaderContact = clock::now();
+        this->resetElectionDeadline();
+
+        const uint64_t prevIndex = json[JSON::KEY::PREV_INDEX].get<uint64_t>();
+        const uint64_t prevTerm = json[JSON::KEY::PREV_TERM].get<uint64_t>();
+        if (prevIndex > this->log.lastIndex() || this->log.termAt(prevIndex) != prevTerm) {
+            // where the leader should continue: the end of this log, or the start of the conflicting term
+            uint64_t next = std::min(prevIndex, this->log.lastIndex() + 1);
+            if (next <= this->log.lastIndex()) {
+                const uint64_t conflictTerm = this->log.termAt(next);
+                while (next > this->commitIndex + 1 && this->log.termAt(next - 1) == conflictTerm) {
+                    next--;
+                }
+            }
+
+            answer[JSON::KEY::TERM] = this->log.getTerm();
+            answer[JSON::KEY::MATCH] = next;
+            connection->send(answer.dump());
+            return;
+        }
+
+        // entries already here are skipped, the first conflicting one and all after it replaced
+        const auto &entries = json[JSON::KEY::ENTRIES];
+        std::vector<RaftLog::Entry> appended;
+        uint64_t index = prevIndex;
+        for (const auto &item : entries) {
+            const uint64_t entryTerm = item[JSON::KEY::TERM].get<uint64_t>();
+            index++;
+            if (appended.empty() && index <= this->log.lastIndex()) {
+                if (this->log.termAt(index) == entryTerm) {
+                    continue;
+                }
+                this->log.truncate(index);
+            }
+            appended.push_back({ entryTerm, item[JSON::KEY::COMMAND].get<string>() });
+        }
+        this->log.append(appended);
+
+        const uint64_t lastNew = prevIndex + entries.size();
+        const uint64_t leaderCommit = json[JSON::KEY::COMMIT_INDEX].get<uint64_t>();
+        if (leaderCommit > this->commitIndex) {
+            this->commitIndex = std::max(this->commitIndex, std::min(leaderCommit, lastNew));
+            this->applyCommitted();
+        }
+
+        answer[JSON::KEY::TERM] = this->log.getTerm();
+        answer[JSON::KEY::SUCCESS] = true;
+        answer[JSON::KEY::MATCH] = lastNew;
+        connection->send(answer.dump());
+    }
+
+    void RaftNode::handleAppendResult(Peer &peer, const nlohmann::json &json) {
+        const uint64_t term = json[JSON::KEY::TERM].get<uint64_t>();
+        if (term > this->log.getTerm()) {
+            this->becomeFollower(term);
+            return;
+        }
+
+        if (this->role != Role::Leader || term != this->log.getTerm()) {
+            return;
+        }
+
+        // any answer of this term means the follower accepted this leader when it got the message
+        const uint64_t answered = json[JSON::KEY::SEQ].get<uint64_t>();
+        while (!peer.sent.empty() && peer.sent.front().first <= answered) {
+            if (peer.sent.front().first == answered) {
+                peer.ackedAt = std::max(peer.ackedAt, peer.sent.front().second);
+            }
+            peer.sent.pop_front();
+        }
+        peer.ackedSeq = std::max(peer.ackedSeq, answered);
+
+        const uint64_t match = json[JSON::KEY::MATCH].get<uint64_t>();
+        if (json[JSON::KEY::SUCCESS].get<bool>()) {
+            peer.matchIndex = std::max(peer.matchIndex, match);
+        }
+
+        if (answered > peer.resetSeq) {
+            peer.inflight = peer.inflight > 0 ? peer.inflight - 1 : 0;
+
+            if (!json[JSON::KEY::SUCCESS].get<bool>()) {
+                // the follower's log differs, messages after this one are answered with failures too
+                peer.nextIndex = std::max(std::min(match, this->log.lastIndex() + 1), peer.matchIndex + 1);
+                peer.inflight = 0;
+                peer.resetSeq = this->seq;
+            }
+        }
+
+        this->advanceCommit();
+        this->serveReads();
+        this->replicate(peer);
+    }
+
+    void RaftNode::handleVote(tcp_connection::pointer connection, const nlohmann::json &json) {
+        const uint64_t term = json[JSON::KEY::TERM].get<uint64_t>();
+        const string candidate = json[JSON::KEY::CANDIDATE].get<string>();
+
+        // while a leader is alive its lease holds: no term change, no vote
+        const bool leaderAlive = this->role == Role::Leader || clock::now() - this->leaderContact < this->electionTimeout;
+        if (!leaderAlive && term > this->log.getTerm()) {
+            this->becomeFollower(term);
+        }
+
+        const uint64_t lastTerm = this->log.termAt(this->log.lastIndex());
+        const uint64_t candidateLastTerm = json[JSON::KEY::LAST_TERM].get<uint64_t>();
+        const bool upToDate = candidateLastTerm > lastTerm ||
+                              (candidateLastTerm == lastTerm && json[JSON::KEY::LAST_INDEX].get<uint64_t>() >= this->log.lastIndex());
+
+        bool granted = false;
+        if (!leaderAlive && term == this->log.getTerm() && upToDate &&
+            (this->log.getVotedFor().empty() || this->log.getVotedFor() == candidate)) {
+            this->log.setState(term, candidate);
+            this->resetElectionDeadline();
+            granted = true;
+        }
+
+        nlohmann::json answer;
+        answer[JSON::KEY::RAFT] = JSON::VALUE::RAFT_VOTE;
+        answer[JSON::KEY::FROM] = this->id;
+        answer[JSON::KEY::TERM] = this->log.getTerm();
+        answer[JSON::KEY::GRANTED] = granted;
+        connection->send(answer.dump());
+    }
+
+    void RaftNode::handleVoteResult(Peer &peer, const nlohmann::json &json) {
+        const uint64_t term = json[JSON::KEY::TERM].get<uint64_t>();
+        if (term > this->log.getTerm()) {
+            this->becomeFollower(term);
+            return;
+        }
+
+        if (this->role != Role::Candidate || term != this->log.getTerm() || !json[JSON::KEY::GRANTED].get<bool>()) {
+            return;
+        }
+
+        peer.voteGranted = true;
+        size_t votes = 1;
+        for (const auto &other : this->peers) {
+            votes += other.voteGranted ? 1 : 0;
+        }
+
+        if (votes >= this->quorum()) {
+            this->becomeLeader();
+        }
+    }
+
+    bool RaftNode::isLeader() const {
+        return this->role == Role::Leader;
+    }
+
+    const string &RaftNode::getLeader() const {
+        return this->leader;
+    }
+
+    const string &RaftNode::getId() const {
+        return this->id;
+    }
+
+    RaftNode::Role RaftNode::getRole() const {
+        return this->role;
+    }
+
+    uint64_t RaftNode::getTerm() const {
+        return this->log.getTerm();
+    }
+
+    uint64_t RaftNode::getCommitIndex() const {
+        return this->commitIndex;
+    }
+
+    uint64_t RaftNode::getLastIndex() const {
+        return this->log.lastIndex();
+    }
+
+    uint64_t RaftNode::getElections() const {
+        return this->elections;
+    }
+
+    std::vector<RaftNode::PeerStatus> RaftNode::getPeers() const {
+        std::vector<PeerStatus> result;
+        for (const auto &peer : this->peers) {
+            result.push_back({ peer.id, peer.connected, peer.matchIndex });
+        }
+
+        return result;
+    }
+}// namespace Diginext::Core::Storage
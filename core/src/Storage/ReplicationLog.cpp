@@ -0,0 +1,77 @@
+#include "Storage/ReplicationLog.h"
+
+#include <boost/uuid/uuid.hpp>
+#include <boost/uuid/uuid_generators.hpp>
+#include <boost/uuid/uuid_io.hpp>
+
+namespace Diginext::Core::Storage {
+
+    // deque node and string headers per record
+    const size_t RECORD_OVERHEAD = 96;
+
+    ReplicationLog::ReplicationLog(size_t maxBytes) {
+        this->id = boost::uuids::to_string(boost::uuids::random_generator()());
+        this->maxBytes = maxBytes;
+        this->bytes = 0;
+        this->position = 0;
+    }
+
+    size_t ReplicationLog::recordBytes(const Record &record) {
+        return RECORD_OVERHEAD + record.key.size() + record.value.size();
+    }
+
+    const string &ReplicationLog::getId() const {
+        return this->id;
+    }
+
+    uint64_t ReplicationLog::getPosition() const {
+        return this->position;
+    }
+
+    size_t ReplicationLog::getBytes() const {
+        return this->bytes;
+    }
+
+    void ReplicationLog::append(WalRecordType type, const string &key, const string &value) {
+        this->records.push_back({ ++this->position, type, key, value });
+        this->bytes += recordBytes(this->records.back());
+
+        // the newest record stays even if it alone is over the budget
+        while (this->bytes > this->maxBytes && this->records.size() > 1) {
+            this->bytes -= recordBytes(this->records.front());
+            this->records.pop_front();
+        }
+    }
+
+    bool ReplicationLog::covers(uint64_t after) const {
+        if (after > this->position) {
+            return false;
+        }
+
+        // nothing after it, or the next record is still kept
+        return after == this->position || (!this->records.empty() && this->records.front().position <= after + 1);
+    }
+
+    size_t ReplicationLog::read(uint64_t after, size_t maxRecords, size_t maxBytes, const record_callback &callback) const {
+        if (!this->covers(after) || after == this->position) {
+            return 0;
+        }
+
+        // positions are contiguous, the first wanted record is found by offset
+        size_t index = static_cast<size_t>(after + 1 - this->records.front().position);
+        size_t count = 0;
+        size_t bytes = 0;
+        for (; index < this->records.size() && count < maxRecords; index++) {
+            const Record &record = this->records[index];
+            if (count > 0 && bytes + recordBytes(record) > maxBytes) {
+                break;
+            }
+
+            callback(record);
+            bytes += recordBytes(record);
+            count++;
+        }
+
+        return count;
+    }
+}// namespace Diginext::Core::Storage
@@ -0,0 +1,501 @@
+#include "Storage/RequestCodec.h"
+
+#include "Storage/StorageCommon.h"
+
+#include <charconv>
+#include <cstring>
+#include <limits>
+
+namespace Diginext::Core::Storage {
+    const uint64_t ONES = 0x0101010101010101ULL;
+    const uint64_t HIGHS = 0x8080808080808080ULL;
+
+    /**
+     * @brief high bit set in every byte of word below 0x20 or equal to '"' or '\\', 0 for a plain run
+     * \details eight bytes per step; a byte with the high bit set may be flagged too, callers then
+     * look at the bytes one by one
+     */
+    static uint64_t special_bytes(uint64_t word) {
+        const uint64_t control = word - ONES * 0x20;
+        const uint64_t quote = (word ^ (ONES * '"')) - ONES;
+        const uint64_t backslash = (word ^ (ONES * '\\')) - ONES;
+        return (control | quote | backslash) & ~word & HIGHS;
+    }
+
+    /**
+     * @brief bytes from pos on that need no look: no quote, backslash, control or non-ASCII byte
+     */
+    static size_t plain_run(const char *data, size_t pos, size_t size, bool stopAtHigh) {
+        const size_t start = pos;
+        while (pos + 8 <= size) {
+            uint64_t word;
+            std::memcpy(&word, data + pos, 8);
+            if (special_bytes(word) != 0 || (stopAtHigh && (word & HIGHS) != 0)) {
+                break;
+            }
+            pos += 8;
+        }
+        return pos - start;
+    }
+
+    static bool is_space(char c) {
+        return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+    }
+
+    static void skip_space(string_view in, size_t &pos) {
+        while (pos < in.size() && is_space(in[pos])) {
+            pos++;
+        }
+    }
+
+    static bool is_continuation(string_view in, size_t pos, unsigned char low = 0x80, unsigned char high = 0xBF) {
+        if (pos >= in.size()) {
+            return false;
+        }
+
+        const auto c = static_cast<unsigned char>(in[pos]);
+        return c >= low && c <= high;
+    }
+
+    /**
+     * @brief step over one multi-byte UTF-8 sequence, rejecting what nlohmann rejects: overlong
+     * forms, surrogates, code points above U+10FFFF
+     */
+    static bool skip_utf8(string_view in, size_t &pos) {
+        const auto c = static_cast<unsigned char>(in[pos]);
+        size_t length = 0;
+        bool valid = false;
+        if (c >= 0xC2 && c <= 0xDF) {
+            length = 2;
+            valid = is_continuation(in, pos + 1);
+        } else if (c == 0xE0) {
+            length = 3;
+            valid = is_continuation(in, pos + 1, 0xA0) && is_continuation(in, pos + 2);
+        } else if ((c >= 0xE1 && c <= 0xEC) || c == 0xEE || c == 0xEF) {
+            length = 3;
+            valid = is_continuation(in, pos + 1) && is_continuation(in, pos + 2);
+        } else if (c == 0xED) {
+            length = 3;
+            valid = is_continuation(in, pos + 1, 0x80, 0x9F) && is_continuation(in, pos + 2);
+        } else if (c == 0xF0) {
+            length = 4;
+            valid = is_continuation(in, pos + 1, 0x90) && is_continuation(in, pos + 2) && is_continuation(in, pos + 3);
+        } else if (c >= 0xF1 && c <= 0xF3) {
+            length = 4;
+            valid = is_continuation(in, pos + 1) && is_continuation(in, pos + 2) && is_continuation(in, pos + 3);
+        } else if (c == 0xF4) {
+            length = 4;
+            valid = is_continuation(in, pos + 1, 0x80, 0x8F) && is_continuation(in, pos + 2) && is_continuation(in, pos + 3);
+        }
+
+        pos += length;
+        return valid;
+    }
+
+    static bool read_hex4(string_view in, size_t pos, uint32_t &value) {
+        if (pos + 4 > in.size()) {
+            return false;
+        }
+
+        value = 0;
+        for (size_t i = pos; i < pos + 4; i++) {
+            const char c = in[i];
+            value <<= 4;
+            if (c >= '0' && c <= '9') {
+                value |= static_cast<uint32_t>(c - '0');
+            } else if (c >= 'a' && c <= 'f') {
+                value |= static_cast<uint32_t>(c - 'a' + 10);
+            } else if (c >= 'A' && c <= 'F') {
+                value |= static_cast<uint32_t>(c - 'A' + 10);
+            } else {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    static void append_utf8(string &out, uint32_t codePoint) {
+        if (codePoint < 0x80) {
+            out.push_back(static_cast<char>(codePoint));
+        } else if (codePoint < 0x800) {
+            out.push_back(static_cast<char>(0xC0 | (codePoint >> 6)));
+            out.push_back(static_cast<char>(0x80 | (codePoint & 0x3F)));
+        } else if (codePoint < 0x10000) {
+            out.push_back(static_cast<char>(0xE0 | (codePoint >> 12)));
+            out.push_back(static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F)));
+            out.push_back(static_cast<char>(0x80 | (codePoint & 0x3F)));
+        } else {
+            out.push_back(static_cast<char>(0xF0 | (codePoint >> 18)));
+            out.push_back(static_cast<char>(0x80 | ((codePoint >> 12) & 0x3F)));
+            out.push_back(static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F)));
+            out.push_back(static_cast<char>(0x80 | (codePoint & 0x3F)));
+        }
+    }
+
+    /**
+     * @brief the escape at pos (just past the backslash) decoded onto buffer
+     */
+    static bool read_escape(string_view in, size_t &pos, string &buffer) {
+        if (pos >= in.size()) {
+            return false;
+        }
+
+        const char c = in[pos++];
+        switch (c) {
+            case '"':
+            case '\\':
+            case '/':
+                buffer.push_back(c);
+                return true;
+            case 'b':
+                buffer.push_back('\b');
+                return true;
+            case 'f':
+                buffer.push_back('\f');
+                return true;
+            case 'n':
+                buffer.push_back('\n');
+                return true;
+            case 'r':
+                buffer.push_back('\r');
+                return true;
+            case 't':
+                buffer.push_back('\t');
+                return true;
+            case 'u':
+                break;
+            default:
+                return false;
+        }
+
+        uint32_t codePoint = 0;
+        if (!read_hex4(in, pos, codePoint)) {
+            return false;
+        }
+        pos += 4;
+
+        if (codePoint >= 0xDC00 && codePoint <= 0xDFFF) {
+            return false;
+        }
+
+        // a high surrogate needs its low half right behind it
+        if (codePoint >= 0xD800 && codePoint <= 0xDBFF) {
+            uint32_t low = 0;
+            if (pos + 6 > in.size() || in[pos] != '\\' || in[pos + 1] != 'u' || !read_hex4(in, pos + 2, low) || low < 0xDC00 || low > 0xDFFF) {
+                return false;
+            }
+            pos += 6;
+            codePoint = 0x10000 + ((codePoint - 0xD800) << 10) + (low - 0xDC00);
+        }
+
+        append_utf8(buffer, codePoint);
+        return true;
+    }
+
+    /**
+     * @brief the string starting at the quote at pos; a view into in, or into buffer if it had escapes
+     */
+    static bool read_string(string_view in, size_t &pos, string &buffer, string_view &out) {
+        const size_t start = ++pos;
+
+        // the common case: no escapes, nothing to copy
+        while (pos < in.size()) {
+            pos += plain_run(in.data(), pos, in.size(), true);
+            if (pos >= in.size()) {
+                break;
+            }
+
+            const auto c = static_cast<unsigned char>(in[pos]);
+            if (c == '"') {
+                out = in.substr(start, pos - start);
+                pos++;
+                return true;
+            }
+            if (c == '\\') {
+                break;
+            }
+            if (c < 0x20) {
+                return false;
+            }
+            if (c >= 0x80) {
+                if (!skip_utf8(in, pos)) {
+                    return false;
+                }
+                continue;
+            }
+            pos++;
+        }
+
+        if (pos >= in.size()) {
+            return false;
+        }
+
+        buffer.assign(in.data() + start, pos - start);
+        while (pos < in.size()) {
+            const auto c = static_cast<unsigned char>(in[pos]);
+            if (c == '"') {
+                out = buffer;
+                pos++;
+                return true;
+            }
+            if (c < 0x20) {
+                return false;
+            }
+            if (c == '\\') {
+                if (!read_escape(in, ++pos, buffer)) {
+                    return false;
+                }
+                continue;
+            }
+
+            const size_t from = pos;
+            if (c >= 0x80) {
+                if (!skip_utf8(in, pos)) {
+                    return false;
+                }
+            } else {
+                pos++;
+            }
+            buffer.append(in.data() + from, pos - from);
+        }
+
+        return false;
+    }
+
+    /**
+     * @brief a JSON integer; fractions and exponents are left to the generic parser
+     */
+    static bool read_integer(string_view in, size_t &pos, bool &negative, uint64_t &magnitude) {
+        negative = pos < in.size() && in[pos] == '-';
+        if (negative) {
+            pos++;
+        }
+
+        const size_t start = pos;
+        while (pos < in.size() && in[pos] >= '0' && in[pos] <= '9') {
+            pos++;
+        }
+        if (pos == start || (in[start] == '0' && pos - start > 1)) {
+            return false;
+        }
+        if (pos < in.size() && (in[pos] == '.' || in[pos] == 'e' || in[pos] == 'E')) {
+            return false;
+        }
+
+        const auto result = std::from_chars(in.data() + start, in.data() + pos, magnitude);
+        return result.ec == std::errc();
+    }
+
+    static bool read_field(string_view in, size_t &pos, string_view name, ParsedRequest &request) {
+        if (pos >= in.size()) {
+            return false;
+        }
+
+        if (name == JSON::KEY::REQUEST || name == JSON::KEY::KEY || name == JSON::KEY::VALUE) {
+            if (in[pos] != '"') {
+                return false;
+            }
+
+            if (name == JSON::KEY::REQUEST) {
+                return read_string(in, pos, request.requestBuffer, request.request);
+            }
+            if (name == JSON::KEY::KEY) {
+                request.hasKey = true;
+                return read_string(in, pos, request.keyBuffer, request.key);
+            }
+            request.hasValue = true;
+            return read_string(in, pos, request.valueBuffer, request.value);
+        }
+
+        bool negative = false;
+        uint64_t magnitude = 0;
+        if (name == JSON::KEY::TTL) {
+            if (!read_integer(in, pos, negative, magnitude) || magnitude > static_cast<uint64_t>(std::numeric_limits<int64_t>::max())) {
+                return false;
+            }
+            request.hasTtl = true;
+            request.ttl = negative ? -static_cast<int64_t>(magnitude) : static_cast<int64_t>(magnitude);
+            return true;
+        }
+
+        if (name == JSON::KEY::IF_VERSION) {
+            if (!read_integer(in, pos, negative, magnitude) || negative) {
+                return false;
+            }
+            request.hasIfVersion = true;
+            request.ifVersion = magnitude;
+            return true;
+        }
+
+        return false;
+    }
+
+    bool parse_request(string_view message, ParsedRequest &request) {
+        request.request = string_view();
+        request.key = string_view();
+        request.value = string_view();
+        request.hasKey = false;
+        request.hasValue = false;
+        request.hasTtl = false;
+        request.hasIfVersion = false;
+        request.ttl = 0;
+        request.ifVersion = 0;
+
+        size_t pos = 0;
+        skip_space(message, pos);
+        if (pos >= message.size() || message[pos++] != '{') {
+            return false;
+        }
+
+        bool hasRequest = false;
+        skip_space(message, pos);
+        if (pos < message.size() && message[pos] == '}') {
+            pos++;
+        } else {
+            for (;;) {
+                // field names are plain ASCII, one with escapes is not one of ours anyway
+                if (pos >= message.size() || message[pos] != '"') {
+                    return false;
+                }
+                const size_t nameStart = ++pos;
+                while (pos < message.size() && message[pos] != '"' && message[pos] != '\\') {
+                    pos++;
+                }
+                if (pos >= message.size() || message[pos] != '"') {
+                    return false;
+                }
+                const string_view name = message.substr(nameStart, pos - nameStart);
+                pos++;
+
+                skip_space(message, pos);
+                if (pos >= message.size() || message[pos++] != ':') {
+                    return false;
+                }
+                skip_space(message, pos);
+
+                if (!read_field(message, pos, name, request)) {
+                    return false;
+                }
+                hasRequest = hasRequest || name == JSON::KEY::REQUEST;
+
+                skip_space(message, pos);
+                if (pos >= message.size()) {
+                    return false;
+                }
+                const char next = message[pos++];
+                if (next == '}') {
+                    break;
+                }
+                if (next != ',') {
+                    return false;
+                }
+                skip_space(message, pos);
+            }
+        }
+
+        skip_space(message, pos);
+        return hasRequest && pos == message.size();
+    }
+
+    bool valid_utf8(string_view text) {
+        size_t pos = 0;
+        while (pos < text.size()) {
+            if (static_cast<unsigned char>(text[pos]) < 0x80) {
+                pos++;
+            } else if (!skip_utf8(text, pos)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    void write_json_string(string &out, string_view text) {
+        static const char HEX[] = "0123456789abcdef";
+
+        out.reserve(out.size() + text.size() + 2);
+        out.push_back('"');
+        size_t run = 0;
+        for (size_t i = 0; i < text.size(); i++) {
+            // UTF-8 goes out as it is, only the escapes need a look
+            i += plain_run(text.data(), i, text.size(), false);
+            if (i >= text.size()) {
+                break;
+            }
+
+            const auto c = static_cast<unsigned char>(text[i]);
+            if (c >= 0x20 && c != '"' && c != '\\') {
+                continue;
+            }
+
+            out.append(text.data() + run, i - run);
+            run = i + 1;
+            switch (c) {
+                case '"':
+                    out.append("\\\"", 2);
+                    break;
+                case '\\':
+                    out.append("\\\\", 2);
+                    break;
+                case '\b':
+                    out.append("\\b", 2);
+                    break;
+                case '\f':
+                    out.append("\\f", 2);
+                    break;
+                case '\n':
+                    out.append("\\n", 2);
+                    break;
+                case '\r':
+                    out.append("\\r", 2);
+                    break;
+                case '\t':
+                    out.append("\\t", 2);
+                    break;
+                default: {
+                    const char escaped[] = { '\\', 'u', '0', '0', HEX[c >> 4], HEX[c & 0xF] };
+                    out.append(escaped, sizeof(escaped));
+                    break;
+                }
+            }
+        }
+        out.append(text.data() + run, text.size() - run);
+        out.push_back('"');
+    }
+
+    void ResponseWriter::name(const string &field) {
+        if (!this->first) {
+            this->out.push_back(',');
+        }
+        this->first = false;
+
+        this->out.push_back('"');
+        this->out.append(field);
+        this->out.append("\":", 2);
+    }
+
+    ResponseWriter &ResponseWriter::begin() {
+        this->out.clear();
+        this->out.push_back('{');
+        this->first = true;
+        return *this;
+    }
+
+    ResponseWriter &ResponseWriter::field(const string &name, string_view value) {
+        this->name(name);
+        write_json_string(this->out, value);
+        return *this;
+    }
+
+    ResponseWriter &ResponseWriter::field(const string &name, uint64_t value) {
+        this->name(name);
+        char digits[24];
+        const auto result = std::to_chars(digits, digits + sizeof(digits), value);
+        this->out.append(digits, result.ptr - digits);
+        return *this;
+    }
+
+    const string &ResponseWriter::end() {
+        this->out.push_back('}');
+        return this->out;
+    }
+}// namespace Diginext::Core::Storage
@@ -0,0 +1,410 @@
+#include "Storage/RespCodec.h"
+
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+
+namespace Diginext::Core::Storage {
+    const string CRLF = "\r\n";
+
+    const RespCommandInfo RESP_COMMANDS[] = {
+            { resp_command::Ping, "ping", -1, false },
+            { resp_command::Echo, "echo", 2, false },
+            { resp_command::Quit, "quit", -1, false },
+            { resp_command::Select, "select", 2, false },
+            { resp_command::Command, "command", -1, false },
+            { resp_command::Config, "config", -2, false },
+            { resp_command::Client, "client", -2, false },
+            { resp_command::Info, "info", -1, false },
+            { resp_command::DbSize, "dbsize", 1, false },
+            { resp_command::Get, "get", 2, false },
+            { resp_command::MGet, "mget", -2, false },
+            { resp_command::Exists, "exists", -2, false },
+            { resp_command::StrLen, "strlen", 2, false },
+            { resp_command::Set, "set", -3, true },
+            { resp_command::SetNx, "setnx", 3, true },
+            { resp_command::SetEx, "setex", 4, true },
+            { resp_command::PSetEx, "psetex", 4, true },
+            { resp_command::MSet, "mset", -3, true },
+            { resp_command::Del, "del", -2, true },
+            { resp_command::Del, "unlink", -2, true },
+            { resp_command::Incr, "incr", 2, true },
+            { resp_command::Decr, "decr", 2, true },
+            { resp_command::IncrBy, "incrby", 3, true },
+            { resp_command::DecrBy, "decrby", 3, true },
+            { resp_command::Append, "append", 3, true },
+            { resp_command::Expire, "expire", 3, true },
+            { resp_command::PExpire, "pexpire", 3, true },
+            { resp_command::Persist, "persist", 2, true },
+            { resp_command::Ttl, "ttl", 2, false },
+            { resp_command::PTtl, "pttl", 2, false },
+    };
+
+    /**
+     * @brief strict decimal integer, no spaces or plus sign
+     */
+    static bool parse_decimal(string_view text, int64_t &value) {
+        if (text.empty()) {
+            return false;
+        }
+
+        const auto result = std::from_chars(text.data(), text.data() + text.size(), value);
+        return result.ec == std::errc() && result.ptr == text.data() + text.size();
+    }
+
+    /**
+     * @brief text with CR and LF blanked, a simple string or error ends at the first of them
+     */
+    static void append_line(string &out, string_view text) {
+        const size_t start = out.size();
+        out.append(text);
+        for (size_t i = start; i < out.size(); i++) {
+            if (out[i] == '\r' || out[i] == '\n') {
+                out[i] = ' ';
+            }
+        }
+        out.append(CRLF);
+    }
+
+    void RespParser::feed(string_view chunk) {
+        // nothing left over - the commands are parsed in the chunk itself
+        this->fromPending = !this->pending.empty();
+        if (this->fromPending) {
+            // room for all of it up front, views into pending survive what is moved over later
+            this->pending.reserve(this->pending.size() + chunk.size());
+            this->input = this->pending;
+            this->rest = chunk;
+        } else {
+            this->input = chunk;
+            this->rest = string_view();
+        }
+        this->offset = 0;
+    }
+
+    resp_parse RespParser::next() {
+        if (!this->fromPending) {
+            return this->parse();
+        }
+
+        const resp_parse status = this->completePending();
+        if (status == resp_parse::Command && this->offset == this->input.size()) {
+            // the cut command is whole, the commands behind it are in the chunk
+            this->input = this->rest;
+            this->rest = string_view();
+            this->fromPending = false;
+            this->offset = 0;
+        }
+        return status;
+    }
+
+    resp_parse RespParser::completePending() {
+        for (;;) {
+            const resp_parse status = this->parse();
+            if (status != resp_parse::Incomplete || this->rest.empty()) {
+                return status;
+            }
+
+            // the missing part of a bulk string or the next line, nothing of the commands behind it
+            size_t take = this->rest.size();
+            if (this->needed != 0) {
+                take = this->needed - (this->pending.size() - this->offset);
+            } else {
+                const void *found = std::memchr(this->rest.data(), '\n', this->rest.size());
+                if (found != nullptr) {
+                    take = static_cast<const char *>(found) - this->rest.data() + 1;
+                }
+            }
+            take = std::min(take, this->rest.size());
+
+            // within the capacity reserved by feed, the arguments taken so far stay where they are
+            this->pending.append(this->rest.substr(0, take));
+            this->rest.remove_prefix(take);
+            this->input = this->pending;
+        }
+    }
+
+    resp_parse RespParser::parse() {
+        // a bulk string still coming in is not looked at again until all of it is there
+        if (this->needed != 0 && this->input.size() - this->offset < this->needed) {
+            return resp_parse::Incomplete;
+        }
+        this->needed = 0;
+
+        while (this->offset < this->input.size()) {
+            const resp_parse status = this->input[this->offset] == '*' ? this->multibulk() : this->inlineCommand();
+
+            // empty lines and empty arrays are skipped, as Redis does
+            if (status != resp_parse::Command || !this->args.empty()) {
+                return status;
+            }
+        }
+
+        return resp_parse::Incomplete;
+    }
+
+    void RespParser::finish() {
+        // a batch ended early may still hold chunk that never reached pending
+        if (this->fromPending) {
+            this->pending.erase(0, this->offset);
+            this->pending.append(this->rest);
+        } else {
+            this->pending.assign(this->input.substr(this->offset));
+        }
+
+        this->input = string_view();
+        this->rest = string_view();
+        this->fromPending = false;
+        this->offset = 0;
+        this->resumeCount = 0;
+    }
+
+    const std::vector<string_view> &RespParser::getArgs() const {
+        return this->args;
+    }
+
+    const string &RespParser::getError() const {
+        return this->error;
+    }
+
+    size_t RespParser::buffered() const {
+        return this->pending.size();
+    }
+
+    resp_parse RespParser::line(size_t pos, size_t &end) {
+        const size_t limit = std::min(this->input.size() - pos, RESP_MAX_INLINE);
+        const void *found = std::memchr(this->input.data() + pos, '\n', limit);
+        if (found == nullptr) {
+            return this->input.size() - pos > RESP_MAX_INLINE ? this->fail("too big inline request") : resp_parse::Incomplete;
+        }
+
+        end = static_cast<const char *>(found) - this->input.data();
+        return resp_parse::Command;
+    }
+
+    resp_parse RespParser::number(size_t &pos, int64_t &value, const char *what) {
+        size_t end = 0;
+        const resp_parse status = this->line(pos, end);
+        if (status != resp_parse::Command) {
+            return status;
+        }
+
+        // the type byte, then digits up to CRLF
+        const string_view text = this->input.substr(pos + 1, end - pos - 1);
+        if (text.empty() || text.back() != '\r' || !parse_decimal(text.substr(0, text.size() - 1), value)) {
+            return this->fail(string("invalid ") + what);
+        }
+
+        pos = end + 1;
+        return resp_parse::Command;
+    }
+
+    resp_parse RespParser::multibulk() {
+        size_t pos = this->offset;
+        int64_t count = 0;
+        resp_parse status = resp_parse::Command;
+        if (this->resumeCount != 0) {
+            // pending grew in place, the arguments already taken are still good
+            count = static_cast<int64_t>(this->resumeCount);
+            pos = this->resumePos;
+            this->resumeCount = 0;
+        } else {
+            status = this->number(pos, count, "multibulk length");
+            if (status != resp_parse::Command) {
+                return status;
+            }
+
+            if (count > static_cast<int64_t>(RESP_MAX_ARGUMENTS)) {
+                return this->fail("invalid multibulk length");
+            }
+            this->args.clear();
+        }
+
+        for (auto i = static_cast<int64_t>(this->args.size()); i < count; i++) {
+            if (pos >= this->input.size()) {
+                return this->suspend(count, pos);
+            }
+
+            if (this->input[pos] != '$') {
+                return this->fail(string("expected '$', got '") + this->input[pos] + "'");
+            }
+
+            const size_t start = pos;
+            int64_t length = 0;
+            status = this->number(pos, length, "bulk length");
+            if (status == resp_parse::Incomplete) {
+                return this->suspend(count, start);
+            }
+            if (status != resp_parse::Command) {
+                return status;
+            }
+
+            if (length < 0 || length > static_cast<int64_t>(RESP_MAX_BULK)) {
+                return this->fail("invalid bulk length");
+            }
+
+            const size_t size = static_cast<size_t>(length);
+            if (this->input.size() - pos < size + 2) {
+                this->needed = pos + size + 2 - this->offset;
+                return this->suspend(count, start);
+            }
+
+            if (this->input[pos + size] != '\r' || this->input[pos + size + 1] != '\n') {
+                return this->fail("expected CRLF after bulk string");
+            }
+
+            this->args.push_back(this->input.substr(pos, size));
+            pos += size + 2;
+        }
+
+        this->offset = pos;
+        return resp_parse::Command;
+    }
+
+    resp_parse RespParser::inlineCommand() {
+        size_t end = 0;
+        const resp_parse status = this->line(this->offset, end);
+        if (status != resp_parse::Command) {
+            return status;
+        }
+
+        string_view text = this->input.substr(this->offset, end - this->offset);
+        if (!text.empty() && text.back() == '\r') {
+            text.remove_suffix(1);
+        }
+        this->offset = end + 1;
+
+        this->args.clear();
+        size_t pos = 0;
+        while (pos < text.size()) {
+            if (text[pos] == ' ' || text[pos] == '\t') {
+                pos++;
+                continue;
+            }
+
+            const size_t start = pos;
+            while (pos < text.size() && text[pos] != ' ' && text[pos] != '\t') {
+                pos++;
+            }
+            this->args.push_back(text.substr(start, pos - start));
+        }
+
+        return resp_parse::Command;
+    }
+
+    resp_parse RespParser::suspend(int64_t count, size_t pos) {
+        // only pending grows in place, a cut chunk is parsed again from its start after the copy
+        if (this->fromPending) {
+            this->resumeCount = static_cast<size_t>(count);
+            this->resumePos = pos;
+        }
+        return resp_parse::Incomplete;
+    }
+
+    resp_parse RespParser::fail(const string &description) {
+        this->error = "Protocol error: " + description;
+        return resp_parse::Error;
+    }
+
+    uint64_t RespReplies::begin() {
+        return this->next++;
+    }
+
+    void RespReplies::answer(uint64_t sequence, string_view reply) {
+        if (sequence < this->head || sequence >= this->next) {
+            return;
+        }
+
+        if (sequence != this->head) {
+            this->early[sequence].assign(reply);
+            return;
+        }
+
+        this->out.append(reply);
+        this->head++;
+
+        // the answers held back for this one follow it
+        auto it = this->early.begin();
+        while (it != this->early.end() && it->first == this->head) {
+            this->out.append(it->second);
+            this->head++;
+            it = this->early.erase(it);
+        }
+    }
+
+    const string &RespReplies::ready() const {
+        return this->out;
+    }
+
+    void RespReplies::sent() {
+        this->out.clear();
+    }
+
+    size_t RespReplies::waiting() const {
+        return this->next - this->head;
+    }
+
+    void resp_simple(string &out, string_view text) {
+        out.push_back('+');
+        append_line(out, text);
+    }
+
+    void resp_error(string &out, string_view text) {
+        out.push_back('-');
+        append_line(out, text);
+    }
+
+    void resp_integer(string &out, int64_t value) {
+        char digits[24];
+        const auto result = std::to_chars(digits, digits + sizeof(digits), value);
+        out.push_back(':');
+        out.append(digits, result.ptr - digits);
+        out.append(CRLF);
+    }
+
+    void resp_bulk(string &out, string_view value) {
+        char digits[24];
+        const auto result = std::to_chars(digits, digits + sizeof(digits), value.size());
+        out.push_back('$');
+        out.append(digits, result.ptr - digits);
+        out.append(CRLF);
+        out.append(value);
+        out.append(CRLF);
+    }
+
+    void resp_null(string &out) {
+        out.append("$-1\r\n");
+    }
+
+    void resp_array(string &out, size_t count) {
+        char digits[24];
+        const auto result = std::to_chars(digits, digits + sizeof(digits), count);
+        out.push_back('*');
+        out.append(digits, result.ptr - digits);
+        out.append(CRLF);
+    }
+
+    const RespCommandInfo *resp_command_lookup(string_view name) {
+        char lower[16];
+        if (name.size() >= sizeof(lower)) {
+            return nullptr;
+        }
+
+        for (size_t i = 0; i < name.size(); i++) {
+            const char c = name[i];
+            lower[i] = c >= 'A' && c <= 'Z' ? static_cast<char>(c - 'A' + 'a') : c;
+        }
+
+        const string_view wanted(lower, name.size());
+        for (const auto &info : RESP_COMMANDS) {
+            if (wanted == info.name) {
+                return &info;
+            }
+        }
+
+        return nullptr;
+    }
+
+    bool resp_arity_ok(const RespCommandInfo &info, size_t arguments) {
+        return info.arity >= 0 ? arguments == static_cast<size_t>(info.arity) : arguments >= static_cast<size_t>(-info.arity);
+    }
+}// namespace Diginext::Core::Storage
@@ -0,0 +1,413 @@
+#include "Storage/SSTable.h"
+
+#include "Checksum/Crc32.h"
+#include "Storage/StorageEncoding.h"
+#include "Storage/StorageHash.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace Diginext::Core::Storage {
+    const char SSTABLE_MAGIC[8] = { 'D', 'G', 'X', 'S', 'S', 'T', '0', '1' };
+    const size_t SSTABLE_FOOTER_SIZE = 64;
+    const size_t SSTABLE_ENTRY_HEADER_SIZE = 9;
+    const size_t SSTABLE_FILE_BUFFER = 1024 * 1024;
+
+    const uint8_t ENTRY_PUT = 1;
+    const uint8_t ENTRY_DELETED = 2;
+
+    SSTableBuilder::SSTableBuilder(const string &path, size_t blockSize, size_t bitsPerKey) {
+        this->path = path;
+        this->blockSize = blockSize;
+        this->bitsPerKey = bitsPerKey;
+        this->offset = 0;
+        this->entryCount = 0;
+        this->deletedCount = 0;
+        this->failed = false;
+
+        this->file = std::fopen(path.c_str(), "wb");
+        if (this->file == nullptr) {
+            throw std::runtime_error("SSTable: cannot create " + path);
+        }
+
+        std::setvbuf(this->file, nullptr, _IOFBF, SSTABLE_FILE_BUFFER);
+    }
+
+    SSTableBuilder::~SSTableBuilder() {
+        this->abandon();
+    }
+
+    void SSTableBuilder::writeRaw(const string &data) {
+        if (std::fwrite(data.data(), 1, data.size(), this->file) != data.size()) {
+            this->failed = true;
+        }
+
+        this->offset += data.size();
+    }
+
+    void SSTableBuilder::add(string_view key, string_view value, bool deleted) {
+        if (this->entryCount == 0) {
+            this->smallestKey.assign(key.data(), key.size());
+        }
+
+        this->block.push_back(static_cast<char>(deleted ? ENTRY_DELETED : ENTRY_PUT));
+        put_fixed32(this->block, static_cast<uint32_t>(key.size()));
+        put_fixed32(this->block, deleted ? 0 : static_cast<uint32_t>(value.size()));
+        this->block.append(key.data(), key.size());
+        if (!deleted) {
+            this->block.append(value.data(), value.size());
+        }
+
+        this->hashes.push_back(hash_key(key.data(), key.size()));
+        this->lastKey.assign(key.data(), key.size());
+        this->entryCount++;
+        if (deleted) {
+            this->deletedCount++;
+        }
+
+        if (this->block.size() >= this->blockSize) {
+            this->flushBlock();
+        }
+    }
+
+    void SSTableBuilder::flushBlock() {
+        if (this->block.empty()) {
+            return;
+        }
+
+        put_fixed32(this->block, Crc32::Compute(this->block));
+
+        put_fixed32(this->index, static_cast<uint32_t>(this->lastKey.size()));
+        this->index.append(this->lastKey);
+        put_fixed64(this->index, this->offset);
+        put_fixed32(this->index, static_cast<uint32_t>(this->block.size()));
+
+        this->writeRaw(this->block);
+        this->block.clear();
+    }
+
+    uint64_t SSTableBuilder::finish() {
+        if (this->file == nullptr) {
+            throw std::runtime_error("SSTable: builder already closed " + this->path);
+        }
+
+        this->flushBlock();
+
+        const BloomFilter filter = BloomFilter::build(this->hashes, this->bitsPerKey);
+        const uint64_t filterOffset = this->offset;
+        this->writeRaw(filter.getData());
+
+        string meta;
+        put_fixed32(meta, static_cast<uint32_t>(this->smallestKey.size()));
+        meta.append(this->smallestKey);
+        meta.append(this->index);
+
+        const uint64_t indexOffset = this->offset;
+        this->writeRaw(meta);
+
+        string footer;
+        put_fixed64(footer, filterOffset);
+        put_fixed64(footer, filter.getData().size());
+        put_fixed64(footer, indexOffset);
+        put_fixed64(footer, meta.size());
+        put_fixed64(footer, this->entryCount);
+        put_fixed64(footer, this->deletedCount);
+        put_fixed32(footer, Crc32::Compute(meta, Crc32::Compute(filter.getData())));
+        put_fixed32(footer, 0);
+        footer.append(SSTABLE_MAGIC, sizeof(SSTABLE_MAGIC));
+        this->writeRaw(footer);
+
+        const bool synced = file_sync(this->file);
+        const bool closed = std::fclose(this->file) == 0;
+        this->file = nullptr;
+
+        if (this->failed || !synced || !closed) {
+            file_remove(this->path);
+            throw std::runtime_error("SSTable: cannot write " + this->path);
+        }
+
+        return this->offset;
+    }
+
+    void SSTableBuilder::abandon() {
+        if (this->file == nullptr) {
+            return;
+        }
+
+        std::fclose(this->file);
+        this->file = nullptr;
+        file_remove(this->path);
+    }
+
+    uint64_t SSTableBuilder::getEntryCount() const {
+        return this->entryCount;
+    }
+
+    uint64_t SSTableBuilder::getFileSize() const {
+        return this->offset + this->block.size();
+    }
+
+    SSTable::pointer SSTable::open(const string &path, uint64_t number) {
+        auto table = std::make_shared<SSTable>(path, number);
+        if (!table->load()) {
+            return nullptr;
+        }
+
+        return table;
+    }
+
+    SSTable::SSTable(const string &path, uint64_t number) {
+        this->number = number;
+        this->file = RandomAccessFile::open(path);
+        this->entryCount = 0;
+        this->deletedCount = 0;
+    }
+
+    SSTable::~SSTable() {
+        if (this->obsolete && this->file != nullptr) {
+            const string path = this->file->getPath();
+            this->file.reset();
+            file_remove(path);
+        }
+    }
+
+    bool SSTable::load() {
+        if (this->file == nullptr || this->file->getSize() < SSTABLE_FOOTER_SIZE) {
+            return false;
+        }
+
+        const uint64_t size = this->file->getSize();
+        string footer;
+        if (!this->file->read(size - SSTABLE_FOOTER_SIZE, SSTABLE_FOOTER_SIZE, footer) ||
+            footer.compare(SSTABLE_FOOTER_SIZE - sizeof(SSTABLE_MAGIC), sizeof(SSTABLE_MAGIC), SSTABLE_MAGIC, sizeof(SSTABLE_MAGIC)) != 0) {
+            return false;
+        }
+
+        const uint64_t filterOffset = get_fixed64(&footer[0]);
+        const uint64_t filterSize = get_fixed64(&footer[8]);
+        const uint64_t indexOffset = get_fixed64(&footer[16]);
+        const uint64_t indexSize = get_fixed64(&footer[24]);
+        if (filterOffset + filterSize != indexOffset || indexOffset + indexSize + SSTABLE_FOOTER_SIZE != size) {
+            return false;
+        }
+
+        string meta;
+        if (!this->file->read(filterOffset, static_cast<size_t>(filterSize + indexSize), meta) ||
+            Crc32::Compute(meta) != get_fixed32(&footer[48])) {
+            return false;
+        }
+
+        this->entryCount = get_fixed64(&footer[32]);
+        this->deletedCount = get_fixed64(&footer[40]);
+        this->filter = BloomFilter(meta.substr(0, static_cast<size_t>(filterSize)));
+
+        // smallest key, then (last key, offset, size) per block
+        const char *p = meta.data() + filterSize;
+        const char *end = meta.data() + meta.size();
+        if (end - p < 4 || uint64_t(end - p - 4) < get_fixed32(p)) {
+            return false;
+        }
+
+        this->smallestKey.assign(p + 4, get_fixed32(p));
+        p += 4 + this->smallestKey.size();
+
+        while (p < end) {
+            if (end - p < 4) {
+                return false;
+            }
+
+            const uint32_t keySize = get_fixed32(p);
+            if (uint64_t(end - p) < 4 + uint64_t(keySize) + 12) {
+                return false;
+            }
+
+            BlockHandle handle;
+            handle.lastKey.assign(p + 4, keySize);
+            handle.offset = get_fixed64(p + 4 + keySize);
+            handle.size = get_fixed32(p + 12 + keySize);
+            if (handle.size < 4 || handle.offset + handle.size > filterOffset) {
+                return false;
+            }
+
+            this->blocks.push_back(std::move(handle));
+            p += 4 + keySize + 12;
+        }
+
+        return true;
+    }
+
+    bool SSTable::readBlock(size_t index, string &block) const {
+        const BlockHandle &handle = this->blocks[index];
+        if (!this->file->read(handle.offset, handle.size, block)) {
+            return false;
+        }
+
+        const size_t contentSize = handle.size - 4;
+        if (Crc32::Compute(block.data(), contentSize) != get_fixed32(block.data() + contentSize)) {
+            return false;
+        }
+
+        block.resize(contentSize);
+        return true;
+    }
+
+    LookupResult SSTable::get(string_view key, uint64_t hash, string &value) const {
+        if (this->blocks.empty() || key < this->smallestKey || key > this->blocks.back().lastKey || !this->filter.mayContain(hash)) {
+            return LookupResult::NotFound;
+        }
+
+        const auto it = std::lower_bound(this->blocks.begin(), this->blocks.end(), key,
+                                         [](const BlockHandle &handle, string_view target) { return handle.lastKey < target; });
+        if (it == this->blocks.end()) {
+            return LookupResult::NotFound;
+        }
+
+        string block;
+        if (!this->readBlock(static_cast<size_t>(it - this->blocks.begin()), block)) {
+            throw std::runtime_error("SSTable: corrupted block in " + this->file->getPath());
+        }
+
+        size_t position = 0;
+        while (position + SSTABLE_ENTRY_HEADER_SIZE <= block.size()) {
+            const char *entry = block.data() + position;
+            const uint32_t keySize = get_fixed32(entry + 1);
+            const uint32_t valueSize = get_fixed32(entry + 5);
+            const string_view entryKey(entry + SSTABLE_ENTRY_HEADER_SIZE, keySize);
+
+            if (entryKey == key) {
+                if (static_cast<uint8_t>(entry[0]) == ENTRY_DELETED) {
+                    return LookupResult::Deleted;
+                }
+
+                value.assign(entry + SSTABLE_ENTRY_HEADER_SIZE + keySize, valueSize);
+                return LookupResult::Found;
+            }
+
+            if (entryKey > key) {
+                break;
+            }
+
+            position += SSTABLE_ENTRY_HEADER_SIZE + keySize + valueSize;
+        }
+
+        return LookupResult::NotFound;
+    }
+
+    SSTable::Iterator SSTable::iterator() {
+        return Iterator(this->shared_from_this());
+    }
+
+    SSTable::Iterator::Iterator(SSTable::pointer table) : table(std::move(table)) {
+        this->blockIndex = 0;
+        this->position = 0;
+        this->blockEnd = 0;
+        this->currentDeleted = false;
+        this->isValid = false;
+    }
+
+    bool SSTable::Iterator::loadBlock(size_t index) {
+        this->blockIndex = index;
+        this->position = 0;
+        this->blockEnd = 0;
+        if (index >= this->table->blocks.size()) {
+            this->isValid = false;
+            return false;
+        }
+
+        if (!this->table->readBlock(index, this->block)) {
+            throw std::runtime_error("SSTable: corrupted block in " + this->table->file->getPath());
+        }
+
+        this->blockEnd = this->block.size();
+        return true;
+    }
+
+    void SSTable::Iterator::parse() {
+        while (this->position + SSTABLE_ENTRY_HEADER_SIZE > this->blockEnd) {
+            if (!this->loadBlock(this->blockIndex + 1)) {
+                return;
+            }
+        }
+
+        const char *entry = this->block.data() + this->position;
+        const uint32_t keySize = get_fixed32(entry + 1);
+        const uint32_t valueSize = get_fixed32(entry + 5);
+        this->currentDeleted = static_cast<uint8_t>(entry[0]) == ENTRY_DELETED;
+        this->currentKey = string_view(entry + SSTABLE_ENTRY_HEADER_SIZE, keySize);
+        this->currentValue = string_view(entry + SSTABLE_ENTRY_HEADER_SIZE + keySize, valueSize);
+        this->isValid = true;
+    }
+
+    void SSTable::Iterator::seekToFirst() {
+        if (this->loadBlock(0)) {
+            this->parse();
+        }
+    }
+
+    void SSTable::Iterator::seek(string_view key) {
+        const auto &blocks = this->table->blocks;
+        const auto it = std::lower_bound(blocks.begin(), blocks.end(), key,
+                                         [](const BlockHandle &handle, string_view target) { return handle.lastKey < target; });
+        if (!this->loadBlock(static_cast<size_t>(it - blocks.begin()))) {
+            return;
+        }
+
+        this->parse();
+        while (this->isValid && this->currentKey < key) {
+            this->next();
+        }
+    }
+
+    bool SSTable::Iterator::valid() const {
+        return this->isValid;
+    }
+
+    void SSTable::Iterator::next() {
+        this->position += SSTABLE_ENTRY_HEADER_SIZE + this->currentKey.size() + this->currentValue.size();
+        this->parse();
+    }
+
+    string_view SSTable::Iterator::key() const {
+        return this->currentKey;
+    }
+
+    string_view SSTable::Iterator::value() const {
+        return this->currentValue;
+    }
+
+    bool SSTable::Iterator::deleted() const {
+        return this->currentDeleted;
+    }
+
+    void SSTable::markObsolete() {
+        this->obsolete = true;
+    }
+
+    uint64_t SSTable::getNumber() const {
+        return this->number;
+    }
+
+    uint64_t SSTable::getFileSize() const {
+        return this->file->getSize();
+    }
+
+    uint64_t SSTable::getEntryCount() const {
+        return this->entryCount;
+    }
+
+    uint64_t SSTable::getDeletedCount() const {
+        return this->deletedCount;
+    }
+
+    uint64_t SSTable::getReads() const {
+        return this->file->getReads();
+    }
+
+    const string &SSTable::getSmallestKey() const {
+        return this->smallestKey;
+    }
+
+    const string &SSTable::getLargestKey() const {
+        return this->blocks.empty() ? this->smallestKey : this->blocks.back().lastKey;
+    }
+}// namespace Diginext::Core::Storage
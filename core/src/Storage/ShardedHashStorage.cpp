@@ -0,0 +1,1080 @@
+#include "Storage/ShardedHashStorage.h"
+
+#include "Storage/StorageHash.h"
+#include "Storage/StorageMemory.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <new>
+#include <queue>
+#include <utility>
+
+namespace Diginext::Core::Storage {
+    const size_t NOT_FOUND = static_cast<size_t>(-1);
+
+    // max (used + deleted) / capacity, in percent
+    const size_t MAX_LOAD_PERCENT = 75;
+
+    // the collector also runs when a snapshot is released
+    const auto COLLECT_INTERVAL = std::chrono::milliseconds(100);
+
+    ShardedHashStorage::Table::Table(size_t capacity)
+        : mask(capacity - 1), slots(new std::atomic<Entry *>[capacity]) {
+        for (size_t i = 0; i < capacity; i++) {
+            this->slots[i].store(nullptr, std::memory_order_relaxed);
+        }
+    }
+
+    ShardedHashStorage::Shard::~Shard() {
+        Table *current = this->table.load(std::memory_order_relaxed);
+        if (current == nullptr) {
+            return;
+        }
+
+        for (size_t i = 0; i <= current->mask; i++) {
+            Entry *entry = current->slots[i].load(std::memory_order_relaxed);
+            while (entry != nullptr && entry != tombstone()) {
+                Entry *older = entry->older();
+                Entry::destroy(entry);
+                entry = older;
+            }
+        }
+
+        delete current;
+    }
+
+    ShardedHashStorage::pointer ShardedHashStorage::create(size_t shardCount) {
+        return std::make_shared<ShardedHashStorage>(shardCount);
+    }
+
+    ShardedHashStorage::ShardedHashStorage(size_t shardCount) {
+        this->memoryLimit = 0;
+        this->shardBudget = 0;
+        this->baseVersion = 0;
+        this->shardBits = 0;
+        while ((size_t(1) << this->shardBits) < shardCount) {
+            this->shardBits++;
+        }
+
+        const size_t count = size_t(1) << this->shardBits;
+        this->shards.reserve(count);
+        for (size_t i = 0; i < count; i++) {
+            auto shard = std::make_unique<Shard>();
+            shard->table.store(new Table(INITIAL_SHARD_CAPACITY), std::memory_order_release);
+            shard->bytes.store(tableBytes(INITIAL_SHARD_CAPACITY) + shard->index.memoryUsage(), std::memory_order_relaxed);
+            this->shards.push_back(std::move(shard));
+        }
+    }
+
+    ShardedHashStorage::~ShardedHashStorage() {
+        {
+            std::lock_guard<std::mutex> guard(this->collectorSync);
+            this->collectorStopping = true;
+        }
+        this->collectorWake.notify_all();
+
+        if (this->collector.joinable()) {
+            this->collector.join();
+        }
+    }
+
+    ShardedHashStorage::Entry::Entry(uint64_t hash, uint64_t version, uint32_t keySize, uint32_t valueSize, uint8_t flags)
+        : hash(hash), version(version), keySize(keySize), valueSize(valueSize), flags(flags) {
+    }
+
+    ShardedHashStorage::Entry *ShardedHashStorage::Entry::create(SlabAllocator &slab, uint64_t hash, uint64_t version, string_view key,
+                                                                 const string *value, bool inBase, Entry *older) {
+        uint8_t flags = inBase ? IN_BASE : 0;
+        size_t valueSize = 0;
+        size_t size = sizeof(Entry) + key.size();
+        if (older != nullptr) {
+            flags |= CHAINED;
+            size += sizeof(std::atomic<Entry *>);
+        }
+        if (value == nullptr) {
+            flags |= DELETED;
+        } else if (value->size() > INLINE_VALUE_MAX) {
+            flags |= SHARED_VALUE;
+            size += sizeof(value_pointer);
+        } else {
+            valueSize = value->size();
+            size += valueSize;
+        }
+
+        void *memory;
+        if (size <= SlabAllocator::MAX_SLOT_SIZE) {
+            memory = slab.allocate(size);
+            flags |= SLAB;
+        } else {
+            memory = ::operator new(size);
+        }
+
+        Entry *entry = new (memory) Entry(hash, version, static_cast<uint32_t>(key.size()), static_cast<uint32_t>(valueSize), flags);
+        char *data = reinterpret_cast<char *>(entry + 1);
+        if ((flags & CHAINED) != 0) {
+            new (data) std::atomic<Entry *>(older);
+            data += sizeof(std::atomic<Entry *>);
+        }
+        if ((flags & SHARED_VALUE) != 0) {
+            new (data) value_pointer(std::make_shared<const string>(*value));
+            data += sizeof(value_pointer);
+        }
+
+        std::memcpy(data, key.data(), key.size());
+        if (valueSize > 0) {
+            std::memcpy(data + key.size(), value->data(), valueSize);
+        }
+
+        return entry;
+    }
+
+    void ShardedHashStorage::Entry::destroy(void *pointer) {
+        Entry *entry = static_cast<Entry *>(pointer);
+        const bool fromSlab = (entry->flags & SLAB) != 0;
+        if ((entry->flags & SHARED_VALUE) != 0) {
+            reinterpret_cast<value_pointer *>(const_cast<char *>(entry->payload()))->~value_pointer();
+        }
+        entry->~Entry();
+
+        if (fromSlab) {
+            SlabAllocator::release(pointer);
+        } else {
+            ::operator delete(pointer);
+        }
+    }
+
+    bool ShardedHashStorage::Entry::live() const {
+        return (this->flags & DELETED) == 0;
+    }
+
+    bool ShardedHashStorage::Entry::inBase() const {
+        return (this->flags & IN_BASE) != 0;
+    }
+
+    ShardedHashStorage::Entry *ShardedHashStorage::Entry::older() const {
+        if ((this->flags & CHAINED) == 0) {
+            return nullptr;
+        }
+
+        return reinterpret_cast<const std::atomic<Entry *> *>(this + 1)->load(std::memory_order_acquire);
+    }
+
+    void ShardedHashStorage::Entry::setOlder(Entry *older) {
+        // only ever shortens a chain, entries are created with their older version
+        if ((this->flags & CHAINED) != 0) {
+            reinterpret_cast<std::atomic<Entry *> *>(this + 1)->store(older, std::memory_order_release);
+        }
+    }
+
+    const char *ShardedHashStorage::Entry::payload() const {
+        const char *data = reinterpret_cast<const char *>(this + 1);
+        return (this->flags & CHAINED) != 0 ? data + sizeof(std::atomic<Entry *>) : data;
+    }
+
+    string_view ShardedHashStorage::Entry::key() const {
+        const char *data = this->payload();
+        if ((this->flags & SHARED_VALUE) != 0) {
+            data += sizeof(value_pointer);
+        }
+
+        return string_view(data, this->keySize);
+    }
+
+    string_view ShardedHashStorage::Entry::value() const {
+        if ((this->flags & SHARED_VALUE) != 0) {
+            const string &value = **reinterpret_cast<const value_pointer *>(this->payload());
+            return string_view(value);
+        }
+
+        return string_view(this->payload() + this->keySize, this->valueSize);
+    }
+
+    value_pointer ShardedHashStorage::Entry::sharedValue() const {
+        if ((this->flags & SHARED_VALUE) != 0) {
+            return *reinterpret_cast<const value_pointer *>(this->payload());
+        }
+
+        return std::make_shared<const string>(this->value());
+    }
+
+    size_t ShardedHashStorage::Entry::bytes() const {
+        size_t size = sizeof(Entry) + this->keySize + this->valueSize;
+        size_t value = 0;
+        if ((this->flags & CHAINED) != 0) {
+            size += sizeof(std::atomic<Entry *>);
+        }
+        if ((this->flags & SHARED_VALUE) != 0) {
+            size += sizeof(value_pointer);
+            value = shared_string_bytes(**reinterpret_cast<const value_pointer *>(this->payload()));
+        }
+
+        return ((this->flags & SLAB) != 0 ? SlabAllocator::slotSize(size) : size) + value;
+    }
+
+    ShardedHashStorage::Entry *ShardedHashStorage::tombstone() {
+        static Entry deleted(0, 0, 0, 0, Entry::DELETED);
+        return &deleted;
+    }
+
+    size_t ShardedHashStorage::entryBytes(const Entry *entry) {
+        return entry->bytes();
+    }
+
+    size_t ShardedHashStorage::tableBytes(size_t capacity) {
+        return sizeof(Table) + capacity * sizeof(std::atomic<Entry *>);
+    }
+
+    void ShardedHashStorage::updateIndex(Shard &shard, const string &key, bool live) {
+        const size_t before = shard.index.memoryUsage();
+        if (live) {
+            shard.index.insert(key);
+        } else {
+            shard.index.erase(key);
+        }
+
+        shard.bytes.fetch_add(shard.index.memoryUsage() - before, std::memory_order_relaxed);
+    }
+
+    size_t ShardedHashStorage::shardIndex(uint64_t hash) const {
+        return this->shardBits == 0 ? 0 : static_cast<size_t>(hash >> (64 - this->shardBits));
+    }
+
+    ShardedHashStorage::Shard &ShardedHashStorage::shardFor(uint64_t hash) const {
+        return *(this->shards[this->shardIndex(hash)]);
+    }
+
+    const ShardedHashStorage::Entry *ShardedHashStorage::find(const Table *table, uint64_t hash, string_view key) {
+        for (size_t i = hash & table->mask;; i = (i + 1) & table->mask) {
+            const Entry *entry = table->slots[i].load(std::memory_order_acquire);
+            if (entry == nullptr) {
+                return nullptr;
+            }
+
+            if (entry != tombstone() && entry->hash == hash && entry->key() == key) {
+                return entry;
+            }
+        }
+    }
+
+    void ShardedHashStorage::insert(Shard &shard, Entry *entry) {
+        Table *table = shard.table.load(std::memory_order_relaxed);
+        const size_t used = shard.count.load(std::memory_order_relaxed) + shard.tombstones;
+
+        if ((used + 1) * 100 > (table->mask + 1) * MAX_LOAD_PERCENT) {
+            // grow only when live keys need it, otherwise just drop the tombstones;
+            // entries are immutable, so the new table shares them with the old one
+            const size_t live = shard.count.load(std::memory_order_relaxed) + 1;
+            const size_t capacity = live * 100 > (table->mask + 1) * MAX_LOAD_PERCENT / 2
+                                            ? (table->mask + 1) * 2
+                                            : (table->mask + 1);
+
+            Table *grown = new Table(capacity);
+            for (size_t i = 0; i <= table->mask; i++) {
+                Entry *item = table->slots[i].load(std::memory_order_relaxed);
+                if (item == nullptr || item == tombstone()) {
+                    continue;
+                }
+
+                size_t j = item->hash & grown->mask;
+                while (grown->slots[j].load(std::memory_order_relaxed) != nullptr) {
+                    j = (j + 1) & grown->mask;
+                }
+
+                grown->slots[j].store(item, std::memory_order_relaxed);
+            }
+
+            shard.table.store(grown, std::memory_order_release);
+            shard.bytes.fetch_add(tableBytes(capacity) - tableBytes(table->mask + 1), std::memory_order_relaxed);
+            shard.tombstones = 0;
+            shard.retired.retire(table);
+            table = grown;
+        }
+
+        size_t i = entry->hash & table->mask;
+        Entry *current = table->slots[i].load(std::memory_order_relaxed);
+        while (current != nullptr && current != tombstone()) {
+            i = (i + 1) & table->mask;
+            current = table->slots[i].load(std::memory_order_relaxed);
+        }
+
+        if (current == tombstone()) {
+            shard.tombstones--;
+        }
+
+        table->slots[i].store(entry, std::memory_order_release);
+        shard.count.fetch_add(1, std::memory_order_relaxed);
+        shard.bytes.fetch_add(entryBytes(entry), std::memory_order_relaxed);
+    }
+
+    void ShardedHashStorage::unlink(Shard &shard, Table *table, size_t slot, Entry *current, bool keepHistory) {
+        const uint64_t version = this->clock.next();
+        shard.live.fetch_sub(1, std::memory_order_relaxed);
+        updateIndex(shard, string(current->key()), false);
+
+        if (keepHistory && this->snapshotCount.load() > 0) {
+            // open snapshots may still read the value, it stays behind a marker until the collector
+            Entry *marker = Entry::create(shard.slab, current->hash, version, current->key(), nullptr, current->inBase(), current);
+            table->slots[slot].store(marker, std::memory_order_release);
+            shard.bytes.fetch_add(entryBytes(marker), std::memory_order_relaxed);
+            shard.history.fetch_add(marker->inBase() ? 1 : 2, std::memory_order_relaxed);
+            this->prune(shard, marker, this->pruneHorizon());
+            return;
+        }
+
+        if (current->inBase()) {
+            // keep hiding the base value
+            Entry *marker = Entry::create(shard.slab, current->hash, version, current->key(), nullptr, true);
+            table->slots[slot].store(marker, std::memory_order_release);
+            shard.bytes.fetch_add(entryBytes(marker), std::memory_order_relaxed);
+        } else {
+            table->slots[slot].store(tombstone(), std::memory_order_release);
+            shard.count.fetch_sub(1, std::memory_order_relaxed);
+            shard.tombstones++;
+        }
+
+        shard.bytes.fetch_sub(entryBytes(current), std::memory_order_relaxed);
+        dropHistory(shard, current->older());
+        shard.retired.retire(current, &Entry::destroy);
+    }
+
+    void ShardedHashStorage::dropHistory(Shard &shard, Entry *entry) {
+        while (entry != nullptr) {
+            Entry *older = entry->older();
+            shard.bytes.fetch_sub(entryBytes(entry), std::memory_order_relaxed);
+            shard.history.fetch_sub(1, std::memory_order_relaxed);
+            shard.retired.retire(entry, &Entry::destroy);
+            entry = older;
+        }
+    }
+
+    uint64_t ShardedHashStorage::pruneHorizon() const {
+        const uint64_t oldest = this->oldestSnapshot.load();
+        if (this->snapshotCount.load() == 0) {
+            return NO_SNAPSHOT;
+        }
+
+        // raised, but its timestamp is not published yet: keep everything
+        return oldest == NO_SNAPSHOT ? 0 : oldest;
+    }
+
+    void ShardedHashStorage::prune(Shard &shard, Entry *head, uint64_t horizon) {
+        // the newest version at or below the horizon serves the oldest snapshot, nothing older is reachable
+        Entry *entry = head;
+        while (entry != nullptr && entry->version > horizon) {
+            entry = entry->older();
+        }
+
+        if (entry == nullptr) {
+            return;
+        }
+
+        Entry *tail = entry->older();
+        if (tail != nullptr) {
+            entry->setOlder(nullptr);
+            dropHistory(shard, tail);
+        }
+    }
+
+    void ShardedHashStorage::touch(const Entry *entry) const {
+        // a plain load on the hot path, hot keys stop writing once saturated
+        if (this->memoryLimit == 0) {
+            return;
+        }
+
+        const uint8_t frequency = entry->frequency.load(std::memory_order_relaxed);
+        if (frequency < MAX_FREQUENCY) {
+            entry->frequency.store(frequency + 1, std::memory_order_relaxed);
+        }
+    }
+
+    void ShardedHashStorage::evict(Shard &shard, const Entry *keep) {
+        Table *table = shard.table.load(std::memory_order_relaxed);
+
+        // every step either evicts or ages one entry, so a sweep is bounded and
+        // O(1) amortized per evicted key
+        size_t steps = (table->mask + 1) * (MAX_FREQUENCY + 1);
+        while (shard.bytes.load(std::memory_order_relaxed) > this->shardBudget && steps-- > 0) {
+            shard.clockHand = (shard.clockHand + 1) & table->mask;
+            Entry *current = table->slots[shard.clockHand].load(std::memory_order_relaxed);
+            if (current == nullptr || current == tombstone() || !current->live() || current == keep) {
+                continue;
+            }
+
+            const uint8_t frequency = current->frequency.load(std::memory_order_relaxed);
+            if (frequency > 0) {
+                current->frequency.store(frequency - 1, std::memory_order_relaxed);
+                continue;
+            }
+
+            this->unlink(shard, table, shard.clockHand, current, false);
+            shard.evictions.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    bool ShardedHashStorage::get(const string &key, string &value) const {
+        const uint64_t hash = hash_key(key);
+        const Shard &shard = this->shardFor(hash);
+
+        EpochManager::Guard guard;
+        const Entry *entry = find(shard.table.load(std::memory_order_acquire), hash, key);
+        if (entry != nullptr) {
+            if (!entry->live()) {
+                return false;
+            }
+
+            this->touch(entry);
+            value.assign(entry->value());
+            return true;
+        }
+
+        string_view baseValue;
+        if (this->base != nullptr && this->base->find(key, baseValue)) {
+            value.assign(baseValue.data(), baseValue.size());
+            return true;
+        }
+
+        return false;
+    }
+
+    value_pointer ShardedHashStorage::readShared(const Shard &shard, uint64_t hash, const string &key, uint64_t *version) const {
+        const Entry *entry = find(shard.table.load(std::memory_order_acquire), hash, key);
+        if (entry != nullptr) {
+            if (!entry->live()) {
+                return nullptr;
+            }
+
+            this->touch(entry);
+            if (version != nullptr) {
+                *version = entry->version;
+            }
+            return entry->sharedValue();
+        }
+
+        string_view baseValue;
+        if (this->base != nullptr && this->base->find(key, baseValue)) {
+            if (version != nullptr) {
+                *version = this->baseVersion;
+            }
+            return std::make_shared<const string>(baseValue);
+        }
+
+        return nullptr;
+    }
+
+    value_pointer ShardedHashStorage::getShared(const string &key) const {
+        const uint64_t hash = hash_key(key);
+
+        EpochManager::Guard guard;
+        return this->readShared(this->shardFor(hash), hash, key, nullptr);
+    }
+
+    value_pointer ShardedHashStorage::getVersioned(const string &key, uint64_t &version) const {
+        const uint64_t hash = hash_key(key);
+        version = 0;
+
+        EpochManager::Guard guard;
+        return this->readShared(this->shardFor(hash), hash, key, &version);
+    }
+
+    std::vector<value_pointer> ShardedHashStorage::multiGet(const std::vector<string> &keys) const {
+        std::vector<value_pointer> values;
+        values.reserve(keys.size());
+
+        EpochManager::Guard guard;
+        for (const auto &key : keys) {
+            const uint64_t hash = hash_key(key);
+            values.push_back(this->readShared(this->shardFor(hash), hash, key, nullptr));
+        }
+
+        return values;
+    }
+
+    void ShardedHashStorage::store(Shard &shard, uint64_t hash, const string &key, const string &value, bool inBase, uint64_t version) {
+        Table *table = shard.table.load(std::memory_order_relaxed);
+        for (size_t i = hash & table->mask;; i = (i + 1) & table->mask) {
+            Entry *current = table->slots[i].load(std::memory_order_relaxed);
+            if (current == nullptr) {
+                break;
+            }
+
+            if (current != tombstone() && current->hash == hash && current->key() == key) {
+                // checked after the version was drawn: a snapshot taken later sees the counter raised
+                const bool keepHistory = this->snapshotCount.load() > 0;
+                const bool pendingMarker = !current->live() && !current->inBase();
+                Entry *entry = Entry::create(shard.slab, hash, version, key, &value, inBase, keepHistory ? current : nullptr);
+                if (!current->live()) {
+                    shard.live.fetch_add(1, std::memory_order_relaxed);
+                    updateIndex(shard, key, true);
+                } else {
+                    // an overwritten key keeps its eviction history
+                    entry->frequency.store(current->frequency.load(std::memory_order_relaxed), std::memory_order_relaxed);
+                }
+
+                table->slots[i].store(entry, std::memory_order_release);
+                shard.bytes.fetch_add(entryBytes(entry), std::memory_order_relaxed);
+                if (keepHistory) {
+                    // a deleted marker was counted already
+                    if (!pendingMarker) {
+                        shard.history.fetch_add(1, std::memory_order_relaxed);
+                    }
+                    this->prune(shard, entry, this->pruneHorizon());
+                } else {
+                    if (pendingMarker) {
+                        shard.history.fetch_sub(1, std::memory_order_relaxed);
+                    }
+                    shard.bytes.fetch_sub(entryBytes(current), std::memory_order_relaxed);
+                    dropHistory(shard, current->older());
+                    shard.retired.retire(current, &Entry::destroy);
+                }
+                if (this->memoryLimit != 0) {
+                    this->evict(shard, entry);
+                }
+                return;
+            }
+        }
+
+        Entry *entry = Entry::create(shard.slab, hash, version, key, &value, inBase);
+        insert(shard, entry);
+        updateIndex(shard, key, true);
+        shard.live.fetch_add(1, std::memory_order_relaxed);
+        if (inBase) {
+            shard.shadowed.fetch_add(1, std::memory_order_relaxed);
+        }
+        if (this->memoryLimit != 0) {
+            this->evict(shard, entry);
+        }
+    }
+
+    void ShardedHashStorage::put(const string &key, const string &value) {
+        const uint64_t hash = hash_key(key);
+        Shard &shard = this->shardFor(hash);
+
+        // base is immutable, look it up before taking the shard lock
+        const bool inBase = this->base != nullptr && this->base->contains(key);
+
+        std::lock_guard<std::mutex> guard(shard.writeSync);
+        // drawn under the shard lock, so versions of one key follow the write order
+        this->store(shard, hash, key, value, inBase, this->clock.next());
+        shard.retired.collect();
+    }
+
+    void ShardedHashStorage::multiPut(const record_batch &records) {
+        struct Pending {
+            size_t shard;
+            uint64_t hash;
+            size_t record;
+            bool inBase;
+        };
+
+        std::vector<Pending> pending;
+        pending.reserve(records.size());
+        for (size_t i = 0; i < records.size(); i++) {
+            const uint64_t hash = hash_key(records[i].first);
+            const bool inBase = this->base != nullptr && this->base->contains(records[i].first);
+            pending.push_back({ this->shardIndex(hash), hash, i, inBase });
+        }
+
+        // stable: a key repeated in the batch is stored in batch order, the last value wins
+        std::stable_sort(pending.begin(), pending.end(), [](const Pending &a, const Pending &b) { return a.shard < b.shard; });
+
+        for (size_t begin = 0; begin < pending.size();) {
+            Shard &shard = *(this->shards[pending[begin].shard]);
+            size_t end = begin;
+
+            std::lock_guard<std::mutex> guard(shard.writeSync);
+            for (; end < pending.size() && pending[end].shard == pending[begin].shard; end++) {
+                const auto &record = records[pending[end].record];
+                this->store(shard, pending[end].hash, record.first, record.second, pending[end].inBase, this->clock.next());
+            }
+            shard.retired.collect();
+
+            begin = end;
+        }
+    }
+
+    bool ShardedHashStorage::update(const string &key, const update_callback &update, const durable_callback &onDurable, uint64_t *version) {
+        const uint64_t hash = hash_key(key);
+        Shard &shard = this->shardFor(hash);
+
+        const bool inBase = this->base != nullptr && this->base->contains(key);
+        {
+            std::lock_guard<std::mutex> guard(shard.writeSync);
+
+            // entries are retired by shard writers only, so the one found stays valid under the lock
+            bool exists = false;
+            string_view current;
+            uint64_t currentVersion = 0;
+            const Entry *entry = find(shard.table.load(std::memory_order_relaxed), hash, key);
+            if (entry != nullptr) {
+                exists = entry->live();
+                current = exists ? entry->value() : string_view();
+                currentVersion = exists ? entry->version : 0;
+            } else if (inBase) {
+                exists = this->base->find(key, current);
+                currentVersion = exists ? this->baseVersion : 0;
+            }
+
+            string updated;
+            if (!update(exists, current, currentVersion, updated)) {
+                return false;
+            }
+
+            const uint64_t written = this->clock.next();
+            this->store(shard, hash, key, updated, inBase, written);
+            if (version != nullptr) {
+                *version = written;
+            }
+            shard.retired.collect();
+        }
+
+        if (onDurable) {
+            onDurable(true);
+        }
+        return true;
+    }
+
+    bool ShardedHashStorage::remove(const string &key) {
+        const uint64_t hash = hash_key(key);
+        Shard &shard = this->shardFor(hash);
+
+        const bool inBase = this->base != nullptr && this->base->contains(key);
+
+        std::lock_guard<std::mutex> guard(shard.writeSync);
+        Table *table = shard.table.load(std::memory_order_relaxed);
+        for (size_t i = hash & table->mask;; i = (i + 1) & table->mask) {
+            Entry *current = table->slots[i].load(std::memory_order_relaxed);
+            if (current == nullptr) {
+                break;
+            }
+
+            if (current != tombstone() && current->hash == hash && current->key() == key) {
+                if (!current->live()) {
+                    return false;
+                }
+
+                this->unlink(shard, table, i, current, true);
+                shard.retired.collect();
+                return true;
+            }
+        }
+
+        if (!inBase) {
+            return false;
+        }
+
+        insert(shard, Entry::create(shard.slab, hash, this->clock.next(), key, nullptr, true));
+        updateIndex(shard, key, false);
+        shard.shadowed.fetch_add(1, std::memory_order_relaxed);
+        shard.retired.collect();
+        return true;
+    }
+
+    void ShardedHashStorage::attachBase(SnapshotFile::pointer snapshot) {
+        this->base = snapshot;
+        this->baseVersion = this->clock.next();
+    }
+
+    SnapshotFile::pointer ShardedHashStorage::getBase() const {
+        return this->base;
+    }
+
+    void ShardedHashStorage::setMemoryLimit(size_t bytes) {
+        this->memoryLimit = bytes;
+        this->shardBudget = bytes / this->shards.size();
+    }
+
+    size_t ShardedHashStorage::getMemoryLimit() const {
+        return this->memoryLimit;
+    }
+
+    size_t ShardedHashStorage::memoryUsage() const {
+        size_t bytes = 0;
+        for (const auto &shard : this->shards) {
+            bytes += shard->bytes.load(std::memory_order_relaxed);
+        }
+
+        return bytes;
+    }
+
+    uint64_t ShardedHashStorage::getEvictions() const {
+        uint64_t evictions = 0;
+        for (const auto &shard : this->shards) {
+            evictions += shard->evictions.load(std::memory_order_relaxed);
+        }
+
+        return evictions;
+    }
+
+    void ShardedHashStorage::forEach(const record_callback &callback) const {
+        for (const auto &shard : this->shards) {
+            EpochManager::Guard guard;
+            const Table *table = shard->table.load(std::memory_order_acquire);
+            for (size_t i = 0; i <= table->mask; i++) {
+                const Entry *entry = table->slots[i].load(std::memory_order_acquire);
+                if (entry != nullptr && entry != tombstone() && entry->live()) {
+                    callback(entry->key(), entry->value());
+                }
+            }
+        }
+
+        if (this->base == nullptr) {
+            return;
+        }
+
+        this->base->forEach([this, &callback](string_view key, string_view value) {
+            const uint64_t hash = hash_key(key.data(), key.size());
+            EpochManager::Guard guard;
+            if (find(this->shardFor(hash).table.load(std::memory_order_acquire), hash, key) == nullptr) {
+                callback(key, value);
+            }
+        });
+    }
+
+    void ShardedHashStorage::indexBase() const {
+        if (this->base == nullptr) {
+            return;
+        }
+
+        // a memory entry means the key is either indexed already (live) or deleted (marker),
+        // checked under the shard lock so writers racing with this pass stay consistent
+        this->base->forEach([this](string_view key, string_view) {
+            const uint64_t hash = hash_key(key.data(), key.size());
+            Shard &shard = this->shardFor(hash);
+
+            std::lock_guard<std::mutex> guard(shard.writeSync);
+            if (find(shard.table.load(std::memory_order_relaxed), hash, key) == nullptr) {
+                updateIndex(shard, string(key), true);
+            }
+        });
+    }
+
+    void ShardedHashStorage::scan(const string &start, const string &end, const scan_callback &callback) const {
+        std::call_once(this->baseIndexed, [this]() { this->indexBase(); });
+
+        struct Source {
+            Shard *shard;
+            std::vector<string> keys;
+            size_t position = 0;
+            size_t batch = 8;///< short scans touch every shard, so batches start small and grow
+            bool exhausted = false;
+        };
+
+        // copies the next batch of keys >= from, the lock is not held while the caller sends them
+        const auto fill = [&end](Source &source, const string &from) {
+            source.keys.clear();
+            source.position = 0;
+
+            std::lock_guard<std::mutex> guard(source.shard->writeSync);
+            source.shard->index.scan(from, [&source, &end](const string &key) {
+                if (!end.empty() && key >= end) {
+                    return false;
+                }
+
+                source.keys.push_back(key);
+                return source.keys.size() < source.batch;
+            });
+
+            source.exhausted = source.keys.size() < source.batch;
+            source.batch = source.batch * 2 < SCAN_BATCH ? source.batch * 2 : SCAN_BATCH;
+        };
+
+        std::vector<Source> sources(this->shards.size());
+        const auto greater = [&sources](size_t a, size_t b) {
+            return sources[a].keys[sources[a].position] > sources[b].keys[sources[b].position];
+        };
+        std::priority_queue<size_t, std::vector<size_t>, decltype(greater)> heap(greater);
+
+        for (size_t i = 0; i < this->shards.size(); i++) {
+            sources[i].shard = this->shards[i].get();
+            fill(sources[i], start);
+            if (!sources[i].keys.empty()) {
+                heap.push(i);
+            }
+        }
+
+        while (!heap.empty()) {
+            const size_t i = heap.top();
+            heap.pop();
+
+            Source &source = sources[i];
+            const string &key = source.keys[source.position];
+
+            // removed after the batch was copied - skip it
+            const value_pointer value = this->getShared(key);
+            if (value != nullptr && !callback(key, *value)) {
+                return;
+            }
+
+            if (++source.position == source.keys.size()) {
+                if (source.exhausted) {
+                    continue;
+                }
+
+                // the smallest key after the last one copied
+                fill(source, source.keys.back() + '\0');
+                if (source.keys.empty()) {
+                    continue;
+                }
+            }
+
+            heap.push(i);
+        }
+    }
+
+    size_t ShardedHashStorage::size() const {
+        size_t count = 0;
+        size_t shadowed = 0;
+        for (const auto &shard : this->shards) {
+            count += shard->live.load(std::memory_order_relaxed);
+            shadowed += shard->shadowed.load(std::memory_order_relaxed);
+        }
+
+        if (this->base != nullptr) {
+            count += static_cast<size_t>(this->base->getCount()) - shadowed;
+        }
+
+        return count;
+    }
+
+    bool ShardedHashStorage::versioned() const {
+        return true;
+    }
+
+    uint64_t ShardedHashStorage::acquireSnapshot() {
+        uint64_t snapshot;
+        {
+            std::lock_guard<std::mutex> guard(this->snapshotSync);
+            // raised before the timestamp is drawn: every write with a later version keeps history
+            this->snapshotCount.fetch_add(1);
+            snapshot = this->clock.next();
+            this->snapshots.insert(snapshot);
+            this->oldestSnapshot.store(*this->snapshots.begin());
+        }
+
+        // writes that drew an earlier version may still be publishing it, wait them out
+        for (const auto &shard : this->shards) {
+            std::lock_guard<std::mutex> guard(shard->writeSync);
+        }
+
+        std::call_once(this->collectorStarted, [this]() { this->collector = std::thread(&ShardedHashStorage::collectorLoop, this); });
+        return snapshot;
+    }
+
+    void ShardedHashStorage::releaseSnapshot(uint64_t snapshot) {
+        {
+            std::lock_guard<std::mutex> guard(this->snapshotSync);
+            const auto found = this->snapshots.find(snapshot);
+            if (found == this->snapshots.end()) {
+                return;
+            }
+
+            this->snapshots.erase(found);
+            this->oldestSnapshot.store(this->snapshots.empty() ? NO_SNAPSHOT : *this->snapshots.begin());
+            this->snapshotCount.fetch_sub(1);
+        }
+
+        this->collectorWake.notify_one();
+    }
+
+    value_pointer ShardedHashStorage::getAt(const string &key, uint64_t snapshot, uint64_t *version) const {
+        const uint64_t hash = hash_key(key);
+        const Shard &shard = this->shardFor(hash);
+
+        EpochManager::Guard guard;
+        const Entry *head = find(shard.table.load(std::memory_order_acquire), hash, key);
+        if (head != nullptr) {
+            const Entry *entry = head;
+            while (entry != nullptr && entry->version > snapshot) {
+                entry = entry->older();
+            }
+
+            if (entry != nullptr) {
+                if (!entry->live()) {
+                    return nullptr;
+                }
+
+                if (version != nullptr) {
+                    *version = entry->version;
+                }
+                return entry->sharedValue();
+            }
+
+            // every memory version is newer, the key was either in base or missing
+            if (!head->inBase()) {
+                return nullptr;
+            }
+        }
+
+        string_view baseValue;
+        if (this->base != nullptr && this->base->find(key, baseValue)) {
+            if (version != nullptr) {
+                *version = this->baseVersion;
+            }
+            return std::make_shared<const string>(baseValue);
+        }
+
+        return nullptr;
+    }
+
+    uint64_t ShardedHashStorage::commit(uint64_t snapshot, const std::vector<string> &checked, const record_batch &writes) {
+        // nothing to validate: a snapshot is a consistent read by itself
+        if (writes.empty()) {
+            return snapshot;
+        }
+
+        struct Key {
+            size_t shard;
+            uint64_t hash;
+        };
+
+        std::vector<Key> checkedKeys;
+        checkedKeys.reserve(checked.size());
+        std::vector<size_t> involved;
+        for (const auto &key : checked) {
+            const uint64_t hash = hash_key(key);
+            checkedKeys.push_back({ this->shardIndex(hash), hash });
+            involved.push_back(checkedKeys.back().shard);
+        }
+
+        std::vector<Key> writeKeys;
+        std::vector<bool> inBase;
+        writeKeys.reserve(writes.size());
+        inBase.reserve(writes.size());
+        for (const auto &record : writes) {
+            const uint64_t hash = hash_key(record.first);
+            writeKeys.push_back({ this->shardIndex(hash), hash });
+            inBase.push_back(this->base != nullptr && this->base->contains(record.first));
+            involved.push_back(writeKeys.back().shard);
+        }
+
+        // index order, so two commits never wait for each other in a cycle
+        std::sort(involved.begin(), involved.end());
+        involved.erase(std::unique(involved.begin(), involved.end()), involved.end());
+
+        std::vector<std::unique_lock<std::mutex>> locks;
+        locks.reserve(involved.size());
+        for (const size_t index : involved) {
+            locks.emplace_back(this->shards[index]->writeSync);
+        }
+
+        for (size_t i = 0; i < checked.size(); i++) {
+            const Shard &shard = *(this->shards[checkedKeys[i].shard]);
+            const Entry *entry = find(shard.table.load(std::memory_order_relaxed), checkedKeys[i].hash, checked[i]);
+            if (entry != nullptr && entry->version > snapshot) {
+                return 0;
+            }
+        }
+
+        const uint64_t version = this->clock.next();
+        for (size_t i = 0; i < writes.size(); i++) {
+            this->store(*(this->shards[writeKeys[i].shard]), writeKeys[i].hash, writes[i].first, writes[i].second, inBase[i], version);
+        }
+
+        for (const size_t index : involved) {
+            this->shards[index]->retired.collect();
+        }
+
+        return version;
+    }
+
+    size_t ShardedHashStorage::getSnapshotCount() const {
+        return this->snapshotCount.load(std::memory_order_relaxed);
+    }
+
+    size_t ShardedHashStorage::historySize() const {
+        size_t history = 0;
+        for (const auto &shard : this->shards) {
+            history += shard->history.load(std::memory_order_relaxed);
+        }
+
+        return history;
+    }
+
+    void ShardedHashStorage::compact(Shard &shard, Entry *head, const std::vector<uint64_t> &snapshots) {
+        // a version is read by the snapshots between it and the next newer one, unlinking it
+        // leaves readers already on it a valid older pointer until the epoch frees it
+        Entry *newer = head;
+        Entry *entry = head->older();
+        while (entry != nullptr) {
+            Entry *older = entry->older();
+            const auto reader = std::lower_bound(snapshots.begin(), snapshots.end(), entry->version);
+            if (reader != snapshots.end() && *reader < newer->version) {
+                newer = entry;
+            } else {
+                newer->setOlder(older);
+                shard.bytes.fetch_sub(entryBytes(entry), std::memory_order_relaxed);
+                shard.history.fetch_sub(1, std::memory_order_relaxed);
+                shard.retired.retire(entry, &Entry::destroy);
+            }
+            entry = older;
+        }
+    }
+
+    void ShardedHashStorage::collectShard(Shard &shard) {
+        // a slice per lock hold, writers to the shard wait for one slice at most
+        for (size_t position = 0;;) {
+            std::lock_guard<std::mutex> guard(shard.writeSync);
+            Table *table = shard.table.load(std::memory_order_relaxed);
+            if (position > table->mask) {
+                return;
+            }
+
+            // copied under the shard lock: a snapshot opened later is newer than every version here
+            std::vector<uint64_t> snapshots;
+            {
+                std::lock_guard<std::mutex> snapshotGuard(this->snapshotSync);
+                snapshots.assign(this->snapshots.begin(), this->snapshots.end());
+            }
+            const uint64_t horizon = snapshots.empty() ? NO_SNAPSHOT : snapshots.front();
+
+            const size_t end = std::min(position + COLLECT_SLICE, table->mask + 1);
+            for (; position < end; position++) {
+                Entry *entry = table->slots[position].load(std::memory_order_relaxed);
+                if (entry == nullptr || entry == tombstone()) {
+                    continue;
+                }
+
+                this->compact(shard, entry, snapshots);
+
+                // a deleted marker no snapshot can see past is a plain deleted key
+                if (!entry->live() && !entry->inBase() && entry->older() == nullptr && entry->version <= horizon) {
+                    table->slots[position].store(tombstone(), std::memory_order_release);
+                    shard.count.fetch_sub(1, std::memory_order_relaxed);
+                    shard.tombstones++;
+                    shard.history.fetch_sub(1, std::memory_order_relaxed);
+                    shard.bytes.fetch_sub(entryBytes(entry), std::memory_order_relaxed);
+                    shard.retired.retire(entry, &Entry::destroy);
+                }
+            }
+
+            shard.retired.collect();
+        }
+    }
+
+    void ShardedHashStorage::collectHistory() {
+        for (const auto &shard : this->shards) {
+            if (shard->history.load(std::memory_order_relaxed) > 0) {
+                this->collectShard(*shard);
+            }
+        }
+    }
+
+    void ShardedHashStorage::collectorLoop() {
+        std::unique_lock<std::mutex> lock(this->collectorSync);
+        while (!this->collectorStopping) {
+            this->collectorWake.wait_for(lock, COLLECT_INTERVAL);
+            if (this->collectorStopping) {
+                return;
+            }
+
+            lock.unlock();
+            this->collectHistory();
+            lock.lock();
+        }
+    }
+
+    size_t ShardedHashStorage::getShardCount() const {
+        return this->shards.size();
+    }
+}// namespace Diginext::Core::Storage
@@ -0,0 +1,188 @@
+#include "Storage/SlabAllocator.h"
+
+#include <cstdlib>
+#include <initializer_list>
+#include <new>
+
+namespace Diginext::Core::Storage {
+
+    // 16 byte steps up to 128, 32 up to 384, then 64: at most 1/7 of a slot is wasted
+    const size_t SlabAllocator::CLASS_SIZES[CLASS_COUNT] = {
+            16, 32, 48, 64, 80, 96, 112, 128,
+            160, 192, 224, 256, 288, 320, 352, 384,
+            448, 512
+    };
+
+    const size_t PAGE_HEADER_SIZE = 64;
+
+    static void *page_alloc(size_t size) {
+#ifdef _WIN32
+        void *page = _aligned_malloc(size, size);
+#else
+        void *page = std::aligned_alloc(size, size);
+#endif
+        if (page == nullptr) {
+            throw std::bad_alloc();
+        }
+
+        return page;
+    }
+
+    static void page_free(void *page) {
+#ifdef _WIN32
+        _aligned_free(page);
+#else
+        std::free(page);
+#endif
+    }
+
+    SlabAllocator::SlabAllocator() {
+        static_assert(sizeof(Page) <= PAGE_HEADER_SIZE, "slab page header does not fit");
+        this->pageCount = 0;
+        this->usedBytes = 0;
+    }
+
+    SlabAllocator::~SlabAllocator() {
+        // slots still handed out go with their pages
+        for (auto &sizeClass : this->classes) {
+            for (Page *list : { sizeClass.partial, sizeClass.full }) {
+                while (list != nullptr) {
+                    Page *next = list->next;
+                    page_free(list);
+                    list = next;
+                }
+            }
+        }
+    }
+
+    size_t SlabAllocator::classIndex(size_t size) {
+        size_t low = 0;
+        size_t high = CLASS_COUNT;
+        while (low < high) {
+            const size_t middle = (low + high) / 2;
+            if (CLASS_SIZES[middle] < size) {
+                low = middle + 1;
+            } else {
+                high = middle;
+            }
+        }
+
+        return low;
+    }
+
+    size_t SlabAllocator::slotSize(size_t size) {
+        const size_t index = classIndex(size);
+        return index < CLASS_COUNT ? CLASS_SIZES[index] : 0;
+    }
+
+    SlabAllocator::Page *SlabAllocator::newPage(size_t sizeClass) {
+        Page *page = static_cast<Page *>(page_alloc(PAGE_SIZE));
+        page->owner = this;
+        page->prev = nullptr;
+        page->next = nullptr;
+        page->freeList = nullptr;
+        page->bump = reinterpret_cast<char *>(page) + PAGE_HEADER_SIZE;
+        page->end = page->bump + (PAGE_SIZE - PAGE_HEADER_SIZE) / CLASS_SIZES[sizeClass] * CLASS_SIZES[sizeClass];
+        page->used = 0;
+        page->sizeClass = static_cast<uint32_t>(sizeClass);
+        page->full = false;
+
+        this->classes[sizeClass].pages++;
+        this->pageCount++;
+        return page;
+    }
+
+    void SlabAllocator::link(Page *page, bool full) {
+        Page *&head = full ? this->classes[page->sizeClass].full : this->classes[page->sizeClass].partial;
+        page->prev = nullptr;
+        page->next = head;
+        if (head != nullptr) {
+            head->prev = page;
+        }
+        head = page;
+        page->full = full;
+    }
+
+    void SlabAllocator::unlink(Page *page) {
+        Page *&head = page->full ? this->classes[page->sizeClass].full : this->classes[page->sizeClass].partial;
+        if (page->prev != nullptr) {
+            page->prev->next = page->next;
+        } else {
+            head = page->next;
+        }
+        if (page->next != nullptr) {
+            page->next->prev = page->prev;
+        }
+
+        page->prev = nullptr;
+        page->next = nullptr;
+    }
+
+    void *SlabAllocator::allocate(size_t size) {
+        const size_t index = classIndex(size);
+        if (index >= CLASS_COUNT) {
+            throw std::bad_alloc();
+        }
+
+        Page *page = this->classes[index].partial;
+        if (page == nullptr) {
+            page = this->newPage(index);
+            this->link(page, false);
+        }
+
+        const size_t slotSize = CLASS_SIZES[index];
+        void *slot;
+        if (page->freeList != nullptr) {
+            slot = page->freeList;
+            page->freeList = *static_cast<void **>(slot);
+        } else {
+            slot = page->bump;
+            page->bump += slotSize;
+        }
+
+        page->used++;
+        this->usedBytes += slotSize;
+
+        if (page->freeList == nullptr && page->bump == page->end) {
+            this->unlink(page);
+            this->link(page, true);
+        }
+
+        return slot;
+    }
+
+    void SlabAllocator::release(void *slot) {
+        const auto address = reinterpret_cast<uintptr_t>(slot);
+        Page *page = reinterpret_cast<Page *>(address & ~static_cast<uintptr_t>(PAGE_SIZE - 1));
+        page->owner->free(page, slot);
+    }
+
+    void SlabAllocator::free(Page *page, void *slot) {
+        *static_cast<void **>(slot) = page->freeList;
+        page->freeList = slot;
+        page->used--;
+        this->usedBytes -= CLASS_SIZES[page->sizeClass];
+
+        if (page->full) {
+            this->unlink(page);
+            this->link(page, false);
+        }
+
+        // keep the last page of a class around, a delete/insert cycle would churn it
+        SizeClass &sizeClass = this->classes[page->sizeClass];
+        if (page->used == 0 && sizeClass.pages > 1) {
+            this->unlink(page);
+            sizeClass.pages--;
+            this->pageCount--;
+            page_free(page);
+        }
+    }
+
+    size_t SlabAllocator::getUsedBytes() const {
+        return this->usedBytes;
+    }
+
+    size_t SlabAllocator::getPageCount() const {
+        return this->pageCount;
+    }
+}// namespace Diginext::Core::Storage
@@ -0,0 +1,279 @@
+#include "Storage/SnapshotFile.h"
+
+#include "Checksum/Crc32.h"
+#include "Storage/StorageEncoding.h"
+#include "Storage/StorageFile.h"
+#include "Storage/StorageHash.h"
+
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace Diginext::Core::Storage {
+    const char SNAPSHOT_MAGIC[8] = { 'D', 'G', 'X', 'S', 'N', 'A', 'P', '1' };
+    const uint32_t SNAPSHOT_VERSION = 1;
+    const size_t SNAPSHOT_HEADER_SIZE = 64;
+    const size_t SNAPSHOT_BUCKET_SIZE = 16;
+    const size_t SNAPSHOT_RECORD_HEADER_SIZE = 8;
+    const size_t SNAPSHOT_WRITE_BUFFER = 4 * 1024 * 1024;
+
+    SnapshotFile::pointer SnapshotFile::open(const string &path) {
+        auto snapshot = std::make_shared<SnapshotFile>(path);
+        if (!snapshot->map()) {
+            return nullptr;
+        }
+
+        return snapshot;
+    }
+
+    SnapshotFile::SnapshotFile(const string &path) {
+        this->path = path;
+        this->data = nullptr;
+        this->size = 0;
+        this->count = 0;
+        this->bucketMask = 0;
+        this->indexOffset = 0;
+        this->walOffset = 0;
+#ifdef _WIN32
+        this->fileHandle = nullptr;
+        this->mappingHandle = nullptr;
+#endif
+    }
+
+    SnapshotFile::~SnapshotFile() {
+        this->unmap();
+    }
+
+    bool SnapshotFile::map() {
+        const uint64_t fileSize = file_size(this->path);
+        if (fileSize < SNAPSHOT_HEADER_SIZE) {
+            return false;
+        }
+
+#ifdef _WIN32
+        HANDLE file = CreateFileA(this->path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE, nullptr,
+                                  OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_RANDOM_ACCESS, nullptr);
+        if (file == INVALID_HANDLE_VALUE) {
+            return false;
+        }
+
+        HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (mapping == nullptr) {
+            CloseHandle(file);
+            return false;
+        }
+
+        void *view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+        if (view == nullptr) {
+            CloseHandle(mapping);
+            CloseHandle(file);
+            return false;
+        }
+
+        this->fileHandle = file;
+        this->mappingHandle = mapping;
+#else
+        const int fd = ::open(this->path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            return false;
+        }
+
+        void *view = ::mmap(nullptr, static_cast<size_t>(fileSize), PROT_READ, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if (view == MAP_FAILED) {
+            return false;
+        }
+
+        // lookups jump around the index and heap, readahead would only waste page cache
+        ::madvise(view, static_cast<size_t>(fileSize), MADV_RANDOM);
+#endif
+
+        this->data = static_cast<const char *>(view);
+        this->size = fileSize;
+
+        const char *header = this->data;
+        const uint64_t bucketCount = get_fixed64(header + 24);
+        const bool valid = std::memcmp(header, SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC)) == 0 &&
+                           get_fixed32(header + 8) == SNAPSHOT_VERSION &&
+                           get_fixed32(header + 12) == Crc32::Compute(header + 16, SNAPSHOT_HEADER_SIZE - 16) &&
+                           get_fixed64(header + 48) == fileSize &&
+                           bucketCount > 0 && (bucketCount & (bucketCount - 1)) == 0 &&
+                           get_fixed64(header + 32) + bucketCount * SNAPSHOT_BUCKET_SIZE == fileSize;
+        if (!valid) {
+            this->unmap();
+            return false;
+        }
+
+        this->count = get_fixed64(header + 16);
+        this->bucketMask = bucketCount - 1;
+        this->indexOffset = get_fixed64(header + 32);
+        this->walOffset = get_fixed64(header + 40);
+        return true;
+    }
+
+    void SnapshotFile::unmap() {
+        if (this->data == nullptr) {
+            return;
+        }
+
+#ifdef _WIN32
+        UnmapViewOfFile(this->data);
+        CloseHandle(static_cast<HANDLE>(this->mappingHandle));
+        CloseHandle(static_cast<HANDLE>(this->fileHandle));
+        this->mappingHandle = nullptr;
+        this->fileHandle = nullptr;
+#else
+        ::munmap(const_cast<char *>(this->data), static_cast<size_t>(this->size));
+#endif
+
+        this->data = nullptr;
+        this->size = 0;
+    }
+
+    bool SnapshotFile::record(uint64_t offset, string_view &key, string_view &value) const {
+        if (offset < SNAPSHOT_HEADER_SIZE || offset + SNAPSHOT_RECORD_HEADER_SIZE > this->indexOffset) {
+            return false;
+        }
+
+        const char *p = this->data + offset;
+        const uint64_t keySize = get_fixed32(p);
+        const uint64_t valueSize = get_fixed32(p + 4);
+        if (offset + SNAPSHOT_RECORD_HEADER_SIZE + keySize + valueSize > this->indexOffset) {
+            return false;
+        }
+
+        key = string_view(p + SNAPSHOT_RECORD_HEADER_SIZE, keySize);
+        value = string_view(p + SNAPSHOT_RECORD_HEADER_SIZE + keySize, valueSize);
+        return true;
+    }
+
+    bool SnapshotFile::find(string_view key, string_view &value) const {
+        if (this->data == nullptr) {
+            return false;
+        }
+
+        const uint64_t hash = hash_key(key.data(), key.size());
+        const char *index = this->data + this->indexOffset;
+
+        for (uint64_t i = hash & this->bucketMask;; i = (i + 1) & this->bucketMask) {
+            const char *bucket = index + i * SNAPSHOT_BUCKET_SIZE;
+            const uint64_t offset = get_fixed64(bucket + 8);
+            if (offset == 0) {
+                return false;
+            }
+
+            string_view recordKey;
+            if (get_fixed64(bucket) == hash && this->record(offset, recordKey, value) && recordKey == key) {
+                return true;
+            }
+        }
+    }
+
+    bool SnapshotFile::contains(string_view key) const {
+        string_view value;
+        return this->find(key, value);
+    }
+
+    void SnapshotFile::forEach(const record_callback &callback) const {
+        uint64_t offset = SNAPSHOT_HEADER_SIZE;
+        string_view key;
+        string_view value;
+
+        while (offset < this->indexOffset && this->record(offset, key, value)) {
+            callback(key, value);
+            offset += SNAPSHOT_RECORD_HEADER_SIZE + key.size() + value.size();
+        }
+    }
+
+    uint64_t SnapshotFile::write(const string &path, const source_callback &source, uint64_t walOffset) {
+        const string tempPath = path + ".tmp";
+        FILE *file = std::fopen(tempPath.c_str(), "wb");
+        if (file == nullptr) {
+            throw std::runtime_error("SnapshotFile: cannot create " + tempPath);
+        }
+
+        std::setvbuf(file, nullptr, _IOFBF, SNAPSHOT_WRITE_BUFFER);
+
+        std::vector<std::pair<uint64_t, uint64_t>> entries;// (hash, offset)
+        bool success = std::fwrite(string(SNAPSHOT_HEADER_SIZE, '\0').data(), 1, SNAPSHOT_HEADER_SIZE, file) == SNAPSHOT_HEADER_SIZE;
+        uint64_t offset = SNAPSHOT_HEADER_SIZE;
+
+        string buffer;
+        source([&](string_view key, string_view value) {
+            buffer.clear();
+            put_fixed32(buffer, static_cast<uint32_t>(key.size()));
+            put_fixed32(buffer, static_cast<uint32_t>(value.size()));
+            buffer.append(key.data(), key.size());
+            buffer.append(value.data(), value.size());
+
+            success = std::fwrite(buffer.data(), 1, buffer.size(), file) == buffer.size() && success;
+            entries.emplace_back(hash_key(key.data(), key.size()), offset);
+            offset += buffer.size();
+        });
+
+        // index at most 2/3 full, so probes stay short
+        uint64_t bucketCount = 16;
+        while (bucketCount * 2 < entries.size() * 3) {
+            bucketCount *= 2;
+        }
+
+        const uint64_t mask = bucketCount - 1;
+        string index(bucketCount * SNAPSHOT_BUCKET_SIZE, '\0');
+        for (const auto &entry : entries) {
+            uint64_t i = entry.first & mask;
+            while (get_fixed64(&index[i * SNAPSHOT_BUCKET_SIZE + 8]) != 0) {
+                i = (i + 1) & mask;
+            }
+
+            set_fixed64(&index[i * SNAPSHOT_BUCKET_SIZE], entry.first);
+            set_fixed64(&index[i * SNAPSHOT_BUCKET_SIZE + 8], entry.second);
+        }
+
+        success = std::fwrite(index.data(), 1, index.size(), file) == index.size() && success;
+
+        string header(SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC));
+        put_fixed32(header, SNAPSHOT_VERSION);
+        put_fixed32(header, 0);
+        put_fixed64(header, entries.size());
+        put_fixed64(header, bucketCount);
+        put_fixed64(header, offset);
+        put_fixed64(header, walOffset);
+        put_fixed64(header, offset + index.size());
+        put_fixed64(header, 0);
+        set_fixed32(&header[12], Crc32::Compute(header.data() + 16, SNAPSHOT_HEADER_SIZE - 16));
+
+        success = std::fseek(file, 0, SEEK_SET) == 0 && success;
+        success = std::fwrite(header.data(), 1, header.size(), file) == header.size() && success;
+        success = file_sync(file) && success;
+        success = std::fclose(file) == 0 && success;
+
+        if (!success || !file_replace(tempPath, path)) {
+            file_remove(tempPath);
+            throw std::runtime_error("SnapshotFile: cannot write " + path);
+        }
+
+        return entries.size();
+    }
+
+    uint64_t SnapshotFile::getCount() const {
+        return this->count;
+    }
+
+    uint64_t SnapshotFile::getWalOffset() const {
+        return this->walOffset;
+    }
+
+    string SnapshotFile::getPath() const {
+        return this->path;
+    }
+}// namespace Diginext::Core::Storage
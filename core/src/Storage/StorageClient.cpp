@@ -2,98 +2,771 @@
 
 #include "Log/LogConsole.h"
 
+#include <algorithm>
 #include <chrono>
+#include <stdexcept>
+#include <utility>
 
 namespace Diginext::Core::Storage {
     using namespace std::chrono_literals;
 
+    const auto CONNECT_TIMEOUT = 5s;
+    const auto REQUEST_TIMEOUT = 30s;
+
+    static tcp::endpoint parse_endpoint(const string &endpoint) {
+        const size_t colon = endpoint.rfind(':');
+        if (colon == string::npos || colon == 0 || colon + 1 == endpoint.size()) {
+            throw std::invalid_argument("StorageClient: endpoint must be host:port, got " + endpoint);
+        }
+
+        string host = endpoint.substr(0, colon);
+        if (host.size() > 2 && host.front() == '[' && host.back() == ']') {
+            host = host.substr(1, host.size() - 2);
+        }
+
+        size_t parsed = 0;
+        const unsigned long port = std::stoul(endpoint.substr(colon + 1), &parsed);
+        if (parsed != endpoint.size() - colon - 1 || port == 0 || port > 65535) {
+            throw std::invalid_argument("StorageClient: bad port in " + endpoint);
+        }
+
+        return tcp::endpoint(boost::asio::ip::address::from_string(host), static_cast<unsigned short>(port));
+    }
+
+    static nlohmann::json error_answer(const string &description) {
+        nlohmann::json json;
+        json[JSON::KEY::STATUS] = JSON::VALUE::STATUS_ERROR;
+        json[JSON::KEY::DESCRIPTION] = description;
+        return json;
+    }
+
     StorageClient::pointer StorageClient::create(const string &host, const unsigned short port) {
         return std::make_shared<StorageClient>(host, port);
     }
 
-    StorageClient::StorageClient(const string &host, const unsigned short port) {
+    StorageClient::pointer StorageClient::create(const std::vector<string> &endpoints, size_t vnodes) {
+        return std::make_shared<StorageClient>(endpoints, vnodes);
+    }
+
+    StorageClient::StorageClient(const string &host, const unsigned short port)
+        : StorageClient(std::vector<string>{ host + ":" + std::to_string(port) }) {
+    }
+
+    StorageClient::StorageClient(const std::vector<string> &endpoints, size_t vnodes) : ring(vnodes) {
         this->logger = ConsoleLogger::create("StorageClient", false);
-        this->host = host;
-        this->port = port;
-        this->tcpClient = tcp_client::create();
-        this->tcpClient->onConnectionTimedOut.connect(boost::bind(&StorageClient::handle_connection_timed_oud, this, _1));
-        this->tcpClient->onConnectionError.connect(boost::bind(&StorageClient::handle_connection_error, this, _1, _2));
-        this->tcpClient->onConnectionSuccess.connect(boost::bind(&StorageClient::handle_connection_success, this, _1));
-        this->tcpClient->onDisconnected.connect(boost::bind(&StorageClient::handle_disconnected, this));
-        this->tcpClient->onReadMessage.connect(boost::bind(&StorageClient::handle_read_message, this, _1));
-        this->tcpClient->onReadError.connect(boost::bind(&StorageClient::handle_read_error, this, _1, _2));
-        this->tcpClient->onSendError.connect(boost::bind(&StorageClient::handle_send_error, this, _1, _2));
+        this->framing = tcp_framing::Base64Line;
+        this->nextRequestId = 1;
+        for (const auto &endpoint : endpoints) {
+            this->addEndpoint(endpoint);
+        }
     }
 
-    bool StorageClient::Started() const {
+    StorageClient::~StorageClient() {
         try {
-            if (this->tcpClient != nullptr) {
-                return this->tcpClient->started();
-            }
+            this->Disconnect();
         } catch (...) {
         }
+    }
+
+    bool StorageClient::addEndpoint(const string &endpoint) {
+        const tcp::endpoint address = parse_endpoint(endpoint);
+
+        std::lock_guard<std::mutex> guard(this->ringSync);
+        if (!this->ring.add(endpoint)) {
+            return false;
+        }
 
-        return false;
+        auto shard = std::make_shared<Shard>();
+        shard->id = endpoint;
+        shard->endpoint = address;
+        this->shards[endpoint] = shard;
+        return true;
     }
 
-    void StorageClient::Connect() {
-        if (this->Started())
+    bool StorageClient::removeEndpoint(const string &endpoint) {
+        shard_pointer shard;
         {
-            return;
+            std::lock_guard<std::mutex> guard(this->ringSync);
+            if (!this->ring.remove(endpoint)) {
+                return false;
+            }
+
+            shard = this->shards[endpoint];
+            this->shards.erase(endpoint);
+        }
+
+        // requests still in flight on it finish first
+        {
+            std::unique_lock<std::mutex> lock(shard->sync);
+            shard->wake.wait_for(lock, REQUEST_TIMEOUT, [&shard]() { return shard->calls.empty(); });
+        }
+
+        std::lock_guard<std::mutex> guard(shard->connectSync);
+        this->dropConnection(*shard);
+        return true;
+    }
+
+    std::vector<string> StorageClient::getEndpoints() const {
+        std::lock_guard<std::mutex> guard(this->ringSync);
+        return this->ring.getNodes();
+    }
+
+    string StorageClient::locate(const string &key) const {
+        std::lock_guard<std::mutex> guard(this->ringSync);
+        return this->ring.empty() ? string() : this->ring.locate(key);
+    }
+
+    StorageClient::shard_pointer StorageClient::shardOf(const string &key) {
+        std::lock_guard<std::mutex> guard(this->ringSync);
+        if (this->ring.empty()) {
+            return nullptr;
+        }
+
+        return this->shards[this->ring.locate(key)];
+    }
+
+    std::vector<StorageClient::shard_pointer> StorageClient::allShards() const {
+        // ordered by id: callers holding several connectSync or orderSync take them in the same order
+        std::lock_guard<std::mutex> guard(this->ringSync);
+        std::vector<shard_pointer> result;
+        result.reserve(this->shards.size());
+        for (const auto &shard : this->shards) {
+            result.push_back(shard.second);
+        }
+        return result;
+    }
+
+    bool StorageClient::Started() const {
+        const auto shards = this->allShards();
+        for (const auto &shard : shards) {
+            std::lock_guard<std::mutex> guard(shard->sync);
+            if (!shard->connected || shard->linkDown) {
+                return false;
+            }
         }
 
-        const auto ip = boost::asio::ip::address::from_string(this->host);
-        auto endpoint = tcp::endpoint(ip, this->port);
-        this->tcpClient->connect(endpoint);
-        this->tcpClient->start();
+        return !shards.empty();
+    }
+
+    void StorageClient::setFraming(tcp_framing framing) {
+        this->framing = framing;
+    }
+
+    void StorageClient::Connect() {
+        const auto shards = this->allShards();
+        std::vector<std::unique_lock<std::mutex>> locks;
+        for (const auto &shard : shards) {
+            locks.emplace_back(shard->connectSync);
+            this->beginConnect(*shard);
+        }
+
+        for (const auto &shard : shards) {
+            this->waitConnected(*shard);
+        }
     }
 
     void StorageClient::Disconnect() {
-        if (!this->Started())
+        for (const auto &shard : this->allShards()) {
+            std::lock_guard<std::mutex> guard(shard->connectSync);
+            this->dropConnection(*shard);
+        }
+    }
+
+    void StorageClient::beginConnect(Shard &shard) {
+        if (shard.client != nullptr) {
+            return;
+        }
+
         {
+            std::lock_guard<std::mutex> guard(shard.sync);
+            shard.connected = false;
+            shard.linkDown = false;
+            shard.tagged = false;
+            shard.link++;
+        }
+
+        // a fresh client per connection, a stopped io service does not run again
+        Shard *target = &shard;
+        shard.client = tcp_client::create();
+        shard.client->setFraming(this->framing);
+        shard.client->onConnectionTimedOut.connect(boost::bind(&StorageClient::handle_connection_timed_oud, this, target, _1));
+        shard.client->onConnectionError.connect(boost::bind(&StorageClient::handle_connection_error, this, target, _1, _2));
+        shard.client->onConnectionSuccess.connect(boost::bind(&StorageClient::handle_connection_success, this, target, _1));
+        shard.client->onDisconnected.connect(boost::bind(&StorageClient::handle_disconnected, this, target));
+        shard.client->onReadReply.connect(boost::bind(&StorageClient::handle_read_message, this, target, _1, _2));
+        shard.client->onReadError.connect(boost::bind(&StorageClient::handle_read_error, this, target, _1, _2));
+        shard.client->onSendError.connect(boost::bind(&StorageClient::handle_send_error, this, target, _1, _2));
+
+        auto endpoint = shard.endpoint;
+        shard.client->connect(endpoint);
+        shard.client->start();
+    }
+
+    bool StorageClient::waitConnected(Shard &shard) {
+        // a link lost while idle, e.g. a restarted server, gets a fresh connection right away
+        bool lost;
+        {
+            std::lock_guard<std::mutex> guard(shard.sync);
+            lost = shard.linkDown;
+        }
+        if (lost) {
+            this->dropConnection(shard);
+        }
+
+        this->beginConnect(shard);
+
+        bool connected;
+        {
+            std::unique_lock<std::mutex> lock(shard.sync);
+            shard.wake.wait_for(lock, CONNECT_TIMEOUT, [&shard]() { return shard.connected || shard.linkDown; });
+            connected = shard.connected && !shard.linkDown;
+            if (connected) {
+                // the server may have granted less than asked for
+                shard.tagged = shard.client->getConnection()->getFraming() != tcp_framing::Base64Line;
+            }
+        }
+
+        if (!connected) {
+            this->dropConnection(shard);
+        }
+        return connected;
+    }
+
+    void StorageClient::dropConnection(Shard &shard) {
+        if (shard.client == nullptr) {
             return;
         }
 
-        this->tcpClient->disconnect();
-        this->tcpClient->stop();
+        // a connection closed on purpose is not reported to the event handler
+        {
+            std::lock_guard<std::mutex> guard(shard.sync);
+            shard.connected = false;
+        }
+
+        // stop fires the disconnect handler, shard.sync must not be held here
+        shard.client->stop();
+        shard.client.reset();
+
+        this->failCalls(shard);
+        std::lock_guard<std::mutex> guard(shard.sync);
+        shard.connected = false;
+        shard.linkDown = false;
+    }
+
+    void StorageClient::failCalls(Shard &shard) {
+        // their answers are lost with the connection
+        std::lock_guard<std::mutex> guard(shard.sync);
+        for (auto &call : shard.calls) {
+            if (!call.second.complete) {
+                call.second.messages.clear();
+                call.second.complete = true;
+                call.second.done.notify_all();
+            }
+        }
+    }
+
+    StorageClient::Ticket StorageClient::sendTo(const shard_pointer &shard, const nlohmann::json &request) {
+        Ticket ticket;
+        ticket.shard = shard;
+        const string message = request.dump();
+
+        // a base64 connection lost while waiting for its turn is tried once more on the next one
+        for (int attempt = 0; attempt < 2; attempt++) {
+            tcp_client::pointer client;
+            bool tagged;
+            {
+                std::lock_guard<std::mutex> guard(shard->connectSync);
+                if (!this->waitConnected(*shard)) {
+                    return ticket;
+                }
+
+                client = shard->client;
+                std::lock_guard<std::mutex> lock(shard->sync);
+                ticket.link = shard->link;
+                tagged = shard->tagged;
+            }
+
+            // an answer without id is matched by being the only request in flight
+            if (!tagged) {
+                ticket.order = std::unique_lock<std::mutex>(shard->orderSync);
+            }
+
+            const uint64_t id = this->nextRequestId++;
+            {
+                std::lock_guard<std::mutex> guard(shard->sync);
+                if (shard->link != ticket.link || shard->linkDown) {
+                    if (ticket.order.owns_lock()) {
+                        ticket.order.unlock();
+                    }
+                    continue;
+                }
+                shard->calls[id];
+            }
+
+            ticket.id = id;
+            client->send(message, id);
+            return ticket;
+        }
+
+        return ticket;
+    }
+
+    nlohmann::json StorageClient::receiveFrom(Ticket &ticket) {
+        Shard &shard = *ticket.shard;
+        std::vector<nlohmann::json> messages;
+        {
+            std::unique_lock<std::mutex> lock(shard.sync);
+            const auto call = shard.calls.find(ticket.id);
+            call->second.done.wait_for(lock, REQUEST_TIMEOUT, [&call]() { return call->second.complete; });
+            if (call->second.complete) {
+                messages.swap(call->second.messages);
+            }
+
+            // a late answer finds no call and is dropped
+            shard.calls.erase(call);
+            if (shard.calls.empty()) {
+                shard.wake.notify_all();
+            }
+        }
+
+        if (ticket.order.owns_lock()) {
+            // without an id, a late answer must not be taken for the next request's
+            if (messages.empty()) {
+                std::lock_guard<std::mutex> guard(shard.connectSync);
+                std::unique_lock<std::mutex> lock(shard.sync);
+                const bool current = shard.link == ticket.link;
+                lock.unlock();
+                if (current) {
+                    this->dropConnection(shard);
+                }
+            }
+            ticket.order.unlock();
+        }
+
+        if (messages.empty()) {
+            return error_answer("no answer from " + shard.id);
+        }
+
+        if (messages.size() == 1) {
+            return std::move(messages.front());
+        }
+
+        // a streamed scan: the final message with the items of all of them
+        nlohmann::json items = nlohmann::json::array();
+        for (auto &message : messages) {
+            for (auto &item : message[JSON::KEY::ITEMS]) {
+                items.push_back(std::move(item));
+            }
+        }
+
+        nlohmann::json answer = std::move(messages.back());
+        answer[JSON::KEY::ITEMS] = std::move(items);
+        return answer;
+    }
+
+    nlohmann::json StorageClient::requestOne(const shard_pointer &shard, const nlohmann::json &request) {
+        if (shard == nullptr) {
+            return error_answer("no servers");
+        }
+
+        Ticket ticket = this->sendTo(shard, request);
+        if (ticket.id == 0) {
+            return error_answer("cannot connect to " + shard->id);
+        }
+
+        return this->receiveFrom(ticket);
+    }
+
+    nlohmann::json StorageClient::requestSplit(const nlohmann::json &request, const string &field) {
+        const auto &items = request[field];
+        if (!items.is_array()) {
+            return error_answer("field " + field + " must be an array");
+        }
+
+        // positions of the batch per server, ordered by id like allShards
+        std::map<string, std::pair<shard_pointer, std::vector<size_t>>> parts;
+        {
+            std::lock_guard<std::mutex> guard(this->ringSync);
+            if (this->ring.empty()) {
+                return error_answer("no servers");
+            }
+
+            for (size_t i = 0; i < items.size(); i++) {
+                const auto &key = field == JSON::KEY::KEYS ? items[i] : items[i].value(JSON::KEY::KEY, nlohmann::json());
+                if (!key.is_string()) {
+                    return error_answer("every item needs " + JSON::KEY::KEY + " and " + JSON::KEY::VALUE);
+                }
+
+                const string &id = this->ring.locate(key.get_ref<const string &>());
+                auto &part = parts[id];
+                if (part.first == nullptr) {
+                    part.first = this->shards[id];
+                }
+                part.second.push_back(i);
+            }
+        }
+
+        // an empty batch is answered here, no server holds any of it
+        if (parts.empty()) {
+            nlohmann::json answer;
+            answer[JSON::KEY::STATUS] = JSON::VALUE::STATUS_OK;
+            if (field == JSON::KEY::KEYS) {
+                answer[JSON::KEY::VALUES] = nlohmann::json::array();
+            }
+            return answer;
+        }
+
+        if (parts.size() == 1) {
+            return this->requestOne(parts.begin()->second.first, request);
+        }
+
+        // connections open in parallel, every part is on the wire before the first answer is awaited
+        for (const auto &part : parts) {
+            std::lock_guard<std::mutex> guard(part.second.first->connectSync);
+            this->beginConnect(*part.second.first);
+        }
+
+        std::vector<Ticket> tickets;
+        for (const auto &part : parts) {
+            nlohmann::json subset = nlohmann::json::array();
+            for (size_t position : part.second.second) {
+                subset.push_back(items[position]);
+            }
+
+            nlohmann::json partRequest = request;
+            partRequest[field] = std::move(subset);
+            tickets.push_back(this->sendTo(part.second.first, partRequest));
+        }
+
+        nlohmann::json values = nlohmann::json::array();
+        nlohmann::json failure;
+        size_t index = 0;
+        for (const auto &part : parts) {
+            const auto &shard = part.second.first;
+            Ticket &ticket = tickets[index++];
+            const nlohmann::json answer = ticket.id != 0 ? this->receiveFrom(ticket) : error_answer("cannot connect to " + shard->id);
+            if (answer.value(JSON::KEY::STATUS, string()) != JSON::VALUE::STATUS_OK) {
+                // the other servers may have applied their part of an mput
+                if (failure.is_null()) {
+                    failure = answer;
+                    failure[JSON::KEY::SHARD] = shard->id;
+                }
+                continue;
+            }
+
+            if (field == JSON::KEY::KEYS) {
+                if (values.empty()) {
+                    values = nlohmann::json::array();
+                    for (size_t i = 0; i < items.size(); i++) {
+                        values.push_back(nullptr);
+                    }
+                }
+
+                const auto &partValues = answer[JSON::KEY::VALUES];
+                for (size_t i = 0; i < part.second.second.size() && i < partValues.size(); i++) {
+                    values[part.second.second[i]] = partValues[i];
+                }
+            }
+        }
+
+        if (!failure.is_null()) {
+            return failure;
+        }
+
+        nlohmann::json answer;
+        answer[JSON::KEY::STATUS] = JSON::VALUE::STATUS_OK;
+        if (field == JSON::KEY::KEYS) {
+            answer[JSON::KEY::VALUES] = std::move(values);
+        }
+        return answer;
+    }
+
+    nlohmann::json StorageClient::requestAll(const nlohmann::json &request) {
+        const auto shards = this->allShards();
+        if (shards.size() <= 1) {
+            return this->requestOne(shards.empty() ? nullptr : shards.front(), request);
+        }
+
+        for (const auto &shard : shards) {
+            std::lock_guard<std::mutex> guard(shard->connectSync);
+            this->beginConnect(*shard);
+        }
+
+        std::vector<Ticket> tickets;
+        for (const auto &shard : shards) {
+            tickets.push_back(this->sendTo(shard, request));
+        }
+
+        nlohmann::json answers = nlohmann::json::object();
+        for (size_t i = 0; i < shards.size(); i++) {
+            answers[shards[i]->id] = tickets[i].id != 0 ? this->receiveFrom(tickets[i]) : error_answer("cannot connect to " + shards[i]->id);
+        }
+
+        nlohmann::json answer;
+        answer[JSON::KEY::STATUS] = JSON::VALUE::STATUS_OK;
+        answer[JSON::KEY::SHARDS] = std::move(answers);
+        return answer;
+    }
+
+    nlohmann::json StorageClient::request(const nlohmann::json &request) {
+        try {
+            const string name = request.value(JSON::KEY::REQUEST, string());
+            if (name == JSON::VALUE::REQUEST_MGET && request.contains(JSON::KEY::KEYS)) {
+                return this->requestSplit(request, JSON::KEY::KEYS);
+            }
+
+            if (name == JSON::VALUE::REQUEST_MPUT && request.contains(JSON::KEY::ITEMS)) {
+                return this->requestSplit(request, JSON::KEY::ITEMS);
+            }
+
+            if (request.contains(JSON::KEY::KEY) && request[JSON::KEY::KEY].is_string()) {
+                return this->requestOne(this->shardOf(request[JSON::KEY::KEY].get<string>()), request);
+            }
+
+            return this->requestAll(request);
+        } catch (const nlohmann::json::exception &error) {
+            return error_answer(string("invalid request: ") + error.what());
+        }
+    }
+
+    std::vector<nlohmann::json> StorageClient::pipeline(const std::vector<nlohmann::json> &requests) {
+        std::vector<nlohmann::json> answers(requests.size());
+        std::vector<Ticket> tickets(requests.size());
+        size_t received = 0;///< answers before it are in
+        std::vector<size_t> ordered;///< tickets holding the orderSync of a base64 connection
+
+        const auto receive = [this, &answers, &tickets](size_t i) {
+            if (tickets[i].id != 0) {
+                answers[i] = this->receiveFrom(tickets[i]);
+                tickets[i].id = 0;
+            }
+        };
+
+        for (size_t i = 0; i < requests.size(); i++) {
+            const auto &request = requests[i];
+            const string name = request.is_object() ? request.value(JSON::KEY::REQUEST, string()) : string();
+            const bool keyed = request.is_object() && request.contains(JSON::KEY::KEY) && request[JSON::KEY::KEY].is_string() &&
+                               name != JSON::VALUE::REQUEST_MGET && name != JSON::VALUE::REQUEST_MPUT;
+            if (!keyed) {
+                for (; received < i; received++) {
+                    receive(received);
+                }
+                ordered.clear();
+                answers[i] = this->request(request);
+                continue;
+            }
+
+            const shard_pointer shard = this->shardOf(request[JSON::KEY::KEY].get_ref<const string &>());
+            if (shard == nullptr) {
+                answers[i] = error_answer("no servers");
+                continue;
+            }
+
+            // one base64 connection's turn at a time, taking a second one could wait on a caller waiting for ours
+            bool tagged;
+            {
+                std::lock_guard<std::mutex> guard(shard->sync);
+                tagged = shard->connected && !shard->linkDown && shard->tagged;
+            }
+            if (!tagged) {
+                for (size_t held : ordered) {
+                    receive(held);
+                }
+                ordered.clear();
+            }
+
+            try {
+                tickets[i] = this->sendTo(shard, request);
+            } catch (const nlohmann::json::exception &error) {
+                answers[i] = error_answer(string("invalid request: ") + error.what());
+                continue;
+            }
+
+            if (tickets[i].id == 0) {
+                answers[i] = error_answer("cannot connect to " + shard->id);
+            } else if (tickets[i].order.owns_lock()) {
+                ordered.push_back(i);
+            }
+        }
+
+        for (; received < requests.size(); received++) {
+            receive(received);
+        }
+        return answers;
+    }
+
+    nlohmann::json StorageClient::hotKeys(size_t limit) {
+        nlohmann::json request;
+        request[JSON::KEY::REQUEST] = JSON::VALUE::REQUEST_STATS;
+        const auto answer = this->request(request);
+
+        std::map<string, nlohmann::json> answers;
+        if (answer.contains(JSON::KEY::SHARDS)) {
+            for (const auto &shard : answer[JSON::KEY::SHARDS].items()) {
+                answers[shard.key()] = shard.value();
+            }
+        } else {
+            const auto endpoints = this->getEndpoints();
+            answers[endpoints.empty() ? string() : endpoints.front()] = answer;
+        }
+
+        std::vector<nlohmann::json> keys;
+        for (const auto &shard : answers) {
+            const auto &stats = shard.second.value(JSON::KEY::STATS, nlohmann::json::object());
+            if (!stats.contains("hot")) {
+                continue;
+            }
+
+            for (auto item : stats["hot"]["keys"]) {
+                item[JSON::KEY::SHARD] = shard.first;
+                keys.push_back(std::move(item));
+            }
+        }
+
+        // servers sample at their own rate, the scaled counts compare across them
+        std::stable_sort(keys.begin(), keys.end(), [](const nlohmann::json &left, const nlohmann::json &right) {
+            return left["accesses"].get<uint64_t>() > right["accesses"].get<uint64_t>();
+        });
+        if (keys.size() > limit) {
+            keys.resize(limit);
+        }
+        return nlohmann::json(keys);
+    }
+
+    void StorageClient::setEventHandler(const event_callback &handler) {
+        std::lock_guard<std::mutex> guard(this->eventSync);
+        this->onEvent = handler;
+    }
+
+    void StorageClient::deliverEvent(Shard &shard, const nlohmann::json &event) {
+        event_callback handler;
+        {
+            std::lock_guard<std::mutex> guard(this->eventSync);
+            handler = this->onEvent;
+        }
+
+        if (handler) {
+            handler(shard.id, event);
+        }
     }
 
     void StorageClient::send(const std::string& msg)
     {
-        this->tcpClient->send(msg);
+        nlohmann::json answer;
+        try {
+            answer = this->request(nlohmann::json::parse(msg));
+        } catch (const nlohmann::json::exception &error) {
+            answer = error_answer(string("request must be json: ") + error.what());
+        }
+
+        std::lock_guard<std::mutex> guard(this->answerSync);
+        this->answer = answer.dump();
     }
 
     string StorageClient::getAnswer() const
     {
+        std::lock_guard<std::mutex> guard(this->answerSync);
         return this->answer;
     }
 
-    void StorageClient::handle_connection_timed_oud(tcp::endpoint &endpoint) {
-        this->logger->LogInfo("client | connection time out");
+    void StorageClient::handle_connection_timed_oud(Shard *shard, tcp::endpoint &endpoint) {
+        this->logger->LogInfo("client | connection to " + shard->id + " timed out");
+        {
+            std::lock_guard<std::mutex> guard(shard->sync);
+            shard->linkDown = true;
+        }
+        shard->wake.notify_all();
     }
 
-    void StorageClient::handle_connection_error(tcp::endpoint &endpoint, const boost::system::error_code &ec) {
-        this->logger->LogInfo("client | connection error: " + ec.message());
+    void StorageClient::handle_connection_error(Shard *shard, tcp::endpoint &endpoint, const boost::system::error_code &ec) {
+        this->logger->LogInfo("client | connection to " + shard->id + " failed: " + ec.message());
+        {
+            std::lock_guard<std::mutex> guard(shard->sync);
+            shard->linkDown = true;
+        }
+        shard->wake.notify_all();
     }
 
-    void StorageClient::handle_connection_success(tcp::endpoint &endpoint) {
-        this->logger->LogInfo("client | connection success");
+    void StorageClient::handle_connection_success(Shard *shard, tcp::endpoint &endpoint) {
+        this->logger->LogInfo("client | connected to " + shard->id);
+        {
+            std::lock_guard<std::mutex> guard(shard->sync);
+            shard->connected = true;
+        }
+        shard->wake.notify_all();
     }
 
-    void StorageClient::handle_disconnected() {
-        this->logger->LogInfo("client | disconnected");
+    void StorageClient::handle_disconnected(Shard *shard) {
+        this->logger->LogInfo("client | disconnected from " + shard->id);
+        bool connected;
+        {
+            std::lock_guard<std::mutex> guard(shard->sync);
+            connected = shard->connected && !shard->linkDown;
+            shard->linkDown = true;
+        }
+        shard->wake.notify_all();
+        this->failCalls(*shard);
+
+        // the server dropped the connection's watches with it
+        if (connected) {
+            nlohmann::json event;
+            event[JSON::KEY::EVENT] = "disconnected";
+            this->deliverEvent(*shard, event);
+        }
     }
 
-    void StorageClient::handle_read_message(std::string msg) {
-        this->logger->LogInfo("client | new message read | msg: " + msg);
-        this->answer = msg;
+    void StorageClient::handle_read_message(Shard *shard, uint64_t requestId, std::string msg) {
+        if (this->logger->Enabled()) {
+            this->logger->LogDebug("client | new message read from " + shard->id + " | bytes: " + std::to_string(msg.size()));
+        }
+
+        nlohmann::json json;
+        try {
+            json = nlohmann::json::parse(msg);
+        } catch (const nlohmann::json::exception &) {
+            json = error_answer("server answer is not json: " + msg);
+        }
+
+        if (json.is_object() && json.contains(JSON::KEY::EVENT)) {
+            this->deliverEvent(*shard, json);
+            return;
+        }
+
+        // a scan streams messages with "final":false before the last one
+        const bool more = json.is_object() && json.contains(JSON::KEY::FINAL) && json[JSON::KEY::FINAL] == false;
+
+        std::lock_guard<std::mutex> guard(shard->sync);
+        // request id 0 - base64 framing, the only request in flight
+        const auto call = requestId != 0 ? shard->calls.find(requestId) : shard->calls.begin();
+        if (call == shard->calls.end() || call->second.complete) {
+            this->logger->LogInfo("client | answer from " + shard->id + " for no request in flight, request id " + std::to_string(requestId));
+            return;
+        }
+
+        call->second.messages.push_back(std::move(json));
+        if (!more) {
+            call->second.complete = true;
+            call->second.done.notify_all();
+        }
     }
 
-    void StorageClient::handle_read_error(const boost::system::error_code error, size_t bytes_transferred) {
-        this->logger->LogInfo("client | read error: " + error.message());
+    void StorageClient::handle_read_error(Shard *shard, const boost::system::error_code error, size_t bytes_transferred) {
+        this->logger->LogInfo("client | read error from " + shard->id + ": " + error.message());
+        {
+            std::lock_guard<std::mutex> guard(shard->sync);
+            shard->linkDown = true;
+        }
+        shard->wake.notify_all();
+        this->failCalls(*shard);
     }
 
-    void StorageClient::handle_send_error(const boost::system::error_code error, size_t bytes_transferred) {
-        this->logger->LogInfo("client | send error: " + error.message());
+    void StorageClient::handle_send_error(Shard *shard, const boost::system::error_code error, size_t bytes_transferred) {
+        this->logger->LogInfo("client | send error to " + shard->id + ": " + error.message());
+        {
+            std::lock_guard<std::mutex> guard(shard->sync);
+            shard->linkDown = true;
+        }
+        shard->wake.notify_all();
+        this->failCalls(*shard);
     }
-}// namespace Diginext::Core::Storage
\ No newline at end of file
+}// namespace Diginext::Core::Storage
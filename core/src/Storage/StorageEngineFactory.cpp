@@ -0,0 +1,41 @@
+#include "Storage/StorageEngineFactory.h"
+
+#include "Storage/LsmStorage.h"
+#include "Storage/MapStorageEngine.h"
+#include "Storage/ShardedHashStorage.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace Diginext::Core::Storage {
+
+    std::vector<std::string> storage_engine_names() {
+        return { "map", "hash", "lsm" };
+    }
+
+    bool storage_engine_exists(const std::string &name) {
+        const auto names = storage_engine_names();
+        return std::find(names.begin(), names.end(), name) != names.end();
+    }
+
+    StorageEngine::pointer create_storage_engine(const StorageOptions &options) {
+        if (options.engine == "map") {
+            return MapStorageEngine::create();
+        }
+
+        if (options.engine == "hash") {
+            auto storage = ShardedHashStorage::create();
+            storage->setMemoryLimit(options.maxMemory);
+            return storage;
+        }
+
+        if (options.engine == "lsm") {
+            LsmOptions lsmOptions;
+            lsmOptions.fsyncPolicy = options.fsyncPolicy;
+            lsmOptions.groupCommitWindow = options.groupCommitWindow;
+            return LsmStorage::create(options.dataDir, lsmOptions);
+        }
+
+        throw std::invalid_argument("unknown storage engine: " + options.engine);
+    }
+}// namespace Diginext::Core::Storage
@@ -0,0 +1,158 @@
+#include "Storage/StorageFile.h"
+
+#include <sys/stat.h>
+
+#ifdef _WIN32
+#include <direct.h>
+#include <io.h>
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace Diginext::Core::Storage {
+
+    bool file_exists(const std::string &path) {
+        struct stat info {};
+        return ::stat(path.c_str(), &info) == 0;
+    }
+
+    uint64_t file_size(const std::string &path) {
+        struct stat info {};
+        if (::stat(path.c_str(), &info) != 0) {
+            return 0;
+        }
+
+        return static_cast<uint64_t>(info.st_size);
+    }
+
+    bool file_truncate(const std::string &path, uint64_t size) {
+#ifdef _WIN32
+        FILE *file = std::fopen(path.c_str(), "r+b");
+        if (file == nullptr) {
+            return false;
+        }
+
+        const bool result = _chsize_s(_fileno(file), static_cast<__int64>(size)) == 0;
+        std::fclose(file);
+        return result;
+#else
+        return ::truncate(path.c_str(), static_cast<off_t>(size)) == 0;
+#endif
+    }
+
+    bool file_sync(FILE *file) {
+        if (std::fflush(file) != 0) {
+            return false;
+        }
+
+#ifdef _WIN32
+        return _commit(_fileno(file)) == 0;
+#elif defined(__APPLE__)
+        return ::fsync(fileno(file)) == 0;
+#else
+        return ::fdatasync(fileno(file)) == 0;
+#endif
+    }
+
+    bool file_replace(const std::string &source, const std::string &target) {
+#ifdef _WIN32
+        return MoveFileExA(source.c_str(), target.c_str(), MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != 0;
+#else
+        return std::rename(source.c_str(), target.c_str()) == 0;
+#endif
+    }
+
+    void file_remove(const std::string &path) {
+        std::remove(path.c_str());
+    }
+
+    bool directory_create(const std::string &path) {
+#ifdef _WIN32
+        _mkdir(path.c_str());
+#else
+        ::mkdir(path.c_str(), 0755);
+#endif
+        struct stat info {};
+        return ::stat(path.c_str(), &info) == 0 && (info.st_mode & S_IFDIR) != 0;
+    }
+
+    RandomAccessFile::pointer RandomAccessFile::open(const std::string &path) {
+        auto file = std::make_shared<RandomAccessFile>(path);
+#ifdef _WIN32
+        if (file->handle == nullptr) {
+            return nullptr;
+        }
+#else
+        if (file->fd < 0) {
+            return nullptr;
+        }
+#endif
+        return file;
+    }
+
+    RandomAccessFile::RandomAccessFile(const std::string &path) {
+        this->path = path;
+        this->size = file_size(path);
+#ifdef _WIN32
+        HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE, nullptr,
+                                  OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_RANDOM_ACCESS, nullptr);
+        this->handle = file == INVALID_HANDLE_VALUE ? nullptr : file;
+#else
+        this->fd = ::open(path.c_str(), O_RDONLY);
+#endif
+    }
+
+    RandomAccessFile::~RandomAccessFile() {
+#ifdef _WIN32
+        if (this->handle != nullptr) {
+            CloseHandle(static_cast<HANDLE>(this->handle));
+        }
+#else
+        if (this->fd >= 0) {
+            ::close(this->fd);
+        }
+#endif
+    }
+
+    bool RandomAccessFile::read(uint64_t offset, size_t size, std::string &out) const {
+        this->reads.fetch_add(1, std::memory_order_relaxed);
+        out.resize(size);
+
+        size_t done = 0;
+        while (done < size) {
+#ifdef _WIN32
+            OVERLAPPED overlapped {};
+            const uint64_t position = offset + done;
+            overlapped.Offset = static_cast<DWORD>(position);
+            overlapped.OffsetHigh = static_cast<DWORD>(position >> 32);
+
+            DWORD read = 0;
+            if (!ReadFile(static_cast<HANDLE>(this->handle), &out[done], static_cast<DWORD>(size - done), &read, &overlapped) || read == 0) {
+                return false;
+            }
+#else
+            const ssize_t read = ::pread(this->fd, &out[done], size - done, static_cast<off_t>(offset + done));
+            if (read <= 0) {
+                return false;
+            }
+#endif
+            done += static_cast<size_t>(read);
+        }
+
+        return true;
+    }
+
+    uint64_t RandomAccessFile::getReads() const {
+        return this->reads.load(std::memory_order_relaxed);
+    }
+
+    uint64_t RandomAccessFile::getSize() const {
+        return this->size;
+    }
+
+    std::string RandomAccessFile::getPath() const {
+        return this->path;
+    }
+}// namespace Diginext::Core::Storage
@@ -0,0 +1,38 @@
+#include "Storage/StorageMemory.h"
+
+#include <cctype>
+
+namespace Diginext::Core::Storage {
+
+    bool memory_size_from_string(const string &text, size_t &bytes) {
+        size_t position = 0;
+        unsigned long long value = 0;
+        while (position < text.size() && std::isdigit(static_cast<unsigned char>(text[position]))) {
+            value = value * 10 + static_cast<unsigned long long>(text[position] - '0');
+            position++;
+        }
+
+        if (position == 0) {
+            return false;
+        }
+
+        string suffix;
+        for (; position < text.size(); position++) {
+            suffix += static_cast<char>(std::tolower(static_cast<unsigned char>(text[position])));
+        }
+
+        unsigned shift = 0;
+        if (suffix == "k" || suffix == "kb") {
+            shift = 10;
+        } else if (suffix == "m" || suffix == "mb") {
+            shift = 20;
+        } else if (suffix == "g" || suffix == "gb") {
+            shift = 30;
+        } else if (!suffix.empty() && suffix != "b") {
+            return false;
+        }
+
+        bytes = static_cast<size_t>(value << shift);
+        return true;
+    }
+}// namespace Diginext::Core::Storage
@@ -0,0 +1,295 @@
+#include "Storage/StorageReplica.h"
+
+#include "Log/LogConsole.h"
+
+#include <chrono>
+
+namespace Diginext::Core::Storage {
+    using namespace std::chrono_literals;
+
+    // pause between connection attempts
+    const auto RECONNECT_DELAY = 1s;
+
+    string replica_state_to_string(StorageReplica::State state) {
+        switch (state) {
+            case StorageReplica::State::Connecting:
+                return "connecting";
+            case StorageReplica::State::Syncing:
+                return "syncing";
+            case StorageReplica::State::Online:
+                return "online";
+        }
+
+        return "unknown";
+    }
+
+    StorageReplica::pointer StorageReplica::create(StorageEngine::pointer storage, const string &host, unsigned short port, tcp_framing framing) {
+        return std::make_shared<StorageReplica>(storage, host, port, framing);
+    }
+
+    StorageReplica::StorageReplica(StorageEngine::pointer storage, const string &host, unsigned short port, tcp_framing framing) {
+        this->logger = ConsoleLogger::create("StorageReplica");
+        this->storage = storage;
+        this->host = host;
+        this->port = port;
+        this->framing = framing;
+        this->stopping = false;
+        this->linkDown = false;
+        this->position = 0;
+        this->leaderPosition = 0;
+        this->fullSyncs = 0;
+        this->partialSyncs = 0;
+        this->state = State::Connecting;
+    }
+
+    StorageReplica::~StorageReplica() {
+        try {
+            this->stop();
+        } catch (...) {
+        }
+    }
+
+    void StorageReplica::setDeadlineHandler(const deadline_callback &handler) {
+        this->deadlineHandler = handler;
+    }
+
+    void StorageReplica::start() {
+        if (this->worker.joinable()) {
+            return;
+        }
+
+        this->stopping = false;
+        this->worker = std::thread(&StorageReplica::run, this);
+    }
+
+    void StorageReplica::stop() {
+        {
+            std::lock_guard<std::mutex> guard(this->sync);
+            this->stopping = true;
+        }
+        this->wake.notify_all();
+
+        if (this->worker.joinable()) {
+            this->worker.join();
+        }
+    }
+
+    void StorageReplica::run() {
+        const auto endpoint = tcp::endpoint(boost::asio::ip::address::from_string(this->host), this->port);
+
+        for (;;) {
+            {
+                std::lock_guard<std::mutex> guard(this->sync);
+                if (this->stopping) {
+                    return;
+                }
+                this->linkDown = false;
+            }
+
+            // a fresh client per attempt, a stopped io service does not run again
+            this->state = State::Connecting;
+            this->client = tcp_client::create();
+            this->client->setFraming(this->framing);
+            this->client->onConnectionTimedOut.connect(boost::bind(&StorageReplica::handle_connection_timed_out, this, _1));
+            this->client->onConnectionError.connect(boost::bind(&StorageReplica::handle_connection_error, this, _1, _2));
+            this->client->onConnectionSuccess.connect(boost::bind(&StorageReplica::handle_connection_success, this, _1));
+            this->client->onDisconnected.connect(boost::bind(&StorageReplica::handle_disconnected, this));
+            this->client->onReadMessage.connect(boost::bind(&StorageReplica::handle_read_message, this, _1));
+            this->client->onReadError.connect(boost::bind(&StorageReplica::handle_read_error, this, _1, _2));
+
+            auto target = endpoint;
+            this->client->connect(target);
+            this->client->start();
+
+            {
+                std::unique_lock<std::mutex> lock(this->sync);
+                this->wake.wait(lock, [this]() { return this->stopping || this->linkDown; });
+            }
+
+            this->client->stop();
+            this->client.reset();
+            this->stale.clear();
+
+            std::unique_lock<std::mutex> lock(this->sync);
+            this->wake.wait_for(lock, RECONNECT_DELAY, [this]() { return this->stopping; });
+        }
+    }
+
+    void StorageReplica::setLinkDown() {
+        {
+            std::lock_guard<std::mutex> guard(this->sync);
+            this->linkDown = true;
+        }
+        this->wake.notify_all();
+    }
+
+    void StorageReplica::applyRecords(const nlohmann::json &json) {
+        // consecutive writes go to the engine as one batch
+        StorageEngine::record_batch batch;
+        deadline_batch deadlines;
+        for (const auto &record : json[JSON::KEY::RECORDS]) {
+            const string key = record[JSON::KEY::KEY].get<string>();
+            if (record.contains(JSON::KEY::VALUE)) {
+                batch.emplace_back(key, record[JSON::KEY::VALUE].get<string>());
+                continue;
+            }
+
+            // a deadline leaves the value as it is
+            if (record.contains(JSON::KEY::EXPIRE_AT)) {
+                deadlines.emplace_back(key, record[JSON::KEY::EXPIRE_AT].get<uint64_t>());
+                continue;
+            }
+
+            if (!batch.empty()) {
+                this->storage->multiPut(batch);
+                batch.clear();
+            }
+            this->storage->remove(key);
+            deadlines.emplace_back(key, 0);
+        }
+
+        if (!batch.empty()) {
+            this->storage->multiPut(batch);
+        }
+
+        if (!deadlines.empty() && this->deadlineHandler != nullptr) {
+            this->deadlineHandler(std::move(deadlines));
+        }
+
+        this->position = json[JSON::KEY::POSITION].get<uint64_t>();
+        this->leaderPosition = json[JSON::KEY::HEAD].get<uint64_t>();
+    }
+
+    uint64_t StorageReplica::getPosition() const {
+        return this->position;
+    }
+
+    uint64_t StorageReplica::getLeaderPosition() const {
+        return this->leaderPosition;
+    }
+
+    uint64_t StorageReplica::getFullSyncs() const {
+        return this->fullSyncs;
+    }
+
+    uint64_t StorageReplica::getPartialSyncs() const {
+        return this->partialSyncs;
+    }
+
+    StorageReplica::State StorageReplica::getState() const {
+        return this->state;
+    }
+
+    string StorageReplica::getLeader() const {
+        return this->host + ":" + std::to_string(this->port);
+    }
+
+    void StorageReplica::handle_connection_timed_out(tcp::endpoint &endpoint) {
+        this->logger->LogInfo("replica | connection to leader timed out");
+        this->setLinkDown();
+    }
+
+    void StorageReplica::handle_connection_error(tcp::endpoint &endpoint, const boost::system::error_code &ec) {
+        this->logger->LogInfo("replica | connection to leader failed: " + ec.message());
+        this->setLinkDown();
+    }
+
+    void StorageReplica::handle_connection_success(tcp::endpoint &endpoint) {
+        this->logger->LogInfo("replica | connected to leader " + this->getLeader() + ", resuming after position " +
+                              std::to_string(this->position.load()));
+
+        nlohmann::json request;
+        request[JSON::KEY::REQUEST] = JSON::VALUE::REQUEST_REPLICATE;
+        request[JSON::KEY::REPLICATION_ID] = this->replicationId;
+        request[JSON::KEY::POSITION] = this->position.load();
+        this->client->send(request.dump());
+    }
+
+    void StorageReplica::handle_disconnected() {
+        this->logger->LogInfo("replica | disconnected from leader");
+        this->setLinkDown();
+    }
+
+    void StorageReplica::handle_read_message(std::string msg) {
+        try {
+            const nlohmann::json json = nlohmann::json::parse(msg);
+            if (json.contains(JSON::KEY::STATUS) && json[JSON::KEY::STATUS] != JSON::VALUE::STATUS_OK) {
+                this->logger->LogError("replica | leader refused: " + json.value(JSON::KEY::DESCRIPTION, string()));
+                this->setLinkDown();
+                return;
+            }
+
+            const string type = json[JSON::KEY::REPLICATION].get<string>();
+            if (type == JSON::VALUE::REPLICATION_RECORDS) {
+                this->applyRecords(json);
+
+                // the leader keeps a bounded window in flight, the ack opens it again
+                nlohmann::json ack;
+                ack[JSON::KEY::REQUEST] = JSON::VALUE::REQUEST_REPLICATE_ACK;
+                ack[JSON::KEY::POSITION] = this->position.load();
+                this->client->send(ack.dump());
+                return;
+            }
+
+            if (type == JSON::VALUE::REPLICATION_ITEMS) {
+                // every item sets its deadline, a key without one may still have an old local one
+                deadline_batch deadlines;
+                for (const auto &item : json[JSON::KEY::ITEMS]) {
+                    const string key = item[JSON::KEY::KEY].get<string>();
+                    this->storage->put(key, item[JSON::KEY::VALUE].get<string>());
+                    this->stale.erase(key);
+                    deadlines.emplace_back(key, item.value(JSON::KEY::EXPIRE_AT, uint64_t(0)));
+                }
+
+                if (this->deadlineHandler != nullptr) {
+                    this->deadlineHandler(std::move(deadlines));
+                }
+                return;
+            }
+
+            if (type == JSON::VALUE::REPLICATION_SYNCED) {
+                // keys the leader no longer has
+                deadline_batch deadlines;
+                for (const auto &key : this->stale) {
+                    this->storage->remove(key);
+                    deadlines.emplace_back(key, 0);
+                }
+                this->stale.clear();
+
+                if (!deadlines.empty() && this->deadlineHandler != nullptr) {
+                    this->deadlineHandler(std::move(deadlines));
+                }
+
+                this->position = json[JSON::KEY::POSITION].get<uint64_t>();
+                this->leaderPosition = this->position.load();
+                this->state = State::Online;
+                this->fullSyncs++;
+                this->logger->LogInfo("replica | full sync done at position " + std::to_string(this->position.load()));
+                return;
+            }
+
+            if (type == JSON::VALUE::REPLICATION_PARTIAL) {
+                this->state = State::Online;
+                this->partialSyncs++;
+                this->logger->LogInfo("replica | resumed at position " + std::to_string(this->position.load()));
+                return;
+            }
+
+            if (type == JSON::VALUE::REPLICATION_FULL) {
+                this->state = State::Syncing;
+                this->replicationId = json[JSON::KEY::REPLICATION_ID].get<string>();
+                this->stale.clear();
+                this->storage->forEach([this](string_view key, string_view) { this->stale.emplace(key); });
+                this->logger->LogInfo("replica | full sync from leader log " + this->replicationId);
+            }
+        } catch (...) {
+            this->logger->LogError("replica | malformed message from leader");
+            this->setLinkDown();
+        }
+    }
+
+    void StorageReplica::handle_read_error(const boost::system::error_code error, size_t bytes_transferred) {
+        this->logger->LogInfo("replica | read error: " + error.message());
+        this->setLinkDown();
+    }
+}// namespace Diginext::Core::Storage
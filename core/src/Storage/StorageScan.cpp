@@ -0,0 +1,78 @@
+#include "Storage/StorageScan.h"
+
+#include "Base64/Base64.h"
+#include "Storage/StorageCommon.h"
+
+#include <nlohmann/json.hpp>
+
+namespace Diginext::Core::Storage {
+
+    string scan_prefix_end(const string &prefix) {
+        string end = prefix;
+        while (!end.empty()) {
+            const auto last = static_cast<unsigned char>(end.back());
+            if (last != 0xff) {
+                end.back() = static_cast<char>(last + 1);
+                return end;
+            }
+
+            // carry: "a\xff" -> "b"
+            end.pop_back();
+        }
+
+        return end;
+    }
+
+    size_t scan_chunks(const StorageEngine &engine, const ScanRequest &request, const scan_chunk_callback &emit) {
+        nlohmann::json items = nlohmann::json::array();
+        size_t bytes = 0;
+        size_t count = 0;
+        string last;
+        bool more = false;
+
+        const auto chunk = [&items](bool final) {
+            nlohmann::json json;
+            json[JSON::KEY::STATUS] = JSON::VALUE::STATUS_OK;
+            json[JSON::KEY::ITEMS] = std::move(items);
+            json[JSON::KEY::FINAL] = final;
+            items = nlohmann::json::array();
+            return json;
+        };
+
+        engine.scan(request.start, request.end, [&](string_view key, string_view value) {
+            if (request.skip && request.skip(key)) {
+                return true;
+            }
+
+            // one key past the limit only tells that the range is not exhausted
+            if (count == request.limit) {
+                more = true;
+                return false;
+            }
+
+            // a full chunk is sent once the next item shows it is not the final one
+            if (items.size() == SCAN_CHUNK_ITEMS || bytes >= SCAN_CHUNK_BYTES) {
+                emit(chunk(false).dump());
+                bytes = 0;
+            }
+
+            nlohmann::json item;
+            item[JSON::KEY::KEY] = key;
+            item[JSON::KEY::VALUE] = value;
+            items.push_back(std::move(item));
+
+            bytes += key.size() + value.size();
+            last.assign(key.data(), key.size());
+            count++;
+            return true;
+        });
+
+        nlohmann::json json = chunk(true);
+        if (more) {
+            json[JSON::KEY::CURSOR] = Base64::Encode(last);
+        }
+        emit(json.dump());
+
+        return count;
+    }
+}// namespace Diginext::Core::Storage
@@ -1,24 +1,175 @@
 #include "Storage/StorageServer.h"
 
+#include "Base64/Base64.h"
 #include "Log/LogConsole.h"
+#include "Storage/StorageEngineFactory.h"
+#include "Storage/StorageFile.h"
+#include "Storage/StorageScan.h"
 
+#include <algorithm>
+#include <charconv>
 #include <chrono>
+#include <cstdio>
+#include <limits>
+#include <stdexcept>
 
 #include <nlohmann/json.hpp>
 
 namespace Diginext::Core::Storage {
     using namespace std::chrono_literals;
 
-    StorageServer::pointer StorageServer::create(const string &host, const unsigned short port) {
-        return std::make_shared<StorageServer>(host, port);
+    // expired keys reclaimed per timer run, the rest wait for the next run
+    const size_t EXPIRY_BATCH = 1000;
+
+    // keys or pairs in one mget / mput request
+    const size_t MAX_BATCH_SIZE = 10000;
+
+    // how often subscribers that overflowed are checked for a drained queue
+    const auto WATCH_FLUSH_INTERVAL = 50ms;
+
+    // records sent to a follower and not acknowledged yet
+    const uint64_t REPLICATION_WINDOW = 16384;
+
+    // records or full sync items per replication message
+    const size_t REPLICATION_CHUNK_RECORDS = 256;
+    const size_t REPLICATION_CHUNK_BYTES = 64 * 1024;
+
+    // EXPIRE seconds that still fit in milliseconds
+    const int64_t MAX_RESP_EXPIRE_SECONDS = std::numeric_limits<int64_t>::max() / 1000;
+
+    // key deadlines next to a snapshot, and in the data directory of an engine with its own log
+    const string SNAPSHOT_DEADLINES_SUFFIX = ".deadlines";
+    const string DEADLINE_LOG_NAME = "deadlines.log";
+
+    /**
+     * @brief strict decimal integer, no spaces or plus sign
+     */
+    static bool parse_int64(string_view text, int64_t &value) {
+        if (text.empty()) {
+            return false;
+        }
+
+        const auto result = std::from_chars(text.data(), text.data() + text.size(), value);
+        return result.ec == std::errc() && result.ptr == text.data() + text.size();
+    }
+
+    /**
+     * @brief RESP argument equal to lower in any letter case, e.g. an option name
+     */
+    static bool resp_is(string_view argument, string_view lower) {
+        if (argument.size() != lower.size()) {
+            return false;
+        }
+
+        for (size_t i = 0; i < argument.size(); i++) {
+            const char c = argument[i];
+            if ((c >= 'A' && c <= 'Z' ? static_cast<char>(c - 'A' + 'a') : c) != lower[i]) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    /**
+     * @brief value of an Expire record: wall-clock milliseconds in decimal, empty - no deadline
+     */
+    static string format_deadline(uint64_t at) {
+        return at != 0 ? std::to_string(at) : string();
+    }
+
+    static uint64_t parse_deadline(const string &logged) {
+        uint64_t at = 0;
+        std::from_chars(logged.data(), logged.data() + logged.size(), at);
+        return at;
+    }
+
+    /**
+     * @brief every deadline as an Expire record, the content of a deadline file
+     */
+    static string encode_deadlines(const KeyExpiry &expiry) {
+        string records;
+        expiry.forEach([&records](const string &key, uint64_t at) {
+            WriteAheadLog::encode(records, WalRecordType::Expire, key, format_deadline(at));
+        });
+        return records;
+    }
+
+    /**
+     * @brief write a deadline file, atomically replaces path
+     */
+    static bool save_deadlines(const string &path, const string &records) {
+        const string tempPath = path + ".tmp";
+        FILE *file = std::fopen(tempPath.c_str(), "wb");
+        if (file == nullptr) {
+            return false;
+        }
+
+        bool success = std::fwrite(records.data(), 1, records.size(), file) == records.size();
+        success = file_sync(file) && success;
+        success = std::fclose(file) == 0 && success;
+        if (!success || !file_replace(tempPath, path)) {
+            file_remove(tempPath);
+            return false;
+        }
+        return true;
+    }
+
+    static void set_error(nlohmann::json &answer, const string &description) {
+        answer[JSON::KEY::STATUS] = JSON::VALUE::STATUS_ERROR;
+        answer[JSON::KEY::DESCRIPTION] = description;
+    }
+
+    /**
+     * @brief requests a follower refuses, its data changes only through the leader's stream
+     */
+    static bool is_write_request(const string &request) {
+        return request == JSON::VALUE::REQUEST_WRITE || request == JSON::VALUE::REQUEST_MPUT || request == JSON::VALUE::REQUEST_INCR ||
+               request == JSON::VALUE::REQUEST_DECR || request == JSON::VALUE::REQUEST_CAS || request == JSON::VALUE::REQUEST_APPEND ||
+               request == JSON::VALUE::REQUEST_EXPIRE || request == JSON::VALUE::REQUEST_PERSIST || request == JSON::VALUE::REQUEST_BEGIN ||
+               request == JSON::VALUE::REQUEST_COMMIT || request == JSON::VALUE::REQUEST_ABORT;
+    }
+
+    StorageServer::pointer StorageServer::create(const string &host, const unsigned short port, const StorageOptions &options) {
+        return std::make_shared<StorageServer>(host, port, options);
     }
 
-    StorageServer::StorageServer(const string &host, const unsigned short port) {
+    StorageServer::StorageServer(const string &host, const unsigned short port, const StorageOptions &options) {
         this->logger = ConsoleLogger::create("StorageServer");
+        this->options = options;
+        this->snapshotRunning = false;
+        this->readHits = 0;
+        this->readMisses = 0;
+        this->expiredKeys = 0;
+        this->nextTransaction = 1;
+        this->replicationFlushPending = false;
+        this->watches = std::make_unique<WatchRegistry>(options.watchQueueLimit, options.watchOverflow);
+        this->watchFlushPending = false;
+        this->requestId = 0;
+        this->respSession = nullptr;
+        this->respConnection = nullptr;
+        this->hotKeys = std::make_unique<HotKeyTracker>(options.hotKeys, options.hotKeySample);
+        this->dataStorage = create_storage_engine(options);
+
+        if (!options.raftId.empty()) {
+            // the state machine is rebuilt from the raft log on start, an engine with its own log would apply it twice
+            if (this->dataStorage->persistent()) {
+                throw std::invalid_argument("raft mode needs an in-memory engine, " + options.engine + " keeps its own log");
+            }
+
+            if (!options.replicaOfHost.empty()) {
+                throw std::invalid_argument("a raft node cannot be a replica");
+            }
+
+            // raft routes requests as JSON, a RESP command has no such form
+            if (options.respPort != 0) {
+                throw std::invalid_argument("a raft node cannot serve RESP");
+            }
+        }
 
         auto ip = boost::asio::ip::address::from_string(host);
         auto endpoint = tcp::endpoint(ip, port);
         this->tcpServer = tcp_server::create(endpoint);
+        this->tcpServer->setFraming(options.acceptFraming);
 
         this->tcpServer->onAccepted.connect(boost::bind(&StorageServer::handle_accept, this, _1));
         this->tcpServer->onAcceptError.connect(boost::bind(&StorageServer::handle_accept_error, this, _1, _2));
@@ -26,159 +177,2275 @@ namespace Diginext::Core::Storage {
         this->tcpServer->onReadMessage.connect(boost::bind(&StorageServer::handle_read_message, this, _1, _2));
         this->tcpServer->onReadError.connect(boost::bind(&StorageServer::handle_read_error, this, _1, _2, _3));
         this->tcpServer->onSendError.connect(boost::bind(&StorageServer::handle_send_error, this, _1, _2, _3));
+
+        if (options.respPort != 0) {
+            // same io thread: commands of both protocols are served one at a time, no locking between them
+            auto respEndpoint = tcp::endpoint(ip, options.respPort);
+            this->respServer = tcp_server::create(respEndpoint, this->tcpServer->getIoService());
+            this->respServer->setFraming(tcp_framing::Raw);
+
+            this->respServer->onAccepted.connect(boost::bind(&StorageServer::handle_resp_accept, this, _1));
+            this->respServer->onAcceptError.connect(boost::bind(&StorageServer::handle_accept_error, this, _1, _2));
+            this->respServer->onDisconnected.connect(boost::bind(&StorageServer::handle_resp_disconnect, this, _1));
+            this->respServer->onReadMessage.connect(boost::bind(&StorageServer::handle_resp_message, this, _1, _2));
+            this->respServer->onReadError.connect(boost::bind(&StorageServer::handle_read_error, this, _1, _2, _3));
+            this->respServer->onSendError.connect(boost::bind(&StorageServer::handle_send_error, this, _1, _2, _3));
+        }
     }
 
     StorageServer::~StorageServer() {
-    }
+        try {
+            if (this->replica != nullptr) {
+                this->replica->stop();
+            }
+        } catch (...) {
+        }
+
+        try {
+            // the expiry timer handler runs on the server thread, stop it before the timer goes
+            this->tcpServer->stop();
+        } catch (...) {
+        }
+
+        try {
+            // the io thread is gone, its connections are closed from here
+            if (this->respServer != nullptr) {
+                this->respServer->stop();
+            }
+        } catch (...) {
+        }
 
-    bool StorageServer::keyExists(string key) {
-        std::lock_guard<std::mutex> guard(this->dataSync);
-        return this->dataStorage.find(key) != this->dataStorage.end();
+        if (this->snapshotThread.joinable()) {
+            this->snapshotThread.join();
+        }
+
+        try {
+            if (this->wal != nullptr) {
+                this->wal->close();
+            }
+        } catch (...) {
+        }
     }
 
-    string StorageServer::readValue(string key) {
-        std::lock_guard<std::mutex> guard(this->dataSync);
-        if (this->dataStorage.find(key) != this->dataStorage.end()) {
-            return this->dataStorage[key];
+    void StorageServer::openWriteAheadLog() {
+        if (this->options.walPath.empty() || this->wal != nullptr) {
+            return;
+        }
+
+        if (this->dataStorage->persistent()) {
+            this->logger->LogWarning("... wal: ignored, " + this->options.engine + " engine keeps its own log");
+            return;
+        }
+
+        if (!this->options.replicaOfHost.empty()) {
+            this->logger->LogWarning("... wal: ignored, a replica gets its data from the leader");
+            return;
+        }
+
+        if (!this->options.raftId.empty()) {
+            this->logger->LogWarning("... wal: ignored, the raft log keeps the writes");
+            return;
+        }
+
+        this->wal = WriteAheadLog::create(this->options.walPath, this->options.fsyncPolicy, this->options.groupCommitWindow);
+
+        // records before the snapshot position are already in the snapshot
+        uint64_t fromOffset = 0;
+        const auto hashStorage = std::dynamic_pointer_cast<ShardedHashStorage>(this->dataStorage);
+        const auto snapshot = hashStorage != nullptr ? hashStorage->getBase() : nullptr;
+        if (snapshot != nullptr) {
+            fromOffset = snapshot->getWalOffset();
+            if (fromOffset > file_size(this->options.walPath)) {
+                this->logger->LogWarning("... wal is shorter than snapshot position, replaying it from start");
+                fromOffset = 0;
+            }
         }
 
-        return std::string();
+        const auto start = std::chrono::steady_clock::now();
+        const size_t count = this->wal->replay([this](const WalRecord &record) {
+            if (record.type == WalRecordType::Put) {
+                this->dataStorage->put(record.key, record.value);
+            } else if (record.type == WalRecordType::Remove) {
+                this->dataStorage->remove(record.key);
+                this->expiry.persist(record.key);
+            } else if (record.type == WalRecordType::Expire) {
+                this->restoreDeadline(record.key, record.value);
+            }
+        }, fromOffset);
+        const auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+
+        this->wal->open();
+        this->logger->LogInfo("... wal: " + this->options.walPath + " | fsync: " + fsync_policy_to_string(this->options.fsyncPolicy) +
+                              " | replayed " + std::to_string(count) + " records in " + std::to_string(elapsed.count()) + " ms");
     }
 
-    void StorageServer::writeValue(string key, string value) {
-        std::lock_guard<std::mutex> guard(this->dataSync);
-        this->dataStorage[key] = value;
+    void StorageServer::openSnapshot() {
+        if (this->options.snapshotPath.empty()) {
+            return;
+        }
+
+        const auto hashStorage = std::dynamic_pointer_cast<ShardedHashStorage>(this->dataStorage);
+        if (hashStorage == nullptr) {
+            this->logger->LogWarning("... snapshot: ignored, supported by hash engine only");
+            return;
+        }
+
+        if (!this->options.raftId.empty()) {
+            this->logger->LogWarning("... snapshot: ignored, the raft log is replayed from the start");
+            return;
+        }
+
+        if (hashStorage->getBase() != nullptr) {
+            return;
+        }
+
+        const auto start = std::chrono::steady_clock::now();
+        const auto snapshot = SnapshotFile::open(this->options.snapshotPath);
+        if (snapshot == nullptr) {
+            this->logger->LogInfo("... snapshot: " + this->options.snapshotPath + " | not found or invalid, starting empty");
+            return;
+        }
+
+        hashStorage->attachBase(snapshot);
+        const size_t deadlines = this->loadDeadlines(this->options.snapshotPath + SNAPSHOT_DEADLINES_SUFFIX);
+        const auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+        this->logger->LogInfo("... snapshot: " + this->options.snapshotPath + " | mapped " + std::to_string(snapshot->getCount()) +
+                              " keys, " + std::to_string(deadlines) + " deadlines in " + std::to_string(elapsed.count()) + " us");
     }
 
-    bool StorageServer::Started() const {
-        try {
-            if (this->tcpServer != nullptr) {
-                return this->tcpServer->started();
-            }
-        } catch (...) {
+    void StorageServer::openDeadlineLog() {
+        // a replica gets its deadlines from the leader, an in-memory engine logs them to the write-ahead log
+        if (!this->dataStorage->persistent() || !this->options.replicaOfHost.empty() || this->deadlineLog != nullptr) {
+            return;
         }
 
-        return false;
+        const string path = this->options.dataDir + "/" + DEADLINE_LOG_NAME;
+        const size_t count = this->loadDeadlines(path);
+
+        // every ttl write adds a record, only the live deadlines are kept over a restart
+        if (count != this->expiry.size() && !save_deadlines(path, encode_deadlines(this->expiry))) {
+            throw std::runtime_error("cannot write " + path);
+        }
+
+        this->deadlineLog = WriteAheadLog::create(path, this->options.fsyncPolicy, this->options.groupCommitWindow);
+        this->deadlineLog->open();
+        this->logger->LogInfo("... deadlines: " + path + " | " + std::to_string(this->expiry.size()) + " keys");
     }
 
-    std::string StorageServer::getAddress() const {
-        return this->tcpServer->getLocalAddress();
+    size_t StorageServer::loadDeadlines(const string &path) {
+        if (!file_exists(path)) {
+            return 0;
+        }
+
+        return WriteAheadLog::create(path)->replay([this](const WalRecord &record) {
+            if (record.type == WalRecordType::Expire) {
+                this->restoreDeadline(record.key, record.value);
+            }
+        });
     }
 
-    unsigned short StorageServer::getPort() const {
-        return this->tcpServer->getPort();
+    void StorageServer::restoreDeadline(const string &key, const string &logged) {
+        const uint64_t at = parse_deadline(logged);
+        if (at == 0) {
+            this->expiry.persist(key);
+        } else {
+            this->expiry.expireAt(key, at);
+        }
     }
 
-    void StorageServer::Start() {
-        this->logger->LogInfo("... starting server ...");
-        if (this->tcpServer != nullptr && this->tcpServer->started()) {
-            logger->LogInfo("server already started");
-            return;
+    bool StorageServer::setDeadline(const string &key, std::chrono::milliseconds ttl, const StorageEngine::durable_callback &durable) {
+        bool had;
+        uint64_t at = 0;
+        if (ttl.count() > 0) {
+            had = this->expiry.deadline(key) != 0;
+            this->expiry.expire(key, ttl);
+            at = this->expiry.deadline(key);
+        } else {
+            had = this->expiry.persist(key);
         }
 
-        this->tcpServer->start();
-        std::this_thread::sleep_for(5s);
+        // most writes have no ttl and had none, they log nothing
+        if (at == 0 && !had) {
+            if (durable != nullptr) {
+                durable(true);
+            }
+            return false;
+        }
 
-        this->logger->LogInfo("... addr: " + this->getAddress());
-        this->logger->LogInfo("... port: " + std::to_string(this->getPort()));
+        const string logged = format_deadline(at);
+        WriteAheadLog *log = this->wal != nullptr ? this->wal.get() : this->deadlineLog.get();
+        if (log != nullptr) {
+            log->append(WalRecordType::Expire, key, logged, durable != nullptr ? this->resume(durable) : nullptr);
+        } else if (durable != nullptr) {
+            durable(true);
+        }
 
-        this->logger->LogInfo("... started server ...");
+        this->logMutation(WalRecordType::Expire, key, logged);
+        return had;
     }
 
-    void StorageServer::Stop() {
-        this->logger->LogInfo("... stopping ...");
+    bool StorageServer::SaveSnapshot() {
+        if (this->options.snapshotPath.empty() || this->dataStorage->persistent()) {
+            return false;
+        }
+
+        bool expected = false;
+        if (!this->snapshotRunning.compare_exchange_strong(expected, true)) {
+            return false;
+        }
+
+        if (this->snapshotThread.joinable()) {
+            this->snapshotThread.join();
+        }
+
+        // every mutation after this log position is replayed on top of the snapshot; the deadlines are
+        // the server thread's, taken at the same point
+        const uint64_t walOffset = this->wal != nullptr ? this->wal->getAppendedOffset() : 0;
+        string deadlines = encode_deadlines(this->expiry);
+
+        this->snapshotThread = std::thread([this, walOffset, deadlines = std::move(deadlines)]() {
+            try {
+                const auto start = std::chrono::steady_clock::now();
+
+                // written first: a crash before the snapshot replays the log from the older position over them
+                const string deadlinesPath = this->options.snapshotPath + SNAPSHOT_DEADLINES_SUFFIX;
+                if (!save_deadlines(deadlinesPath, deadlines)) {
+                    throw std::runtime_error("cannot write " + deadlinesPath);
+                }
+
+                const uint64_t count = SnapshotFile::write(
+                        this->options.snapshotPath,
+                        [this](const SnapshotFile::record_callback &emit) { this->dataStorage->forEach(emit); },
+                        walOffset);
+
+                const auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+                this->logger->LogInfo("snapshot | saved " + std::to_string(count) + " keys in " + std::to_string(elapsed.count()) + " ms");
+            } catch (const std::exception &e) {
+                this->logger->LogError(std::string("snapshot | ") + e.what());
+            }
+
+            this->snapshotRunning = false;
+        });
+
+        return true;
     }
 
-    void StorageServer::handle_accept(tcp_connection::pointer connection) {
-        this->logger->LogInfo("server | accept new connection with uuid: " + connection->getUUID());
+    bool StorageServer::SnapshotRunning() const {
+        return this->snapshotRunning.load();
     }
 
-    void StorageServer::handle_accept_error(tcp_connection::pointer connection, const boost::system::error_code error) {
-        this->logger->LogInfo("server | accept error with uuid: " + connection->getUUID());
+    void StorageServer::scheduleExpiry(std::chrono::milliseconds delay) {
+        this->expiryTimer->expires_after(delay);
+        this->expiryTimer->async_wait(boost::bind(&StorageServer::handle_expiry_timer, this, boost::asio::placeholders::error));
     }
 
-    void StorageServer::handle_disconnect(tcp_connection::pointer connection) {
-        this->logger->LogInfo("server | client disconnected | uuid: " + connection->getUUID());
+    value_pointer StorageServer::readValue(const string &key, uint64_t *version) {
+        // expired but not reclaimed yet
+        if (this->expiry.expired(key)) {
+            return nullptr;
+        }
+
+        if (version != nullptr) {
+            return this->dataStorage->getVersioned(key, *version);
+        }
+
+        return this->dataStorage->getShared(key);
     }
 
-    void StorageServer::sendErrorStatus(tcp_connection::pointer connection, const string& description)
-    {
-        nlohmann::json json;
-        json[JSON::KEY::STATUS] = JSON::VALUE::STATUS_ERROR;
-        json[JSON::KEY::DESCRIPTION] = description;
+    void StorageServer::removeValue(const string &key, const StorageEngine::durable_callback &durable) {
+        if (this->wal == nullptr) {
+            this->dataStorage->remove(key);
+            if (durable != nullptr) {
+                durable(true);
+            }
+        } else {
+            this->wal->append(WalRecordType::Remove, key, string(), durable, [this, &key]() { this->dataStorage->remove(key); });
+        }
 
-        std::string jsonString = json.dump();
-        connection->send(jsonString);
+        this->logMutation(WalRecordType::Remove, key, string());
     }
 
-    void StorageServer::sendOkRead(tcp_connection::pointer connection, const string& value)
-    {
-        nlohmann::json json;
-        json[JSON::KEY::STATUS] = JSON::VALUE::STATUS_OK;
-        json[JSON::KEY::VALUE] = value;
+    bool StorageServer::readTtl(tcp_connection::pointer connection, const nlohmann::json &json, std::chrono::milliseconds &ttl) {
+        const int64_t value = json[JSON::KEY::TTL].get<int64_t>();
+        if (value <= 0) {
+            this->sendErrorStatus(connection, "field " + JSON::KEY::TTL + " must be positive");
+            return false;
+        }
 
-        std::string jsonString = json.dump();
-        connection->send(jsonString);
+        ttl = std::chrono::milliseconds(value);
+        return true;
     }
 
-    void StorageServer::sendOkWrite(tcp_connection::pointer connection)
-    {
-        nlohmann::json json;
-        json[JSON::KEY::STATUS] = JSON::VALUE::STATUS_OK;
+    bool StorageServer::readIfVersion(tcp_connection::pointer connection, const nlohmann::json &json, uint64_t &version) {
+        if (!this->dataStorage->versioned()) {
+            this->sendErrorStatus(connection, "field " + JSON::KEY::IF_VERSION + " is not supported by " + this->options.engine + " engine");
+            return false;
+        }
 
-        std::string jsonString = json.dump();
-        connection->send(jsonString);
+        version = json[JSON::KEY::IF_VERSION].get<uint64_t>();
+        return true;
     }
 
-    void StorageServer::handle_read_message(tcp_connection::pointer connection, std::string msg) {
-        this->logger->LogInfo("server | new message from client | uuid: " + connection->getUUID() + " | msg: " + msg);
+    bool StorageServer::writeValue(tcp_connection::pointer connection, const string &key, string &value, const uint64_t *ifVersion,
+                                   const std::chrono::milliseconds *ttl) {
+        if (this->dataStorage->versioned()) {
+            // mismatch is only ever set before updateValue returns, the deferred ok does not look at it
+            bool mismatch = false;
+            uint64_t current = 0;
+            const bool written = this->updateValue(connection, key, [&mismatch, &current, &value, ifVersion](bool, string_view, uint64_t version, string &updated) {
+                // if_version 0 - the key must be missing
+                if (ifVersion != nullptr && *ifVersion != version) {
+                    mismatch = true;
+                    current = version;
+                    return false;
+                }
 
-        try {
-            nlohmann::json json = nlohmann::json::parse(msg);
-            if (!json.contains(JSON::KEY::REQUEST)) {
-                this->sendErrorStatus(connection, "field" + JSON::KEY::REQUEST + " not found");
-            }
+                updated.swap(value);
+                return true;
+            }, [this, connection](bool written, uint64_t version) {
+                if (written) {
+                    this->sendOkWrite(connection, version);
+                }
+            }, ttl);
 
-            if (!json.contains(JSON::KEY::KEY)) {
-                this->sendErrorStatus(connection, "field" + JSON::KEY::KEY + " not found");
+            if (mismatch && connection != nullptr) {
+                this->reply(connection, this->response.begin()
+                                         .field(JSON::KEY::DESCRIPTION, "version mismatch")
+                                         .field(JSON::KEY::STATUS, JSON::VALUE::STATUS_ERROR)
+                                         .field(JSON::KEY::VERSION, current)
+                                         .end());
             }
+            return written;
+        }
 
-            const std::string request = json[JSON::KEY::REQUEST].get<string>();
-            const std::string key = json[JSON::KEY::KEY].get<string>();
+        // the ok waits for the value, so the deadline goes to the log first
+        if (ttl != nullptr) {
+            this->setDeadline(key, *ttl);
+        }
 
-            if (request == JSON::VALUE::REQUEST_READ)
-            {
-                if (this->keyExists(key)) {
-                    const std::string value = this->readValue(key);
-                    this->sendOkRead(connection, value);
+        if (this->wal == nullptr) {
+            this->dataStorage->putDurable(key, value, this->resume([this, connection](bool durable) {
+                if (durable) {
+                    this->sendOkWrite(connection);
                 } else {
-                    this->sendErrorStatus(connection, "key not found in storage");
+                    this->sendErrorStatus(connection, "write-ahead log failure");
                 }
+            }));
+            this->logMutation(WalRecordType::Put, key, value);
+            return true;
+        }
 
-            } else if (request == JSON::VALUE::REQUEST_WRITE)
-            {
-                if (!json.contains(JSON::KEY::VALUE)) {
-                    this->sendErrorStatus(connection, "field" + JSON::KEY::KEY + " not found");
-                }
+        // ok is deferred until the record is durable under the fsync policy
+        this->wal->append(
+                WalRecordType::Put, key, value,
+                this->resume([this, connection](bool durable) {
+                    if (durable) {
+                        this->sendOkWrite(connection);
+                    } else {
+                        this->sendErrorStatus(connection, "write-ahead log failure");
+                    }
+                }),
+                [this, &key, &value]() { this->dataStorage->put(key, value); });
+        this->logMutation(WalRecordType::Put, key, value);
+        return true;
+    }
 
-                const  std::string value = json[JSON::KEY::VALUE].get<string>();
-                this->writeValue(key, value);
-                this->sendOkWrite(connection);
+    void StorageServer::scanValues(tcp_connection::pointer connection, const nlohmann::json &json) {
+        ScanRequest request;
+        if (json.contains(JSON::KEY::PREFIX)) {
+            request.start = json[JSON::KEY::PREFIX].get<string>();
+            request.end = scan_prefix_end(request.start);
+        } else {
+            if (json.contains(JSON::KEY::START)) {
+                request.start = json[JSON::KEY::START].get<string>();
+            }
+            if (json.contains(JSON::KEY::END)) {
+                request.end = json[JSON::KEY::END].get<string>();
+            }
+        }
+
+        if (json.contains(JSON::KEY::LIMIT)) {
+            const int64_t limit = json[JSON::KEY::LIMIT].get<int64_t>();
+            if (limit <= 0) {
+                this->sendErrorStatus(connection, "field " + JSON::KEY::LIMIT + " must be positive");
+                return;
+            }
+
+            request.limit = std::min(static_cast<size_t>(limit), SCAN_MAX_LIMIT);
+        }
+
+        if (json.contains(JSON::KEY::CURSOR)) {
+            // resume right after the last key of the previous page
+            const string resume = Base64::Decode(json[JSON::KEY::CURSOR].get<string>()) + '\0';
+            if (resume > request.start) {
+                request.start = resume;
+            }
+        }
 
+        request.skip = [this](string_view key) {
+            return this->expiry.size() > 0 && this->expiry.expired(string(key));
+        };
+
+        // chunks are queued one by one, no single message holds the whole page
+        scan_chunks(*(this->dataStorage), request, [this, &connection](const string &chunk) {
+            this->reply(connection, chunk);
+        });
+    }
+
+    void StorageServer::readValues(tcp_connection::pointer connection, const nlohmann::json &json, Transaction *transaction) {
+        if (!json.contains(JSON::KEY::KEYS) || !json[JSON::KEY::KEYS].is_array()) {
+            this->sendErrorStatus(connection, "field " + JSON::KEY::KEYS + " must be an array");
+            return;
+        }
+
+        const auto &items = json[JSON::KEY::KEYS];
+        if (items.size() > MAX_BATCH_SIZE) {
+            this->sendErrorStatus(connection, "at most " + std::to_string(MAX_BATCH_SIZE) + " keys per request");
+            return;
+        }
+
+        std::vector<string> keys;
+        keys.reserve(items.size());
+        for (const auto &item : items) {
+            keys.push_back(item.get<string>());
+        }
+
+        // one engine call for the batch, missing and expired keys answer null
+        std::vector<value_pointer> values;
+        if (transaction == nullptr) {
+            values = this->dataStorage->multiGet(keys);
+        } else {
+            values.reserve(keys.size());
+            for (const auto &key : keys) {
+                values.push_back(this->readInTransaction(*transaction, key, nullptr));
+            }
+        }
+
+        nlohmann::json result = nlohmann::json::array();
+        for (size_t i = 0; i < keys.size(); i++) {
+            this->hotKeys->record(keys[i], false);
+            if (values[i] != nullptr && !this->expiry.expired(keys[i])) {
+                this->readHits++;
+                result.push_back(*(values[i]));
             } else {
-                this->sendErrorStatus(connection, "request must be read/write");
+                this->readMisses++;
+                result.push_back(nullptr);
             }
+        }
 
-        } catch (...) {
-            this->sendErrorStatus(connection, "json parse error");
+        nlohmann::json answer;
+        answer[JSON::KEY::STATUS] = JSON::VALUE::STATUS_OK;
+        answer[JSON::KEY::VALUES] = std::move(result);
+
+        this->reply(connection, answer.dump());
+    }
+
+    void StorageServer::writeValues(tcp_connection::pointer connection, const nlohmann::json &json) {
+        if (!json.contains(JSON::KEY::ITEMS) || !json[JSON::KEY::ITEMS].is_array()) {
+            this->sendErrorStatus(connection, "field " + JSON::KEY::ITEMS + " must be an array");
+            return;
+        }
+
+        const auto &items = json[JSON::KEY::ITEMS];
+        if (items.size() > MAX_BATCH_SIZE) {
+            this->sendErrorStatus(connection, "at most " + std::to_string(MAX_BATCH_SIZE) + " items per request");
+            return;
         }
+
+        StorageEngine::record_batch records;
+        records.reserve(items.size());
+        for (const auto &item : items) {
+            if (!item.contains(JSON::KEY::KEY) || !item.contains(JSON::KEY::VALUE)) {
+                this->sendErrorStatus(connection, "every item needs " + JSON::KEY::KEY + " and " + JSON::KEY::VALUE);
+                return;
+            }
+
+            records.emplace_back(item[JSON::KEY::KEY].get<string>(), item[JSON::KEY::VALUE].get<string>());
+        }
+
+        this->writeRecords(connection, records);
     }
 
-    void StorageServer::handle_read_error(tcp_connection::pointer connection, const boost::system::error_code error, size_t bytes_transferred) {
-        this->logger->LogInfo("server | msg read error | uuid: " + connection->getUUID() + " | error: " + error.message());
+    void StorageServer::writeRecords(tcp_connection::pointer connection, const StorageEngine::record_batch &records) {
+        // one ok for the batch, once every record is durable
+        const auto onDurable = this->resume([this, connection](bool durable) {
+            if (durable) {
+                this->sendOkWrite(connection);
+            } else {
+                this->sendErrorStatus(connection, "write-ahead log failure");
+            }
+        });
+
+        // plain writes make the keys persistent again, logged before the values the ok waits for
+        for (const auto &record : records) {
+            this->setDeadline(record.first, 0ms);
+        }
+
+        if (this->wal == nullptr) {
+            this->dataStorage->multiPutDurable(records, onDurable);
+        } else {
+            this->wal->appendBatch(records, onDurable, [this, &records]() { this->dataStorage->multiPut(records); });
+        }
+
+        for (const auto &record : records) {
+            this->logMutation(WalRecordType::Put, record.first, record.second);
+        }
     }
 
-    void StorageServer::handle_send_error(tcp_connection::pointer connection, const boost::system::error_code error, size_t bytes_transferred) {
-        this->logger->LogInfo("server | msg send error | uuid: " + connection->getUUID() + " | error: " + error.message());
+    bool StorageServer::updateValue(tcp_connection::pointer connection, const string &key, const StorageEngine::update_callback &update,
+                                    const std::function<void(bool, uint64_t)> &reply, const std::chrono::milliseconds *ttl) {
+        // an expired key not reclaimed yet counts as missing, its timer goes with it
+        if (this->expiry.expired(key)) {
+            this->removeValue(key);
+            this->setDeadline(key, 0ms);
+        }
+
+        // an engine with its own log acknowledges the write itself, after update has run
+        const bool engineDurable = this->dataStorage->persistent();
+        StorageEngine::durable_callback engineAck;
+        if (engineDurable) {
+            engineAck = this->resume([this, connection, reply](bool durable) {
+                if (!durable) {
+                    this->sendErrorStatus(connection, "write-ahead log failure");
+                } else if (connection != nullptr) {
+                    reply(true, 0);
+                }
+            });
+        }
+
+        string logged;
+        uint64_t version = 0;
+        const bool written = this->dataStorage->update(
+                key,
+                [this, &update, &logged](bool exists, string_view current, uint64_t currentVersion, string &updated) {
+                    if (!update(exists, current, currentVersion, updated)) {
+                        return false;
+                    }
+
+                    if (this->wal != nullptr || this->replicationLog != nullptr || !this->watches->empty()) {
+                        logged = updated;
+                    }
+                    return true;
+                },
+                engineAck, &version);
+
+        if (!written) {
+            if (connection != nullptr) {
+                reply(false, 0);
+            }
+            return false;
+        }
+
+        if (ttl != nullptr) {
+            this->setDeadline(key, *ttl);
+        }
+
+        this->logMutation(WalRecordType::Put, key, logged);
+
+        if (engineDurable) {
+            return true;
+        }
+
+        const StorageEngine::durable_callback onDurable = [this, connection, reply, version](bool durable) {
+            if (!durable) {
+                this->sendErrorStatus(connection, "write-ahead log failure");
+            } else if (connection != nullptr) {
+                reply(true, version);
+            }
+        };
+
+        // the server thread is the only writer, so the log order still equals the apply order
+        if (this->wal != nullptr) {
+            this->wal->append(WalRecordType::Put, key, logged, this->resume(onDurable));
+        } else {
+            onDurable(true);
+        }
+        return true;
+    }
+
+    std::function<void(bool, uint64_t)> StorageServer::replyJson(tcp_connection::pointer connection, const shared_ptr<nlohmann::json> &answer) {
+        return [this, connection, answer](bool, uint64_t version) {
+            if (version != 0) {
+                (*answer)[JSON::KEY::VERSION] = version;
+            }
+            this->reply(connection, answer->dump());
+        };
+    }
+
+    void StorageServer::reply(tcp_connection::pointer connection, const string &answer) {
+        if (connection->getFraming() != tcp_framing::Raw) {
+            connection->send(answer, this->requestId);
+            return;
+        }
+
+        // RESP: answers of one read go out together, in command order
+        if (this->respSession != nullptr && this->respConnection == connection.get()) {
+            this->respSession->replies.answer(this->requestId, answer);
+            return;
+        }
+
+        // a deferred one, the client may have gone while its write was logged
+        const auto found = this->respSessions.find(connection->getUUID());
+        if (found != this->respSessions.end()) {
+            found->second.replies.answer(this->requestId, answer);
+            this->flushResp(connection, found->second);
+        }
+    }
+
+    StorageEngine::durable_callback StorageServer::resume(const StorageEngine::durable_callback &done) {
+        // log flushers run it on their thread; dispatch runs it in place when already on the io thread
+        return [this, done, requestId = this->requestId](bool durable) {
+            this->tcpServer->getIoService().dispatch([this, done, requestId, durable]() {
+                const uint64_t current = this->requestId;
+                this->requestId = requestId;
+                done(durable);
+                this->requestId = current;
+            });
+        };
+    }
+
+    void StorageServer::beginTransaction(tcp_connection::pointer connection) {
+        const auto hashStorage = std::dynamic_pointer_cast<ShardedHashStorage>(this->dataStorage);
+        if (hashStorage == nullptr) {
+            this->sendErrorStatus(connection, "transactions are supported by hash engine only");
+            return;
+        }
+
+        const uint64_t id = this->nextTransaction++;
+        Transaction &transaction = this->transactions[id];
+        transaction.snapshot = hashStorage->acquireSnapshot();
+        transaction.connection = connection->getUUID();
+
+        nlohmann::json answer;
+        answer[JSON::KEY::STATUS] = JSON::VALUE::STATUS_OK;
+        answer[JSON::KEY::TXN] = id;
+        answer[JSON::KEY::SNAPSHOT] = transaction.snapshot;
+
+        this->reply(connection, answer.dump());
+    }
+
+    StorageServer::Transaction *StorageServer::findTransaction(tcp_connection::pointer connection, const nlohmann::json &json) {
+        // another connection's id is as unknown as a finished one
+        const auto found = this->transactions.find(json[JSON::KEY::TXN].get<uint64_t>());
+        if (found == this->transactions.end() || found->second.connection != connection->getUUID()) {
+            this->sendErrorStatus(connection, "transaction not found");
+            return nullptr;
+        }
+
+        return &(found->second);
+    }
+
+    value_pointer StorageServer::readInTransaction(Transaction &transaction, const string &key, uint64_t *version) {
+        // own writes first, they are not in the snapshot
+        const auto written = transaction.writes.find(key);
+        if (written != transaction.writes.end()) {
+            return std::make_shared<const string>(written->second);
+        }
+
+        transaction.reads.insert(key);
+        if (this->expiry.expired(key)) {
+            return nullptr;
+        }
+
+        const auto hashStorage = std::static_pointer_cast<ShardedHashStorage>(this->dataStorage);
+        return hashStorage->getAt(key, transaction.snapshot, version);
+    }
+
+    void StorageServer::commitTransaction(tcp_connection::pointer connection, const nlohmann::json &json) {
+        Transaction *transaction = this->findTransaction(connection, json);
+        if (transaction == nullptr) {
+            return;
+        }
+
+        // every key read or written must be unchanged since the snapshot
+        std::vector<string> checked(transaction->reads.begin(), transaction->reads.end());
+        StorageEngine::record_batch records(transaction->writes.begin(), transaction->writes.end());
+        for (const auto &record : records) {
+            checked.push_back(record.first);
+        }
+
+        const auto hashStorage = std::static_pointer_cast<ShardedHashStorage>(this->dataStorage);
+        const uint64_t version = hashStorage->commit(transaction->snapshot, checked, records);
+        this->endTransaction(json[JSON::KEY::TXN].get<uint64_t>());
+
+        if (version == 0) {
+            this->sendErrorStatus(connection, "transaction conflict");
+            return;
+        }
+
+        for (const auto &record : records) {
+            this->setDeadline(record.first, 0ms);
+            this->logMutation(WalRecordType::Put, record.first, record.second);
+        }
+
+        const auto answer = std::make_shared<nlohmann::json>();
+        (*answer)[JSON::KEY::STATUS] = JSON::VALUE::STATUS_OK;
+        (*answer)[JSON::KEY::VERSION] = version;
+        if (this->wal == nullptr || records.empty()) {
+            this->reply(connection, answer->dump());
+            return;
+        }
+
+        // already applied, the server thread is the only writer so the log order equals the apply order
+        this->wal->appendBatch(records, this->resume([this, connection, answer](bool durable) {
+            if (durable) {
+                this->reply(connection, answer->dump());
+            } else {
+                this->sendErrorStatus(connection, "write-ahead log failure");
+            }
+        }));
+    }
+
+    void StorageServer::endTransaction(uint64_t id) {
+        const auto found = this->transactions.find(id);
+        if (found == this->transactions.end()) {
+            return;
+        }
+
+        std::static_pointer_cast<ShardedHashStorage>(this->dataStorage)->releaseSnapshot(found->second.snapshot);
+        this->transactions.erase(found);
+    }
+
+    void StorageServer::logMutation(WalRecordType type, const string &key, const string &value) {
+        // a deadline is not a change of the value, watchers hear of the removal once it expires
+        if (type != WalRecordType::Expire) {
+            this->hotKeys->record(key, true);
+            this->notifyWatchers(type, key, value);
+        }
+
+        if (this->replicationLog == nullptr) {
+            return;
+        }
+
+        this->replicationLog->append(type, key, value);
+
+        // one flush after the requests queued now, their records go out together
+        if (!this->replicationFlushPending) {
+            this->replicationFlushPending = true;
+            this->tcpServer->getIoService().post([this]() {
+                this->replicationFlushPending = false;
+                this->flushReplicas();
+            });
+        }
+    }
+
+    void StorageServer::notifyWatchers(WalRecordType type, const string &key, const string &value) {
+        if (this->watches->empty()) {
+            return;
+        }
+
+        const uint64_t dropped = this->watches->getEventsDropped();
+        const auto slow = this->watches->notify(key, type == WalRecordType::Put ? &value : nullptr);
+
+        // closing fires the disconnect handler, not while a request is half done
+        for (const auto &connection : slow) {
+            this->logger->LogWarning("watch | closing subscriber " + connection->getUUID() + ", its queue is over the limit");
+            this->tcpServer->getIoService().post([this, connection]() { this->tcpServer->disconnect(connection); });
+        }
+
+        if (this->watches->getEventsDropped() != dropped) {
+            this->scheduleWatchFlush();
+        }
+    }
+
+    void StorageServer::scheduleWatchFlush() {
+        if (this->watchFlushPending || this->watchTimer == nullptr) {
+            return;
+        }
+
+        this->watchFlushPending = true;
+        this->watchTimer->expires_after(WATCH_FLUSH_INTERVAL);
+        this->watchTimer->async_wait(boost::bind(&StorageServer::handle_watch_timer, this, boost::asio::placeholders::error));
+    }
+
+    void StorageServer::watchKeys(tcp_connection::pointer connection, const string &request, const nlohmann::json &json) {
+        const bool prefix = json.contains(JSON::KEY::PREFIX);
+        if (prefix == json.contains(JSON::KEY::KEY)) {
+            this->sendErrorStatus(connection, "one of fields " + JSON::KEY::KEY + " and " + JSON::KEY::PREFIX + " is needed");
+            return;
+        }
+
+        const string pattern = json[prefix ? JSON::KEY::PREFIX : JSON::KEY::KEY].get<string>();
+        if (request == JSON::VALUE::REQUEST_UNWATCH) {
+            this->watches->unwatch(connection->getUUID(), pattern, prefix);
+            this->sendOkWrite(connection);
+            return;
+        }
+
+        if (this->watches->watches(connection->getUUID()) >= WatchRegistry::MAX_WATCHES_PER_CONNECTION) {
+            this->sendErrorStatus(connection, "at most " + std::to_string(WatchRegistry::MAX_WATCHES_PER_CONNECTION) + " watches per connection");
+            return;
+        }
+
+        this->watches->watch(connection, pattern, prefix);
+        this->sendOkWrite(connection);
+    }
+
+    void StorageServer::startReplication(tcp_connection::pointer connection, const nlohmann::json &json) {
+        if (this->replica != nullptr) {
+            this->sendErrorStatus(connection, "a replica does not serve replicas");
+            return;
+        }
+
+        if (this->replicationLog == nullptr) {
+            this->replicationLog = std::make_unique<ReplicationLog>(this->options.replicationBacklog);
+        }
+
+        const string id = json.value(JSON::KEY::REPLICATION_ID, string());
+        const uint64_t position = json.value(JSON::KEY::POSITION, uint64_t(0));
+
+        Replica &replica = this->replicas[connection->getUUID()];
+        replica.connection = connection;
+
+        nlohmann::json answer;
+        answer[JSON::KEY::STATUS] = JSON::VALUE::STATUS_OK;
+        answer[JSON::KEY::REPLICATION_ID] = this->replicationLog->getId();
+
+        // same log and the backlog still has everything after the follower's position
+        if (id == this->replicationLog->getId() && this->replicationLog->covers(position)) {
+            answer[JSON::KEY::REPLICATION] = JSON::VALUE::REPLICATION_PARTIAL;
+            answer[JSON::KEY::POSITION] = position;
+            this->reply(connection, answer.dump());
+
+            replica.sent = position;
+            replica.acked = position;
+            this->sendReplicationRecords(replica);
+            return;
+        }
+
+        answer[JSON::KEY::REPLICATION] = JSON::VALUE::REPLICATION_FULL;
+        answer[JSON::KEY::POSITION] = this->replicationLog->getPosition();
+        this->reply(connection, answer.dump());
+        this->sendFullSync(replica);
+    }
+
+    void StorageServer::sendFullSync(Replica &replica) {
+        // the server thread is the only writer, the copy matches the log position exactly
+        const uint64_t position = this->replicationLog->getPosition();
+
+        nlohmann::json items = nlohmann::json::array();
+        size_t bytes = 0;
+        const auto flush = [&replica, &items, &bytes]() {
+            nlohmann::json message;
+            message[JSON::KEY::REPLICATION] = JSON::VALUE::REPLICATION_ITEMS;
+            message[JSON::KEY::ITEMS] = std::move(items);
+            replica.connection->send(message.dump());
+
+            items = nlohmann::json::array();
+            bytes = 0;
+        };
+
+        size_t count = 0;
+        this->dataStorage->forEach([this, &items, &bytes, &count, &flush](string_view key, string_view value) {
+            uint64_t at = 0;
+            if (this->expiry.size() > 0) {
+                const string name(key);
+                if (this->expiry.expired(name)) {
+                    return;
+                }
+                at = this->expiry.deadline(name);
+            }
+
+            nlohmann::json item;
+            item[JSON::KEY::KEY] = string(key);
+            item[JSON::KEY::VALUE] = string(value);
+            if (at != 0) {
+                item[JSON::KEY::EXPIRE_AT] = at;
+            }
+            items.push_back(std::move(item));
+            bytes += key.size() + value.size();
+            count++;
+
+            if (items.size() >= REPLICATION_CHUNK_RECORDS || bytes >= REPLICATION_CHUNK_BYTES) {
+                flush();
+            }
+        });
+
+        if (!items.empty()) {
+            flush();
+        }
+
+        nlohmann::json synced;
+        synced[JSON::KEY::REPLICATION] = JSON::VALUE::REPLICATION_SYNCED;
+        synced[JSON::KEY::POSITION] = position;
+        replica.connection->send(synced.dump());
+
+        replica.sent = position;
+        replica.acked = position;
+        this->logger->LogInfo("server | replica " + replica.connection->getUUID() + " | full sync of " + std::to_string(count) +
+                              " keys at position " + std::to_string(position));
+    }
+
+    bool StorageServer::sendReplicationRecords(Replica &replica) {
+        if (!this->replicationLog->covers(replica.sent)) {
+            return false;
+        }
+
+        while (replica.sent - replica.acked < REPLICATION_WINDOW) {
+            nlohmann::json records = nlohmann::json::array();
+            uint64_t last = replica.sent;
+            const size_t limit = std::min(REPLICATION_CHUNK_RECORDS, static_cast<size_t>(REPLICATION_WINDOW - (replica.sent - replica.acked)));
+            const size_t count = this->replicationLog->read(replica.sent, limit, REPLICATION_CHUNK_BYTES,
+                                                            [&records, &last](const ReplicationLog::Record &record) {
+                                                                nlohmann::json item;
+                                                                item[JSON::KEY::KEY] = record.key;
+                                                                if (record.type == WalRecordType::Put) {
+                                                                    item[JSON::KEY::VALUE] = record.value;
+                                                                } else if (record.type == WalRecordType::Expire) {
+                                                                    item[JSON::KEY::EXPIRE_AT] = parse_deadline(record.value);
+                                                                }
+                                                                records.push_back(std::move(item));
+                                                                last = record.position;
+                                                            });
+            if (count == 0) {
+                break;
+            }
+
+            nlohmann::json message;
+            message[JSON::KEY::REPLICATION] = JSON::VALUE::REPLICATION_RECORDS;
+            message[JSON::KEY::POSITION] = last;
+            message[JSON::KEY::HEAD] = this->replicationLog->getPosition();
+            message[JSON::KEY::RECORDS] = std::move(records);
+            replica.connection->send(message.dump());
+
+            replica.sent = last;
+        }
+
+        return true;
+    }
+
+    void StorageServer::flushReplicas() {
+        // a follower the backlog left behind reconnects and gets a full sync
+        std::vector<tcp_connection::pointer> lagging;
+        for (auto &replica : this->replicas) {
+            if (!this->sendReplicationRecords(replica.second)) {
+                lagging.push_back(replica.second.connection);
+            }
+        }
+
+        for (const auto &connection : lagging) {
+            this->logger->LogWarning("server | replica " + connection->getUUID() + " | fell behind the replication backlog");
+            connection->disconnect();
+        }
+    }
+
+    bool StorageServer::routeRaftRequest(tcp_connection::pointer connection, const string &request, const nlohmann::json &json) {
+        if (request == JSON::VALUE::REQUEST_RAFT_APPEND || request == JSON::VALUE::REQUEST_RAFT_VOTE) {
+            this->raft->handleRequest(connection, request, json);
+            return true;
+        }
+
+        // every member applies the log, so its watchers see every committed change
+        if (request == JSON::VALUE::REQUEST_STATS || request == JSON::VALUE::REQUEST_WATCH || request == JSON::VALUE::REQUEST_UNWATCH) {
+            return false;
+        }
+
+        // their effect would be local to one node: expiry timers, snapshots, per-node versions, async replicas
+        if (request == JSON::VALUE::REQUEST_EXPIRE || request == JSON::VALUE::REQUEST_PERSIST || request == JSON::VALUE::REQUEST_BEGIN ||
+            request == JSON::VALUE::REQUEST_COMMIT || request == JSON::VALUE::REQUEST_ABORT || request == JSON::VALUE::REQUEST_SNAPSHOT ||
+            request == JSON::VALUE::REQUEST_REPLICATE || request == JSON::VALUE::REQUEST_REPLICATE_ACK) {
+            this->sendErrorStatus(connection, "request " + request + " is not supported in raft mode");
+            return true;
+        }
+
+        if (json.contains(JSON::KEY::TTL) || json.contains(JSON::KEY::TXN) || (is_write_request(request) && json.contains(JSON::KEY::IF_VERSION))) {
+            this->sendErrorStatus(connection, "fields " + JSON::KEY::TTL + ", " + JSON::KEY::TXN + " and " + JSON::KEY::IF_VERSION +
+                                                      " of writes are not supported in raft mode");
+            return true;
+        }
+
+        if (!this->raft->isLeader()) {
+            this->sendNotLeader(connection);
+            return true;
+        }
+
+        // the request itself is the command, every node runs it once it commits
+        if (is_write_request(request)) {
+            this->raftPending[this->raft->propose(json.dump())] = std::make_pair(connection, this->requestId);
+            return true;
+        }
+
+        // reads are linearizable: served by the leader only, once it is sure it still is the leader
+        this->raft->read([this, connection, request, json, requestId = this->requestId](bool leader) {
+            // run in place under a lease or later from the raft tick, the id of whatever runs then is put back
+            const uint64_t current = this->requestId;
+            this->requestId = requestId;
+            if (!leader) {
+                this->sendNotLeader(connection);
+            } else {
+                try {
+                    this->dispatchRequest(connection, request, json);
+                } catch (...) {
+                    this->sendErrorStatus(connection, "json parse error");
+                }
+            }
+            this->requestId = current;
+        });
+        return true;
+    }
+
+    void StorageServer::applyRaftCommand(uint64_t index, const string &command) {
+        // the client is answered by the node it sent the write to
+        tcp_connection::pointer connection;
+        const uint64_t current = this->requestId;
+        this->requestId = 0;
+        const auto found = this->raftPending.find(index);
+        if (found != this->raftPending.end()) {
+            connection = found->second.first;
+            this->requestId = found->second.second;
+            this->raftPending.erase(found);
+        }
+
+        try {
+            const nlohmann::json json = nlohmann::json::parse(command);
+            this->dispatchRequest(connection, json[JSON::KEY::REQUEST].get<string>(), json);
+        } catch (...) {
+            this->sendErrorStatus(connection, "json parse error");
+        }
+        this->requestId = current;
+    }
+
+    void StorageServer::failRaftPending() {
+        const uint64_t current = this->requestId;
+        for (const auto &pending : this->raftPending) {
+            this->requestId = pending.second.second;
+            this->sendErrorStatus(pending.second.first, "leader changed, the write may or may not be applied");
+        }
+        this->raftPending.clear();
+        this->requestId = current;
+    }
+
+    void StorageServer::sendNotLeader(tcp_connection::pointer connection) {
+        nlohmann::json json;
+        json[JSON::KEY::STATUS] = JSON::VALUE::STATUS_ERROR;
+        json[JSON::KEY::DESCRIPTION] = "not the leader";
+        if (!this->raft->getLeader().empty()) {
+            json[JSON::KEY::LEADER] = this->raft->getLeader();
+        }
+
+        this->reply(connection, json.dump());
+    }
+
+    void StorageServer::incrementValue(tcp_connection::pointer connection, const string &key, const nlohmann::json &json, bool decrement) {
+        int64_t by = 1;
+        if (json.contains(JSON::KEY::BY)) {
+            by = json[JSON::KEY::BY].get<int64_t>();
+        }
+
+        if (decrement) {
+            if (by == std::numeric_limits<int64_t>::min()) {
+                this->sendErrorStatus(connection, "field " + JSON::KEY::BY + " is out of range");
+                return;
+            }
+            by = -by;
+        }
+
+        const auto answer = std::make_shared<nlohmann::json>();
+        this->updateValue(connection, key, [&answer, by](bool exists, string_view current, uint64_t, string &updated) {
+            // a missing key counts from zero
+            int64_t value = 0;
+            if (exists && !parse_int64(current, value)) {
+                set_error(*answer, "value is not an integer");
+                return false;
+            }
+
+            if ((by > 0 && value > std::numeric_limits<int64_t>::max() - by) ||
+                (by < 0 && value < std::numeric_limits<int64_t>::min() - by)) {
+                set_error(*answer, "increment would overflow");
+                return false;
+            }
+
+            updated = std::to_string(value + by);
+            (*answer)[JSON::KEY::STATUS] = JSON::VALUE::STATUS_OK;
+            (*answer)[JSON::KEY::VALUE] = updated;
+            return true;
+        }, this->replyJson(connection, answer));
+    }
+
+    void StorageServer::compareAndSwapValue(tcp_connection::pointer connection, const string &key, const nlohmann::json &json) {
+        const bool byValue = json.contains(JSON::KEY::EXPECTED);
+        const bool byVersion = json.contains(JSON::KEY::IF_VERSION);
+        if (!byValue && !byVersion) {
+            this->sendErrorStatus(connection, "field " + JSON::KEY::EXPECTED + " or " + JSON::KEY::IF_VERSION + " not found");
+            return;
+        }
+
+        if (!json.contains(JSON::KEY::VALUE)) {
+            this->sendErrorStatus(connection, "field " + JSON::KEY::VALUE + " not found");
+            return;
+        }
+
+        uint64_t ifVersion = 0;
+        if (byVersion && !this->readIfVersion(connection, json, ifVersion)) {
+            return;
+        }
+
+        // expected null - swap only if the key is missing
+        const bool expectMissing = byValue && json[JSON::KEY::EXPECTED].is_null();
+        const string expected = byValue && !expectMissing ? json[JSON::KEY::EXPECTED].get<string>() : string();
+        const string value = json[JSON::KEY::VALUE].get<string>();
+
+        const auto answer = std::make_shared<nlohmann::json>();
+        (*answer)[JSON::KEY::STATUS] = JSON::VALUE::STATUS_OK;
+        (*answer)[JSON::KEY::SWAPPED] = false;
+
+        this->updateValue(connection, key, [&](bool exists, string_view current, uint64_t version, string &updated) {
+            if (byValue && (exists == expectMissing || (exists && current != expected))) {
+                return false;
+            }
+
+            if (byVersion && version != ifVersion) {
+                return false;
+            }
+
+            updated = value;
+            (*answer)[JSON::KEY::SWAPPED] = true;
+            return true;
+        }, this->replyJson(connection, answer));
+    }
+
+    void StorageServer::appendValue(tcp_connection::pointer connection, const string &key, const nlohmann::json &json) {
+        if (!json.contains(JSON::KEY::VALUE)) {
+            this->sendErrorStatus(connection, "field " + JSON::KEY::VALUE + " not found");
+            return;
+        }
+
+        const string tail = json[JSON::KEY::VALUE].get<string>();
+
+        const auto answer = std::make_shared<nlohmann::json>();
+        this->updateValue(connection, key, [&answer, &tail](bool, string_view current, uint64_t, string &updated) {
+            updated.reserve(current.size() + tail.size());
+            updated.assign(current);
+            updated.append(tail);
+
+            (*answer)[JSON::KEY::STATUS] = JSON::VALUE::STATUS_OK;
+            (*answer)[JSON::KEY::LENGTH] = updated.size();
+            return true;
+        }, this->replyJson(connection, answer));
+    }
+
+    bool StorageServer::Started() const {
+        try {
+            if (this->tcpServer != nullptr) {
+                return this->tcpServer->started();
+            }
+        } catch (...) {
+        }
+
+        return false;
+    }
+
+    std::string StorageServer::getAddress() const {
+        return this->tcpServer->getLocalAddress();
+    }
+
+    unsigned short StorageServer::getPort() const {
+        return this->tcpServer->getPort();
+    }
+
+    unsigned short StorageServer::getRespPort() const {
+        return this->respServer != nullptr ? this->respServer->getPort() : 0;
+    }
+
+    void StorageServer::Start() {
+        this->logger->LogInfo("... starting server ...");
+        if (this->tcpServer != nullptr && this->tcpServer->started()) {
+            logger->LogInfo("server already started");
+            return;
+        }
+
+        this->openSnapshot();
+        this->openWriteAheadLog();
+        this->openDeadlineLog();
+
+        const auto hashStorage = std::dynamic_pointer_cast<ShardedHashStorage>(this->dataStorage);
+        if (this->options.maxMemory != 0) {
+            if (hashStorage == nullptr) {
+                this->logger->LogWarning("... maxmemory: ignored, supported by hash engine only");
+            } else {
+                this->logger->LogInfo("... maxmemory: " + std::to_string(this->options.maxMemory) + " bytes | in use " +
+                                      std::to_string(hashStorage->memoryUsage()) + " bytes");
+            }
+        }
+
+        if (this->expiryTimer == nullptr) {
+            this->expiryTimer = std::make_unique<boost::asio::steady_timer>(this->tcpServer->getIoService());
+            this->scheduleExpiry(this->expiry.getTick());
+        }
+
+        if (this->watchTimer == nullptr) {
+            this->watchTimer = std::make_unique<boost::asio::steady_timer>(this->tcpServer->getIoService());
+        }
+
+        if (!this->options.raftId.empty() && this->raft == nullptr) {
+            this->raft = RaftNode::create(
+                    this->tcpServer->getIoService(), this->options,
+                    [this](uint64_t index, const string &command) { this->applyRaftCommand(index, command); },
+                    [this]() { this->failRaftPending(); });
+            this->raft->start();
+        }
+
+        this->tcpServer->start();
+        if (this->respServer != nullptr) {
+            this->respServer->start();
+        }
+
+        if (!this->options.replicaOfHost.empty() && this->replica == nullptr) {
+            this->replica = StorageReplica::create(this->dataStorage, this->options.replicaOfHost, this->options.replicaOfPort, this->options.framing);
+            this->replica->setDeadlineHandler([this](StorageReplica::deadline_batch deadlines) {
+                // the expiry belongs to the server thread, the batches keep their stream order there
+                this->tcpServer->getIoService().post([this, deadlines = std::move(deadlines)]() {
+                    for (const auto &deadline : deadlines) {
+                        if (deadline.second == 0) {
+                            this->expiry.persist(deadline.first);
+                        } else {
+                            this->expiry.expireAt(deadline.first, deadline.second);
+                        }
+                    }
+                });
+            });
+            this->replica->start();
+            this->logger->LogInfo("... replica of " + this->replica->getLeader() + ", read-only");
+        }
+
+        std::this_thread::sleep_for(5s);
+
+        this->logger->LogInfo("... addr: " + this->getAddress());
+        this->logger->LogInfo("... port: " + std::to_string(this->getPort()));
+        if (this->respServer != nullptr) {
+            this->logger->LogInfo("... resp port: " + std::to_string(this->getRespPort()));
+        }
+
+        this->logger->LogInfo("... started server ...");
+    }
+
+    void StorageServer::Stop() {
+        this->logger->LogInfo("... stopping ...");
+
+        if (this->wal != nullptr) {
+            this->wal->close();
+        }
+    }
+
+    void StorageServer::handle_accept(tcp_connection::pointer connection) {
+        this->logger->LogInfo("server | accept new connection with uuid: " + connection->getUUID());
+
+        // pipelined small answers, e.g. to raft peers, must not wait for the client's ack
+        boost::system::error_code ignored;
+        connection->socket().set_option(tcp::no_delay(true), ignored);
+    }
+
+    void StorageServer::handle_accept_error(tcp_connection::pointer connection, const boost::system::error_code error) {
+        this->logger->LogInfo("server | accept error with uuid: " + connection->getUUID());
+    }
+
+    void StorageServer::handle_disconnect(tcp_connection::pointer connection) {
+        this->logger->LogInfo("server | client disconnected | uuid: " + connection->getUUID());
+
+        this->replicas.erase(connection->getUUID());
+        this->watches->remove(connection->getUUID());
+
+        // open transactions of the connection are aborted, their snapshots released
+        std::vector<uint64_t> aborted;
+        for (const auto &transaction : this->transactions) {
+            if (transaction.second.connection == connection->getUUID()) {
+                aborted.push_back(transaction.first);
+            }
+        }
+        for (const uint64_t id : aborted) {
+            this->endTransaction(id);
+        }
+    }
+
+    void StorageServer::sendErrorStatus(tcp_connection::pointer connection, const string& description)
+    {
+        // raft entries applied on followers have no client to answer
+        if (connection == nullptr) {
+            return;
+        }
+
+        if (connection->getFraming() == tcp_framing::Raw) {
+            this->respAnswer.clear();
+            resp_error(this->respAnswer, "ERR " + description);
+            this->reply(connection, this->respAnswer);
+            return;
+        }
+
+        this->reply(connection, this->response.begin()
+                                 .field(JSON::KEY::DESCRIPTION, description)
+                                 .field(JSON::KEY::STATUS, JSON::VALUE::STATUS_ERROR)
+                                 .end());
+    }
+
+    void StorageServer::sendOkRead(tcp_connection::pointer connection, const string& value, uint64_t version)
+    {
+        if (connection->getFraming() == tcp_framing::Raw) {
+            this->respAnswer.clear();
+            resp_bulk(this->respAnswer, value);
+            this->reply(connection, this->respAnswer);
+            return;
+        }
+
+        this->response.begin().field(JSON::KEY::STATUS, JSON::VALUE::STATUS_OK).field(JSON::KEY::VALUE, value);
+        if (version != 0) {
+            this->response.field(JSON::KEY::VERSION, version);
+        }
+
+        this->reply(connection, this->response.end());
+    }
+
+    void StorageServer::sendNotModified(tcp_connection::pointer connection, uint64_t version)
+    {
+        this->reply(connection, this->response.begin()
+                                 .field(JSON::KEY::STATUS, JSON::VALUE::STATUS_NOT_MODIFIED)
+                                 .field(JSON::KEY::VERSION, version)
+                                 .end());
+    }
+
+    void StorageServer::sendOkWrite(tcp_connection::pointer connection, uint64_t version)
+    {
+        if (connection == nullptr) {
+            return;
+        }
+
+        if (connection->getFraming() == tcp_framing::Raw) {
+            this->respAnswer.clear();
+            resp_simple(this->respAnswer, "OK");
+            this->reply(connection, this->respAnswer);
+            return;
+        }
+
+        this->response.begin().field(JSON::KEY::STATUS, JSON::VALUE::STATUS_OK);
+        if (version != 0) {
+            this->response.field(JSON::KEY::VERSION, version);
+        }
+
+        this->reply(connection, this->response.end());
+    }
+
+    void StorageServer::sendStats(tcp_connection::pointer connection)
+    {
+        nlohmann::json stats;
+        stats["keys"] = this->dataStorage->size();
+        stats["hits"] = this->readHits;
+        stats["misses"] = this->readMisses;
+        stats["expired"] = this->expiredKeys;
+        stats["ttl_keys"] = this->expiry.size();
+
+        nlohmann::json watch;
+        watch["watches"] = this->watches->getSubscriptions();
+        watch["watchers"] = this->watches->getWatchers();
+        watch["events"] = this->watches->getEventsSent();
+        watch["dropped"] = this->watches->getEventsDropped();
+        watch["disconnects"] = this->watches->getDisconnects();
+        stats[JSON::KEY::WATCH] = std::move(watch);
+
+        // how far the rollout of the faster framings got, raw - clients of the RESP listener
+        nlohmann::json framings;
+        size_t negotiating = 0;
+        size_t counts[TCP_FRAMING_COUNT] = {};
+        auto clients = this->tcpServer->getConnectionsVector();
+        if (this->respServer != nullptr) {
+            const auto respClients = this->respServer->getConnectionsVector();
+            clients.insert(clients.end(), respClients.begin(), respClients.end());
+        }
+        for (const auto &client : clients) {
+            if (client->negotiating()) {
+                negotiating++;
+            } else {
+                counts[static_cast<size_t>(client->getFraming())]++;
+            }
+        }
+        for (size_t framing = 0; framing < TCP_FRAMING_COUNT; framing++) {
+            framings[tcp_framing_to_string(static_cast<tcp_framing>(framing))] = counts[framing];
+        }
+        framings["negotiating"] = negotiating;
+        stats["connections"] = std::move(framings);
+
+        if (this->hotKeys->enabled()) {
+            nlohmann::json hot;
+            hot["sample"] = this->hotKeys->getSampleRate();
+            hot["sampled"] = this->hotKeys->getSampled();
+            hot["keys"] = nlohmann::json::array();
+            for (const auto &hotKey : this->hotKeys->hottest(this->hotKeys->getCapacity())) {
+                nlohmann::json item;
+                item[JSON::KEY::KEY] = hotKey.key;
+                item["accesses"] = hotKey.accesses;
+                item["reads"] = hotKey.reads;
+                item["writes"] = hotKey.writes;
+                hot["keys"].push_back(std::move(item));
+            }
+            stats["hot"] = std::move(hot);
+        }
+
+        const auto hashStorage = std::dynamic_pointer_cast<ShardedHashStorage>(this->dataStorage);
+        if (hashStorage != nullptr) {
+            stats["memory"] = hashStorage->memoryUsage();
+            stats["maxmemory"] = hashStorage->getMemoryLimit();
+            stats["evictions"] = hashStorage->getEvictions();
+            stats["transactions"] = this->transactions.size();
+            stats["history"] = hashStorage->historySize();
+        }
+
+        nlohmann::json replication;
+        if (this->replica != nullptr) {
+            replication["role"] = "replica";
+            replication["leader"] = this->replica->getLeader();
+            replication["state"] = replica_state_to_string(this->replica->getState());
+            replication["position"] = this->replica->getPosition();
+            replication["leader_position"] = this->replica->getLeaderPosition();
+            replication["full_syncs"] = this->replica->getFullSyncs();
+            replication["partial_syncs"] = this->replica->getPartialSyncs();
+        } else {
+            replication["role"] = "leader";
+            replication["position"] = this->replicationLog != nullptr ? this->replicationLog->getPosition() : 0;
+            replication["backlog_bytes"] = this->replicationLog != nullptr ? this->replicationLog->getBytes() : 0;
+
+            nlohmann::json followers = nlohmann::json::array();
+            for (const auto &replica : this->replicas) {
+                nlohmann::json follower;
+                follower["position"] = replica.second.acked;
+                follower["lag"] = this->replicationLog->getPosition() - replica.second.acked;
+                followers.push_back(std::move(follower));
+            }
+            replication["replicas"] = std::move(followers);
+        }
+        stats["replication"] = std::move(replication);
+
+        if (this->raft != nullptr) {
+            nlohmann::json raft;
+            raft["id"] = this->raft->getId();
+            raft["role"] = raft_role_to_string(this->raft->getRole());
+            raft["term"] = this->raft->getTerm();
+            raft["leader"] = this->raft->getLeader();
+            raft["commit_index"] = this->raft->getCommitIndex();
+            raft["last_index"] = this->raft->getLastIndex();
+            raft["lease"] = this->raft->hasLease();
+            raft["elections"] = this->raft->getElections();
+
+            nlohmann::json peers = nlohmann::json::array();
+            for (const auto &peer : this->raft->getPeers()) {
+                nlohmann::json item;
+                item["id"] = peer.id;
+                item["connected"] = peer.connected;
+                item["match"] = peer.matchIndex;
+                peers.push_back(std::move(item));
+            }
+            raft["peers"] = std::move(peers);
+            stats["raft"] = std::move(raft);
+        }
+
+        nlohmann::json json;
+        json[JSON::KEY::STATUS] = JSON::VALUE::STATUS_OK;
+        json[JSON::KEY::STATS] = stats;
+
+        std::string jsonString = json.dump();
+        this->reply(connection, jsonString);
+    }
+
+    void StorageServer::handle_read_message(tcp_connection::pointer connection, std::string msg) {
+        // the payload stays out of the log: it may be large and holds client data; a disabled logger costs no string
+        if (this->logger->Enabled()) {
+            this->logger->LogDebug("server | new message from client | uuid: " + connection->getUUID() + " | bytes: " + std::to_string(msg.size()));
+        }
+
+        // every answer to it carries the id back, deferred ones included
+        this->requestId = connection->getReadRequestId();
+
+        // plain reads and writes skip the DOM, raft routes requests as JSON so it always takes the long way
+        if (this->raft == nullptr && parse_request(msg, this->parsed) && this->dispatchParsed(connection)) {
+            return;
+        }
+
+        try {
+            nlohmann::json json = nlohmann::json::parse(msg);
+            if (!json.contains(JSON::KEY::REQUEST)) {
+                this->sendErrorStatus(connection, "field " + JSON::KEY::REQUEST + " not found");
+                return;
+            }
+
+            const std::string request = json[JSON::KEY::REQUEST].get<string>();
+
+            if (this->replica != nullptr && is_write_request(request)) {
+                this->sendErrorStatus(connection, "read-only replica of " + this->replica->getLeader());
+                return;
+            }
+
+            if (this->raft != nullptr && this->routeRaftRequest(connection, request, json)) {
+                return;
+            }
+
+            this->dispatchRequest(connection, request, json);
+        } catch (...) {
+            this->sendErrorStatus(connection, "json parse error");
+        }
+    }
+
+    bool StorageServer::dispatchParsed(tcp_connection::pointer connection) {
+        const ParsedRequest &parsed = this->parsed;
+
+        // whatever would answer an error is left to dispatchRequest, it words them all
+        if (!parsed.hasKey) {
+            return false;
+        }
+
+        if (parsed.request == JSON::VALUE::REQUEST_READ) {
+            this->parsedKey.assign(parsed.key);
+            this->serveRead(connection, this->parsedKey, parsed.hasIfVersion ? &parsed.ifVersion : nullptr, nullptr);
+            return true;
+        }
+
+        if (parsed.request == JSON::VALUE::REQUEST_WRITE) {
+            if (!parsed.hasValue || this->replica != nullptr || (parsed.hasTtl && parsed.ttl <= 0) ||
+                (parsed.hasIfVersion && !this->dataStorage->versioned())) {
+                return false;
+            }
+
+            this->parsedKey.assign(parsed.key);
+            string value(parsed.value);
+            this->serveWrite(connection, this->parsedKey, value, std::chrono::milliseconds(parsed.ttl),
+                             parsed.hasIfVersion ? &parsed.ifVersion : nullptr);
+            return true;
+        }
+
+        return false;
+    }
+
+    void StorageServer::serveRead(tcp_connection::pointer connection, const string &key, const uint64_t *ifVersion, Transaction *transaction) {
+        this->hotKeys->record(key, false);
+        uint64_t version = 0;
+        const value_pointer value = transaction != nullptr ? this->readInTransaction(*transaction, key, &version)
+                                                           : this->readValue(key, &version);
+        if (value == nullptr) {
+            this->readMisses++;
+            this->sendErrorStatus(connection, "key not found in storage");
+            return;
+        }
+
+        this->readHits++;
+        // the client already holds this version, skip the value
+        if (version != 0 && ifVersion != nullptr && *ifVersion == version) {
+            this->sendNotModified(connection, version);
+        } else {
+            this->sendOkRead(connection, *value, version);
+        }
+    }
+
+    void StorageServer::serveWrite(tcp_connection::pointer connection, const string &key, string &value, std::chrono::milliseconds ttl,
+                                   const uint64_t *ifVersion) {
+        // a plain write makes the key persistent again
+        this->writeValue(connection, key, value, ifVersion, &ttl);
+    }
+
+    void StorageServer::dispatchRequest(tcp_connection::pointer connection, const string &request, const nlohmann::json &json) {
+        if (request == JSON::VALUE::REQUEST_REPLICATE) {
+            this->startReplication(connection, json);
+            return;
+        }
+
+        if (request == JSON::VALUE::REQUEST_REPLICATE_ACK) {
+            const auto found = this->replicas.find(connection->getUUID());
+            if (found == this->replicas.end()) {
+                this->sendErrorStatus(connection, "replication not started");
+                return;
+            }
+
+            // acks answer nothing, they only let more records out
+            found->second.acked = std::min(json[JSON::KEY::POSITION].get<uint64_t>(), found->second.sent);
+            if (!this->sendReplicationRecords(found->second)) {
+                connection->disconnect();
+            }
+            return;
+        }
+
+        if (request == JSON::VALUE::REQUEST_SNAPSHOT) {
+            if (this->SaveSnapshot()) {
+                this->sendOkWrite(connection);
+            } else {
+                this->sendErrorStatus(connection, "snapshot is not configured or already running");
+            }
+            return;
+        }
+
+        if (request == JSON::VALUE::REQUEST_STATS) {
+            this->sendStats(connection);
+            return;
+        }
+
+        if (request == JSON::VALUE::REQUEST_WATCH || request == JSON::VALUE::REQUEST_UNWATCH) {
+            this->watchKeys(connection, request, json);
+            return;
+        }
+
+        if (request == JSON::VALUE::REQUEST_SCAN) {
+            this->scanValues(connection, json);
+            return;
+        }
+
+        if (request == JSON::VALUE::REQUEST_BEGIN) {
+            this->beginTransaction(connection);
+            return;
+        }
+
+        Transaction *transaction = nullptr;
+        if (json.contains(JSON::KEY::TXN)) {
+            if (request == JSON::VALUE::REQUEST_COMMIT) {
+                this->commitTransaction(connection, json);
+                return;
+            }
+
+            transaction = this->findTransaction(connection, json);
+            if (transaction == nullptr) {
+                return;
+            }
+
+            if (request == JSON::VALUE::REQUEST_ABORT) {
+                this->endTransaction(json[JSON::KEY::TXN].get<uint64_t>());
+                this->sendOkWrite(connection);
+                return;
+            }
+
+            if (request != JSON::VALUE::REQUEST_READ && request != JSON::VALUE::REQUEST_WRITE && request != JSON::VALUE::REQUEST_MGET) {
+                this->sendErrorStatus(connection, "only read/write/mget are supported inside a transaction");
+                return;
+            }
+
+            if (json.contains(JSON::KEY::TTL) || json.contains(JSON::KEY::IF_VERSION)) {
+                this->sendErrorStatus(connection, "fields " + JSON::KEY::TTL + " and " + JSON::KEY::IF_VERSION +
+                                                          " are not supported inside a transaction");
+                return;
+            }
+        } else if (request == JSON::VALUE::REQUEST_COMMIT || request == JSON::VALUE::REQUEST_ABORT) {
+            this->sendErrorStatus(connection, "field " + JSON::KEY::TXN + " not found");
+            return;
+        }
+
+        if (request == JSON::VALUE::REQUEST_MGET) {
+            this->readValues(connection, json, transaction);
+            return;
+        }
+
+        if (request == JSON::VALUE::REQUEST_MPUT) {
+            this->writeValues(connection, json);
+            return;
+        }
+
+        if (!json.contains(JSON::KEY::KEY)) {
+            this->sendErrorStatus(connection, "field " + JSON::KEY::KEY + " not found");
+            return;
+        }
+
+        const std::string key = json[JSON::KEY::KEY].get<string>();
+
+        if (request == JSON::VALUE::REQUEST_EXPIRE || request == JSON::VALUE::REQUEST_PERSIST) {
+            std::chrono::milliseconds ttl(0);
+            if (request == JSON::VALUE::REQUEST_EXPIRE) {
+                if (!json.contains(JSON::KEY::TTL)) {
+                    this->sendErrorStatus(connection, "field " + JSON::KEY::TTL + " not found");
+                    return;
+                }
+
+                if (!this->readTtl(connection, json, ttl)) {
+                    return;
+                }
+            }
+
+            if (this->readValue(key) == nullptr) {
+                this->sendErrorStatus(connection, "key not found in storage");
+                return;
+            }
+
+            // ttl stays 0 for persist
+            this->setDeadline(key, ttl, [this, connection](bool durable) {
+                if (durable) {
+                    this->sendOkWrite(connection);
+                } else {
+                    this->sendErrorStatus(connection, "write-ahead log failure");
+                }
+            });
+            return;
+        }
+
+        if (request == JSON::VALUE::REQUEST_INCR || request == JSON::VALUE::REQUEST_DECR) {
+            this->incrementValue(connection, key, json, request == JSON::VALUE::REQUEST_DECR);
+            return;
+        }
+
+        if (request == JSON::VALUE::REQUEST_CAS) {
+            this->compareAndSwapValue(connection, key, json);
+            return;
+        }
+
+        if (request == JSON::VALUE::REQUEST_APPEND) {
+            this->appendValue(connection, key, json);
+            return;
+        }
+
+        if (request == JSON::VALUE::REQUEST_READ)
+        {
+            uint64_t ifVersion = 0;
+            const bool conditional = json.contains(JSON::KEY::IF_VERSION);
+            if (conditional) {
+                ifVersion = json[JSON::KEY::IF_VERSION].get<uint64_t>();
+            }
+            this->serveRead(connection, key, conditional ? &ifVersion : nullptr, transaction);
+
+        } else if (request == JSON::VALUE::REQUEST_WRITE)
+        {
+            if (!json.contains(JSON::KEY::VALUE)) {
+                this->sendErrorStatus(connection, "field " + JSON::KEY::VALUE + " not found");
+                return;
+            }
+
+            if (transaction != nullptr) {
+                // buffered, checked and applied at commit
+                if (transaction->writes.size() >= MAX_BATCH_SIZE && transaction->writes.count(key) == 0) {
+                    this->sendErrorStatus(connection, "at most " + std::to_string(MAX_BATCH_SIZE) + " keys written per transaction");
+                    return;
+                }
+
+                transaction->writes[key] = json[JSON::KEY::VALUE].get<string>();
+                this->sendOkWrite(connection);
+                return;
+            }
+
+            std::chrono::milliseconds ttl(0);
+            if (json.contains(JSON::KEY::TTL) && !this->readTtl(connection, json, ttl)) {
+                return;
+            }
+
+            uint64_t ifVersion = 0;
+            const bool conditional = json.contains(JSON::KEY::IF_VERSION);
+            if (conditional && !this->readIfVersion(connection, json, ifVersion)) {
+                return;
+            }
+
+            std::string value = json[JSON::KEY::VALUE].get<string>();
+            this->serveWrite(connection, key, value, ttl, conditional ? &ifVersion : nullptr);
+
+        } else {
+            this->sendErrorStatus(connection, "request must be read/write/mget/mput/incr/decr/cas/append/begin/commit/abort/scan/expire/persist/stats/snapshot/replicate");
+        }
+    }
+
+    void StorageServer::handle_resp_accept(tcp_connection::pointer connection) {
+        this->logger->LogInfo("server | accept resp connection with uuid: " + connection->getUUID());
+        this->respSessions[connection->getUUID()];
+
+        // answers of a read go out in one send already, they must not wait for the client's ack
+        boost::system::error_code ignored;
+        connection->socket().set_option(tcp::no_delay(true), ignored);
+    }
+
+    void StorageServer::handle_resp_disconnect(tcp_connection::pointer connection) {
+        this->logger->LogInfo("server | resp client disconnected | uuid: " + connection->getUUID());
+        this->respSessions.erase(connection->getUUID());
+    }
+
+    void StorageServer::handle_resp_message(tcp_connection::pointer connection, std::string msg) {
+        const auto found = this->respSessions.find(connection->getUUID());
+        if (found == this->respSessions.end() || found->second.closing) {
+            return;
+        }
+
+        // every command the read completed is served before any answer goes out
+        RespSession &session = found->second;
+        this->respSession = &session;
+        this->respConnection = connection.get();
+
+        session.parser.feed(msg);
+        while (!session.closing) {
+            const resp_parse status = session.parser.next();
+            if (status == resp_parse::Incomplete) {
+                break;
+            }
+
+            // the sequence number stands in for the request id, deferred answers find their place by it
+            this->requestId = session.replies.begin();
+            if (status == resp_parse::Error) {
+                this->respAnswer.clear();
+                resp_error(this->respAnswer, "ERR " + session.parser.getError());
+                this->reply(connection, this->respAnswer);
+                session.closing = true;
+                break;
+            }
+
+            try {
+                this->serveResp(connection, session, session.parser.getArgs());
+            } catch (...) {
+                this->sendErrorStatus(connection, "internal error");
+            }
+        }
+        session.parser.finish();
+
+        this->respSession = nullptr;
+        this->respConnection = nullptr;
+        this->requestId = 0;
+
+        // may close the connection, the session goes with it
+        this->flushResp(connection, session);
+    }
+
+    void StorageServer::flushResp(tcp_connection::pointer connection, RespSession &session) {
+        if (!session.replies.ready().empty()) {
+            connection->send(session.replies.ready());
+            session.replies.sent();
+        }
+
+        if (session.closing && session.replies.waiting() == 0) {
+            connection->disconnectAfterSend();
+        }
+    }
+
+    void StorageServer::serveResp(tcp_connection::pointer connection, RespSession &session, const std::vector<string_view> &args) {
+        string &answer = this->respAnswer;
+        answer.clear();
+
+        const RespCommandInfo *info = resp_command_lookup(args[0]);
+        if (info == nullptr) {
+            resp_error(answer, "ERR unknown command '" + string(args[0]) + "'");
+        } else if (!resp_arity_ok(*info, args.size()) || (info->command == resp_command::Ping && args.size() > 2) ||
+                   (info->command == resp_command::MSet && args.size() % 2 == 0)) {
+            resp_error(answer, string("ERR wrong number of arguments for '") + info->name + "' command");
+        } else if (info->write && this->replica != nullptr) {
+            resp_error(answer, "READONLY You can't write against a read only replica.");
+        } else if (info->write && !std::all_of(args.begin() + 1, args.end(), valid_utf8)) {
+            // watchers, replicas and native clients get keys and values as JSON strings
+            resp_error(answer, "ERR keys and values must be valid UTF-8");
+        }
+
+        if (!answer.empty()) {
+            this->reply(connection, answer);
+            return;
+        }
+
+        // the engines take keys as strings, this one keeps its capacity
+        string &key = this->parsedKey;
+        if (args.size() > 1) {
+            key.assign(args[1]);
+        }
+
+        int64_t number = 0;
+        value_pointer value;
+        switch (info->command) {
+            case resp_command::Ping:
+                if (args.size() == 1) {
+                    resp_simple(answer, "PONG");
+                } else {
+                    resp_bulk(answer, args[1]);
+                }
+                break;
+
+            case resp_command::Echo:
+                resp_bulk(answer, args[1]);
+                break;
+
+            case resp_command::Quit:
+                resp_simple(answer, "OK");
+                session.closing = true;
+                break;
+
+            case resp_command::Select:
+                // one keyspace
+                if (args[1] == "0") {
+                    resp_simple(answer, "OK");
+                } else {
+                    resp_error(answer, "ERR DB index is out of range");
+                }
+                break;
+
+            case resp_command::Command:
+                // clients ask for the command table on connect, none is fine
+                resp_array(answer, 0);
+                break;
+
+            case resp_command::Config:
+                if (resp_is(args[1], "get")) {
+                    resp_array(answer, 0);
+                } else {
+                    resp_error(answer, "ERR CONFIG " + string(args[1]) + " is not supported");
+                }
+                break;
+
+            case resp_command::Client:
+                if (resp_is(args[1], "setname") || resp_is(args[1], "setinfo")) {
+                    resp_simple(answer, "OK");
+                } else {
+                    resp_error(answer, "ERR CLIENT " + string(args[1]) + " is not supported");
+                }
+                break;
+
+            case resp_command::Info:
+                this->respInfo();
+                break;
+
+            case resp_command::DbSize:
+                resp_integer(answer, static_cast<int64_t>(this->dataStorage->size()));
+                break;
+
+            case resp_command::Get:
+                this->hotKeys->record(key, false);
+                value = this->readValue(key);
+                if (value == nullptr) {
+                    this->readMisses++;
+                    resp_null(answer);
+                } else {
+                    this->readHits++;
+                    resp_bulk(answer, *value);
+                }
+                break;
+
+            case resp_command::StrLen:
+                value = this->readValue(key);
+                resp_integer(answer, value != nullptr ? static_cast<int64_t>(value->size()) : 0);
+                break;
+
+            case resp_command::Exists:
+                // a key named twice counts twice, as in Redis
+                for (size_t i = 1; i < args.size(); i++) {
+                    key.assign(args[i]);
+                    number += this->readValue(key) != nullptr ? 1 : 0;
+                }
+                resp_integer(answer, number);
+                break;
+
+            case resp_command::MGet:
+                this->respMultiGet(connection, args);
+                return;
+
+            case resp_command::Set:
+            case resp_command::SetNx:
+            case resp_command::SetEx:
+            case resp_command::PSetEx:
+                this->respSet(connection, info->command, args);
+                return;
+
+            case resp_command::MSet: {
+                if (args.size() / 2 > MAX_BATCH_SIZE) {
+                    resp_error(answer, "ERR at most " + std::to_string(MAX_BATCH_SIZE) + " pairs per command");
+                    break;
+                }
+
+                StorageEngine::record_batch records;
+                records.reserve(args.size() / 2);
+                for (size_t i = 1; i + 1 < args.size(); i += 2) {
+                    records.emplace_back(string(args[i]), string(args[i + 1]));
+                }
+                this->writeRecords(connection, records);
+                return;
+            }
+
+            case resp_command::Del:
+                this->respDelete(connection, args);
+                return;
+
+            case resp_command::Incr:
+            case resp_command::Decr:
+                this->respIncrement(connection, key, info->command == resp_command::Incr ? 1 : -1);
+                return;
+
+            case resp_command::IncrBy:
+            case resp_command::DecrBy:
+                if (!parse_int64(args[2], number) || (info->command == resp_command::DecrBy && number == std::numeric_limits<int64_t>::min())) {
+                    resp_error(answer, "ERR value is not an integer or out of range");
+                    break;
+                }
+                this->respIncrement(connection, key, info->command == resp_command::IncrBy ? number : -number);
+                return;
+
+            case resp_command::Append:
+                this->respAppend(connection, key, args[2]);
+                return;
+
+            case resp_command::Expire:
+            case resp_command::PExpire:
+                if (!parse_int64(args[2], number) ||
+                    (info->command == resp_command::Expire && (number > MAX_RESP_EXPIRE_SECONDS || number < -MAX_RESP_EXPIRE_SECONDS))) {
+                    resp_error(answer, "ERR value is not an integer or out of range");
+                    break;
+                }
+
+                if (this->readValue(key) == nullptr) {
+                    resp_integer(answer, 0);
+                    break;
+                }
+
+                // a deadline already passed deletes the key, as in Redis; answered once the removal is logged, as DEL is
+                if (number <= 0) {
+                    this->removeValue(key, this->resume([this, connection](bool written) {
+                        if (!written) {
+                            this->sendErrorStatus(connection, "write-ahead log failure");
+                            return;
+                        }
+
+                        this->respAnswer.clear();
+                        resp_integer(this->respAnswer, 1);
+                        this->reply(connection, this->respAnswer);
+                    }));
+                    this->setDeadline(key, 0ms);
+                    return;
+                }
+
+                this->setDeadline(key, std::chrono::milliseconds(info->command == resp_command::Expire ? number * 1000 : number));
+                resp_integer(answer, 1);
+                break;
+
+            case resp_command::Persist:
+                resp_integer(answer, this->readValue(key) != nullptr && this->setDeadline(key, 0ms) ? 1 : 0);
+                break;
+
+            case resp_command::Ttl:
+            case resp_command::PTtl:
+                if (this->readValue(key) == nullptr) {
+                    resp_integer(answer, -2);
+                    break;
+                }
+
+                number = this->expiry.remaining(key).count();
+                if (number >= 0 && info->command == resp_command::Ttl) {
+                    number = (number + 500) / 1000;
+                }
+                resp_integer(answer, number);
+                break;
+        }
+
+        this->reply(connection, answer);
+    }
+
+    void StorageServer::respSet(tcp_connection::pointer connection, resp_command command, const std::vector<string_view> &args) {
+        string &answer = this->respAnswer;
+        const bool timed = command == resp_command::SetEx || command == resp_command::PSetEx;
+        bool hasTtl = timed;
+        string_view ttlText = timed ? args[2] : string_view();
+        bool milliseconds = command == resp_command::PSetEx;
+        bool ifMissing = command == resp_command::SetNx;
+        bool ifExists = false;
+        bool keepTtl = false;
+
+        // SET key value [EX seconds | PX milliseconds | KEEPTTL] [NX | XX]
+        for (size_t i = 3; command == resp_command::Set && i < args.size(); i++) {
+            if ((resp_is(args[i], "ex") || resp_is(args[i], "px")) && !hasTtl && !keepTtl && i + 1 < args.size()) {
+                milliseconds = resp_is(args[i], "px");
+                hasTtl = true;
+                ttlText = args[++i];
+            } else if (resp_is(args[i], "keepttl") && !hasTtl) {
+                keepTtl = true;
+            } else if (resp_is(args[i], "nx") && !ifExists) {
+                ifMissing = true;
+            } else if (resp_is(args[i], "xx") && !ifMissing) {
+                ifExists = true;
+            } else {
+                resp_error(answer, "ERR syntax error");
+                this->reply(connection, answer);
+                return;
+            }
+        }
+
+        int64_t ttl = 0;
+        if (hasTtl) {
+            if (!parse_int64(ttlText, ttl) || (!milliseconds && ttl > MAX_RESP_EXPIRE_SECONDS)) {
+                resp_error(answer, "ERR value is not an integer or out of range");
+                this->reply(connection, answer);
+                return;
+            }
+
+            if (ttl <= 0) {
+                resp_error(answer, string("ERR invalid expire time in '") + resp_command_lookup(args[0])->name + "' command");
+                this->reply(connection, answer);
+                return;
+            }
+        }
+
+        const string &key = this->parsedKey;
+        string value(timed ? args[3] : args[2]);
+        const std::chrono::milliseconds expireIn(milliseconds ? ttl : ttl * 1000);
+
+        // a plain write makes the key persistent again
+        const std::chrono::milliseconds *deadline = expireIn.count() > 0 || !keepTtl ? &expireIn : nullptr;
+
+        if (!ifMissing && !ifExists) {
+            this->writeValue(connection, key, value, nullptr, deadline);
+        } else {
+            // the condition is checked and the value written in one engine update
+            const bool counted = command == resp_command::SetNx;
+            this->updateValue(connection, key, [&value, ifMissing, ifExists](bool exists, string_view, uint64_t, string &updated) {
+                if ((ifMissing && exists) || (ifExists && !exists)) {
+                    return false;
+                }
+
+                updated.swap(value);
+                return true;
+            }, [this, connection, counted](bool written, uint64_t) {
+                this->respAnswer.clear();
+                if (counted) {
+                    resp_integer(this->respAnswer, written ? 1 : 0);
+                } else if (written) {
+                    resp_simple(this->respAnswer, "OK");
+                } else {
+                    resp_null(this->respAnswer);
+                }
+                this->reply(connection, this->respAnswer);
+            }, deadline);
+        }
+    }
+
+    void StorageServer::respIncrement(tcp_connection::pointer connection, const string &key, int64_t by) {
+        const auto answer = std::make_shared<string>();
+        this->updateValue(connection, key, [&answer, by](bool exists, string_view current, uint64_t, string &updated) {
+            // a missing key counts from zero
+            int64_t value = 0;
+            if (exists && !parse_int64(current, value)) {
+                resp_error(*answer, "ERR value is not an integer or out of range");
+                return false;
+            }
+
+            if ((by > 0 && value > std::numeric_limits<int64_t>::max() - by) ||
+                (by < 0 && value < std::numeric_limits<int64_t>::min() - by)) {
+                resp_error(*answer, "ERR increment or decrement would overflow");
+                return false;
+            }
+
+            updated = std::to_string(value + by);
+            resp_integer(*answer, value + by);
+            return true;
+        }, [this, connection, answer](bool, uint64_t) { this->reply(connection, *answer); });
+    }
+
+    void StorageServer::respAppend(tcp_connection::pointer connection, const string &key, string_view tail) {
+        const auto answer = std::make_shared<string>();
+        this->updateValue(connection, key, [&answer, tail](bool, string_view current, uint64_t, string &updated) {
+            updated.reserve(current.size() + tail.size());
+            updated.assign(current);
+            updated.append(tail);
+            resp_integer(*answer, static_cast<int64_t>(updated.size()));
+            return true;
+        }, [this, connection, answer](bool, uint64_t) { this->reply(connection, *answer); });
+    }
+
+    void StorageServer::respDelete(tcp_connection::pointer connection, const std::vector<string_view> &args) {
+        string &key = this->parsedKey;
+
+        // the answer waits for the last removal, the log makes it durable after the ones before
+        size_t last = 0;
+        int64_t removed = 0;
+        for (size_t i = 1; i < args.size(); i++) {
+            key.assign(args[i]);
+            if (this->readValue(key) != nullptr) {
+                last = i;
+                removed++;
+            }
+        }
+
+        if (removed == 0) {
+            this->respAnswer.clear();
+            resp_integer(this->respAnswer, 0);
+            this->reply(connection, this->respAnswer);
+            return;
+        }
+
+        for (size_t i = 1; i <= last; i++) {
+            key.assign(args[i]);
+            if (this->readValue(key) == nullptr) {
+                continue;
+            }
+
+            StorageEngine::durable_callback durable;
+            if (i == last) {
+                durable = this->resume([this, connection, removed](bool written) {
+                    if (!written) {
+                        this->sendErrorStatus(connection, "write-ahead log failure");
+                        return;
+                    }
+
+                    this->respAnswer.clear();
+                    resp_integer(this->respAnswer, removed);
+                    this->reply(connection, this->respAnswer);
+                });
+            }
+
+            this->removeValue(key, durable);
+            this->setDeadline(key, 0ms);
+        }
+    }
+
+    void StorageServer::respMultiGet(tcp_connection::pointer connection, const std::vector<string_view> &args) {
+        string &answer = this->respAnswer;
+        if (args.size() - 1 > MAX_BATCH_SIZE) {
+            resp_error(answer, "ERR at most " + std::to_string(MAX_BATCH_SIZE) + " keys per command");
+            this->reply(connection, answer);
+            return;
+        }
+
+        // one engine call for the batch, missing and expired keys answer null
+        std::vector<string> keys(args.begin() + 1, args.end());
+        const std::vector<value_pointer> values = this->dataStorage->multiGet(keys);
+
+        resp_array(answer, keys.size());
+        for (size_t i = 0; i < keys.size(); i++) {
+            this->hotKeys->record(keys[i], false);
+            if (values[i] != nullptr && !this->expiry.expired(keys[i])) {
+                this->readHits++;
+                resp_bulk(answer, *(values[i]));
+            } else {
+                this->readMisses++;
+                resp_null(answer);
+            }
+        }
+
+        this->reply(connection, answer);
+    }
+
+    void StorageServer::respInfo() {
+        string info = "# Server\r\nserver:diginext\r\nresp_version:2\r\n\r\n# Stats\r\n";
+        info += "keyspace_hits:" + std::to_string(this->readHits) + "\r\n";
+        info += "keyspace_misses:" + std::to_string(this->readMisses) + "\r\n";
+        info += "expired_keys:" + std::to_string(this->expiredKeys) + "\r\n";
+        info += "\r\n# Replication\r\nrole:" + string(this->replica != nullptr ? "slave" : "master") + "\r\n";
+        info += "\r\n# Keyspace\r\ndb0:keys=" + std::to_string(this->dataStorage->size()) + ",expires=" + std::to_string(this->expiry.size()) + "\r\n";
+        resp_bulk(this->respAnswer, info);
+    }
+
+    void StorageServer::handle_read_error(tcp_connection::pointer connection, const boost::system::error_code error, size_t bytes_transferred) {
+        this->logger->LogInfo("server | msg read error | uuid: " + connection->getUUID() + " | error: " + error.message());
+    }
+
+    void StorageServer::handle_send_error(tcp_connection::pointer connection, const boost::system::error_code error, size_t bytes_transferred) {
+        this->logger->LogInfo("server | msg send error | uuid: " + connection->getUUID() + " | error: " + error.message());
+    }
+
+    void StorageServer::handle_expiry_timer(const boost::system::error_code &error) {
+        if (error == boost::asio::error::operation_aborted) {
+            return;
+        }
+
+        const bool more = this->expiry.collect(EXPIRY_BATCH, [this](const string &key) {
+            // a follower keeps the key hidden, the leader's stream removes it or gives it a new value
+            if (this->replica != nullptr) {
+                this->expiry.hold(key);
+                return;
+            }
+
+            this->removeValue(key);
+            this->expiredKeys++;
+
+            // the remove record tells the write-ahead log, the engine's own log does not know of deadlines
+            if (this->deadlineLog != nullptr) {
+                this->deadlineLog->append(WalRecordType::Expire, key, string());
+            }
+        });
+
+        // a large expiry wave is reclaimed in batches, requests are served in between
+        this->scheduleExpiry(more ? 0ms : this->expiry.getTick());
+    }
+
+    void StorageServer::handle_watch_timer(const boost::system::error_code &error) {
+        if (error == boost::asio::error::operation_aborted) {
+            return;
+        }
+
+        this->watchFlushPending = false;
+        if (this->watches->flushOverflows()) {
+            this->scheduleWatchFlush();
+        }
     }
 }// namespace Diginext::Core::Storage
\ No newline at end of file
@@ -0,0 +1,124 @@
+#include "Storage/TimingWheel.h"
+
+#include <utility>
+
+namespace Diginext::Core::Storage {
+
+    TimingWheel::TimingWheel(uint64_t currentTick) {
+        this->current = currentTick;
+        this->count = 0;
+        for (size_t level = 0; level < LEVEL_COUNT; level++) {
+            this->levelCounts[level] = 0;
+        }
+    }
+
+    void TimingWheel::schedule(const string &key, uint64_t deadline) {
+        this->place(Timer{ key, deadline });
+        this->count++;
+    }
+
+    void TimingWheel::place(Timer &&timer) {
+        if (timer.deadline <= this->current) {
+            this->due.push_back(std::move(timer));
+            return;
+        }
+
+        // the lowest level whose span still reaches the deadline
+        const uint64_t delta = timer.deadline - this->current;
+        for (size_t level = 0; level < LEVEL_COUNT; level++) {
+            if (delta < (uint64_t(1) << (SLOT_BITS * (level + 1)))) {
+                const size_t slot = static_cast<size_t>(timer.deadline >> (SLOT_BITS * level)) & (SLOT_COUNT - 1);
+                this->slots[level][slot].push_back(std::move(timer));
+                this->levelCounts[level]++;
+                return;
+            }
+        }
+
+        this->overflow.push_back(std::move(timer));
+    }
+
+    void TimingWheel::cascade(size_t level) {
+        if (level == LEVEL_COUNT) {
+            std::vector<Timer> timers;
+            timers.swap(this->overflow);
+            for (auto &timer : timers) {
+                this->place(std::move(timer));
+            }
+            return;
+        }
+
+        const size_t slot = static_cast<size_t>(this->current >> (SLOT_BITS * level)) & (SLOT_COUNT - 1);
+        std::vector<Timer> timers;
+        timers.swap(this->slots[level][slot]);
+        this->levelCounts[level] -= timers.size();
+        for (auto &timer : timers) {
+            this->place(std::move(timer));
+        }
+    }
+
+    size_t TimingWheel::advance(uint64_t tick, size_t budget, const expire_callback &callback) {
+        while (this->current < tick && this->count > this->due.size()) {
+            // levels below the first occupied one have nothing to fire or cascade
+            // until its next boundary, jump right before it
+            size_t occupied = 0;
+            while (occupied < LEVEL_COUNT && this->levelCounts[occupied] == 0) {
+                occupied++;
+            }
+
+            if (occupied > 0) {
+                const uint64_t last = this->current | ((uint64_t(1) << (SLOT_BITS * occupied)) - 1);
+                if (last >= tick) {
+                    this->current = tick;
+                    break;
+                }
+                this->current = last;
+            }
+
+            this->current++;
+
+            // upper levels first: a cascaded timer may land in the level 0 slot of this tick
+            size_t levels = 1;
+            while (levels <= LEVEL_COUNT && (this->current & ((uint64_t(1) << (SLOT_BITS * levels)) - 1)) == 0) {
+                levels++;
+            }
+            for (size_t level = levels - 1; level >= 1; level--) {
+                this->cascade(level);
+            }
+
+            auto &slot = this->slots[0][this->current & (SLOT_COUNT - 1)];
+            for (auto &timer : slot) {
+                this->due.push_back(std::move(timer));
+            }
+            this->levelCounts[0] -= slot.size();
+            slot.clear();
+        }
+
+        // nothing left to turn for, jump straight to tick
+        if (this->current < tick) {
+            this->current = tick;
+        }
+
+        size_t fired = 0;
+        while (fired < budget && !this->due.empty()) {
+            Timer timer = std::move(this->due.front());
+            this->due.pop_front();
+            this->count--;
+            fired++;
+            callback(timer);
+        }
+
+        return fired;
+    }
+
+    size_t TimingWheel::getDueCount() const {
+        return this->due.size();
+    }
+
+    size_t TimingWheel::size() const {
+        return this->count;
+    }
+
+    uint64_t TimingWheel::getCurrentTick() const {
+        return this->current;
+    }
+}// namespace Diginext::Core::Storage
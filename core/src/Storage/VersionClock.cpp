@@ -0,0 +1,32 @@
+#include "Storage/VersionClock.h"
+
+#include <algorithm>
+#include <chrono>
+
+namespace Diginext::Core::Storage {
+
+    VersionClock::VersionClock() : last(now()) {
+    }
+
+    uint64_t VersionClock::next() {
+        const uint64_t wall = now();
+        uint64_t previous = this->last.load(std::memory_order_relaxed);
+        uint64_t version;
+        // sequentially consistent: snapshots rely on a version drawn before a snapshot counter
+        // check being smaller than a snapshot drawn after the counter was raised
+        do {
+            version = std::max(previous + 1, wall);
+        } while (!this->last.compare_exchange_weak(previous, version, std::memory_order_seq_cst, std::memory_order_relaxed));
+
+        return version;
+    }
+
+    uint64_t VersionClock::current() const {
+        return this->last.load(std::memory_order_relaxed);
+    }
+
+    uint64_t VersionClock::now() {
+        const auto elapsed = std::chrono::system_clock::now().time_since_epoch();
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count());
+    }
+}// namespace Diginext::Core::Storage
@@ -0,0 +1,285 @@
+#include "Storage/WatchRegistry.h"
+
+#include "Storage/StorageCommon.h"
+
+#include <algorithm>
+
+#include <nlohmann/json.hpp>
+
+namespace Diginext::Core::Storage {
+    bool watch_overflow_policy_from_string(const string &name, WatchOverflowPolicy &policy) {
+        if (name == "drop") {
+            policy = WatchOverflowPolicy::Drop;
+        } else if (name == "disconnect") {
+            policy = WatchOverflowPolicy::Disconnect;
+        } else {
+            return false;
+        }
+
+        return true;
+    }
+
+    string watch_overflow_policy_to_string(WatchOverflowPolicy policy) {
+        switch (policy) {
+            case WatchOverflowPolicy::Drop:
+                return "drop";
+            case WatchOverflowPolicy::Disconnect:
+                return "disconnect";
+        }
+
+        return "unknown";
+    }
+
+    WatchRegistry::WatchRegistry(size_t queueLimit, WatchOverflowPolicy policy) {
+        this->queueLimit = queueLimit;
+        this->policy = policy;
+        this->subscriptionCount = 0;
+        this->eventSeq = 0;
+        this->eventsSent = 0;
+        this->eventsDropped = 0;
+        this->disconnects = 0;
+    }
+
+    bool WatchRegistry::watch(const tcp_connection::pointer &connection, const string &pattern, bool prefix) {
+        auto &watcher = this->watchers[connection->getUUID()];
+        if (watcher == nullptr) {
+            watcher = std::make_unique<Watcher>();
+            watcher->connection = connection;
+        }
+
+        auto &subscribers = (prefix ? this->prefixes : this->keys)[pattern];
+        if (std::find(subscribers.begin(), subscribers.end(), watcher.get()) != subscribers.end()) {
+            return false;
+        }
+
+        subscribers.push_back(watcher.get());
+        if (prefix && subscribers.size() == 1) {
+            this->prefixLengths[pattern.size()]++;
+        }
+
+        watcher->subscriptions++;
+        this->subscriptionCount++;
+        return true;
+    }
+
+    void WatchRegistry::unlink(subscription_map &map, const string &pattern, Watcher *watcher) {
+        const auto found = map.find(pattern);
+        if (found == map.end()) {
+            return;
+        }
+
+        auto &subscribers = found->second;
+        subscribers.erase(std::remove(subscribers.begin(), subscribers.end(), watcher), subscribers.end());
+        if (subscribers.empty()) {
+            map.erase(found);
+        }
+    }
+
+    bool WatchRegistry::unwatch(const string &uuid, const string &pattern, bool prefix) {
+        const auto found = this->watchers.find(uuid);
+        if (found == this->watchers.end()) {
+            return false;
+        }
+
+        Watcher *watcher = found->second.get();
+        auto &map = prefix ? this->prefixes : this->keys;
+        const auto subscribers = map.find(pattern);
+        if (subscribers == map.end() ||
+            std::find(subscribers->second.begin(), subscribers->second.end(), watcher) == subscribers->second.end()) {
+            return false;
+        }
+
+        unlink(map, pattern, watcher);
+        if (prefix && map.find(pattern) == map.end() && --this->prefixLengths[pattern.size()] == 0) {
+            this->prefixLengths.erase(pattern.size());
+        }
+
+        this->subscriptionCount--;
+        if (--watcher->subscriptions == 0) {
+            this->drop(uuid);
+        }
+        return true;
+    }
+
+    void WatchRegistry::drop(const string &uuid) {
+        this->watchers.erase(uuid);
+        this->overflowed.erase(std::remove(this->overflowed.begin(), this->overflowed.end(), uuid), this->overflowed.end());
+    }
+
+    void WatchRegistry::remove(const string &uuid) {
+        const auto found = this->watchers.find(uuid);
+        if (found == this->watchers.end()) {
+            return;
+        }
+
+        // a disconnect is rare next to events, a full pass over the subscriptions is fine
+        Watcher *watcher = found->second.get();
+        for (auto *map : { &this->keys, &this->prefixes }) {
+            for (auto entry = map->begin(); entry != map->end();) {
+                auto &subscribers = entry->second;
+                const auto end = std::remove(subscribers.begin(), subscribers.end(), watcher);
+                this->subscriptionCount -= static_cast<size_t>(subscribers.end() - end);
+                subscribers.erase(end, subscribers.end());
+
+                if (!subscribers.empty()) {
+                    ++entry;
+                    continue;
+                }
+
+                if (map == &this->prefixes && --this->prefixLengths[entry->first.size()] == 0) {
+                    this->prefixLengths.erase(entry->first.size());
+                }
+                entry = map->erase(entry);
+            }
+        }
+
+        this->drop(uuid);
+    }
+
+    size_t WatchRegistry::watches(const string &uuid) const {
+        const auto found = this->watchers.find(uuid);
+        return found == this->watchers.end() ? 0 : found->second->subscriptions;
+    }
+
+    bool WatchRegistry::empty() const {
+        return this->subscriptionCount == 0;
+    }
+
+    void WatchRegistry::collect(const std::vector<Watcher *> &subscribers) {
+        for (Watcher *watcher : subscribers) {
+            if (watcher->lastEvent != this->eventSeq) {
+                watcher->lastEvent = this->eventSeq;
+                this->matched.push_back(watcher);
+            }
+        }
+    }
+
+    bool WatchRegistry::sendOverflow(Watcher &watcher) {
+        // only once the backlog is half gone, or the notice would overflow right away
+        if (watcher.connection->getQueuedBytes() > this->queueLimit / 2) {
+            return false;
+        }
+
+        nlohmann::json event;
+        event[JSON::KEY::EVENT] = JSON::VALUE::EVENT_OVERFLOW;
+        event[JSON::KEY::DROPPED] = watcher.dropped;
+        watcher.connection->send(event.dump());
+        watcher.dropped = 0;
+        return true;
+    }
+
+    std::vector<tcp_connection::pointer> WatchRegistry::notify(const string &key, const string *value) {
+        std::vector<tcp_connection::pointer> slow;
+        if (this->subscriptionCount == 0) {
+            return slow;
+        }
+
+        this->eventSeq++;
+        this->matched.clear();
+
+        const auto exact = this->keys.find(key);
+        if (exact != this->keys.end()) {
+            this->collect(exact->second);
+        }
+
+        for (const auto &length : this->prefixLengths) {
+            if (length.first > key.size()) {
+                break;
+            }
+
+            const auto prefix = this->prefixes.find(key.substr(0, length.first));
+            if (prefix != this->prefixes.end()) {
+                this->collect(prefix->second);
+            }
+        }
+
+        if (this->matched.empty()) {
+            return slow;
+        }
+
+        // one encode per framing for every subscriber
+        nlohmann::json event;
+        event[JSON::KEY::EVENT] = value != nullptr ? JSON::VALUE::EVENT_PUT : JSON::VALUE::EVENT_DELETE;
+        event[JSON::KEY::KEY] = key;
+        if (value != nullptr) {
+            event[JSON::KEY::VALUE] = *value;
+        }
+        const string payload = event.dump();
+        frame_pointer frames[TCP_FRAMING_COUNT];
+
+        for (Watcher *watcher : this->matched) {
+            if (watcher->dropped > 0 && !this->sendOverflow(*watcher)) {
+                watcher->dropped++;
+                this->eventsDropped++;
+                continue;
+            }
+
+            const tcp_framing framing = watcher->connection->getFraming();
+            frame_pointer &frame = frames[static_cast<size_t>(framing)];
+            if (frame == nullptr) {
+                frame = encode_frame(payload, framing);
+            }
+
+            if (watcher->connection->getQueuedBytes() + frame->size() > this->queueLimit) {
+                if (this->policy == WatchOverflowPolicy::Disconnect) {
+                    slow.push_back(watcher->connection);
+                    continue;
+                }
+
+                if (watcher->dropped++ == 0) {
+                    this->overflowed.push_back(watcher->connection->getUUID());
+                }
+                this->eventsDropped++;
+                continue;
+            }
+
+            watcher->connection->sendFrame(frame);
+            this->eventsSent++;
+        }
+
+        // unsubscribed after the loop, matched points into the watchers
+        for (const auto &connection : slow) {
+            this->remove(connection->getUUID());
+            this->disconnects++;
+        }
+
+        return slow;
+    }
+
+    bool WatchRegistry::flushOverflows() {
+        std::vector<string> waiting;
+        for (const auto &uuid : this->overflowed) {
+            const auto found = this->watchers.find(uuid);
+            if (found == this->watchers.end() || found->second->dropped == 0) {
+                continue;
+            }
+
+            if (!this->sendOverflow(*found->second)) {
+                waiting.push_back(uuid);
+            }
+        }
+
+        this->overflowed.swap(waiting);
+        return !this->overflowed.empty();
+    }
+
+    size_t WatchRegistry::getSubscriptions() const {
+        return this->subscriptionCount;
+    }
+
+    size_t WatchRegistry::getWatchers() const {
+        return this->watchers.size();
+    }
+
+    uint64_t WatchRegistry::getEventsSent() const {
+        return this->eventsSent;
+    }
+
+    uint64_t WatchRegistry::getEventsDropped() const {
+        return this->eventsDropped;
+    }
+
+    uint64_t WatchRegistry::getDisconnects() const {
+        return this->disconnects;
+    }
+}// namespace Diginext::Core::Storage
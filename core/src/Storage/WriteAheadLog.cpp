@@ -0,0 +1,377 @@
+#include "Storage/WriteAheadLog.h"
+
+#include "Checksum/Crc32.h"
+#include "Log/LogConsole.h"
+#include "Storage/StorageEncoding.h"
+#include "Storage/StorageFile.h"
+
+#include <stdexcept>
+
+namespace Diginext::Core::Storage {
+    const size_t RECORD_HEADER_SIZE = 8;
+    const size_t PAYLOAD_HEADER_SIZE = 5;
+    const size_t REPLAY_CHUNK_SIZE = 4 * 1024 * 1024;
+    const size_t FILE_BUFFER_SIZE = 1024 * 1024;
+
+    bool fsync_policy_from_string(const string &name, FsyncPolicy &policy) {
+        if (name == "always") {
+            policy = FsyncPolicy::Always;
+        } else if (name == "group") {
+            policy = FsyncPolicy::GroupCommit;
+        } else if (name == "async") {
+            policy = FsyncPolicy::Async;
+        } else {
+            return false;
+        }
+
+        return true;
+    }
+
+    string fsync_policy_to_string(FsyncPolicy policy) {
+        switch (policy) {
+            case FsyncPolicy::Always:
+                return "always";
+            case FsyncPolicy::GroupCommit:
+                return "group";
+            case FsyncPolicy::Async:
+                return "async";
+        }
+
+        return "unknown";
+    }
+
+    WriteAheadLog::pointer WriteAheadLog::create(const string &path, FsyncPolicy policy, std::chrono::microseconds groupCommitWindow) {
+        return std::make_shared<WriteAheadLog>(path, policy, groupCommitWindow);
+    }
+
+    WriteAheadLog::WriteAheadLog(const string &path, FsyncPolicy policy, std::chrono::microseconds groupCommitWindow) {
+        this->logger = ConsoleLogger::create("WriteAheadLog");
+        this->path = path;
+        this->policy = policy;
+        this->groupCommitWindow = groupCommitWindow;
+        this->asyncSyncInterval = std::chrono::milliseconds(1000);
+        this->file = nullptr;
+        this->appendedOffset = file_size(path);
+        this->writtenOffset = this->appendedOffset;
+        this->durableOffset = this->appendedOffset;
+        this->stopping = false;
+        this->syncRequested = false;
+    }
+
+    WriteAheadLog::~WriteAheadLog() {
+        try {
+            this->close();
+        } catch (...) {
+        }
+    }
+
+    void WriteAheadLog::encode(string &out, WalRecordType type, const string &key, const string &value) {
+        const size_t start = out.size();
+        const uint32_t payloadSize = static_cast<uint32_t>(PAYLOAD_HEADER_SIZE + key.size() + value.size());
+
+        out.reserve(start + RECORD_HEADER_SIZE + payloadSize);
+        put_fixed32(out, 0);
+        put_fixed32(out, payloadSize);
+        out.push_back(static_cast<char>(type));
+        put_fixed32(out, static_cast<uint32_t>(key.size()));
+        out.append(key);
+        out.append(value);
+
+        const uint32_t crc = Crc32::Compute(out.data() + start + RECORD_HEADER_SIZE, size_t(payloadSize));
+        set_fixed32(&out[start], crc);
+    }
+
+    size_t WriteAheadLog::replay(const replay_callback &apply, uint64_t fromOffset) {
+        FILE *input = std::fopen(this->path.c_str(), "rb");
+        if (input == nullptr) {
+            return 0;
+        }
+
+        size_t applied = 0;
+        uint64_t goodOffset = 0;
+        uint64_t bufferOffset = 0;// file offset of buffer[0]
+        string buffer;
+        string chunk(REPLAY_CHUNK_SIZE, '\0');
+        size_t position = 0;
+        bool corrupted = false;
+        bool eof = false;
+
+        while (true) {
+            while (buffer.size() - position >= RECORD_HEADER_SIZE) {
+                const char *header = buffer.data() + position;
+                const uint32_t crc = get_fixed32(header);
+                const uint32_t payloadSize = get_fixed32(header + 4);
+
+                if (payloadSize < PAYLOAD_HEADER_SIZE || payloadSize > MAX_RECORD_SIZE) {
+                    corrupted = true;
+                    break;
+                }
+
+                if (buffer.size() - position - RECORD_HEADER_SIZE < payloadSize) {
+                    break;// record continues in the next chunk
+                }
+
+                const char *payload = header + RECORD_HEADER_SIZE;
+                if (Crc32::Compute(payload, size_t(payloadSize)) != crc) {
+                    corrupted = true;
+                    break;
+                }
+
+                const uint32_t keySize = get_fixed32(payload + 1);
+                if (keySize > payloadSize - PAYLOAD_HEADER_SIZE) {
+                    corrupted = true;
+                    break;
+                }
+
+                if (bufferOffset + position >= fromOffset) {
+                    WalRecord record;
+                    record.type = static_cast<WalRecordType>(payload[0]);
+                    record.key.assign(payload + PAYLOAD_HEADER_SIZE, keySize);
+                    record.value.assign(payload + PAYLOAD_HEADER_SIZE + keySize, payloadSize - PAYLOAD_HEADER_SIZE - keySize);
+                    apply(record);
+                    applied++;
+                }
+
+                position += RECORD_HEADER_SIZE + payloadSize;
+                goodOffset = bufferOffset + position;
+            }
+
+            if (corrupted || eof) {
+                break;
+            }
+
+            // keep the unparsed tail, append next chunk
+            buffer.erase(0, position);
+            bufferOffset += position;
+            position = 0;
+
+            const size_t read = std::fread(&chunk[0], 1, chunk.size(), input);
+            buffer.append(chunk.data(), read);
+            eof = read < chunk.size();
+        }
+
+        std::fclose(input);
+
+        const uint64_t size = file_size(this->path);
+        if (goodOffset < size) {
+            this->logger->LogWarning("replay | dropping " + std::to_string(size - goodOffset) +
+                                     " bytes of torn or corrupted tail at offset " + std::to_string(goodOffset));
+            if (!file_truncate(this->path, goodOffset)) {
+                throw std::runtime_error("WriteAheadLog: cannot truncate " + this->path);
+            }
+        }
+
+        std::lock_guard<std::mutex> guard(this->sync);
+        this->appendedOffset = goodOffset;
+        this->writtenOffset = goodOffset;
+        this->durableOffset = goodOffset;
+        return applied;
+    }
+
+    void WriteAheadLog::open() {
+        std::lock_guard<std::mutex> guard(this->sync);
+        if (this->file != nullptr) {
+            return;
+        }
+
+        this->file = std::fopen(this->path.c_str(), "ab");
+        if (this->file == nullptr) {
+            throw std::runtime_error("WriteAheadLog: cannot open " + this->path);
+        }
+
+        std::setvbuf(this->file, nullptr, _IOFBF, FILE_BUFFER_SIZE);
+        this->stopping = false;
+        this->flusher = std::thread(&WriteAheadLog::flushLoop, this);
+    }
+
+    void WriteAheadLog::close() {
+        {
+            std::lock_guard<std::mutex> guard(this->sync);
+            if (this->file == nullptr) {
+                return;
+            }
+
+            this->stopping = true;
+        }
+
+        this->pendingCondition.notify_all();
+        if (this->flusher.joinable()) {
+            this->flusher.join();
+        }
+
+        std::lock_guard<std::mutex> guard(this->sync);
+        std::fclose(this->file);
+        this->file = nullptr;
+    }
+
+    bool WriteAheadLog::opened() const {
+        std::lock_guard<std::mutex> guard(this->sync);
+        return this->file != nullptr;
+    }
+
+    uint64_t WriteAheadLog::append(WalRecordType type, const string &key, const string &value,
+                                   durable_callback onDurable, const std::function<void()> &applyInOrder) {
+        uint64_t offset;
+        {
+            std::lock_guard<std::mutex> guard(this->sync);
+            if (this->file == nullptr || this->stopping) {
+                throw std::runtime_error("WriteAheadLog: append to closed log " + this->path);
+            }
+
+            const size_t before = this->pending.size();
+            encode(this->pending, type, key, value);
+            this->appendedOffset += this->pending.size() - before;
+            offset = this->appendedOffset;
+
+            if (applyInOrder) {
+                applyInOrder();
+            }
+
+            if (onDurable && this->policy != FsyncPolicy::Async) {
+                this->callbacks.push_back(std::move(onDurable));
+            }
+        }
+
+        this->pendingCondition.notify_one();
+
+        if (onDurable && this->policy == FsyncPolicy::Async) {
+            onDurable(true);
+        }
+
+        return offset;
+    }
+
+    uint64_t WriteAheadLog::appendBatch(const std::vector<std::pair<string, string>> &records,
+                                        durable_callback onDurable, const std::function<void()> &applyInOrder) {
+        uint64_t offset;
+        {
+            std::lock_guard<std::mutex> guard(this->sync);
+            if (this->file == nullptr || this->stopping) {
+                throw std::runtime_error("WriteAheadLog: append to closed log " + this->path);
+            }
+
+            const size_t before = this->pending.size();
+            for (const auto &record : records) {
+                encode(this->pending, WalRecordType::Put, record.first, record.second);
+            }
+            this->appendedOffset += this->pending.size() - before;
+            offset = this->appendedOffset;
+
+            if (applyInOrder) {
+                applyInOrder();
+            }
+
+            if (onDurable && this->policy != FsyncPolicy::Async) {
+                this->callbacks.push_back(std::move(onDurable));
+            }
+        }
+
+        this->pendingCondition.notify_one();
+
+        if (onDurable && this->policy == FsyncPolicy::Async) {
+            onDurable(true);
+        }
+
+        return offset;
+    }
+
+    void WriteAheadLog::waitDurable(uint64_t offset) {
+        std::unique_lock<std::mutex> lock(this->sync);
+        if (this->durableOffset >= offset) {
+            return;
+        }
+
+        // async policy would otherwise wait for the next background fsync
+        this->syncRequested = true;
+        this->pendingCondition.notify_one();
+        this->durableCondition.wait(lock, [this, offset]() {
+            return this->durableOffset >= offset || this->file == nullptr;
+        });
+    }
+
+    void WriteAheadLog::flushLoop() {
+        auto lastSync = std::chrono::steady_clock::now();
+        std::unique_lock<std::mutex> lock(this->sync);
+
+        while (true) {
+            const auto hasWork = [this]() { return this->stopping || this->syncRequested || !this->pending.empty(); };
+
+            if (this->policy == FsyncPolicy::Async && this->writtenOffset > this->durableOffset) {
+                this->pendingCondition.wait_until(lock, lastSync + this->asyncSyncInterval, hasWork);
+            } else {
+                this->pendingCondition.wait(lock, hasWork);
+            }
+
+            if (this->policy == FsyncPolicy::GroupCommit && !this->stopping && !this->pending.empty()) {
+                // commit window: let more writers join this fsync
+                this->pendingCondition.wait_for(lock, this->groupCommitWindow, [this]() {
+                    return this->stopping || this->pending.size() >= MAX_GROUP_BYTES;
+                });
+            }
+
+            string batch;
+            batch.swap(this->pending);
+            std::vector<durable_callback> batchCallbacks;
+            batchCallbacks.swap(this->callbacks);
+            const uint64_t batchEnd = this->appendedOffset;
+            const bool forceSync = this->syncRequested;
+            this->syncRequested = false;
+
+            lock.unlock();
+
+            bool success = true;
+            if (!batch.empty()) {
+                success = std::fwrite(batch.data(), 1, batch.size(), this->file) == batch.size();
+            }
+
+            const auto now = std::chrono::steady_clock::now();
+            const bool doSync = this->policy != FsyncPolicy::Async || forceSync || this->stopping || now - lastSync >= this->asyncSyncInterval;
+            if (doSync) {
+                success = file_sync(this->file) && success;
+                lastSync = now;
+            } else {
+                success = std::fflush(this->file) == 0 && success;
+            }
+
+            if (!success) {
+                this->logger->LogError("flush | write or fsync failed for " + this->path);
+            }
+
+            for (auto &callback : batchCallbacks) {
+                try {
+                    callback(success);
+                } catch (...) {
+                }
+            }
+
+            lock.lock();
+            this->writtenOffset = batchEnd;
+            if (doSync && success) {
+                this->durableOffset = batchEnd;
+            }
+            this->durableCondition.notify_all();
+
+            if (this->stopping && this->pending.empty()) {
+                break;
+            }
+        }
+    }
+
+    uint64_t WriteAheadLog::getAppendedOffset() const {
+        std::lock_guard<std::mutex> guard(this->sync);
+        return this->appendedOffset;
+    }
+
+    uint64_t WriteAheadLog::getDurableOffset() const {
+        std::lock_guard<std::mutex> guard(this->sync);
+        return this->durableOffset;
+    }
+
+    FsyncPolicy WriteAheadLog::getPolicy() const {
+        return this->policy;
+    }
+
+    string WriteAheadLog::getPath() const {
+        return this->path;
+    }
+}// namespace Diginext::Core::Storage
@@ -6,6 +6,59 @@ namespace Diginext::Core::TCP
 	bool _tcp_client_log_enabled = true;
 	bool _tcp_server_log_enabled = true;
 
+	bool tcp_framing_from_string(const std::string& name, tcp_framing& framing)
+	{
+		if (name == "base64")
+		{
+			framing = tcp_framing::Base64Line;
+		}
+		else if (name == "binary")
+		{
+			framing = tcp_framing::Binary;
+		}
+		else if (name == "compressed")
+		{
+			framing = tcp_framing::Compressed;
+		}
+		else
+		{
+			return false;
+		}
+
+		return true;
+	}
+
+	std::string tcp_framing_to_string(tcp_framing framing)
+	{
+		switch (framing)
+		{
+		case tcp_framing::Base64Line:
+			return "base64";
+		case tcp_framing::Binary:
+			return "binary";
+		case tcp_framing::Compressed:
+			return "compressed";
+		case tcp_framing::Raw:
+			return "raw";
+		}
+
+		return "unknown";
+	}
+
+	bool tcp_compression_available()
+	{
+#ifdef DIGINEXT_HAVE_ZLIB
+		return true;
+#else
+		return false;
+#endif
+	}
+
+	tcp_framing tcp_best_framing()
+	{
+		return tcp_compression_available() ? tcp_framing::Compressed : tcp_framing::Binary;
+	}
+
 	bool tcp_connection_log_enabled()
 	{
 		return _tcp_connection_log_enabled;
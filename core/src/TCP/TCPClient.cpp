@@ -21,6 +21,7 @@ namespace Diginext::Core::TCP
 	{
 		this->io_service = &(this->ios);
 		this->started_status = false;
+		this->framing = tcp_framing::Base64Line;
 	}
 	
 	tcp_client::~tcp_client()
@@ -63,7 +64,11 @@ namespace Diginext::Core::TCP
 	void tcp_client::handle_tcp_connection_read_message(tcp_connection* connection, std::string msg)
 	{
 		if (this->tcp_conn != nullptr && this->tcp_conn->getUUID() == connection->getUUID())
+		{
+			if (!this->onReadReply.empty())
+				this->onReadReply(connection->getReadRequestId(), msg);
 			this->onReadMessage(msg);
+		}
 	}
 	
 	void tcp_client::handle_tcp_connection_read_error(
@@ -119,6 +124,7 @@ namespace Diginext::Core::TCP
 	void tcp_client::connect(tcp::endpoint& endpoint)
 	{
 		this->tcp_conn = tcp_connection::create(this->ios);
+		this->tcp_conn->requestFraming(this->framing);
 
 		this->tcp_conn->onConnectionTimedOut.connect(boost::bind(&tcp_client::handle_tcp_connection_timeout, this, _1, _2));
 		this->tcp_conn->onConnectionError.connect(boost::bind(&tcp_client::handle_tcp_connection_error, this, _1, _2, _3));
@@ -131,6 +137,11 @@ namespace Diginext::Core::TCP
 		this->tcp_conn->connect(endpoint);
 	}
 
+	void tcp_client::setFraming(tcp_framing framing)
+	{
+		this->framing = framing;
+	}
+
 	tcp_connection::pointer tcp_client::getConnection()
 	{
 		return this->tcp_conn;
@@ -143,6 +154,14 @@ namespace Diginext::Core::TCP
 			this->getConnection()->send(msg);
 		}
 	}
+
+	void tcp_client::send(const std::string& msg, uint64_t requestId)
+	{
+		if (this->getConnection() != nullptr)
+		{
+			this->getConnection()->send(msg, requestId);
+		}
+	}
 	
 	void tcp_client::disconnect()
 	{
@@ -159,13 +178,15 @@ namespace Diginext::Core::TCP
 			this->stop();
 		}
 
+		// set before the thread runs: a connection refused right away ends io_service::run
+		// before waitStart could see the client started
+		{
+			std::lock_guard<std::mutex> guard(this->status_sync);
+			this->started_status = this->io_service != nullptr;
+		}
+
 		this->server_thread = std::thread([this]() {
 			if (this->io_service == nullptr) return;
-			
-			{
-				std::lock_guard<std::mutex> guard(this->status_sync);
-				this->started_status = true;
-			}
 
 			try
 			{
@@ -191,11 +212,12 @@ namespace Diginext::Core::TCP
 			this->disconnect();
 			this->io_service->stop();
 			this->waitStop();
+		}
 
-			if (this->server_thread.joinable())
-			{
-				this->server_thread.join();
-			}
+		// the io thread also ends on its own once the connection is gone
+		if (this->server_thread.joinable())
+		{
+			this->server_thread.join();
 		}
 	}
 
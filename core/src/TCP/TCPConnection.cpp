@@ -3,7 +3,10 @@
 #include "Base64/Base64.h"
 #include "Log/LogConsole.h"
 
+#include <algorithm>
+#include <cstring>
 #include <mutex>
+#include <stdexcept>
 #include <vector>
 
 #include <boost/algorithm/string.hpp>
@@ -13,17 +16,160 @@
 #include <boost/uuid/uuid_generators.hpp>
 #include <boost/uuid/uuid_io.hpp>
 
+#ifdef DIGINEXT_HAVE_ZLIB
+#include <zlib.h>
+#endif
+
 namespace Diginext::Core::TCP {
     const char DELIMETR = '\n';
     const std::string DELIMETR_STR = std::string(1, DELIMETR);
+    const size_t BINARY_READ_BUFFER = 64 * 1024;
+
+    // queued frames handed to one gathered write, a pipelined burst leaves in one syscall
+    const size_t WRITE_GATHER_FRAMES = 64;
 
     tcp_connection::pointer tcp_connection::create(boost::asio::io_service &io_service) {
         return boost::make_shared<tcp_connection>(io_service);
     }
 
+    frame_pointer encode_frame(const std::string &message) {
+        return std::make_shared<const std::string>(Base64::Encode(message) + DELIMETR_STR);
+    }
+
+    /**
+     * \brief original length and a zlib stream, fast level: it runs on the io thread for every frame
+     * @return false if deflate did not make it smaller
+     */
+    bool compress_payload(const std::string &message, std::string &compressed) {
+#ifdef DIGINEXT_HAVE_ZLIB
+        uLongf size = compressBound(static_cast<uLong>(message.size()));
+        compressed.resize(4 + size);
+        for (size_t i = 0; i < 4; i++) {
+            compressed[i] = static_cast<char>(message.size() >> (8 * i));
+        }
+        if (compress2(reinterpret_cast<Bytef *>(&compressed[4]), &size, reinterpret_cast<const Bytef *>(message.data()),
+                      static_cast<uLong>(message.size()), Z_BEST_SPEED) != Z_OK) {
+            return false;
+        }
+        compressed.resize(4 + size);
+        return compressed.size() < message.size();
+#else
+        return false;
+#endif
+    }
+
+    bool decode_payload(const char *payload, size_t length, uint32_t flags, std::string &message) {
+        if ((flags & FRAME_FLAG_COMPRESSED) == 0) {
+            message.assign(payload, length);
+            return true;
+        }
+
+#ifdef DIGINEXT_HAVE_ZLIB
+        if (length < 4) {
+            return false;
+        }
+        uint32_t original = 0;
+        for (size_t i = 0; i < 4; i++) {
+            original |= static_cast<uint32_t>(static_cast<unsigned char>(payload[i])) << (8 * i);
+        }
+        if (original > BINARY_MAX_PAYLOAD) {
+            return false;
+        }
+
+        message.resize(original);
+        uLongf size = original;
+        const int result = uncompress(reinterpret_cast<Bytef *>(&message[0]), &size, reinterpret_cast<const Bytef *>(payload + 4),
+                                      static_cast<uLong>(length - 4));
+        return result == Z_OK && size == original;
+#else
+        return false;
+#endif
+    }
+
+    frame_pointer encode_frame(const std::string &message, tcp_framing framing, uint64_t requestId, uint32_t flags) {
+        if (framing == tcp_framing::Raw) {
+            return std::make_shared<const std::string>(message);
+        }
+
+        if (framing == tcp_framing::Base64Line) {
+            return encode_frame(message);
+        }
+
+        if (message.size() > BINARY_MAX_PAYLOAD) {
+            throw std::length_error("message over the binary frame limit");
+        }
+
+        std::string compressed;
+        if (framing == tcp_framing::Compressed && message.size() >= COMPRESS_MIN_PAYLOAD && compress_payload(message, compressed)) {
+            auto frame = std::make_shared<std::string>(BINARY_HEADER_SIZE + compressed.size(), '\0');
+            write_binary_header(reinterpret_cast<unsigned char *>(&(*frame)[0]),
+                                { static_cast<uint32_t>(compressed.size()), flags | FRAME_FLAG_COMPRESSED, requestId });
+            std::memcpy(&(*frame)[BINARY_HEADER_SIZE], compressed.data(), compressed.size());
+            return frame;
+        }
+
+        // header and payload in one buffer, one write
+        auto frame = std::make_shared<std::string>(BINARY_HEADER_SIZE + message.size(), '\0');
+        write_binary_header(reinterpret_cast<unsigned char *>(&(*frame)[0]), { static_cast<uint32_t>(message.size()), flags, requestId });
+        std::memcpy(&(*frame)[BINARY_HEADER_SIZE], message.data(), message.size());
+        return frame;
+    }
+
+    void write_binary_header(unsigned char *out, const binary_header &header) {
+        for (size_t i = 0; i < 4; i++) {
+            out[i] = static_cast<unsigned char>(header.length >> (8 * i));
+            out[4 + i] = static_cast<unsigned char>(header.flags >> (8 * i));
+        }
+        for (size_t i = 0; i < 8; i++) {
+            out[8 + i] = static_cast<unsigned char>(header.requestId >> (8 * i));
+        }
+    }
+
+    binary_header read_binary_header(const unsigned char *in) {
+        binary_header header{ 0, 0, 0 };
+        for (size_t i = 0; i < 4; i++) {
+            header.length |= static_cast<uint32_t>(in[i]) << (8 * i);
+            header.flags |= static_cast<uint32_t>(in[4 + i]) << (8 * i);
+        }
+        for (size_t i = 0; i < 8; i++) {
+            header.requestId |= static_cast<uint64_t>(in[8 + i]) << (8 * i);
+        }
+        return header;
+    }
+
+    frame_pointer encode_hello(tcp_framing framing) {
+        auto hello = std::make_shared<std::string>(HELLO_SIZE, '\0');
+        std::memcpy(&(*hello)[0], HELLO_MAGIC, sizeof(HELLO_MAGIC));
+        (*hello)[4] = static_cast<char>(HELLO_VERSION);
+        (*hello)[5] = static_cast<char>(framing);
+        return hello;
+    }
+
+    bool read_hello(const unsigned char *in, tcp_framing &framing) {
+        if (std::memcmp(in, HELLO_MAGIC, sizeof(HELLO_MAGIC)) != 0 || in[4] != HELLO_VERSION ||
+            in[5] > static_cast<unsigned char>(tcp_framing::Compressed)) {
+            return false;
+        }
+
+        framing = static_cast<tcp_framing>(in[5]);
+        return true;
+    }
+
     tcp_connection::tcp_connection(boost::asio::io_service &io_service)
         : socket_(io_service) {
         this->io_service = &io_service;
+        this->sendStart = false;
+        this->queuedBytes = 0;
+        this->closeWhenSent = false;
+        this->sendingFrames = 0;
+        this->framing = tcp_framing::Base64Line;
+        this->offered = tcp_framing::Base64Line;
+        this->negotiation = tcp_negotiation::None;
+        this->negotiated = true;
+        this->readStart = 0;
+        this->readEnd = 0;
+        this->readRequestId = 0;
+        this->readFlags = 0;
 
         const boost::uuids::uuid boost_uuid = boost::uuids::random_generator()();
         this->uuid = boost::uuids::to_string(boost_uuid);
@@ -53,11 +199,119 @@ namespace Diginext::Core::TCP {
             this->onConnectionError(this, endpoint, ec);
         } else {
             this->logger->LogInfo("tcp_connection::handle_connect | connected successfully");
+            if (this->negotiation == tcp_negotiation::Request) {
+                // the hello goes out before anything else, what was sent meanwhile waits in pendingMessages
+                this->sendFrame(encode_hello(this->offered));
+                boost::asio::async_read(
+                        socket_,
+                        boost::asio::buffer(this->helloReply, HELLO_SIZE),
+                        boost::bind(&tcp_connection::handle_hello_reply, shared_from_this(), boost::asio::placeholders::error, endpoint));
+                return;
+            }
+
             start();
             this->onConnectionSuccess(this, endpoint);
         }
     }
 
+    void tcp_connection::handle_hello_reply(const boost::system::error_code &error, tcp::endpoint endpoint) {
+        tcp_framing framing = tcp_framing::Base64Line;
+        if (error || !read_hello(this->helloReply, framing) || framing > this->offered) {
+            this->logger->LogError("tcp_connection::handle_hello_reply | no valid answer to the hello: " +
+                                   (error ? error.message() : std::string("bad reply")));
+            const boost::system::error_code ec = error ? error : boost::asio::error::invalid_argument;
+            socket_.close();
+            this->onConnectionError(this, endpoint, ec);
+            return;
+        }
+
+        this->logger->LogInfo("tcp_connection::handle_hello_reply | framing " + tcp_framing_to_string(framing));
+        this->finish_negotiation(framing);
+        start();
+        this->onConnectionSuccess(this, endpoint);
+    }
+
+    void tcp_connection::handle_sniff(const boost::system::error_code &error, size_t bytes_transferred) {
+        if (error) {
+            this->read_failed(error, bytes_transferred);
+            return;
+        }
+
+        // base64 never starts with the hello's 0, the byte stays in message_ for the line reader
+        if (static_cast<unsigned char>(*boost::asio::buffers_begin(this->message_.data())) != HELLO_MAGIC[0]) {
+            this->finish_negotiation(tcp_framing::Base64Line);
+            this->start_read();
+            return;
+        }
+
+        if (this->message_.size() < HELLO_SIZE) {
+            boost::asio::async_read(
+                    socket_,
+                    message_,
+                    boost::asio::transfer_exactly(HELLO_SIZE - this->message_.size()),
+                    boost::bind(&tcp_connection::handle_hello, shared_from_this(), boost::asio::placeholders::error, boost::asio::placeholders::bytes_transferred));
+            return;
+        }
+
+        this->handle_hello(error, 0);
+    }
+
+    void tcp_connection::handle_hello(const boost::system::error_code &error, size_t bytes_transferred) {
+        if (error) {
+            this->read_failed(error, bytes_transferred);
+            return;
+        }
+
+        unsigned char hello[HELLO_SIZE];
+        boost::asio::buffer_copy(boost::asio::buffer(hello), this->message_.data());
+        this->message_.consume(HELLO_SIZE);
+
+        tcp_framing requested = tcp_framing::Base64Line;
+        if (!read_hello(hello, requested)) {
+            this->logger->LogError("tcp_connection::handle_hello | not a hello of version " + std::to_string(HELLO_VERSION));
+            this->onReadError(this, boost::asio::error::invalid_argument, HELLO_SIZE);
+            this->disconnect();
+            return;
+        }
+
+        const tcp_framing framing = std::min(requested, this->offered);
+        this->logger->LogInfo("tcp_connection::handle_hello | asked " + tcp_framing_to_string(requested) + ", granted " + tcp_framing_to_string(framing));
+        this->sendFrame(encode_hello(framing));
+        this->finish_negotiation(framing);
+
+        // anything that came in behind the hello is the start of the first frame
+        if (framing != tcp_framing::Base64Line && this->message_.size() > 0) {
+            this->readBuffer.resize(std::max(BINARY_READ_BUFFER, this->message_.size()));
+            this->readStart = 0;
+            this->readEnd = boost::asio::buffer_copy(boost::asio::buffer(this->readBuffer), this->message_.data());
+            this->message_.consume(this->readEnd);
+        }
+
+        this->start_read();
+    }
+
+    void tcp_connection::finish_negotiation(tcp_framing framing) {
+        {
+            // queued under the same lock as the flag, a send racing with this cannot overtake them
+            std::lock_guard<std::mutex> guard(this->sendSync);
+            this->framing = framing;
+            this->negotiated = true;
+            for (const auto &pending : this->pendingMessages) {
+                try {
+                    auto frame = encode_frame(pending.first, framing, pending.second);
+                    this->queuedBytes += frame->size();
+                    this->sendBuffer.push_back(std::move(frame));
+                } catch (...) {
+                    this->logger->LogError("tcp_connection::finish_negotiation | Encode error");
+                }
+            }
+            this->pendingMessages.clear();
+            this->pendingMessages.shrink_to_fit();
+        }
+
+        this->async_write(true);
+    }
+
     std::vector<std::string> decode_message(
             Logger::pointer logger,
             const std::string& message,
@@ -163,11 +417,170 @@ namespace Diginext::Core::TCP {
         }
 
         this->logger->LogInfo("tcp_connection::handle_read | calling async_read_until");
-        boost::asio::async_read_until(
-                socket_,
-                message_,
-                '\n',
-                boost::bind(&tcp_connection::handle_read, shared_from_this(), boost::asio::placeholders::error, boost::asio::placeholders::bytes_transferred));
+        this->start_read();
+    }
+
+    void tcp_connection::start_read() {
+        if (this->framing == tcp_framing::Base64Line) {
+            boost::asio::async_read_until(
+                    socket_,
+                    message_,
+                    DELIMETR,
+                    boost::bind(&tcp_connection::handle_read, shared_from_this(), boost::asio::placeholders::error, boost::asio::placeholders::bytes_transferred));
+            return;
+        }
+
+        if (this->framing == tcp_framing::Raw) {
+            this->read_raw();
+            return;
+        }
+
+        this->read_binary();
+    }
+
+    void tcp_connection::read_raw() {
+        if (this->readBuffer.empty()) {
+            this->readBuffer.resize(BINARY_READ_BUFFER);
+        }
+
+        this->socket_.async_read_some(
+                boost::asio::buffer(this->readBuffer.data(), this->readBuffer.size()),
+                boost::bind(&tcp_connection::handle_read_raw, shared_from_this(), boost::asio::placeholders::error, boost::asio::placeholders::bytes_transferred));
+    }
+
+    void tcp_connection::handle_read_raw(const boost::system::error_code &error, size_t bytes_transferred) {
+        if (error) {
+            this->read_failed(error, bytes_transferred);
+            return;
+        }
+
+        // whatever arrived, several pipelined commands or part of one: the protocol above frames it
+        this->onReadMessage(this, std::string(reinterpret_cast<const char *>(this->readBuffer.data()), bytes_transferred));
+        this->read_raw();
+    }
+
+    void tcp_connection::read_failed(const boost::system::error_code &error, size_t bytes_transferred) {
+        if ((boost::asio::error::eof == error) ||
+            (boost::asio::error::connection_reset == error)) {
+            this->logger->LogInfo("tcp_connection::read_failed | client disconnected");
+            this->onDisconnected(this);
+            return;
+        }
+
+        this->logger->LogError(error.message());
+        this->onReadError(this, error, bytes_transferred);
+    }
+
+    void tcp_connection::read_binary() {
+        if (this->readBuffer.empty()) {
+            this->readBuffer.resize(BINARY_READ_BUFFER);
+            this->readStart = 0;
+            this->readEnd = 0;
+        }
+
+        // the header says how much follows, every complete frame in the buffer goes out without another read
+        for (;;) {
+            const size_t available = this->readEnd - this->readStart;
+            if (available < BINARY_HEADER_SIZE) {
+                break;
+            }
+
+            const binary_header header = read_binary_header(&this->readBuffer[this->readStart]);
+            if (header.length > BINARY_MAX_PAYLOAD) {
+                this->logger->LogError("tcp_connection::read_binary | frame of " + std::to_string(header.length) + " bytes, stream is broken");
+                this->onReadError(this, boost::asio::error::message_size, available);
+                this->disconnect();
+                return;
+            }
+
+            const char *payload = reinterpret_cast<const char *>(&this->readBuffer[this->readStart + BINARY_HEADER_SIZE]);
+            if (available - BINARY_HEADER_SIZE >= header.length) {
+                this->readStart += BINARY_HEADER_SIZE + header.length;
+                this->readRequestId = header.requestId;
+                const bool delivered = this->deliver(payload, header.length, header.flags);
+                this->readRequestId = 0;
+                if (!delivered) {
+                    return;
+                }
+                continue;
+            }
+
+            if (BINARY_HEADER_SIZE + header.length > this->readBuffer.size()) {
+                // does not fit the buffer: the bytes here start the payload, an exact read brings the rest
+                const size_t have = available - BINARY_HEADER_SIZE;
+                this->readRequestId = header.requestId;
+                this->readFlags = header.flags;
+                this->readBody.reserve(header.length);
+                this->readBody.assign(payload, have);
+                this->readBody.resize(header.length);
+                this->readStart = 0;
+                this->readEnd = 0;
+
+                boost::asio::async_read(
+                        socket_,
+                        boost::asio::buffer(&this->readBody[have], header.length - have),
+                        boost::bind(&tcp_connection::handle_read_body, shared_from_this(), boost::asio::placeholders::error, boost::asio::placeholders::bytes_transferred));
+                return;
+            }
+
+            break;
+        }
+
+        // the incomplete frame moves to the front, the read goes behind it
+        if (this->readStart > 0) {
+            std::memmove(&this->readBuffer[0], &this->readBuffer[this->readStart], this->readEnd - this->readStart);
+            this->readEnd -= this->readStart;
+            this->readStart = 0;
+        }
+
+        this->socket_.async_read_some(
+                boost::asio::buffer(&this->readBuffer[this->readEnd], this->readBuffer.size() - this->readEnd),
+                boost::bind(&tcp_connection::handle_read_binary, shared_from_this(), boost::asio::placeholders::error, boost::asio::placeholders::bytes_transferred));
+    }
+
+    void tcp_connection::handle_read_binary(const boost::system::error_code &error, size_t bytes_transferred) {
+        if (error) {
+            this->read_failed(error, bytes_transferred);
+            return;
+        }
+
+        this->readEnd += bytes_transferred;
+        this->read_binary();
+    }
+
+    void tcp_connection::handle_read_body(const boost::system::error_code &error, size_t bytes_transferred) {
+        if (error) {
+            this->read_failed(error, bytes_transferred);
+            return;
+        }
+
+        std::string body;
+        body.swap(this->readBody);
+        bool delivered = true;
+        if ((this->readFlags & FRAME_FLAG_COMPRESSED) == 0) {
+            this->onReadMessage(this, body);
+        } else {
+            delivered = this->deliver(body.data(), body.size(), this->readFlags);
+        }
+        this->readRequestId = 0;
+        this->readFlags = 0;
+
+        if (delivered) {
+            this->read_binary();
+        }
+    }
+
+    bool tcp_connection::deliver(const char *payload, size_t length, uint32_t flags) {
+        std::string message;
+        if (!decode_payload(payload, length, flags, message)) {
+            this->logger->LogError("tcp_connection::deliver | compressed frame of " + std::to_string(length) + " bytes does not inflate");
+            this->onReadError(this, boost::asio::error::invalid_argument, length);
+            this->disconnect();
+            return false;
+        }
+
+        this->onReadMessage(this, message);
+        return true;
     }
 
     std::string tcp_connection::getUUID() {
@@ -190,13 +603,23 @@ namespace Diginext::Core::TCP {
         }
 
         this->async_write();
+
+        bool drained = false;
+        {
+            std::lock_guard<std::mutex> guard(this->sendSync);
+            drained = this->closeWhenSent && !this->sendStart;
+            this->closeWhenSent = this->closeWhenSent && !drained;
+        }
+        if (drained) {
+            this->stop();
+        }
     }
 
     void tcp_connection::async_write(bool init) {
         std::lock_guard<std::mutex> guard(this->sendSync);
 
         this->logger->LogInfo("tcp_connection::async_write | method called");
-        std::list<string>::iterator msg_itertor;
+        std::list<frame_pointer>::iterator msg_itertor;
 
         if (init) {
             if (this->sendStart) {
@@ -206,7 +629,8 @@ namespace Diginext::Core::TCP {
             }
         } else {
             try {
-                if (!this->sendBuffer.empty()) {
+                for (; this->sendingFrames > 0 && !this->sendBuffer.empty(); this->sendingFrames--) {
+                    this->queuedBytes -= this->sendBuffer.front()->size();
                     this->sendBuffer.pop_front();
                 }
             } catch (...) {
@@ -218,11 +642,16 @@ namespace Diginext::Core::TCP {
             return;
         }
 
-        msg_itertor = this->sendBuffer.begin();
+        // frames are only appended while the write is in flight, the ones it covers stay in place
+        this->sendBuffers.clear();
+        for (msg_itertor = this->sendBuffer.begin(); msg_itertor != this->sendBuffer.end() && this->sendBuffers.size() < WRITE_GATHER_FRAMES; ++msg_itertor) {
+            this->sendBuffers.push_back(boost::asio::buffer((*msg_itertor)->data(), (*msg_itertor)->size()));
+        }
+        this->sendingFrames = this->sendBuffers.size();
 
         boost::asio::async_write(
                 this->socket(),
-                boost::asio::buffer(msg_itertor->c_str(), msg_itertor->size()),
+                this->sendBuffers,
                 boost::bind(
                         &tcp_connection::handle_write,
                         shared_from_this(),
@@ -230,34 +659,132 @@ namespace Diginext::Core::TCP {
                         boost::asio::placeholders::bytes_transferred));
     }
 
-    void tcp_connection::send(std::string msg)
+    void tcp_connection::send(const std::string &msg)
     {
         this->logger->LogInfo("tcp_connection::send | method called");
 
         {
             std::lock_guard<std::mutex> guard(this->sendSync);
-            try
+            if (!this->negotiated)
             {
-                const std::string socket_msg = Base64::Encode(msg) + DELIMETR_STR;
-                this->sendBuffer.push_back(socket_msg);
+                this->pendingMessages.emplace_back(msg, 0);
+                return;
             }
-            catch (...)
+        }
+
+        frame_pointer frame;
+        try
+        {
+            frame = encode_frame(msg, this->framing);
+        }
+        catch (...)
+        {
+            this->logger->LogError("tcp_connection::send | Encode error");
+            return;
+        }
+
+        this->sendFrame(frame);
+    }
+
+    void tcp_connection::send(const std::string &msg, uint64_t requestId)
+    {
+        {
+            std::lock_guard<std::mutex> guard(this->sendSync);
+            if (!this->negotiated)
             {
-                this->logger->LogError("tcp_connection::send | Encode error");
+                this->pendingMessages.emplace_back(msg, requestId);
+                return;
             }
         }
 
+        frame_pointer frame;
+        try
+        {
+            frame = encode_frame(msg, this->framing, requestId);
+        }
+        catch (...)
+        {
+            this->logger->LogError("tcp_connection::send | Encode error");
+            return;
+        }
+
+        this->sendFrame(frame);
+    }
+
+    void tcp_connection::sendFrame(frame_pointer frame)
+    {
+        {
+            std::lock_guard<std::mutex> guard(this->sendSync);
+            this->queuedBytes += frame->size();
+            this->sendBuffer.push_back(std::move(frame));
+        }
+
         this->async_write(true);
     }
 
+    size_t tcp_connection::getQueuedBytes()
+    {
+        std::lock_guard<std::mutex> guard(this->sendSync);
+        return this->queuedBytes;
+    }
+
+    void tcp_connection::setFraming(tcp_framing framing) {
+        this->framing = framing;
+        this->negotiation = tcp_negotiation::None;
+    }
+
+    void tcp_connection::requestFraming(tcp_framing framing) {
+        if (framing == tcp_framing::Compressed && !tcp_compression_available()) {
+            framing = tcp_framing::Binary;
+        }
+
+        this->framing = tcp_framing::Base64Line;
+        this->offered = framing;
+        this->negotiation = framing == tcp_framing::Base64Line ? tcp_negotiation::None : tcp_negotiation::Request;
+        std::lock_guard<std::mutex> guard(this->sendSync);
+        this->negotiated = this->negotiation == tcp_negotiation::None;
+    }
+
+    void tcp_connection::acceptFraming(tcp_framing best) {
+        if (best == tcp_framing::Compressed && !tcp_compression_available()) {
+            best = tcp_framing::Binary;
+        }
+
+        // a server capped at Base64Line still answers hellos, granting Base64Line; only a raw listener does not look for them
+        this->framing = best == tcp_framing::Raw ? tcp_framing::Raw : tcp_framing::Base64Line;
+        this->offered = best;
+        this->negotiation = best == tcp_framing::Raw ? tcp_negotiation::None : tcp_negotiation::Accept;
+        std::lock_guard<std::mutex> guard(this->sendSync);
+        this->negotiated = this->negotiation == tcp_negotiation::None;
+    }
+
+    bool tcp_connection::negotiating() {
+        std::lock_guard<std::mutex> guard(this->sendSync);
+        return !this->negotiated;
+    }
+
+    tcp_framing tcp_connection::getFraming() const {
+        return this->framing;
+    }
+
+    uint64_t tcp_connection::getReadRequestId() const {
+        return this->readRequestId;
+    }
+
     void tcp_connection::start() {
-        this->sendStart = false;
+        // sendStart is left alone: frames queued while connecting already have a write in flight,
+        // clearing it would start a second one writing the same frame again
         this->partMessage = "";
-        boost::asio::async_read_until(
-                socket_,
-                message_,
-                DELIMETR,
-                boost::bind(&tcp_connection::handle_read, shared_from_this(), boost::asio::placeholders::error, boost::asio::placeholders::bytes_transferred));
+        if (this->negotiation == tcp_negotiation::Accept && this->negotiating()) {
+            boost::asio::async_read(
+                    socket_,
+                    message_,
+                    boost::asio::transfer_exactly(1),
+                    boost::bind(&tcp_connection::handle_sniff, shared_from_this(), boost::asio::placeholders::error, boost::asio::placeholders::bytes_transferred));
+            return;
+        }
+
+        this->start_read();
     }
 
     void tcp_connection::stop() {
@@ -266,7 +793,9 @@ namespace Diginext::Core::TCP {
         } catch (...) {
         }
 
-        this->io_service->post([this]() {
+        // the owner may let go of the connection on onDisconnected, the close keeps it alive until it ran
+        auto self = shared_from_this();
+        this->io_service->post([this, self]() {
             try {
                 this->socket().shutdown(boost::asio::ip::tcp::socket::shutdown_both);
             } catch (...) {
@@ -293,4 +822,16 @@ namespace Diginext::Core::TCP {
     void tcp_connection::disconnect() {
         this->stop();
     }
+
+    void tcp_connection::disconnectAfterSend() {
+        {
+            std::lock_guard<std::mutex> guard(this->sendSync);
+            if (this->sendStart) {
+                this->closeWhenSent = true;
+                return;
+            }
+        }
+
+        this->stop();
+    }
 }// namespace Diginext::Core::TCP
\ No newline at end of file
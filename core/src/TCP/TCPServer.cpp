@@ -17,11 +17,25 @@ namespace Diginext::Core::TCP
 		return boost::make_shared<tcp_server>(endpoint);
 	}
 
+	tcp_server::pointer tcp_server::create(tcp::endpoint& endpoint, boost::asio::io_service& io_service)
+	{
+		return boost::make_shared<tcp_server>(endpoint, io_service);
+	}
+
 	tcp_server::tcp_server(tcp::endpoint& endpoint)
-		: acceptor_(this->ios, endpoint)
+		: io_service(&(this->ios)), shared(false), acceptor_(this->ios, endpoint)
+	{
+		this->started_status = false;
+		this->framing = tcp_best_framing();
+		connections = std::list<tcp_connection::pointer>();
+		start_accept();
+	}
+
+	tcp_server::tcp_server(tcp::endpoint& endpoint, boost::asio::io_service& io_service)
+		: io_service(&io_service), shared(true), acceptor_(io_service, endpoint)
 	{
 		this->started_status = false;
-		this->io_service = &(this->ios);
+		this->framing = tcp_best_framing();
 		connections = std::list<tcp_connection::pointer>();
 		start_accept();
 	}
@@ -43,6 +57,11 @@ namespace Diginext::Core::TCP
 		return &acceptor_;
 	}
 
+	boost::asio::io_service& tcp_server::getIoService()
+	{
+		return *(this->io_service);
+	}
+
 	void tcp_server::start_accept()
 	{
 		tcp_connection::pointer new_connection = tcp_connection::create(*(this->io_service));
@@ -54,6 +73,12 @@ namespace Diginext::Core::TCP
 		if (error)
 		{
 			this->onAcceptError(new_connection, error);
+
+			// stopped listener: nothing to keep and no accept to queue again
+			if (error == boost::asio::error::operation_aborted || !this->acceptor_.is_open())
+			{
+				return;
+			}
 		}
 
 		try
@@ -66,6 +91,7 @@ namespace Diginext::Core::TCP
 			new_connection->onReadError.connect(boost::bind(&tcp_server::handle_tcp_connection_read_error, this, _1, _2, _3));
 			new_connection->onSendError.connect(boost::bind(&tcp_server::handle_tcp_connection_send_error, this, _1, _2, _3));
 
+			new_connection->acceptFraming(this->framing);
 			new_connection->start();
 			this->onAccepted(new_connection);
 		}
@@ -119,6 +145,13 @@ namespace Diginext::Core::TCP
 			this->stop();
 		}
 
+		if (this->shared)
+		{
+			std::lock_guard<std::mutex> guard(this->status_sync);
+			this->started_status = true;
+			return;
+		}
+
 		this->server_thread = std::thread([this]() {
 			{
 				std::lock_guard<std::mutex> guard(this->status_sync);
@@ -144,6 +177,18 @@ namespace Diginext::Core::TCP
 
 	void tcp_server::stop()
 	{
+		if (this->started() && this->shared)
+		{
+			// the owner's io_service keeps running, only this listener goes away
+			boost::system::error_code ignored;
+			this->acceptor_.close(ignored);
+			this->disconnectAll();
+
+			std::lock_guard<std::mutex> guard(this->status_sync);
+			this->started_status = false;
+			return;
+		}
+
 		if (this->started())
 		{
 			this->disconnectAll();
@@ -163,6 +208,16 @@ namespace Diginext::Core::TCP
 		return this->started_status;
 	}
 
+	void tcp_server::setFraming(tcp_framing framing)
+	{
+		this->framing = framing;
+	}
+
+	tcp_framing tcp_server::getFraming() const
+	{
+		return this->framing;
+	}
+
 	tcp::endpoint tcp_server::getLocalEndpoint() const
 	{
 		return this->acceptor_.local_endpoint();
@@ -276,12 +331,32 @@ namespace Diginext::Core::TCP
 
 	void tcp_server::sendAll(std::string message)
 	{
-		std::list<tcp_connection::pointer> connections = this->getConnections();
-		for (const auto connection : connections)
+		std::vector<tcp_connection::pointer> connections;
+		{
+			std::lock_guard<std::mutex> guard(this->server_sync);
+			connections.assign(this->connections.begin(), this->connections.end());
+		}
+
+		// one frame per framing in use, encoded on first need
+		frame_pointer frames[TCP_FRAMING_COUNT];
+		for (const auto& connection : connections)
 		{
 			try
 			{
-				this->send(connection, message);
+				// framing not known yet, the connection encodes it once the hello is through
+				if (connection->negotiating())
+				{
+					connection->send(message);
+					continue;
+				}
+
+				const tcp_framing framing = connection->getFraming();
+				frame_pointer& frame = frames[static_cast<size_t>(framing)];
+				if (frame == nullptr)
+				{
+					frame = encode_frame(message, framing);
+				}
+				connection->sendFrame(frame);
 			}
 			catch (...)
 			{
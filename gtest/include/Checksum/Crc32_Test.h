@@ -0,0 +1,41 @@
+#ifndef DIGINEXT_GTEST___CHECKSUM_CRC32_TEST_H
+#define DIGINEXT_GTEST___CHECKSUM_CRC32_TEST_H
+
+#include <Checksum/Crc32.h>
+
+#include <string>
+
+namespace Diginext::Core::GTest {
+    using namespace std;
+
+    struct TestStructCrc32
+    {
+        string data;
+        uint32_t crc;
+    };
+
+    TestStructCrc32 assertsCrc32[] = {
+            { "", 0x00000000U },
+            { "a", 0xE8B7BE43U },
+            { "123456789", 0xCBF43926U },
+            { "The quick brown fox jumps over the lazy dog", 0x414FA339U },
+    };
+
+    TEST(Test_Crc32, Test_Compute_String) {
+        for (const auto& assert : assertsCrc32)
+        {
+            ASSERT_EQ(assert.crc, Crc32::Compute(assert.data));
+        }
+    }
+
+    TEST(Test_Crc32, Test_Compute_Continue) {
+        const string data = "The quick brown fox jumps over the lazy dog";
+        for (size_t split = 0; split <= data.size(); split++)
+        {
+            const uint32_t first = Crc32::Compute(data.data(), split);
+            ASSERT_EQ(0x414FA339U, Crc32::Compute(data.data() + split, data.size() - split, first));
+        }
+    }
+}
+
+#endif
@@ -0,0 +1,94 @@
+#ifndef DIGINEXT_GTEST___STORAGE_HASH_RING_TEST_H
+#define DIGINEXT_GTEST___STORAGE_HASH_RING_TEST_H
+
+#include <gtest/gtest.h>
+
+#include <Storage/HashRing.h>
+
+#include <map>
+#include <string>
+#include <vector>
+
+namespace Diginext::Core::Storage::GTest {
+    using namespace std;
+
+    const size_t RING_KEYS = 100000;
+
+    inline std::vector<string> ring_locate_all(const HashRing &ring) {
+        std::vector<string> owners;
+        owners.reserve(RING_KEYS);
+        for (size_t i = 0; i < RING_KEYS; i++) {
+            owners.push_back(ring.locate("key:" + std::to_string(i)));
+        }
+        return owners;
+    }
+
+    TEST(Test_HashRing, Balance_And_Order_Independence) {
+        HashRing ring;
+        HashRing reversed;
+        const std::vector<string> nodes = { "10.0.0.1:6000", "10.0.0.2:6000", "10.0.0.3:6000", "10.0.0.4:6000" };
+        for (size_t i = 0; i < nodes.size(); i++) {
+            ASSERT_TRUE(ring.add(nodes[i]));
+            ASSERT_TRUE(reversed.add(nodes[nodes.size() - 1 - i]));
+        }
+        ASSERT_FALSE(ring.add(nodes[0]));
+        ASSERT_EQ(nodes.size(), ring.size());
+
+        const auto owners = ring_locate_all(ring);
+        ASSERT_EQ(owners, ring_locate_all(reversed));
+
+        std::map<string, size_t> counts;
+        for (const auto &owner : owners) {
+            counts[owner]++;
+        }
+
+        // 160 points per node keep every share within a fifth of the fair one
+        ASSERT_EQ(nodes.size(), counts.size());
+        for (const auto &count : counts) {
+            ASSERT_GT(count.second, RING_KEYS / 4 * 8 / 10);
+            ASSERT_LT(count.second, RING_KEYS / 4 * 12 / 10);
+        }
+    }
+
+    TEST(Test_HashRing, Add_Remove_Move_Minimum) {
+        HashRing ring;
+        for (size_t i = 1; i <= 4; i++) {
+            ring.add("10.0.0." + std::to_string(i) + ":6000");
+        }
+        const auto before = ring_locate_all(ring);
+
+        // a new node only takes keys, about its fair share of them
+        const string added = "10.0.0.5:6000";
+        ring.add(added);
+        const auto grown = ring_locate_all(ring);
+        size_t moved = 0;
+        for (size_t i = 0; i < RING_KEYS; i++) {
+            if (grown[i] != before[i]) {
+                ASSERT_EQ(added, grown[i]);
+                moved++;
+            }
+        }
+        ASSERT_GT(moved, RING_KEYS / 5 * 8 / 10);
+        ASSERT_LT(moved, RING_KEYS / 5 * 12 / 10);
+
+        // removing it again puts every key back where it was
+        ASSERT_TRUE(ring.remove(added));
+        ASSERT_EQ(before, ring_locate_all(ring));
+
+        // removing another node only moves that node's keys
+        const string removed = "10.0.0.2:6000";
+        ASSERT_TRUE(ring.remove(removed));
+        ASSERT_FALSE(ring.remove(removed));
+        ASSERT_FALSE(ring.contains(removed));
+        const auto shrunk = ring_locate_all(ring);
+        for (size_t i = 0; i < RING_KEYS; i++) {
+            if (before[i] != removed) {
+                ASSERT_EQ(before[i], shrunk[i]);
+            } else {
+                ASSERT_NE(removed, shrunk[i]);
+            }
+        }
+    }
+}// namespace Diginext::Core::Storage::GTest
+
+#endif
@@ -0,0 +1,78 @@
+#ifndef DIGINEXT_GTEST___STORAGE_HOT_KEY_TRACKER_TEST_H
+#define DIGINEXT_GTEST___STORAGE_HOT_KEY_TRACKER_TEST_H
+
+#include <gtest/gtest.h>
+
+#include <Storage/HotKeyTracker.h>
+
+#include <set>
+#include <string>
+#include <vector>
+
+namespace Diginext::Core::Storage::GTest {
+    using namespace std;
+
+    // ten hot keys at 1% of the traffic each, the rest spread over 100000 cold ones
+    inline void hot_key_traffic(HotKeyTracker &tracker, const string &hotPrefix, size_t accesses) {
+        uint64_t state = 88172645463325252ULL;
+        for (size_t i = 0; i < accesses; i++) {
+            state ^= state << 13;
+            state ^= state >> 7;
+            state ^= state << 17;
+            const bool hot = state % 100 < 10;
+            const string key = hot ? hotPrefix + std::to_string(state % 10) : "cold:" + std::to_string(state % 100000);
+            tracker.record(key, i % 4 == 0);
+        }
+    }
+
+    inline std::set<string> hot_key_names(const HotKeyTracker &tracker, size_t limit) {
+        std::set<string> names;
+        for (const auto &hotKey : tracker.hottest(limit)) {
+            names.insert(hotKey.key);
+        }
+        return names;
+    }
+
+    TEST(Test_HotKeyTracker, Finds_Heavy_Hitters_Sampled) {
+        for (const size_t sampleRate : { 1, 16 }) {
+            HotKeyTracker tracker(32, sampleRate);
+            hot_key_traffic(tracker, "hot:", 1000000);
+
+            const auto hottest = tracker.hottest(10);
+            ASSERT_EQ(10, hottest.size());
+            for (const auto &hotKey : hottest) {
+                ASSERT_EQ(0, hotKey.key.rfind("hot:", 0)) << hotKey.key;
+                ASSERT_GE(hotKey.accesses, hotKey.reads + hotKey.writes);
+                ASSERT_GT(hotKey.reads, hotKey.writes);
+            }
+            for (size_t i = 1; i < hottest.size(); i++) {
+                ASSERT_GE(hottest[i - 1].accesses, hottest[i].accesses);
+            }
+
+            const size_t expected = 1000000 / sampleRate;
+            ASSERT_GT(tracker.getSampled(), expected * 9 / 10);
+            ASSERT_LT(tracker.getSampled(), expected * 11 / 10);
+        }
+    }
+
+    TEST(Test_HotKeyTracker, Follows_Shift_And_Off) {
+        HotKeyTracker tracker(16, 4);
+        hot_key_traffic(tracker, "old:", 1000000);
+        ASSERT_EQ(10, hot_key_names(tracker, 10).size());
+        ASSERT_EQ(0, hot_key_names(tracker, 10).begin()->rfind("old:", 0));
+
+        // decay halves the old counts, the new hot set takes over
+        hot_key_traffic(tracker, "new:", 4000000);
+        for (const auto &name : hot_key_names(tracker, 10)) {
+            ASSERT_EQ(0, name.rfind("new:", 0)) << name;
+        }
+
+        HotKeyTracker off(0, 1);
+        ASSERT_FALSE(off.enabled());
+        hot_key_traffic(off, "hot:", 1000);
+        ASSERT_EQ(0, off.getSampled());
+        ASSERT_TRUE(off.hottest(10).empty());
+    }
+}// namespace Diginext::Core::Storage::GTest
+
+#endif
@@ -0,0 +1,157 @@
+#ifndef DIGINEXT_GTEST___STORAGE_KEY_EXPIRY_TEST_H
+#define DIGINEXT_GTEST___STORAGE_KEY_EXPIRY_TEST_H
+
+#include <gtest/gtest.h>
+
+#include <Storage/KeyExpiry.h>
+#include <Storage/TimingWheel.h>
+
+#include <chrono>
+#include <map>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace Diginext::Core::Storage::GTest {
+    using namespace std;
+    using namespace std::chrono_literals;
+
+    TEST(Test_KeyExpiry, Timing_Wheel_Fires_On_Time) {
+        TimingWheel wheel(1000);
+        std::mt19937_64 random(11);
+
+        // deadlines on every level and past the top one
+        std::map<string, uint64_t> model;
+        for (int i = 0; i < 20000; i++) {
+            const uint64_t span = uint64_t(1) << (random() % 27);
+            const uint64_t deadline = 1000 + random() % span;
+            const string key = "key:" + std::to_string(i);
+            model[key] = deadline;
+            wheel.schedule(key, deadline);
+        }
+        ASSERT_EQ(model.size(), wheel.size());
+
+        uint64_t tick = 1000;
+        while (!model.empty()) {
+            tick += 1 + random() % 50000;
+            wheel.advance(tick, static_cast<size_t>(-1), [&model, tick](const TimingWheel::Timer &timer) {
+                const auto it = model.find(timer.key);
+                ASSERT_NE(model.end(), it);
+                ASSERT_EQ(it->second, timer.deadline);
+                ASSERT_LE(timer.deadline, tick);
+                model.erase(it);
+            });
+
+            // nothing due is left behind
+            for (const auto &item : model) {
+                ASSERT_GT(item.second, tick);
+            }
+        }
+        ASSERT_EQ(0, wheel.size());
+    }
+
+    TEST(Test_KeyExpiry, Timing_Wheel_Budget) {
+        TimingWheel wheel;
+        for (int i = 0; i < 2500; i++) {
+            wheel.schedule("key:" + std::to_string(i), 100);
+        }
+
+        size_t fired = 0;
+        const auto count = [&fired](const TimingWheel::Timer &) { fired++; };
+        ASSERT_EQ(0, wheel.advance(99, 1000, count));
+        ASSERT_EQ(1000, wheel.advance(100, 1000, count));
+        ASSERT_EQ(1500, wheel.getDueCount());
+        ASSERT_EQ(1000, wheel.advance(100, 1000, count));
+        ASSERT_EQ(500, wheel.advance(101, 1000, count));
+        ASSERT_EQ(2500, fired);
+        ASSERT_EQ(0, wheel.size());
+    }
+
+    TEST(Test_KeyExpiry, Expire_Persist_Collect) {
+        KeyExpiry expiry(1ms);
+        ASSERT_FALSE(expiry.expired("a"));
+        ASSERT_EQ(-1, expiry.remaining("a").count());
+
+        expiry.expire("a", 20ms);
+        expiry.expire("b", 20ms);
+        expiry.expire("c", 20ms);
+        expiry.expire("d", 1h);
+        expiry.expire("c", 1h);
+        ASSERT_TRUE(expiry.persist("b"));
+        ASSERT_FALSE(expiry.persist("b"));
+        ASSERT_EQ(3, expiry.size());
+        ASSERT_FALSE(expiry.expired("a"));
+        ASSERT_GT(expiry.remaining("d").count(), 0);
+
+        std::this_thread::sleep_for(40ms);
+        ASSERT_TRUE(expiry.expired("a"));
+        ASSERT_FALSE(expiry.expired("b"));
+        ASSERT_FALSE(expiry.expired("c"));
+
+        // stale timers of b (persisted) and c (new deadline) fire without callback
+        std::vector<string> reclaimed;
+        ASSERT_FALSE(expiry.collect(100, [&reclaimed](const string &key) { reclaimed.push_back(key); }));
+        ASSERT_EQ(std::vector<string>{ "a" }, reclaimed);
+        ASSERT_FALSE(expiry.expired("a"));
+        ASSERT_EQ(2, expiry.size());
+    }
+
+    TEST(Test_KeyExpiry, Incremental_Collect) {
+        KeyExpiry expiry(1ms);
+        for (int i = 0; i < 5000; i++) {
+            expiry.expire("key:" + std::to_string(i), 1ms);
+        }
+        std::this_thread::sleep_for(10ms);
+
+        size_t reclaimed = 0;
+        size_t runs = 0;
+        bool more = true;
+        while (more) {
+            more = expiry.collect(1000, [&reclaimed](const string &) { reclaimed++; });
+            runs++;
+        }
+
+        ASSERT_EQ(5000, reclaimed);
+        ASSERT_EQ(5, runs);
+        ASSERT_EQ(0, expiry.size());
+    }
+
+    TEST(Test_KeyExpiry, Wall_Clock_Deadlines) {
+        KeyExpiry expiry(1ms);
+        ASSERT_EQ(0, expiry.deadline("a"));
+
+        const uint64_t before = KeyExpiry::wallClock();
+        expiry.expire("a", 1h);
+        const uint64_t at = expiry.deadline("a");
+        ASSERT_GE(at, before + 3600 * 1000);
+        ASSERT_LE(at, KeyExpiry::wallClock() + 3600 * 1000);
+
+        // read back by another process, e.g. from a log
+        KeyExpiry restored(1ms);
+        restored.expireAt("a", at);
+        restored.expireAt("b", before - 1000);
+        ASSERT_LE(restored.deadline("a") > at ? restored.deadline("a") - at : at - restored.deadline("a"), 5);
+        ASSERT_TRUE(restored.expired("b"));
+
+        std::map<string, uint64_t> visited;
+        restored.forEach([&visited](const string &key, uint64_t deadline) { visited[key] = deadline; });
+        ASSERT_EQ(2, visited.size());
+        ASSERT_LE(visited["b"], KeyExpiry::wallClock());
+
+        std::vector<string> reclaimed;
+        restored.collect(100, [&reclaimed](const string &key) { reclaimed.push_back(key); });
+        ASSERT_EQ(std::vector<string>{ "b" }, reclaimed);
+
+        // held keys stay expired, no timer brings them back to collect
+        restored.hold("b");
+        ASSERT_TRUE(restored.expired("b"));
+        std::this_thread::sleep_for(5ms);
+        ASSERT_FALSE(restored.collect(100, [&reclaimed](const string &key) { reclaimed.push_back(key); }));
+        ASSERT_EQ(1, reclaimed.size());
+        ASSERT_TRUE(restored.persist("b"));
+        ASSERT_FALSE(restored.expired("b"));
+    }
+}// namespace Diginext::Core::Storage::GTest
+
+#endif
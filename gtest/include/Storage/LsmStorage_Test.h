@@ -0,0 +1,275 @@
+#ifndef DIGINEXT_GTEST___STORAGE_LSM_STORAGE_TEST_H
+#define DIGINEXT_GTEST___STORAGE_LSM_STORAGE_TEST_H
+
+#include <gtest/gtest.h>
+
+#include "Storage/StorageTestUtils.h"
+
+#include <Storage/BloomFilter.h>
+#include <Storage/LsmStorage.h>
+#include <Storage/SSTable.h>
+#include <Storage/StorageHash.h>
+
+#include <atomic>
+#include <map>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace Diginext::Core::Storage::GTest {
+    using namespace std;
+
+    inline LsmOptions smallLsmOptions() {
+        LsmOptions options;
+        options.memtableSize = 16 * 1024;
+        options.blockSize = 512;
+        options.level0CompactionTrigger = 2;
+        options.level1MaxBytes = 64 * 1024;
+        options.levelMultiplier = 4;
+        options.tableFileSize = 16 * 1024;
+        options.fsyncPolicy = FsyncPolicy::Async;
+        return options;
+    }
+
+    inline std::map<string, string> lsmContent(const LsmStorage &storage) {
+        std::map<string, string> content;
+        storage.forEach([&content](string_view key, string_view value) {
+            content.emplace(string(key), string(value));
+        });
+        return content;
+    }
+
+    TEST(Test_LsmStorage, Bloom_Filter) {
+        std::vector<uint64_t> hashes;
+        for (int i = 0; i < 10000; i++) {
+            hashes.push_back(hash_key("key:" + std::to_string(i)));
+        }
+
+        const BloomFilter filter = BloomFilter::build(hashes);
+        for (const uint64_t hash : hashes) {
+            ASSERT_TRUE(filter.mayContain(hash));
+        }
+
+        size_t falsePositives = 0;
+        for (int i = 0; i < 10000; i++) {
+            if (filter.mayContain(string_view("other:" + std::to_string(i)))) {
+                falsePositives++;
+            }
+        }
+        ASSERT_LT(falsePositives, 300);
+
+        ASSERT_TRUE(BloomFilter().mayContain(hash_key("anything")));
+    }
+
+    TEST(Test_LsmStorage, SSTable_Build_Read) {
+        TempPath path(".sst");
+
+        std::map<string, string> data;
+        for (int i = 0; i < 5000; i++) {
+            data["key:" + std::to_string(100000 + i)] = string(i % 50, 'v');
+        }
+
+        {
+            SSTableBuilder builder(path.get(), 256);
+            for (const auto &entry : data) {
+                builder.add(entry.first, entry.second, entry.first == "key:100007");
+            }
+            builder.finish();
+        }
+
+        auto table = SSTable::open(path.get(), 1);
+        ASSERT_NE(nullptr, table);
+        ASSERT_EQ(5000, table->getEntryCount());
+        ASSERT_EQ(1, table->getDeletedCount());
+        ASSERT_EQ("key:100000", table->getSmallestKey());
+        ASSERT_EQ("key:104999", table->getLargestKey());
+
+        string value;
+        for (const auto &entry : data) {
+            const LookupResult result = table->get(entry.first, hash_key(entry.first), value);
+            if (entry.first == "key:100007") {
+                ASSERT_EQ(LookupResult::Deleted, result);
+            } else {
+                ASSERT_EQ(LookupResult::Found, result);
+                ASSERT_EQ(entry.second, value);
+            }
+        }
+
+        ASSERT_EQ(LookupResult::NotFound, table->get("key:100000x", hash_key("key:100000x"), value));
+        ASSERT_EQ(LookupResult::NotFound, table->get("zzz", hash_key("zzz"), value));
+
+        auto it = table->iterator();
+        it.seekToFirst();
+        auto expected = data.begin();
+        for (; it.valid(); it.next(), ++expected) {
+            ASSERT_EQ(expected->first, it.key());
+        }
+        ASSERT_EQ(data.end(), expected);
+
+        it.seek("key:102500");
+        ASSERT_TRUE(it.valid());
+        ASSERT_EQ("key:102500", it.key());
+
+        it.seek("key:104999z");
+        ASSERT_FALSE(it.valid());
+    }
+
+    TEST(Test_LsmStorage, Put_Get_Remove_Reopen) {
+        TempDirectory directory;
+        std::map<string, string> model;
+
+        {
+            auto storage = LsmStorage::create(directory.get(), smallLsmOptions());
+            for (int i = 0; i < 3000; i++) {
+                const string key = "key:" + std::to_string(i % 1000);
+                const string value = std::to_string(i) + string(i % 40, 'x');
+                storage->put(key, value);
+                model[key] = value;
+
+                if (i % 7 == 0) {
+                    const string removed = "key:" + std::to_string((i * 13) % 1000);
+                    ASSERT_EQ(model.erase(removed) == 1, storage->remove(removed));
+                }
+            }
+
+            ASSERT_FALSE(storage->remove("missing"));
+
+            string value;
+            for (const auto &entry : model) {
+                ASSERT_TRUE(storage->get(entry.first, value));
+                ASSERT_EQ(entry.second, value);
+            }
+
+            ASSERT_EQ(model, lsmContent(*storage));
+            ASSERT_GT(storage->getStats().flushes, 0);
+        }
+
+        // tables from the manifest plus the replayed memtable log
+        auto reopened = LsmStorage::create(directory.get(), smallLsmOptions());
+        ASSERT_EQ(model, lsmContent(*reopened));
+
+        string value;
+        for (const auto &entry : model) {
+            ASSERT_TRUE(reopened->get(entry.first, value));
+            ASSERT_EQ(entry.second, value);
+        }
+
+        for (int i = 0; i < 1000; i++) {
+            const string key = "key:" + std::to_string(i);
+            ASSERT_EQ(model.count(key) == 1, reopened->getShared(key) != nullptr);
+        }
+    }
+
+    TEST(Test_LsmStorage, Leveled_Compaction) {
+        TempDirectory directory;
+        std::map<string, string> model;
+
+        auto storage = LsmStorage::create(directory.get(), smallLsmOptions());
+        for (int round = 0; round < 4; round++) {
+            for (int i = 0; i < 5000; i++) {
+                const string key = "key:" + std::to_string((i * 7919) % 5000);
+                const string value = string(32, char('a' + round));
+                storage->put(key, value);
+                model[key] = value;
+            }
+
+            for (int i = round; i < 5000; i += 10) {
+                const string key = "key:" + std::to_string(i);
+                storage->remove(key);
+                model.erase(key);
+            }
+        }
+
+        storage->flush();
+        storage->waitIdle();
+
+        const LsmStats stats = storage->getStats();
+        ASSERT_GT(stats.compactions, 0);
+        ASSERT_LT(stats.levelBytes[0], 4 * 16 * 1024);
+
+        uint64_t deeperBytes = 0;
+        for (size_t level = 2; level < stats.levelBytes.size(); level++) {
+            deeperBytes += stats.levelBytes[level];
+        }
+        ASSERT_GT(deeperBytes, 0);
+
+        ASSERT_EQ(model, lsmContent(*storage));
+        // size is an estimate until every overwrite is merged down
+        ASSERT_NEAR(double(model.size()), double(storage->size()), model.size() / 2.0);
+
+        string value;
+        for (int i = 0; i < 5000; i++) {
+            const string key = "key:" + std::to_string(i);
+            const auto it = model.find(key);
+            ASSERT_EQ(it != model.end(), storage->get(key, value));
+            if (it != model.end()) {
+                ASSERT_EQ(it->second, value);
+            }
+        }
+
+        storage->close();
+        auto reopened = LsmStorage::create(directory.get(), smallLsmOptions());
+        ASSERT_EQ(model, lsmContent(*reopened));
+    }
+
+    TEST(Test_LsmStorage, Missing_Keys_Skip_Disk) {
+        TempDirectory directory;
+        auto storage = LsmStorage::create(directory.get(), smallLsmOptions());
+
+        for (int i = 0; i < 20000; i++) {
+            storage->put("key:" + std::to_string(i), string(16, 'v'));
+        }
+        storage->flush();
+        storage->waitIdle();
+
+        const uint64_t before = storage->getStats().blockReads;
+        string value;
+        for (int i = 0; i < 10000; i++) {
+            ASSERT_FALSE(storage->get("key:" + std::to_string(i) + "-missing", value));
+        }
+        const uint64_t reads = storage->getStats().blockReads - before;
+
+        // bloom filters let through ~1% per table touched
+        ASSERT_LT(reads, 500);
+    }
+
+    TEST(Test_LsmStorage, Readers_During_Compaction) {
+        TempDirectory directory;
+        auto storage = LsmStorage::create(directory.get(), smallLsmOptions());
+
+        // stable keys must stay readable while tables are flushed, merged and deleted
+        for (int i = 0; i < 500; i++) {
+            storage->put("stable:" + std::to_string(i), "value:" + std::to_string(i));
+        }
+
+        std::atomic<bool> stop{false};
+        std::atomic<size_t> errors{0};
+        std::vector<std::thread> readers;
+        for (int r = 0; r < 4; r++) {
+            readers.emplace_back([&storage, &stop, &errors, r]() {
+                string value;
+                for (int i = r; !stop; i = (i + 7) % 500) {
+                    if (!storage->get("stable:" + std::to_string(i), value) || value != "value:" + std::to_string(i)) {
+                        errors++;
+                    }
+                }
+            });
+        }
+
+        for (int i = 0; i < 15000; i++) {
+            storage->put("churn:" + std::to_string(i % 3000), string(64, char('a' + i % 26)));
+        }
+        storage->flush();
+        storage->waitIdle();
+
+        stop = true;
+        for (auto &reader : readers) {
+            reader.join();
+        }
+
+        ASSERT_EQ(0, errors.load());
+        ASSERT_GT(storage->getStats().compactions, 0);
+    }
+}// namespace Diginext::Core::Storage::GTest
+
+#endif
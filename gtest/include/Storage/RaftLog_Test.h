@@ -0,0 +1,95 @@
+#ifndef DIGINEXT_GTEST___STORAGE_RAFT_LOG_TEST_H
+#define DIGINEXT_GTEST___STORAGE_RAFT_LOG_TEST_H
+
+#include <gtest/gtest.h>
+
+#include "Storage/StorageTestUtils.h"
+
+#include <Storage/RaftLog.h>
+#include <Storage/StorageFile.h>
+
+#include <string>
+#include <vector>
+
+namespace Diginext::Core::Storage::GTest {
+    using namespace std;
+
+    TEST(Test_RaftLog, Append_Truncate_Reopen) {
+        TempPath path(".raft");
+
+        {
+            RaftLog log(path.get(), true);
+            ASSERT_EQ(0, log.open());
+            ASSERT_EQ(0, log.getTerm());
+            ASSERT_EQ(0, log.lastIndex());
+            ASSERT_EQ(0, log.termAt(0));
+
+            log.setState(1, "a:1");
+            log.append({ { 1, "" }, { 1, "one" }, { 1, "two" } });
+            log.setState(2, string());
+            log.append({ { 2, "three" } });
+
+            // a new leader replaces the conflicting suffix
+            log.truncate(3);
+            log.setState(3, "b:2");
+            log.append({ { 3, "three'" }, { 3, string(100000, 'x') } });
+
+            ASSERT_EQ(4, log.lastIndex());
+            ASSERT_EQ(1, log.termAt(2));
+            ASSERT_EQ(3, log.termAt(3));
+            ASSERT_EQ(0, log.termAt(5));
+        }
+
+        // term, vote and entries come back exactly, truncated entries stay gone
+        RaftLog log(path.get(), false);
+        ASSERT_EQ(4, log.open());
+        ASSERT_EQ(3, log.getTerm());
+        ASSERT_EQ("b:2", log.getVotedFor());
+        ASSERT_EQ("", log.at(1).command);
+        ASSERT_EQ("one", log.at(2).command);
+        ASSERT_EQ("three'", log.at(3).command);
+        ASSERT_EQ(3, log.at(3).term);
+        ASSERT_EQ(string(100000, 'x'), log.at(4).command);
+    }
+
+    TEST(Test_RaftLog, Torn_Tail_Dropped) {
+        TempPath path(".raft");
+
+        uint64_t goodSize = 0;
+        {
+            RaftLog log(path.get(), true);
+            log.open();
+            log.setState(5, "c:3");
+            log.append({ { 5, "a" }, { 5, "b" } });
+            goodSize = file_size(path.get());
+            log.append({ { 5, string(1000, 'c') } });
+        }
+
+        // a crash in the middle of the last write
+        ASSERT_TRUE(file_truncate(path.get(), file_size(path.get()) - 10));
+
+        {
+            RaftLog log(path.get(), true);
+            ASSERT_EQ(2, log.open());
+            ASSERT_EQ(goodSize, file_size(path.get()));
+            ASSERT_EQ(5, log.getTerm());
+
+            // appends continue after the cut
+            log.append({ { 6, "d" } });
+        }
+
+        RaftLog log(path.get(), true);
+        ASSERT_EQ(3, log.open());
+        ASSERT_EQ("d", log.at(3).command);
+        ASSERT_EQ(6, log.termAt(3));
+
+        // without a path nothing touches the disk
+        RaftLog memory("", true);
+        ASSERT_EQ(0, memory.open());
+        memory.setState(1, "x");
+        memory.append({ { 1, "e" } });
+        ASSERT_EQ(1, memory.lastIndex());
+    }
+}// namespace Diginext::Core::Storage::GTest
+
+#endif
@@ -0,0 +1,278 @@
+#ifndef DIGINEXT_GTEST___STORAGE_RAFT_NODE_TEST_H
+#define DIGINEXT_GTEST___STORAGE_RAFT_NODE_TEST_H
+
+#include <gtest/gtest.h>
+
+#include "Storage/StorageTestUtils.h"
+
+#include <Storage/StorageClient.h>
+#include <Storage/StorageCommon.h>
+#include <Storage/StorageServer.h>
+#include <TCP/TCPClient.h>
+
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <nlohmann/json.hpp>
+
+namespace Diginext::Core::Storage::GTest {
+    using namespace std;
+    using namespace std::chrono_literals;
+
+    /**
+     * \brief three raft members in this process on local ports, each with its log on disk so a
+     * stopped one can come back with what it had; a fresh cluster per test
+     */
+    class Test_RaftNode : public testing::Test {
+    protected:
+        static constexpr size_t NODES = 3;
+
+        TempDirectory directory;
+        std::vector<unsigned short> ports;
+        std::vector<StorageServer::pointer> servers;
+        std::vector<StorageClient::pointer> clients;
+
+        void SetUp() override {
+            std::filesystem::create_directories(this->directory.get());
+            for (size_t i = 0; i < NODES; i++) {
+                this->ports.push_back(free_port());
+            }
+            this->servers.resize(NODES);
+            this->clients.resize(NODES);
+
+            // a start takes seconds, the members come up together
+            std::vector<std::thread> starting;
+            for (size_t i = 0; i < NODES; i++) {
+                starting.emplace_back([this, i]() { this->startNode(i); });
+            }
+            for (auto &thread : starting) {
+                thread.join();
+            }
+        }
+
+        void TearDown() override {
+            this->clients.clear();
+            this->servers.clear();
+        }
+
+        string nodeId(size_t i) const {
+            return "127.0.0.1:" + std::to_string(this->ports[i]);
+        }
+
+        void startNode(size_t i) {
+            StorageOptions options;
+            options.raftId = this->nodeId(i);
+            for (size_t peer = 0; peer < NODES; peer++) {
+                if (peer != i) {
+                    options.raftPeers.push_back(this->nodeId(peer));
+                }
+            }
+            options.raftLogPath = this->directory.get() + "/raft_" + std::to_string(i) + ".log";
+            options.raftElectionTimeout = 3s;
+
+            auto server = StorageServer::create("127.0.0.1", this->ports[i], options);
+            server->Start();
+            this->servers[i] = server;
+            this->clients[i] = StorageClient::create("127.0.0.1", this->ports[i]);
+        }
+
+        void stopNode(size_t i) {
+            this->clients[i].reset();
+            this->servers[i].reset();
+        }
+
+        /**
+         * @brief stop several members at once, each stop takes a second
+         */
+        void stopNodes(const std::vector<size_t> &nodes) {
+            std::vector<std::thread> stopping;
+            for (size_t i : nodes) {
+                stopping.emplace_back([this, i]() { this->stopNode(i); });
+            }
+            for (auto &thread : stopping) {
+                thread.join();
+            }
+        }
+
+        nlohmann::json stats(size_t i) const {
+            return this->clients[i]->request({ { JSON::KEY::REQUEST, JSON::VALUE::REQUEST_STATS } })[JSON::KEY::STATS];
+        }
+
+        nlohmann::json raft(size_t i) const {
+            return this->stats(i)["raft"];
+        }
+
+        /**
+         * @brief the running member that is leader, waiting for an election if needed
+         * @return NODES if none was elected in time
+         */
+        size_t waitLeader() const {
+            size_t leader = NODES;
+            wait_until([this, &leader]() {
+                for (size_t i = 0; i < NODES; i++) {
+                    if (this->servers[i] != nullptr && this->raft(i)["role"] == "leader") {
+                        leader = i;
+                        return true;
+                    }
+                }
+                return false;
+            }, 30s);
+            return leader;
+        }
+
+        nlohmann::json write(size_t i, const string &key, const string &value) const {
+            return this->clients[i]->request({ { JSON::KEY::REQUEST, JSON::VALUE::REQUEST_WRITE }, { JSON::KEY::KEY, key }, { JSON::KEY::VALUE, value } });
+        }
+
+        nlohmann::json read(size_t i, const string &key) const {
+            return this->clients[i]->request({ { JSON::KEY::REQUEST, JSON::VALUE::REQUEST_READ }, { JSON::KEY::KEY, key } });
+        }
+    };
+
+    TEST_F(Test_RaftNode, Elects_One_Leader) {
+        const size_t leader = this->waitLeader();
+        ASSERT_LT(leader, NODES);
+
+        // the others follow it in the same term
+        const auto state = this->raft(leader);
+        ASSERT_EQ(this->nodeId(leader), state["leader"]);
+        for (size_t i = 0; i < NODES; i++) {
+            if (i == leader) {
+                continue;
+            }
+            ASSERT_TRUE(wait_until([this, i, &state]() {
+                const auto follower = this->raft(i);
+                return follower["role"] == "follower" && follower["leader"] == state["leader"] && follower["term"] == state["term"];
+            }));
+        }
+
+        ASSERT_EQ(JSON::VALUE::STATUS_OK, this->write(leader, "raft:a", "1")[JSON::KEY::STATUS]);
+        ASSERT_EQ("1", this->read(leader, "raft:a")[JSON::KEY::VALUE]);
+
+        // reads and writes finish as the log commits, each answer still finds its request by id
+        auto binary = StorageClient::create("127.0.0.1", this->ports[leader]);
+        binary->setFraming(tcp_framing::Binary);
+        std::vector<nlohmann::json> requests;
+        for (int i = 0; i < 50; i++) {
+            const string key = "raft:pipelined:" + std::to_string(i);
+            requests.push_back({ { JSON::KEY::REQUEST, JSON::VALUE::REQUEST_WRITE }, { JSON::KEY::KEY, key }, { JSON::KEY::VALUE, std::to_string(i) } });
+            requests.push_back({ { JSON::KEY::REQUEST, JSON::VALUE::REQUEST_READ }, { JSON::KEY::KEY, "raft:a" } });
+        }
+        const auto answers = binary->pipeline(requests);
+        for (size_t i = 0; i < answers.size(); i++) {
+            ASSERT_EQ(JSON::VALUE::STATUS_OK, answers[i][JSON::KEY::STATUS]) << i;
+            if (i % 2 == 1) {
+                ASSERT_EQ("1", answers[i][JSON::KEY::VALUE]) << i;
+            } else {
+                ASSERT_FALSE(answers[i].contains(JSON::KEY::VALUE)) << i;
+            }
+        }
+    }
+
+    TEST_F(Test_RaftNode, Write_Commits_After_Leader_Stops) {
+        const size_t first = this->waitLeader();
+        ASSERT_LT(first, NODES);
+        ASSERT_EQ(JSON::VALUE::STATUS_OK, this->write(first, "raft:before", "1")[JSON::KEY::STATUS]);
+        const uint64_t term = this->raft(first)["term"].get<uint64_t>();
+
+        this->stopNode(first);
+
+        // the two left are a majority
+        const size_t second = this->waitLeader();
+        ASSERT_LT(second, NODES);
+        ASSERT_NE(first, second);
+        ASSERT_GT(this->raft(second)["term"].get<uint64_t>(), term);
+
+        ASSERT_EQ(JSON::VALUE::STATUS_OK, this->write(second, "raft:after", "2")[JSON::KEY::STATUS]);
+        ASSERT_EQ("1", this->read(second, "raft:before")[JSON::KEY::VALUE]);
+        ASSERT_EQ("2", this->read(second, "raft:after")[JSON::KEY::VALUE]);
+
+        // committed on the other one too
+        for (size_t i = 0; i < NODES; i++) {
+            if (i != first && i != second) {
+                const uint64_t commit = this->raft(second)["commit_index"].get<uint64_t>();
+                ASSERT_TRUE(wait_until([this, i, commit]() { return this->raft(i)["commit_index"].get<uint64_t>() >= commit; }));
+            }
+        }
+    }
+
+    TEST_F(Test_RaftNode, Lease_Lost_Without_Majority) {
+        const size_t leader = this->waitLeader();
+        ASSERT_LT(leader, NODES);
+        ASSERT_EQ(JSON::VALUE::STATUS_OK, this->write(leader, "raft:lease", "1")[JSON::KEY::STATUS]);
+        ASSERT_TRUE(wait_until([this, leader]() { return this->raft(leader)["lease"] == true; }));
+
+        std::vector<size_t> followers;
+        for (size_t i = 0; i < NODES; i++) {
+            if (i != leader) {
+                followers.push_back(i);
+            }
+        }
+        this->stopNodes(followers);
+
+        // nobody answers, the lease runs out and the leader steps down
+        ASSERT_TRUE(wait_until([this, leader]() { return this->raft(leader)["lease"] == false; }));
+        ASSERT_TRUE(wait_until([this, leader]() { return this->raft(leader)["role"] != "leader"; }));
+        ASSERT_EQ(false, this->raft(leader)["lease"]);
+    }
+
+    TEST_F(Test_RaftNode, Divergent_Tail_Truncated) {
+        const size_t old = this->waitLeader();
+        ASSERT_LT(old, NODES);
+        ASSERT_EQ(JSON::VALUE::STATUS_OK, this->write(old, "raft:committed", "1")[JSON::KEY::STATUS]);
+        const uint64_t committed = this->raft(old)["commit_index"].get<uint64_t>();
+
+        std::vector<size_t> others;
+        for (size_t i = 0; i < NODES; i++) {
+            if (i != old) {
+                others.push_back(i);
+            }
+        }
+        this->stopNodes(others);
+
+        // still leader for an election timeout: the write goes into its log only, no answer comes
+        auto sender = tcp_client::create();
+        tcp::endpoint endpoint(boost::asio::ip::address::from_string("127.0.0.1"), this->ports[old]);
+        sender->connect(endpoint);
+        sender->start();
+        sender->send(nlohmann::json({ { JSON::KEY::REQUEST, JSON::VALUE::REQUEST_WRITE }, { JSON::KEY::KEY, "raft:lost" }, { JSON::KEY::VALUE, "1" } }).dump());
+        ASSERT_TRUE(wait_until([this, old, committed]() { return this->raft(old)["last_index"].get<uint64_t>() > committed; }));
+        const uint64_t divergent = this->raft(old)["last_index"].get<uint64_t>();
+        ASSERT_EQ(committed, this->raft(old)["commit_index"].get<uint64_t>());
+        sender->stop();
+        this->stopNode(old);
+
+        // the other two elect a leader in a later term and write over that index
+        for (size_t i : others) {
+            this->startNode(i);
+        }
+        const size_t leader = this->waitLeader();
+        ASSERT_LT(leader, NODES);
+        for (int i = 0; i < 3; i++) {
+            ASSERT_EQ(JSON::VALUE::STATUS_OK, this->write(leader, "raft:kept:" + std::to_string(i), "1")[JSON::KEY::STATUS]);
+        }
+        ASSERT_GE(this->raft(leader)["commit_index"].get<uint64_t>(), divergent);
+
+        // the old leader comes back with its tail, which gives way to the leader's entries
+        this->startNode(old);
+        ASSERT_TRUE(wait_until([this, old]() {
+            const size_t current = this->waitLeader();
+            if (current >= NODES || current == old) {
+                return false;
+            }
+            const auto leaderState = this->raft(current);
+            const auto state = this->raft(old);
+            return state["commit_index"] == leaderState["commit_index"] && state["last_index"] == leaderState["last_index"];
+        }, 30s));
+
+        // only the committed keys were applied there
+        const size_t current = this->waitLeader();
+        ASSERT_EQ(this->stats(current)["keys"], this->stats(old)["keys"]);
+        ASSERT_EQ(4, this->stats(old)["keys"]);
+        ASSERT_EQ("key not found in storage", this->read(current, "raft:lost")[JSON::KEY::DESCRIPTION]);
+    }
+}// namespace Diginext::Core::Storage::GTest
+
+#endif
@@ -0,0 +1,72 @@
+#ifndef DIGINEXT_GTEST___STORAGE_REPLICATION_LOG_TEST_H
+#define DIGINEXT_GTEST___STORAGE_REPLICATION_LOG_TEST_H
+
+#include <gtest/gtest.h>
+
+#include <Storage/ReplicationLog.h>
+
+#include <string>
+#include <vector>
+
+namespace Diginext::Core::Storage::GTest {
+    using namespace std;
+
+    TEST(Test_ReplicationLog, Positions_And_Resume) {
+        ReplicationLog log(1 << 20);
+        ASSERT_FALSE(log.getId().empty());
+        ASSERT_NE(log.getId(), ReplicationLog(1 << 20).getId());
+        ASSERT_EQ(0, log.getPosition());
+        ASSERT_TRUE(log.covers(0));
+        ASSERT_FALSE(log.covers(1));
+
+        for (int i = 1; i <= 100; i++) {
+            log.append(i % 10 == 0 ? WalRecordType::Remove : WalRecordType::Put, "key:" + std::to_string(i), "value");
+        }
+        ASSERT_EQ(100, log.getPosition());
+
+        // a reader resumes right after the position it has, in order
+        std::vector<uint64_t> positions;
+        ASSERT_EQ(5, log.read(40, 5, 1 << 20, [&positions](const ReplicationLog::Record &record) {
+            positions.push_back(record.position);
+            ASSERT_EQ("key:" + std::to_string(record.position), record.key);
+            ASSERT_EQ(record.position % 10 == 0 ? WalRecordType::Remove : WalRecordType::Put, record.type);
+        }));
+        ASSERT_EQ((std::vector<uint64_t>{ 41, 42, 43, 44, 45 }), positions);
+
+        // nothing after the head, and a position from the future is not covered
+        ASSERT_EQ(0, log.read(100, 10, 1 << 20, [](const ReplicationLog::Record &) { FAIL(); }));
+        ASSERT_FALSE(log.covers(101));
+
+        // the byte limit stops a read, but never before the first record
+        size_t count = 0;
+        ASSERT_EQ(1, log.read(0, 100, 1, [&count](const ReplicationLog::Record &) { count++; }));
+        ASSERT_EQ(1, count);
+    }
+
+    TEST(Test_ReplicationLog, Backlog_Drops_Oldest) {
+        const size_t MAX_BYTES = 64 * 1024;
+        ReplicationLog log(MAX_BYTES);
+        const string value(1000, 'v');
+        for (int i = 0; i < 1000; i++) {
+            log.append(WalRecordType::Put, "key:" + std::to_string(i), value);
+        }
+
+        ASSERT_LE(log.getBytes(), MAX_BYTES);
+        ASSERT_TRUE(log.covers(log.getPosition()));
+        ASSERT_FALSE(log.covers(0));
+        ASSERT_FALSE(log.covers(900));
+
+        // the oldest covered position reads on without a gap
+        uint64_t first = log.getPosition();
+        while (log.covers(first - 1)) {
+            first--;
+        }
+        uint64_t expected = first + 1;
+        log.read(first, 1000, static_cast<size_t>(-1), [&expected](const ReplicationLog::Record &record) {
+            ASSERT_EQ(expected++, record.position);
+        });
+        ASSERT_EQ(log.getPosition() + 1, expected);
+    }
+}// namespace Diginext::Core::Storage::GTest
+
+#endif
@@ -0,0 +1,139 @@
+#ifndef DIGINEXT_GTEST___STORAGE_REQUEST_CODEC_TEST_H
+#define DIGINEXT_GTEST___STORAGE_REQUEST_CODEC_TEST_H
+
+#include <gtest/gtest.h>
+
+#include <Storage/RequestCodec.h>
+#include <Storage/StorageCommon.h>
+
+#include <string>
+#include <vector>
+
+#include <nlohmann/json.hpp>
+
+namespace Diginext::Core::Storage::GTest {
+    using namespace std;
+
+    // what the generic path reads out of the same message
+    inline void expect_same_as_dom(const string &message, const ParsedRequest &parsed) {
+        const auto json = nlohmann::json::parse(message);
+        ASSERT_EQ(json[JSON::KEY::REQUEST].get<string>(), parsed.request) << message;
+        ASSERT_EQ(json.contains(JSON::KEY::KEY), parsed.hasKey) << message;
+        if (parsed.hasKey) {
+            ASSERT_EQ(json[JSON::KEY::KEY].get<string>(), parsed.key) << message;
+        }
+        ASSERT_EQ(json.contains(JSON::KEY::VALUE), parsed.hasValue) << message;
+        if (parsed.hasValue) {
+            ASSERT_EQ(json[JSON::KEY::VALUE].get<string>(), parsed.value) << message;
+        }
+        ASSERT_EQ(json.contains(JSON::KEY::TTL), parsed.hasTtl) << message;
+        if (parsed.hasTtl) {
+            ASSERT_EQ(json[JSON::KEY::TTL].get<int64_t>(), parsed.ttl) << message;
+        }
+        ASSERT_EQ(json.contains(JSON::KEY::IF_VERSION), parsed.hasIfVersion) << message;
+        if (parsed.hasIfVersion) {
+            ASSERT_EQ(json[JSON::KEY::IF_VERSION].get<uint64_t>(), parsed.ifVersion) << message;
+        }
+    }
+
+    TEST(Test_RequestCodec, Parses_Like_The_DOM) {
+        const vector<string> messages = {
+            R"({"request":"read","key":"user:1"})",
+            R"({"key":"user:1","request":"write","value":"v","ttl":1500,"if_version":18446744073709551615})",
+            " \t\r\n{ \"request\" : \"write\" ,\n\"key\":\"k\" , \"value\" : \"\" , \"ttl\" : -3 } \n",
+            R"({"request":"write","key":"k","value":"quote \" slash \\ \/ \b\f\n\r\t \u0000 é € 😀"})",
+            "{\"request\":\"write\",\"key\":\"caf\xc3\xa9 \xe2\x82\xac \xf0\x9f\x98\x80\",\"value\":\"raw utf-8\"}",
+            R"({"request":"read","key":"first","key":"second"})",
+            R"({"request":"stats"})",
+        };
+
+        ParsedRequest parsed;
+        for (const auto &message : messages) {
+            ASSERT_TRUE(parse_request(message, parsed)) << message;
+            expect_same_as_dom(message, parsed);
+        }
+
+        // no escapes - the key is a view into the message itself
+        const string plain = R"({"request":"read","key":"user:1"})";
+        ASSERT_TRUE(parse_request(plain, parsed));
+        ASSERT_GE(parsed.key.data(), plain.data());
+        ASSERT_LT(parsed.key.data(), plain.data() + plain.size());
+    }
+
+    TEST(Test_RequestCodec, Leaves_The_Rest_To_The_DOM) {
+        const vector<string> messages = {
+            "",
+            "[]",
+            R"({"key":"k"})",
+            R"({"request":"read","key":"k","txn":1})",
+            R"({"request":"read","key":{"nested":1}})",
+            R"({"request":"write","key":"k","value":null})",
+            R"({"request":"write","key":"k","value":1})",
+            R"({"request":"write","key":"k","value":"v","ttl":1.5})",
+            R"({"request":"write","key":"k","value":"v","ttl":1e3})",
+            R"({"request":"write","key":"k","value":"v","ttl":01})",
+            R"({"request":"read","key":"k","if_version":-1})",
+            R"({"request":"read","key":"k","if_version":18446744073709551616})",
+            R"({"request":"read","key":"lone \ud83d"})",
+            R"({"request":"read","key":"bad \x"})",
+            "{\"request\":\"read\",\"key\":\"\xff\"}",
+            "{\"request\":\"read\",\"key\":\"\xc0\xaf\"}",
+            "{\"request\":\"read\",\"key\":\"\xed\xa0\x80\"}",
+            "{\"request\":\"read\",\"key\":\"tab\tinside\"}",
+            R"({"request":"read","key":"k"} trailing)",
+            R"({"request":"read","key":"k",})",
+            R"({"request":"read","key":"k")",
+            R"({"request":"read" "key":"k"})",
+            R"({"request":1})",
+        };
+
+        ParsedRequest parsed;
+        for (const auto &message : messages) {
+            ASSERT_FALSE(parse_request(message, parsed)) << message;
+        }
+    }
+
+    TEST(Test_RequestCodec, Writer_Matches_Dump) {
+        string every;
+        for (int c = 0; c < 128; c++) {
+            every.push_back(static_cast<char>(c));
+        }
+        const vector<string> values = { "", "plain", every, "caf\xc3\xa9 \xe2\x82\xac \xf0\x9f\x98\x80", string(70000, 'v') };
+
+        ResponseWriter writer;
+        for (const auto &value : values) {
+            nlohmann::json json;
+            json[JSON::KEY::STATUS] = JSON::VALUE::STATUS_OK;
+            json[JSON::KEY::VALUE] = value;
+            json[JSON::KEY::VERSION] = uint64_t(18446744073709551615ULL);
+
+            const string &written = writer.begin()
+                                            .field(JSON::KEY::STATUS, JSON::VALUE::STATUS_OK)
+                                            .field(JSON::KEY::VALUE, value)
+                                            .field(JSON::KEY::VERSION, uint64_t(18446744073709551615ULL))
+                                            .end();
+            ASSERT_EQ(json.dump(), written);
+        }
+
+        nlohmann::json error;
+        error[JSON::KEY::STATUS] = JSON::VALUE::STATUS_ERROR;
+        error[JSON::KEY::DESCRIPTION] = "key not found in storage";
+        ASSERT_EQ(error.dump(), writer.begin().field(JSON::KEY::DESCRIPTION, "key not found in storage").field(JSON::KEY::STATUS, JSON::VALUE::STATUS_ERROR).end());
+        ASSERT_EQ("{}", writer.begin().end());
+    }
+
+    TEST(Test_RequestCodec, Valid_Utf8_As_Dump_Takes_It) {
+        for (const string &text : vector<string>{ "", "plain", "h\xc3\xa9", "\xe2\x82\xac", "\xf0\x9f\x98\x80", "\xf4\x8f\xbf\xbf", string("a\0b", 3) }) {
+            ASSERT_TRUE(valid_utf8(text)) << text;
+            ASSERT_NO_THROW(nlohmann::json(text).dump());
+        }
+
+        // cut, overlong, surrogate, above U+10FFFF, stray continuation
+        for (const string &text : vector<string>{ "\xff\xfe", "\xc3", "\xc0\xaf", "\xe0\x80\xaf", "\xed\xa0\x80", "\xf4\x90\x80\x80", "a\x80" }) {
+            ASSERT_FALSE(valid_utf8(text)) << text;
+            ASSERT_THROW(nlohmann::json(text).dump(), nlohmann::json::type_error);
+        }
+    }
+}// namespace Diginext::Core::Storage::GTest
+
+#endif
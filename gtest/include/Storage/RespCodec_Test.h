@@ -0,0 +1,198 @@
+#ifndef DIGINEXT_GTEST___STORAGE_RESP_CODEC_TEST_H
+#define DIGINEXT_GTEST___STORAGE_RESP_CODEC_TEST_H
+
+#include <gtest/gtest.h>
+
+#include <Storage/RespCodec.h>
+
+#include <string>
+#include <vector>
+
+namespace Diginext::Core::Storage::GTest {
+    using namespace std;
+
+    inline string resp_command_text(const vector<string> &args) {
+        string out;
+        resp_array(out, args.size());
+        for (const auto &arg : args) {
+            resp_bulk(out, arg);
+        }
+        return out;
+    }
+
+    // every command of the stream, fed in pieces of size bytes
+    inline vector<vector<string>> resp_parse_all(RespParser &parser, const string &stream, size_t size) {
+        vector<vector<string>> commands;
+        for (size_t pos = 0; pos < stream.size(); pos += size) {
+            const string chunk = stream.substr(pos, size);
+            parser.feed(chunk);
+            resp_parse status;
+            while ((status = parser.next()) == resp_parse::Command) {
+                commands.emplace_back(parser.getArgs().begin(), parser.getArgs().end());
+            }
+            EXPECT_EQ(resp_parse::Incomplete, status) << parser.getError();
+            parser.finish();
+        }
+        return commands;
+    }
+
+    TEST(Test_RespCodec, Parses_Pipelined_Commands_Cut_Anywhere) {
+        const vector<vector<string>> sent = {
+            { "SET", "key:1", "value" },
+            { "GET", "key:1" },
+            { "SET", "binary", string("\r\n\0$*", 5) },
+            { "SET", "empty", "" },
+            { "MSET", "a", string(5000, 'a'), "b", "b" },
+            { "PING" },
+        };
+
+        string stream;
+        for (const auto &command : sent) {
+            stream += resp_command_text(command);
+        }
+
+        // every cut of the stream, a command split across reads comes out whole
+        for (size_t size : { size_t(1), size_t(2), size_t(3), size_t(7), size_t(64), size_t(4096), stream.size() }) {
+            RespParser parser;
+            ASSERT_EQ(sent, resp_parse_all(parser, stream, size)) << "chunks of " << size;
+            ASSERT_EQ(0U, parser.buffered());
+        }
+    }
+
+    TEST(Test_RespCodec, Arguments_Point_Into_The_Read) {
+        const string chunk = resp_command_text({ "GET", "key:1" }) + resp_command_text({ "GET", "key:2" }) + "*2\r\n$3\r\nGET";
+
+        RespParser parser;
+        parser.feed(chunk);
+        for (const string key : { "key:1", "key:2" }) {
+            ASSERT_EQ(resp_parse::Command, parser.next());
+            const string_view arg = parser.getArgs()[1];
+            ASSERT_EQ(key, arg);
+            ASSERT_GE(arg.data(), chunk.data());
+            ASSERT_LT(arg.data(), chunk.data() + chunk.size());
+        }
+
+        // only the cut command is kept
+        ASSERT_EQ(resp_parse::Incomplete, parser.next());
+        parser.finish();
+        ASSERT_EQ(11U, parser.buffered());
+
+        // the next read completes it, the commands behind it are parsed in the read again
+        const string next = "\r\n$5\r\nkey:3\r\n" + resp_command_text({ "GET", "key:4" }) + "*2\r\n$3\r\nGET\r\n$5\r\nke";
+        parser.feed(next);
+        ASSERT_EQ(resp_parse::Command, parser.next());
+        ASSERT_EQ((vector<string_view>{ "GET", "key:3" }), parser.getArgs());
+        const string_view first = parser.getArgs()[1];
+        ASSERT_EQ(resp_parse::Command, parser.next());
+        ASSERT_EQ((vector<string_view>{ "GET", "key:4" }), parser.getArgs());
+        ASSERT_GE(parser.getArgs()[1].data(), next.data());
+        ASSERT_LT(parser.getArgs()[1].data(), next.data() + next.size());
+        ASSERT_EQ("key:3", first);
+        ASSERT_EQ(resp_parse::Incomplete, parser.next());
+        parser.finish();
+        ASSERT_EQ(19U, parser.buffered());
+
+        parser.feed("y:5\r\n");
+        ASSERT_EQ(resp_parse::Command, parser.next());
+        ASSERT_EQ((vector<string_view>{ "GET", "key:5" }), parser.getArgs());
+        ASSERT_EQ(resp_parse::Incomplete, parser.next());
+        parser.finish();
+        ASSERT_EQ(0U, parser.buffered());
+    }
+
+    TEST(Test_RespCodec, Batch_Ended_Early_Keeps_The_Rest) {
+        RespParser parser;
+        parser.feed("*1\r\n$4\r\nPI");
+        ASSERT_EQ(resp_parse::Incomplete, parser.next());
+        parser.finish();
+
+        // a QUIT stops the batch after the first command, what followed it is not lost
+        const string chunk = "NG\r\n" + resp_command_text({ "GET", "k" });
+        parser.feed(chunk);
+        ASSERT_EQ(resp_parse::Command, parser.next());
+        ASSERT_EQ((vector<string_view>{ "PING" }), parser.getArgs());
+        parser.finish();
+
+        parser.feed("");
+        ASSERT_EQ(resp_parse::Command, parser.next());
+        ASSERT_EQ((vector<string_view>{ "GET", "k" }), parser.getArgs());
+        parser.finish();
+        ASSERT_EQ(0U, parser.buffered());
+    }
+
+    TEST(Test_RespCodec, Inline_Commands_And_Empty_Ones) {
+        RespParser parser;
+        const auto commands = resp_parse_all(parser, "PING\r\n\r\n  set  k\tv \r\n*0\r\nget k\n", 5);
+        ASSERT_EQ((vector<vector<string>>{ { "PING" }, { "set", "k", "v" }, { "get", "k" } }), commands);
+    }
+
+    TEST(Test_RespCodec, Refuses_Malformed_Input) {
+        const vector<string> streams = {
+            "*x\r\n",
+            "*1\r\n+PING\r\n",
+            "*1\r\n$-1\r\n",
+            "*1\r\n$4\r\nPINGxx",
+            "*1\n$4\r\nPING\r\n",
+            "*1\r\n$" + std::to_string(RESP_MAX_BULK + 1) + "\r\n",
+            "*" + std::to_string(RESP_MAX_ARGUMENTS + 1) + "\r\n",
+            string(RESP_MAX_INLINE + 1, 'a'),
+        };
+
+        for (const auto &stream : streams) {
+            RespParser parser;
+            parser.feed(stream);
+            ASSERT_EQ(resp_parse::Error, parser.next()) << stream.substr(0, 32);
+            ASSERT_EQ(0U, parser.getError().find("Protocol error: ")) << parser.getError();
+        }
+    }
+
+    TEST(Test_RespCodec, Replies_Keep_Command_Order) {
+        RespReplies replies;
+        const uint64_t set = replies.begin();
+        const uint64_t get = replies.begin();
+        const uint64_t incr = replies.begin();
+
+        // the write waits for the log, the read behind it is answered first
+        replies.answer(get, "$1\r\nv\r\n");
+        replies.answer(incr, ":1\r\n");
+        ASSERT_EQ("", replies.ready());
+        ASSERT_EQ(3U, replies.waiting());
+
+        replies.answer(set, "+OK\r\n");
+        ASSERT_EQ("+OK\r\n$1\r\nv\r\n:1\r\n", replies.ready());
+        ASSERT_EQ(0U, replies.waiting());
+
+        // answered once only
+        replies.sent();
+        replies.answer(set, "+OK\r\n");
+        ASSERT_EQ("", replies.ready());
+    }
+
+    TEST(Test_RespCodec, Writes_Replies) {
+        string out;
+        resp_simple(out, "OK");
+        resp_error(out, "ERR two\r\nlines");
+        resp_integer(out, -9223372036854775807LL - 1);
+        resp_bulk(out, string("a\0b", 3));
+        resp_null(out);
+        resp_array(out, 2);
+        const char expected[] = "+OK\r\n-ERR two  lines\r\n:-9223372036854775808\r\n$3\r\na\0b\r\n$-1\r\n*2\r\n";
+        ASSERT_EQ(string(expected, sizeof(expected) - 1), out);
+    }
+
+    TEST(Test_RespCodec, Looks_Up_Commands) {
+        ASSERT_EQ(resp_command::Get, resp_command_lookup("GET")->command);
+        ASSERT_EQ(resp_command::Get, resp_command_lookup("gEt")->command);
+        ASSERT_EQ(resp_command::Del, resp_command_lookup("UNLINK")->command);
+        ASSERT_EQ(nullptr, resp_command_lookup("GETX"));
+        ASSERT_EQ(nullptr, resp_command_lookup(""));
+        ASSERT_EQ(nullptr, resp_command_lookup("averyveryverylongname"));
+
+        ASSERT_TRUE(resp_arity_ok(*resp_command_lookup("get"), 2));
+        ASSERT_FALSE(resp_arity_ok(*resp_command_lookup("get"), 3));
+        ASSERT_TRUE(resp_arity_ok(*resp_command_lookup("del"), 4));
+        ASSERT_FALSE(resp_arity_ok(*resp_command_lookup("del"), 1));
+    }
+}// namespace Diginext::Core::Storage::GTest
+
+#endif
@@ -0,0 +1,558 @@
+#ifndef DIGINEXT_GTEST___STORAGE_SHARDED_HASH_STORAGE_TEST_H
+#define DIGINEXT_GTEST___STORAGE_SHARDED_HASH_STORAGE_TEST_H
+
+#include <gtest/gtest.h>
+
+#include <Storage/ShardedHashStorage.h>
+#include <Storage/SlabAllocator.h>
+#include <Storage/StorageMemory.h>
+#include <Storage/VersionClock.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <iterator>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace Diginext::Core::Storage::GTest {
+    using namespace std;
+
+    TEST(Test_ShardedHashStorage, Shard_Count_Power_Of_Two) {
+        ASSERT_EQ(1, ShardedHashStorage(1).getShardCount());
+        ASSERT_EQ(8, ShardedHashStorage(5).getShardCount());
+        ASSERT_EQ(64, ShardedHashStorage().getShardCount());
+    }
+
+    TEST(Test_ShardedHashStorage, Put_Get) {
+        ShardedHashStorage storage;
+        string value;
+
+        ASSERT_FALSE(storage.get("key", value));
+
+        storage.put("key", "value");
+        ASSERT_TRUE(storage.get("key", value));
+        ASSERT_EQ("value", value);
+
+        storage.put("key", "value2");
+        ASSERT_TRUE(storage.get("key", value));
+        ASSERT_EQ("value2", value);
+        ASSERT_EQ(1, storage.size());
+
+        storage.put("", "empty key");
+        ASSERT_TRUE(storage.get("", value));
+        ASSERT_EQ("empty key", value);
+    }
+
+    TEST(Test_ShardedHashStorage, Remove) {
+        ShardedHashStorage storage;
+        string value;
+
+        storage.put("key", "value");
+        ASSERT_TRUE(storage.remove("key"));
+        ASSERT_FALSE(storage.remove("key"));
+        ASSERT_FALSE(storage.get("key", value));
+        ASSERT_EQ(0, storage.size());
+
+        storage.put("key", "value3");
+        ASSERT_TRUE(storage.get("key", value));
+        ASSERT_EQ("value3", value);
+    }
+
+    TEST(Test_ShardedHashStorage, Grow_And_Tombstones) {
+        ShardedHashStorage storage(2);
+        const int COUNT = 20000;
+
+        for (int i = 0; i < COUNT; i++) {
+            storage.put("key_" + std::to_string(i), std::to_string(i));
+        }
+        ASSERT_EQ(COUNT, storage.size());
+
+        for (int i = 0; i < COUNT; i += 2) {
+            ASSERT_TRUE(storage.remove("key_" + std::to_string(i)));
+        }
+        ASSERT_EQ(COUNT / 2, storage.size());
+
+        // churn on removed slots must not lose the remaining keys
+        for (int round = 0; round < 5; round++) {
+            for (int i = 0; i < COUNT; i += 2) {
+                storage.put("key_" + std::to_string(i), "x");
+                storage.remove("key_" + std::to_string(i));
+            }
+        }
+
+        string value;
+        for (int i = 0; i < COUNT; i++) {
+            const bool exists = storage.get("key_" + std::to_string(i), value);
+            ASSERT_EQ(i % 2 == 1, exists);
+            if (exists) {
+                ASSERT_EQ(std::to_string(i), value);
+            }
+        }
+    }
+
+    TEST(Test_ShardedHashStorage, Concurrent_Put_Get) {
+        ShardedHashStorage storage;
+        const int THREADS = 8;
+        const int COUNT = 5000;
+
+        std::vector<std::thread> threads;
+        for (int t = 0; t < THREADS; t++) {
+            threads.emplace_back([&storage, t]() {
+                for (int i = 0; i < COUNT; i++) {
+                    const string key = std::to_string(t) + "_" + std::to_string(i);
+                    storage.put(key, key);
+
+                    string value;
+                    storage.get(key, value);
+                }
+            });
+        }
+
+        for (auto &thread : threads) {
+            thread.join();
+        }
+
+        ASSERT_EQ(THREADS * COUNT, storage.size());
+
+        string value;
+        ASSERT_TRUE(storage.get("3_1234", value));
+        ASSERT_EQ("3_1234", value);
+    }
+
+    // value "<c><c>...<c>" of length derived from <c>, any mix of two writes is detectable
+    inline string makeStormValue(unsigned round) {
+        const unsigned letter = round % 26;
+        return string(64 + letter * 40, static_cast<char>('a' + letter));
+    }
+
+    inline bool isStormValue(const string &value) {
+        if (value.empty()) {
+            return false;
+        }
+
+        const unsigned letter = static_cast<unsigned>(value[0] - 'a');
+        if (letter >= 26 || value.size() != 64 + letter * 40) {
+            return false;
+        }
+
+        return value.find_first_not_of(value[0]) == string::npos;
+    }
+
+    TEST(Test_ShardedHashStorage, Lock_Free_Readers_Under_Overwrite_Storm) {
+        ShardedHashStorage storage(4);
+        const int KEYS = 64;
+        const int WRITERS = 4;
+        const int READERS = 4;
+        const auto DURATION = std::chrono::milliseconds(1500);
+
+        for (int i = 0; i < KEYS; i++) {
+            storage.put("key_" + std::to_string(i), makeStormValue(0));
+        }
+
+        std::atomic<bool> stop(false);
+        std::atomic<size_t> reads(0);
+        std::atomic<size_t> torn(0);
+        std::atomic<size_t> missing(0);
+
+        std::vector<std::thread> threads;
+        for (int t = 0; t < WRITERS; t++) {
+            threads.emplace_back([&, t]() {
+                unsigned round = t;
+                while (!stop.load()) {
+                    for (int i = 0; i < KEYS; i++) {
+                        const string key = "key_" + std::to_string(i);
+                        storage.put(key, makeStormValue(round++));
+
+                        // remove + put churns tombstones and forces table rebuilds
+                        const string extra = "extra_" + std::to_string(t) + "_" + std::to_string(round % 512);
+                        storage.put(extra, makeStormValue(round));
+                        storage.remove(extra);
+                    }
+                }
+            });
+        }
+
+        for (int t = 0; t < READERS; t++) {
+            threads.emplace_back([&, t]() {
+                string value;
+                size_t localReads = 0;
+                while (!stop.load()) {
+                    for (int i = 0; i < KEYS; i++) {
+                        const string key = "key_" + std::to_string(i);
+                        if (t % 2 == 0) {
+                            if (!storage.get(key, value)) {
+                                missing++;
+                            } else if (!isStormValue(value)) {
+                                torn++;
+                            }
+                        } else {
+                            const value_pointer shared = storage.getShared(key);
+                            if (shared == nullptr) {
+                                missing++;
+                            } else if (!isStormValue(*shared)) {
+                                torn++;
+                            }
+                        }
+
+                        localReads++;
+                    }
+                }
+
+                reads += localReads;
+            });
+        }
+
+        std::this_thread::sleep_for(DURATION);
+        stop = true;
+        for (auto &thread : threads) {
+            thread.join();
+        }
+
+        ASSERT_GT(reads.load(), 0);
+        ASSERT_EQ(0, torn.load());
+        ASSERT_EQ(0, missing.load());
+        ASSERT_EQ(KEYS, storage.size());
+    }
+
+    TEST(Test_ShardedHashStorage, Shared_Value_Outlives_Overwrite) {
+        ShardedHashStorage storage;
+        storage.put("key", "old");
+
+        const value_pointer old = storage.getShared("key");
+        for (int i = 0; i < 1000; i++) {
+            storage.put("key", "new_" + std::to_string(i));
+        }
+        storage.remove("key");
+
+        ASSERT_NE(nullptr, old);
+        ASSERT_EQ("old", *old);
+        ASSERT_EQ(nullptr, storage.getShared("key"));
+    }
+
+    TEST(Test_ShardedHashStorage, Memory_Accounting) {
+        size_t bytes = 0;
+        ASSERT_TRUE(memory_size_from_string("512mb", bytes));
+        ASSERT_EQ(size_t(512) << 20, bytes);
+        ASSERT_TRUE(memory_size_from_string("4096", bytes));
+        ASSERT_EQ(4096, bytes);
+        ASSERT_FALSE(memory_size_from_string("lots", bytes));
+
+        ShardedHashStorage storage(4);
+        const size_t empty = storage.memoryUsage();
+        ASSERT_GT(empty, 0);
+
+        // shared value buffer grows by exactly the difference of heap allocations
+        storage.put("a long key that does not fit inline", string(1000, 'v'));
+        const size_t small = storage.memoryUsage();
+        storage.put("a long key that does not fit inline", string(2000, 'v'));
+        ASSERT_EQ(1000, storage.memoryUsage() - small);
+
+        // an inline value of the same size reuses a slot of the same class
+        storage.put("inline", string(100, 'v'));
+        const size_t inlined = storage.memoryUsage();
+        storage.put("inline", string(100, 'w'));
+        ASSERT_EQ(inlined, storage.memoryUsage());
+        storage.remove("inline");
+
+        // back to the start once every key is gone, tables stay at their grown size
+        for (int i = 0; i < 10; i++) {
+            storage.put("key:" + std::to_string(i) + string(40, 'k'), string(i * 10, 'v'));
+        }
+        for (int i = 0; i < 10; i++) {
+            storage.remove("key:" + std::to_string(i) + string(40, 'k'));
+        }
+        storage.remove("a long key that does not fit inline");
+        ASSERT_EQ(empty, storage.memoryUsage());
+    }
+
+    TEST(Test_ShardedHashStorage, Inline_And_Shared_Values) {
+        ShardedHashStorage storage(4);
+        const size_t sizes[] = { 0, 1, 255, 256, 257, 480, 1000, 100000 };
+        for (size_t size : sizes) {
+            const string key = "key:" + std::to_string(size);
+            const string value(size, static_cast<char>('a' + size % 26));
+            storage.put(key, value);
+
+            string read;
+            ASSERT_TRUE(storage.get(key, read));
+            ASSERT_EQ(value, read);
+
+            auto shared = storage.getShared(key);
+            ASSERT_NE(nullptr, shared);
+            ASSERT_EQ(value, *shared);
+        }
+
+        // a buffer handed out stays valid after the key is overwritten
+        auto held = storage.getShared("key:1000");
+        storage.put("key:1000", "short");
+        ASSERT_EQ(string(1000, static_cast<char>('a' + 1000 % 26)), *held);
+
+        size_t count = 0;
+        storage.forEach([&count](const string_view &key, const string_view &value) {
+            count++;
+            if (key == "key:1000") {
+                ASSERT_EQ("short", value);
+            }
+        });
+        ASSERT_EQ(std::size(sizes), count);
+    }
+
+    TEST(Test_ShardedHashStorage, Version_Clock) {
+        VersionClock clock;
+        const uint64_t start = VersionClock::now();
+
+        // strictly increasing from every thread, never below the wall clock
+        std::vector<std::vector<uint64_t>> seen(4);
+        std::vector<std::thread> threads;
+        for (size_t t = 0; t < seen.size(); t++) {
+            threads.emplace_back([&clock, &seen, t]() {
+                for (int i = 0; i < 10000; i++) {
+                    seen[t].push_back(clock.next());
+                }
+            });
+        }
+        for (auto &thread : threads) {
+            thread.join();
+        }
+
+        std::vector<uint64_t> all;
+        for (const auto &versions : seen) {
+            for (size_t i = 1; i < versions.size(); i++) {
+                ASSERT_LT(versions[i - 1], versions[i]);
+            }
+            all.insert(all.end(), versions.begin(), versions.end());
+        }
+
+        std::sort(all.begin(), all.end());
+        ASSERT_EQ(all.end(), std::adjacent_find(all.begin(), all.end()));
+        ASSERT_GE(all.front(), start);
+        ASSERT_EQ(all.back(), clock.current());
+    }
+
+    TEST(Test_ShardedHashStorage, Slab_Allocator) {
+        SlabAllocator slab;
+        const size_t MAX_SLOT_SIZE = SlabAllocator::MAX_SLOT_SIZE;
+        ASSERT_EQ(16, SlabAllocator::slotSize(1));
+        ASSERT_EQ(48, SlabAllocator::slotSize(33));
+        ASSERT_EQ(MAX_SLOT_SIZE, SlabAllocator::slotSize(MAX_SLOT_SIZE));
+        ASSERT_EQ(0, SlabAllocator::slotSize(MAX_SLOT_SIZE + 1));
+
+        // slots of a class never overlap and freed slots are reused
+        std::vector<char *> slots;
+        for (int i = 0; i < 10000; i++) {
+            char *slot = static_cast<char *>(slab.allocate(40));
+            std::memset(slot, i & 0xff, 40);
+            slots.push_back(slot);
+        }
+        ASSERT_EQ(10000 * 48, slab.getUsedBytes());
+        for (size_t i = 0; i < slots.size(); i++) {
+            ASSERT_EQ(static_cast<char>(i & 0xff), slots[i][39]);
+        }
+
+        const size_t pages = slab.getPageCount();
+        for (char *slot : slots) {
+            SlabAllocator::release(slot);
+        }
+        ASSERT_EQ(0, slab.getUsedBytes());
+        ASSERT_LT(slab.getPageCount(), pages);
+
+        void *again = slab.allocate(40);
+        ASSERT_NE(nullptr, again);
+        SlabAllocator::release(again);
+    }
+
+    TEST(Test_ShardedHashStorage, Memory_Limit_Evicts) {
+        const size_t LIMIT = 4 * 1024 * 1024;
+        ShardedHashStorage storage(8);
+        storage.setMemoryLimit(LIMIT);
+
+        for (int i = 0; i < 100000; i++) {
+            storage.put("key:" + std::to_string(i), string(100, 'v'));
+            ASSERT_LE(storage.memoryUsage(), LIMIT);
+        }
+
+        ASSERT_GT(storage.getEvictions(), 0);
+        ASSERT_EQ(100000 - storage.getEvictions(), storage.size());
+
+        // the newest key is never its own victim
+        string value;
+        ASSERT_TRUE(storage.get("key:99999", value));
+    }
+
+    TEST(Test_ShardedHashStorage, Eviction_Is_Scan_Resistant) {
+        const int KEYS = 20000;
+        ShardedHashStorage storage(8);
+        for (int i = 0; i < KEYS; i++) {
+            storage.put("key:" + std::to_string(i), string(100, 'v'));
+        }
+        storage.setMemoryLimit(storage.memoryUsage());
+
+        // a small hot set read often, then one pass over everything else
+        const int HOT = KEYS / 10;
+        for (int round = 0; round < 4; round++) {
+            for (int i = 0; i < HOT; i++) {
+                storage.getShared("key:" + std::to_string(i));
+            }
+        }
+        for (int i = HOT; i < KEYS; i++) {
+            storage.getShared("key:" + std::to_string(i));
+        }
+
+        for (int i = 0; i < KEYS / 2; i++) {
+            storage.put("new:" + std::to_string(i), string(100, 'v'));
+        }
+        ASSERT_GT(storage.getEvictions(), KEYS / 4);
+
+        int hot = 0;
+        for (int i = 0; i < HOT; i++) {
+            hot += storage.getShared("key:" + std::to_string(i)) != nullptr ? 1 : 0;
+        }
+        ASSERT_GE(hot, HOT * 95 / 100);
+    }
+    TEST(Test_ShardedHashStorage, Snapshot_Isolation) {
+        ShardedHashStorage storage(4);
+        storage.put("changed", "before");
+        storage.put("removed", "before");
+        storage.put("kept", "before");
+        const size_t start = storage.memoryUsage();
+
+        const uint64_t snapshot = storage.acquireSnapshot();
+        for (int i = 0; i < 100; i++) {
+            storage.put("changed", "after_" + std::to_string(i));
+        }
+        storage.remove("removed");
+        storage.put("added", "after");
+
+        uint64_t version = 0;
+        ASSERT_EQ("before", *storage.getAt("changed", snapshot, &version));
+        ASSERT_LE(version, snapshot);
+        ASSERT_EQ("before", *storage.getAt("removed", snapshot));
+        ASSERT_EQ("before", *storage.getAt("kept", snapshot));
+        ASSERT_EQ(nullptr, storage.getAt("added", snapshot));
+
+        // the collector keeps only what the open snapshot reads: one old value and one removed key
+        ASSERT_EQ(1, storage.getSnapshotCount());
+        storage.collectHistory();
+        ASSERT_EQ(3, storage.historySize());
+        ASSERT_EQ("before", *storage.getAt("changed", snapshot));
+        ASSERT_EQ("before", *storage.getAt("removed", snapshot));
+        ASSERT_EQ("after_99", *storage.getShared("changed"));
+        ASSERT_EQ(nullptr, storage.getShared("removed"));
+
+        storage.releaseSnapshot(snapshot);
+        storage.collectHistory();
+        ASSERT_EQ(0, storage.getSnapshotCount());
+        ASSERT_EQ(0, storage.historySize());
+
+        storage.remove("added");
+        storage.put("removed", "before");
+        storage.put("changed", "before");
+        ASSERT_EQ(start, storage.memoryUsage());
+    }
+
+    TEST(Test_ShardedHashStorage, Commit_Conflict_And_Atomicity) {
+        ShardedHashStorage storage(4);
+        storage.put("a", "1");
+        storage.put("b", "1");
+
+        const uint64_t first = storage.acquireSnapshot();
+        const uint64_t second = storage.acquireSnapshot();
+
+        const uint64_t committed = storage.commit(first, { "a", "b" }, { { "a", "2" }, { "b", "2" } });
+        ASSERT_GT(committed, second);
+        uint64_t version = 0;
+        ASSERT_EQ("2", *storage.getVersioned("a", version));
+        ASSERT_EQ(committed, version);
+        ASSERT_EQ("2", *storage.getShared("b"));
+
+        // read "b" at the older snapshot, which changed since: nothing of it is written
+        ASSERT_EQ(0, storage.commit(second, { "b", "c" }, { { "b", "3" }, { "c", "3" } }));
+        ASSERT_EQ("2", *storage.getShared("b"));
+        ASSERT_EQ(nullptr, storage.getShared("c"));
+
+        // disjoint keys do not conflict, read-only commits never do
+        ASSERT_GT(storage.commit(second, { "c" }, { { "c", "3" } }), committed);
+        ASSERT_EQ(second, storage.commit(second, { "a", "b" }, {}));
+        ASSERT_EQ("1", *storage.getAt("a", second));
+
+        storage.releaseSnapshot(second);
+        storage.releaseSnapshot(first);
+        storage.collectHistory();
+        ASSERT_EQ(0, storage.historySize());
+    }
+
+    TEST(Test_ShardedHashStorage, Concurrent_Transactions_Keep_Invariant) {
+        const int ACCOUNTS = 16;
+        const int TRANSFERS = 2000;
+        ShardedHashStorage storage(8);
+        for (int i = 0; i < ACCOUNTS; i++) {
+            storage.put("account:" + std::to_string(i), "100");
+        }
+
+        std::atomic<int> committed{0};
+        std::atomic<bool> stop{false};
+        std::atomic<bool> broken{false};
+
+        // snapshot readers see a consistent total while transfers commit, and never block them
+        std::thread auditor([&]() {
+            while (!stop.load()) {
+                const uint64_t snapshot = storage.acquireSnapshot();
+                long total = 0;
+                for (int i = 0; i < ACCOUNTS; i++) {
+                    total += std::stol(*storage.getAt("account:" + std::to_string(i), snapshot));
+                }
+                storage.releaseSnapshot(snapshot);
+                if (total != ACCOUNTS * 100) {
+                    broken = true;
+                }
+            }
+        });
+
+        std::vector<std::thread> writers;
+        for (int t = 0; t < 4; t++) {
+            writers.emplace_back([&storage, &committed, t]() {
+                uint64_t state = t + 1;
+                for (int i = 0; i < TRANSFERS; i++) {
+                    state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+                    const string from = "account:" + std::to_string((state >> 33) % ACCOUNTS);
+                    const string to = "account:" + std::to_string((state >> 40) % ACCOUNTS);
+                    if (from == to) {
+                        continue;
+                    }
+
+                    const uint64_t snapshot = storage.acquireSnapshot();
+                    const long fromBalance = std::stol(*storage.getAt(from, snapshot));
+                    const long toBalance = std::stol(*storage.getAt(to, snapshot));
+                    if (storage.commit(snapshot, { from, to },
+                                       { { from, std::to_string(fromBalance - 1) }, { to, std::to_string(toBalance + 1) } }) != 0) {
+                        committed++;
+                    }
+                    storage.releaseSnapshot(snapshot);
+                }
+            });
+        }
+
+        for (auto &writer : writers) {
+            writer.join();
+        }
+        stop = true;
+        auditor.join();
+
+        ASSERT_FALSE(broken.load());
+        ASSERT_GT(committed.load(), 0);
+
+        long total = 0;
+        for (int i = 0; i < ACCOUNTS; i++) {
+            total += std::stol(*storage.getShared("account:" + std::to_string(i)));
+        }
+        ASSERT_EQ(ACCOUNTS * 100, total);
+
+        storage.collectHistory();
+        ASSERT_EQ(0, storage.historySize());
+    }
+}// namespace Diginext::Core::Storage::GTest
+
+#endif
@@ -0,0 +1,133 @@
+#ifndef DIGINEXT_GTEST___STORAGE_SNAPSHOT_FILE_TEST_H
+#define DIGINEXT_GTEST___STORAGE_SNAPSHOT_FILE_TEST_H
+
+#include <gtest/gtest.h>
+
+#include "Storage/StorageTestUtils.h"
+
+#include <Storage/ShardedHashStorage.h>
+#include <Storage/SnapshotFile.h>
+
+#include <cstdio>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace Diginext::Core::Storage::GTest {
+    using namespace std;
+
+    inline void writeSnapshot(const string &path, const std::map<string, string> &data, uint64_t walOffset = 0) {
+        SnapshotFile::write(path, [&data](const SnapshotFile::record_callback &emit) {
+            for (const auto &record : data) {
+                emit(record.first, record.second);
+            }
+        }, walOffset);
+    }
+
+    TEST(Test_SnapshotFile, Write_Open_Find) {
+        TempPath path(".snap");
+
+        std::map<string, string> data;
+        for (int i = 0; i < 10000; i++) {
+            data["key:" + std::to_string(i)] = string(i % 300, char('a' + i % 26));
+        }
+        data[""] = "empty key";
+        data[string("bin\0key", 7)] = string("bin\0value", 9);
+
+        writeSnapshot(path.get(), data, 12345);
+
+        auto snapshot = SnapshotFile::open(path.get());
+        ASSERT_NE(nullptr, snapshot);
+        ASSERT_EQ(data.size(), snapshot->getCount());
+        ASSERT_EQ(12345, snapshot->getWalOffset());
+
+        for (const auto &record : data) {
+            string_view value;
+            ASSERT_TRUE(snapshot->find(record.first, value));
+            ASSERT_EQ(record.second, value);
+        }
+
+        ASSERT_FALSE(snapshot->contains("key:10000"));
+        ASSERT_FALSE(snapshot->contains("missing"));
+
+        std::map<string, string> visited;
+        snapshot->forEach([&visited](string_view key, string_view value) {
+            visited[string(key)] = string(value);
+        });
+        ASSERT_EQ(data, visited);
+    }
+
+    TEST(Test_SnapshotFile, Missing_And_Corrupted) {
+        TempPath path(".snap");
+        ASSERT_EQ(nullptr, SnapshotFile::open(path.get()));
+
+        writeSnapshot(path.get(), { { "a", "1" } });
+        ASSERT_NE(nullptr, SnapshotFile::open(path.get()));
+
+        FILE *file = std::fopen(path.get().c_str(), "r+b");
+        ASSERT_NE(nullptr, file);
+        std::fseek(file, 20, SEEK_SET);
+        std::fputc(0x7f, file);
+        std::fclose(file);
+
+        ASSERT_EQ(nullptr, SnapshotFile::open(path.get()));
+    }
+
+    TEST(Test_SnapshotFile, Storage_Over_Snapshot) {
+        TempPath path(".snap");
+        writeSnapshot(path.get(), { { "a", "1" }, { "b", "2" }, { "c", "3" } });
+
+        auto storage = ShardedHashStorage::create(4);
+        storage->attachBase(SnapshotFile::open(path.get()));
+        ASSERT_EQ(3, storage->size());
+
+        string value;
+        ASSERT_TRUE(storage->get("b", value));
+        ASSERT_EQ("2", value);
+
+        storage->put("b", "20");
+        storage->put("d", "4");
+        storage->remove("c");
+        storage->remove("missing");
+        ASSERT_EQ(3, storage->size());
+
+        ASSERT_TRUE(storage->get("b", value));
+        ASSERT_EQ("20", value);
+        ASSERT_FALSE(storage->get("c", value));
+        ASSERT_EQ(nullptr, storage->getShared("c"));
+
+        storage->put("c", "30");
+        ASSERT_EQ(4, storage->size());
+        ASSERT_TRUE(storage->get("c", value));
+        ASSERT_EQ("30", value);
+
+        storage->remove("a");
+        ASSERT_EQ(3, storage->size());
+
+        std::map<string, string> visited;
+        storage->forEach([&visited](string_view key, string_view value) {
+            visited[string(key)] = string(value);
+        });
+        ASSERT_EQ((std::map<string, string>{ { "b", "20" }, { "c", "30" }, { "d", "4" } }), visited);
+
+        // base keys join the ordered index on the first scan
+        std::vector<string> scanned;
+        storage->scan("", "", [&scanned](string_view key, string_view) {
+            scanned.emplace_back(key);
+            return true;
+        });
+        ASSERT_EQ((std::vector<string>{ "b", "c", "d" }), scanned);
+
+        // snapshot of the merged view round-trips
+        TempPath next(".snap");
+        SnapshotFile::write(next.get(), [&storage](const SnapshotFile::record_callback &emit) { storage->forEach(emit); });
+        auto reopened = ShardedHashStorage::create(4);
+        reopened->attachBase(SnapshotFile::open(next.get()));
+        ASSERT_EQ(3, reopened->size());
+        ASSERT_TRUE(reopened->get("d", value));
+        ASSERT_EQ("4", value);
+        ASSERT_FALSE(reopened->get("a", value));
+    }
+}// namespace Diginext::Core::Storage::GTest
+
+#endif
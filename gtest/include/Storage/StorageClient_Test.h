@@ -0,0 +1,262 @@
+#ifndef DIGINEXT_GTEST___STORAGE_STORAGE_CLIENT_TEST_H
+#define DIGINEXT_GTEST___STORAGE_STORAGE_CLIENT_TEST_H
+
+#include <gtest/gtest.h>
+
+#include "Storage/StorageTestUtils.h"
+
+#include <Storage/StorageClient.h>
+#include <Storage/StorageCommon.h>
+#include <Storage/StorageScan.h>
+#include <Storage/StorageServer.h>
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include <nlohmann/json.hpp>
+
+namespace Diginext::Core::Storage::GTest {
+    using namespace std;
+
+    /**
+     * \brief a client over two real servers: the first grants binary framing, the second
+     * base64 only; every access feeds their hot key trackers
+     */
+    class Test_StorageClient : public testing::Test {
+    protected:
+        static std::vector<StorageServer::pointer> servers;
+        static std::vector<string> endpoints;
+
+        /**
+         * @brief key routed to endpoint, named prefix:n
+         */
+        static string keyOn(const StorageClient::pointer &client, const string &endpoint, const string &prefix) {
+            for (int i = 0;; i++) {
+                const string key = prefix + ":" + std::to_string(i);
+                if (client->locate(key) == endpoint) {
+                    return key;
+                }
+            }
+        }
+
+        static void SetUpTestSuite() {
+            StorageOptions options;
+            options.hotKeySample = 1;
+            servers.push_back(start_server(options));
+
+            options.acceptFraming = tcp_framing::Base64Line;
+            servers.push_back(start_server(options));
+
+            for (const auto &server : servers) {
+                endpoints.push_back("127.0.0.1:" + std::to_string(server->getPort()));
+            }
+        }
+
+        static void TearDownTestSuite() {
+            servers.clear();
+            endpoints.clear();
+        }
+
+        /**
+         * @brief client over both servers asking for binary framing, the second one grants base64
+         */
+        static StorageClient::pointer connect() {
+            auto client = StorageClient::create(endpoints);
+            client->setFraming(tcp_framing::Binary);
+            return client;
+        }
+    };
+
+    std::vector<StorageServer::pointer> Test_StorageClient::servers;
+    std::vector<string> Test_StorageClient::endpoints;
+
+    TEST_F(Test_StorageClient, Hot_Keys) {
+        auto client = connect();
+        const string first = keyOn(client, endpoints[0], "hot");
+        const string second = keyOn(client, endpoints[1], "hot");
+        const string third = keyOn(client, endpoints[0], "warm");
+
+        client->request({ { JSON::KEY::REQUEST, JSON::VALUE::REQUEST_WRITE }, { JSON::KEY::KEY, first }, { JSON::KEY::VALUE, "1" } });
+        for (int i = 0; i < 400; i++) {
+            client->request({ { JSON::KEY::REQUEST, JSON::VALUE::REQUEST_READ }, { JSON::KEY::KEY, first } });
+            if (i < 250) {
+                client->request({ { JSON::KEY::REQUEST, JSON::VALUE::REQUEST_READ }, { JSON::KEY::KEY, second } });
+            }
+            if (i < 100) {
+                client->request({ { JSON::KEY::REQUEST, JSON::VALUE::REQUEST_READ }, { JSON::KEY::KEY, third } });
+            }
+        }
+
+        // the stats section of one server
+        auto single = StorageClient::create("127.0.0.1", servers[0]->getPort());
+        const auto stats = single->request({ { JSON::KEY::REQUEST, JSON::VALUE::REQUEST_STATS } })[JSON::KEY::STATS];
+        ASSERT_TRUE(stats.contains("hot"));
+        ASSERT_EQ(1, stats["hot"]["sample"]);
+        ASSERT_GE(stats["hot"]["sampled"].get<uint64_t>(), 501);
+        const auto &top = stats["hot"]["keys"][0];
+        ASSERT_EQ(first, top[JSON::KEY::KEY]);
+        ASSERT_GE(top["accesses"].get<uint64_t>(), 401);
+        ASSERT_GE(top["reads"].get<uint64_t>(), 400);
+        ASSERT_GE(top["writes"].get<uint64_t>(), 1);
+
+        // merged over both servers, hottest first, each with its server
+        auto hot = client->hotKeys(3);
+        ASSERT_EQ(3, hot.size());
+        ASSERT_EQ(first, hot[0][JSON::KEY::KEY]);
+        ASSERT_EQ(endpoints[0], hot[0][JSON::KEY::SHARD]);
+        ASSERT_EQ(second, hot[1][JSON::KEY::KEY]);
+        ASSERT_EQ(endpoints[1], hot[1][JSON::KEY::SHARD]);
+        ASSERT_EQ(third, hot[2][JSON::KEY::KEY]);
+        ASSERT_GE(hot[0]["accesses"].get<uint64_t>(), hot[1]["accesses"].get<uint64_t>());
+        ASSERT_GE(hot[1]["accesses"].get<uint64_t>(), hot[2]["accesses"].get<uint64_t>());
+
+        ASSERT_EQ(1, client->hotKeys(1).size());
+    }
+
+    TEST_F(Test_StorageClient, Batches_Keep_Request_Order) {
+        auto client = connect();
+        const string a = keyOn(client, endpoints[0], "order");
+        const string b = keyOn(client, endpoints[1], "order");
+        const string c = keyOn(client, endpoints[0], "order:next");
+        const string d = keyOn(client, endpoints[1], "order:next");
+
+        nlohmann::json items = nlohmann::json::array();
+        for (const auto &key : { d, a, c, b }) {
+            items.push_back({ { JSON::KEY::KEY, key }, { JSON::KEY::VALUE, "value of " + key } });
+        }
+        auto answer = client->request({ { JSON::KEY::REQUEST, JSON::VALUE::REQUEST_MPUT }, { JSON::KEY::ITEMS, items } });
+        ASSERT_EQ(JSON::VALUE::STATUS_OK, answer[JSON::KEY::STATUS]);
+
+        // the servers' parts are put back where their keys were asked for
+        answer = client->request({ { JSON::KEY::REQUEST, JSON::VALUE::REQUEST_MGET },
+                                   { JSON::KEY::KEYS, { b, "order:missing", a, d, c, b } } });
+        ASSERT_EQ(JSON::VALUE::STATUS_OK, answer[JSON::KEY::STATUS]);
+        ASSERT_EQ(nlohmann::json({ "value of " + b, nullptr, "value of " + a, "value of " + d, "value of " + c, "value of " + b }),
+                  answer[JSON::KEY::VALUES]);
+
+        // an empty batch is answered without asking any server
+        answer = client->request({ { JSON::KEY::REQUEST, JSON::VALUE::REQUEST_MGET }, { JSON::KEY::KEYS, nlohmann::json::array() } });
+        ASSERT_EQ(JSON::VALUE::STATUS_OK, answer[JSON::KEY::STATUS]);
+        ASSERT_EQ(nlohmann::json::array(), answer[JSON::KEY::VALUES]);
+        answer = client->request({ { JSON::KEY::REQUEST, JSON::VALUE::REQUEST_MPUT }, { JSON::KEY::ITEMS, nlohmann::json::array() } });
+        ASSERT_EQ(JSON::VALUE::STATUS_OK, answer[JSON::KEY::STATUS]);
+        ASSERT_FALSE(answer.contains(JSON::KEY::VALUES));
+    }
+
+    TEST_F(Test_StorageClient, Partial_Failure_Names_Shard) {
+        // a third server nobody listens for
+        std::vector<string> withDead = endpoints;
+        withDead.push_back("127.0.0.1:" + std::to_string(free_port()));
+        auto client = StorageClient::create(withDead);
+
+        const string live = keyOn(client, endpoints[0], "partial");
+        const string dead = keyOn(client, withDead[2], "partial");
+        auto answer = client->request({ { JSON::KEY::REQUEST, JSON::VALUE::REQUEST_MGET }, { JSON::KEY::KEYS, { live, dead } } });
+        ASSERT_EQ(JSON::VALUE::STATUS_ERROR, answer[JSON::KEY::STATUS]);
+        ASSERT_EQ(withDead[2], answer[JSON::KEY::SHARD]);
+
+        nlohmann::json items = nlohmann::json::array();
+        items.push_back({ { JSON::KEY::KEY, live }, { JSON::KEY::VALUE, "1" } });
+        items.push_back({ { JSON::KEY::KEY, dead }, { JSON::KEY::VALUE, "1" } });
+        answer = client->request({ { JSON::KEY::REQUEST, JSON::VALUE::REQUEST_MPUT }, { JSON::KEY::ITEMS, items } });
+        ASSERT_EQ(JSON::VALUE::STATUS_ERROR, answer[JSON::KEY::STATUS]);
+        ASSERT_EQ(withDead[2], answer[JSON::KEY::SHARD]);
+
+        // the live server applied its part
+        answer = connect()->request({ { JSON::KEY::REQUEST, JSON::VALUE::REQUEST_READ }, { JSON::KEY::KEY, live } });
+        ASSERT_EQ("1", answer[JSON::KEY::VALUE]);
+    }
+
+    TEST_F(Test_StorageClient, Streamed_Scans_Merged) {
+        auto client = connect();
+
+        // several chunks from each server
+        const size_t count = 3 * SCAN_CHUNK_ITEMS;
+        nlohmann::json items = nlohmann::json::array();
+        for (size_t i = 0; i < count; i++) {
+            items.push_back({ { JSON::KEY::KEY, "scan:" + std::to_string(1000 + i) }, { JSON::KEY::VALUE, std::to_string(i) } });
+        }
+        ASSERT_EQ(JSON::VALUE::STATUS_OK, client->request({ { JSON::KEY::REQUEST, JSON::VALUE::REQUEST_MPUT }, { JSON::KEY::ITEMS, items } })[JSON::KEY::STATUS]);
+
+        const auto answer = client->request({ { JSON::KEY::REQUEST, JSON::VALUE::REQUEST_SCAN }, { JSON::KEY::PREFIX, "scan:" } });
+        ASSERT_EQ(JSON::VALUE::STATUS_OK, answer[JSON::KEY::STATUS]);
+
+        size_t total = 0;
+        for (const auto &endpoint : endpoints) {
+            const auto &part = answer[JSON::KEY::SHARDS][endpoint];
+            ASSERT_EQ(JSON::VALUE::STATUS_OK, part[JSON::KEY::STATUS]);
+            ASSERT_EQ(true, part[JSON::KEY::FINAL]);
+            ASSERT_FALSE(part.contains(JSON::KEY::CURSOR));
+            ASSERT_GT(part[JSON::KEY::ITEMS].size(), SCAN_CHUNK_ITEMS);
+
+            // one message, the chunks' items in key order, each on its server
+            string previous;
+            for (const auto &item : part[JSON::KEY::ITEMS]) {
+                const string key = item[JSON::KEY::KEY];
+                ASSERT_LT(previous, key);
+                ASSERT_EQ(endpoint, client->locate(key));
+                ASSERT_EQ(std::to_string(std::stoul(key.substr(5)) - 1000), item[JSON::KEY::VALUE]);
+                previous = key;
+            }
+            total += part[JSON::KEY::ITEMS].size();
+        }
+        ASSERT_EQ(count, total);
+    }
+
+    TEST_F(Test_StorageClient, Pipeline_Over_Mixed_Framings) {
+        auto client = connect();
+        const string tagged = keyOn(client, endpoints[0], "pipeline");
+        const string legacy = keyOn(client, endpoints[1], "pipeline");
+
+        // writes and reads of both servers interleaved, each read sees the write before it
+        std::vector<nlohmann::json> requests;
+        std::vector<nlohmann::json> expected;
+        for (int i = 0; i < 100; i++) {
+            for (const auto &key : { tagged, legacy }) {
+                const string value = key + "=" + std::to_string(i);
+                requests.push_back({ { JSON::KEY::REQUEST, JSON::VALUE::REQUEST_WRITE }, { JSON::KEY::KEY, key }, { JSON::KEY::VALUE, value } });
+                expected.push_back(nullptr);
+                requests.push_back({ { JSON::KEY::REQUEST, JSON::VALUE::REQUEST_READ }, { JSON::KEY::KEY, key } });
+                expected.push_back(value);
+            }
+
+            // requests without key wait for the ones before them
+            if (i == 50) {
+                requests.push_back({ { JSON::KEY::REQUEST, JSON::VALUE::REQUEST_STATS } });
+                expected.push_back(nullptr);
+            }
+        }
+
+        const auto answers = client->pipeline(requests);
+        ASSERT_EQ(requests.size(), answers.size());
+        for (size_t i = 0; i < answers.size(); i++) {
+            ASSERT_EQ(JSON::VALUE::STATUS_OK, answers[i][JSON::KEY::STATUS]) << i;
+            if (!expected[i].is_null()) {
+                ASSERT_EQ(expected[i], answers[i][JSON::KEY::VALUE]) << i;
+            }
+        }
+
+        // one server was talked to in binary framing, the other in base64
+        const auto stats = client->request({ { JSON::KEY::REQUEST, JSON::VALUE::REQUEST_STATS } })[JSON::KEY::SHARDS];
+        ASSERT_GE(stats[endpoints[0]][JSON::KEY::STATS]["connections"]["binary"].get<uint64_t>(), 1);
+        ASSERT_EQ(0, stats[endpoints[1]][JSON::KEY::STATS]["connections"]["binary"].get<uint64_t>());
+        ASSERT_GE(stats[endpoints[1]][JSON::KEY::STATS]["connections"]["base64"].get<uint64_t>(), 1);
+    }
+
+    TEST_F(Test_StorageClient, Binary_Client_On_Base64_Server) {
+        // the capped server answers the hello with base64 right away, no connect timeout
+        auto client = StorageClient::create("127.0.0.1", servers[1]->getPort());
+        client->setFraming(tcp_framing::Binary);
+        const auto started = std::chrono::steady_clock::now();
+        const auto answer = client->request({ { JSON::KEY::REQUEST, JSON::VALUE::REQUEST_WRITE }, { JSON::KEY::KEY, "capped" }, { JSON::KEY::VALUE, "1" } });
+        ASSERT_EQ(JSON::VALUE::STATUS_OK, answer[JSON::KEY::STATUS]);
+        ASSERT_LT(std::chrono::steady_clock::now() - started, std::chrono::seconds(2));
+        const auto connections = client->request({ { JSON::KEY::REQUEST, JSON::VALUE::REQUEST_STATS } })[JSON::KEY::STATS]["connections"];
+        ASSERT_EQ(0, connections["binary"]);
+        ASSERT_EQ(0, connections["negotiating"]);
+        ASSERT_GE(connections["base64"].get<uint64_t>(), 1);
+    }
+}// namespace Diginext::Core::Storage::GTest
+
+#endif
@@ -0,0 +1,329 @@
+#ifndef DIGINEXT_GTEST___STORAGE_STORAGE_ENGINE_TEST_H
+#define DIGINEXT_GTEST___STORAGE_STORAGE_ENGINE_TEST_H
+
+#include <gtest/gtest.h>
+
+#include "Storage/StorageTestUtils.h"
+
+#include <Storage/LsmStorage.h>
+#include <Storage/StorageEngineFactory.h>
+
+#include <atomic>
+#include <map>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace Diginext::Core::Storage::GTest {
+    using namespace std;
+
+    /**
+     * \brief conformance suite, every engine from storage_engine_names must pass it
+     */
+    class Test_StorageEngine : public testing::TestWithParam<std::string> {
+    protected:
+        TempDirectory directory;
+        StorageEngine::pointer engine;
+
+        void SetUp() override {
+            StorageOptions options;
+            options.engine = GetParam();
+            options.dataDir = this->directory.get();
+            options.fsyncPolicy = FsyncPolicy::Async;
+            this->engine = create_storage_engine(options);
+        }
+
+        void TearDown() override {
+            this->engine.reset();
+        }
+
+        /**
+         * \brief push buffered writes down to the engine's main structure (lsm: memtable -> tables)
+         */
+        void settle() {
+            if (auto lsm = std::dynamic_pointer_cast<LsmStorage>(this->engine)) {
+                lsm->flush();
+                lsm->waitIdle();
+            }
+        }
+
+        std::map<string, string> content() const {
+            std::map<string, string> result;
+            this->engine->forEach([&result](string_view key, string_view value) {
+                result.emplace(string(key), string(value));
+            });
+            return result;
+        }
+
+        std::vector<string> scanKeys(const string &start, const string &end, size_t limit = 0) const {
+            std::vector<string> keys;
+            this->engine->scan(start, end, [&keys, limit](string_view key, string_view) {
+                keys.emplace_back(key);
+                return limit == 0 || keys.size() < limit;
+            });
+            return keys;
+        }
+    };
+
+    TEST_P(Test_StorageEngine, Put_Get_Overwrite) {
+        string value;
+        ASSERT_FALSE(this->engine->get("a", value));
+        ASSERT_EQ(nullptr, this->engine->getShared("a"));
+
+        this->engine->put("a", "1");
+        this->engine->put("b", "");
+        this->engine->put(string("bin\0key", 7), string("\0\1\2", 3));
+        this->engine->put("a", "11");
+
+        for (int pass = 0; pass < 2; pass++) {
+            ASSERT_TRUE(this->engine->get("a", value));
+            ASSERT_EQ("11", value);
+            ASSERT_TRUE(this->engine->get("b", value));
+            ASSERT_EQ("", value);
+            ASSERT_EQ(string("\0\1\2", 3), *(this->engine->getShared(string("bin\0key", 7))));
+            ASSERT_EQ(3, this->engine->size());
+            this->settle();
+        }
+    }
+
+    TEST_P(Test_StorageEngine, Remove) {
+        this->engine->put("a", "1");
+        this->engine->put("b", "2");
+        this->settle();
+
+        ASSERT_TRUE(this->engine->remove("a"));
+        ASSERT_FALSE(this->engine->remove("a"));
+        ASSERT_FALSE(this->engine->remove("missing"));
+
+        string value;
+        ASSERT_FALSE(this->engine->get("a", value));
+        this->settle();
+        ASSERT_FALSE(this->engine->get("a", value));
+        ASSERT_TRUE(this->engine->get("b", value));
+        ASSERT_EQ(1, this->engine->size());
+
+        this->engine->put("a", "again");
+        ASSERT_TRUE(this->engine->get("a", value));
+        ASSERT_EQ("again", value);
+    }
+
+    TEST_P(Test_StorageEngine, Multi_Get) {
+        for (int i = 0; i < 100; i += 2) {
+            this->engine->put("key:" + std::to_string(i), std::to_string(i));
+        }
+        this->settle();
+
+        std::vector<string> keys;
+        for (int i = 0; i < 100; i++) {
+            keys.push_back("key:" + std::to_string(i));
+        }
+
+        const auto values = this->engine->multiGet(keys);
+        ASSERT_EQ(keys.size(), values.size());
+        for (int i = 0; i < 100; i++) {
+            if (i % 2 == 0) {
+                ASSERT_NE(nullptr, values[i]);
+                ASSERT_EQ(std::to_string(i), *(values[i]));
+            } else {
+                ASSERT_EQ(nullptr, values[i]);
+            }
+        }
+
+        ASSERT_TRUE(this->engine->multiGet({}).empty());
+    }
+
+    TEST_P(Test_StorageEngine, Multi_Put) {
+        this->engine->put("key:0", "old");
+
+        StorageEngine::record_batch records;
+        for (int i = 0; i < 500; i++) {
+            records.emplace_back("key:" + std::to_string(i), std::to_string(i));
+        }
+        // a key repeated in the batch keeps its last value
+        records.emplace_back("key:7", "last");
+
+        std::atomic<bool> durable(false);
+        this->engine->multiPutDurable(records, [&durable](bool ok) { durable = ok; });
+        this->engine->multiPut({});
+        this->settle();
+
+        ASSERT_TRUE(durable.load());
+        ASSERT_EQ(500, this->engine->size());
+        string value;
+        ASSERT_TRUE(this->engine->get("key:0", value));
+        ASSERT_EQ("0", value);
+        ASSERT_TRUE(this->engine->get("key:7", value));
+        ASSERT_EQ("last", value);
+        ASSERT_TRUE(this->engine->get("key:499", value));
+        ASSERT_EQ("499", value);
+    }
+
+    TEST_P(Test_StorageEngine, Update_Is_Atomic) {
+        const int THREADS = 4;
+        const int COUNT = 500;
+
+        // read-modify-write counters, a lost update shows up as a smaller total
+        std::vector<std::thread> threads;
+        for (int t = 0; t < THREADS; t++) {
+            threads.emplace_back([this]() {
+                for (int i = 0; i < COUNT; i++) {
+                    const bool written = this->engine->update("counter", [](bool exists, string_view current, uint64_t, string &updated) {
+                        updated = std::to_string((exists ? std::stoi(string(current)) : 0) + 1);
+                        return true;
+                    });
+                    ASSERT_TRUE(written);
+                }
+            });
+        }
+
+        for (auto &thread : threads) {
+            thread.join();
+        }
+
+        string value;
+        ASSERT_TRUE(this->engine->get("counter", value));
+        ASSERT_EQ(std::to_string(THREADS * COUNT), value);
+
+        // declined update leaves the key as it is and reports no write
+        bool durableCalled = false;
+        ASSERT_FALSE(this->engine->update(
+                "counter", [](bool, string_view, uint64_t, string &) { return false; },
+                [&durableCalled](bool) { durableCalled = true; }));
+        ASSERT_FALSE(durableCalled);
+        ASSERT_TRUE(this->engine->get("counter", value));
+        ASSERT_EQ(std::to_string(THREADS * COUNT), value);
+
+        ASSERT_TRUE(this->engine->update("fresh", [](bool exists, string_view, uint64_t, string &updated) {
+            updated = exists ? "seen" : "created";
+            return true;
+        }));
+        ASSERT_TRUE(this->engine->get("fresh", value));
+        ASSERT_EQ("created", value);
+    }
+
+    TEST_P(Test_StorageEngine, Versions) {
+        uint64_t version = 1;
+        ASSERT_EQ(nullptr, this->engine->getVersioned("a", version));
+        ASSERT_EQ(0, version);
+
+        this->engine->put("a", "1");
+        ASSERT_NE(nullptr, this->engine->getVersioned("a", version));
+        if (!this->engine->versioned()) {
+            ASSERT_EQ(0, version);
+            return;
+        }
+
+        // every write moves the version forward, the update callback sees the current one
+        const uint64_t first = version;
+        ASSERT_GT(first, 0);
+        uint64_t seen = 0;
+        uint64_t written = 0;
+        ASSERT_TRUE(this->engine->update("a", [&seen](bool, string_view, uint64_t current, string &updated) {
+            seen = current;
+            updated = "2";
+            return true;
+        }, nullptr, &written));
+        ASSERT_EQ(first, seen);
+        ASSERT_GT(written, first);
+        ASSERT_NE(nullptr, this->engine->getVersioned("a", version));
+        ASSERT_EQ(written, version);
+
+        this->engine->put("a", "2");
+        ASSERT_NE(nullptr, this->engine->getVersioned("a", version));
+        ASSERT_GT(version, written);
+
+        // a removed and rewritten key never gets an old version back
+        const uint64_t beforeRemove = version;
+        this->engine->remove("a");
+        this->engine->put("a", "1");
+        ASSERT_NE(nullptr, this->engine->getVersioned("a", version));
+        ASSERT_GT(version, beforeRemove);
+    }
+
+    TEST_P(Test_StorageEngine, Scan_Matches_Model) {
+        std::map<string, string> model;
+        uint64_t state = 12345;
+        for (int i = 0; i < 3000; i++) {
+            state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+            const string key = "k" + std::to_string(state % 2000);
+            if (state % 5 == 0) {
+                this->engine->remove(key);
+                model.erase(key);
+            } else {
+                this->engine->put(key, std::to_string(i));
+                model[key] = std::to_string(i);
+            }
+
+            if (i == 1500) {
+                this->settle();
+            }
+        }
+
+        ASSERT_EQ(model, this->content());
+
+        std::vector<string> all;
+        for (const auto &record : model) {
+            all.push_back(record.first);
+        }
+        ASSERT_EQ(all, this->scanKeys("", ""));
+
+        for (const auto &range : std::vector<std::pair<string, string>>{ { "k1", "k2" }, { "k15", "k150" }, { "k999", "" }, { "a", "b" }, { "k5", "k5" } }) {
+            std::vector<string> expected;
+            for (auto it = model.lower_bound(range.first); it != model.end() && (range.second.empty() || it->first < range.second); ++it) {
+                expected.push_back(it->first);
+            }
+            ASSERT_EQ(expected, this->scanKeys(range.first, range.second));
+
+            if (expected.size() > 10) {
+                expected.resize(10);
+                ASSERT_EQ(expected, this->scanKeys(range.first, range.second, 10));
+            }
+        }
+
+        this->engine->scan("", "", [this, &model](string_view key, string_view value) {
+            EXPECT_EQ(model[string(key)], value);
+            return true;
+        });
+    }
+
+    TEST_P(Test_StorageEngine, Concurrent_Writers_And_Readers) {
+        const int threadCount = 4;
+        const int keysPerThread = 2000;
+
+        std::vector<std::thread> threads;
+        for (int t = 0; t < threadCount; t++) {
+            threads.emplace_back([this, t]() {
+                string value;
+                for (int i = 0; i < keysPerThread; i++) {
+                    const string key = "t" + std::to_string(t) + ":" + std::to_string(i);
+                    this->engine->put(key, key);
+                    if (!this->engine->get(key, value) || value != key) {
+                        ADD_FAILURE() << "read own write failed for " << key;
+                        return;
+                    }
+
+                    if (i % 3 == 0) {
+                        this->engine->remove(key);
+                    }
+                }
+            });
+        }
+
+        for (auto &thread : threads) {
+            thread.join();
+        }
+
+        this->settle();
+
+        const auto data = this->content();
+        ASSERT_EQ(size_t(threadCount * (keysPerThread - (keysPerThread + 2) / 3)), data.size());
+        for (const auto &record : data) {
+            ASSERT_EQ(record.first, record.second);
+        }
+    }
+
+    INSTANTIATE_TEST_SUITE_P(Engines, Test_StorageEngine, testing::ValuesIn(storage_engine_names()),
+                             [](const testing::TestParamInfo<std::string> &info) { return info.param; });
+}// namespace Diginext::Core::Storage::GTest
+
+#endif
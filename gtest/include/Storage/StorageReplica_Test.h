@@ -0,0 +1,172 @@
+#ifndef DIGINEXT_GTEST___STORAGE_STORAGE_REPLICA_TEST_H
+#define DIGINEXT_GTEST___STORAGE_STORAGE_REPLICA_TEST_H
+
+#include <gtest/gtest.h>
+
+#include "Storage/StorageTestUtils.h"
+
+#include <Storage/ShardedHashStorage.h>
+#include <Storage/StorageClient.h>
+#include <Storage/StorageCommon.h>
+#include <Storage/StorageReplica.h>
+#include <Storage/StorageServer.h>
+
+#include <string>
+
+#include <nlohmann/json.hpp>
+
+namespace Diginext::Core::Storage::GTest {
+    using namespace std;
+
+    /**
+     * \brief a follower over its own engine against a real leader with a small backlog,
+     * stopped and started again to resume or fall back to a full copy
+     */
+    class Test_StorageReplica : public testing::Test {
+    protected:
+        static const size_t BACKLOG = 16 * 1024;
+
+        static StorageServer::pointer leader;
+        static StorageClient::pointer client;
+
+        static void SetUpTestSuite() {
+            StorageOptions options;
+            options.replicationBacklog = BACKLOG;
+            leader = start_server(options);
+            client = connect_client(leader);
+        }
+
+        static void TearDownTestSuite() {
+            client.reset();
+            leader.reset();
+        }
+
+        static void write(const string &key, const string &value, int64_t ttl = 0) {
+            nlohmann::json request = { { JSON::KEY::REQUEST, JSON::VALUE::REQUEST_WRITE }, { JSON::KEY::KEY, key }, { JSON::KEY::VALUE, value } };
+            if (ttl != 0) {
+                request[JSON::KEY::TTL] = ttl;
+            }
+            ASSERT_EQ(JSON::VALUE::STATUS_OK, client->request(request)[JSON::KEY::STATUS]);
+        }
+
+        static uint64_t leaderPosition() {
+            return client->request({ { JSON::KEY::REQUEST, JSON::VALUE::REQUEST_STATS } })[JSON::KEY::STATS]["replication"]["position"].get<uint64_t>();
+        }
+
+        /**
+         * @brief true once the follower is online and applied everything the leader logged so far
+         */
+        static bool caughtUp(const StorageReplica::pointer &replica) {
+            const uint64_t position = leaderPosition();
+            return wait_until([&replica, position]() {
+                return replica->getState() == StorageReplica::State::Online && replica->getPosition() >= position;
+            });
+        }
+
+        static string valueOf(const StorageEngine::pointer &engine, const string &key) {
+            string value;
+            return engine->get(key, value) ? value : "(missing)";
+        }
+    };
+
+    StorageServer::pointer Test_StorageReplica::leader;
+    StorageClient::pointer Test_StorageReplica::client;
+
+    TEST_F(Test_StorageReplica, Full_Sync_Removes_Stale_Keys) {
+        write("full:a", "1");
+        write("full:b", "2");
+
+        // what the follower held before is replaced by the leader's data set
+        auto engine = ShardedHashStorage::create();
+        engine->put("full:a", "old");
+        engine->put("full:stale", "old");
+
+        auto replica = StorageReplica::create(engine, "127.0.0.1", leader->getPort());
+        replica->start();
+        ASSERT_TRUE(caughtUp(replica));
+        ASSERT_EQ(1, replica->getFullSyncs());
+        ASSERT_EQ(0, replica->getPartialSyncs());
+        ASSERT_EQ("1", valueOf(engine, "full:a"));
+        ASSERT_EQ("2", valueOf(engine, "full:b"));
+        ASSERT_EQ("(missing)", valueOf(engine, "full:stale"));
+
+        // then the stream, removals included
+        write("full:c", "3");
+        write("full:short", "1", 100);
+        ASSERT_TRUE(caughtUp(replica));
+        ASSERT_EQ("3", valueOf(engine, "full:c"));
+        ASSERT_TRUE(wait_until([&engine]() { return valueOf(engine, "full:short") == "(missing)"; }));
+    }
+
+    TEST_F(Test_StorageReplica, Resume_From_Covered_Position) {
+        auto engine = ShardedHashStorage::create();
+        auto replica = StorageReplica::create(engine, "127.0.0.1", leader->getPort());
+        replica->start();
+        ASSERT_TRUE(caughtUp(replica));
+        replica->stop();
+
+        // a few records, well inside the backlog
+        write("resume:a", "1");
+        write("resume:b", "2");
+
+        replica->start();
+        ASSERT_TRUE(caughtUp(replica));
+        ASSERT_EQ(1, replica->getFullSyncs());
+        ASSERT_EQ(1, replica->getPartialSyncs());
+        ASSERT_EQ("1", valueOf(engine, "resume:a"));
+        ASSERT_EQ("2", valueOf(engine, "resume:b"));
+    }
+
+    TEST_F(Test_StorageReplica, Trimmed_Backlog_Falls_Back_To_Full_Copy) {
+        auto engine = ShardedHashStorage::create();
+        auto replica = StorageReplica::create(engine, "127.0.0.1", leader->getPort());
+        replica->start();
+        ASSERT_TRUE(caughtUp(replica));
+        replica->stop();
+
+        // several times the backlog, the follower's position falls out of it
+        const string value(1024, 'x');
+        for (size_t i = 0; i < 4 * BACKLOG / value.size(); i++) {
+            write("trimmed:" + std::to_string(i), value);
+        }
+        engine->put("trimmed:stale", "old");
+
+        replica->start();
+        ASSERT_TRUE(caughtUp(replica));
+        ASSERT_EQ(2, replica->getFullSyncs());
+        ASSERT_EQ(0, replica->getPartialSyncs());
+        ASSERT_EQ(value, valueOf(engine, "trimmed:0"));
+        ASSERT_EQ("(missing)", valueOf(engine, "trimmed:stale"));
+    }
+
+    TEST_F(Test_StorageReplica, Follower_Server_Is_Read_Only) {
+        write("readonly:a", "1");
+
+        StorageOptions options;
+        options.replicaOfHost = "127.0.0.1";
+        options.replicaOfPort = leader->getPort();
+        auto follower = start_server(options);
+        auto followerClient = connect_client(follower);
+        ASSERT_TRUE(wait_until([&followerClient]() {
+            return followerClient->request({ { JSON::KEY::REQUEST, JSON::VALUE::REQUEST_READ }, { JSON::KEY::KEY, "readonly:a" } }).value(JSON::KEY::VALUE, string()) == "1";
+        }));
+
+        const string refused = "read-only replica of 127.0.0.1:" + std::to_string(leader->getPort());
+        for (const nlohmann::json &request : {
+                     nlohmann::json({ { JSON::KEY::REQUEST, JSON::VALUE::REQUEST_WRITE }, { JSON::KEY::KEY, "readonly:a" }, { JSON::KEY::VALUE, "2" } }),
+                     nlohmann::json({ { JSON::KEY::REQUEST, JSON::VALUE::REQUEST_INCR }, { JSON::KEY::KEY, "readonly:n" } }),
+                     nlohmann::json({ { JSON::KEY::REQUEST, JSON::VALUE::REQUEST_EXPIRE }, { JSON::KEY::KEY, "readonly:a" }, { JSON::KEY::TTL, 100 } }),
+             }) {
+            const auto answer = followerClient->request(request);
+            ASSERT_EQ(JSON::VALUE::STATUS_ERROR, answer[JSON::KEY::STATUS]) << request.dump();
+            ASSERT_EQ(refused, answer[JSON::KEY::DESCRIPTION]) << request.dump();
+        }
+
+        nlohmann::json items = nlohmann::json::array();
+        items.push_back({ { JSON::KEY::KEY, "readonly:b" }, { JSON::KEY::VALUE, "1" } });
+        ASSERT_EQ(refused, followerClient->request({ { JSON::KEY::REQUEST, JSON::VALUE::REQUEST_MPUT }, { JSON::KEY::ITEMS, items } })[JSON::KEY::DESCRIPTION]);
+        ASSERT_EQ("1", followerClient->request({ { JSON::KEY::REQUEST, JSON::VALUE::REQUEST_READ }, { JSON::KEY::KEY, "readonly:a" } })[JSON::KEY::VALUE]);
+    }
+}// namespace Diginext::Core::Storage::GTest
+
+#endif
@@ -0,0 +1,153 @@
+#ifndef DIGINEXT_GTEST___STORAGE_STORAGE_SCAN_TEST_H
+#define DIGINEXT_GTEST___STORAGE_STORAGE_SCAN_TEST_H
+
+#include <gtest/gtest.h>
+
+#include <Base64/Base64.h>
+#include <Storage/BTreeIndex.h>
+#include <Storage/ShardedHashStorage.h>
+#include <Storage/StorageCommon.h>
+#include <Storage/StorageScan.h>
+
+#include <nlohmann/json.hpp>
+
+#include <algorithm>
+#include <cstdio>
+#include <random>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace Diginext::Core::Storage::GTest {
+    using namespace std;
+
+    TEST(Test_StorageScan, BTree_Matches_Model) {
+        BTreeIndex index;
+        const size_t empty = index.memoryUsage();
+        std::set<string> model;
+        std::mt19937 random(7);
+
+        // enough keys for a three level tree, then erase most of them to force merges
+        for (int round = 0; round < 2; round++) {
+            for (int i = 0; i < 60000; i++) {
+                char key[16];
+                std::snprintf(key, sizeof(key), "k%06u", static_cast<unsigned>(random() % 100000));
+                ASSERT_EQ(model.insert(key).second, index.insert(key));
+            }
+            ASSERT_EQ(model.size(), index.size());
+            ASSERT_GE(index.height(), 3);
+
+            for (int i = 0; i < 80000; i++) {
+                char key[16];
+                std::snprintf(key, sizeof(key), "k%06u", static_cast<unsigned>(random() % 100000));
+                ASSERT_EQ(model.erase(key) == 1, index.erase(key));
+            }
+            ASSERT_EQ(model.size(), index.size());
+        }
+
+        std::vector<string> all;
+        index.scan("", [&all](const string &key) {
+            all.push_back(key);
+            return true;
+        });
+        ASSERT_EQ(std::vector<string>(model.begin(), model.end()), all);
+
+        for (const char *start : { "k", "k05", "k050000", "k09999", "z" }) {
+            std::vector<string> expected;
+            for (auto it = model.lower_bound(start); it != model.end() && expected.size() < 10; ++it) {
+                expected.push_back(*it);
+            }
+
+            std::vector<string> actual;
+            index.scan(start, [&actual](const string &key) {
+                actual.push_back(key);
+                return actual.size() < 10;
+            });
+            ASSERT_EQ(expected, actual) << start;
+        }
+
+        for (const auto &key : model) {
+            ASSERT_TRUE(index.contains(key));
+            ASSERT_TRUE(index.erase(key));
+        }
+        ASSERT_EQ(0, index.size());
+        ASSERT_EQ(1, index.height());
+        ASSERT_EQ(empty, index.memoryUsage());
+
+        // long keys are counted with their heap buffers
+        index.insert(string(1000, 'x'));
+        ASSERT_GE(index.memoryUsage(), empty + 1000);
+        index.erase(string(1000, 'x'));
+        ASSERT_EQ(empty, index.memoryUsage());
+    }
+
+    TEST(Test_StorageScan, Prefix_End) {
+        ASSERT_EQ("", scan_prefix_end(""));
+        ASSERT_EQ("b", scan_prefix_end("a"));
+        ASSERT_EQ("user;", scan_prefix_end("user:"));
+        ASSERT_EQ("b", scan_prefix_end("a\xff"));
+        ASSERT_EQ("", scan_prefix_end("\xff\xff"));
+    }
+
+    TEST(Test_StorageScan, Chunks_And_Cursor) {
+        ShardedHashStorage storage(8);
+        for (int i = 0; i < 3000; i++) {
+            char key[16];
+            std::snprintf(key, sizeof(key), "user:%05d", i);
+            storage.put(key, string(i % 50, 'v'));
+        }
+        storage.put("other", "x");
+        storage.remove("user:00010");
+
+        ScanRequest request;
+        request.start = "user:";
+        request.end = scan_prefix_end(request.start);
+        request.limit = 1000;
+
+        std::vector<string> keys;
+        size_t pages = 0;
+        while (true) {
+            std::vector<nlohmann::json> chunks;
+            const size_t count = scan_chunks(storage, request, [&chunks](const string &chunk) {
+                chunks.push_back(nlohmann::json::parse(chunk));
+            });
+            pages++;
+
+            size_t items = 0;
+            for (size_t i = 0; i < chunks.size(); i++) {
+                ASSERT_EQ(JSON::VALUE::STATUS_OK, chunks[i][JSON::KEY::STATUS]);
+                ASSERT_EQ(i + 1 == chunks.size(), chunks[i][JSON::KEY::FINAL].get<bool>());
+                ASSERT_LE(chunks[i][JSON::KEY::ITEMS].size(), SCAN_CHUNK_ITEMS);
+                for (const auto &item : chunks[i][JSON::KEY::ITEMS]) {
+                    keys.push_back(item[JSON::KEY::KEY].get<string>());
+                    items++;
+                }
+            }
+            ASSERT_EQ(count, items);
+
+            const auto &last = chunks.back();
+            if (!last.contains(JSON::KEY::CURSOR)) {
+                break;
+            }
+
+            ASSERT_EQ(request.limit, count);
+            request.start = Base64::Decode(last[JSON::KEY::CURSOR].get<string>()) + '\0';
+        }
+
+        ASSERT_EQ(3, pages);
+        ASSERT_EQ(2999, keys.size());
+        ASSERT_TRUE(std::is_sorted(keys.begin(), keys.end()));
+        ASSERT_EQ(keys.end(), std::adjacent_find(keys.begin(), keys.end()));
+        ASSERT_EQ(keys.end(), std::find(keys.begin(), keys.end(), "user:00010"));
+
+        // empty range still answers with one final chunk
+        request.start = "zzz";
+        request.end = "";
+        std::vector<string> chunks;
+        ASSERT_EQ(0, scan_chunks(storage, request, [&chunks](const string &chunk) { chunks.push_back(chunk); }));
+        ASSERT_EQ(1, chunks.size());
+        ASSERT_TRUE(nlohmann::json::parse(chunks.front())[JSON::KEY::FINAL].get<bool>());
+    }
+}// namespace Diginext::Core::Storage::GTest
+
+#endif
@@ -0,0 +1,689 @@
+#ifndef DIGINEXT_GTEST___STORAGE_STORAGE_SERVER_TEST_H
+#define DIGINEXT_GTEST___STORAGE_STORAGE_SERVER_TEST_H
+
+#include <gtest/gtest.h>
+
+#include "Storage/StorageTestUtils.h"
+
+#include <Storage/RespCodec.h>
+#include <Storage/StorageClient.h>
+#include <Storage/StorageCommon.h>
+#include <Storage/StorageServer.h>
+
+#include <chrono>
+#include <cstdint>
+#include <limits>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <boost/asio.hpp>
+#include <nlohmann/json.hpp>
+
+namespace Diginext::Core::Storage::GTest {
+    using namespace std;
+    using namespace std::chrono_literals;
+
+    /**
+     * \brief blocking RESP2 client, as redis-cli talks to the server
+     */
+    class RespTestConnection {
+    private:
+        boost::asio::io_service ios;
+        boost::asio::ip::tcp::socket socket;
+        boost::asio::streambuf received;
+
+    public:
+        explicit RespTestConnection(unsigned short port) : socket(ios) {
+            this->socket.connect(boost::asio::ip::tcp::endpoint(boost::asio::ip::address::from_string("127.0.0.1"), port));
+        }
+
+        void send(const std::vector<string> &args) {
+            string out;
+            resp_array(out, args.size());
+            for (const auto &arg : args) {
+                resp_bulk(out, arg);
+            }
+            boost::asio::write(this->socket, boost::asio::buffer(out));
+        }
+
+        /**
+         * @brief the next reply without its CRLF, a bulk string as its content, so "+OK" and "OK" tell
+         * a simple string from a bulk one
+         */
+        string reply() {
+            const size_t size = boost::asio::read_until(this->socket, this->received, "\r\n");
+            const auto begin = boost::asio::buffers_begin(this->received.data());
+            const string line(begin, begin + size - 2);
+            this->received.consume(size);
+            if (line[0] != '$' || line == "$-1") {
+                return line;
+            }
+
+            const size_t length = std::stoul(line.substr(1));
+            if (this->received.size() < length + 2) {
+                boost::asio::read(this->socket, this->received, boost::asio::transfer_exactly(length + 2 - this->received.size()));
+            }
+            const auto data = boost::asio::buffers_begin(this->received.data());
+            const string value(data, data + length);
+            this->received.consume(length + 2);
+            return value;
+        }
+
+        string call(const std::vector<string> &args) {
+            this->send(args);
+            return this->reply();
+        }
+
+        /**
+         * @brief true once the server closed the connection with nothing more sent, false if it is still open after timeout
+         */
+        bool closedByServer(std::chrono::milliseconds timeout = std::chrono::seconds(5)) {
+            if (this->received.size() != 0) {
+                return false;
+            }
+
+            this->socket.non_blocking(true);
+            return wait_until([this]() {
+                char chunk[64];
+                boost::system::error_code error;
+                const size_t size = this->socket.read_some(boost::asio::buffer(chunk), error);
+                return size == 0 && (error == boost::asio::error::eof || error == boost::asio::error::connection_reset);
+            }, timeout);
+        }
+    };
+
+    /**
+     * \brief requests and answers against a real server; a start takes seconds, the tests
+     * without options of their own share one hash engine server and use their own keys
+     */
+    class Test_StorageServer : public testing::Test {
+    protected:
+        static StorageServer::pointer server;
+        static StorageClient::pointer client;
+
+        static void SetUpTestSuite() {
+            StorageOptions options;
+            options.respPort = free_port();
+            server = start_server(options);
+            client = connect_client(server);
+        }
+
+        static void TearDownTestSuite() {
+            client.reset();
+            server.reset();
+        }
+
+        static nlohmann::json write(const StorageClient::pointer &target, const string &key, const string &value, int64_t ttl = 0) {
+            nlohmann::json request = { { JSON::KEY::REQUEST, JSON::VALUE::REQUEST_WRITE }, { JSON::KEY::KEY, key }, { JSON::KEY::VALUE, value } };
+            if (ttl != 0) {
+                request[JSON::KEY::TTL] = ttl;
+            }
+            return target->request(request);
+        }
+
+        static nlohmann::json read(const StorageClient::pointer &target, const string &key) {
+            return target->request({ { JSON::KEY::REQUEST, JSON::VALUE::REQUEST_READ }, { JSON::KEY::KEY, key } });
+        }
+
+        static nlohmann::json stats(const StorageClient::pointer &target) {
+            return target->request({ { JSON::KEY::REQUEST, JSON::VALUE::REQUEST_STATS } })[JSON::KEY::STATS];
+        }
+
+        static uint64_t ttlKeys(const StorageClient::pointer &target) {
+            return stats(target)["ttl_keys"].get<uint64_t>();
+        }
+    };
+
+    StorageServer::pointer Test_StorageServer::server;
+    StorageClient::pointer Test_StorageServer::client;
+
+    TEST_F(Test_StorageServer, Ttl_Expire_Persist) {
+        ASSERT_EQ(JSON::VALUE::STATUS_OK, write(client, "ttl:write", "1", 100)[JSON::KEY::STATUS]);
+        ASSERT_EQ("1", read(client, "ttl:write")[JSON::KEY::VALUE]);
+
+        write(client, "ttl:expire", "1");
+        auto answer = client->request({ { JSON::KEY::REQUEST, JSON::VALUE::REQUEST_EXPIRE }, { JSON::KEY::KEY, "ttl:expire" }, { JSON::KEY::TTL, 100 } });
+        ASSERT_EQ(JSON::VALUE::STATUS_OK, answer[JSON::KEY::STATUS]);
+
+        write(client, "ttl:persist", "1", 100);
+        answer = client->request({ { JSON::KEY::REQUEST, JSON::VALUE::REQUEST_PERSIST }, { JSON::KEY::KEY, "ttl:persist" } });
+        ASSERT_EQ(JSON::VALUE::STATUS_OK, answer[JSON::KEY::STATUS]);
+
+        // a plain write makes the key persistent again
+        write(client, "ttl:rewrite", "1", 100);
+        write(client, "ttl:rewrite", "2");
+
+        std::this_thread::sleep_for(300ms);
+        ASSERT_EQ("key not found in storage", read(client, "ttl:write")[JSON::KEY::DESCRIPTION]);
+        ASSERT_EQ("key not found in storage", read(client, "ttl:expire")[JSON::KEY::DESCRIPTION]);
+        ASSERT_EQ("1", read(client, "ttl:persist")[JSON::KEY::VALUE]);
+        ASSERT_EQ("2", read(client, "ttl:rewrite")[JSON::KEY::VALUE]);
+
+        answer = client->request({ { JSON::KEY::REQUEST, JSON::VALUE::REQUEST_EXPIRE }, { JSON::KEY::KEY, "ttl:missing" }, { JSON::KEY::TTL, 100 } });
+        ASSERT_EQ("key not found in storage", answer[JSON::KEY::DESCRIPTION]);
+        answer = client->request({ { JSON::KEY::REQUEST, JSON::VALUE::REQUEST_EXPIRE }, { JSON::KEY::KEY, "ttl:persist" }, { JSON::KEY::TTL, 0 } });
+        ASSERT_EQ("field ttl must be positive", answer[JSON::KEY::DESCRIPTION]);
+        answer = client->request({ { JSON::KEY::REQUEST, JSON::VALUE::REQUEST_EXPIRE }, { JSON::KEY::KEY, "ttl:persist" } });
+        ASSERT_EQ("field ttl not found", answer[JSON::KEY::DESCRIPTION]);
+    }
+
+    TEST_F(Test_StorageServer, Mget_Mput) {
+        nlohmann::json items = nlohmann::json::array();
+        items.push_back({ { JSON::KEY::KEY, "batch:a" }, { JSON::KEY::VALUE, "1" } });
+        items.push_back({ { JSON::KEY::KEY, "batch:b" }, { JSON::KEY::VALUE, "2" } });
+        auto answer = client->request({ { JSON::KEY::REQUEST, JSON::VALUE::REQUEST_MPUT }, { JSON::KEY::ITEMS, items } });
+        ASSERT_EQ(JSON::VALUE::STATUS_OK, answer[JSON::KEY::STATUS]);
+
+        // expired and not reclaimed yet, or gone: both answer null
+        write(client, "batch:expired", "1", 1);
+        std::this_thread::sleep_for(20ms);
+        answer = client->request({ { JSON::KEY::REQUEST, JSON::VALUE::REQUEST_MGET },
+                                   { JSON::KEY::KEYS, { "batch:b", "batch:expired", "batch:missing", "batch:a" } } });
+        ASSERT_EQ(JSON::VALUE::STATUS_OK, answer[JSON::KEY::STATUS]);
+        ASSERT_EQ(nlohmann::json({ "2", nullptr, nullptr, "1" }), answer[JSON::KEY::VALUES]);
+
+        // one bad item refuses the whole batch; the client catches a missing key, the server a missing value
+        items.push_back({ { JSON::KEY::KEY, "batch:c" } });
+        answer = client->request({ { JSON::KEY::REQUEST, JSON::VALUE::REQUEST_MPUT }, { JSON::KEY::ITEMS, items } });
+        ASSERT_EQ("every item needs key and value", answer[JSON::KEY::DESCRIPTION]);
+        items.back() = { { JSON::KEY::VALUE, "3" } };
+        answer = client->request({ { JSON::KEY::REQUEST, JSON::VALUE::REQUEST_MPUT }, { JSON::KEY::ITEMS, items } });
+        ASSERT_EQ("every item needs key and value", answer[JSON::KEY::DESCRIPTION]);
+        ASSERT_EQ("key not found in storage", read(client, "batch:c")[JSON::KEY::DESCRIPTION]);
+
+        answer = client->request({ { JSON::KEY::REQUEST, JSON::VALUE::REQUEST_MGET }, { JSON::KEY::KEYS, "batch:a" } });
+        ASSERT_EQ("field keys must be an array", answer[JSON::KEY::DESCRIPTION]);
+    }
+
+    TEST_F(Test_StorageServer, Mget_Mput_Batch_Size) {
+        // a client of one server passes the batch on as it is
+        nlohmann::json keys = nlohmann::json::array();
+        nlohmann::json items = nlohmann::json::array();
+        for (int i = 0; i <= 10000; i++) {
+            keys.push_back("size:" + std::to_string(i));
+            items.push_back({ { JSON::KEY::KEY, "size:" + std::to_string(i) }, { JSON::KEY::VALUE, "1" } });
+        }
+
+        auto answer = client->request({ { JSON::KEY::REQUEST, JSON::VALUE::REQUEST_MGET }, { JSON::KEY::KEYS, keys } });
+        ASSERT_EQ("at most 10000 keys per request", answer[JSON::KEY::DESCRIPTION]);
+        answer = client->request({ { JSON::KEY::REQUEST, JSON::VALUE::REQUEST_MPUT }, { JSON::KEY::ITEMS, items } });
+        ASSERT_EQ("at most 10000 items per request", answer[JSON::KEY::DESCRIPTION]);
+        ASSERT_EQ("key not found in storage", read(client, "size:0")[JSON::KEY::DESCRIPTION]);
+
+        keys.erase(keys.size() - 1);
+        answer = client->request({ { JSON::KEY::REQUEST, JSON::VALUE::REQUEST_MGET }, { JSON::KEY::KEYS, keys } });
+        ASSERT_EQ(JSON::VALUE::STATUS_OK, answer[JSON::KEY::STATUS]);
+        ASSERT_EQ(10000, answer[JSON::KEY::VALUES].size());
+    }
+
+    TEST_F(Test_StorageServer, Incr_Decr) {
+        const auto incr = [](const string &request, const string &key, const nlohmann::json &by) {
+            nlohmann::json json = { { JSON::KEY::REQUEST, request }, { JSON::KEY::KEY, key } };
+            if (!by.is_null()) {
+                json[JSON::KEY::BY] = by;
+            }
+            return client->request(json);
+        };
+
+        // a missing key counts from zero
+        ASSERT_EQ("1", incr(JSON::VALUE::REQUEST_INCR, "counter:a", nullptr)[JSON::KEY::VALUE]);
+        ASSERT_EQ("11", incr(JSON::VALUE::REQUEST_INCR, "counter:a", 10)[JSON::KEY::VALUE]);
+        ASSERT_EQ("8", incr(JSON::VALUE::REQUEST_DECR, "counter:a", 3)[JSON::KEY::VALUE]);
+
+        const int64_t max = std::numeric_limits<int64_t>::max();
+        const int64_t min = std::numeric_limits<int64_t>::min();
+        write(client, "counter:max", std::to_string(max - 1));
+        ASSERT_EQ(std::to_string(max), incr(JSON::VALUE::REQUEST_INCR, "counter:max", nullptr)[JSON::KEY::VALUE]);
+        ASSERT_EQ("increment would overflow", incr(JSON::VALUE::REQUEST_INCR, "counter:max", nullptr)[JSON::KEY::DESCRIPTION]);
+        ASSERT_EQ(std::to_string(max), read(client, "counter:max")[JSON::KEY::VALUE]);
+
+        write(client, "counter:min", std::to_string(min + 1));
+        ASSERT_EQ(std::to_string(min), incr(JSON::VALUE::REQUEST_DECR, "counter:min", 1)[JSON::KEY::VALUE]);
+        ASSERT_EQ("increment would overflow", incr(JSON::VALUE::REQUEST_DECR, "counter:min", 1)[JSON::KEY::DESCRIPTION]);
+        ASSERT_EQ("increment would overflow", incr(JSON::VALUE::REQUEST_INCR, "counter:min", min)[JSON::KEY::DESCRIPTION]);
+
+        // its negation does not fit
+        ASSERT_EQ("field by is out of range", incr(JSON::VALUE::REQUEST_DECR, "counter:a", min)[JSON::KEY::DESCRIPTION]);
+        ASSERT_EQ("8", read(client, "counter:a")[JSON::KEY::VALUE]);
+
+        write(client, "counter:text", "12a");
+        ASSERT_EQ("value is not an integer", incr(JSON::VALUE::REQUEST_INCR, "counter:text", nullptr)[JSON::KEY::DESCRIPTION]);
+        write(client, "counter:text", " 12");
+        ASSERT_EQ("value is not an integer", incr(JSON::VALUE::REQUEST_DECR, "counter:text", nullptr)[JSON::KEY::DESCRIPTION]);
+        ASSERT_EQ(" 12", read(client, "counter:text")[JSON::KEY::VALUE]);
+    }
+
+    TEST_F(Test_StorageServer, Cas_Append) {
+        const auto cas = [](const StorageClient::pointer &target, const string &key, const nlohmann::json &fields) {
+            nlohmann::json json = { { JSON::KEY::REQUEST, JSON::VALUE::REQUEST_CAS }, { JSON::KEY::KEY, key } };
+            json.update(fields);
+            return target->request(json);
+        };
+
+        // expected null - only if the key is missing
+        auto answer = cas(client, "cas:a", { { JSON::KEY::EXPECTED, nullptr }, { JSON::KEY::VALUE, "1" } });
+        ASSERT_EQ(JSON::VALUE::STATUS_OK, answer[JSON::KEY::STATUS]);
+        ASSERT_TRUE(answer[JSON::KEY::SWAPPED].get<bool>());
+        answer = cas(client, "cas:a", { { JSON::KEY::EXPECTED, nullptr }, { JSON::KEY::VALUE, "2" } });
+        ASSERT_EQ(JSON::VALUE::STATUS_OK, answer[JSON::KEY::STATUS]);
+        ASSERT_FALSE(answer[JSON::KEY::SWAPPED].get<bool>());
+
+        ASSERT_FALSE(cas(client, "cas:a", { { JSON::KEY::EXPECTED, "0" }, { JSON::KEY::VALUE, "2" } })[JSON::KEY::SWAPPED].get<bool>());
+        ASSERT_TRUE(cas(client, "cas:a", { { JSON::KEY::EXPECTED, "1" }, { JSON::KEY::VALUE, "2" } })[JSON::KEY::SWAPPED].get<bool>());
+        ASSERT_EQ("2", read(client, "cas:a")[JSON::KEY::VALUE]);
+
+        ASSERT_EQ("field expected or if_version not found", cas(client, "cas:a", { { JSON::KEY::VALUE, "3" } })[JSON::KEY::DESCRIPTION]);
+        ASSERT_EQ("field value not found", cas(client, "cas:a", { { JSON::KEY::EXPECTED, "2" } })[JSON::KEY::DESCRIPTION]);
+
+        answer = client->request({ { JSON::KEY::REQUEST, JSON::VALUE::REQUEST_APPEND }, { JSON::KEY::KEY, "cas:a" }, { JSON::KEY::VALUE, "34" } });
+        ASSERT_EQ(3, answer[JSON::KEY::LENGTH]);
+        ASSERT_EQ("234", read(client, "cas:a")[JSON::KEY::VALUE]);
+
+        // an engine without versions refuses if_version rather than ignoring it
+        TempDirectory directory;
+        StorageOptions options;
+        options.engine = "lsm";
+        options.dataDir = directory.get();
+        auto lsm = start_server(options);
+        auto target = connect_client(lsm);
+
+        write(target, "cas:a", "1");
+        answer = cas(target, "cas:a", { { JSON::KEY::IF_VERSION, 1 }, { JSON::KEY::VALUE, "2" } });
+        ASSERT_EQ("field if_version is not supported by lsm engine", answer[JSON::KEY::DESCRIPTION]);
+        ASSERT_EQ("1", read(target, "cas:a")[JSON::KEY::VALUE]);
+        ASSERT_TRUE(cas(target, "cas:a", { { JSON::KEY::EXPECTED, "1" }, { JSON::KEY::VALUE, "2" } })[JSON::KEY::SWAPPED].get<bool>());
+        ASSERT_EQ("2", read(target, "cas:a")[JSON::KEY::VALUE]);
+    }
+
+    TEST_F(Test_StorageServer, Versions) {
+        const auto writeIf = [](const string &key, const string &value, uint64_t version) {
+            return client->request({ { JSON::KEY::REQUEST, JSON::VALUE::REQUEST_WRITE }, { JSON::KEY::KEY, key }, { JSON::KEY::VALUE, value },
+                                     { JSON::KEY::IF_VERSION, version } });
+        };
+        const auto readIf = [](const string &key, uint64_t version) {
+            return client->request({ { JSON::KEY::REQUEST, JSON::VALUE::REQUEST_READ }, { JSON::KEY::KEY, key }, { JSON::KEY::IF_VERSION, version } });
+        };
+
+        // every write answers the version it made
+        const uint64_t first = write(client, "version:a", "1")[JSON::KEY::VERSION].get<uint64_t>();
+        const uint64_t second = write(client, "version:a", "2")[JSON::KEY::VERSION].get<uint64_t>();
+        ASSERT_GT(first, 0);
+        ASSERT_GT(second, first);
+
+        auto answer = read(client, "version:a");
+        ASSERT_EQ("2", answer[JSON::KEY::VALUE]);
+        ASSERT_EQ(second, answer[JSON::KEY::VERSION]);
+
+        // the client holds the current version, the value is not sent again
+        answer = readIf("version:a", second);
+        ASSERT_EQ(JSON::VALUE::STATUS_NOT_MODIFIED, answer[JSON::KEY::STATUS]);
+        ASSERT_EQ(second, answer[JSON::KEY::VERSION]);
+        ASSERT_FALSE(answer.contains(JSON::KEY::VALUE));
+        answer = readIf("version:a", first);
+        ASSERT_EQ(JSON::VALUE::STATUS_OK, answer[JSON::KEY::STATUS]);
+        ASSERT_EQ("2", answer[JSON::KEY::VALUE]);
+
+        // a stale version is refused with the current one
+        answer = writeIf("version:a", "3", first);
+        ASSERT_EQ("version mismatch", answer[JSON::KEY::DESCRIPTION]);
+        ASSERT_EQ(second, answer[JSON::KEY::VERSION]);
+        ASSERT_EQ("2", read(client, "version:a")[JSON::KEY::VALUE]);
+
+        answer = writeIf("version:a", "3", second);
+        ASSERT_EQ(JSON::VALUE::STATUS_OK, answer[JSON::KEY::STATUS]);
+        const uint64_t third = answer[JSON::KEY::VERSION].get<uint64_t>();
+        ASSERT_GT(third, second);
+
+        // if_version 0 - the key must be missing
+        answer = writeIf("version:a", "4", 0);
+        ASSERT_EQ("version mismatch", answer[JSON::KEY::DESCRIPTION]);
+        ASSERT_EQ(third, answer[JSON::KEY::VERSION]);
+        answer = writeIf("version:b", "1", 0);
+        ASSERT_EQ(JSON::VALUE::STATUS_OK, answer[JSON::KEY::STATUS]);
+        ASSERT_GT(answer[JSON::KEY::VERSION].get<uint64_t>(), 0);
+
+        // updates answer their version too, cas checks it
+        answer = client->request({ { JSON::KEY::REQUEST, JSON::VALUE::REQUEST_INCR }, { JSON::KEY::KEY, "version:b" } });
+        const uint64_t incremented = answer[JSON::KEY::VERSION].get<uint64_t>();
+        ASSERT_EQ(incremented, read(client, "version:b")[JSON::KEY::VERSION]);
+        answer = client->request({ { JSON::KEY::REQUEST, JSON::VALUE::REQUEST_CAS }, { JSON::KEY::KEY, "version:b" }, { JSON::KEY::IF_VERSION, incremented - 1 },
+                                   { JSON::KEY::VALUE, "5" } });
+        ASSERT_FALSE(answer[JSON::KEY::SWAPPED].get<bool>());
+        answer = client->request({ { JSON::KEY::REQUEST, JSON::VALUE::REQUEST_CAS }, { JSON::KEY::KEY, "version:b" }, { JSON::KEY::IF_VERSION, incremented },
+                                   { JSON::KEY::VALUE, "5" } });
+        ASSERT_TRUE(answer[JSON::KEY::SWAPPED].get<bool>());
+        ASSERT_GT(answer[JSON::KEY::VERSION].get<uint64_t>(), incremented);
+    }
+
+    TEST_F(Test_StorageServer, Transactions) {
+        const auto begin = []() {
+            return client->request({ { JSON::KEY::REQUEST, JSON::VALUE::REQUEST_BEGIN } })[JSON::KEY::TXN].get<uint64_t>();
+        };
+        const auto inside = [](uint64_t txn, const string &request, const nlohmann::json &fields = nlohmann::json::object()) {
+            nlohmann::json json = { { JSON::KEY::REQUEST, request }, { JSON::KEY::TXN, txn } };
+            json.update(fields);
+            return client->request(json);
+        };
+
+        // transactions belong to a connection, the concurrent writer has its own
+        auto writer = connect_client(server);
+        write(client, "txn:a", "1");
+
+        // writes are buffered, reads see the snapshot and the own writes
+        uint64_t txn = begin();
+        ASSERT_EQ("1", inside(txn, JSON::VALUE::REQUEST_READ, { { JSON::KEY::KEY, "txn:a" } })[JSON::KEY::VALUE]);
+        ASSERT_EQ(JSON::VALUE::STATUS_OK, inside(txn, JSON::VALUE::REQUEST_WRITE, { { JSON::KEY::KEY, "txn:b" }, { JSON::KEY::VALUE, "1" } })[JSON::KEY::STATUS]);
+        ASSERT_EQ("1", inside(txn, JSON::VALUE::REQUEST_READ, { { JSON::KEY::KEY, "txn:b" } })[JSON::KEY::VALUE]);
+        ASSERT_EQ("key not found in storage", read(writer, "txn:b")[JSON::KEY::DESCRIPTION]);
+        auto answer = inside(txn, JSON::VALUE::REQUEST_COMMIT);
+        ASSERT_EQ(JSON::VALUE::STATUS_OK, answer[JSON::KEY::STATUS]);
+        ASSERT_GT(answer[JSON::KEY::VERSION].get<uint64_t>(), 0);
+        ASSERT_EQ("1", read(writer, "txn:b")[JSON::KEY::VALUE]);
+
+        // a key read in the transaction changed before its commit
+        txn = begin();
+        ASSERT_EQ("1", inside(txn, JSON::VALUE::REQUEST_READ, { { JSON::KEY::KEY, "txn:a" } })[JSON::KEY::VALUE]);
+        write(writer, "txn:a", "2");
+        ASSERT_EQ("1", inside(txn, JSON::VALUE::REQUEST_READ, { { JSON::KEY::KEY, "txn:a" } })[JSON::KEY::VALUE]);
+        inside(txn, JSON::VALUE::REQUEST_WRITE, { { JSON::KEY::KEY, "txn:c" }, { JSON::KEY::VALUE, "1" } });
+        ASSERT_EQ("transaction conflict", inside(txn, JSON::VALUE::REQUEST_COMMIT)[JSON::KEY::DESCRIPTION]);
+        ASSERT_EQ("2", read(client, "txn:a")[JSON::KEY::VALUE]);
+        ASSERT_EQ("key not found in storage", read(client, "txn:c")[JSON::KEY::DESCRIPTION]);
+
+        // a blind write conflicts too
+        txn = begin();
+        inside(txn, JSON::VALUE::REQUEST_WRITE, { { JSON::KEY::KEY, "txn:a" }, { JSON::KEY::VALUE, "3" } });
+        write(writer, "txn:a", "4");
+        ASSERT_EQ("transaction conflict", inside(txn, JSON::VALUE::REQUEST_COMMIT)[JSON::KEY::DESCRIPTION]);
+        ASSERT_EQ("4", read(client, "txn:a")[JSON::KEY::VALUE]);
+
+        // abort drops the writes, the id is gone with it
+        txn = begin();
+        inside(txn, JSON::VALUE::REQUEST_WRITE, { { JSON::KEY::KEY, "txn:d" }, { JSON::KEY::VALUE, "1" } });
+        ASSERT_EQ(JSON::VALUE::STATUS_OK, inside(txn, JSON::VALUE::REQUEST_ABORT)[JSON::KEY::STATUS]);
+        ASSERT_EQ("key not found in storage", read(client, "txn:d")[JSON::KEY::DESCRIPTION]);
+        ASSERT_EQ("transaction not found", inside(txn, JSON::VALUE::REQUEST_COMMIT)[JSON::KEY::DESCRIPTION]);
+
+        // unknown ids, another connection's id, a finished one
+        ASSERT_EQ("transaction not found", inside(txn + 1000, JSON::VALUE::REQUEST_READ, { { JSON::KEY::KEY, "txn:a" } })[JSON::KEY::DESCRIPTION]);
+        txn = begin();
+        answer = writer->request({ { JSON::KEY::REQUEST, JSON::VALUE::REQUEST_COMMIT }, { JSON::KEY::TXN, txn } });
+        ASSERT_EQ("transaction not found", answer[JSON::KEY::DESCRIPTION]);
+        ASSERT_EQ("field txn not found", client->request({ { JSON::KEY::REQUEST, JSON::VALUE::REQUEST_COMMIT } })[JSON::KEY::DESCRIPTION]);
+
+        // deadlines and versions are not part of a transaction
+        answer = inside(txn, JSON::VALUE::REQUEST_WRITE, { { JSON::KEY::KEY, "txn:e" }, { JSON::KEY::VALUE, "1" }, { JSON::KEY::TTL, 1000 } });
+        ASSERT_EQ("fields ttl and if_version are not supported inside a transaction", answer[JSON::KEY::DESCRIPTION]);
+        answer = inside(txn, JSON::VALUE::REQUEST_WRITE, { { JSON::KEY::KEY, "txn:e" }, { JSON::KEY::VALUE, "1" }, { JSON::KEY::IF_VERSION, 0 } });
+        ASSERT_EQ("fields ttl and if_version are not supported inside a transaction", answer[JSON::KEY::DESCRIPTION]);
+        answer = inside(txn, JSON::VALUE::REQUEST_READ, { { JSON::KEY::KEY, "txn:a" }, { JSON::KEY::IF_VERSION, 1 } });
+        ASSERT_EQ("fields ttl and if_version are not supported inside a transaction", answer[JSON::KEY::DESCRIPTION]);
+        ASSERT_EQ(JSON::VALUE::STATUS_OK, inside(txn, JSON::VALUE::REQUEST_COMMIT)[JSON::KEY::STATUS]);
+        ASSERT_EQ("key not found in storage", read(client, "txn:e")[JSON::KEY::DESCRIPTION]);
+    }
+
+    TEST_F(Test_StorageServer, Deadlines_Survive_Restart) {
+        TempDirectory directory;
+        ASSERT_TRUE(directory_create(directory.get()));
+
+        StorageOptions options;
+        options.walPath = directory.get() + "/wal.log";
+        options.snapshotPath = directory.get() + "/snapshot";
+
+        {
+            auto first = start_server(options);
+            auto target = connect_client(first);
+
+            // in the snapshot
+            write(target, "snapshot:long", "1", 3600 * 1000);
+            write(target, "snapshot:short", "1", 2000);
+            write(target, "snapshot:persisted", "1", 3600 * 1000);
+            target->request({ { JSON::KEY::REQUEST, JSON::VALUE::REQUEST_PERSIST }, { JSON::KEY::KEY, "snapshot:persisted" } });
+            ASSERT_EQ(JSON::VALUE::STATUS_OK, target->request({ { JSON::KEY::REQUEST, JSON::VALUE::REQUEST_SNAPSHOT } })[JSON::KEY::STATUS]);
+            ASSERT_TRUE(wait_until([&first]() { return !first->SnapshotRunning(); }));
+
+            // in the log after it
+            write(target, "wal:long", "1", 3600 * 1000);
+            write(target, "wal:persisted", "1", 3600 * 1000);
+            target->request({ { JSON::KEY::REQUEST, JSON::VALUE::REQUEST_PERSIST }, { JSON::KEY::KEY, "wal:persisted" } });
+            write(target, "wal:rewritten", "1", 3600 * 1000);
+            write(target, "wal:rewritten", "2");
+            ASSERT_EQ(3, ttlKeys(target));
+        }
+
+        auto second = start_server(options);
+        auto target = connect_client(second);
+
+        // the short one passed while the server was down
+        ASSERT_TRUE(wait_until([&target]() { return ttlKeys(target) == 2; }));
+        ASSERT_EQ("key not found in storage", read(target, "snapshot:short")[JSON::KEY::DESCRIPTION]);
+        ASSERT_EQ("1", read(target, "snapshot:long")[JSON::KEY::VALUE]);
+        ASSERT_EQ("1", read(target, "snapshot:persisted")[JSON::KEY::VALUE]);
+        ASSERT_EQ("1", read(target, "wal:long")[JSON::KEY::VALUE]);
+        ASSERT_EQ("2", read(target, "wal:rewritten")[JSON::KEY::VALUE]);
+    }
+
+    TEST_F(Test_StorageServer, Deadlines_Survive_Restart_Lsm) {
+        TempDirectory directory;
+
+        StorageOptions options;
+        options.engine = "lsm";
+        options.dataDir = directory.get();
+
+        {
+            auto first = start_server(options);
+            auto target = connect_client(first);
+
+            write(target, "lsm:long", "1", 3600 * 1000);
+            write(target, "lsm:persisted", "1", 3600 * 1000);
+            target->request({ { JSON::KEY::REQUEST, JSON::VALUE::REQUEST_PERSIST }, { JSON::KEY::KEY, "lsm:persisted" } });
+
+            // reclaimed, then written again without a ttl: its old deadline must not come back
+            write(target, "lsm:expired", "1", 50);
+            ASSERT_TRUE(wait_until([&target]() { return ttlKeys(target) == 1; }));
+            write(target, "lsm:expired", "2");
+        }
+
+        auto second = start_server(options);
+        auto target = connect_client(second);
+        ASSERT_EQ(1, ttlKeys(target));
+        ASSERT_EQ("1", read(target, "lsm:long")[JSON::KEY::VALUE]);
+        ASSERT_EQ("1", read(target, "lsm:persisted")[JSON::KEY::VALUE]);
+        std::this_thread::sleep_for(100ms);
+        ASSERT_EQ("2", read(target, "lsm:expired")[JSON::KEY::VALUE]);
+    }
+
+    TEST_F(Test_StorageServer, Deadlines_Reach_Follower) {
+        auto leader = start_server();
+        auto leaderClient = connect_client(leader);
+
+        // sent with the full sync
+        write(leaderClient, "sync:long", "1", 3600 * 1000);
+        write(leaderClient, "sync:plain", "1");
+
+        StorageOptions options;
+        options.replicaOfHost = "127.0.0.1";
+        options.replicaOfPort = leader->getPort();
+        auto follower = start_server(options);
+        auto followerClient = connect_client(follower);
+        ASSERT_TRUE(wait_until([&followerClient]() { return read(followerClient, "sync:plain").value(JSON::KEY::VALUE, string()) == "1"; }));
+        ASSERT_EQ(1, ttlKeys(followerClient));
+
+        // sent with the stream
+        write(leaderClient, "stream:long", "1", 3600 * 1000);
+        write(leaderClient, "stream:persisted", "1", 3600 * 1000);
+        leaderClient->request({ { JSON::KEY::REQUEST, JSON::VALUE::REQUEST_PERSIST }, { JSON::KEY::KEY, "stream:persisted" } });
+        write(leaderClient, "stream:short", "1", 300);
+        ASSERT_TRUE(wait_until([&followerClient]() { return ttlKeys(followerClient) == 3; }));
+        ASSERT_EQ("1", read(followerClient, "stream:persisted")[JSON::KEY::VALUE]);
+
+        ASSERT_TRUE(wait_until([&followerClient]() { return read(followerClient, "stream:short").contains(JSON::KEY::DESCRIPTION); }));
+        ASSERT_TRUE(wait_until([&followerClient]() { return ttlKeys(followerClient) == 2; }));
+        ASSERT_EQ("1", read(followerClient, "stream:long")[JSON::KEY::VALUE]);
+    }
+
+    TEST_F(Test_StorageServer, Resp_Set_Options) {
+        RespTestConnection resp(server->getRespPort());
+
+        ASSERT_EQ("+OK", resp.call({ "SET", "resp:ex", "1", "EX", "100" }));
+        const int64_t ttl = std::stoll(resp.call({ "PTTL", "resp:ex" }).substr(1));
+        ASSERT_GT(ttl, 90 * 1000);
+        ASSERT_LE(ttl, 100 * 1000);
+
+        // KEEPTTL keeps the deadline, a plain SET drops it
+        ASSERT_EQ("+OK", resp.call({ "SET", "resp:ex", "2", "KEEPTTL" }));
+        ASSERT_EQ("2", resp.call({ "GET", "resp:ex" }));
+        ASSERT_EQ(":100", resp.call({ "TTL", "resp:ex" }));
+        ASSERT_EQ("+OK", resp.call({ "SET", "resp:ex", "3" }));
+        ASSERT_EQ(":-1", resp.call({ "TTL", "resp:ex" }));
+
+        ASSERT_EQ("+OK", resp.call({ "SET", "resp:px", "1", "PX", "100" }));
+        std::this_thread::sleep_for(300ms);
+        ASSERT_EQ("$-1", resp.call({ "GET", "resp:px" }));
+        ASSERT_EQ(":-2", resp.call({ "PTTL", "resp:px" }));
+
+        ASSERT_EQ("+OK", resp.call({ "SET", "resp:nx", "1", "NX" }));
+        ASSERT_EQ("$-1", resp.call({ "SET", "resp:nx", "2", "NX", "EX", "100" }));
+        ASSERT_EQ("1", resp.call({ "GET", "resp:nx" }));
+        ASSERT_EQ(":-1", resp.call({ "TTL", "resp:nx" }));
+
+        ASSERT_EQ("$-1", resp.call({ "SET", "resp:xx", "1", "XX" }));
+        ASSERT_EQ("$-1", resp.call({ "GET", "resp:xx" }));
+        ASSERT_EQ("+OK", resp.call({ "SET", "resp:nx", "2", "XX", "PX", "100000" }));
+        ASSERT_EQ("2", resp.call({ "GET", "resp:nx" }));
+        ASSERT_EQ(":100", resp.call({ "TTL", "resp:nx" }));
+
+        ASSERT_EQ("-ERR syntax error", resp.call({ "SET", "resp:bad", "1", "NX", "XX" }));
+        ASSERT_EQ("-ERR syntax error", resp.call({ "SET", "resp:bad", "1", "EX", "10", "PX", "10" }));
+        ASSERT_EQ("-ERR syntax error", resp.call({ "SET", "resp:bad", "1", "EX", "10", "KEEPTTL" }));
+        ASSERT_EQ("-ERR invalid expire time in 'set' command", resp.call({ "SET", "resp:bad", "1", "EX", "0" }));
+        ASSERT_EQ("-ERR value is not an integer or out of range", resp.call({ "SET", "resp:bad", "1", "PX", "soon" }));
+        ASSERT_EQ("$-1", resp.call({ "GET", "resp:bad" }));
+    }
+
+    TEST_F(Test_StorageServer, Resp_Expire) {
+        RespTestConnection resp(server->getRespPort());
+
+        ASSERT_EQ("+OK", resp.call({ "SET", "resp:expire", "1" }));
+        ASSERT_EQ(":1", resp.call({ "EXPIRE", "resp:expire", "100" }));
+        ASSERT_EQ(":100", resp.call({ "TTL", "resp:expire" }));
+        ASSERT_EQ(":1", resp.call({ "PERSIST", "resp:expire" }));
+        ASSERT_EQ(":-1", resp.call({ "TTL", "resp:expire" }));
+
+        // a deadline in the past deletes the key
+        ASSERT_EQ(":1", resp.call({ "PEXPIRE", "resp:expire", "0" }));
+        ASSERT_EQ("$-1", resp.call({ "GET", "resp:expire" }));
+        ASSERT_EQ(":0", resp.call({ "EXPIRE", "resp:expire", "-1" }));
+        ASSERT_EQ(":0", resp.call({ "PERSIST", "resp:expire" }));
+    }
+
+    TEST_F(Test_StorageServer, Resp_Refuses_Invalid_Utf8) {
+        // a watcher and a follower get every write as JSON
+        std::mutex sync;
+        std::vector<nlohmann::json> events;
+        auto watcher = connect_client(server);
+        watcher->setEventHandler([&sync, &events](const string &, const nlohmann::json &event) {
+            std::lock_guard<std::mutex> guard(sync);
+            events.push_back(event);
+        });
+        ASSERT_EQ(JSON::VALUE::STATUS_OK, watcher->request({ { JSON::KEY::REQUEST, JSON::VALUE::REQUEST_WATCH }, { JSON::KEY::PREFIX, "resp:utf8" } })[JSON::KEY::STATUS]);
+
+        StorageOptions options;
+        options.replicaOfHost = "127.0.0.1";
+        options.replicaOfPort = server->getPort();
+        auto follower = start_server(options);
+        auto followerClient = connect_client(follower);
+
+        RespTestConnection resp(server->getRespPort());
+        const string binary = "\xff\xfe";
+        const string refused = "-ERR keys and values must be valid UTF-8";
+        ASSERT_EQ(refused, resp.call({ "SET", "resp:utf8:bin", binary }));
+        ASSERT_EQ(refused, resp.call({ "SET", "resp:utf8:" + binary, "1" }));
+        ASSERT_EQ(refused, resp.call({ "MSET", "resp:utf8:a", "1", "resp:utf8:b", binary }));
+        ASSERT_EQ(refused, resp.call({ "APPEND", "resp:utf8:bin", "\xc3" }));
+        ASSERT_EQ(refused, resp.call({ "SETEX", "resp:utf8:bin", "100", "\xed\xa0\x80" }));
+
+        // a read takes any key, nothing is stored under it
+        ASSERT_EQ("$-1", resp.call({ "GET", "resp:utf8:" + binary }));
+        ASSERT_EQ("+OK", resp.call({ "SET", "resp:utf8:text", "h\xc3\xa9" }));
+
+        // the server and the native protocol are fine
+        ASSERT_TRUE(server->Started());
+        ASSERT_EQ("key not found in storage", read(client, "resp:utf8:bin")[JSON::KEY::DESCRIPTION]);
+        ASSERT_EQ("h\xc3\xa9", read(client, "resp:utf8:text")[JSON::KEY::VALUE]);
+        const auto answer = client->request({ { JSON::KEY::REQUEST, JSON::VALUE::REQUEST_MGET }, { JSON::KEY::KEYS, { "resp:utf8:text", "resp:utf8:a", "resp:utf8:bin" } } });
+        ASSERT_EQ(nlohmann::json({ "h\xc3\xa9", nullptr, nullptr }), answer[JSON::KEY::VALUES]);
+
+        ASSERT_TRUE(wait_until([&followerClient]() { return read(followerClient, "resp:utf8:text").value(JSON::KEY::VALUE, string()) == "h\xc3\xa9"; }));
+        ASSERT_TRUE(wait_until([&sync, &events]() {
+            std::lock_guard<std::mutex> guard(sync);
+            return events.size() == 1;
+        }));
+        std::lock_guard<std::mutex> guard(sync);
+        ASSERT_EQ("resp:utf8:text", events[0][JSON::KEY::KEY]);
+    }
+
+    TEST_F(Test_StorageServer, Resp_Incr_Overflow) {
+        RespTestConnection resp(server->getRespPort());
+
+        ASSERT_EQ(":1", resp.call({ "INCR", "resp:counter" }));
+        ASSERT_EQ(":-9", resp.call({ "DECRBY", "resp:counter", "10" }));
+
+        const string max = std::to_string(std::numeric_limits<int64_t>::max());
+        ASSERT_EQ("+OK", resp.call({ "SET", "resp:max", max }));
+        ASSERT_EQ("-ERR increment or decrement would overflow", resp.call({ "INCR", "resp:max" }));
+        ASSERT_EQ(max, resp.call({ "GET", "resp:max" }));
+
+        const string min = std::to_string(std::numeric_limits<int64_t>::min());
+        ASSERT_EQ("+OK", resp.call({ "SET", "resp:min", min }));
+        ASSERT_EQ("-ERR increment or decrement would overflow", resp.call({ "DECR", "resp:min" }));
+        ASSERT_EQ(":1", resp.call({ "INCRBY", "resp:counter", "10" }));
+        ASSERT_EQ("-ERR increment or decrement would overflow", resp.call({ "INCRBY", "resp:counter", max }));
+        ASSERT_EQ(min, resp.call({ "GET", "resp:min" }));
+
+        ASSERT_EQ("+OK", resp.call({ "SET", "resp:text", "abc" }));
+        ASSERT_EQ("-ERR value is not an integer or out of range", resp.call({ "INCR", "resp:text" }));
+        ASSERT_EQ("-ERR value is not an integer or out of range", resp.call({ "INCRBY", "resp:counter", "1.5" }));
+    }
+
+    TEST_F(Test_StorageServer, Resp_Quit_Closes) {
+        RespTestConnection resp(server->getRespPort());
+
+        // the command behind QUIT in the same read is not served
+        resp.send({ "SET", "resp:quit", "1" });
+        resp.send({ "QUIT" });
+        resp.send({ "SET", "resp:quit", "2" });
+        ASSERT_EQ("+OK", resp.reply());
+        ASSERT_EQ("+OK", resp.reply());
+        ASSERT_TRUE(resp.closedByServer());
+
+        RespTestConnection other(server->getRespPort());
+        ASSERT_EQ("1", other.call({ "GET", "resp:quit" }));
+    }
+
+    TEST_F(Test_StorageServer, Resp_Readonly_Replica) {
+        RespTestConnection resp(server->getRespPort());
+        ASSERT_EQ("+OK", resp.call({ "SET", "resp:replicated", "1" }));
+
+        StorageOptions options;
+        options.replicaOfHost = "127.0.0.1";
+        options.replicaOfPort = server->getPort();
+        options.respPort = free_port();
+        auto follower = start_server(options);
+        RespTestConnection replica(follower->getRespPort());
+        ASSERT_TRUE(wait_until([&replica]() { return replica.call({ "GET", "resp:replicated" }) == "1"; }));
+
+        const string readonly = "-READONLY You can't write against a read only replica.";
+        ASSERT_EQ(readonly, replica.call({ "SET", "resp:replicated", "2" }));
+        ASSERT_EQ(readonly, replica.call({ "INCR", "resp:replicated" }));
+        ASSERT_EQ(readonly, replica.call({ "DEL", "resp:replicated" }));
+        ASSERT_EQ(readonly, replica.call({ "EXPIRE", "resp:replicated", "10" }));
+        ASSERT_EQ("1", replica.call({ "GET", "resp:replicated" }));
+        ASSERT_EQ(":-1", replica.call({ "TTL", "resp:replicated" }));
+        ASSERT_EQ("+PONG", replica.call({ "PING" }));
+    }
+}// namespace Diginext::Core::Storage::GTest
+
+#endif
@@ -0,0 +1,105 @@
+#ifndef DIGINEXT_GTEST___STORAGE_STORAGE_TEST_UTILS_H
+#define DIGINEXT_GTEST___STORAGE_STORAGE_TEST_UTILS_H
+
+#include <Storage/StorageClient.h>
+#include <Storage/StorageFile.h>
+#include <Storage/StorageOptions.h>
+#include <Storage/StorageServer.h>
+
+#include <chrono>
+#include <filesystem>
+#include <functional>
+#include <string>
+#include <thread>
+
+#include <boost/asio.hpp>
+#include <boost/uuid/uuid.hpp>
+#include <boost/uuid/uuid_generators.hpp>
+#include <boost/uuid/uuid_io.hpp>
+
+namespace Diginext::Core::Storage::GTest {
+
+    /**
+     * \brief unique file name in working directory, removed on scope exit
+     */
+    class TempPath {
+    private:
+        std::string path;
+
+    public:
+        explicit TempPath(const std::string &suffix) {
+            const boost::uuids::uuid boost_uuid = boost::uuids::random_generator()();
+            this->path = "diginext_test_" + boost::uuids::to_string(boost_uuid) + suffix;
+        }
+
+        ~TempPath() {
+            file_remove(this->path);
+        }
+
+        const std::string &get() const {
+            return this->path;
+        }
+    };
+
+    /**
+     * \brief unique directory name in working directory, removed with its content on scope exit
+     */
+    class TempDirectory {
+    private:
+        std::string path;
+
+    public:
+        TempDirectory() {
+            const boost::uuids::uuid boost_uuid = boost::uuids::random_generator()();
+            this->path = "diginext_test_" + boost::uuids::to_string(boost_uuid);
+        }
+
+        ~TempDirectory() {
+            std::error_code error;
+            std::filesystem::remove_all(this->path, error);
+        }
+
+        const std::string &get() const {
+            return this->path;
+        }
+    };
+
+    /**
+     * @brief a localhost port nothing listens on right now, for listeners that take no port 0
+     */
+    inline unsigned short free_port() {
+        boost::asio::io_service ios;
+        boost::asio::ip::tcp::acceptor acceptor(ios, boost::asio::ip::tcp::endpoint(boost::asio::ip::address::from_string("127.0.0.1"), 0));
+        return acceptor.local_endpoint().port();
+    }
+
+    /**
+     * @brief started server on a random localhost port; every start takes a few seconds
+     */
+    inline StorageServer::pointer start_server(const StorageOptions &options = StorageOptions()) {
+        auto server = StorageServer::create("127.0.0.1", 0, options);
+        server->Start();
+        return server;
+    }
+
+    inline StorageClient::pointer connect_client(const StorageServer::pointer &server) {
+        return StorageClient::create("127.0.0.1", server->getPort());
+    }
+
+    /**
+     * @brief poll condition until it holds or timeout passes
+     * @return true if condition holds
+     */
+    inline bool wait_until(const std::function<bool()> &condition, std::chrono::milliseconds timeout = std::chrono::seconds(10)) {
+        const auto deadline = std::chrono::steady_clock::now() + timeout;
+        while (!condition()) {
+            if (std::chrono::steady_clock::now() > deadline) {
+                return false;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+        return true;
+    }
+}// namespace Diginext::Core::Storage::GTest
+
+#endif
@@ -0,0 +1,102 @@
+#ifndef DIGINEXT_GTEST___STORAGE_WATCH_REGISTRY_TEST_H
+#define DIGINEXT_GTEST___STORAGE_WATCH_REGISTRY_TEST_H
+
+#include <gtest/gtest.h>
+
+#include <Base64/Base64.h>
+#include <Storage/WatchRegistry.h>
+#include <TCP/TCPConnection.h>
+
+#include <string>
+#include <vector>
+
+#include <boost/asio.hpp>
+
+namespace Diginext::Core::Storage::GTest {
+    using namespace std;
+    using namespace Diginext::Core::TCP;
+
+    // the io service never runs: frames stay queued on the unconnected sockets
+    inline std::vector<tcp_connection::pointer> watch_connections(boost::asio::io_service &ios, size_t count) {
+        std::vector<tcp_connection::pointer> connections;
+        for (size_t i = 0; i < count; i++) {
+            connections.push_back(tcp_connection::create(ios));
+        }
+        return connections;
+    }
+
+    TEST(Test_WatchRegistry, Keys_Prefixes_Once_Per_Subscriber) {
+        boost::asio::io_service ios;
+        const auto connections = watch_connections(ios, 3);
+        WatchRegistry registry(1 << 20, WatchOverflowPolicy::Drop);
+        ASSERT_TRUE(registry.empty());
+
+        ASSERT_TRUE(registry.watch(connections[0], "user:1", false));
+        ASSERT_FALSE(registry.watch(connections[0], "user:1", false));
+        ASSERT_TRUE(registry.watch(connections[0], "user:", true));
+        ASSERT_TRUE(registry.watch(connections[1], "user:", true));
+        ASSERT_TRUE(registry.watch(connections[2], "", true));
+        ASSERT_EQ(4, registry.getSubscriptions());
+        ASSERT_EQ(3, registry.getWatchers());
+
+        // key and prefix match for the first one, it still gets one event
+        const string value = "v";
+        ASSERT_TRUE(registry.notify("user:1", &value).empty());
+        ASSERT_EQ(3, registry.getEventsSent());
+        const size_t frame = encode_frame(R"({"event":"put","key":"user:1","value":"v"})")->size();
+        for (const auto &connection : connections) {
+            ASSERT_EQ(frame, connection->getQueuedBytes());
+        }
+
+        // only the catch-all prefix matches
+        registry.notify("order:1", nullptr);
+        ASSERT_EQ(4, registry.getEventsSent());
+        ASSERT_EQ(frame, connections[0]->getQueuedBytes());
+
+        ASSERT_TRUE(registry.unwatch(connections[2]->getUUID(), "", true));
+        ASSERT_FALSE(registry.unwatch(connections[2]->getUUID(), "", true));
+        registry.remove(connections[0]->getUUID());
+        ASSERT_EQ(1, registry.getSubscriptions());
+        ASSERT_EQ(1, registry.getWatchers());
+
+        registry.notify("user:2", &value);
+        ASSERT_EQ(5, registry.getEventsSent());
+        ASSERT_EQ(frame, connections[0]->getQueuedBytes());
+
+        registry.remove(connections[1]->getUUID());
+        ASSERT_TRUE(registry.empty());
+    }
+
+    TEST(Test_WatchRegistry, Overflow_Policies) {
+        boost::asio::io_service ios;
+        const auto connections = watch_connections(ios, 2);
+        const string value(100, 'v');
+        const size_t frame = encode_frame(R"({"event":"put","key":"hot","value":")" + value + R"("})")->size();
+
+        // room for three events, the rest is dropped and counted
+        WatchRegistry dropping(frame * 3, WatchOverflowPolicy::Drop);
+        dropping.watch(connections[0], "hot", false);
+        for (size_t i = 0; i < 10; i++) {
+            ASSERT_TRUE(dropping.notify("hot", &value).empty());
+        }
+        ASSERT_EQ(3, dropping.getEventsSent());
+        ASSERT_EQ(7, dropping.getEventsDropped());
+        ASSERT_EQ(frame * 3, connections[0]->getQueuedBytes());
+
+        // the queue has not drained, the overflow event waits
+        ASSERT_TRUE(dropping.flushOverflows());
+
+        // a slow subscriber is closed instead, the others keep their events
+        WatchRegistry disconnecting(frame * 3, WatchOverflowPolicy::Disconnect);
+        disconnecting.watch(connections[0], "hot", false);
+        disconnecting.watch(connections[1], "hot", false);
+        const auto slow = disconnecting.notify("hot", &value);
+        ASSERT_EQ(1, slow.size());
+        ASSERT_EQ(connections[0]->getUUID(), slow[0]->getUUID());
+        ASSERT_EQ(1, disconnecting.getDisconnects());
+        ASSERT_EQ(1, disconnecting.getWatchers());
+        ASSERT_EQ(frame, connections[1]->getQueuedBytes());
+    }
+}// namespace Diginext::Core::Storage::GTest
+
+#endif
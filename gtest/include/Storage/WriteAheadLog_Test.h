@@ -0,0 +1,206 @@
+#ifndef DIGINEXT_GTEST___STORAGE_WRITE_AHEAD_LOG_TEST_H
+#define DIGINEXT_GTEST___STORAGE_WRITE_AHEAD_LOG_TEST_H
+
+#include <gtest/gtest.h>
+
+#include "Storage/StorageTestUtils.h"
+
+#include <Storage/StorageFile.h>
+#include <Storage/WriteAheadLog.h>
+
+#include <atomic>
+#include <cstdio>
+#include <map>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace Diginext::Core::Storage::GTest {
+    using namespace std;
+
+    inline std::map<string, string> replayToMap(const string &path, size_t *count = nullptr) {
+        std::map<string, string> data;
+        WriteAheadLog wal(path);
+        const size_t applied = wal.replay([&data](const WalRecord &record) {
+            if (record.type == WalRecordType::Put) {
+                data[record.key] = record.value;
+            } else {
+                data.erase(record.key);
+            }
+        });
+
+        if (count != nullptr) {
+            *count = applied;
+        }
+
+        return data;
+    }
+
+    TEST(Test_WriteAheadLog, Append_Replay) {
+        TempPath path(".wal");
+
+        for (const auto policy : { FsyncPolicy::Always, FsyncPolicy::GroupCommit, FsyncPolicy::Async }) {
+            file_remove(path.get());
+
+            {
+                WriteAheadLog wal(path.get(), policy);
+                wal.open();
+                wal.append(WalRecordType::Put, "a", "1");
+                wal.append(WalRecordType::Put, "b", string(100000, 'b'));
+                wal.append(WalRecordType::Put, "", "");
+                wal.append(WalRecordType::Remove, "a", "");
+                const uint64_t offset = wal.append(WalRecordType::Put, "c", string("3\n\0x", 4));
+                wal.waitDurable(offset);
+                ASSERT_EQ(offset, wal.getDurableOffset());
+            }
+
+            size_t count = 0;
+            const auto data = replayToMap(path.get(), &count);
+            ASSERT_EQ(5, count);
+            ASSERT_EQ(3, data.size());
+            ASSERT_EQ(0, data.count("a"));
+            ASSERT_EQ(string(100000, 'b'), data.at("b"));
+            ASSERT_EQ("", data.at(""));
+            ASSERT_EQ(string("3\n\0x", 4), data.at("c"));
+        }
+    }
+
+    TEST(Test_WriteAheadLog, Group_Commit_Callbacks) {
+        TempPath path(".wal");
+        const int THREADS = 8;
+        const int COUNT = 200;
+
+        std::atomic<int> durable(0);
+        {
+            WriteAheadLog wal(path.get(), FsyncPolicy::GroupCommit);
+            wal.open();
+
+            std::vector<std::thread> threads;
+            for (int t = 0; t < THREADS; t++) {
+                threads.emplace_back([&wal, &durable, t]() {
+                    for (int i = 0; i < COUNT; i++) {
+                        wal.append(WalRecordType::Put, std::to_string(t) + "_" + std::to_string(i), "v",
+                                   [&durable](bool ok) { if (ok) durable++; });
+                    }
+                });
+            }
+
+            for (auto &thread : threads) {
+                thread.join();
+            }
+        }
+
+        ASSERT_EQ(THREADS * COUNT, durable.load());
+        ASSERT_EQ(THREADS * COUNT, replayToMap(path.get()).size());
+    }
+
+    TEST(Test_WriteAheadLog, Append_Batch) {
+        TempPath path(".wal");
+
+        std::atomic<int> durable(0);
+        bool applied = false;
+        {
+            WriteAheadLog wal(path.get(), FsyncPolicy::GroupCommit);
+            wal.open();
+            wal.append(WalRecordType::Put, "a", "before");
+
+            std::vector<std::pair<string, string>> records;
+            for (int i = 0; i < 100; i++) {
+                records.emplace_back("key:" + std::to_string(i), std::to_string(i));
+            }
+            records.emplace_back("a", "after");
+
+            const uint64_t offset = wal.appendBatch(records, [&durable](bool ok) { if (ok) durable++; }, [&applied]() { applied = true; });
+            wal.waitDurable(offset);
+            ASSERT_TRUE(applied);
+        }
+
+        // one callback for the whole batch, records replay one by one
+        ASSERT_EQ(1, durable.load());
+        size_t count = 0;
+        const auto data = replayToMap(path.get(), &count);
+        ASSERT_EQ(102, count);
+        ASSERT_EQ(101, data.size());
+        ASSERT_EQ("after", data.at("a"));
+        ASSERT_EQ("99", data.at("key:99"));
+    }
+
+    TEST(Test_WriteAheadLog, Truncated_Tail) {
+        TempPath path(".wal");
+
+        uint64_t goodSize;
+        {
+            WriteAheadLog wal(path.get(), FsyncPolicy::Always);
+            wal.open();
+            wal.append(WalRecordType::Put, "a", "1");
+            goodSize = wal.append(WalRecordType::Put, "b", "2");
+            wal.waitDurable(wal.append(WalRecordType::Put, "c", "333333"));
+        }
+
+        // cut the last record in the middle
+        ASSERT_TRUE(file_truncate(path.get(), file_size(path.get()) - 3));
+
+        size_t count = 0;
+        const auto data = replayToMap(path.get(), &count);
+        ASSERT_EQ(2, count);
+        ASSERT_EQ(0, data.count("c"));
+        ASSERT_EQ(goodSize, file_size(path.get()));
+
+        // log keeps working after the tail was dropped
+        {
+            WriteAheadLog wal(path.get(), FsyncPolicy::Always);
+            wal.replay([](const WalRecord &) {});
+            wal.open();
+            wal.waitDurable(wal.append(WalRecordType::Put, "d", "4"));
+        }
+
+        const auto data2 = replayToMap(path.get());
+        ASSERT_EQ(3, data2.size());
+        ASSERT_EQ("4", data2.at("d"));
+    }
+
+    TEST(Test_WriteAheadLog, Corrupted_Record) {
+        TempPath path(".wal");
+
+        uint64_t firstSize;
+        {
+            WriteAheadLog wal(path.get(), FsyncPolicy::Always);
+            wal.open();
+            firstSize = wal.append(WalRecordType::Put, "a", "1");
+            wal.waitDurable(wal.append(WalRecordType::Put, "b", "2"));
+        }
+
+        // flip one byte of the second record value
+        FILE *file = std::fopen(path.get().c_str(), "r+b");
+        ASSERT_NE(nullptr, file);
+        std::fseek(file, -1, SEEK_END);
+        std::fputc('X', file);
+        std::fclose(file);
+
+        size_t count = 0;
+        const auto data = replayToMap(path.get(), &count);
+        ASSERT_EQ(1, count);
+        ASSERT_EQ("1", data.at("a"));
+        ASSERT_EQ(firstSize, file_size(path.get()));
+    }
+
+    TEST(Test_WriteAheadLog, Replay_From_Offset) {
+        TempPath path(".wal");
+
+        uint64_t offset;
+        {
+            WriteAheadLog wal(path.get(), FsyncPolicy::Always);
+            wal.open();
+            offset = wal.append(WalRecordType::Put, "a", "1");
+            wal.waitDurable(wal.append(WalRecordType::Put, "b", "2"));
+        }
+
+        std::vector<string> keys;
+        WriteAheadLog wal(path.get());
+        ASSERT_EQ(1, wal.replay([&keys](const WalRecord &record) { keys.push_back(record.key); }, offset));
+        ASSERT_EQ(std::vector<string>{ "b" }, keys);
+    }
+}// namespace Diginext::Core::Storage::GTest
+
+#endif
@@ -7,9 +7,12 @@
 #include "TCP/TCPClient.h"
 #include "TCP/TCPServer.h"
 
+#include <algorithm>
 #include <chrono>
 #include <list>
+#include <mutex>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include <boost/asio.hpp>
@@ -394,6 +397,384 @@ namespace Diginext::Core::TCP::GTest {
         TEST(Test_TCP_Server_Client, send___server___10) {
             test___send___server(10);
         }
+
+        TEST(Test_TCP_Server_Client, send___binary_framing) {
+            unsigned char header[BINARY_HEADER_SIZE];
+            write_binary_header(header, { 1048576, 3, 0x0102030405060708ULL });
+            const binary_header decoded = read_binary_header(header);
+            ASSERT_EQ(1048576, decoded.length);
+            ASSERT_EQ(3, decoded.flags);
+            ASSERT_EQ(0x0102030405060708ULL, decoded.requestId);
+
+            // delimiters and zero bytes are payload like any other byte
+            std::vector<std::string> messages = { "", "line\none\n", std::string(64, '\0'), std::string(4096, 'k'), std::string(1 << 20, '\n') };
+
+            std::mutex sync;
+            std::vector<std::pair<uint64_t, std::string>> server_received;
+            std::vector<std::string> client_received;
+
+            tcp::endpoint endpoint = getLocalEndpoint();
+            auto srv = tcp_server::create(endpoint);
+            srv->setFraming(tcp_framing::Binary);
+            srv->onReadMessage.connect([&](tcp_connection::pointer connection, std::string msg) {
+                std::lock_guard<std::mutex> guard(sync);
+                server_received.emplace_back(connection->getReadRequestId(), msg);
+            });
+            srv->start();
+
+            tcp::endpoint client_endpoint = getLocalEndpoint(srv->getPort());
+            auto client = tcp_client::create();
+            client->setFraming(tcp_framing::Binary);
+            client->onReadMessage.connect([&](std::string msg) {
+                std::lock_guard<std::mutex> guard(sync);
+                client_received.push_back(msg);
+            });
+            client->connect(client_endpoint);
+            client->start();
+
+            for (int i = 0; i < 50 && (srv->getConnections().empty() || srv->getConnectionsVector()[0]->negotiating()); i++) {
+                std::this_thread::sleep_for(100ms);
+            }
+            ASSERT_FALSE(srv->getConnections().empty());
+            ASSERT_EQ(tcp_framing::Binary, srv->getConnectionsVector()[0]->getFraming());
+
+            for (size_t i = 0; i < messages.size(); i++) {
+                client->getConnection()->send(messages[i], i + 100);
+            }
+            srv->sendAll(messages[1]);
+            srv->sendAll(messages[4]);
+
+            for (int i = 0; i < 50; i++) {
+                {
+                    std::lock_guard<std::mutex> guard(sync);
+                    if (server_received.size() == messages.size() && client_received.size() == 2) {
+                        break;
+                    }
+                }
+                std::this_thread::sleep_for(100ms);
+            }
+
+            {
+                std::lock_guard<std::mutex> guard(sync);
+                ASSERT_EQ(messages.size(), server_received.size());
+                for (size_t i = 0; i < messages.size(); i++) {
+                    ASSERT_EQ(i + 100, server_received[i].first);
+                    ASSERT_EQ(messages[i], server_received[i].second);
+                }
+                ASSERT_EQ(2, client_received.size());
+                ASSERT_EQ(messages[1], client_received[0]);
+                ASSERT_EQ(messages[4], client_received[1]);
+            }
+
+            client->stop();
+            srv->stop();
+        }
+
+        TEST(Test_TCP_Server_Client, send___negotiated_framing) {
+            // compressible, like the JSON the storage protocol carries
+            std::string large;
+            for (int i = 0; large.size() < 256 * 1024; i++) {
+                large += R"({"request":"write","key":"key:)" + std::to_string(i) + R"(","value":"value"})";
+            }
+            const std::vector<std::string> messages = { "small", large, std::string(100, '\n') };
+
+            const auto frame = encode_frame(large, tcp_framing::Compressed, 7);
+            const binary_header header = read_binary_header(reinterpret_cast<const unsigned char *>(frame->data()));
+            std::string decoded;
+            if (tcp_compression_available()) {
+                ASSERT_EQ(FRAME_FLAG_COMPRESSED, header.flags);
+                ASSERT_LT(frame->size(), large.size() / 4);
+                ASSERT_TRUE(decode_payload(frame->data() + BINARY_HEADER_SIZE, header.length, header.flags, decoded));
+                ASSERT_EQ(large, decoded);
+                ASSERT_FALSE(decode_payload(frame->data() + BINARY_HEADER_SIZE, header.length / 2, header.flags, decoded));
+            }
+            ASSERT_EQ(0, read_binary_header(reinterpret_cast<const unsigned char *>(encode_frame("small", tcp_framing::Compressed)->data())).flags);
+
+            // one listener, every kind of client; the second one grants binary at most, the third answers every hello with base64
+            for (const tcp_framing best : { tcp_best_framing(), tcp_framing::Binary, tcp_framing::Base64Line }) {
+                tcp::endpoint endpoint = getLocalEndpoint();
+                auto srv = tcp_server::create(endpoint);
+                srv->setFraming(best);
+                srv->onReadMessage.connect([&](tcp_connection::pointer connection, std::string msg) {
+                    connection->send(msg);
+                });
+                srv->start();
+
+                const std::vector<tcp_framing> requested = { tcp_framing::Base64Line, tcp_framing::Binary, tcp_framing::Compressed };
+                std::mutex sync;
+                std::vector<std::vector<std::string>> received(requested.size());
+                std::vector<tcp_client::pointer> clients;
+                for (size_t c = 0; c < requested.size(); c++) {
+                    tcp::endpoint client_endpoint = getLocalEndpoint(srv->getPort());
+                    auto client = tcp_client::create();
+                    client->setFraming(requested[c]);
+                    client->onReadMessage.connect([&, c](std::string msg) {
+                        std::lock_guard<std::mutex> guard(sync);
+                        received[c].push_back(msg);
+                    });
+                    client->connect(client_endpoint);
+                    client->start();
+
+                    // sent before the hello is answered, held until the framing is known
+                    for (const auto &message : messages) {
+                        client->send(message);
+                    }
+                    clients.push_back(client);
+                }
+
+                for (int i = 0; i < 100; i++) {
+                    {
+                        std::lock_guard<std::mutex> guard(sync);
+                        if (received[0].size() == messages.size() && received[1].size() == messages.size() && received[2].size() == messages.size()) {
+                            break;
+                        }
+                    }
+                    std::this_thread::sleep_for(50ms);
+                }
+
+                {
+                    std::lock_guard<std::mutex> guard(sync);
+                    for (size_t c = 0; c < requested.size(); c++) {
+                        ASSERT_EQ(messages, received[c]) << tcp_framing_to_string(requested[c]);
+                        ASSERT_EQ(std::min(requested[c], best), clients[c]->getConnection()->getFraming());
+                    }
+                }
+
+                std::vector<tcp_framing> granted;
+                for (const auto &connection : srv->getConnectionsVector()) {
+                    ASSERT_FALSE(connection->negotiating());
+                    granted.push_back(connection->getFraming());
+                }
+                std::sort(granted.begin(), granted.end());
+                ASSERT_EQ((std::vector<tcp_framing>{ tcp_framing::Base64Line, std::min(tcp_framing::Binary, best), std::min(tcp_framing::Compressed, best) }), granted);
+
+                for (const auto &client : clients) {
+                    client->stop();
+                }
+                srv->stop();
+            }
+        }
+
+        TEST(Test_TCP_Server_Client, send___request_id_out_of_order) {
+            const size_t count = 200;
+            tcp::endpoint endpoint = getLocalEndpoint();
+            auto srv = tcp_server::create(endpoint);
+            srv->setFraming(tcp_framing::Binary);
+
+            // every request held until the last is in, then answered last first with the id it came with
+            std::vector<std::pair<uint64_t, std::string>> held;
+            srv->onReadMessage.connect([&](tcp_connection::pointer connection, std::string msg) {
+                held.emplace_back(connection->getReadRequestId(), msg);
+                if (held.size() == count) {
+                    for (auto request = held.rbegin(); request != held.rend(); ++request) {
+                        connection->send("answer " + request->second, request->first);
+                    }
+                }
+            });
+            srv->start();
+
+            std::mutex sync;
+            std::vector<std::pair<uint64_t, std::string>> received;
+            tcp::endpoint client_endpoint = getLocalEndpoint(srv->getPort());
+            auto client = tcp_client::create();
+            client->setFraming(tcp_framing::Binary);
+            client->onReadReply.connect([&](uint64_t requestId, std::string msg) {
+                std::lock_guard<std::mutex> guard(sync);
+                received.emplace_back(requestId, msg);
+            });
+            client->connect(client_endpoint);
+            client->start();
+
+            for (size_t i = 1; i <= count; i++) {
+                client->send("request " + std::to_string(i), 1000 + i);
+            }
+
+            for (int i = 0; i < 100; i++) {
+                {
+                    std::lock_guard<std::mutex> guard(sync);
+                    if (received.size() == count) {
+                        break;
+                    }
+                }
+                std::this_thread::sleep_for(50ms);
+            }
+
+            {
+                std::lock_guard<std::mutex> guard(sync);
+                ASSERT_EQ(count, received.size());
+                for (size_t i = 0; i < count; i++) {
+                    const size_t request = count - i;
+                    ASSERT_EQ(1000 + request, received[i].first);
+                    ASSERT_EQ("answer request " + std::to_string(request), received[i].second);
+                }
+            }
+
+            client->stop();
+            srv->stop();
+        }
+
+        /**
+         * \brief true once the server closed the socket, false if it is still open after timeout
+         */
+        inline bool wait_closed_by_server(tcp::socket &socket, std::chrono::milliseconds timeout = 5s) {
+            socket.non_blocking(true);
+            const auto start = std::chrono::steady_clock::now();
+            char chunk[256];
+            while (std::chrono::steady_clock::now() - start < timeout) {
+                boost::system::error_code error;
+                socket.read_some(boost::asio::buffer(chunk), error);
+                if (error == boost::asio::error::eof || error == boost::asio::error::connection_reset) {
+                    return true;
+                }
+                if (error == boost::asio::error::would_block) {
+                    std::this_thread::sleep_for(20ms);
+                }
+            }
+            return false;
+        }
+
+        inline bool wait_no_connections(tcp_server::pointer srv) {
+            for (int i = 0; i < 100 && !srv->getConnections().empty(); i++) {
+                std::this_thread::sleep_for(50ms);
+            }
+            return srv->getConnections().empty();
+        }
+
+        TEST(Test_TCP_Server_Client, sendAll___mixed_framings) {
+            const std::string message = "broadcast\n" + std::string(4096, 'b');
+
+            tcp::endpoint endpoint = getLocalEndpoint();
+            auto srv = tcp_server::create(endpoint);
+            srv->setFraming(tcp_framing::Binary);
+            srv->start();
+
+            std::mutex sync;
+            std::vector<std::vector<std::string>> received(2);
+            std::vector<tcp_client::pointer> clients;
+            for (const tcp_framing framing : { tcp_framing::Base64Line, tcp_framing::Binary }) {
+                const size_t c = clients.size();
+                auto client = tcp_client::create();
+                client->setFraming(framing);
+                client->onReadMessage.connect([&, c](std::string msg) {
+                    std::lock_guard<std::mutex> guard(sync);
+                    received[c].push_back(msg);
+                });
+                tcp::endpoint client_endpoint = getLocalEndpoint(srv->getPort());
+                client->connect(client_endpoint);
+                client->start();
+                clients.push_back(client);
+            }
+
+            // a legacy client has no hello, its first line tells the server
+            clients[0]->send("legacy");
+
+            // connected, but its hello is not sent yet
+            boost::asio::io_service ios;
+            tcp::socket late(ios);
+            late.connect(getLocalEndpoint(srv->getPort()));
+
+            auto negotiated = [&srv]() {
+                size_t count = 0;
+                for (const auto &connection : srv->getConnectionsVector()) {
+                    count += connection->negotiating() ? 0 : 1;
+                }
+                return count;
+            };
+            for (int i = 0; i < 100 && (srv->getConnections().size() < 3 || negotiated() < 2); i++) {
+                std::this_thread::sleep_for(50ms);
+            }
+            ASSERT_EQ(3, srv->getConnections().size());
+            ASSERT_EQ(2, negotiated());
+
+            srv->sendAll(message);
+
+            // the late one gets the broadcast in the framing its hello settles on
+            const auto hello = encode_hello(tcp_framing::Binary);
+            boost::asio::write(late, boost::asio::buffer(*hello));
+            unsigned char reply[HELLO_SIZE];
+            boost::asio::read(late, boost::asio::buffer(reply));
+            tcp_framing granted = tcp_framing::Base64Line;
+            ASSERT_TRUE(read_hello(reply, granted));
+            ASSERT_EQ(tcp_framing::Binary, granted);
+
+            unsigned char header[BINARY_HEADER_SIZE];
+            boost::asio::read(late, boost::asio::buffer(header));
+            const binary_header decoded = read_binary_header(header);
+            ASSERT_EQ(message.size(), decoded.length);
+            std::string payload(decoded.length, '\0');
+            boost::asio::read(late, boost::asio::buffer(&payload[0], payload.size()));
+            ASSERT_EQ(message, payload);
+
+            // nothing more comes, each client got it once
+            std::this_thread::sleep_for(500ms);
+            late.non_blocking(true);
+            boost::system::error_code error;
+            char extra[16];
+            late.read_some(boost::asio::buffer(extra), error);
+            ASSERT_EQ(boost::asio::error::would_block, error);
+            {
+                std::lock_guard<std::mutex> guard(sync);
+                for (const auto &messages : received) {
+                    ASSERT_EQ(std::vector<std::string>{ message }, messages);
+                }
+            }
+
+            for (const auto &client : clients) {
+                client->stop();
+            }
+            srv->stop();
+        }
+
+        TEST(Test_TCP_Server_Client, drops___bad_hello) {
+            tcp::endpoint endpoint = getLocalEndpoint();
+            auto srv = tcp_server::create(endpoint);
+            srv->start();
+
+            // the hello prefix, so not taken for a base64 line, but a version this server does not speak
+            boost::asio::io_service ios;
+            tcp::socket socket(ios);
+            socket.connect(getLocalEndpoint(srv->getPort()));
+            const unsigned char hello[HELLO_SIZE] = { HELLO_MAGIC[0], HELLO_MAGIC[1], HELLO_MAGIC[2], HELLO_MAGIC[3], HELLO_VERSION + 1, 1, 0, 0 };
+            boost::asio::write(socket, boost::asio::buffer(hello));
+
+            ASSERT_TRUE(wait_closed_by_server(socket));
+            ASSERT_TRUE(wait_no_connections(srv));
+
+            srv->stop();
+        }
+
+        TEST(Test_TCP_Server_Client, drops___oversized_binary_frame) {
+            tcp::endpoint endpoint = getLocalEndpoint();
+            auto srv = tcp_server::create(endpoint);
+            srv->setFraming(tcp_framing::Binary);
+            size_t read_errors = 0;
+            srv->onReadError.connect([&read_errors](tcp_connection::pointer connection, const boost::system::error_code error, size_t bytes_transferred) {
+                read_errors++;
+            });
+            srv->start();
+
+            boost::asio::io_service ios;
+            tcp::socket socket(ios);
+            socket.connect(getLocalEndpoint(srv->getPort()));
+
+            const auto hello = encode_hello(tcp_framing::Binary);
+            boost::asio::write(socket, boost::asio::buffer(*hello));
+            unsigned char reply[HELLO_SIZE];
+            boost::asio::read(socket, boost::asio::buffer(reply));
+            tcp_framing granted = tcp_framing::Base64Line;
+            ASSERT_TRUE(read_hello(reply, granted));
+            ASSERT_EQ(tcp_framing::Binary, granted);
+
+            unsigned char header[BINARY_HEADER_SIZE];
+            write_binary_header(header, { BINARY_MAX_PAYLOAD + 1, 0, 1 });
+            boost::asio::write(socket, boost::asio::buffer(header));
+
+            ASSERT_TRUE(wait_closed_by_server(socket));
+            ASSERT_TRUE(wait_no_connections(srv));
+            ASSERT_EQ(1, read_errors);
+
+            srv->stop();
+        }
     }// namespace Test_TCP_Server_Client
 }// namespace Diginext::Core::TCP::GTest
 
@@ -1,6 +1,25 @@
 #include <gtest/gtest.h>
 
 #include "Base64/Base64_Test.h"
+#include "Checksum/Crc32_Test.h"
+#include "Storage/HashRing_Test.h"
+#include "Storage/HotKeyTracker_Test.h"
+#include "Storage/KeyExpiry_Test.h"
+#include "Storage/LsmStorage_Test.h"
+#include "Storage/RaftLog_Test.h"
+#include "Storage/RaftNode_Test.h"
+#include "Storage/ReplicationLog_Test.h"
+#include "Storage/RequestCodec_Test.h"
+#include "Storage/RespCodec_Test.h"
+#include "Storage/ShardedHashStorage_Test.h"
+#include "Storage/SnapshotFile_Test.h"
+#include "Storage/StorageClient_Test.h"
+#include "Storage/StorageEngine_Test.h"
+#include "Storage/StorageReplica_Test.h"
+#include "Storage/StorageScan_Test.h"
+#include "Storage/StorageServer_Test.h"
+#include "Storage/WatchRegistry_Test.h"
+#include "Storage/WriteAheadLog_Test.h"
 #include "TCP/TCP_Test.h"
 
 int main(int argc, char** argv)
@@ -1,19 +1,166 @@
+#include <Storage/StorageEngineFactory.h>
+#include <Storage/StorageMemory.h>
 #include <Storage/StorageServer.h>
 #include <TCP/TCP.h>
 
 #include <chrono>
+#include <iostream>
+#include <sstream>
+#include <string>
 
 using namespace Diginext::Core::Storage;
 using namespace std::chrono_literals;
 
+void printUsage() {
+    std::cout << "usage: diginext.server [options]" << std::endl
+              << "  --host <addr>            listen address (default " << Diginext::Core::TCP::LOCAL_ADDRESS_TCP_V6 << ")" << std::endl
+              << "  --port <port>            listen port (default " << Diginext::Core::TCP::DEFAULT_PORT << ")" << std::endl
+              << "  --engine <name>          map | hash | lsm (default hash)" << std::endl
+              << "  --data-dir <path>        lsm engine directory (default diginext-data)" << std::endl
+              << "  --wal <path>             write-ahead log file (default: in-memory only)" << std::endl
+              << "  --fsync <policy>         always | group | async (default group)" << std::endl
+              << "  --group-commit-us <us>   group commit window in microseconds (default 2000)" << std::endl
+              << "  --snapshot <path>        memory-mapped snapshot file, mapped on start" << std::endl
+              << "  --maxmemory <size>       hash engine memory limit, e.g. 512mb (default: no limit)" << std::endl
+              << "  --replica-of <host:port> follow a leader, serve reads only" << std::endl
+              << "  --repl-backlog <size>    leader backlog a reconnecting replica resumes from (default 64mb)" << std::endl
+              << "  --raft-peers <list>      run as a raft cluster member, comma separated host:port of the other members" << std::endl
+              << "  --raft-id <host:port>    address the peers reach this node at (default --host:--port)" << std::endl
+              << "  --raft-log <path>        raft log file (default: in-memory only)" << std::endl
+              << "  --raft-batch <n>         log entries per raft log write and per message (default 256)" << std::endl
+              << "  --raft-election-ms <ms>  election timeout in milliseconds (default 300)" << std::endl
+              << "  --watch-queue <size>     bytes queued to a watching connection before its events overflow (default 1mb)" << std::endl
+              << "  --watch-overflow <mode>  drop | disconnect, what happens to a watcher over its queue limit (default drop)" << std::endl
+              << "  --hot-keys <n>           keys in the hot key list of stats, 0 - no tracking (default 32)" << std::endl
+              << "  --hot-sample <n>         one read or write in n on average is sampled for hot keys (default 16)" << std::endl
+              << "  --framing <mode>         base64 | binary | compressed, asked for on connections to the leader and raft peers (default base64)" << std::endl
+              << "  --accept-framing <mode>  base64 | binary | compressed, best a client hello is granted (default compressed, binary without zlib)" << std::endl
+              << "  --resp-port <port>       also serve the Redis protocol (RESP2) on this port (default: off)" << std::endl;
+}
+
+bool splitHostPort(const std::string &address, std::string &host, unsigned short &port) {
+    const size_t colon = address.rfind(':');
+    if (colon == std::string::npos || colon == 0 || colon + 1 == address.size()) {
+        return false;
+    }
+
+    host = address.substr(0, colon);
+    port = static_cast<unsigned short>(std::stoi(address.substr(colon + 1)));
+    return true;
+}
+
 int main(int argc, char** argv) {
     Diginext::Core::TCP::tcp_all_log_disable();
 
-    StorageServer::pointer server = StorageServer::create();
+    std::string host = Diginext::Core::TCP::LOCAL_ADDRESS_TCP_V6;
+    unsigned short port = Diginext::Core::TCP::DEFAULT_PORT;
+    StorageOptions options;
+    bool raft = false;
+
+    for (int i = 1; i < argc; i++) {
+        const std::string arg = argv[i];
+        const bool hasValue = i + 1 < argc;
+
+        if (arg == "--host" && hasValue) {
+            host = argv[++i];
+        } else if (arg == "--port" && hasValue) {
+            port = static_cast<unsigned short>(std::stoi(argv[++i]));
+        } else if (arg == "--engine" && hasValue) {
+            options.engine = argv[++i];
+            if (!storage_engine_exists(options.engine)) {
+                printUsage();
+                return 1;
+            }
+        } else if (arg == "--data-dir" && hasValue) {
+            options.dataDir = argv[++i];
+        } else if (arg == "--wal" && hasValue) {
+            options.walPath = argv[++i];
+        } else if (arg == "--fsync" && hasValue) {
+            if (!fsync_policy_from_string(argv[++i], options.fsyncPolicy)) {
+                printUsage();
+                return 1;
+            }
+        } else if (arg == "--snapshot" && hasValue) {
+            options.snapshotPath = argv[++i];
+        } else if (arg == "--maxmemory" && hasValue) {
+            if (!memory_size_from_string(argv[++i], options.maxMemory)) {
+                printUsage();
+                return 1;
+            }
+        } else if (arg == "--replica-of" && hasValue) {
+            if (!splitHostPort(argv[++i], options.replicaOfHost, options.replicaOfPort)) {
+                printUsage();
+                return 1;
+            }
+        } else if (arg == "--raft-peers" && hasValue) {
+            std::stringstream peers(argv[++i]);
+            std::string peer;
+            while (std::getline(peers, peer, ',')) {
+                std::string peerHost;
+                unsigned short peerPort = 0;
+                if (!splitHostPort(peer, peerHost, peerPort)) {
+                    printUsage();
+                    return 1;
+                }
+                options.raftPeers.push_back(peer);
+            }
+            raft = true;
+        } else if (arg == "--raft-id" && hasValue) {
+            options.raftId = argv[++i];
+        } else if (arg == "--raft-log" && hasValue) {
+            options.raftLogPath = argv[++i];
+        } else if (arg == "--raft-batch" && hasValue) {
+            options.raftBatch = static_cast<size_t>(std::stoul(argv[++i]));
+        } else if (arg == "--raft-election-ms" && hasValue) {
+            options.raftElectionTimeout = std::chrono::milliseconds(std::stol(argv[++i]));
+        } else if (arg == "--repl-backlog" && hasValue) {
+            if (!memory_size_from_string(argv[++i], options.replicationBacklog)) {
+                printUsage();
+                return 1;
+            }
+        } else if (arg == "--watch-queue" && hasValue) {
+            if (!memory_size_from_string(argv[++i], options.watchQueueLimit)) {
+                printUsage();
+                return 1;
+            }
+        } else if (arg == "--watch-overflow" && hasValue) {
+            if (!watch_overflow_policy_from_string(argv[++i], options.watchOverflow)) {
+                printUsage();
+                return 1;
+            }
+        } else if (arg == "--framing" && hasValue) {
+            if (!tcp_framing_from_string(argv[++i], options.framing)) {
+                printUsage();
+                return 1;
+            }
+        } else if (arg == "--accept-framing" && hasValue) {
+            if (!tcp_framing_from_string(argv[++i], options.acceptFraming)) {
+                printUsage();
+                return 1;
+            }
+        } else if (arg == "--resp-port" && hasValue) {
+            options.respPort = static_cast<unsigned short>(std::stoi(argv[++i]));
+        } else if (arg == "--hot-keys" && hasValue) {
+            options.hotKeys = static_cast<size_t>(std::stoul(argv[++i]));
+        } else if (arg == "--hot-sample" && hasValue) {
+            options.hotKeySample = static_cast<size_t>(std::stoul(argv[++i]));
+        } else if (arg == "--group-commit-us" && hasValue) {
+            options.groupCommitWindow = std::chrono::microseconds(std::stol(argv[++i]));
+        } else {
+            printUsage();
+            return 1;
+        }
+    }
+
+    if (raft && options.raftId.empty()) {
+        options.raftId = host + ":" + std::to_string(port);
+    }
+
+    StorageServer::pointer server = StorageServer::create(host, port, options);
     server->Start();
 
     while (server->Started())
     {
         std::this_thread::sleep_for(1s);
     }
-}
\ No newline at end of file
+}
@@ -0,0 +1,95 @@
+#ifndef DIGINEXT_BENCHMARK___BENCHMARK_H
+#define DIGINEXT_BENCHMARK___BENCHMARK_H
+
+#include <chrono>
+#include <cstdio>
+#include <functional>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifdef __linux__
+#include <malloc.h>
+#include <unistd.h>
+#endif
+
+namespace Diginext::Core::Benchmark {
+    using namespace std;
+
+    typedef std::chrono::steady_clock bench_clock;
+
+    /**
+     * \brief seconds since start
+     */
+    inline double elapsed_seconds(const bench_clock::time_point &start) {
+        return std::chrono::duration<double>(bench_clock::now() - start).count();
+    }
+
+    /**
+     * \brief run worker(threadIndex) on threadCount threads and return wall time in seconds
+     */
+    inline double run_threads(size_t threadCount, const std::function<void(size_t)> &worker) {
+        std::vector<std::thread> threads;
+        threads.reserve(threadCount);
+
+        const auto start = bench_clock::now();
+        for (size_t i = 0; i < threadCount; i++) {
+            threads.emplace_back(worker, i);
+        }
+
+        for (auto &thread : threads) {
+            thread.join();
+        }
+
+        return elapsed_seconds(start);
+    }
+
+    /**
+     * \brief xorshift pseudo random, cheap enough to not dominate a benchmark loop
+     */
+    inline uint64_t next_random(uint64_t &state) {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        return state;
+    }
+
+    inline std::vector<string> make_keys(size_t count, const string &prefix = "key") {
+        std::vector<string> keys;
+        keys.reserve(count);
+        for (size_t i = 0; i < count; i++) {
+            keys.push_back(prefix + ":" + std::to_string(i));
+        }
+
+        return keys;
+    }
+
+    /**
+     * \brief resident set size of the process, 0 where it is not available
+     */
+    inline size_t resident_bytes() {
+#ifdef __linux__
+        // freed heap pages are given back first, so consecutive measurements do not see each other
+        malloc_trim(0);
+
+        FILE *file = std::fopen("/proc/self/statm", "r");
+        if (file == nullptr) {
+            return 0;
+        }
+
+        unsigned long size = 0;
+        unsigned long resident = 0;
+        const int read = std::fscanf(file, "%lu %lu", &size, &resident);
+        std::fclose(file);
+        return read == 2 ? static_cast<size_t>(resident) * static_cast<size_t>(sysconf(_SC_PAGESIZE)) : 0;
+#else
+        return 0;
+#endif
+    }
+
+    inline void print_header(const string &title) {
+        std::printf("\n=== %s ===\n", title.c_str());
+    }
+}// namespace Diginext::Core::Benchmark
+
+#endif
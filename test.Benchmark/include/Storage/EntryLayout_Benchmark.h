@@ -0,0 +1,83 @@
+#ifndef DIGINEXT_BENCHMARK___STORAGE_ENTRY_LAYOUT_BENCHMARK_H
+#define DIGINEXT_BENCHMARK___STORAGE_ENTRY_LAYOUT_BENCHMARK_H
+
+#include "Benchmark.h"
+
+#include <Storage/ShardedHashStorage.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace Diginext::Core::Storage::Benchmark {
+    using namespace Diginext::Core::Benchmark;
+
+    /**
+     * \brief memory and point lookups of ShardedHashStorage for typical sizes: keys under
+     * 32 bytes, values from a few bytes up to over the inline limit; key count via
+     * DIGINEXT_BENCH_LAYOUT_KEYS
+     */
+    inline void benchmark_entry_layout() {
+        const char *env = std::getenv("DIGINEXT_BENCH_LAYOUT_KEYS");
+        const size_t keyCount = env != nullptr ? std::stoull(env) : 1000000;
+        const size_t LOOKUPS = 4000000;
+        const size_t THREADS = 4;
+
+        print_header("entry layout, " + std::to_string(keyCount) + " keys of ~20 B");
+        std::printf("%-8s %14s %14s %14s %14s %14s\n", "value", "RSS MB/1M", "counted MB/1M", "get/s", "getShared/s", "get x4 /s");
+
+        std::vector<string> keys;
+        keys.reserve(keyCount);
+        for (size_t i = 0; i < keyCount; i++) {
+            char key[32];
+            std::snprintf(key, sizeof(key), "session:%010zu", i * 2654435761u % 10000000000u);
+            keys.emplace_back(key);
+        }
+
+        for (const size_t valueSize : { 16, 100, 200, 1000 }) {
+            const string value(valueSize, 'v');
+            const size_t before = resident_bytes();
+
+            auto storage = std::make_unique<ShardedHashStorage>();
+            for (const auto &key : keys) {
+                storage->put(key, value);
+            }
+
+            const double rss = static_cast<double>(resident_bytes() - before) * 1000000.0 / keyCount / (1024 * 1024);
+            const double counted = static_cast<double>(storage->memoryUsage()) * 1000000.0 / keyCount / (1024 * 1024);
+
+            uint64_t state = 88172645463325252ull;
+            string out;
+            auto start = bench_clock::now();
+            for (size_t i = 0; i < LOOKUPS; i++) {
+                storage->get(keys[next_random(state) % keyCount], out);
+            }
+            const double getRate = LOOKUPS / elapsed_seconds(start);
+
+            size_t found = 0;
+            start = bench_clock::now();
+            for (size_t i = 0; i < LOOKUPS; i++) {
+                found += storage->getShared(keys[next_random(state) % keyCount]) != nullptr ? 1 : 0;
+            }
+            const double sharedRate = LOOKUPS / elapsed_seconds(start);
+
+            const double seconds = run_threads(THREADS, [&](size_t thread) {
+                uint64_t local = 0x9E3779B97F4A7C15ull + thread;
+                string threadOut;
+                for (size_t i = 0; i < LOOKUPS / THREADS; i++) {
+                    storage->get(keys[next_random(local) % keyCount], threadOut);
+                }
+            });
+            const double parallelRate = LOOKUPS / seconds;
+
+            std::printf("%-8zu %14.1f %14.1f %14.0f %14.0f %14.0f\n", valueSize, rss, counted, getRate, sharedRate, parallelRate);
+            if (found != LOOKUPS) {
+                std::printf("  missing keys: %zu\n", LOOKUPS - found);
+            }
+        }
+    }
+}// namespace Diginext::Core::Storage::Benchmark
+
+#endif
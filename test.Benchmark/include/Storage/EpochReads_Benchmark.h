@@ -0,0 +1,72 @@
+#ifndef DIGINEXT_BENCHMARK___STORAGE_EPOCH_READS_BENCHMARK_H
+#define DIGINEXT_BENCHMARK___STORAGE_EPOCH_READS_BENCHMARK_H
+
+#include "Benchmark.h"
+
+#include <Storage/ShardedHashStorage.h>
+
+#include <algorithm>
+#include <atomic>
+#include <string>
+#include <vector>
+
+namespace Diginext::Core::Storage::Benchmark {
+    using namespace Diginext::Core::Benchmark;
+
+    /**
+     * \brief read latency percentiles (ns) while writerCount threads overwrite the same keys
+     */
+    inline void epoch_reads_latency(size_t writerCount) {
+        const auto keys = make_keys(10000);
+        const string value(256, 'v');
+
+        ShardedHashStorage storage;
+        for (const auto &key : keys) {
+            storage.put(key, value);
+        }
+
+        std::atomic<bool> stop(false);
+        std::vector<std::thread> writers;
+        for (size_t t = 0; t < writerCount; t++) {
+            writers.emplace_back([&, t]() {
+                uint64_t random = 0x2545F4914F6CDD1DULL * (t + 1);
+                while (!stop.load(std::memory_order_relaxed)) {
+                    storage.put(keys[next_random(random) % keys.size()], value);
+                }
+            });
+        }
+
+        const size_t SAMPLES = 200000;
+        std::vector<double> latencies;
+        latencies.reserve(SAMPLES);
+
+        uint64_t random = 42;
+        string out;
+        for (size_t i = 0; i < SAMPLES; i++) {
+            const string &key = keys[next_random(random) % keys.size()];
+            const auto start = bench_clock::now();
+            storage.get(key, out);
+            latencies.push_back(std::chrono::duration<double, std::nano>(bench_clock::now() - start).count());
+        }
+
+        stop = true;
+        for (auto &writer : writers) {
+            writer.join();
+        }
+
+        std::sort(latencies.begin(), latencies.end());
+        std::printf("%8zu %12.0f %12.0f %12.0f\n", writerCount,
+                    latencies[SAMPLES / 2], latencies[SAMPLES * 99 / 100], latencies[SAMPLES * 999 / 1000]);
+    }
+
+    inline void benchmark_epoch_reads() {
+        print_header("ShardedHashStorage lock-free read latency (ns) under write bursts");
+
+        std::printf("%8s %12s %12s %12s\n", "writers", "p50", "p99", "p99.9");
+        for (size_t writers : {0, 1, 4, 16}) {
+            epoch_reads_latency(writers);
+        }
+    }
+}// namespace Diginext::Core::Storage::Benchmark
+
+#endif
@@ -0,0 +1,152 @@
+#ifndef DIGINEXT_BENCHMARK___STORAGE_HOT_KEYS_BENCHMARK_H
+#define DIGINEXT_BENCHMARK___STORAGE_HOT_KEYS_BENCHMARK_H
+
+#include "Benchmark.h"
+
+#include <Base64/Base64.h>
+#include <Storage/HotKeyTracker.h>
+#include <Storage/ShardedHashStorage.h>
+#include <Storage/StorageCommon.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+#include <nlohmann/json.hpp>
+
+namespace Diginext::Core::Storage::Benchmark {
+    using namespace Diginext::Core::Benchmark;
+
+    const size_t HOT_KEYS_KEYS = 100000;
+    const size_t HOT_KEYS_ACCESSES = 2000000;
+
+    /**
+     * \brief key indexes drawn from a zipf distribution over keyCount keys
+     */
+    inline std::vector<uint32_t> zipf_indexes(size_t keyCount, size_t count, double exponent) {
+        std::vector<double> cumulative(keyCount);
+        double sum = 0;
+        for (size_t i = 0; i < keyCount; i++) {
+            sum += 1.0 / std::pow(static_cast<double>(i + 1), exponent);
+            cumulative[i] = sum;
+        }
+
+        std::vector<uint32_t> indexes;
+        indexes.reserve(count);
+        uint64_t random = 0x2545F4914F6CDD1DULL;
+        for (size_t i = 0; i < count; i++) {
+            const double point = static_cast<double>(next_random(random) % 1000000007ULL) / 1000000007.0 * sum;
+            indexes.push_back(static_cast<uint32_t>(std::lower_bound(cumulative.begin(), cumulative.end(), point) - cumulative.begin()));
+        }
+        return indexes;
+    }
+
+    /**
+     * \brief ns per access of work, with tracking off (one branch) and at each sample rate
+     * @param[in] work one access of key i, returns something so it is not optimized away
+     */
+    inline void hot_keys_overhead(const string &name, const std::vector<string> &keys, const std::vector<uint32_t> &indexes,
+                                  const std::function<size_t(const string &)> &work) {
+        const std::vector<size_t> sampleRates = { 0, 1, 16, 64 };///< 0 - untracked
+        std::vector<double> best(sampleRates.size(), 0);
+        size_t sink = 0;
+
+        // best of three, the configurations take turns so drift hits all of them alike
+        for (size_t attempt = 0; attempt < 3; attempt++) {
+            for (size_t config = 0; config < sampleRates.size(); config++) {
+                const size_t sampleRate = sampleRates[config];
+                HotKeyTracker tracker(sampleRate == 0 ? 0 : HotKeyTracker::DEFAULT_CAPACITY, sampleRate);
+                const auto start = bench_clock::now();
+                for (size_t i = 0; i < indexes.size(); i++) {
+                    const string &key = keys[indexes[i]];
+                    tracker.record(key, i % 8 == 0);
+                    sink += work(key);
+                }
+
+                const double ns = elapsed_seconds(start) * 1e9 / static_cast<double>(indexes.size());
+                best[config] = attempt == 0 ? ns : std::min(best[config], ns);
+            }
+        }
+
+        std::printf("%-22s %10.1f", name.c_str(), best[0]);
+        for (size_t config = 1; config < sampleRates.size(); config++) {
+            std::printf(" %10.1f (%+5.1f%%)", best[config], (best[config] - best[0]) * 100 / best[0]);
+        }
+        std::printf("%s\n", sink == 0 ? " " : "");
+    }
+
+    /**
+     * \brief how many of the real top keys the tracker lists, at each sample rate
+     */
+    inline void hot_keys_accuracy(const std::vector<string> &keys, const std::vector<uint32_t> &indexes, size_t top) {
+        std::map<uint32_t, size_t> exact;
+        for (const auto index : indexes) {
+            exact[index]++;
+        }
+        std::vector<std::pair<size_t, uint32_t>> ranked;
+        for (const auto &count : exact) {
+            ranked.emplace_back(count.second, count.first);
+        }
+        std::sort(ranked.rbegin(), ranked.rend());
+
+        std::set<string> truth;
+        for (size_t i = 0; i < top && i < ranked.size(); i++) {
+            truth.insert(keys[ranked[i].second]);
+        }
+
+        std::printf("top %zu found:", top);
+        for (const size_t sampleRate : { 1, 16, 64 }) {
+            HotKeyTracker tracker(HotKeyTracker::DEFAULT_CAPACITY, sampleRate);
+            for (const auto index : indexes) {
+                tracker.record(keys[index], false);
+            }
+
+            size_t found = 0;
+            for (const auto &hotKey : tracker.hottest(top)) {
+                found += truth.count(hotKey.key);
+            }
+            std::printf("  sample 1/%zu: %zu/%zu", sampleRate, found, truth.size());
+        }
+        std::printf("\n");
+    }
+
+    inline void benchmark_hot_keys() {
+        print_header("HotKeyTracker overhead (ns per access, zipf 0.99 over 100k keys) and accuracy");
+
+        const auto keys = make_keys(HOT_KEYS_KEYS);
+        const auto indexes = zipf_indexes(HOT_KEYS_KEYS, HOT_KEYS_ACCESSES, 0.99);
+        const string value(100, 'v');
+
+        ShardedHashStorage storage;
+        for (const auto &key : keys) {
+            storage.put(key, value);
+        }
+
+        std::printf("%-22s %10s %19s %19s %19s\n", "work", "untracked", "sample 1/1", "sample 1/16", "sample 1/64");
+
+        // the bare engine read is the worst case, nothing else to hide the tracker behind
+        string out;
+        hot_keys_overhead("engine get", keys, indexes, [&](const string &key) {
+            storage.get(key, out);
+            return out.size();
+        });
+
+        // what the server does around the read for every request
+        hot_keys_overhead("decode+get+encode", keys, indexes, [&](const string &key) {
+            const auto request = nlohmann::json::parse(R"({"request":"read","key":")" + key + R"("})");
+            storage.get(request[JSON::KEY::KEY].get<string>(), out);
+            nlohmann::json answer;
+            answer[JSON::KEY::STATUS] = JSON::VALUE::STATUS_OK;
+            answer[JSON::KEY::VALUE] = out;
+            return Base64::Encode(answer.dump()).size();
+        });
+
+        hot_keys_accuracy(keys, indexes, 10);
+    }
+}// namespace Diginext::Core::Storage::Benchmark
+
+#endif
@@ -0,0 +1,104 @@
+#ifndef DIGINEXT_BENCHMARK___STORAGE_LSM_STORAGE_BENCHMARK_H
+#define DIGINEXT_BENCHMARK___STORAGE_LSM_STORAGE_BENCHMARK_H
+
+#include "Benchmark.h"
+
+#include <Storage/LsmStorage.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+namespace Diginext::Core::Storage::Benchmark {
+    using namespace Diginext::Core::Benchmark;
+
+    /**
+     * \brief key count from DIGINEXT_BENCH_LSM_KEYS
+     */
+    inline size_t lsm_key_count() {
+        const char *env = std::getenv("DIGINEXT_BENCH_LSM_KEYS");
+        return env != nullptr ? static_cast<size_t>(std::stoull(env)) : 500000;
+    }
+
+    inline void benchmark_lsm_storage() {
+        print_header("LsmStorage reads, writes and space amplification (100 B values, async log)");
+
+        const string directory = "diginext_benchmark_lsm";
+        std::filesystem::remove_all(directory);
+
+        const size_t keyCount = lsm_key_count();
+        const auto keys = make_keys(keyCount);
+        const string value(100, 'v');
+        const uint64_t liveBytes = [&keys, &value]() {
+            uint64_t bytes = 0;
+            for (const auto &key : keys) {
+                bytes += key.size() + value.size();
+            }
+            return bytes;
+        }();
+
+        LsmOptions options;
+        options.fsyncPolicy = FsyncPolicy::Async;
+        auto storage = LsmStorage::create(directory, options);
+
+        std::printf("%-28s %14s %16s\n", "phase", "ops/s", "block reads/op");
+
+        auto start = bench_clock::now();
+        for (const auto &key : keys) {
+            storage->put(key, value);
+        }
+        std::printf("%-28s %14.0f %16s\n", "write (load)", double(keyCount) / elapsed_seconds(start), "-");
+
+        start = bench_clock::now();
+        for (int round = 0; round < 2; round++) {
+            uint64_t state = 88172645463325252ULL + round;
+            for (size_t i = 0; i < keyCount; i++) {
+                storage->put(keys[next_random(state) % keyCount], value);
+            }
+        }
+        std::printf("%-28s %14.0f %16s\n", "write (random overwrite)", double(2 * keyCount) / elapsed_seconds(start), "-");
+
+        storage->flush();
+        storage->waitIdle();
+
+        const size_t readCount = std::min<size_t>(keyCount, 200000);
+        string read;
+
+        uint64_t reads = storage->getStats().blockReads;
+        uint64_t state = 0x9E3779B97F4A7C15ULL;
+        start = bench_clock::now();
+        for (size_t i = 0; i < readCount; i++) {
+            storage->get(keys[next_random(state) % keyCount], read);
+        }
+        double seconds = elapsed_seconds(start);
+        std::printf("%-28s %14.0f %16.3f\n", "read (hit, random)", double(readCount) / seconds,
+                    double(storage->getStats().blockReads - reads) / double(readCount));
+
+        reads = storage->getStats().blockReads;
+        start = bench_clock::now();
+        for (size_t i = 0; i < readCount; i++) {
+            storage->get("missing:" + std::to_string(i), read);
+        }
+        seconds = elapsed_seconds(start);
+        std::printf("%-28s %14.0f %16.3f\n", "read (miss)", double(readCount) / seconds,
+                    double(storage->getStats().blockReads - reads) / double(readCount));
+
+        const LsmStats stats = storage->getStats();
+        std::printf("\nlive data %.1f MB, on disk %.1f MB, space amplification %.2f, %llu tables, %llu flushes, %llu compactions\n",
+                    double(liveBytes) / 1048576.0, double(stats.diskBytes) / 1048576.0, double(stats.diskBytes) / double(liveBytes),
+                    static_cast<unsigned long long>(stats.tableCount), static_cast<unsigned long long>(stats.flushes),
+                    static_cast<unsigned long long>(stats.compactions));
+        for (size_t level = 0; level < stats.levelBytes.size(); level++) {
+            if (stats.levelBytes[level] > 0) {
+                std::printf("  level %zu: %.1f MB\n", level, double(stats.levelBytes[level]) / 1048576.0);
+            }
+        }
+
+        storage.reset();
+        std::filesystem::remove_all(directory);
+    }
+}// namespace Diginext::Core::Storage::Benchmark
+
+#endif
@@ -0,0 +1,110 @@
+#ifndef DIGINEXT_BENCHMARK___STORAGE_PIPELINE_BENCHMARK_H
+#define DIGINEXT_BENCHMARK___STORAGE_PIPELINE_BENCHMARK_H
+
+#include "Benchmark.h"
+#include "Storage/Replication_Benchmark.h"
+
+#include <Storage/StorageClient.h>
+#include <Storage/StorageCommon.h>
+#include <Storage/StorageServer.h>
+#include <TCP/TCP.h>
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include <nlohmann/json.hpp>
+
+namespace Diginext::Core::Storage::Benchmark {
+    using namespace Diginext::Core::Benchmark;
+
+    const unsigned short PIPELINE_PORT = 47910;
+    const unsigned short PIPELINE_WAL_PORT = 47911;
+
+    /**
+     * \brief requests per second over one connection, depth requests in flight (1 - request())
+     */
+    inline double pipeline_rate(StorageClient &client, size_t depth, bool writes) {
+        const string value(100, 'v');
+        std::vector<nlohmann::json> batch(depth);
+        uint64_t random = 0x9E3779B97F4A7C15ULL;
+        uint64_t done = 0;
+
+        const auto start = bench_clock::now();
+        while (elapsed_seconds(start) < 2) {
+            for (auto &request : batch) {
+                const string key = "key:" + std::to_string(next_random(random) % 10000);
+                request = writes ? nlohmann::json{ { JSON::KEY::REQUEST, JSON::VALUE::REQUEST_WRITE }, { JSON::KEY::KEY, key }, { JSON::KEY::VALUE, value } }
+                                 : nlohmann::json{ { JSON::KEY::REQUEST, JSON::VALUE::REQUEST_READ }, { JSON::KEY::KEY, key } };
+            }
+
+            if (depth == 1) {
+                client.request(batch.front());
+            } else {
+                client.pipeline(batch);
+            }
+            done += depth;
+        }
+        return done / elapsed_seconds(start);
+    }
+
+    inline void pipeline_table(const string &name, unsigned short port, bool writes) {
+        StorageClient client(std::vector<string>{ "127.0.0.1:" + std::to_string(port) });
+        client.setFraming(tcp_framing::Binary);
+        client.Connect();
+
+        // every key exists, reads hit
+        std::vector<nlohmann::json> preload;
+        for (size_t i = 0; i < 10000; i++) {
+            preload.push_back({ { JSON::KEY::REQUEST, JSON::VALUE::REQUEST_WRITE }, { JSON::KEY::KEY, "key:" + std::to_string(i) }, { JSON::KEY::VALUE, "v" } });
+        }
+        client.pipeline(preload);
+
+        std::printf("%-24s", name.c_str());
+        double single = 0;
+        for (size_t depth : { 1, 16, 64, 256 }) {
+            const double rate = pipeline_rate(client, depth, writes);
+            single = depth == 1 ? rate : single;
+            std::printf(" %12.0f", rate);
+        }
+        std::printf("   x%.1f at 256\n", pipeline_rate(client, 256, writes) / single);
+        client.Disconnect();
+    }
+
+    inline void benchmark_pipeline() {
+        print_header("requests / s over one binary connection by requests in flight, local server process");
+#ifdef __linux__
+        StorageOptions options;
+        StorageOptions walOptions;
+        walOptions.walPath = "pipeline_benchmark.wal";
+        std::remove(walOptions.walPath.c_str());
+
+        const pid_t pid = spawn_server(PIPELINE_PORT, options);
+        const pid_t walPid = spawn_server(PIPELINE_WAL_PORT, walOptions);
+        Diginext::Core::TCP::tcp_all_log_disable();
+
+        try {
+            // the servers may still be starting
+            bench_connection server(PIPELINE_PORT);
+            bench_connection walServer(PIPELINE_WAL_PORT);
+
+            std::printf("%-24s %12s %12s %12s %12s\n", "in flight", "1", "16", "64", "256");
+            pipeline_table("read", PIPELINE_PORT, false);
+            pipeline_table("write", PIPELINE_PORT, true);
+            pipeline_table("write, wal group commit", PIPELINE_WAL_PORT, true);
+        } catch (const std::exception &error) {
+            std::printf("pipeline benchmark failed: %s\n", error.what());
+        }
+
+        kill(pid, SIGKILL);
+        kill(walPid, SIGKILL);
+        waitpid(pid, nullptr, 0);
+        waitpid(walPid, nullptr, 0);
+        std::remove(walOptions.walPath.c_str());
+#else
+        std::printf("needs fork, linux only\n");
+#endif
+    }
+}// namespace Diginext::Core::Storage::Benchmark
+
+#endif
@@ -0,0 +1,304 @@
+#ifndef DIGINEXT_BENCHMARK___STORAGE_RAFT_BENCHMARK_H
+#define DIGINEXT_BENCHMARK___STORAGE_RAFT_BENCHMARK_H
+
+#include "Benchmark.h"
+#include "Storage/Replication_Benchmark.h"
+
+#include <Storage/StorageCommon.h>
+#include <Storage/StorageFile.h>
+#include <Storage/StorageOptions.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <nlohmann/json.hpp>
+
+#ifdef __linux__
+#include <signal.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+namespace Diginext::Core::Storage::Benchmark {
+    using namespace Diginext::Core::Benchmark;
+
+    const unsigned short RAFT_FIRST_PORT = 47910;
+    const size_t RAFT_NODES = 3;
+
+#ifdef __linux__
+    /**
+     * \brief three local server processes in raft mode, logs in the working directory
+     */
+    class bench_raft_cluster {
+    private:
+        size_t batch;
+        std::vector<pid_t> pids;
+
+    public:
+        explicit bench_raft_cluster(size_t batch) : batch(batch), pids(RAFT_NODES, 0) {
+            for (size_t node = 0; node < RAFT_NODES; node++) {
+                file_remove(logPath(node));
+            }
+        }
+
+        ~bench_raft_cluster() {
+            for (size_t node = 0; node < RAFT_NODES; node++) {
+                this->kill(node);
+                file_remove(logPath(node));
+            }
+        }
+
+        static unsigned short port(size_t node) {
+            return static_cast<unsigned short>(RAFT_FIRST_PORT + node);
+        }
+
+        static string id(size_t node) {
+            return "127.0.0.1:" + std::to_string(port(node));
+        }
+
+        static string logPath(size_t node) {
+            return "diginext_benchmark.raft." + std::to_string(node);
+        }
+
+        /**
+         * @brief node of a member id, RAFT_NODES - not a member
+         */
+        static size_t node(const string &id) {
+            for (size_t node = 0; node < RAFT_NODES; node++) {
+                if (bench_raft_cluster::id(node) == id) {
+                    return node;
+                }
+            }
+            return RAFT_NODES;
+        }
+
+        /**
+         * \brief start a node, a restarted node reads its log back
+         */
+        void start(size_t node) {
+            StorageOptions options;
+            options.raftId = id(node);
+            for (size_t peer = 0; peer < RAFT_NODES; peer++) {
+                if (peer != node) {
+                    options.raftPeers.push_back(id(peer));
+                }
+            }
+            options.raftLogPath = logPath(node);
+            options.raftBatch = this->batch;
+
+            this->pids[node] = spawn_server(port(node), options);
+        }
+
+        void kill(size_t node) {
+            if (this->pids[node] != 0) {
+                ::kill(this->pids[node], SIGKILL);
+                waitpid(this->pids[node], nullptr, 0);
+                this->pids[node] = 0;
+            }
+        }
+
+        /**
+         * @brief the node that leads and holds a lease, waits for an election
+         */
+        size_t leader() {
+            const auto start = bench_clock::now();
+            while (elapsed_seconds(start) < 30) {
+                for (size_t node = 0; node < RAFT_NODES; node++) {
+                    if (this->pids[node] == 0) {
+                        continue;
+                    }
+
+                    try {
+                        bench_connection connection(port(node), 1);
+                        const auto raft = connection.request({ { JSON::KEY::REQUEST, JSON::VALUE::REQUEST_STATS } })[JSON::KEY::STATS][JSON::KEY::RAFT];
+                        if (raft["role"] == "leader" && raft["lease"].get<bool>()) {
+                            return node;
+                        }
+                    } catch (const std::exception &) {
+                        // not up yet
+                    }
+                }
+                std::this_thread::sleep_for(std::chrono::milliseconds(50));
+            }
+
+            throw std::runtime_error("no raft leader elected");
+        }
+    };
+
+    /**
+     * \brief commit throughput and latency of single writes on the leader, clients concurrent
+     * writers share log writes, fsyncs and messages up to batch proposals
+     */
+    inline void raft_commit_latency(size_t batch) {
+        bench_raft_cluster cluster(batch);
+        for (size_t node = 0; node < RAFT_NODES; node++) {
+            cluster.start(node);
+        }
+        const unsigned short leaderPort = bench_raft_cluster::port(cluster.leader());
+        const string value(100, 'v');
+
+        for (size_t clients : { 1, 16, 64 }) {
+            std::vector<std::vector<double>> latencies(clients);
+            std::atomic<bool> stop(false);
+            std::vector<std::thread> writers;
+            for (size_t t = 0; t < clients; t++) {
+                writers.emplace_back([&, t]() {
+                    bench_connection leader(leaderPort);
+                    for (uint64_t i = 0; !stop.load(std::memory_order_relaxed); i++) {
+                        const auto sent = bench_clock::now();
+                        const auto answer = leader.request({ { JSON::KEY::REQUEST, JSON::VALUE::REQUEST_WRITE },
+                                                             { JSON::KEY::KEY, "batch:" + std::to_string(t) + ":" + std::to_string(i % 1000) },
+                                                             { JSON::KEY::VALUE, value } });
+                        if (answer[JSON::KEY::STATUS] != JSON::VALUE::STATUS_OK) {
+                            throw std::runtime_error("write failed: " + answer.dump());
+                        }
+                        latencies[t].push_back(std::chrono::duration<double, std::milli>(bench_clock::now() - sent).count());
+                    }
+                });
+            }
+
+            const auto start = bench_clock::now();
+            std::this_thread::sleep_for(std::chrono::seconds(2));
+            stop = true;
+            for (auto &writer : writers) {
+                writer.join();
+            }
+            const double seconds = elapsed_seconds(start);
+
+            std::vector<double> all;
+            for (const auto &thread : latencies) {
+                all.insert(all.end(), thread.begin(), thread.end());
+            }
+            std::sort(all.begin(), all.end());
+            std::printf("%8zu %8zu %12.0f %10.3f %10.3f\n", batch, clients, all.size() / seconds, all[all.size() / 2],
+                        all[all.size() * 99 / 100]);
+        }
+    }
+
+    /**
+     * \brief writers keep going while the leader is killed and restarted failovers times, then
+     * every acknowledged write must be on the new leader
+     */
+    inline void raft_failover(size_t failovers) {
+        const size_t WRITERS = 8;
+        bench_raft_cluster cluster(256);
+        for (size_t node = 0; node < RAFT_NODES; node++) {
+            cluster.start(node);
+        }
+        cluster.leader();
+
+        std::mutex mutex;
+        std::vector<string> acknowledged;
+        auto lastAcknowledged = bench_clock::now();
+        double maxGap = 0;
+        std::atomic<uint64_t> retries(0);
+        std::atomic<bool> stop(false);
+
+        std::vector<std::thread> writers;
+        for (size_t t = 0; t < WRITERS; t++) {
+            writers.emplace_back([&, t]() {
+                size_t node = t % RAFT_NODES;
+                std::unique_ptr<bench_connection> connection;
+                uint64_t n = 0;
+                while (!stop.load(std::memory_order_relaxed)) {
+                    // the value is the key, writing it again after an unknown outcome is harmless
+                    const string key = "failover:" + std::to_string(t) + ":" + std::to_string(n);
+                    try {
+                        if (connection == nullptr) {
+                            connection.reset(new bench_connection(bench_raft_cluster::port(node), 1));
+                        }
+
+                        const auto answer = connection->request({ { JSON::KEY::REQUEST, JSON::VALUE::REQUEST_WRITE },
+                                                                  { JSON::KEY::KEY, key },
+                                                                  { JSON::KEY::VALUE, key } });
+                        if (answer[JSON::KEY::STATUS] == JSON::VALUE::STATUS_OK) {
+                            std::lock_guard<std::mutex> lock(mutex);
+                            const auto now = bench_clock::now();
+                            maxGap = std::max(maxGap, std::chrono::duration<double, std::milli>(now - lastAcknowledged).count());
+                            lastAcknowledged = now;
+                            acknowledged.push_back(key);
+                            n++;
+                            continue;
+                        }
+
+                        // not the leader, or the leader changed before the write committed
+                        retries++;
+                        connection.reset();
+                        const size_t hint = bench_raft_cluster::node(answer.value(JSON::KEY::LEADER, string()));
+                        if (hint < RAFT_NODES) {
+                            node = hint;
+                        } else {
+                            node = (node + 1) % RAFT_NODES;
+                            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+                        }
+                    } catch (const std::exception &) {
+                        // killed or not up yet
+                        retries++;
+                        connection.reset();
+                        node = (node + 1) % RAFT_NODES;
+                        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+                    }
+                }
+            });
+        }
+
+        for (size_t i = 0; i < failovers; i++) {
+            std::this_thread::sleep_for(std::chrono::seconds(3));
+            const size_t leader = cluster.leader();
+            cluster.kill(leader);
+            std::this_thread::sleep_for(std::chrono::seconds(1));
+            cluster.start(leader);
+        }
+        std::this_thread::sleep_for(std::chrono::seconds(2));
+
+        stop = true;
+        for (auto &writer : writers) {
+            writer.join();
+        }
+
+        bench_connection leader(bench_raft_cluster::port(cluster.leader()));
+        size_t missing = 0;
+        for (size_t first = 0; first < acknowledged.size(); first += 100) {
+            const size_t last = std::min(acknowledged.size(), first + 100);
+            const std::vector<string> keys(acknowledged.begin() + first, acknowledged.begin() + last);
+            const auto answer = leader.request({ { JSON::KEY::REQUEST, JSON::VALUE::REQUEST_MGET }, { JSON::KEY::KEYS, keys } });
+            const auto &values = answer[JSON::KEY::VALUES];
+            for (size_t i = 0; i < keys.size(); i++) {
+                if (!values[i].is_string() || values[i].get<string>() != keys[i]) {
+                    missing++;
+                }
+            }
+        }
+
+        std::printf("%zu leader kills under %zu writers: %zu writes acknowledged, %llu retried, longest pause %.0f ms, %zu acknowledged writes lost\n",
+                    failovers, WRITERS, acknowledged.size(), static_cast<unsigned long long>(retries.load()), maxGap, missing);
+    }
+#endif
+
+    inline void benchmark_raft() {
+        print_header("raft cluster, three local server processes");
+#ifdef __linux__
+        try {
+            std::printf("%8s %8s %12s %10s %10s\n", "batch", "clients", "writes/s", "p50 ms", "p99 ms");
+            for (size_t batch : { 1, 16, 256 }) {
+                raft_commit_latency(batch);
+            }
+
+            raft_failover(3);
+        } catch (const std::exception &error) {
+            std::printf("raft benchmark failed: %s\n", error.what());
+        }
+#else
+        std::printf("needs fork, linux only\n");
+#endif
+    }
+}// namespace Diginext::Core::Storage::Benchmark
+
+#endif
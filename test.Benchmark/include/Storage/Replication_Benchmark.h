@@ -0,0 +1,233 @@
+#ifndef DIGINEXT_BENCHMARK___STORAGE_REPLICATION_BENCHMARK_H
+#define DIGINEXT_BENCHMARK___STORAGE_REPLICATION_BENCHMARK_H
+
+#include "Benchmark.h"
+
+#include <Base64/Base64.h>
+#include <Storage/StorageCommon.h>
+#include <Storage/StorageServer.h>
+#include <TCP/TCP.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <boost/asio.hpp>
+#include <nlohmann/json.hpp>
+
+#ifdef __linux__
+#include <signal.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+namespace Diginext::Core::Storage::Benchmark {
+    using namespace Diginext::Core::Benchmark;
+
+    const unsigned short REPLICATION_LEADER_PORT = 47900;
+    const unsigned short REPLICATION_FOLLOWER_PORT = 47901;
+
+    /**
+     * \brief blocking connection in the server's framing, one base64 json message per line
+     */
+    class bench_connection {
+    private:
+        boost::asio::io_service ios;
+        boost::asio::ip::tcp::socket socket;
+        boost::asio::streambuf buffer;
+
+    public:
+        /**
+         * @param[in] port server port on 127.0.0.1
+         * @param[in] connectSeconds how long to keep retrying while the server is not up
+         */
+        explicit bench_connection(unsigned short port, double connectSeconds = 30) : socket(ios) {
+            const auto endpoint = boost::asio::ip::tcp::endpoint(boost::asio::ip::address::from_string("127.0.0.1"), port);
+
+            // the server process may still be starting
+            const auto start = bench_clock::now();
+            for (;;) {
+                boost::system::error_code error;
+                this->socket.connect(endpoint, error);
+                if (!error) {
+                    this->socket.set_option(boost::asio::ip::tcp::no_delay(true));
+                    return;
+                }
+
+                this->socket.close();
+                if (elapsed_seconds(start) > connectSeconds) {
+                    throw std::runtime_error("server on port " + std::to_string(port) + " does not answer");
+                }
+                std::this_thread::sleep_for(std::chrono::milliseconds(100));
+            }
+        }
+
+        nlohmann::json request(const nlohmann::json &message) {
+            const string line = Base64::Encode(message.dump()) + "\n";
+            boost::asio::write(this->socket, boost::asio::buffer(line));
+
+            boost::asio::read_until(this->socket, this->buffer, '\n');
+            std::istream stream(&this->buffer);
+            string answer;
+            std::getline(stream, answer);
+            return nlohmann::json::parse(Base64::Decode(answer));
+        }
+    };
+
+#ifdef __linux__
+    /**
+     * \brief run a server in a child process until it is killed
+     */
+    inline pid_t spawn_server(unsigned short port, const StorageOptions &options) {
+        // the child would print whatever is still buffered a second time
+        std::fflush(stdout);
+        const pid_t pid = fork();
+        if (pid != 0) {
+            return pid;
+        }
+
+        // the server logs every request, keep it off the report
+        std::freopen("/dev/null", "w", stdout);
+        std::freopen("/dev/null", "w", stderr);
+        Diginext::Core::TCP::tcp_all_log_disable();
+
+        StorageServer::pointer server = StorageServer::create("127.0.0.1", port, options);
+        server->Start();
+        for (;;) {
+            std::this_thread::sleep_for(std::chrono::seconds(1));
+        }
+    }
+
+    inline nlohmann::json replication_stats(bench_connection &connection) {
+        return connection.request({ { JSON::KEY::REQUEST, JSON::VALUE::REQUEST_STATS } })[JSON::KEY::STATS][JSON::KEY::REPLICATION];
+    }
+
+    /**
+     * \brief time from a write acknowledged by the leader until the follower serves it,
+     * while writerCount clients keep the leader busy with mput batches
+     */
+    inline void replication_lag(size_t writerCount) {
+        const string value(100, 'v');
+        const size_t BATCH = 50;
+
+        std::atomic<bool> stop(false);
+        std::atomic<uint64_t> written(0);
+        std::vector<std::thread> writers;
+        for (size_t t = 0; t < writerCount; t++) {
+            writers.emplace_back([&, t]() {
+                bench_connection leader(REPLICATION_LEADER_PORT);
+                uint64_t random = 0x9E3779B97F4A7C15ULL * (t + 1);
+                while (!stop.load(std::memory_order_relaxed)) {
+                    nlohmann::json items = nlohmann::json::array();
+                    for (size_t i = 0; i < BATCH; i++) {
+                        items.push_back({ { JSON::KEY::KEY, "key:" + std::to_string(next_random(random) % 100000) }, { JSON::KEY::VALUE, value } });
+                    }
+                    leader.request({ { JSON::KEY::REQUEST, JSON::VALUE::REQUEST_MPUT }, { JSON::KEY::ITEMS, std::move(items) } });
+                    written += BATCH;
+                }
+            });
+        }
+
+        bench_connection leader(REPLICATION_LEADER_PORT);
+        bench_connection follower(REPLICATION_FOLLOWER_PORT);
+
+        std::vector<double> lags;
+        const auto start = bench_clock::now();
+        for (uint64_t probe = 1; elapsed_seconds(start) < 3; probe++) {
+            const string expected = std::to_string(probe) + ":" + std::to_string(writerCount);
+            leader.request({ { JSON::KEY::REQUEST, JSON::VALUE::REQUEST_WRITE }, { JSON::KEY::KEY, "probe" }, { JSON::KEY::VALUE, expected } });
+            const auto acknowledged = bench_clock::now();
+
+            for (;;) {
+                const auto answer = follower.request({ { JSON::KEY::REQUEST, JSON::VALUE::REQUEST_READ }, { JSON::KEY::KEY, "probe" } });
+                if (answer.value(JSON::KEY::VALUE, string()) == expected) {
+                    break;
+                }
+            }
+            lags.push_back(std::chrono::duration<double, std::milli>(bench_clock::now() - acknowledged).count());
+        }
+        const double seconds = elapsed_seconds(start);
+
+        stop = true;
+        for (auto &writer : writers) {
+            writer.join();
+        }
+
+        std::sort(lags.begin(), lags.end());
+        std::printf("%8zu %14.0f %8zu %10.3f %10.3f %10.3f\n", writerCount, written.load() / seconds, lags.size(),
+                    lags[lags.size() / 2], lags[lags.size() * 99 / 100], lags.back());
+    }
+
+    /**
+     * \brief follower paused under write load, then the time it takes to apply the backlog
+     */
+    inline void replication_catch_up(pid_t followerPid) {
+        const string value(100, 'v');
+        bench_connection leader(REPLICATION_LEADER_PORT);
+
+        kill(followerPid, SIGSTOP);
+        const auto paused = bench_clock::now();
+        uint64_t written = 0;
+        while (elapsed_seconds(paused) < 2) {
+            nlohmann::json items = nlohmann::json::array();
+            for (size_t i = 0; i < 50; i++) {
+                items.push_back({ { JSON::KEY::KEY, "catchup:" + std::to_string(written++) }, { JSON::KEY::VALUE, value } });
+            }
+            leader.request({ { JSON::KEY::REQUEST, JSON::VALUE::REQUEST_MPUT }, { JSON::KEY::ITEMS, std::move(items) } });
+        }
+        const uint64_t head = replication_stats(leader)["position"].get<uint64_t>();
+        kill(followerPid, SIGCONT);
+
+        const auto resumed = bench_clock::now();
+        bench_connection follower(REPLICATION_FOLLOWER_PORT);
+        while (replication_stats(follower)["position"].get<uint64_t>() < head) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+
+        std::printf("paused 2 s while %llu records were written, caught up in %.0f ms\n",
+                    static_cast<unsigned long long>(written), elapsed_seconds(resumed) * 1000);
+    }
+#endif
+
+    inline void benchmark_replication() {
+        print_header("leader -> follower replication lag, two local server processes");
+#ifdef __linux__
+        StorageOptions leaderOptions;
+        StorageOptions followerOptions;
+        followerOptions.replicaOfHost = "127.0.0.1";
+        followerOptions.replicaOfPort = REPLICATION_LEADER_PORT;
+
+        const pid_t leaderPid = spawn_server(REPLICATION_LEADER_PORT, leaderOptions);
+        const pid_t followerPid = spawn_server(REPLICATION_FOLLOWER_PORT, followerOptions);
+
+        try {
+            bench_connection follower(REPLICATION_FOLLOWER_PORT);
+            while (replication_stats(follower)["state"] != "online") {
+                std::this_thread::sleep_for(std::chrono::milliseconds(100));
+            }
+
+            std::printf("%8s %14s %8s %10s %10s %10s\n", "writers", "writes/s", "probes", "p50 ms", "p99 ms", "max ms");
+            for (size_t writers : { 0, 1, 4, 8 }) {
+                replication_lag(writers);
+            }
+
+            replication_catch_up(followerPid);
+        } catch (const std::exception &error) {
+            std::printf("replication benchmark failed: %s\n", error.what());
+        }
+
+        kill(leaderPid, SIGKILL);
+        kill(followerPid, SIGKILL);
+        waitpid(leaderPid, nullptr, 0);
+        waitpid(followerPid, nullptr, 0);
+#else
+        std::printf("needs fork, linux only\n");
+#endif
+    }
+}// namespace Diginext::Core::Storage::Benchmark
+
+#endif
@@ -0,0 +1,122 @@
+#ifndef DIGINEXT_BENCHMARK___STORAGE_REQUEST_CODEC_BENCHMARK_H
+#define DIGINEXT_BENCHMARK___STORAGE_REQUEST_CODEC_BENCHMARK_H
+
+#include "Benchmark.h"
+
+#include <Storage/RequestCodec.h>
+#include <Storage/StorageCommon.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include <nlohmann/json.hpp>
+
+namespace Diginext::Core::Storage::Benchmark {
+    using namespace Diginext::Core::Benchmark;
+
+    const size_t REQUEST_CODEC_ROUNDS = 500000;
+
+    /**
+     * \brief best of three, ns per call
+     */
+    inline double request_codec_ns(const std::function<size_t()> &work) {
+        double best = 0;
+        volatile size_t sink = 0;///< keeps the work from being optimized away
+        for (size_t attempt = 0; attempt < 3; attempt++) {
+            const auto start = bench_clock::now();
+            for (size_t i = 0; i < REQUEST_CODEC_ROUNDS; i++) {
+                sink = sink + work();
+            }
+            const double ns = elapsed_seconds(start) * 1e9 / REQUEST_CODEC_ROUNDS;
+            best = attempt == 0 ? ns : std::min(best, ns);
+        }
+        return best;
+    }
+
+    inline void request_codec_parse(const string &name, const string &message) {
+        // what handle_read_message did for every request: DOM, then the fields copied out of it
+        const double dom = request_codec_ns([&]() {
+            const auto json = nlohmann::json::parse(message);
+            size_t size = 0;
+            if (json.contains(JSON::KEY::REQUEST) && json.contains(JSON::KEY::KEY)) {
+                const string request = json[JSON::KEY::REQUEST].get<string>();
+                const string key = json[JSON::KEY::KEY].get<string>();
+                size = request.size() + key.size();
+                if (json.contains(JSON::KEY::VALUE)) {
+                    size += json[JSON::KEY::VALUE].get<string>().size();
+                }
+            }
+            return size;
+        });
+
+        ParsedRequest parsed;
+        string key;
+        const double fast = request_codec_ns([&]() {
+            if (!parse_request(message, parsed)) {
+                return size_t(0);
+            }
+            key.assign(parsed.key);
+            return parsed.request.size() + key.size() + parsed.value.size();
+        });
+
+        std::printf("%-28s %10zu %12.1f %12.1f %8.1fx\n", name.c_str(), message.size(), dom, fast, dom / fast);
+    }
+
+    inline void request_codec_answer(const string &name, const string &value, bool error) {
+        const double dom = request_codec_ns([&]() {
+            nlohmann::json json;
+            if (error) {
+                json[JSON::KEY::STATUS] = JSON::VALUE::STATUS_ERROR;
+                json[JSON::KEY::DESCRIPTION] = value;
+            } else {
+                json[JSON::KEY::STATUS] = JSON::VALUE::STATUS_OK;
+                json[JSON::KEY::VALUE] = value;
+                json[JSON::KEY::VERSION] = uint64_t(1792270913897660ULL);
+            }
+            return json.dump().size();
+        });
+
+        ResponseWriter writer;
+        const double fast = request_codec_ns([&]() {
+            writer.begin();
+            if (error) {
+                writer.field(JSON::KEY::DESCRIPTION, value).field(JSON::KEY::STATUS, JSON::VALUE::STATUS_ERROR);
+            } else {
+                writer.field(JSON::KEY::STATUS, JSON::VALUE::STATUS_OK).field(JSON::KEY::VALUE, value).field(JSON::KEY::VERSION, uint64_t(1792270913897660ULL));
+            }
+            return writer.end().size();
+        });
+
+        std::printf("%-28s %10zu %12.1f %12.1f %8.1fx\n", name.c_str(), value.size(), dom, fast, dom / fast);
+    }
+
+    inline void benchmark_request_codec() {
+        print_header("request parse and answer write, ns per request: nlohmann DOM vs RequestCodec");
+
+        const string value100(100, 'v');
+        const string value1k(1024, 'v');
+        string escaped;
+        for (size_t i = 0; escaped.size() < 100; i++) {
+            escaped += "line \"" + std::to_string(i) + "\"\n";
+        }
+
+        std::printf("%-28s %10s %12s %12s %9s\n", "parse", "bytes", "dom ns", "codec ns", "speedup");
+        request_codec_parse("read", R"({"request":"read","key":"user:000012345678"})");
+        request_codec_parse("read if_version", R"({"request":"read","key":"user:000012345678","if_version":1792270913897660})");
+        request_codec_parse("write 100 B", nlohmann::json{ { "request", "write" }, { "key", "user:000012345678" }, { "value", value100 } }.dump());
+        request_codec_parse("write 1 KB", nlohmann::json{ { "request", "write" }, { "key", "user:000012345678" }, { "value", value1k } }.dump());
+        request_codec_parse("write 100 B escaped", nlohmann::json{ { "request", "write" }, { "key", "user:000012345678" }, { "value", escaped } }.dump());
+        request_codec_parse("write ttl", nlohmann::json{ { "request", "write" }, { "key", "user:000012345678" }, { "value", value100 }, { "ttl", 60000 } }.dump());
+
+        std::printf("\n%-28s %10s %12s %12s %9s\n", "answer", "value", "dom ns", "writer ns", "speedup");
+        request_codec_answer("ok read 100 B", value100, false);
+        request_codec_answer("ok read 1 KB", value1k, false);
+        request_codec_answer("ok read 100 B escaped", escaped, false);
+        request_codec_answer("error", "key not found in storage", true);
+    }
+}// namespace Diginext::Core::Storage::Benchmark
+
+#endif
@@ -0,0 +1,232 @@
+#ifndef DIGINEXT_BENCHMARK___STORAGE_RESP_BENCHMARK_H
+#define DIGINEXT_BENCHMARK___STORAGE_RESP_BENCHMARK_H
+
+#include "Benchmark.h"
+#include "Storage/Pipeline_Benchmark.h"
+#include "Storage/Replication_Benchmark.h"
+
+#include <Storage/RespCodec.h>
+#include <Storage/StorageServer.h>
+#include <TCP/TCP.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <boost/asio.hpp>
+
+namespace Diginext::Core::Storage::Benchmark {
+    using namespace Diginext::Core::Benchmark;
+
+    const unsigned short RESP_NATIVE_PORT = 47920;
+    const unsigned short RESP_NATIVE_WAL_PORT = 47921;
+    const unsigned short RESP_PORT = 47922;
+    const unsigned short RESP_WAL_PORT = 47923;
+
+    /**
+     * \brief blocking RESP client, whole batches written at once, answers counted
+     */
+    class resp_bench_connection {
+    private:
+        boost::asio::io_service ios;
+        boost::asio::ip::tcp::socket socket;
+        string in;
+        size_t parsed = 0;
+
+        // one answer from parsed on, false if it is not all there yet
+        bool skip() {
+            if (this->parsed >= this->in.size()) {
+                return false;
+            }
+
+            const size_t end = this->in.find("\r\n", this->parsed);
+            if (end == string::npos) {
+                return false;
+            }
+
+            if (this->in[this->parsed] == '-') {
+                throw std::runtime_error("resp error: " + this->in.substr(this->parsed, end - this->parsed));
+            }
+
+            size_t next = end + 2;
+            if (this->in[this->parsed] == '$') {
+                const long length = std::stol(this->in.substr(this->parsed + 1, end - this->parsed - 1));
+                next += length < 0 ? 0 : static_cast<size_t>(length) + 2;
+                if (next > this->in.size()) {
+                    return false;
+                }
+            }
+
+            this->parsed = next;
+            return true;
+        }
+
+    public:
+        explicit resp_bench_connection(unsigned short port) : socket(ios) {
+            const auto endpoint = boost::asio::ip::tcp::endpoint(boost::asio::ip::address::from_string("127.0.0.1"), port);
+            const auto start = bench_clock::now();
+            for (;;) {
+                boost::system::error_code error;
+                this->socket.connect(endpoint, error);
+                if (!error) {
+                    this->socket.set_option(boost::asio::ip::tcp::no_delay(true));
+                    return;
+                }
+
+                this->socket.close();
+                if (elapsed_seconds(start) > 30) {
+                    throw std::runtime_error("resp port " + std::to_string(port) + " does not answer");
+                }
+                std::this_thread::sleep_for(std::chrono::milliseconds(100));
+            }
+        }
+
+        void round(const string &commands, size_t count) {
+            boost::asio::write(this->socket, boost::asio::buffer(commands));
+
+            char chunk[65536];
+            for (size_t answered = 0; answered < count;) {
+                if (this->skip()) {
+                    answered++;
+                    continue;
+                }
+
+                const size_t read = this->socket.read_some(boost::asio::buffer(chunk));
+                this->in.erase(0, this->parsed);
+                this->parsed = 0;
+                this->in.append(chunk, read);
+            }
+        }
+    };
+
+    inline string resp_bench_command(const std::vector<string> &args) {
+        string out;
+        resp_array(out, args.size());
+        for (const auto &arg : args) {
+            resp_bulk(out, arg);
+        }
+        return out;
+    }
+
+    /**
+     * \brief commands per second over one connection, depth commands written before the answers are read
+     */
+    inline double resp_rate(resp_bench_connection &connection, size_t depth, bool writes) {
+        const string value(100, 'v');
+        uint64_t random = 0x9E3779B97F4A7C15ULL;
+        uint64_t done = 0;
+        string batch;
+
+        const auto start = bench_clock::now();
+        while (elapsed_seconds(start) < 2) {
+            batch.clear();
+            for (size_t i = 0; i < depth; i++) {
+                const string key = "key:" + std::to_string(next_random(random) % 10000);
+                batch += writes ? resp_bench_command({ "SET", key, value }) : resp_bench_command({ "GET", key });
+            }
+
+            connection.round(batch, depth);
+            done += depth;
+        }
+        return done / elapsed_seconds(start);
+    }
+
+    inline void resp_table(const string &name, unsigned short port, bool writes) {
+        resp_bench_connection connection(port);
+
+        // every key exists, reads hit
+        string preload;
+        for (size_t i = 0; i < 10000; i++) {
+            preload += resp_bench_command({ "SET", "key:" + std::to_string(i), "v" });
+        }
+        connection.round(preload, 10000);
+
+        std::printf("%-24s", name.c_str());
+        for (size_t depth : { 1, 16, 64, 256 }) {
+            std::printf(" %12.0f", resp_rate(connection, depth, writes));
+        }
+        std::printf("\n");
+    }
+
+    inline void resp_parse_rate(const string &name, size_t readSize) {
+        const string value(100, 'v');
+        string stream;
+        for (size_t i = 0; i < 256; i++) {
+            stream += resp_bench_command({ "SET", "key:" + std::to_string(i), value });
+        }
+
+        std::vector<string> reads;
+        for (size_t pos = 0; pos < stream.size(); pos += readSize) {
+            reads.push_back(stream.substr(pos, readSize));
+        }
+
+        RespParser parser;
+        size_t commands = 0;
+        size_t bytes = 0;
+        const auto start = bench_clock::now();
+        while (elapsed_seconds(start) < 1) {
+            for (const auto &read : reads) {
+                parser.feed(read);
+                while (parser.next() == resp_parse::Command) {
+                    commands++;
+                    bytes += parser.getArgs()[2].size();
+                }
+                parser.finish();
+            }
+        }
+        const double seconds = elapsed_seconds(start);
+        std::printf("%-28s %12.1f %12.0f\n", name.c_str(), seconds * 1e9 / commands, bytes / seconds / (1024 * 1024));
+    }
+
+    inline void benchmark_resp() {
+        print_header("RESP2 listener: parse cost and commands / s over one connection next to the native binary protocol");
+
+        std::printf("%-28s %12s %12s\n", "parse 256 pipelined SET", "ns / cmd", "value MB / s");
+        resp_parse_rate("one read", 1 << 20);
+        resp_parse_rate("1460 byte reads", 1460);
+        resp_parse_rate("64 byte reads", 64);
+        std::printf("\n");
+
+#ifdef __linux__
+        StorageOptions options;
+        options.respPort = RESP_PORT;
+        StorageOptions walOptions;
+        walOptions.respPort = RESP_WAL_PORT;
+        walOptions.walPath = "resp_benchmark.wal";
+        std::remove(walOptions.walPath.c_str());
+
+        const pid_t pid = spawn_server(RESP_NATIVE_PORT, options);
+        const pid_t walPid = spawn_server(RESP_NATIVE_WAL_PORT, walOptions);
+        Diginext::Core::TCP::tcp_all_log_disable();
+
+        try {
+            // the servers may still be starting
+            bench_connection server(RESP_NATIVE_PORT);
+            bench_connection walServer(RESP_NATIVE_WAL_PORT);
+
+            std::printf("%-24s %12s %12s %12s %12s\n", "in flight", "1", "16", "64", "256");
+            resp_table("resp GET", RESP_PORT, false);
+            pipeline_table("native read", RESP_NATIVE_PORT, false);
+            resp_table("resp SET", RESP_PORT, true);
+            pipeline_table("native write", RESP_NATIVE_PORT, true);
+            resp_table("resp SET, wal", RESP_WAL_PORT, true);
+            pipeline_table("native write, wal", RESP_NATIVE_WAL_PORT, true);
+        } catch (const std::exception &error) {
+            std::printf("resp benchmark failed: %s\n", error.what());
+        }
+
+        kill(pid, SIGKILL);
+        kill(walPid, SIGKILL);
+        waitpid(pid, nullptr, 0);
+        waitpid(walPid, nullptr, 0);
+        std::remove(walOptions.walPath.c_str());
+#else
+        std::printf("needs fork, linux only\n");
+#endif
+    }
+}// namespace Diginext::Core::Storage::Benchmark
+
+#endif
@@ -0,0 +1,98 @@
+#ifndef DIGINEXT_BENCHMARK___STORAGE_SHARDED_HASH_STORAGE_BENCHMARK_H
+#define DIGINEXT_BENCHMARK___STORAGE_SHARDED_HASH_STORAGE_BENCHMARK_H
+
+#include "Benchmark.h"
+
+#include <Storage/ShardedHashStorage.h>
+
+#include <atomic>
+#include <map>
+#include <mutex>
+#include <string>
+
+namespace Diginext::Core::Storage::Benchmark {
+    using namespace Diginext::Core::Benchmark;
+
+    /**
+     * \brief the storage StorageServer used before sharding: one map, one mutex,
+     * read = keyExists + readValue (two lock round trips)
+     */
+    class MapBaseline {
+    private:
+        std::map<string, string> dataStorage;
+        std::mutex dataSync;
+
+    public:
+        bool get(const string &key, string &value) {
+            {
+                std::lock_guard<std::mutex> guard(this->dataSync);
+                if (this->dataStorage.find(key) == this->dataStorage.end()) {
+                    return false;
+                }
+            }
+
+            std::lock_guard<std::mutex> guard(this->dataSync);
+            value = this->dataStorage[key];
+            return true;
+        }
+
+        void put(const string &key, const string &value) {
+            std::lock_guard<std::mutex> guard(this->dataSync);
+            this->dataStorage[key] = value;
+        }
+    };
+
+    /**
+     * \brief 90% reads / 10% writes over a preloaded key set
+     * @return operations per second
+     */
+    template<class StorageT>
+    double sharded_hash_storage_workload(StorageT &storage, const std::vector<string> &keys, size_t threadCount, size_t opsPerThread) {
+        const string value(100, 'v');
+        for (const auto &key : keys) {
+            storage.put(key, value);
+        }
+
+        std::atomic<size_t> found(0);
+        const double seconds = run_threads(threadCount, [&](size_t index) {
+            uint64_t random = 0x9E3779B97F4A7C15ULL * (index + 1);
+            string out;
+            size_t localFound = 0;
+            for (size_t i = 0; i < opsPerThread; i++) {
+                const uint64_t r = next_random(random);
+                const string &key = keys[r % keys.size()];
+                if ((r >> 32) % 10 == 0) {
+                    storage.put(key, value);
+                } else if (storage.get(key, out)) {
+                    localFound++;
+                }
+            }
+
+            found += localFound;
+        });
+
+        return double(threadCount * opsPerThread) / seconds;
+    }
+
+    inline void benchmark_sharded_hash_storage() {
+        print_header("ShardedHashStorage vs std::map + mutex (90% read / 10% write, 100k keys)");
+
+        const auto keys = make_keys(100000);
+        const size_t OPS_TOTAL = 4000000;
+
+        std::printf("%8s %18s %18s %8s\n", "threads", "map ops/s", "sharded ops/s", "speedup");
+        for (size_t threads : {1, 4, 16, 64}) {
+            const size_t opsPerThread = OPS_TOTAL / threads;
+
+            MapBaseline baseline;
+            const double mapOps = sharded_hash_storage_workload(baseline, keys, threads, opsPerThread);
+
+            ShardedHashStorage sharded;
+            const double shardedOps = sharded_hash_storage_workload(sharded, keys, threads, opsPerThread);
+
+            std::printf("%8zu %18.0f %18.0f %7.2fx\n", threads, mapOps, shardedOps, shardedOps / mapOps);
+        }
+    }
+}// namespace Diginext::Core::Storage::Benchmark
+
+#endif
@@ -0,0 +1,107 @@
+#ifndef DIGINEXT_BENCHMARK___STORAGE_SNAPSHOT_BENCHMARK_H
+#define DIGINEXT_BENCHMARK___STORAGE_SNAPSHOT_BENCHMARK_H
+
+#include "Benchmark.h"
+
+#include <Storage/ShardedHashStorage.h>
+#include <Storage/SnapshotFile.h>
+#include <Storage/StorageFile.h>
+#include <Storage/WriteAheadLog.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace Diginext::Core::Storage::Benchmark {
+    using namespace Diginext::Core::Benchmark;
+
+    /**
+     * \brief key counts from DIGINEXT_BENCH_SNAPSHOT_KEYS (comma separated), defaults keep a run short
+     */
+    inline std::vector<size_t> snapshot_key_counts() {
+        std::vector<size_t> counts;
+        const char *env = std::getenv("DIGINEXT_BENCH_SNAPSHOT_KEYS");
+        if (env != nullptr) {
+            std::stringstream stream(env);
+            string item;
+            while (std::getline(stream, item, ',')) {
+                counts.push_back(std::stoull(item));
+            }
+        }
+
+        if (counts.empty()) {
+            counts = { 1000000, 5000000 };
+        }
+
+        return counts;
+    }
+
+    /**
+     * \brief cold start of the same data set: full log replay vs mapping a snapshot and
+     * serving the first read
+     */
+    inline void snapshot_workload(size_t keyCount) {
+        const string walPath = "diginext_benchmark.wal";
+        const string snapshotPath = "diginext_benchmark.snap";
+        file_remove(walPath);
+        file_remove(snapshotPath);
+
+        const string value(64, 'v');
+        auto key = [](size_t i) { return "key:" + std::to_string(i); };
+
+        {
+            WriteAheadLog wal(walPath, FsyncPolicy::Async);
+            wal.open();
+            for (size_t i = 0; i < keyCount; i++) {
+                wal.append(WalRecordType::Put, key(i), value);
+            }
+        }
+
+        SnapshotFile::write(snapshotPath, [&](const SnapshotFile::record_callback &emit) {
+            for (size_t i = 0; i < keyCount; i++) {
+                emit(key(i), value);
+            }
+        });
+
+        double replaySeconds;
+        {
+            auto start = bench_clock::now();
+            auto storage = ShardedHashStorage::create();
+            WriteAheadLog wal(walPath);
+            wal.replay([&storage](const WalRecord &record) { storage->put(record.key, record.value); });
+            replaySeconds = elapsed_seconds(start);
+        }
+
+        double mapSeconds;
+        double firstReadSeconds;
+        {
+            auto start = bench_clock::now();
+            auto storage = ShardedHashStorage::create();
+            storage->attachBase(SnapshotFile::open(snapshotPath));
+            mapSeconds = elapsed_seconds(start);
+
+            string read;
+            storage->get(key(keyCount / 2), read);
+            firstReadSeconds = elapsed_seconds(start);
+        }
+
+        std::printf("%12zu %14.1f %14.3f %16.3f %10.0fx\n", keyCount, replaySeconds * 1000, mapSeconds * 1000,
+                    firstReadSeconds * 1000, replaySeconds / firstReadSeconds);
+
+        file_remove(walPath);
+        file_remove(snapshotPath);
+    }
+
+    inline void benchmark_snapshot() {
+        print_header("startup: wal replay vs mapped snapshot (64 B values, page cache warm)");
+
+        std::printf("%12s %14s %14s %16s %11s\n", "keys", "replay ms", "map ms", "first read ms", "speedup");
+        for (size_t keyCount : snapshot_key_counts()) {
+            snapshot_workload(keyCount);
+        }
+    }
+}// namespace Diginext::Core::Storage::Benchmark
+
+#endif
@@ -0,0 +1,119 @@
+#ifndef DIGINEXT_BENCHMARK___STORAGE_STORAGE_ENGINE_BENCHMARK_H
+#define DIGINEXT_BENCHMARK___STORAGE_STORAGE_ENGINE_BENCHMARK_H
+
+#include "Benchmark.h"
+
+#include <Storage/LsmStorage.h>
+#include <Storage/StorageEngineFactory.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+namespace Diginext::Core::Storage::Benchmark {
+    using namespace Diginext::Core::Benchmark;
+
+    /**
+     * \brief the same workload for every engine from storage_engine_names,
+     * key count from DIGINEXT_BENCH_ENGINE_KEYS
+     */
+    inline void benchmark_storage_engines() {
+        print_header("storage engines, same workload (64 B values)");
+
+        const char *env = std::getenv("DIGINEXT_BENCH_ENGINE_KEYS");
+        const size_t keyCount = env != nullptr ? static_cast<size_t>(std::stoull(env)) : 200000;
+        const size_t threadCount = 4;
+        const size_t opsPerThread = 100000;
+        const auto keys = make_keys(keyCount);
+        const string value(64, 'v');
+
+        std::printf("%-6s %12s %14s %12s %14s %14s %12s\n", "engine", "load/s", "mput keys/s", "read/s", "90r/10w /s", "mget keys/s", "scan100/s");
+
+        for (const auto &name : storage_engine_names()) {
+            StorageOptions options;
+            options.engine = name;
+            options.dataDir = "diginext_benchmark_engine";
+            options.fsyncPolicy = FsyncPolicy::Async;
+            std::filesystem::remove_all(options.dataDir);
+
+            auto engine = create_storage_engine(options);
+
+            auto start = bench_clock::now();
+            for (const auto &key : keys) {
+                engine->put(key, value);
+            }
+            const double load = double(keyCount) / elapsed_seconds(start);
+
+            // the same keys again, 100 per batch
+            StorageEngine::record_batch records(100);
+            start = bench_clock::now();
+            for (size_t offset = 0; offset < keyCount; offset += records.size()) {
+                records.resize(std::min(records.size(), keyCount - offset));
+                for (size_t i = 0; i < records.size(); i++) {
+                    records[i].first = keys[offset + i];
+                    records[i].second = value;
+                }
+                engine->multiPut(records);
+            }
+            const double mput = double(keyCount) / elapsed_seconds(start);
+
+            if (auto lsm = std::dynamic_pointer_cast<LsmStorage>(engine)) {
+                lsm->flush();
+                lsm->waitIdle();
+            }
+
+            const double read = double(threadCount * opsPerThread) / run_threads(threadCount, [&](size_t index) {
+                uint64_t state = 0x9E3779B97F4A7C15ULL + index;
+                string read;
+                for (size_t i = 0; i < opsPerThread; i++) {
+                    engine->get(keys[next_random(state) % keyCount], read);
+                }
+            });
+
+            const double mixed = double(threadCount * opsPerThread) / run_threads(threadCount, [&](size_t index) {
+                uint64_t state = 0xD1B54A32D192ED03ULL + index;
+                string read;
+                for (size_t i = 0; i < opsPerThread; i++) {
+                    const uint64_t random = next_random(state);
+                    if (random % 10 == 0) {
+                        engine->put(keys[(random >> 8) % keyCount], value);
+                    } else {
+                        engine->get(keys[(random >> 8) % keyCount], read);
+                    }
+                }
+            });
+
+            std::vector<string> batch(100);
+            uint64_t state = 42;
+            start = bench_clock::now();
+            for (size_t round = 0; round < 2000; round++) {
+                for (auto &key : batch) {
+                    key = keys[next_random(state) % keyCount];
+                }
+                engine->multiGet(batch);
+            }
+            const double mget = double(2000 * batch.size()) / elapsed_seconds(start);
+
+            // the hash engine sorts the whole key space per scan, keep its round count small
+            const size_t scanRounds = name == "hash" ? 10 : 2000;
+            start = bench_clock::now();
+            for (size_t round = 0; round < scanRounds; round++) {
+                size_t seen = 0;
+                engine->scan(keys[next_random(state) % keyCount], string(), [&seen](string_view, string_view) {
+                    return ++seen < 100;
+                });
+            }
+            const double scan = double(scanRounds) / elapsed_seconds(start);
+
+            std::printf("%-6s %12.0f %14.0f %12.0f %14.0f %14.0f %12.1f\n", name.c_str(), load, mput, read, mixed, mget, scan);
+
+            engine.reset();
+            std::filesystem::remove_all(options.dataDir);
+        }
+    }
+}// namespace Diginext::Core::Storage::Benchmark
+
+#endif
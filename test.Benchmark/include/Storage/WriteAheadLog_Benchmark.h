@@ -0,0 +1,84 @@
+#ifndef DIGINEXT_BENCHMARK___STORAGE_WRITE_AHEAD_LOG_BENCHMARK_H
+#define DIGINEXT_BENCHMARK___STORAGE_WRITE_AHEAD_LOG_BENCHMARK_H
+
+#include "Benchmark.h"
+
+#include <Storage/StorageFile.h>
+#include <Storage/WriteAheadLog.h>
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace Diginext::Core::Storage::Benchmark {
+    using namespace Diginext::Core::Benchmark;
+
+    /**
+     * \brief every thread appends and waits for its record to become durable (like a client
+     * waiting for the write ack), reports throughput and ack latency percentiles
+     */
+    inline void write_ahead_log_workload(FsyncPolicy policy, size_t threadCount, size_t opsPerThread) {
+        const string path = "diginext_benchmark.wal";
+        file_remove(path);
+
+        const string value(128, 'v');
+        std::vector<std::vector<double>> latencies(threadCount);
+
+        double seconds;
+        {
+            WriteAheadLog wal(path, policy);
+            wal.open();
+
+            seconds = run_threads(threadCount, [&](size_t index) {
+                auto &local = latencies[index];
+                local.reserve(opsPerThread);
+
+                std::mutex sync;
+                std::condition_variable condition;
+
+                for (size_t i = 0; i < opsPerThread; i++) {
+                    bool done = false;
+                    const auto start = bench_clock::now();
+
+                    wal.append(WalRecordType::Put, "key:" + std::to_string(index) + ":" + std::to_string(i), value,
+                               [&](bool) {
+                                   std::lock_guard<std::mutex> guard(sync);
+                                   done = true;
+                                   condition.notify_one();
+                               });
+
+                    std::unique_lock<std::mutex> lock(sync);
+                    condition.wait(lock, [&done]() { return done; });
+                    local.push_back(std::chrono::duration<double, std::micro>(bench_clock::now() - start).count());
+                }
+            });
+        }
+
+        file_remove(path);
+
+        std::vector<double> all;
+        for (const auto &local : latencies) {
+            all.insert(all.end(), local.begin(), local.end());
+        }
+        std::sort(all.begin(), all.end());
+
+        std::printf("%8s %8zu %14.0f %12.1f %12.1f\n", fsync_policy_to_string(policy).c_str(), threadCount,
+                    double(all.size()) / seconds, all[all.size() / 2], all[all.size() * 99 / 100]);
+    }
+
+    inline void benchmark_write_ahead_log() {
+        print_header("WriteAheadLog write throughput and ack latency (128 B values)");
+
+        std::printf("%8s %8s %14s %12s %12s\n", "fsync", "threads", "writes/s", "p50 us", "p99 us");
+        for (const auto policy : { FsyncPolicy::Always, FsyncPolicy::GroupCommit, FsyncPolicy::Async }) {
+            for (size_t threads : { 1, 16, 64 }) {
+                write_ahead_log_workload(policy, threads, policy == FsyncPolicy::Async ? 20000 : 2000 / threads + 50);
+            }
+        }
+    }
+}// namespace Diginext::Core::Storage::Benchmark
+
+#endif
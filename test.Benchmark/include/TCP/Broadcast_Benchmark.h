@@ -0,0 +1,225 @@
+#ifndef DIGINEXT_BENCHMARK___TCP_BROADCAST_BENCHMARK_H
+#define DIGINEXT_BENCHMARK___TCP_BROADCAST_BENCHMARK_H
+
+#include "Benchmark.h"
+
+#include <TCP/TCP.h>
+#include <TCP/TCPConnection.h>
+#include <TCP/TCPServer.h>
+
+#include <array>
+#include <chrono>
+#include <cstdio>
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <boost/asio.hpp>
+
+#ifdef __linux__
+#include <malloc.h>
+#include <signal.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+namespace Diginext::Core::TCP::Benchmark {
+    using namespace Diginext::Core::Benchmark;
+
+    const unsigned short BROADCAST_PORT = 47920;
+    const size_t BROADCAST_ROUNDS = 20;
+
+#ifdef __linux__
+    /**
+     * \brief heap bytes in use, unlike the resident size it sees a frame the moment it is queued
+     */
+    inline size_t heap_bytes() {
+        return mallinfo2().uordblks;
+    }
+
+    /**
+     * \brief lift the descriptor limit to the hard one, 10k connections do not fit the usual 1024
+     */
+    inline size_t raise_descriptor_limit() {
+        rlimit limit{};
+        getrlimit(RLIMIT_NOFILE, &limit);
+        limit.rlim_cur = limit.rlim_max;
+        setrlimit(RLIMIT_NOFILE, &limit);
+        return static_cast<size_t>(limit.rlim_cur);
+    }
+
+    /**
+     * \brief child process holding count connections to the server and reading whatever arrives on them
+     * \details a separate process, so both ends of 10k connections do not share one descriptor table
+     */
+    inline pid_t spawn_broadcast_readers(unsigned short port, size_t count) {
+        std::fflush(stdout);
+        const pid_t pid = fork();
+        if (pid != 0) {
+            return pid;
+        }
+
+        boost::asio::io_service ios;
+        const auto endpoint = boost::asio::ip::tcp::endpoint(boost::asio::ip::address::from_string(LOCAL_ADDRESS_TCP_V4), port);
+        std::vector<std::unique_ptr<boost::asio::ip::tcp::socket>> sockets;
+        std::vector<std::array<char, 4096>> buffers(count);
+
+        std::function<void(size_t)> read = [&](size_t i) {
+            sockets[i]->async_read_some(boost::asio::buffer(buffers[i]), [&, i](const boost::system::error_code &error, size_t) {
+                if (!error) {
+                    read(i);
+                }
+            });
+        };
+
+        for (size_t i = 0; i < count; i++) {
+            sockets.push_back(std::make_unique<boost::asio::ip::tcp::socket>(ios));
+            for (size_t attempt = 0;; attempt++) {
+                boost::system::error_code error;
+                sockets[i]->connect(endpoint, error);
+                if (!error) {
+                    break;
+                }
+
+                sockets[i]->close();
+                if (attempt == 100) {
+                    _exit(1);
+                }
+                std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            }
+            read(i);
+        }
+
+        ios.run();
+        _exit(0);
+    }
+
+    inline size_t broadcast_queued_bytes(const std::vector<tcp_connection::pointer> &connections) {
+        size_t queued = 0;
+        for (const auto &connection : connections) {
+            queued += connection->getQueuedBytes();
+        }
+        return queued;
+    }
+
+    /**
+     * \brief rounds of one message to every connection, each round waits until every queue drained into the sockets
+     * @param[in] broadcast queues the message on every connection
+     * @param[out] callMs wall time of the broadcast call itself, per round
+     * @return ms from the call until every connection's queue is empty, per round
+     */
+    inline double broadcast_rounds(const std::vector<tcp_connection::pointer> &connections, const std::function<void()> &broadcast, double &callMs) {
+        double callSeconds = 0;
+        double drainSeconds = 0;
+        for (size_t round = 0; round < BROADCAST_ROUNDS; round++) {
+            const auto start = bench_clock::now();
+            broadcast();
+            callSeconds += elapsed_seconds(start);
+
+            while (broadcast_queued_bytes(connections) > 0) {
+                std::this_thread::sleep_for(std::chrono::microseconds(200));
+            }
+            drainSeconds += elapsed_seconds(start);
+        }
+
+        callMs = callSeconds * 1000 / BROADCAST_ROUNDS;
+        return drainSeconds * 1000 / BROADCAST_ROUNDS;
+    }
+
+    /**
+     * \brief heap held by one broadcast to subscribers that do not read at all
+     * \details unconnected connections on an io service that never runs keep everything queued,
+     * the way a stalled reader does once its socket buffer is full
+     * @return MB, per-connection copies first, one shared frame second
+     */
+    inline std::pair<double, double> broadcast_queued_heap(size_t count, const string &message) {
+        boost::asio::io_service ios;
+        std::vector<tcp_connection::pointer> stalled;
+        stalled.reserve(count);
+        for (size_t i = 0; i < count; i++) {
+            stalled.push_back(tcp_connection::create(ios));
+        }
+
+        const size_t before = heap_bytes();
+        for (const auto &connection : stalled) {
+            connection->send(message);
+        }
+        const size_t copies = heap_bytes();
+
+        const frame_pointer frame = encode_frame(message);
+        for (const auto &connection : stalled) {
+            connection->sendFrame(frame);
+        }
+        const size_t shared = heap_bytes();
+
+        return { static_cast<double>(copies - before) / (1 << 20), static_cast<double>(shared - copies) / (1 << 20) };
+    }
+
+    inline void broadcast_fan_out(size_t count) {
+        auto endpoint = tcp::endpoint(address::from_string(LOCAL_ADDRESS_TCP_V4), BROADCAST_PORT);
+        auto server = tcp_server::create(endpoint);
+        server->start();
+
+        const pid_t readers = spawn_broadcast_readers(BROADCAST_PORT, count);
+        const auto start = bench_clock::now();
+        while (server->getConnections().size() < count && elapsed_seconds(start) < 60) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+
+        const auto connections = server->getConnectionsVector();
+        if (connections.size() < count) {
+            std::printf("%zu connections: only %zu connected, skipped\n", count, connections.size());
+        } else {
+            for (const size_t size : { 64, 4096, 16384 }) {
+                const string message(size, 'm');
+                const size_t frame = encode_frame(message)->size();
+
+                // what sendAll did before: every connection encodes and owns its copy
+                double legacyCall = 0;
+                const double legacyDrain = broadcast_rounds(
+                        connections, [&]() {
+                            for (const auto &connection : connections) {
+                                connection->send(message);
+                            }
+                        },
+                        legacyCall);
+
+                double sharedCall = 0;
+                const double sharedDrain = broadcast_rounds(
+                        connections, [&]() { server->sendAll(message); }, sharedCall);
+
+                const auto heap = broadcast_queued_heap(count, message);
+                std::printf("%6zu conns %6zu B (frame %6zu B) | per-connection: call %7.2f ms, drained %7.2f ms, stalled heap %8.2f MB | shared: call %7.2f ms, drained %7.2f ms, stalled heap %6.2f MB\n",
+                            count, size, frame, legacyCall, legacyDrain, heap.first, sharedCall, sharedDrain, heap.second);
+            }
+        }
+
+        kill(readers, SIGKILL);
+        waitpid(readers, nullptr, 0);
+        server->stop();
+    }
+#endif
+
+    inline void benchmark_broadcast() {
+        print_header("tcp_server::sendAll, per-connection encode vs one shared frame");
+#ifdef __linux__
+        tcp_all_log_disable();
+        const size_t descriptors = raise_descriptor_limit();
+        for (const size_t count : { 1000, 10000 }) {
+            if (count + 64 > descriptors) {
+                std::printf("%zu connections: descriptor limit %zu, skipped\n", count, descriptors);
+                continue;
+            }
+            broadcast_fan_out(count);
+        }
+#else
+        std::printf("needs fork, skipped\n");
+#endif
+    }
+}// namespace Diginext::Core::TCP::Benchmark
+
+#endif
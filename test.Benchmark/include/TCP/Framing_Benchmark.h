@@ -0,0 +1,109 @@
+#ifndef DIGINEXT_BENCHMARK___TCP_FRAMING_BENCHMARK_H
+#define DIGINEXT_BENCHMARK___TCP_FRAMING_BENCHMARK_H
+
+#include "Benchmark.h"
+
+#include <TCP/TCP.h>
+#include <TCP/TCPClient.h>
+#include <TCP/TCPConnection.h>
+#include <TCP/TCPServer.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <thread>
+
+#include <boost/asio.hpp>
+
+namespace Diginext::Core::TCP::Benchmark {
+    using namespace Diginext::Core::Benchmark;
+
+    /**
+     * \brief one-way throughput: a client sends count messages, timed until the server has decoded all of them
+     * @return seconds, 0 if not everything arrived
+     */
+    inline double framing_throughput(tcp_framing framing, const string &message, size_t count) {
+        std::atomic<size_t> received(0);
+        std::atomic<size_t> receivedBytes(0);
+
+        auto endpoint = tcp::endpoint(address::from_string(LOCAL_ADDRESS_TCP_V4), RANDOM_PORT);
+        auto server = tcp_server::create(endpoint);
+        server->setFraming(framing);
+        server->onReadMessage.connect([&](tcp_connection::pointer, std::string msg) {
+            receivedBytes += msg.size();
+            received++;
+        });
+        server->start();
+
+        auto clientEndpoint = tcp::endpoint(address::from_string(LOCAL_ADDRESS_TCP_V4), server->getPort());
+        auto client = tcp_client::create();
+        client->setFraming(framing);
+        client->connect(clientEndpoint);
+        client->start();
+        while (server->getConnections().empty()) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+
+        const auto start = bench_clock::now();
+        for (size_t i = 0; i < count; i++) {
+            client->send(message);
+        }
+        while (received < count && elapsed_seconds(start) < 120) {
+            std::this_thread::sleep_for(std::chrono::microseconds(100));
+        }
+        const double seconds = elapsed_seconds(start);
+        const bool complete = received == count && receivedBytes == count * message.size();
+
+        client->stop();
+        server->stop();
+        return complete ? seconds : 0;
+    }
+
+    /**
+     * \brief size bytes of repeated storage requests, about as compressible as real traffic
+     */
+    inline string framing_payload(size_t size) {
+        string message;
+        message.reserve(size + 64);
+        for (size_t i = 0; message.size() < size; i++) {
+            message += R"({"request":"write","key":"user:)" + std::to_string(i) + R"(","value":"profile )" + std::to_string(i * 7919) + R"("})";
+        }
+        message.resize(size);
+        return message;
+    }
+
+    inline void benchmark_framing() {
+        print_header("wire framing throughput, one connection, client to server");
+        tcp_all_log_disable();
+
+        const tcp_framing framings[] = { tcp_framing::Base64Line, tcp_framing::Binary, tcp_framing::Compressed };
+        std::printf("%10s %8s %20s %14s %14s %14s %12s %12s %12s\n", "message", "count", "wire B b64/bin/zip", "base64 msg/s", "binary msg/s",
+                    "zip msg/s", "base64 MB/s", "binary MB/s", "zip MB/s");
+        for (const auto &run : { std::make_pair(size_t(64), size_t(200000)), std::make_pair(size_t(4096), size_t(50000)),
+                                 std::make_pair(size_t(1) << 20, size_t(256)) }) {
+            const string message = framing_payload(run.first);
+            const size_t count = run.second;
+            const double megabytes = static_cast<double>(message.size() * count) / (1 << 20);
+
+            double seconds[3];
+            for (size_t f = 0; f < 3; f++) {
+                seconds[f] = framings[f] == tcp_framing::Compressed && !tcp_compression_available() ? 0 : framing_throughput(framings[f], message, count);
+            }
+
+            const string wire = std::to_string(encode_frame(message, tcp_framing::Base64Line)->size()) + "/" +
+                                std::to_string(encode_frame(message, tcp_framing::Binary)->size()) + "/" +
+                                std::to_string(encode_frame(message, tcp_framing::Compressed)->size());
+            std::printf("%10zu %8zu %20s", message.size(), count, wire.c_str());
+            for (const double time : seconds) {
+                std::printf(" %14.0f", time > 0 ? count / time : 0);
+            }
+            for (const double time : seconds) {
+                std::printf(" %12.1f", time > 0 ? megabytes / time : 0);
+            }
+            std::printf("\n");
+        }
+    }
+}// namespace Diginext::Core::TCP::Benchmark
+
+#endif
@@ -0,0 +1,60 @@
+#include "Storage/EntryLayout_Benchmark.h"
+#include "Storage/EpochReads_Benchmark.h"
+#include "Storage/HotKeys_Benchmark.h"
+#include "Storage/LsmStorage_Benchmark.h"
+#include "Storage/Pipeline_Benchmark.h"
+#include "Storage/Raft_Benchmark.h"
+#include "Storage/Replication_Benchmark.h"
+#include "Storage/Resp_Benchmark.h"
+#include "Storage/RequestCodec_Benchmark.h"
+#include "Storage/ShardedHashStorage_Benchmark.h"
+#include "Storage/Snapshot_Benchmark.h"
+#include "Storage/StorageEngine_Benchmark.h"
+#include "Storage/WriteAheadLog_Benchmark.h"
+#include "TCP/Broadcast_Benchmark.h"
+#include "TCP/Framing_Benchmark.h"
+
+#include <cstdio>
+#include <functional>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace Diginext::Core::Storage::Benchmark;
+using namespace Diginext::Core::TCP::Benchmark;
+
+int main(int argc, char** argv) {
+    const std::vector<std::pair<std::string, std::function<void()>>> benchmarks = {
+            { "sharded", benchmark_sharded_hash_storage },
+            { "epoch", benchmark_epoch_reads },
+            { "wal", benchmark_write_ahead_log },
+            { "snapshot", benchmark_snapshot },
+            { "lsm", benchmark_lsm_storage },
+            { "engines", benchmark_storage_engines },
+            { "layout", benchmark_entry_layout },
+            { "replication", benchmark_replication },
+            { "raft", benchmark_raft },
+            { "broadcast", benchmark_broadcast },
+            { "hotkeys", benchmark_hot_keys },
+            { "framing", benchmark_framing },
+            { "codec", benchmark_request_codec },
+            { "pipeline", benchmark_pipeline },
+            { "resp", benchmark_resp },
+    };
+
+    // no arguments: run everything, otherwise only the named benchmarks
+    for (const auto &benchmark : benchmarks) {
+        bool selected = argc < 2;
+        for (int i = 1; i < argc; i++) {
+            if (benchmark.first == argv[i]) {
+                selected = true;
+            }
+        }
+
+        if (selected) {
+            benchmark.second();
+        }
+    }
+
+    return 0;
+}